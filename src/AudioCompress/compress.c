@@ -9,6 +9,11 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "config.h"
 #include "compress.h"
@@ -26,6 +31,12 @@ struct Compressor {
         //! History of clip amounts
         int *clipped;
 
+        //! History of the peak values (float samples)
+        float *fpeaks;
+
+        //! History of the gain values (float samples)
+        float *fgain;
+
         unsigned int pos;
         unsigned int bufsz;
 };
@@ -42,6 +53,7 @@ struct Compressor *Compressor_new(unsigned int history)
 	obj->prefs.smooth = GAINSMOOTH;
 
         obj->peaks = obj->gain = obj->clipped = NULL;
+        obj->fpeaks = obj->fgain = NULL;
 	obj->bufsz = 0;
         obj->pos = 0;
 
@@ -58,6 +70,10 @@ void Compressor_delete(struct Compressor *obj)
 		free(obj->gain);
 	if (obj->clipped)
 		free(obj->clipped);
+	if (obj->fpeaks)
+		free(obj->fpeaks);
+	if (obj->fgain)
+		free(obj->fgain);
 	free(obj);
 }
 
@@ -73,6 +89,18 @@ static int *resizeArray(int *data, int newsz, int oldsz)
         return data;
 }
 
+static float *resizeArrayF(float *data, int newsz, int oldsz)
+{
+        data = realloc(data, newsz*sizeof(float));
+	if (data == NULL)
+		/* out of memory, not much we can do */
+		abort();
+
+        if (newsz > oldsz)
+                memset(data + oldsz, 0, sizeof(float)*(newsz - oldsz));
+        return data;
+}
+
 void Compressor_setHistory(struct Compressor *obj, unsigned int history)
 {
 	if (!history)
@@ -81,6 +109,8 @@ void Compressor_setHistory(struct Compressor *obj, unsigned int history)
         obj->peaks = resizeArray(obj->peaks, history, obj->bufsz);
         obj->gain = resizeArray(obj->gain, history, obj->bufsz);
         obj->clipped = resizeArray(obj->clipped, history, obj->bufsz);
+        obj->fpeaks = resizeArrayF(obj->fpeaks, history, obj->bufsz);
+        obj->fgain = resizeArrayF(obj->fgain, history, obj->bufsz);
         obj->bufsz = history;
 }
 
@@ -190,3 +220,169 @@ void Compressor_Process_int16(struct Compressor *obj, int16_t *audio,
         obj->pos = slot;
 }
 
+void Compressor_Process_float(struct Compressor *obj, float *audio,
+                              unsigned int count)
+{
+        struct CompressorConfig *prefs = Compressor_getConfig(obj);
+	float *ap;
+	unsigned int i;
+        float *peaks = obj->fpeaks;
+        float curGain = obj->fgain[obj->pos];
+        float newGain;
+        //! The same floor as the int16 code's initial peak value of 1
+        float peakVal = 1.f/32768.f;
+        unsigned int peakPos = 0;
+        int slot = (obj->pos + 1) % obj->bufsz;
+        unsigned int ramp = count;
+        float delta;
+
+	ap = audio;
+	i = 0;
+#ifdef __SSE2__
+	{
+                //! Clear the sign bit to compute the absolute value
+                const __m128 absmask =
+                        _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+                __m128 vpeak = _mm_set1_ps(peakVal);
+
+                for (; i + 4 <= count; i += 4)
+                        vpeak = _mm_max_ps(vpeak,
+                                           _mm_and_ps(_mm_loadu_ps(ap + i),
+                                                      absmask));
+
+                vpeak = _mm_max_ps(vpeak,
+                                   _mm_shuffle_ps(vpeak, vpeak,
+                                                  _MM_SHUFFLE(1, 0, 3, 2)));
+                vpeak = _mm_max_ps(vpeak,
+                                   _mm_shuffle_ps(vpeak, vpeak,
+                                                  _MM_SHUFFLE(2, 3, 0, 1)));
+                peakVal = _mm_cvtss_f32(vpeak);
+	}
+#endif
+	for (; i < count; i++)
+	{
+		float val = fabsf(ap[i]);
+		if (val > peakVal)
+                {
+			peakVal = val;
+                        peakPos = i;
+                }
+	}
+	peaks[slot] = peakVal;
+
+	for (i = 0; i < obj->bufsz; i++)
+	{
+		if (peaks[i] > peakVal)
+		{
+			peakVal = peaks[i];
+			peakPos = 0;
+		}
+	}
+
+	//! Determine target gain
+	newGain = ((float)prefs->target/32768.f)/peakVal;
+
+        //! Adjust the gain with inertia from the previous gain value
+        newGain = (curGain*((1 << prefs->smooth) - 1) + newGain)
+                / (1 << prefs->smooth);
+
+        //! Make sure it's no more than the maximum gain value
+        if (newGain > prefs->maxgain)
+                newGain = prefs->maxgain;
+
+        //! Make sure it's no less than 1:1
+	if (newGain < 1.f)
+		newGain = 1.f;
+
+        //! Make sure the adjusted gain won't cause clipping
+        if (peakVal*newGain > 1.f)
+        {
+                newGain = 1.f/peakVal;
+#ifdef __SSE2__
+                //! The vectorized peak scan does not track the peak
+                //! position; rescan for it (this branch is rare)
+                if (peaks[slot] == peakVal)
+                        for (peakPos = 0; peakPos < count; peakPos++)
+                                if (fabsf(ap[peakPos]) == peakVal)
+                                        break;
+#endif
+                //! Truncate the ramp time
+                ramp = peakPos;
+        }
+
+        //! Record the new gain
+        obj->fgain[slot] = newGain;
+
+        if (!ramp)
+                ramp = 1;
+        if (curGain == 0.f)
+                curGain = 1.f;
+	delta = (newGain - curGain) / (int)ramp;
+
+	i = 0;
+#ifdef __SSE2__
+	{
+                const __m128 vmax = _mm_set1_ps(1.f);
+                const __m128 vmin = _mm_set1_ps(-1.f);
+                __m128 vgain = _mm_setr_ps(curGain,
+                                           curGain + delta,
+                                           curGain + 2*delta,
+                                           curGain + 3*delta);
+                const __m128 vdelta = _mm_set1_ps(4*delta);
+
+                //! Amplify the ramp with a per-lane gain vector
+                for (; i + 4 <= ramp; i += 4)
+                {
+                        __m128 v = _mm_mul_ps(_mm_loadu_ps(ap + i), vgain);
+                        v = _mm_min_ps(_mm_max_ps(v, vmin), vmax);
+                        _mm_storeu_ps(ap + i, v);
+                        vgain = _mm_add_ps(vgain, vdelta);
+                }
+
+                curGain += i*delta;
+
+                //! Finish the scalar remainder of the ramp
+                for (; i < ramp && i < count; i++)
+                {
+                        float sample = ap[i]*curGain;
+                        if (sample < -1.f)
+                                sample = -1.f;
+                        else if (sample > 1.f)
+                                sample = 1.f;
+                        ap[i] = sample;
+                        curGain += delta;
+                }
+
+                //! Amplify the rest with the constant new gain
+                vgain = _mm_set1_ps(newGain);
+                for (; i + 4 <= count; i += 4)
+                {
+                        __m128 v = _mm_mul_ps(_mm_loadu_ps(ap + i), vgain);
+                        v = _mm_min_ps(_mm_max_ps(v, vmin), vmax);
+                        _mm_storeu_ps(ap + i, v);
+                }
+
+                if (i >= ramp)
+                        curGain = newGain;
+	}
+#endif
+	for (; i < count; i++)
+	{
+		//! Amplify the sample
+		float sample = ap[i]*curGain;
+		if (sample < -1.f)
+			sample = -1.f;
+		else if (sample > 1.f)
+			sample = 1.f;
+		ap[i] = sample;
+
+                //! Adjust the gain
+                if (i < ramp)
+                        curGain += delta;
+                else
+                        curGain = newGain;
+	}
+
+        obj->pos = slot;
+}
+
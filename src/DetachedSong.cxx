@@ -29,7 +29,23 @@ DetachedSong::DetachedSong(const LightSong &other)
 	 tag(*other.tag),
 	 mtime(other.mtime),
 	 start_time(other.start_time),
-	 end_time(other.end_time) {}
+	 end_time(other.end_time)
+{
+	if (other.replay_gain != nullptr)
+		replay_gain = *other.replay_gain;
+}
+
+DetachedSong::DetachedSong(const LightSong &other, Tag &&_tag)
+	:uri(other.GetURI()),
+	 real_uri(other.real_uri != nullptr ? other.real_uri : ""),
+	 tag(std::move(_tag)),
+	 mtime(other.mtime),
+	 start_time(other.start_time),
+	 end_time(other.end_time)
+{
+	if (other.replay_gain != nullptr)
+		replay_gain = *other.replay_gain;
+}
 
 DetachedSong::operator LightSong() const noexcept
 {
@@ -38,6 +54,7 @@ DetachedSong::operator LightSong() const noexcept
 	result.uri = uri.c_str();
 	result.real_uri = real_uri.empty() ? nullptr : real_uri.c_str();
 	result.tag = &tag;
+	result.replay_gain = replay_gain.IsDefined() ? &replay_gain : nullptr;
 	result.mtime = mtime;
 	result.start_time = start_time;
 	result.end_time = end_time;
@@ -22,6 +22,7 @@
 
 #include "check.h"
 #include "tag/Tag.hxx"
+#include "ReplayGainInfo.hxx"
 #include "Chrono.hxx"
 #include "Compiler.h"
 
@@ -62,6 +63,13 @@ class DetachedSong {
 
 	Tag tag;
 
+	/**
+	 * The song's replay gain, as determined by the last tag scan.
+	 * Undefined (see ReplayGainInfo::IsDefined()) if the file has
+	 * no replay gain tags or was never scanned.
+	 */
+	ReplayGainInfo replay_gain = ReplayGainInfo::Undefined();
+
 	/**
 	 * The time stamp of the last file modification.  A negative
 	 * value means that this is unknown/unavailable.
@@ -102,6 +110,12 @@ public:
 	 */
 	explicit DetachedSong(const LightSong &other);
 
+	/**
+	 * Like the above, but replace the tag with the given one,
+	 * e.g. a reduced copy of the song's tag.
+	 */
+	DetachedSong(const LightSong &other, Tag &&_tag);
+
 	gcc_noinline
 	~DetachedSong() = default;
 
@@ -205,6 +219,18 @@ public:
 		tag.MoveItemsFrom(std::move(other.tag));
 	}
 
+	const ReplayGainInfo &GetReplayGain() const noexcept {
+		return replay_gain;
+	}
+
+	ReplayGainInfo &WritableReplayGain() noexcept {
+		return replay_gain;
+	}
+
+	void SetReplayGain(const ReplayGainInfo &_replay_gain) noexcept {
+		replay_gain = _replay_gain;
+	}
+
 	std::chrono::system_clock::time_point GetLastModified() const {
 		return mtime;
 	}
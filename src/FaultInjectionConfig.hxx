@@ -0,0 +1,127 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_FAULT_INJECTION_CONFIG_HXX
+#define MPD_FAULT_INJECTION_CONFIG_HXX
+
+#include "util/RuntimeError.hxx"
+
+#include <chrono>
+#include <string>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * A fault profile for the "fault" input and storage wrappers: how
+ * slow and how unreliable should the wrapped I/O be?  All defaults
+ * are neutral, so an unconfigured wrapper merely forwards.
+ */
+struct FaultInjectionConfig {
+	/** added delay per I/O call */
+	std::chrono::milliseconds latency{0};
+
+	/** bandwidth cap [bytes/s]; 0 means unlimited */
+	uint64_t bandwidth = 0;
+
+	/** probability of an I/O call failing, 0..1 */
+	double error_rate = 0;
+
+	/** PRNG seed, to make error sequences reproducible */
+	unsigned seed = 42;
+};
+
+/**
+ * Parse one "NAME=VALUE" fault option.
+ *
+ * Throws std::runtime_error if the name or value is not understood.
+ */
+inline void
+ParseFaultOption(FaultInjectionConfig &config, const std::string &option)
+{
+	const auto eq = option.find('=');
+	if (eq == option.npos)
+		throw FormatRuntimeError("Malformed fault option: %s",
+					 option.c_str());
+
+	const std::string name(option, 0, eq);
+	const char *value = option.c_str() + eq + 1;
+	char *endptr;
+
+	if (name == "latency_ms") {
+		config.latency =
+			std::chrono::milliseconds(strtoul(value, &endptr, 10));
+		if (endptr == value || *endptr != 0)
+			throw FormatRuntimeError("Invalid latency_ms: %s",
+						 value);
+	} else if (name == "bandwidth_kbps") {
+		config.bandwidth = strtoul(value, &endptr, 10) * uint64_t(1024);
+		if (endptr == value || *endptr != 0)
+			throw FormatRuntimeError("Invalid bandwidth_kbps: %s",
+						 value);
+	} else if (name == "error_rate") {
+		double percent = strtod(value, &endptr);
+		if (endptr == value || *endptr != 0 ||
+		    percent < 0 || percent > 100)
+			throw FormatRuntimeError("Invalid error_rate: %s",
+						 value);
+
+		config.error_rate = percent / 100.0;
+	} else if (name == "seed") {
+		config.seed = strtoul(value, &endptr, 10);
+		if (endptr == value || *endptr != 0)
+			throw FormatRuntimeError("Invalid seed: %s", value);
+	} else
+		throw FormatRuntimeError("Unknown fault option: %s",
+					 name.c_str());
+}
+
+/**
+ * Parse the optional "NAME=VALUE&...;" options segment at the start
+ * of a "fault://" URI tail and return a pointer to the wrapped URI.
+ * A segment is only recognized when the semicolon comes before any
+ * slash, so it cannot be confused with the wrapped URI itself.
+ *
+ * Throws std::runtime_error if an option is not understood.
+ */
+inline const char *
+ParseFaultOptions(FaultInjectionConfig &config, const char *tail)
+{
+	const char *semicolon = strchr(tail, ';');
+	if (semicolon == nullptr ||
+	    memchr(tail, '/', semicolon - tail) != nullptr)
+		return tail;
+
+	std::string options(tail, semicolon);
+	size_t start = 0;
+	while (start < options.length()) {
+		auto end = options.find('&', start);
+		if (end == options.npos)
+			end = options.length();
+
+		ParseFaultOption(config,
+				 std::string(options, start, end - start));
+		start = end + 1;
+	}
+
+	return semicolon + 1;
+}
+
+#endif
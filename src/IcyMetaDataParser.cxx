@@ -188,6 +188,23 @@ IcyMetaDataParser::Meta(const void *data, size_t length) noexcept
 		   return value */
 		--length;
 
+		if (length >= meta_size) {
+			/* fast path: the whole metadata block is
+			   already available; parse it from a stack
+			   buffer, without allocating a reassembly
+			   buffer on the heap */
+			char buffer[255 * 16 + 1];
+			memcpy(buffer, p, meta_size);
+
+			tag = icy_parse_tag(buffer, buffer + meta_size);
+
+			data_rest = data_size;
+
+			const size_t consumed = meta_size + 1;
+			meta_size = 0;
+			return consumed;
+		}
+
 		/* initialize metadata reader, allocate enough
 		   memory (+1 for the null terminator) */
 		meta_position = 0;
@@ -231,7 +248,13 @@ IcyMetaDataParser::ParseInPlace(void *data, size_t length) noexcept
 	while (length > 0) {
 		size_t chunk = Data(length);
 		if (chunk > 0) {
-			memmove(dest, src, chunk);
+			/* no copy needed until the first metadata
+			   block has shifted the stream; with typical
+			   icy-metaint values, most buffers are pure
+			   audio and pass through untouched */
+			if (dest != src)
+				memmove(dest, src, chunk);
+
 			dest += chunk;
 			src += chunk;
 			length -= chunk;
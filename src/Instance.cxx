@@ -35,7 +35,8 @@
 #include <exception>
 
 Instance::Instance()
-	:idle_monitor(event_loop, BIND_THIS_METHOD(OnIdle))
+	:idle_monitor(event_loop, BIND_THIS_METHOD(OnIdle)),
+	 idle_flush_event(event_loop, BIND_THIS_METHOD(OnIdleFlush))
 {
 }
 
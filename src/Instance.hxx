@@ -71,6 +71,12 @@ struct Instance final
 
 	MaskMonitor idle_monitor;
 
+	/**
+	 * Flushes accumulated client idle flags once after a burst of
+	 * mutations, so each client gets one merged notification.
+	 */
+	DeferEvent idle_flush_event;
+
 #ifdef ENABLE_NEIGHBOR_PLUGINS
 	NeighborGlue *neighbors;
 #endif
@@ -145,6 +151,9 @@ private:
 
 	/* callback for #idle_monitor */
 	void OnIdle(unsigned mask);
+
+	/* callback for #idle_flush_event */
+	void OnIdleFlush() noexcept;
 };
 
 #endif
@@ -25,6 +25,9 @@
 #include "util/UriUtil.hxx"
 #include "util/StringCompare.hxx"
 
+#include <assert.h>
+#include <string.h>
+
 #ifdef ENABLE_DATABASE
 #include "storage/StorageInterface.hxx"
 #endif
@@ -54,14 +57,38 @@ LocateFileUri(const char *uri, const Client *client
 	return LocatedUri(LocatedUri::Type::PATH, uri, std::move(path));
 }
 
+/**
+ * Like uri_supported_scheme(), but with a per-client one-entry cache:
+ * a client which adds many songs with the same scheme (e.g. a bulk
+ * playlist load) pays for the scheme list scan only once.
+ */
+static bool
+SupportedSchemeCached(const char *uri, const Client *client) noexcept
+{
+	if (client == nullptr)
+		return uri_supported_scheme(uri);
+
+	auto &cached = client->verified_uri_scheme;
+	if (!cached.empty() && StringStartsWith(uri, cached.c_str()))
+		return true;
+
+	if (!uri_supported_scheme(uri))
+		return false;
+
+	const char *colon = strstr(uri, "://");
+	assert(colon != nullptr);
+	cached.assign(uri, colon + 3);
+	return true;
+}
+
 static LocatedUri
-LocateAbsoluteUri(const char *uri
+LocateAbsoluteUri(const char *uri, const Client *client
 #ifdef ENABLE_DATABASE
 		  , const Storage *storage
 #endif
 		  )
 {
-	if (!uri_supported_scheme(uri))
+	if (!SupportedSchemeCached(uri, client))
 		throw std::runtime_error("Unsupported URI scheme");
 
 #ifdef ENABLE_DATABASE
@@ -100,7 +127,7 @@ LocateUri(const char *uri, const Client *client
 #endif
 				     );
 	else if (uri_has_scheme(uri))
-		return LocateAbsoluteUri(uri
+		return LocateAbsoluteUri(uri, client
 #ifdef ENABLE_DATABASE
 					 , storage
 #endif
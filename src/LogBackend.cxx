@@ -22,8 +22,16 @@
 #include "Log.hxx"
 #include "util/Domain.hxx"
 #include "util/StringStrip.hxx"
+#include "thread/Thread.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+#include "thread/Name.hxx"
+
+#include <atomic>
+#include <chrono>
 
 #include <assert.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -85,11 +93,10 @@ EnableLogTimestamp() noexcept
 }
 
 static const char *
-log_date() noexcept
+log_date(time_t t) noexcept
 {
 	static constexpr size_t LOG_DATE_BUF_SIZE = 16;
 	static char buf[LOG_DATE_BUF_SIZE];
-	time_t t = time(nullptr);
 	strftime(buf, LOG_DATE_BUF_SIZE, "%b %d %H:%M : ", localtime(&t));
 	return buf;
 }
@@ -157,10 +164,10 @@ LogFinishSysLog() noexcept
 #endif
 
 static void
-FileLog(const Domain &domain, const char *message) noexcept
+FileLog(const Domain &domain, const char *message, time_t t) noexcept
 {
 	fprintf(stderr, "%s%s: %.*s\n",
-		enable_timestamp ? log_date() : "",
+		enable_timestamp ? log_date(t) : "",
 		domain.GetName(),
 		chomp_length(message), message);
 
@@ -171,6 +178,210 @@ FileLog(const Domain &domain, const char *message) noexcept
 #endif
 }
 
+/**
+ * Write a message to the configured backend (syslog or log file).
+ * This is the final, potentially blocking step of both the
+ * synchronous and the asynchronous path.
+ */
+static void
+DispatchLog(const Domain &domain, LogLevel level,
+	    const char *message, time_t t) noexcept
+{
+#ifdef HAVE_SYSLOG
+	if (enable_syslog) {
+		SysLog(domain, level, message);
+		return;
+	}
+#else
+	(void)level;
+#endif
+
+	FileLog(domain, message, t);
+}
+
+/* The asynchronous backend: a bounded multi-producer ring buffer
+   which is drained by a dedicated writer thread.  Logging threads
+   only claim a slot and copy the message; the blocking write happens
+   on the writer thread, so even verbose logging from the real-time
+   output thread cannot cause xruns.  When the ring is full, messages
+   are dropped and counted instead of blocking the producer. */
+
+static constexpr size_t ASYNC_LOG_QUEUE_SIZE = 1024;
+static_assert((ASYNC_LOG_QUEUE_SIZE & (ASYNC_LOG_QUEUE_SIZE - 1)) == 0,
+	      "Must be a power of two");
+
+struct AsyncLogItem {
+	/**
+	 * The slot's sequence number: producers may claim the slot
+	 * when it equals their ticket, and the consumer may read it
+	 * when it equals the ticket plus one (Dmitry Vyukov's bounded
+	 * queue algorithm).
+	 */
+	std::atomic<size_t> sequence;
+
+	const Domain *domain;
+	LogLevel level;
+
+	/**
+	 * The time at which the message was enqueued, so delayed
+	 * writes carry the correct timestamp.
+	 */
+	time_t time;
+
+	char message[256];
+};
+
+static AsyncLogItem async_log_queue[ASYNC_LOG_QUEUE_SIZE];
+static std::atomic<size_t> async_log_enqueue_pos;
+
+/** only accessed by the writer thread */
+static size_t async_log_dequeue_pos;
+
+/** the number of messages dropped because the ring was full */
+static std::atomic<unsigned> async_log_dropped;
+
+static std::atomic<bool> async_log_enabled;
+
+static Mutex async_log_mutex;
+static Cond async_log_cond;
+
+/** protected by #async_log_mutex */
+static bool async_log_quit;
+
+static void
+RunAsyncLogThread() noexcept;
+
+static Thread async_log_thread(BIND_FUNCTION(RunAsyncLogThread));
+
+static void
+EnqueueLog(const Domain &domain, LogLevel level, const char *message) noexcept
+{
+	size_t pos = async_log_enqueue_pos.load(std::memory_order_relaxed);
+	AsyncLogItem *item;
+
+	while (true) {
+		item = &async_log_queue[pos & (ASYNC_LOG_QUEUE_SIZE - 1)];
+		const size_t seq = item->sequence.load(std::memory_order_acquire);
+		const intptr_t delta = intptr_t(seq) - intptr_t(pos);
+
+		if (delta == 0) {
+			if (async_log_enqueue_pos.compare_exchange_weak(pos, pos + 1,
+									std::memory_order_relaxed))
+				break;
+		} else if (delta < 0) {
+			/* the ring is full: drop the message instead
+			   of blocking the logging thread */
+			async_log_dropped.fetch_add(1,
+						    std::memory_order_relaxed);
+			return;
+		} else
+			pos = async_log_enqueue_pos.load(std::memory_order_relaxed);
+	}
+
+	item->domain = &domain;
+	item->level = level;
+	item->time = time(nullptr);
+	snprintf(item->message, sizeof(item->message), "%s", message);
+
+	/* publish the slot to the writer thread */
+	item->sequence.store(pos + 1, std::memory_order_release);
+}
+
+/**
+ * Write all pending messages.  Returns true if at least one message
+ * was written.
+ */
+static bool
+DrainAsyncLog() noexcept
+{
+	bool result = false;
+
+	while (true) {
+		auto &item = async_log_queue[async_log_dequeue_pos &
+					     (ASYNC_LOG_QUEUE_SIZE - 1)];
+		if (item.sequence.load(std::memory_order_acquire) !=
+		    async_log_dequeue_pos + 1)
+			break;
+
+		DispatchLog(*item.domain, item.level, item.message, item.time);
+
+		/* mark the slot reusable for the producer one lap
+		   ahead */
+		item.sequence.store(async_log_dequeue_pos + ASYNC_LOG_QUEUE_SIZE,
+				    std::memory_order_release);
+		++async_log_dequeue_pos;
+		result = true;
+	}
+
+	const unsigned dropped =
+		async_log_dropped.exchange(0, std::memory_order_relaxed);
+	if (dropped > 0) {
+		static constexpr Domain log_domain("log");
+		char buffer[64];
+		snprintf(buffer, sizeof(buffer),
+			 "dropped %u log messages", dropped);
+		DispatchLog(log_domain, LogLevel::WARNING,
+			    buffer, time(nullptr));
+	}
+
+	return result;
+}
+
+static void
+RunAsyncLogThread() noexcept
+{
+	SetThreadName("log");
+
+	while (true) {
+		const bool busy = DrainAsyncLog();
+
+		const std::lock_guard<Mutex> lock(async_log_mutex);
+		if (async_log_quit)
+			break;
+
+		if (!busy)
+			/* poll instead of having producers signal the
+			   condition variable, which would reintroduce
+			   a system call on the logging hot path */
+			async_log_cond.timed_wait(async_log_mutex,
+						  std::chrono::milliseconds(10));
+	}
+
+	/* flush what was enqueued while shutting down */
+	DrainAsyncLog();
+}
+
+void
+LogInitAsync()
+{
+	assert(!async_log_enabled.load());
+
+	for (size_t i = 0; i < ASYNC_LOG_QUEUE_SIZE; ++i)
+		async_log_queue[i].sequence.store(i,
+						  std::memory_order_relaxed);
+
+	async_log_thread.Start();
+	async_log_enabled.store(true, std::memory_order_release);
+}
+
+void
+LogFinishAsync() noexcept
+{
+	if (!async_log_enabled.load(std::memory_order_relaxed))
+		return;
+
+	/* from now on, Log() writes synchronously again */
+	async_log_enabled.store(false, std::memory_order_release);
+
+	{
+		const std::lock_guard<Mutex> lock(async_log_mutex);
+		async_log_quit = true;
+		async_log_cond.signal();
+	}
+
+	async_log_thread.Join();
+}
+
 #endif /* !ANDROID */
 
 void
@@ -184,13 +395,12 @@ Log(const Domain &domain, LogLevel level, const char *msg) noexcept
 	if (level < log_threshold)
 		return;
 
-#ifdef HAVE_SYSLOG
-	if (enable_syslog) {
-		SysLog(domain, level, msg);
+	if (async_log_enabled.load(std::memory_order_acquire)) {
+		EnqueueLog(domain, level, msg);
 		return;
 	}
-#endif
 
-	FileLog(domain, msg);
+	DispatchLog(domain, level, msg,
+		    enable_timestamp ? time(nullptr) : 0);
 #endif /* !ANDROID */
 }
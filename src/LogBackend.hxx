@@ -35,4 +35,21 @@ LogInitSysLog() noexcept;
 void
 LogFinishSysLog() noexcept;
 
+/**
+ * Start the asynchronous log writer thread.  From now on, Log()
+ * only copies the message into a lock-free ring buffer, and the
+ * writer thread performs the blocking I/O.
+ *
+ * Throws on error.
+ */
+void
+LogInitAsync();
+
+/**
+ * Flush all pending messages, stop the writer thread and return to
+ * synchronous logging.  No-op if LogInitAsync() was never called.
+ */
+void
+LogFinishAsync() noexcept;
+
 #endif /* LOG_H */
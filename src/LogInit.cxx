@@ -149,6 +149,9 @@ log_init(bool verbose, bool use_stdout)
 			log_init_file(param->line);
 		}
 	}
+
+	if (config_get_bool(ConfigOption::LOG_ASYNC, false))
+		LogInitAsync();
 #endif
 }
 
@@ -168,6 +171,7 @@ void
 log_deinit(void)
 {
 #ifndef ANDROID
+	LogFinishAsync();
 	close_log_files();
 	out_path = AllocatedPath::Null();
 #endif
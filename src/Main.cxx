@@ -24,7 +24,13 @@
 #include "PlaylistFile.hxx"
 #include "MusicChunk.hxx"
 #include "StateFile.hxx"
+#include "MemoryStats.hxx"
+#include "PerfStats.hxx"
+#include "StartupTiming.hxx"
+#include "util/AllocAudit.hxx"
+#include "Profiler.hxx"
 #include "player/Thread.hxx"
+#include "player/CommandTrace.hxx"
 #include "Mapper.hxx"
 #include "Permission.hxx"
 #include "Listen.hxx"
@@ -49,6 +55,8 @@
 #include "unix/SignalHandlers.hxx"
 #include "system/FatalError.hxx"
 #include "thread/Slack.hxx"
+#include "thread/Thread.hxx"
+#include "thread/Name.hxx"
 #include "lib/icu/Init.hxx"
 #include "config/ConfigGlobal.hxx"
 #include "config/Param.hxx"
@@ -185,19 +193,20 @@ InitStorage(EventLoop &event_loop)
 }
 
 /**
- * Returns the database.  If this function returns false, this has not
- * succeeded, and the caller should create the database after the
- * process has been daemonized.
+ * Create the configured database (and its storage).
+ *
+ * @return true if a database was configured; the caller shall open
+ * it via #DatabaseOpenThread
  */
 static bool
-glue_db_init_and_load(void)
+glue_db_init()
 {
 	instance->database =
 		CreateConfiguredDatabase(instance->event_loop,
 					 instance->io_thread.GetEventLoop(),
 					 *instance);
 	if (instance->database == nullptr)
-		return true;
+		return false;
 
 	if (instance->database->GetPlugin().flags & DatabasePlugin::FLAG_REQUIRE_STORAGE) {
 		InitStorage(instance->io_thread.GetEventLoop());
@@ -208,7 +217,7 @@ glue_db_init_and_load(void)
 			LogDefault(config_domain,
 				   "Found database setting without "
 				   "music_directory - disabling database");
-			return true;
+			return false;
 		}
 	} else {
 		if (IsStorageConfigured())
@@ -217,14 +226,63 @@ glue_db_init_and_load(void)
 				   "because the database does not need it");
 	}
 
+	return true;
+}
+
+/**
+ * Opens (loads) the database on a separate thread, so the rest of the
+ * daemon initialization overlaps with the disk instead of waiting for
+ * it.  Errors are captured and rethrown by Join().
+ */
+class DatabaseOpenThread {
+	Thread thread;
+
+	std::exception_ptr error;
+
+public:
+	DatabaseOpenThread() noexcept:thread(BIND_THIS_METHOD(Run)) {}
+
+	void Start() {
+		thread.Start();
+	}
+
+	void Join() {
+		thread.Join();
+
+		if (error)
+			std::rethrow_exception(std::move(error));
+	}
+
+private:
+	void Run() noexcept {
+		SetThreadName("dbload");
+
+		try {
+			instance->database->Open();
+		} catch (...) {
+			error = std::current_exception();
+		}
+	}
+};
+
+/**
+ * Wait for the database load started by glue_db_init() and finish the
+ * database setup (update service).
+ *
+ * @return true if the database file does not exist yet and an update
+ * shall be started to create it
+ */
+static bool
+glue_db_open_finish(DatabaseOpenThread &db_open)
+{
 	try {
-		instance->database->Open();
+		db_open.Join();
 	} catch (...) {
 		std::throw_with_nested(std::runtime_error("Failed to open database plugin"));
 	}
 
 	if (!instance->database->IsPlugin(simple_db_plugin))
-		return true;
+		return false;
 
 	SimpleDatabase &db = *(SimpleDatabase *)instance->database;
 	instance->update = new UpdateService(instance->event_loop, db,
@@ -232,14 +290,7 @@ glue_db_init_and_load(void)
 					     *instance);
 
 	/* run database update after daemonization? */
-	return db.FileExists();
-}
-
-static bool
-InitDatabaseAndStorage()
-{
-	const bool create_db = !glue_db_init_and_load();
-	return create_db;
+	return !db.FileExists();
 }
 
 #endif
@@ -285,6 +336,23 @@ glue_state_file_init()
 	instance->state_file->Read();
 }
 
+/**
+ * The periodic memory telemetry logger, or nullptr if
+ * "memstats_interval" is not configured.
+ */
+static MemoryStatsLogger *memory_stats_logger;
+
+static void
+glue_memory_stats_init()
+{
+	const unsigned interval =
+		config_get_unsigned(ConfigOption::MEMSTATS_INTERVAL, 0);
+	if (interval > 0)
+		memory_stats_logger =
+			new MemoryStatsLogger(*instance,
+					      std::chrono::seconds(interval));
+}
+
 /**
  * Windows-only initialization of the Winsock2 library.
  */
@@ -312,6 +380,17 @@ initialize_decoder_and_player(const ReplayGainConfig &replay_gain_config)
 {
 	const ConfigParam *param;
 
+	/* the chunk size is latched here, before the first
+	   MusicBuffer is created; MusicChunk::length is 16 bits, so
+	   cap it well below 64 kB */
+	const unsigned chunk_kbytes =
+		config_get_positive(ConfigOption::AUDIO_CHUNK_SIZE,
+				    CHUNK_SIZE / KILOBYTE);
+	if (chunk_kbytes > 32)
+		FormatFatalError("audio_chunk_size \"%u\" is too big (maximum 32)",
+				 chunk_kbytes);
+	music_chunk_size = chunk_kbytes * KILOBYTE;
+
 	size_t buffer_size;
 	param = config_get_param(ConfigOption::AUDIO_BUFFER_SIZE);
 	if (param != nullptr) {
@@ -332,7 +411,7 @@ initialize_decoder_and_player(const ReplayGainConfig &replay_gain_config)
 	} else
 		buffer_size = DEFAULT_BUFFER_SIZE;
 
-	const unsigned buffered_chunks = buffer_size / CHUNK_SIZE;
+	const unsigned buffered_chunks = buffer_size / music_chunk_size;
 
 	if (buffered_chunks >= 1 << 15)
 		FormatFatalError("buffer size \"%lu\" is too big",
@@ -369,6 +448,9 @@ initialize_decoder_and_player(const ReplayGainConfig &replay_gain_config)
 	if (buffered_before_play > buffered_chunks)
 		buffered_before_play = buffered_chunks;
 
+	const unsigned buffer_reserve_time =
+		config_get_unsigned(ConfigOption::BUFFER_RESERVE_TIME, 0);
+
 	const unsigned max_length =
 		config_get_positive(ConfigOption::MAX_PLAYLIST_LENGTH,
 				    DEFAULT_PLAYLIST_MAX_LENGTH);
@@ -390,6 +472,7 @@ initialize_decoder_and_player(const ReplayGainConfig &replay_gain_config)
 					  max_length,
 					  buffered_chunks,
 					  buffered_before_play,
+					  buffer_reserve_time,
 					  configured_audio_format,
 					  replay_gain_config);
 	auto &partition = instance->partitions.back();
@@ -408,15 +491,23 @@ initialize_decoder_and_player(const ReplayGainConfig &replay_gain_config)
 void
 Instance::OnIdle(unsigned flags)
 {
-	/* send "idle" notifications to all subscribed
-	   clients */
+	/* accumulate the flags on all subscribed clients; the
+	   notifications are sent by OnIdleFlush(), so a burst of
+	   mutations produces only one notification per client */
 	client_list->IdleAdd(flags);
+	idle_flush_event.Schedule();
 
 	if (flags & (IDLE_PLAYLIST|IDLE_PLAYER|IDLE_MIXER|IDLE_OUTPUT) &&
 	    state_file != nullptr)
 		state_file->CheckModified();
 }
 
+void
+Instance::OnIdleFlush() noexcept
+{
+	client_list->IdleFlush();
+}
+
 #ifndef ANDROID
 
 int main(int argc, char *argv[])
@@ -473,6 +564,7 @@ try {
 #endif
 
 	const auto config = LoadConfig();
+	startup_timing_mark("config");
 
 #ifdef ENABLE_DAEMON
 	glue_daemonize_init(&options);
@@ -502,6 +594,7 @@ try {
 	initialize_decoder_and_player(config.replay_gain);
 
 	listen_global_init(instance->event_loop, instance->partitions.front());
+	startup_timing_mark("listener");
 
 #ifdef ENABLE_DAEMON
 	daemonize_set_user();
@@ -546,7 +639,14 @@ try {
 	decoder_plugin_init_all();
 
 #ifdef ENABLE_DATABASE
-	const bool create_db = InitDatabaseAndStorage();
+	/* load the database on a worker thread; the remaining
+	   initialization (outputs, input plugins, player threads,
+	   ...) runs concurrently, and glue_db_open_finish() joins
+	   before the first database consumer */
+	DatabaseOpenThread db_open;
+	const bool have_db = glue_db_init();
+	if (have_db)
+		db_open.Start();
 #endif
 
 	glue_sticker_init();
@@ -560,6 +660,8 @@ try {
 		partition.UpdateEffectiveReplayGainMode();
 	}
 
+	startup_timing_mark("outputs");
+
 	client_manager_init();
 	input_stream_global_init(instance->io_thread.GetEventLoop());
 	playlist_list_global_init();
@@ -583,20 +685,41 @@ try {
 
 	ZeroconfInit(instance->event_loop);
 
+	/* start the command trace before the first player/decoder
+	   command can be issued */
+	const char *player_trace_path =
+		config_get_string(ConfigOption::PLAYER_TRACE_FILE, nullptr);
+	if (player_trace_path != nullptr)
+		player_trace_init(player_trace_path);
+
+	if (config_get_bool(ConfigOption::ALLOCATION_AUDIT, false)) {
+#ifdef ENABLE_ALLOC_AUDIT
+		/* arm the audit before the audited threads exist */
+		alloc_audit_enable();
+#else
+		FormatWarning(config_domain,
+			      "allocation_audit requires a debug build with glibc");
+#endif
+	}
+
 	for (auto &partition : instance->partitions)
 		StartPlayerThread(partition.pc);
 
 #ifdef ENABLE_DATABASE
-	if (create_db) {
+	if (have_db && glue_db_open_finish(db_open)) {
 		/* the database failed to load: recreate the
 		   database */
 		unsigned job = instance->update->Enqueue("", true);
 		if (job == 0)
 			FatalError("directory update failed");
 	}
+
+	startup_timing_mark("db_load");
 #endif
 
 	glue_state_file_init();
+	startup_timing_mark("state_restore");
+	glue_memory_stats_init();
 
 #ifdef ENABLE_DATABASE
 	if (config_get_bool(ConfigOption::AUTO_UPDATE, false)) {
@@ -630,11 +753,22 @@ try {
 	   a huge value to allow the kernel to reduce CPU wakeups */
 	SetThreadTimerSlackMS(100);
 
+	/* enable the event loop watchdog if a handler budget was
+	   configured */
+	const unsigned loop_budget =
+		config_get_unsigned(ConfigOption::EVENT_LOOP_BUDGET, 0);
+	if (loop_budget > 0)
+		instance->event_loop.SetHandlerBudget(std::chrono::milliseconds(loop_budget),
+						      &perf_stats.loop_latency);
+
 #ifdef ENABLE_SYSTEMD_DAEMON
 	sd_notify(0, "READY=1");
 #endif
 
+	startup_timing_finish();
+
 	/* run the main loop */
+	const ProfilerThreadScope profiler_scope("main");
 	instance->event_loop.Run();
 
 #ifdef _WIN32
@@ -650,6 +784,8 @@ try {
 		instance->update->CancelAllAsync();
 #endif
 
+	delete memory_stats_logger;
+
 	if (instance->state_file != nullptr) {
 		instance->state_file->Write();
 		delete instance->state_file;
@@ -658,6 +794,8 @@ try {
 	for (auto &partition : instance->partitions)
 		partition.pc.Kill();
 
+	player_trace_finish();
+
 	ZeroconfDeinit();
 	listen_global_finish();
 	delete instance->client_list;
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "MemoryStats.hxx"
+#include "Instance.hxx"
+#include "MusicBuffer.hxx"
+#include "client/Response.hxx"
+#include "client/ClientList.hxx"
+#include "tag/Pool.hxx"
+#include "util/Domain.hxx"
+#include "util/HeapProfile.hxx"
+#include "Log.hxx"
+
+#ifdef ENABLE_DATABASE
+#include "db/Interface.hxx"
+#include "db/DatabaseLock.hxx"
+#include "db/plugins/simple/SimpleDatabasePlugin.hxx"
+#include "db/plugins/simple/Directory.hxx"
+#endif
+
+static constexpr Domain memory_stats_domain("memstats");
+
+struct MemoryStatsSnapshot {
+	TagPoolStats tag_pool;
+
+	unsigned buffer_chunks_total, buffer_chunks_used;
+
+	unsigned n_clients;
+	size_t client_output_bytes;
+
+#ifdef ENABLE_DATABASE
+	/**
+	 * The approximate size of the in-memory database tree, or 0
+	 * if there is no (simple) database.
+	 */
+	size_t db_bytes;
+#endif
+};
+
+static MemoryStatsSnapshot
+memory_stats_get(Instance &instance) noexcept
+{
+	MemoryStatsSnapshot s;
+
+	s.tag_pool = tag_pool_get_stats();
+
+	s.buffer_chunks_total = music_buffer_get_total();
+	s.buffer_chunks_used = music_buffer_get_used();
+
+	s.n_clients = 0;
+	s.client_output_bytes = 0;
+	for (const auto &client : *instance.client_list) {
+		++s.n_clients;
+		s.client_output_bytes += client.GetOutputBufferSize();
+	}
+
+#ifdef ENABLE_DATABASE
+	s.db_bytes = 0;
+
+	Database *db = instance.database;
+	if (db != nullptr && db->IsPlugin(simple_db_plugin)) {
+		SimpleDatabase &sdb = *(SimpleDatabase *)db;
+
+		const ScopeDatabaseLock protect;
+		s.db_bytes = sdb.GetRoot().GetTotalMemoryUsage();
+	}
+#endif
+
+	return s;
+}
+
+void
+memory_stats_print(Response &r, Instance &instance) noexcept
+{
+	const auto s = memory_stats_get(instance);
+
+	r.Format("tag_pool_slots: %zu\n"
+		 "tag_pool_bytes: %zu\n",
+		 s.tag_pool.slots, s.tag_pool.bytes);
+
+	r.Format("music_buffer_chunks: %u\n"
+		 "music_buffer_chunks_used: %u\n",
+		 s.buffer_chunks_total, s.buffer_chunks_used);
+
+	r.Format("clients: %u\n"
+		 "client_output_bytes: %zu\n",
+		 s.n_clients, s.client_output_bytes);
+
+#ifdef ENABLE_DATABASE
+	r.Format("database_bytes: %zu\n", s.db_bytes);
+#endif
+
+#ifdef ENABLE_HEAP_PROFILE
+	for (unsigned i = 0; i < unsigned(HeapTag::COUNT); ++i) {
+		const auto tag = HeapTag(i);
+		const auto c = heap_profile_get(tag);
+		r.Format("heap_%s_count: %lu\n"
+			 "heap_%s_bytes: %lu\n",
+			 heap_tag_name(tag), (unsigned long)c.count,
+			 heap_tag_name(tag), (unsigned long)c.bytes);
+	}
+#endif
+}
+
+MemoryStatsLogger::MemoryStatsLogger(Instance &_instance,
+				     std::chrono::steady_clock::duration _interval) noexcept
+	:instance(_instance), interval(_interval),
+	 timer(instance.event_loop, BIND_THIS_METHOD(OnTimer))
+{
+	timer.Schedule(interval);
+}
+
+void
+MemoryStatsLogger::OnTimer() noexcept
+{
+	const auto s = memory_stats_get(instance);
+
+#ifdef ENABLE_DATABASE
+	FormatDefault(memory_stats_domain,
+		      "tag_pool=%zu/%zu buffer=%u/%u clients=%u/%zu db=%zu",
+		      s.tag_pool.slots, s.tag_pool.bytes,
+		      s.buffer_chunks_used, s.buffer_chunks_total,
+		      s.n_clients, s.client_output_bytes,
+		      s.db_bytes);
+#else
+	FormatDefault(memory_stats_domain,
+		      "tag_pool=%zu/%zu buffer=%u/%u clients=%u/%zu",
+		      s.tag_pool.slots, s.tag_pool.bytes,
+		      s.buffer_chunks_used, s.buffer_chunks_total,
+		      s.n_clients, s.client_output_bytes);
+#endif
+
+	timer.Schedule(interval);
+}
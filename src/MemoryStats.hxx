@@ -0,0 +1,58 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_MEMORY_STATS_HXX
+#define MPD_MEMORY_STATS_HXX
+
+#include "check.h"
+#include "event/TimerEvent.hxx"
+
+#include <chrono>
+
+struct Instance;
+class Response;
+
+/**
+ * Print per-subsystem memory accounting (tag pool, #MusicBuffer,
+ * client output buffers, database tree) for the "memstats" command.
+ */
+void
+memory_stats_print(Response &r, Instance &instance) noexcept;
+
+/**
+ * Logs one memory accounting summary line on a fixed interval, so
+ * long-term RSS growth can be attributed to a subsystem after the
+ * fact.  Enabled with the "memstats_interval" setting.
+ */
+class MemoryStatsLogger final {
+	Instance &instance;
+
+	const std::chrono::steady_clock::duration interval;
+
+	TimerEvent timer;
+
+public:
+	MemoryStatsLogger(Instance &_instance,
+			  std::chrono::steady_clock::duration _interval) noexcept;
+
+private:
+	void OnTimer() noexcept;
+};
+
+#endif
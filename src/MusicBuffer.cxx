@@ -20,18 +20,100 @@
 #include "config.h"
 #include "MusicBuffer.hxx"
 #include "MusicChunk.hxx"
+#include "pcm/Silence.hxx"
+#include "util/WritableBuffer.hxx"
+#include "config/ConfigGlobal.hxx"
+#include "config/ConfigOption.hxx"
+
+#include <atomic>
 
 #include <assert.h>
 
+/* global counters over all instances (there is one buffer per
+   partition), so the "memstats" command can report them without
+   access to the player thread's buffer */
+static std::atomic<unsigned> music_buffer_total;
+static std::atomic<unsigned> music_buffer_used;
+
+unsigned
+music_buffer_get_total() noexcept
+{
+	return music_buffer_total.load(std::memory_order_relaxed);
+}
+
+unsigned
+music_buffer_get_used() noexcept
+{
+	return music_buffer_used.load(std::memory_order_relaxed);
+}
+
 MusicBuffer::MusicBuffer(unsigned num_chunks) noexcept
-	:buffer(num_chunks) {
+	:buffer(num_chunks),
+	 chunk_size(music_chunk_size),
+	 payload(num_chunks * music_chunk_size),
+	 slot_silence(new uint8_t[num_chunks]()) {
+	payload.ForkCow(false);
+
+	music_buffer_total.fetch_add(num_chunks, std::memory_order_relaxed);
+
+	/* the policies must be applied in this order: interleaving
+	   affects only pages which have not been touched yet, and
+	   locking faults in all of them */
+	if (config_get_bool(ConfigOption::AUDIO_BUFFER_NUMA_INTERLEAVE,
+			    false)) {
+		buffer.NumaInterleave();
+		payload.NumaInterleave();
+	}
+
+	if (config_get_bool(ConfigOption::AUDIO_BUFFER_MLOCK, false)) {
+		buffer.Lock();
+		payload.Lock();
+	}
+}
+
+MusicBuffer::~MusicBuffer() noexcept
+{
+	music_buffer_total.fetch_sub(buffer.GetCapacity(),
+				     std::memory_order_relaxed);
 }
 
 MusicChunk *
 MusicBuffer::Allocate() noexcept
 {
-	const std::lock_guard<Mutex> protect(mutex);
-	return buffer.Allocate();
+	auto *chunk = buffer.Allocate();
+	if (chunk != nullptr) {
+		const unsigned i = buffer.IndexOf(*chunk);
+		chunk->data = &payload.front() + i * chunk_size;
+		chunk->capacity = chunk_size;
+
+		/* the caller will write arbitrary samples */
+		slot_silence[i] = 0;
+
+		music_buffer_used.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	return chunk;
+}
+
+MusicChunk *
+MusicBuffer::AllocateSilence(SampleFormat format) noexcept
+{
+	auto *chunk = buffer.Allocate();
+	if (chunk == nullptr)
+		return nullptr;
+
+	const unsigned i = buffer.IndexOf(*chunk);
+	chunk->data = &payload.front() + i * chunk_size;
+	chunk->capacity = chunk_size;
+
+	const uint8_t key = uint8_t(format) + 1;
+	if (slot_silence[i] != key) {
+		PcmSilence({chunk->data, chunk_size}, format);
+		slot_silence[i] = key;
+	}
+
+	music_buffer_used.fetch_add(1, std::memory_order_relaxed);
+	return chunk;
 }
 
 void
@@ -39,12 +121,15 @@ MusicBuffer::Return(MusicChunk *chunk) noexcept
 {
 	assert(chunk != nullptr);
 
-	const std::lock_guard<Mutex> protect(mutex);
+	unsigned n = 1;
 
 	if (chunk->other != nullptr) {
 		assert(chunk->other->other == nullptr);
 		buffer.Free(chunk->other);
+		++n;
 	}
 
 	buffer.Free(chunk);
+
+	music_buffer_used.fetch_sub(n, std::memory_order_relaxed);
 }
@@ -21,19 +21,48 @@
 #define MPD_MUSIC_BUFFER_HXX
 
 #include "util/SliceBuffer.hxx"
-#include "thread/Mutex.hxx"
 
+#include <memory>
+
+enum class SampleFormat : uint8_t;
 struct MusicChunk;
 
 /**
  * An allocator for #MusicChunk objects.
+ *
+ * This class is thread-safe; it is backed by a lock-free
+ * #SliceBuffer.
  */
 class MusicBuffer {
-	/** a mutex which protects #buffer */
-	Mutex mutex;
-
 	SliceBuffer<MusicChunk> buffer;
 
+	/**
+	 * The payload size of one chunk (#music_chunk_size, latched
+	 * at construction time).
+	 */
+	const size_t chunk_size;
+
+	/**
+	 * The payload arena: #chunk_size bytes per chunk, referenced
+	 * by MusicChunk::data.  Kept out of the #MusicChunk struct so
+	 * the payload size can be configured at runtime.
+	 */
+	HugeArray<uint8_t> payload;
+
+	/**
+	 * Tracks which payload slots still hold a full chunk of
+	 * silence, and for which #SampleFormat (stored with an offset
+	 * of one; zero means "unknown contents").  AllocateSilence()
+	 * uses this to skip re-clearing a recycled slot whose previous
+	 * user was also a silence chunk, which is the common case
+	 * while the player idles waiting for the decoder.
+	 *
+	 * Each entry is only accessed by the thread currently owning
+	 * the slot; the SliceBuffer free list provides the necessary
+	 * release/acquire ordering when a slot changes hands.
+	 */
+	const std::unique_ptr<uint8_t[]> slot_silence;
+
 public:
 	/**
 	 * Creates a new #MusicBuffer object.
@@ -43,11 +72,12 @@ public:
 	 */
 	MusicBuffer(unsigned num_chunks) noexcept;
 
+	~MusicBuffer() noexcept;
+
 #ifndef NDEBUG
 	/**
-	 * Check whether the buffer is empty.  This call is not
-	 * protected with the mutex, and may only be used while this
-	 * object is inaccessible to other threads.
+	 * Check whether the buffer is empty.  This call may only be
+	 * used while this object is inaccessible to other threads.
 	 */
 	bool IsEmptyUnsafe() const {
 		return buffer.empty();
@@ -64,6 +94,15 @@ public:
 		return buffer.GetCapacity();
 	}
 
+	/**
+	 * Returns the number of chunks which are currently free.  The
+	 * value may be stale already when this method returns.
+	 */
+	gcc_pure
+	unsigned GetFreeCount() const noexcept {
+		return buffer.GetFreeCount();
+	}
+
 	/**
 	 * Allocates a chunk from the buffer.  When it is not used anymore,
 	 * call Return().
@@ -73,6 +112,17 @@ public:
 	 */
 	MusicChunk *Allocate() noexcept;
 
+	/**
+	 * Like Allocate(), but the returned chunk's whole payload is
+	 * filled with silence for the given sample format; the caller
+	 * still sets MusicChunk::length.  The actual write is skipped
+	 * when the recycled slot is known to contain silence already.
+	 *
+	 * @return a silence chunk or nullptr if there are no chunks
+	 * available
+	 */
+	MusicChunk *AllocateSilence(SampleFormat format) noexcept;
+
 	/**
 	 * Returns a chunk to the buffer.  It can be reused by
 	 * Allocate() then.
@@ -80,4 +130,19 @@ public:
 	void Return(MusicChunk *chunk) noexcept;
 };
 
+/**
+ * Returns the total number of chunks in all #MusicBuffer instances,
+ * for memory telemetry.
+ */
+unsigned
+music_buffer_get_total() noexcept;
+
+/**
+ * Returns the number of chunks currently allocated from all
+ * #MusicBuffer instances.  The value may be stale already when this
+ * function returns.
+ */
+unsigned
+music_buffer_get_used() noexcept;
+
 #endif
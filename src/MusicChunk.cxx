@@ -24,6 +24,8 @@
 
 #include <assert.h>
 
+size_t music_chunk_size = CHUNK_SIZE;
+
 MusicChunk::MusicChunk() noexcept = default;
 MusicChunk::~MusicChunk() noexcept = default;
 
@@ -57,7 +59,7 @@ MusicChunk::Write(const AudioFormat af,
 	}
 
 	const size_t frame_size = af.GetFrameSize();
-	size_t num_frames = (sizeof(data) - length) / frame_size;
+	size_t num_frames = (capacity - length) / frame_size;
 	return { data + length, num_frames * frame_size };
 }
 
@@ -66,10 +68,10 @@ MusicChunk::Expand(const AudioFormat af, size_t _length) noexcept
 {
 	const size_t frame_size = af.GetFrameSize();
 
-	assert(length + _length <= sizeof(data));
+	assert(length + _length <= capacity);
 	assert(audio_format == af);
 
 	length += _length;
 
-	return length + frame_size > sizeof(data);
+	return length + frame_size > capacity;
 }
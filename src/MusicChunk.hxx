@@ -22,20 +22,30 @@
 
 #include "Chrono.hxx"
 #include "ReplayGainInfo.hxx"
-#include "util/WritableBuffer.hxx"
-
-#ifndef NDEBUG
 #include "AudioFormat.hxx"
-#endif
+#include "util/WritableBuffer.hxx"
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 
 #include <stdint.h>
 #include <stddef.h>
 
+/**
+ * The default #MusicChunk payload size (see #music_chunk_size).
+ */
 static constexpr size_t CHUNK_SIZE = 4096;
 
-struct AudioFormat;
+/**
+ * The configured payload size of a #MusicChunk
+ * ("audio_chunk_size").  It is set once during startup, before the
+ * first #MusicBuffer is created.  Larger chunks reduce the per-chunk
+ * overhead (locking, filter calls) of high sample rate streams at
+ * the cost of a coarser buffer granularity.
+ */
+extern size_t music_chunk_size;
+
 struct Tag;
 
 /**
@@ -43,8 +53,10 @@ struct Tag;
  * MusicPipe::Push() caller.
  */
 struct MusicChunk {
-	/** the next chunk in a linked list */
-	MusicChunk *next;
+	/** the next chunk in a linked list; atomic because
+	    MusicPipe::Push() publishes the chunk through this
+	    attribute without locking a mutex */
+	std::atomic<MusicChunk *> next;
 
 	/**
 	 * An optional chunk which should be mixed into this chunk.
@@ -67,6 +79,15 @@ struct MusicChunk {
 	/** the time stamp within the song */
 	SignedSongTime time;
 
+	/**
+	 * The monotonic clock time stamp at which this chunk was
+	 * pushed into the #MusicPipe by the decoder (or allocated as
+	 * a silence chunk by the player).  Used by the "latencyinfo"
+	 * command to measure pipeline latency.  The epoch value means
+	 * "unknown".
+	 */
+	std::chrono::steady_clock::time_point decode_time;
+
 	/**
 	 * An optional tag associated with this chunk (and the
 	 * following chunks); appears at song boundaries.
@@ -94,8 +115,45 @@ struct MusicChunk {
 	 */
 	unsigned replay_gain_serial;
 
-	/** the data (probably PCM) */
-	uint8_t data[CHUNK_SIZE];
+	/** the data (probably PCM); points into the payload arena of
+	    the #MusicBuffer which owns this chunk */
+	uint8_t *data;
+
+	/** the allocated size of #data, i.e. #music_chunk_size */
+	size_t capacity;
+
+	/**
+	 * The state of the shared conversion cache (see
+	 * #converted_data).
+	 */
+	enum class ConvertedState : uint8_t {
+		/** no cached conversion */
+		EMPTY,
+
+		/** an output thread is currently converting */
+		BUSY,
+
+		/** #converted_data is valid */
+		READY,
+	};
+
+	/**
+	 * A one-slot cache for a converted copy of this chunk, filled
+	 * by whichever output thread converts the chunk first and
+	 * reused by all other outputs with the same target format
+	 * (see AudioOutputSource::FilterChunkShared()).  The cache
+	 * dies with the chunk, i.e. when it is returned to the
+	 * #MusicBuffer.
+	 */
+	mutable std::atomic<ConvertedState> converted_state{ConvertedState::EMPTY};
+
+	/** the format of #converted_data */
+	mutable AudioFormat converted_format;
+
+	/** the size of #converted_data in bytes */
+	mutable size_t converted_size;
+
+	mutable std::unique_ptr<uint8_t[]> converted_data;
 
 #ifndef NDEBUG
 	AudioFormat audio_format;
@@ -21,15 +21,16 @@
 #include "MusicPipe.hxx"
 #include "MusicBuffer.hxx"
 #include "MusicChunk.hxx"
+#include "Tracepoint.hxx"
 
 #ifndef NDEBUG
 
 bool
 MusicPipe::Contains(const MusicChunk *chunk) const noexcept
 {
-	const std::lock_guard<Mutex> protect(mutex);
-
-	for (const MusicChunk *i = head; i != nullptr; i = i->next)
+	for (const MusicChunk *i = head.load(std::memory_order_acquire);
+	     i != nullptr;
+	     i = i->next.load(std::memory_order_acquire))
 		if (i == chunk)
 			return true;
 
@@ -41,31 +42,48 @@ MusicPipe::Contains(const MusicChunk *chunk) const noexcept
 MusicChunk *
 MusicPipe::Shift() noexcept
 {
-	const std::lock_guard<Mutex> protect(mutex);
-
-	MusicChunk *chunk = head;
+	MusicChunk *chunk = head.load(std::memory_order_acquire);
 	if (chunk != nullptr) {
 		assert(!chunk->IsEmpty());
 
-		head = chunk->next;
-		--size;
-
-		if (head == nullptr) {
-			assert(size == 0);
-			assert(tail_r == &chunk->next);
-
-			tail_r = &head;
+		MusicChunk *next = chunk->next.load(std::memory_order_acquire);
+		if (next != nullptr) {
+			head.store(next, std::memory_order_release);
 		} else {
-			assert(size > 0);
-			assert(tail_r != &chunk->next);
+			/* this appears to be the last chunk: declare
+			   the pipe empty, then try to reset the tail;
+			   the order matters, because the producer
+			   writes #head after it has seen the empty
+			   tail */
+			head.store(nullptr, std::memory_order_release);
+
+			MusicChunk *expected = chunk;
+			if (!tail.compare_exchange_strong(expected, nullptr,
+							  std::memory_order_acq_rel)) {
+				/* meanwhile, the producer has
+				   appended another chunk; wait for
+				   its "next" link to appear */
+				while ((next = chunk->next.load(std::memory_order_acquire)) == nullptr)
+					;
+
+				head.store(next, std::memory_order_release);
+			}
 		}
 
-#ifndef NDEBUG
-		/* poison the "next" reference */
-		chunk->next = (MusicChunk *)(void *)0x01010101;
+		size.fetch_sub(1, std::memory_order_relaxed);
 
-		if (size == 0)
-			audio_format.Clear();
+#ifndef NDEBUG
+		/* poison the "next" reference; the producer never
+		   touches a chunk again after its successor has
+		   become visible */
+		chunk->next.store((MusicChunk *)(void *)0x01010101,
+				  std::memory_order_relaxed);
+
+		{
+			const std::lock_guard<Mutex> protect(mutex);
+			if (IsEmpty())
+				audio_format.Clear();
+		}
 #endif
 	}
 
@@ -87,20 +105,31 @@ MusicPipe::Push(MusicChunk *chunk) noexcept
 	assert(!chunk->IsEmpty());
 	assert(chunk->length == 0 || chunk->audio_format.IsValid());
 
-	const std::lock_guard<Mutex> protect(mutex);
+#ifndef NDEBUG
+	{
+		const std::lock_guard<Mutex> protect(mutex);
 
-	assert(size > 0 || !audio_format.IsDefined());
-	assert(!audio_format.IsDefined() ||
-	       chunk->CheckFormat(audio_format));
+		assert(!audio_format.IsDefined() ||
+		       chunk->CheckFormat(audio_format));
 
-#ifndef NDEBUG
-	if (!audio_format.IsDefined() && chunk->length > 0)
-		audio_format = chunk->audio_format;
+		if (!audio_format.IsDefined() && chunk->length > 0)
+			audio_format = chunk->audio_format;
+	}
 #endif
 
-	chunk->next = nullptr;
-	*tail_r = chunk;
-	tail_r = &chunk->next;
+	chunk->next.store(nullptr, std::memory_order_relaxed);
+
+	MusicChunk *old_tail = tail.exchange(chunk,
+					     std::memory_order_acq_rel);
+	if (old_tail != nullptr)
+		/* append to the previous tail; a consumer blocked in
+		   Shift() may be waiting for this link */
+		old_tail->next.store(chunk, std::memory_order_release);
+	else
+		/* the pipe was empty; publish the new head */
+		head.store(chunk, std::memory_order_release);
+
+	size.fetch_add(1, std::memory_order_relaxed);
 
-	++size;
+	MPD_PROBE2(chunk_push, this, chunk->length);
 }
@@ -20,13 +20,15 @@
 #ifndef MPD_PIPE_H
 #define MPD_PIPE_H
 
-#include "thread/Mutex.hxx"
 #include "Compiler.h"
 
 #ifndef NDEBUG
+#include "thread/Mutex.hxx"
 #include "AudioFormat.hxx"
 #endif
 
+#include <atomic>
+
 #include <assert.h>
 
 struct MusicChunk;
@@ -35,21 +37,41 @@ class MusicBuffer;
 /**
  * A queue of #MusicChunk objects.  One party appends chunks at the
  * tail, and the other consumes them from the head.
+ *
+ * This class is lock-free: it is a single-producer/single-consumer
+ * queue, i.e. Push() may be called by one thread while another thread
+ * calls Shift(), without locking a mutex.  Peek() and GetSize() may
+ * be called by any thread.
  */
 class MusicPipe {
-	/** the first chunk */
-	MusicChunk *head = nullptr;
-
-	/** a pointer to the tail of the chunk */
-	MusicChunk **tail_r = &head;
+	/**
+	 * The first chunk.  Modified by the consumer; separated from
+	 * #tail by explicit padding to avoid false sharing.
+	 */
+	std::atomic<MusicChunk *> head{nullptr};
 
 	/** the current number of chunks */
-	unsigned size = 0;
+	std::atomic<unsigned> size{0};
 
-	/** a mutex which protects #head and #tail_r */
-	mutable Mutex mutex;
+	/**
+	 * Padding which keeps #head and #tail at least one cache
+	 * line apart.  Explicit padding instead of alignas(),
+	 * because plain C++14 "operator new" does not guarantee
+	 * extended alignment, and #MusicPipe instances are always
+	 * heap-allocated.
+	 */
+	char padding[64];
+
+	/**
+	 * The last chunk.  Modified by the producer (and reset by the
+	 * consumer when it removes the last chunk).
+	 */
+	std::atomic<MusicChunk *> tail{nullptr};
 
 #ifndef NDEBUG
+	/** a mutex which protects #audio_format */
+	mutable Mutex mutex;
+
 	AudioFormat audio_format = AudioFormat::Undefined();
 #endif
 
@@ -65,8 +87,8 @@ public:
 	 * Frees the object.  It must be empty now.
 	 */
 	~MusicPipe() {
-		assert(head == nullptr);
-		assert(tail_r == &head);
+		assert(head.load() == nullptr);
+		assert(tail.load() == nullptr);
 	}
 
 	MusicPipe &operator=(const MusicPipe &) = delete;
@@ -93,9 +115,8 @@ public:
 	 * Returns the first #MusicChunk from the pipe.  Returns
 	 * nullptr if the pipe is empty.
 	 */
-	gcc_pure
 	const MusicChunk *Peek() const noexcept {
-		return head;
+		return head.load(std::memory_order_acquire);
 	}
 
 	/**
@@ -118,12 +139,10 @@ public:
 	/**
 	 * Returns the number of chunks currently in this pipe.
 	 */
-	gcc_pure
 	unsigned GetSize() const noexcept {
-		return size;
+		return size.load(std::memory_order_relaxed);
 	}
 
-	gcc_pure
 	bool IsEmpty() const noexcept {
 		return GetSize() == 0;
 	}
@@ -21,6 +21,8 @@
 #include "Partition.hxx"
 #include "Instance.hxx"
 #include "DetachedSong.hxx"
+#include "config/ConfigGlobal.hxx"
+#include "config/ConfigOption.hxx"
 #include "mixer/Volume.hxx"
 #include "IdleFlags.hxx"
 
@@ -29,6 +31,7 @@ Partition::Partition(Instance &_instance,
 		     unsigned max_length,
 		     unsigned buffer_chunks,
 		     unsigned buffered_before_play,
+		     unsigned buffer_reserve_time,
 		     AudioFormat configured_audio_format,
 		     const ReplayGainConfig &replay_gain_config)
 	:instance(_instance),
@@ -37,8 +40,11 @@ Partition::Partition(Instance &_instance,
 	 playlist(max_length, *this),
 	 outputs(*this),
 	 pc(*this, outputs, buffer_chunks, buffered_before_play,
-	    configured_audio_format, replay_gain_config)
+	    buffer_reserve_time, configured_audio_format, replay_gain_config)
 {
+	playlist.reject_duplicates =
+		config_get_bool(ConfigOption::REJECT_DUPLICATES, false);
+
 	UpdateEffectiveReplayGainMode();
 }
 
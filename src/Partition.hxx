@@ -64,6 +64,7 @@ struct Partition final : QueueListener, PlayerListener, MixerListener {
 		  unsigned max_length,
 		  unsigned buffer_chunks,
 		  unsigned buffered_before_play,
+		  unsigned buffer_reserve_time,
 		  AudioFormat configured_audio_format,
 		  const ReplayGainConfig &replay_gain_config);
 
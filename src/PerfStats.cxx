@@ -0,0 +1,93 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "PerfStats.hxx"
+#include "client/Response.hxx"
+
+#include <inttypes.h>
+
+PerfStats perf_stats;
+
+/**
+ * Find the upper bound (in microseconds) of the bucket which contains
+ * the given percentile.
+ */
+static uint64_t
+HistogramPercentile(const uint64_t counts[], unsigned n,
+		    uint64_t total, unsigned percent) noexcept
+{
+	const uint64_t threshold = (total * percent + 99) / 100;
+
+	uint64_t sum = 0;
+	for (unsigned i = 0; i < n; ++i) {
+		sum += counts[i];
+		if (sum >= threshold)
+			return uint64_t(1) << i;
+	}
+
+	return uint64_t(1) << (n - 1);
+}
+
+void
+PerfLatencyHistogram::Print(Response &r, const char *name) const noexcept
+{
+	uint64_t counts[N_BUCKETS];
+	uint64_t total = 0;
+
+	for (unsigned i = 0; i < N_BUCKETS; ++i) {
+		counts[i] = buckets[i].load(std::memory_order_relaxed);
+		total += counts[i];
+	}
+
+	r.Format("%s_count: %" PRIu64 "\n", name, total);
+	if (total == 0)
+		return;
+
+	r.Format("%s_p50_us: %" PRIu64 "\n", name,
+		 HistogramPercentile(counts, N_BUCKETS, total, 50));
+	r.Format("%s_p90_us: %" PRIu64 "\n", name,
+		 HistogramPercentile(counts, N_BUCKETS, total, 90));
+	r.Format("%s_p99_us: %" PRIu64 "\n", name,
+		 HistogramPercentile(counts, N_BUCKETS, total, 99));
+}
+
+void
+PerfFillHistogram::Print(Response &r, const char *name) const noexcept
+{
+	for (unsigned i = 0; i < N_BUCKETS; ++i)
+		r.Format("%s_%u_%u: %" PRIu64 "\n",
+			 name,
+			 i * 100 / N_BUCKETS, (i + 1) * 100 / N_BUCKETS,
+			 buckets[i].load(std::memory_order_relaxed));
+}
+
+void
+perf_stats_print(Response &r) noexcept
+{
+	r.Format("decoder_chunks: %" PRIu64 "\n",
+		 perf_stats.decoder_chunks.load(std::memory_order_relaxed));
+	r.Format("decoder_bytes: %" PRIu64 "\n",
+		 perf_stats.decoder_bytes.load(std::memory_order_relaxed));
+
+	perf_stats.buffer_fill.Print(r, "buffer_fill");
+	perf_stats.play_latency.Print(r, "play_latency");
+	perf_stats.convert_latency.Print(r, "convert_latency");
+	perf_stats.loop_latency.Print(r, "loop_latency");
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_PERF_STATS_HXX
+#define MPD_PERF_STATS_HXX
+
+#include <atomic>
+#include <chrono>
+
+#include <stdint.h>
+
+class Response;
+
+/**
+ * A latency histogram with power-of-two microsecond buckets.  All
+ * accesses use relaxed atomics, so recording a sample on a hot path
+ * costs only a clock read and one increment.
+ */
+class PerfLatencyHistogram {
+	static constexpr unsigned N_BUCKETS = 24;
+
+	std::atomic<uint64_t> buckets[N_BUCKETS];
+
+public:
+	void Record(std::chrono::steady_clock::duration d) noexcept {
+		auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+		unsigned bucket = 0;
+		while (us > 1 && bucket < N_BUCKETS - 1) {
+			us >>= 1;
+			++bucket;
+		}
+
+		buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/**
+	 * Print the number of samples and approximate percentiles
+	 * (the upper bucket bound, in microseconds).
+	 */
+	void Print(Response &r, const char *name) const noexcept;
+};
+
+/**
+ * A histogram of buffer utilization, in sixteenths of the capacity.
+ */
+class PerfFillHistogram {
+	static constexpr unsigned N_BUCKETS = 16;
+
+	std::atomic<uint64_t> buckets[N_BUCKETS];
+
+public:
+	void Record(unsigned used, unsigned capacity) noexcept {
+		if (capacity == 0)
+			return;
+
+		unsigned bucket = used * N_BUCKETS / capacity;
+		if (bucket >= N_BUCKETS)
+			bucket = N_BUCKETS - 1;
+
+		buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void Print(Response &r, const char *name) const noexcept;
+};
+
+/**
+ * Global performance counters for the playback hot paths, updated
+ * with relaxed atomics and exposed by the "perfstats" protocol
+ * command.  All counters are cumulative since startup.
+ */
+struct PerfStats {
+	/**
+	 * The number of (non-empty) chunks and bytes the decoder has
+	 * pushed into the music pipe.
+	 */
+	std::atomic<uint64_t> decoder_chunks;
+	std::atomic<uint64_t> decoder_bytes;
+
+	/**
+	 * #MusicBuffer utilization, sampled by the player thread
+	 * before each chunk it plays.
+	 */
+	PerfFillHistogram buffer_fill;
+
+	/**
+	 * How long one AudioOutput::Play() call blocks the output
+	 * thread.
+	 */
+	PerfLatencyHistogram play_latency;
+
+	/**
+	 * How long the output thread spends filtering/converting one
+	 * chunk.
+	 */
+	PerfLatencyHistogram convert_latency;
+
+	/**
+	 * How long one handler invocation blocks the main
+	 * #EventLoop.  Only collected while the event_loop_budget
+	 * setting is configured.
+	 */
+	PerfLatencyHistogram loop_latency;
+};
+
+extern PerfStats perf_stats;
+
+/**
+ * Print all counters in protocol format.
+ */
+void
+perf_stats_print(Response &r) noexcept;
+
+#endif
@@ -20,7 +20,7 @@
 #include "config.h"
 #include "PlaylistDatabase.hxx"
 #include "db/PlaylistVector.hxx"
-#include "fs/io/TextFile.hxx"
+#include "fs/io/LineReader.hxx"
 #include "fs/io/BufferedOutputStream.hxx"
 #include "util/StringStrip.hxx"
 #include "util/ChronoUtil.hxx"
@@ -42,7 +42,7 @@ playlist_vector_save(BufferedOutputStream &os, const PlaylistVector &pv)
 }
 
 void
-playlist_metadata_load(TextFile &file, PlaylistVector &pv, const char *name)
+playlist_metadata_load(LineReader &file, PlaylistVector &pv, const char *name)
 {
 	PlaylistInfo pm(name);
 
@@ -26,7 +26,7 @@
 
 class PlaylistVector;
 class BufferedOutputStream;
-class TextFile;
+class LineReader;
 
 void
 playlist_vector_save(BufferedOutputStream &os, const PlaylistVector &pv);
@@ -35,6 +35,6 @@ playlist_vector_save(BufferedOutputStream &os, const PlaylistVector &pv);
  * Throws #std::runtime_error on error.
  */
 void
-playlist_metadata_load(TextFile &file, PlaylistVector &pv, const char *name);
+playlist_metadata_load(LineReader &file, PlaylistVector &pv, const char *name);
 
 #endif
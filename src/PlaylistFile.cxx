@@ -43,6 +43,7 @@
 #include "util/StringCompare.hxx"
 #include "util/UriUtil.hxx"
 
+#include <algorithm>
 #include <memory>
 
 #include <assert.h>
@@ -201,6 +202,16 @@ try {
 
 	TextFile file(path_fs);
 
+	try {
+		/* reserve the vector from a rough size estimate to
+		   avoid repeated reallocations while loading very
+		   large playlists */
+		const FileInfo fi(path_fs);
+		contents.reserve(std::min<uint64_t>(fi.GetSize() / 32 + 1,
+						    playlist_max_length));
+	} catch (...) {
+	}
+
 	char *s;
 	while ((s = file.ReadLine()) != nullptr) {
 		if (*s == 0 || *s == PLAYLIST_COMMENT)
@@ -90,6 +90,13 @@ playlist_print_find(Response &r, const playlist &playlist,
 	queue_find(r, playlist.queue, filter);
 }
 
+void
+playlist_print_find_uri(Response &r, const playlist &playlist,
+			const char *uri)
+{
+	queue_find_uri(r, playlist.queue, uri);
+}
+
 void
 playlist_print_changes_info(Response &r, const playlist &playlist,
 			    uint32_t version,
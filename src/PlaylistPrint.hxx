@@ -67,6 +67,14 @@ void
 playlist_print_find(Response &r, const playlist &playlist,
 		    const SongFilter &filter);
 
+/**
+ * Find songs in the playlist by their exact URI, using the queue's
+ * URI index.
+ */
+void
+playlist_print_find_uri(Response &r, const playlist &playlist,
+			const char *uri);
+
 /**
  * Print detailed changes since the specified playlist version.
  */
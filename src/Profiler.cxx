@@ -0,0 +1,372 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * A built-in sampling profiler for production machines where
+ * attaching "perf" is not possible.  A sampler thread periodically
+ * sends SIGPROF to all registered threads; the signal handler walks
+ * the frame-pointer chain of the interrupted thread into a
+ * preallocated ring of samples, and "profile stop" folds them into
+ * one line per unique stack.  Build with -fno-omit-frame-pointer
+ * (and -rdynamic for symbol names) for useful results.
+ */
+
+#include "config.h"
+#include "Profiler.hxx"
+#include "client/Response.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/Thread.hxx"
+#include "thread/Name.hxx"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifndef _WIN32
+
+#include <atomic>
+#include <map>
+#include <string>
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+static constexpr unsigned MAX_THREADS = 16;
+static constexpr unsigned MAX_DEPTH = 24;
+static constexpr unsigned RING_SIZE = 16384;
+
+struct ProfilerTarget {
+	pthread_t handle;
+
+	/**
+	 * The stack bounds of this thread; the signal handler only
+	 * dereferences candidate frame pointers inside this range.
+	 */
+	const char *stack_base;
+	size_t stack_size;
+
+	char name[16];
+
+	bool used;
+};
+
+struct ProfilerSample {
+	uint8_t thread, depth;
+	void *pc[MAX_DEPTH];
+};
+
+static Mutex profiler_mutex;
+static ProfilerTarget profiler_targets[MAX_THREADS];
+
+/**
+ * This thread's slot in #profiler_targets, or -1 if it is not
+ * registered.  The signal handler uses it to attribute its sample.
+ */
+static thread_local int profiler_slot = -1;
+
+static std::atomic_bool profiler_running{false};
+static ProfilerSample *profiler_ring;
+static std::atomic_uint profiler_ring_head;
+static unsigned profiler_interval_us;
+
+/**
+ * Thread names captured when the session was started; registry
+ * slots may be reused while the profiler runs.
+ */
+static char profiler_session_names[MAX_THREADS][16];
+
+static struct sigaction profiler_old_sigprof;
+
+ProfilerThreadScope::ProfilerThreadScope(const char *name) noexcept
+	:slot(-1)
+{
+	const char *stack_base = nullptr;
+	size_t stack_size = 0;
+
+	pthread_attr_t attr;
+	if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+		void *base;
+		if (pthread_attr_getstack(&attr, &base, &stack_size) == 0)
+			stack_base = (const char *)base;
+		pthread_attr_destroy(&attr);
+	}
+
+	const std::lock_guard<Mutex> protect(profiler_mutex);
+
+	for (unsigned i = 0; i < MAX_THREADS; ++i) {
+		auto &t = profiler_targets[i];
+		if (t.used)
+			continue;
+
+		t.handle = pthread_self();
+		t.stack_base = stack_base;
+		t.stack_size = stack_size;
+		snprintf(t.name, sizeof(t.name), "%s", name);
+		t.used = true;
+
+		slot = i;
+		profiler_slot = i;
+		break;
+	}
+}
+
+ProfilerThreadScope::~ProfilerThreadScope() noexcept
+{
+	if (slot < 0)
+		return;
+
+	const std::lock_guard<Mutex> protect(profiler_mutex);
+	profiler_targets[slot].used = false;
+	profiler_slot = -1;
+}
+
+static void
+profiler_signal_handler(int, siginfo_t *, void *_ctx) noexcept
+{
+	/* async-signal context: only reads of globals, TLS and the
+	   preallocated ring below */
+
+	if (!profiler_running.load(std::memory_order_relaxed))
+		return;
+
+	const int slot = profiler_slot;
+	if (slot < 0)
+		return;
+
+	auto &sample =
+		profiler_ring[profiler_ring_head.fetch_add(1, std::memory_order_relaxed)
+			      % RING_SIZE];
+	sample.thread = slot;
+
+	unsigned depth = 0;
+
+	const auto &uc = *(const ucontext_t *)_ctx;
+	const char *fp;
+#if defined(__linux__) && defined(__x86_64__)
+	sample.pc[depth++] = (void *)uc.uc_mcontext.gregs[REG_RIP];
+	fp = (const char *)uc.uc_mcontext.gregs[REG_RBP];
+#elif defined(__linux__) && defined(__aarch64__)
+	sample.pc[depth++] = (void *)uc.uc_mcontext.pc;
+	fp = (const char *)uc.uc_mcontext.regs[29];
+#else
+	/* no frame-pointer walk on this architecture; the sample
+	   will be empty */
+	fp = nullptr;
+#endif
+
+	const auto &target = profiler_targets[slot];
+	const char *const stack_lo = target.stack_base;
+	const char *const stack_hi = target.stack_base != nullptr
+		? target.stack_base + target.stack_size - 2 * sizeof(void *)
+		: nullptr;
+
+	/* each frame starts with the caller's frame pointer,
+	   followed by the return address */
+	while (depth < MAX_DEPTH &&
+	       fp >= stack_lo && fp < stack_hi && stack_lo != nullptr &&
+	       (uintptr_t)fp % sizeof(void *) == 0) {
+		void *ret = *((void *const *)fp + 1);
+		if (ret == nullptr)
+			break;
+
+		sample.pc[depth++] = ret;
+
+		const char *next = *(const char *const *)fp;
+		if (next <= fp)
+			break;
+
+		fp = next;
+	}
+
+	sample.depth = depth;
+}
+
+static void
+profiler_sampler_task() noexcept
+{
+	SetThreadName("profiler");
+
+	while (profiler_running.load(std::memory_order_relaxed)) {
+		{
+			const std::lock_guard<Mutex> protect(profiler_mutex);
+			for (const auto &t : profiler_targets)
+				if (t.used)
+					pthread_kill(t.handle, SIGPROF);
+		}
+
+		usleep(profiler_interval_us);
+	}
+}
+
+static Thread *profiler_sampler_thread;
+
+void
+profiler_start(unsigned hz)
+{
+	if (hz < 1 || hz > 1000)
+		throw std::runtime_error("sampling frequency must be between 1 and 1000 Hz");
+
+	if (profiler_running.load(std::memory_order_relaxed))
+		throw std::runtime_error("profiler is already running");
+
+	profiler_ring = new ProfilerSample[RING_SIZE];
+	profiler_ring_head.store(0, std::memory_order_relaxed);
+	profiler_interval_us = 1000000 / hz;
+
+	{
+		const std::lock_guard<Mutex> protect(profiler_mutex);
+		for (unsigned i = 0; i < MAX_THREADS; ++i)
+			snprintf(profiler_session_names[i],
+				 sizeof(profiler_session_names[i]), "%s",
+				 profiler_targets[i].used
+				 ? profiler_targets[i].name
+				 : "?");
+	}
+
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_sigaction = profiler_signal_handler;
+	sa.sa_flags = SA_RESTART | SA_SIGINFO;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGPROF, &sa, &profiler_old_sigprof);
+
+	profiler_running.store(true, std::memory_order_release);
+
+	profiler_sampler_thread = new Thread(BIND_FUNCTION(profiler_sampler_task));
+
+	try {
+		profiler_sampler_thread->Start();
+	} catch (...) {
+		profiler_running.store(false, std::memory_order_relaxed);
+		sigaction(SIGPROF, &profiler_old_sigprof, nullptr);
+		delete profiler_sampler_thread;
+		profiler_sampler_thread = nullptr;
+		delete[] profiler_ring;
+		profiler_ring = nullptr;
+		throw;
+	}
+}
+
+/**
+ * Render one program counter as a symbol name, or as module+offset
+ * if the symbol is not exported (use addr2line to map those).
+ */
+static std::string
+profiler_symbolize(void *pc) noexcept
+{
+	Dl_info info;
+	if (dladdr(pc, &info) != 0) {
+		if (info.dli_sname != nullptr)
+			return info.dli_sname;
+
+		if (info.dli_fname != nullptr) {
+			const char *slash = strrchr(info.dli_fname, '/');
+			const char *module = slash != nullptr
+				? slash + 1 : info.dli_fname;
+
+			char buffer[256];
+			snprintf(buffer, sizeof(buffer), "%s+0x%zx",
+				 module,
+				 (size_t)((const char *)pc -
+					  (const char *)info.dli_fbase));
+			return buffer;
+		}
+	}
+
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%p", pc);
+	return buffer;
+}
+
+void
+profiler_stop(Response &r)
+{
+	if (!profiler_running.load(std::memory_order_relaxed))
+		throw std::runtime_error("profiler is not running");
+
+	profiler_running.store(false, std::memory_order_relaxed);
+	profiler_sampler_thread->Join();
+	delete profiler_sampler_thread;
+	profiler_sampler_thread = nullptr;
+
+	/* give in-flight signal handlers a moment to finish before
+	   the handler is uninstalled and the ring is read */
+	usleep(2 * profiler_interval_us);
+	sigaction(SIGPROF, &profiler_old_sigprof, nullptr);
+
+	const unsigned head = profiler_ring_head.load(std::memory_order_relaxed);
+	const unsigned n = std::min(head, RING_SIZE);
+
+	std::map<std::string, unsigned> folded;
+
+	for (unsigned i = 0; i < n; ++i) {
+		const auto &sample = profiler_ring[i];
+		if (sample.thread >= MAX_THREADS)
+			continue;
+
+		std::string line = profiler_session_names[sample.thread];
+
+		/* outermost frame first, as flamegraph tools
+		   expect */
+		for (unsigned j = sample.depth; j > 0; --j) {
+			line += ';';
+			line += profiler_symbolize(sample.pc[j - 1]);
+		}
+
+		++folded[line];
+	}
+
+	delete[] profiler_ring;
+	profiler_ring = nullptr;
+
+	r.Format("samples: %u\n", n);
+	if (head > RING_SIZE)
+		r.Format("dropped: %u\n", head - RING_SIZE);
+
+	for (const auto &i : folded)
+		r.Format("stack: %s %u\n", i.first.c_str(), i.second);
+}
+
+#else /* _WIN32 */
+
+ProfilerThreadScope::ProfilerThreadScope(const char *) noexcept
+	:slot(-1)
+{
+}
+
+ProfilerThreadScope::~ProfilerThreadScope() noexcept = default;
+
+void
+profiler_start(unsigned)
+{
+	throw std::runtime_error("profiling is not supported on this platform");
+}
+
+void
+profiler_stop(Response &)
+{
+	throw std::runtime_error("profiler is not running");
+}
+
+#endif
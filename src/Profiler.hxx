@@ -0,0 +1,62 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_PROFILER_HXX
+#define MPD_PROFILER_HXX
+
+class Response;
+
+/**
+ * Registers the calling thread with the built-in sampling profiler
+ * for the lifetime of this object.  Instantiate one at the top of
+ * each thread function which should show up in profiles.
+ */
+class ProfilerThreadScope {
+	int slot;
+
+public:
+	explicit ProfilerThreadScope(const char *name) noexcept;
+	~ProfilerThreadScope() noexcept;
+
+	ProfilerThreadScope(const ProfilerThreadScope &) = delete;
+	ProfilerThreadScope &operator=(const ProfilerThreadScope &) = delete;
+};
+
+/**
+ * Start sampling the stacks of all registered threads.
+ *
+ * Throws #std::runtime_error if the profiler is already running or
+ * not supported on this platform.
+ *
+ * @param hz the sampling frequency per thread
+ */
+void
+profiler_start(unsigned hz);
+
+/**
+ * Stop sampling and print the collected samples in folded-stack
+ * format ("thread;outer;...;leaf count"), one line per unique
+ * stack, suitable for flamegraph tooling.
+ *
+ * Throws #std::runtime_error if the profiler is not running.
+ */
+void
+profiler_stop(Response &r);
+
+#endif
@@ -60,6 +60,14 @@ struct ReplayGainInfo {
 		track.Clear();
 		album.Clear();
 	}
+
+	/**
+	 * Create an instance with "undefined" values, for use as
+	 * initializer.
+	 */
+	static constexpr ReplayGainInfo Undefined() noexcept {
+		return { {-200.0f, 0.0f}, {-200.0f, 0.0f} };
+	}
 };
 
 #endif
@@ -22,6 +22,7 @@
 #include "db/LightSong.hxx"
 #include "DetachedSong.hxx"
 #include "tag/ParseName.hxx"
+#include "tag/Pool.hxx"
 #include "util/ChronoUtil.hxx"
 #include "util/ConstBuffer.hxx"
 #include "util/StringAPI.hxx"
@@ -88,11 +89,27 @@ SongFilter::Item::StringMatch(const char *s) const noexcept
 	}
 }
 
+bool
+SongFilter::Item::StringMatch(const TagItem &item) const noexcept
+{
+	assert(tag != LOCATE_TAG_MODIFIED_SINCE);
+
+#ifdef HAVE_ICU_CASE_FOLD
+	if (fold_case)
+		/* instead of case-folding the value for every
+		   comparison, use the folded copy cached in the tag
+		   pool */
+		return fold_case.IsInFolded(tag_pool_get_folded(item));
+#endif
+
+	return StringMatch(item.value);
+}
+
 bool
 SongFilter::Item::Match(const TagItem &item) const noexcept
 {
 	return (tag == LOCATE_TAG_ANY_TYPE || (unsigned)item.type == tag) &&
-		StringMatch(item.value);
+		StringMatch(item);
 }
 
 bool
@@ -123,7 +140,7 @@ SongFilter::Item::Match(const Tag &_tag) const noexcept
 			   only "artist" exists, use that */
 			for (const auto &item : _tag)
 				if (item.type == TAG_ARTIST &&
-				    StringMatch(item.value))
+				    StringMatch(item))
 					return true;
 		}
 	}
@@ -275,3 +292,16 @@ SongFilter::GetBase() const noexcept
 
 	return nullptr;
 }
+
+std::chrono::system_clock::time_point
+SongFilter::GetModifiedSince() const noexcept
+{
+	auto result = std::chrono::system_clock::time_point::min();
+
+	for (const auto &i : items)
+		if (i.GetTag() == LOCATE_TAG_MODIFIED_SINCE &&
+		    i.GetTime() > result)
+			result = i.GetTime();
+
+	return result;
+}
@@ -88,9 +88,24 @@ public:
 			return value.c_str();
 		}
 
+		/**
+		 * Only valid for #LOCATE_TAG_MODIFIED_SINCE.
+		 */
+		std::chrono::system_clock::time_point GetTime() const {
+			return time;
+		}
+
 		gcc_pure gcc_nonnull(2)
 		bool StringMatch(const char *s) const noexcept;
 
+		/**
+		 * Like StringMatch(), but for a #TagItem which lives
+		 * in the tag pool, whose cached case-folded value can
+		 * be used.
+		 */
+		gcc_pure
+		bool StringMatch(const TagItem &tag_item) const noexcept;
+
 		gcc_pure
 		bool Match(const TagItem &tag_item) const noexcept;
 
@@ -162,6 +177,14 @@ public:
 	 */
 	gcc_pure
 	const char *GetBase() const noexcept;
+
+	/**
+	 * Returns the most recent "modified-since" time stamp in this
+	 * filter, or time_point::min() if there is none.  No song
+	 * older than the returned value can match the filter.
+	 */
+	gcc_pure
+	std::chrono::system_clock::time_point GetModifiedSince() const noexcept;
 };
 
 /**
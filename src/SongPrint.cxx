@@ -26,13 +26,25 @@
 #include "DetachedSong.hxx"
 #include "TimePrint.hxx"
 #include "TagPrint.hxx"
+#include "tag/Tag.hxx"
 #include "client/Response.hxx"
 #include "fs/Traits.hxx"
 #include "util/ChronoUtil.hxx"
 #include "util/UriUtil.hxx"
 
+#include <string.h>
+#include <stdio.h>
+
 #define SONG_FILE "file: "
 
+/* non-tag field ids for the binary song record; ids below 0x80 are
+   #TagType values (see the "binaryoutput" command) */
+static constexpr uint8_t BINARY_FIELD_FILE = 0x80;
+static constexpr uint8_t BINARY_FIELD_LAST_MODIFIED = 0x81;
+static constexpr uint8_t BINARY_FIELD_RANGE = 0x82;
+static constexpr uint8_t BINARY_FIELD_TIME = 0x83;
+static constexpr uint8_t BINARY_FIELD_DURATION = 0x84;
+
 static void
 song_print_uri(Response &r, const char *uri, bool base)
 {
@@ -46,15 +58,81 @@ song_print_uri(Response &r, const char *uri, bool base)
 			uri = allocated.c_str();
 	}
 
-	r.Format(SONG_FILE "%s\n", uri);
+	r.WritePair("file", uri);
+}
+
+static void
+song_binary_uri(Response &r, const char *uri, bool base)
+{
+	std::string allocated;
+
+	if (base) {
+		uri = PathTraitsUTF8::GetBase(uri);
+	} else {
+		allocated = uri_remove_auth(uri);
+		if (!allocated.empty())
+			uri = allocated.c_str();
+	}
+
+	r.BinaryField(BINARY_FIELD_FILE, uri);
+}
+
+static void
+song_binary_uri(Response &r, const LightSong &song, bool base)
+{
+	if (!base && song.directory != nullptr) {
+		const size_t directory_length = strlen(song.directory);
+		const size_t uri_length = strlen(song.uri);
+
+		char buffer[1024];
+		if (directory_length + 1 + uri_length <= sizeof(buffer)) {
+			char *p = buffer;
+			memcpy(p, song.directory, directory_length);
+			p += directory_length;
+			*p++ = '/';
+			memcpy(p, song.uri, uri_length);
+			p += uri_length;
+
+			r.BinaryField(BINARY_FIELD_FILE,
+				      buffer, p - buffer);
+		} else {
+			std::string full(song.directory);
+			full.push_back('/');
+			full.append(song.uri);
+			r.BinaryField(BINARY_FIELD_FILE,
+				      full.data(), full.length());
+		}
+	} else
+		song_binary_uri(r, song.uri, base);
 }
 
 void
 song_print_uri(Response &r, const LightSong &song, bool base)
 {
-	if (!base && song.directory != nullptr)
-		r.Format(SONG_FILE "%s/%s\n", song.directory, song.uri);
-	else
+	if (!base && song.directory != nullptr) {
+		/* assemble the directory and the relative URI into
+		   one line without going through printf */
+		const size_t directory_length = strlen(song.directory);
+		const size_t uri_length = strlen(song.uri);
+
+		char buffer[1024];
+		if (sizeof(SONG_FILE) - 1 + directory_length +
+		    1 + uri_length + 1 <= sizeof(buffer)) {
+			char *p = buffer;
+			memcpy(p, SONG_FILE, sizeof(SONG_FILE) - 1);
+			p += sizeof(SONG_FILE) - 1;
+			memcpy(p, song.directory, directory_length);
+			p += directory_length;
+			*p++ = '/';
+			memcpy(p, song.uri, uri_length);
+			p += uri_length;
+			*p++ = '\n';
+
+			r.Write(buffer, p - buffer);
+		} else
+			r.Format(SONG_FILE "%s/%s\n",
+				 song.directory, song.uri);
+	} else
 		song_print_uri(r, song.uri, base);
 }
 
@@ -64,27 +142,87 @@ song_print_uri(Response &r, const DetachedSong &song, bool base)
 	song_print_uri(r, song.GetURI(), base);
 }
 
-static void
-PrintRange(Response &r, SongTime start_time, SongTime end_time)
+static size_t
+FormatRange(char *buffer, size_t size,
+	    SongTime start_time, SongTime end_time) noexcept
 {
 	const unsigned start_ms = start_time.ToMS();
 	const unsigned end_ms = end_time.ToMS();
 
 	if (end_ms > 0)
-		r.Format("Range: %u.%03u-%u.%03u\n",
-			 start_ms / 1000,
-			 start_ms % 1000,
-			 end_ms / 1000,
-			 end_ms % 1000);
+		return snprintf(buffer, size, "%u.%03u-%u.%03u",
+				start_ms / 1000,
+				start_ms % 1000,
+				end_ms / 1000,
+				end_ms % 1000);
 	else if (start_ms > 0)
-		r.Format("Range: %u.%03u-\n",
-			 start_ms / 1000,
-			 start_ms % 1000);
+		return snprintf(buffer, size, "%u.%03u-",
+				start_ms / 1000,
+				start_ms % 1000);
+	else
+		return 0;
+}
+
+static void
+PrintRange(Response &r, SongTime start_time, SongTime end_time)
+{
+	char buffer[64];
+	if (FormatRange(buffer, sizeof(buffer), start_time, end_time) > 0)
+		r.Format("Range: %s\n", buffer);
+}
+
+static void
+BinaryRange(Response &r, SongTime start_time, SongTime end_time)
+{
+	char buffer[64];
+	const size_t length =
+		FormatRange(buffer, sizeof(buffer), start_time, end_time);
+	if (length > 0)
+		r.BinaryField(BINARY_FIELD_RANGE, buffer, length);
+}
+
+static void
+BinaryLastModified(Response &r,
+		   std::chrono::system_clock::time_point mtime)
+{
+	char buffer[32];
+	time_format_iso8601(buffer, sizeof(buffer),
+			    std::chrono::system_clock::to_time_t(mtime));
+	r.BinaryField(BINARY_FIELD_LAST_MODIFIED, buffer);
+}
+
+static void
+BinaryDuration(Response &r, SignedSongTime duration)
+{
+	char buffer[32];
+	size_t length = snprintf(buffer, sizeof(buffer), "%i",
+				 duration.RoundS());
+	r.BinaryField(BINARY_FIELD_TIME, buffer, length);
+
+	length = snprintf(buffer, sizeof(buffer), "%1.3f",
+			  duration.ToDoubleS());
+	r.BinaryField(BINARY_FIELD_DURATION, buffer, length);
 }
 
 void
 song_print_info(Response &r, const LightSong &song, bool base)
 {
+	if (r.IsBinaryOutput()) {
+		song_binary_uri(r, song, base);
+
+		BinaryRange(r, song.start_time, song.end_time);
+
+		if (!IsNegative(song.mtime))
+			BinaryLastModified(r, song.mtime);
+
+		if (!song.tag->duration.IsNegative())
+			BinaryDuration(r, song.tag->duration);
+
+		tag_print_values_binary(r, *song.tag);
+		r.FlushBinaryRecord();
+		return;
+	}
+
 	song_print_uri(r, song, base);
 
 	PrintRange(r, song.start_time, song.end_time);
@@ -98,6 +236,23 @@ song_print_info(Response &r, const LightSong &song, bool base)
 void
 song_print_info(Response &r, const DetachedSong &song, bool base)
 {
+	if (r.IsBinaryOutput()) {
+		song_binary_uri(r, song.GetURI(), base);
+
+		BinaryRange(r, song.GetStartTime(), song.GetEndTime());
+
+		if (!IsNegative(song.GetLastModified()))
+			BinaryLastModified(r, song.GetLastModified());
+
+		const auto duration = song.GetDuration();
+		if (!duration.IsNegative())
+			BinaryDuration(r, duration);
+
+		tag_print_values_binary(r, song.GetTag());
+		r.FlushBinaryRecord();
+		return;
+	}
+
 	song_print_uri(r, song, base);
 
 	PrintRange(r, song.GetStartTime(), song.GetEndTime());
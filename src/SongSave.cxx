@@ -22,11 +22,12 @@
 #include "db/plugins/simple/Song.hxx"
 #include "DetachedSong.hxx"
 #include "TagSave.hxx"
-#include "fs/io/TextFile.hxx"
+#include "fs/io/LineReader.hxx"
 #include "fs/io/BufferedOutputStream.hxx"
 #include "tag/ParseName.hxx"
 #include "tag/Tag.hxx"
 #include "tag/Builder.hxx"
+#include "ReplayGainInfo.hxx"
 #include "util/ChronoUtil.hxx"
 #include "util/StringStrip.hxx"
 #include "util/RuntimeError.hxx"
@@ -46,6 +47,26 @@ range_save(BufferedOutputStream &os, unsigned start_ms, unsigned end_ms)
 		os.Format("Range: %u-\n", start_ms);
 }
 
+static void
+replay_gain_save(BufferedOutputStream &os, const ReplayGainInfo &rgi)
+{
+	if (rgi.track.IsDefined())
+		os.Format("ReplayGainTrack: %f %f\n",
+			  rgi.track.gain, rgi.track.peak);
+
+	if (rgi.album.IsDefined())
+		os.Format("ReplayGainAlbum: %f %f\n",
+			  rgi.album.gain, rgi.album.peak);
+}
+
+static void
+replay_gain_tuple_load(ReplayGainTuple &tuple, const char *value)
+{
+	char *endptr;
+	tuple.gain = strtod(value, &endptr);
+	tuple.peak = strtod(endptr, nullptr);
+}
+
 void
 song_save(BufferedOutputStream &os, const Song &song)
 {
@@ -55,6 +76,8 @@ song_save(BufferedOutputStream &os, const Song &song)
 
 	tag_save(os, song.tag);
 
+	replay_gain_save(os, song.replay_gain);
+
 	if (!IsNegative(song.mtime))
 		os.Format(SONG_MTIME ": %li\n",
 			  (long)std::chrono::system_clock::to_time_t(song.mtime));
@@ -70,6 +93,8 @@ song_save(BufferedOutputStream &os, const DetachedSong &song)
 
 	tag_save(os, song.GetTag());
 
+	replay_gain_save(os, song.GetReplayGain());
+
 	if (!IsNegative(song.GetLastModified()))
 		os.Format(SONG_MTIME ": %li\n",
 			  (long)std::chrono::system_clock::to_time_t(song.GetLastModified()));
@@ -77,7 +102,7 @@ song_save(BufferedOutputStream &os, const DetachedSong &song)
 }
 
 std::unique_ptr<DetachedSong>
-song_load(TextFile &file, const char *uri)
+song_load(LineReader &file, const char *uri)
 {
 	auto song = std::make_unique<DetachedSong>(uri);
 
@@ -101,6 +126,12 @@ song_load(TextFile &file, const char *uri)
 			tag.SetDuration(SignedSongTime::FromS(atof(value)));
 		} else if (strcmp(line, "Playlist") == 0) {
 			tag.SetHasPlaylist(strcmp(value, "yes") == 0);
+		} else if (strcmp(line, "ReplayGainTrack") == 0) {
+			replay_gain_tuple_load(song->WritableReplayGain().track,
+					       value);
+		} else if (strcmp(line, "ReplayGainAlbum") == 0) {
+			replay_gain_tuple_load(song->WritableReplayGain().album,
+					       value);
 		} else if (strcmp(line, SONG_MTIME) == 0) {
 			song->SetLastModified(std::chrono::system_clock::from_time_t(atoi(value)));
 		} else if (strcmp(line, "Range") == 0) {
@@ -27,7 +27,7 @@
 struct Song;
 class DetachedSong;
 class BufferedOutputStream;
-class TextFile;
+class LineReader;
 
 void
 song_save(BufferedOutputStream &os, const Song &song);
@@ -42,6 +42,6 @@ song_save(BufferedOutputStream &os, const DetachedSong &song);
  * Throws #std::runtime_error on error.
  */
 std::unique_ptr<DetachedSong>
-song_load(TextFile &file, const char *uri);
+song_load(LineReader &file, const char *uri);
 
 #endif
@@ -42,13 +42,14 @@
 #ifdef ENABLE_DATABASE
 
 Song *
-Song::LoadFile(Storage &storage, const char *path_utf8, Directory &parent)
+Song::LoadFile(Storage &storage, const char *path_utf8, Directory &parent,
+	       const StorageFileInfo &info)
 {
 	assert(!uri_has_scheme(path_utf8));
 	assert(strchr(path_utf8, '\n') == nullptr);
 
 	Song *song = NewFile(path_utf8, parent);
-	if (!song->UpdateFile(storage)) {
+	if (!song->UpdateFile(storage, info)) {
 		song->Free();
 		return nullptr;
 	}
@@ -61,30 +62,24 @@ Song::LoadFile(Storage &storage, const char *path_utf8, Directory &parent)
 #ifdef ENABLE_DATABASE
 
 bool
-Song::UpdateFile(Storage &storage)
+Song::UpdateFile(Storage &storage, const StorageFileInfo &info)
 {
 	const auto &relative_uri = GetURI();
 
-	StorageFileInfo info;
-	try {
-		info = storage.GetInfo(relative_uri.c_str(), true);
-	} catch (...) {
-		return false;
-	}
-
 	if (!info.IsRegular())
 		return false;
 
-	TagBuilder tag_builder;
+	TagBuilder &tag_builder = GetScratchTagBuilder();
 
 	const auto path_fs = storage.MapFS(relative_uri.c_str());
 	if (path_fs.IsNull()) {
 		const auto absolute_uri =
 			storage.MapUTF8(relative_uri.c_str());
-		if (!tag_stream_scan(absolute_uri.c_str(), tag_builder))
+		if (!tag_stream_scan(absolute_uri.c_str(), tag_builder,
+				     replay_gain))
 			return false;
 	} else {
-		if (!tag_file_scan(path_fs, tag_builder))
+		if (!tag_file_scan(path_fs, tag_builder, replay_gain))
 			return false;
 	}
 
@@ -130,7 +125,7 @@ Song::UpdateFileInArchive(ArchiveFile &archive)
 		path_utf8.insert(0, directory->GetName());
 	}
 
-	TagBuilder tag_builder;
+	TagBuilder &tag_builder = GetScratchTagBuilder();
 	if (!tag_archive_scan(archive, path_utf8.c_str(), tag_builder))
 		return false;
 
@@ -147,8 +142,8 @@ DetachedSong::LoadFile(Path path)
 	if (!GetFileInfo(path, fi) || !fi.IsRegular())
 		return false;
 
-	TagBuilder tag_builder;
-	if (!tag_file_scan(path, tag_builder))
+	TagBuilder &tag_builder = GetScratchTagBuilder();
+	if (!tag_file_scan(path, tag_builder, replay_gain))
 		return false;
 
 	mtime = fi.GetModificationTime();
@@ -167,8 +162,8 @@ DetachedSong::Update()
 
 		return LoadFile(path_fs);
 	} else if (IsRemote()) {
-		TagBuilder tag_builder;
-		if (!tag_stream_scan(uri.c_str(), tag_builder))
+		TagBuilder &tag_builder = GetScratchTagBuilder();
+		if (!tag_stream_scan(uri.c_str(), tag_builder, replay_gain))
 			return false;
 
 		mtime = std::chrono::system_clock::time_point::min();
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "StartupTiming.hxx"
+#include "client/Response.hxx"
+#include "util/Domain.hxx"
+#include "Log.hxx"
+
+#include <chrono>
+
+static constexpr Domain startup_domain("startup");
+
+struct StartupPhase {
+	const char *name;
+	std::chrono::steady_clock::duration duration;
+};
+
+static constexpr unsigned MAX_STARTUP_PHASES = 16;
+
+static StartupPhase startup_phases[MAX_STARTUP_PHASES];
+static unsigned n_startup_phases;
+
+/**
+ * The base line for the first phase; static initialization runs
+ * close enough to process start.
+ */
+static const std::chrono::steady_clock::time_point startup_begin =
+	std::chrono::steady_clock::now();
+
+static std::chrono::steady_clock::time_point last_mark = startup_begin;
+
+static std::chrono::steady_clock::duration startup_total;
+
+static constexpr unsigned long
+ToMs(std::chrono::steady_clock::duration d) noexcept
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+}
+
+void
+startup_timing_mark(const char *name) noexcept
+{
+	const auto now = std::chrono::steady_clock::now();
+
+	if (n_startup_phases < MAX_STARTUP_PHASES)
+		startup_phases[n_startup_phases++] = {name, now - last_mark};
+
+	last_mark = now;
+}
+
+void
+startup_timing_finish() noexcept
+{
+	startup_timing_mark("rest");
+	startup_total = last_mark - startup_begin;
+
+	for (unsigned i = 0; i < n_startup_phases; ++i)
+		FormatDefault(startup_domain, "%s: %lums",
+			      startup_phases[i].name,
+			      ToMs(startup_phases[i].duration));
+
+	FormatDefault(startup_domain, "startup complete in %lums",
+		      ToMs(startup_total));
+}
+
+void
+startup_timing_print(Response &r) noexcept
+{
+	for (unsigned i = 0; i < n_startup_phases; ++i)
+		r.Format("startup_%s_ms: %lu\n",
+			 startup_phases[i].name,
+			 ToMs(startup_phases[i].duration));
+
+	r.Format("startup_total_ms: %lu\n", ToMs(startup_total));
+}
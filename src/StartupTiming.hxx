@@ -0,0 +1,50 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_STARTUP_TIMING_HXX
+#define MPD_STARTUP_TIMING_HXX
+
+#include "check.h"
+
+class Response;
+
+/**
+ * Mark the end of a named startup phase.  The phase's duration is
+ * the time since the previous mark (or since process start for the
+ * first one), i.e. work between two marks is attributed to the later
+ * phase.  Called from main() only.
+ */
+void
+startup_timing_mark(const char *name) noexcept;
+
+/**
+ * Mark the end of startup, just before the main loop starts.  Logs
+ * one line per phase plus the total at notice level.
+ */
+void
+startup_timing_finish() noexcept;
+
+/**
+ * Append the recorded phase durations to the "stats" response, as
+ * "startup_NAME_ms" values.
+ */
+void
+startup_timing_print(Response &r) noexcept;
+
+#endif
@@ -24,6 +24,9 @@
 #include "fs/io/TextFile.hxx"
 #include "fs/io/FileOutputStream.hxx"
 #include "fs/io/BufferedOutputStream.hxx"
+#include "fs/io/StringOutputStream.hxx"
+#include "queue/QueueSave.hxx"
+#include "queue/Playlist.hxx"
 #include "storage/StorageState.hxx"
 #include "Partition.hxx"
 #include "Instance.hxx"
@@ -46,10 +49,24 @@ StateFile::StateFile(AllocatedPath &&_path,
 	:path(std::move(_path)), path_utf8(path.ToUTF8()),
 	 interval(_interval),
 	 timer_event(_loop, BIND_THIS_METHOD(OnTimeout)),
-	 partition(_partition)
+	 partition(_partition),
+	 thread(BIND_THIS_METHOD(RunWriter))
 {
 }
 
+StateFile::~StateFile() noexcept
+{
+	if (!thread.IsDefined())
+		return;
+
+	mutex.lock();
+	stop = true;
+	cond.signal();
+	mutex.unlock();
+
+	thread.Join();
+}
+
 void
 StateFile::RememberVersions() noexcept
 {
@@ -75,6 +92,24 @@ StateFile::IsModified() const noexcept
 		;
 }
 
+const std::string &
+StateFile::GetQueueCache()
+{
+	const auto &queue = partition.playlist.queue;
+
+	if (queue_cache.empty() || prev_queue_version != queue.version) {
+		StringOutputStream sos;
+		BufferedOutputStream bos(sos);
+		queue_save(bos, queue);
+		bos.Flush();
+
+		queue_cache = sos.TakeValue();
+		prev_queue_version = queue.version;
+	}
+
+	return queue_cache;
+}
+
 inline void
 StateFile::Write(BufferedOutputStream &os)
 {
@@ -85,7 +120,8 @@ StateFile::Write(BufferedOutputStream &os)
 	storage_state_save(os, partition.instance);
 #endif
 
-	playlist_state_save(os, partition.playlist, partition.pc);
+	playlist_state_save(os, partition.playlist, partition.pc,
+			    &GetQueueCache());
 }
 
 inline void
@@ -97,18 +133,62 @@ StateFile::Write(OutputStream &os)
 }
 
 void
-StateFile::Write()
+StateFile::WriteFile(const std::string &contents) noexcept
 {
 	FormatDebug(state_file_domain,
 		    "Saving state file %s", path_utf8.c_str());
 
 	try {
 		FileOutputStream fos(path);
-		Write(fos);
+		fos.Write(contents.data(), contents.size());
 		fos.Commit();
 	} catch (const std::exception &e) {
 		LogError(e);
 	}
+}
+
+void
+StateFile::RunWriter() noexcept
+{
+	mutex.lock();
+
+	while (true) {
+		if (has_pending) {
+			const std::string contents = std::move(pending);
+			has_pending = false;
+			mutex.unlock();
+
+			WriteFile(contents);
+
+			mutex.lock();
+		} else if (stop) {
+			break;
+		} else {
+			cond.wait(mutex);
+		}
+	}
+
+	mutex.unlock();
+}
+
+void
+StateFile::Write()
+{
+	/* serialize the state into memory; only the actual disk
+	   write happens on the background thread */
+	StringOutputStream sos;
+	Write(sos);
+
+	mutex.lock();
+	pending = sos.TakeValue();
+	has_pending = true;
+	cond.signal();
+	mutex.unlock();
+
+	if (!thread.IsDefined())
+		/* started lazily, so the thread is not created
+		   before the daemon has forked */
+		thread.Start();
 
 	RememberVersions();
 }
@@ -22,6 +22,9 @@
 
 #include "event/TimerEvent.hxx"
 #include "fs/AllocatedPath.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+#include "thread/Thread.hxx"
 #include "Compiler.h"
 
 #include <string>
@@ -47,17 +50,59 @@ class StateFile final {
 	unsigned prev_volume_version = 0, prev_output_version = 0,
 		prev_playlist_version = 0;
 
+	/**
+	 * A cache of the serialized queue listing, so the queue -
+	 * usually the by far largest part of the state file - need
+	 * not be re-serialized while only the playback state
+	 * (e.g. the elapsed time) changes between saves.  Valid as
+	 * long as the queue version equals #prev_queue_version.
+	 */
+	std::string queue_cache;
+
+	unsigned prev_queue_version = 0;
+
 #ifdef ENABLE_DATABASE
 	unsigned prev_storage_version = 0;
 #endif
 
+	/**
+	 * The background thread which writes the serialized state to
+	 * disk, so the event loop never stalls on disk latency.
+	 * Started lazily on the first Write() call.
+	 */
+	Thread thread;
+
+	Mutex mutex;
+	Cond cond;
+
+	/**
+	 * The serialized state waiting to be written by #thread.  A
+	 * newer snapshot simply replaces an unwritten older one.
+	 */
+	std::string pending;
+
+	bool has_pending = false;
+
+	bool stop = false;
+
 public:
 	static constexpr std::chrono::steady_clock::duration DEFAULT_INTERVAL = std::chrono::minutes(2);
 
 	StateFile(AllocatedPath &&path, std::chrono::steady_clock::duration interval,
 		  Partition &partition, EventLoop &loop);
 
+	/**
+	 * Waits for the background thread to write out the last
+	 * snapshot.
+	 */
+	~StateFile() noexcept;
+
 	void Read();
+
+	/**
+	 * Serialize the current state and hand it to the background
+	 * thread for writing.
+	 */
 	void Write();
 
 	/**
@@ -66,9 +111,24 @@ public:
 	void CheckModified();
 
 private:
+	/**
+	 * Return the serialized queue listing, re-serializing it
+	 * only if the queue has changed since the last call.
+	 */
+	const std::string &GetQueueCache();
+
 	void Write(OutputStream &os);
 	void Write(BufferedOutputStream &os);
 
+	/**
+	 * Write one serialized state snapshot to the file, logging
+	 * (not throwing) errors.
+	 */
+	void WriteFile(const std::string &contents) noexcept;
+
+	/* the background thread */
+	void RunWriter() noexcept;
+
 	/**
 	 * Save the current state versions for use with IsModified().
 	 */
@@ -27,6 +27,7 @@
 #include "db/Interface.hxx"
 #include "db/Stats.hxx"
 #include "system/Clock.hxx"
+#include "StartupTiming.hxx"
 #include "Log.hxx"
 #include "util/ChronoUtil.hxx"
 
@@ -127,4 +128,6 @@ stats_print(Response &r, const Partition &partition)
 	if (db != nullptr)
 		db_stats_print(r, *db);
 #endif
+
+	startup_timing_print(r);
 }
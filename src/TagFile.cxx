@@ -22,6 +22,7 @@
 #include "tag/Generic.hxx"
 #include "tag/Handler.hxx"
 #include "tag/Builder.hxx"
+#include "ReplayGainInfo.hxx"
 #include "fs/Path.hxx"
 #include "decoder/DecoderList.hxx"
 #include "decoder/DecoderPlugin.hxx"
@@ -29,6 +30,7 @@
 #include "input/LocalOpen.hxx"
 #include "thread/Cond.hxx"
 
+#include <atomic>
 #include <exception>
 
 #include <assert.h>
@@ -84,6 +86,16 @@ public:
 	}
 };
 
+/**
+ * The plugin which scanned the previous file successfully.  It is
+ * tried first, because directories tend to contain files of uniform
+ * type, and this skips all plugins registered before it - including
+ * those which support the same suffix, but would fail only after
+ * doing real I/O.  The race on this variable is benign: a stale
+ * pointer merely costs one failed scan attempt.
+ */
+static std::atomic<const DecoderPlugin *> last_tag_scan_plugin{nullptr};
+
 bool
 tag_file_scan(Path path_fs, const TagHandler &handler, void *handler_ctx)
 {
@@ -98,8 +110,19 @@ tag_file_scan(Path path_fs, const TagHandler &handler, void *handler_ctx)
 	const auto suffix_utf8 = Path::FromFS(suffix).ToUTF8();
 
 	TagFileScan tfs(path_fs, suffix_utf8.c_str(), handler, handler_ctx);
-	return decoder_plugins_try([&](const DecoderPlugin &plugin){
-			return tfs.Scan(plugin);
+
+	const auto *last = last_tag_scan_plugin.load(std::memory_order_relaxed);
+	if (last != nullptr && tfs.Scan(*last))
+		return true;
+
+	return decoder_plugins_try_suffix(suffix_utf8.c_str(),
+					  [&](const DecoderPlugin &plugin){
+			if (&plugin == last || !tfs.Scan(plugin))
+				return false;
+
+			last_tag_scan_plugin.store(&plugin,
+						   std::memory_order_relaxed);
+			return true;
 		});
 }
 
@@ -114,3 +137,18 @@ tag_file_scan(Path path, TagBuilder &builder)
 
 	return true;
 }
+
+bool
+tag_file_scan(Path path, TagBuilder &builder, ReplayGainInfo &rgi)
+{
+	rgi.Clear();
+
+	TagReplayGainContext ctx{builder, rgi};
+	if (!tag_file_scan(path, full_replay_gain_tag_handler, &ctx))
+		return false;
+
+	if (builder.empty())
+		ScanGenericTags(path, full_replay_gain_tag_handler, &ctx);
+
+	return true;
+}
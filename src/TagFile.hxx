@@ -25,6 +25,7 @@
 class Path;
 struct TagHandler;
 class TagBuilder;
+struct ReplayGainInfo;
 
 /**
  * Scan the tags of a song file.  Invokes matching decoder plugins,
@@ -47,4 +48,14 @@ tag_file_scan(Path path, const TagHandler &handler, void *handler_ctx);
 bool
 tag_file_scan(Path path, TagBuilder &builder);
 
+/**
+ * Like the #TagBuilder overload, but additionally collects replay
+ * gain tags into the given #ReplayGainInfo, which is cleared first.
+ *
+ * @return true if the file was recognized (even if no metadata was
+ * found)
+ */
+bool
+tag_file_scan(Path path, TagBuilder &builder, ReplayGainInfo &rgi);
+
 #endif
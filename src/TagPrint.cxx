@@ -22,19 +22,27 @@
 #include "tag/Tag.hxx"
 #include "tag/Settings.hxx"
 #include "client/Response.hxx"
+#include "util/StringView.hxx"
 
 void
 tag_print_types(Response &r)
 {
 	for (unsigned i = 0; i < TAG_NUM_OF_ITEM_TYPES; i++)
 		if (IsTagEnabled(i))
-			r.Format("tagtype: %s\n", tag_item_names[i]);
+			r.WritePair("tagtype", tag_item_names[i]);
 }
 
 void
 tag_print(Response &r, TagType type, const char *value)
 {
-	r.Format("%s: %s\n", tag_item_names[type], value);
+	r.WritePair(tag_item_names[type], value);
+}
+
+void
+tag_print(Response &r, TagType type, StringView value)
+{
+	r.Format("%s: %.*s\n", tag_item_names[type],
+		 int(value.size), value.data);
 }
 
 void
@@ -46,6 +54,15 @@ tag_print_values(Response &r, const Tag &tag)
 			tag_print(r, i.type, i.value);
 }
 
+void
+tag_print_values_binary(Response &r, const Tag &tag)
+{
+	const auto tag_mask = r.GetTagMask();
+	for (const auto &i : tag)
+		if (tag_mask.Test(i.type))
+			r.BinaryField(i.type, i.value);
+}
+
 void
 tag_print(Response &r, const Tag &tag)
 {
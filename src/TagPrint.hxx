@@ -25,6 +25,7 @@
 enum TagType : uint8_t;
 
 struct Tag;
+struct StringView;
 class Response;
 
 void
@@ -33,9 +34,19 @@ tag_print_types(Response &response);
 void
 tag_print(Response &response, TagType type, const char *value);
 
+void
+tag_print(Response &response, TagType type, StringView value);
+
 void
 tag_print_values(Response &response, const Tag &tag);
 
+/**
+ * Like tag_print_values(), but appends the tags as fields to the
+ * client's pending binary record (see Response::BinaryField()).
+ */
+void
+tag_print_values_binary(Response &response, const Tag &tag);
+
 void
 tag_print(Response &response, const Tag &tag);
 
@@ -22,6 +22,7 @@
 #include "tag/Generic.hxx"
 #include "tag/Handler.hxx"
 #include "tag/Builder.hxx"
+#include "ReplayGainInfo.hxx"
 #include "util/MimeType.hxx"
 #include "util/UriUtil.hxx"
 #include "decoder/DecoderList.hxx"
@@ -34,18 +35,6 @@
 
 #include <assert.h>
 
-/**
- * Does the #DecoderPlugin support either the suffix or the MIME type?
- */
-gcc_pure
-static bool
-CheckDecoderPlugin(const DecoderPlugin &plugin,
-		   const char *suffix, const char *mime) noexcept
-{
-	return (mime != nullptr && plugin.SupportsMimeType(mime)) ||
-		(suffix != nullptr && plugin.SupportsSuffix(suffix));
-}
-
 bool
 tag_stream_scan(InputStream &is, const TagHandler &handler, void *ctx)
 {
@@ -62,15 +51,15 @@ tag_stream_scan(InputStream &is, const TagHandler &handler, void *ctx)
 	if (mime != nullptr)
 		mime = (mime_base = GetMimeTypeBase(mime)).c_str();
 
-	return decoder_plugins_try([suffix, mime, &is,
-				    &handler, ctx](const DecoderPlugin &plugin){
+	return decoder_plugins_try_suffix_or_mime_type(suffix, mime,
+						       [&is, &handler,
+							ctx](const DecoderPlugin &plugin){
 			try {
 				is.LockRewind();
 			} catch (...) {
 			}
 
-			return CheckDecoderPlugin(plugin, suffix, mime) &&
-				plugin.ScanStream(is, handler, ctx);
+			return plugin.ScanStream(is, handler, ctx);
 		});
 }
 
@@ -111,3 +100,32 @@ try {
 } catch (const std::exception &e) {
 	return false;
 }
+
+bool
+tag_stream_scan(InputStream &is, TagBuilder &builder, ReplayGainInfo &rgi)
+{
+	assert(is.IsReady());
+
+	rgi.Clear();
+
+	TagReplayGainContext ctx{builder, rgi};
+	if (!tag_stream_scan(is, full_replay_gain_tag_handler, &ctx))
+		return false;
+
+	if (builder.empty())
+		ScanGenericTags(is, full_replay_gain_tag_handler, &ctx);
+
+	return true;
+}
+
+bool
+tag_stream_scan(const char *uri, TagBuilder &builder, ReplayGainInfo &rgi)
+try {
+	Mutex mutex;
+	Cond cond;
+
+	auto is = InputStream::OpenReady(uri, mutex, cond);
+	return tag_stream_scan(*is, builder, rgi);
+} catch (const std::exception &e) {
+	return false;
+}
@@ -25,6 +25,7 @@
 class InputStream;
 struct TagHandler;
 class TagBuilder;
+struct ReplayGainInfo;
 
 /**
  * Scan the tags of an #InputStream.  Invokes matching decoder
@@ -53,4 +54,17 @@ tag_stream_scan(InputStream &is, TagBuilder &builder);
 bool
 tag_stream_scan(const char *uri, TagBuilder &builder);
 
+/**
+ * Like the #TagBuilder overloads, but additionally collect replay
+ * gain tags into the given #ReplayGainInfo, which is cleared first.
+ *
+ * @return true if the file was recognized (even if no metadata was
+ * found)
+ */
+bool
+tag_stream_scan(InputStream &is, TagBuilder &builder, ReplayGainInfo &rgi);
+
+bool
+tag_stream_scan(const char *uri, TagBuilder &builder, ReplayGainInfo &rgi);
+
 #endif
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "ThreadConfig.hxx"
+#include "config/ConfigGlobal.hxx"
+#include "config/ConfigOption.hxx"
+#include "thread/Util.hxx"
+#include "util/RuntimeError.hxx"
+#include "Log.hxx"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Parse a CPU list in the usual kernel notation, e.g. "0-3,8", into a
+ * bit mask.
+ *
+ * Throws std::runtime_error on syntax errors.
+ */
+static uint64_t
+ParseCpuList(const char *s)
+{
+	uint64_t mask = 0;
+
+	while (true) {
+		char *endptr;
+		unsigned long first = strtoul(s, &endptr, 10);
+		if (endptr == s || first >= 64)
+			throw FormatRuntimeError("Malformed CPU list: %s", s);
+
+		unsigned long last = first;
+		if (*endptr == '-') {
+			s = endptr + 1;
+			last = strtoul(s, &endptr, 10);
+			if (endptr == s || last >= 64 || last < first)
+				throw FormatRuntimeError("Malformed CPU list: %s",
+							 s);
+		}
+
+		for (unsigned long i = first; i <= last; ++i)
+			mask |= uint64_t(1) << i;
+
+		if (*endptr == 0)
+			return mask;
+
+		if (*endptr != ',')
+			throw FormatRuntimeError("Malformed CPU list: %s", s);
+
+		s = endptr + 1;
+	}
+}
+
+/**
+ * Reduce the given mask to the single CPU selected round-robin by the
+ * given index.  A mask with at most one CPU is returned unchanged.
+ */
+static uint64_t
+SpreadCpuMask(uint64_t mask, unsigned index) noexcept
+{
+	unsigned n = 0;
+	for (unsigned i = 0; i < 64; ++i)
+		if (mask & (uint64_t(1) << i))
+			++n;
+
+	if (n <= 1)
+		return mask;
+
+	const unsigned target = index % n;
+	for (unsigned i = 0, seen = 0; i < 64; ++i)
+		if (mask & (uint64_t(1) << i)) {
+			if (seen == target)
+				return uint64_t(1) << i;
+			++seen;
+		}
+
+	return mask;
+}
+
+static void
+ApplyCpuList(ConfigOption option, int spread_index) noexcept
+{
+	const char *s = config_get_string(option, nullptr);
+	if (s == nullptr)
+		return;
+
+	try {
+		uint64_t mask = ParseCpuList(s);
+		if (spread_index >= 0)
+			mask = SpreadCpuMask(mask, unsigned(spread_index));
+
+		SetThreadAffinity(mask);
+	} catch (...) {
+		LogError(std::current_exception(),
+			 "Failed to set thread CPU affinity");
+	}
+}
+
+void
+ApplyThreadAffinity(ConfigOption option) noexcept
+{
+	ApplyCpuList(option, -1);
+}
+
+void
+ApplyThreadAffinity(ConfigOption option, unsigned spread_index) noexcept
+{
+	ApplyCpuList(option, int(spread_index));
+}
+
+void
+ApplyThreadRealtime()
+{
+	unsigned priority = config_get_unsigned(ConfigOption::REALTIME_PRIORITY,
+						50);
+	if (priority < 1 || priority > 99)
+		throw FormatRuntimeError("realtime_priority must be in the range 1..99");
+
+	const char *policy = config_get_string(ConfigOption::REALTIME_POLICY,
+					       "fifo");
+	bool round_robin;
+	if (strcmp(policy, "fifo") == 0)
+		round_robin = false;
+	else if (strcmp(policy, "rr") == 0)
+		round_robin = true;
+	else
+		throw FormatRuntimeError("Unknown realtime_policy: %s",
+					 policy);
+
+	SetThreadRealtime(priority, round_robin);
+}
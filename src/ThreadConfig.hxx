@@ -0,0 +1,55 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_THREAD_CONFIG_HXX
+#define MPD_THREAD_CONFIG_HXX
+
+enum class ConfigOption;
+
+/**
+ * Bind the calling thread to the CPUs listed in the given
+ * configuration option (e.g. "0-3,8").  If the option is not set,
+ * this is a no-op.  Errors are logged, not thrown, because a bad
+ * affinity mask should not kill the thread.
+ */
+void
+ApplyThreadAffinity(ConfigOption option) noexcept;
+
+/**
+ * Like ApplyThreadAffinity(), but when the configured list contains
+ * more than one CPU, bind the calling thread to just one of them,
+ * selected round-robin by the given index.  This spreads the
+ * per-partition player and decoder threads across the listed CPUs
+ * instead of letting all of them float over the same mask.
+ */
+void
+ApplyThreadAffinity(ConfigOption option, unsigned spread_index) noexcept;
+
+/**
+ * Switch the calling thread to the real-time scheduling policy and
+ * priority from the "realtime_policy" and "realtime_priority"
+ * configuration options (default: SCHED_FIFO, priority 50).
+ *
+ * Throws std::runtime_error on bad configuration and
+ * std::system_error if the kernel refuses.
+ */
+void
+ApplyThreadRealtime();
+
+#endif
@@ -21,25 +21,66 @@
 #include "TimePrint.hxx"
 #include "client/Response.hxx"
 
+#include <stdio.h>
+
+/**
+ * Format the given UTC time stamp in ISO 8601, without going through
+ * gmtime_r()/strftime(), which are too expensive to be called a
+ * million times for one "listallinfo" response.  The conversion from
+ * days to a civil date uses Howard Hinnant's "civil_from_days"
+ * algorithm.
+ */
+static void
+FormatIsoUtc(char *buffer, size_t size, time_t t) noexcept
+{
+	/* split into days and seconds of day; floor division, so
+	   times before the epoch work, too */
+	long long days = t / 86400;
+	int seconds = int(t % 86400);
+	if (seconds < 0) {
+		seconds += 86400;
+		--days;
+	}
+
+	days += 719468;
+	const long long era = (days >= 0 ? days : days - 146096) / 146097;
+	const unsigned doe = unsigned(days - era * 146097);
+	const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096)
+		/ 365;
+	const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	const unsigned mp = (5 * doy + 2) / 153;
+	const unsigned day = doy - (153 * mp + 2) / 5 + 1;
+	const unsigned month = mp < 10 ? mp + 3 : mp - 9;
+	long long year = (long long)yoe + era * 400;
+	if (month <= 2)
+		++year;
+
+	snprintf(buffer, size, "%04lld-%02u-%02uT%02u:%02u:%02uZ",
+		 year, month, day,
+		 unsigned(seconds / 3600),
+		 unsigned(seconds / 60 % 60),
+		 unsigned(seconds % 60));
+}
+
+void
+time_format_iso8601(char *buffer, size_t size, time_t t) noexcept
+{
+	FormatIsoUtc(buffer, size, t);
+}
+
 void
 time_print(Response &r, const char *name, time_t t)
 {
-#ifdef _WIN32
-	const struct tm *tm2 = gmtime(&t);
-#else
-	struct tm tm;
-	const struct tm *tm2 = gmtime_r(&t, &tm);
-#endif
-	if (tm2 == nullptr)
-		return;
-
-	char buffer[32];
-	strftime(buffer, sizeof(buffer),
-#ifdef _WIN32
-		 "%Y-%m-%dT%H:%M:%SZ",
-#else
-		 "%FT%TZ",
-#endif
-		 tm2);
-	r.Format("%s: %s\n", name, buffer);
+	/* one-entry cache: all songs imported by the same update
+	   visit and all files copied together share one mtime, so
+	   big listings hit this cache most of the time */
+	static thread_local time_t cached_time = -1;
+	static thread_local char cached_buffer[32];
+
+	if (t != cached_time) {
+		FormatIsoUtc(cached_buffer, sizeof(cached_buffer), t);
+		cached_time = t;
+	}
+
+	r.Format("%s: %s\n", name, cached_buffer);
 }
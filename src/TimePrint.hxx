@@ -22,6 +22,7 @@
 
 #include <chrono>
 
+#include <stddef.h>
 #include <time.h>
 
 class Response;
@@ -32,6 +33,13 @@ class Response;
 void
 time_print(Response &r, const char *name, time_t t);
 
+/**
+ * Format the given UTC time stamp in ISO 8601 into the caller's
+ * buffer, which must hold at least 32 bytes.
+ */
+void
+time_format_iso8601(char *buffer, size_t size, time_t t) noexcept;
+
 inline void
 time_print(Response &r, const char *name,
 	   std::chrono::system_clock::time_point t)
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_TRACEPOINT_HXX
+#define MPD_TRACEPOINT_HXX
+
+#include "check.h"
+
+/*
+ * Static userspace tracepoints (USDT) at the seams of the audio
+ * pipeline, usable with perf(1), SystemTap, bpftrace etc.  When
+ * <sys/sdt.h> is not available (or no tracer is attached), a probe
+ * is a single nop instruction, so they can stay in production
+ * builds.
+ *
+ * All probes use the provider name "mpd".
+ */
+
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+
+#define MPD_PROBE(name) DTRACE_PROBE(mpd, name)
+#define MPD_PROBE1(name, a) DTRACE_PROBE1(mpd, name, a)
+#define MPD_PROBE2(name, a, b) DTRACE_PROBE2(mpd, name, a, b)
+#else
+#define MPD_PROBE(name)
+#define MPD_PROBE1(name, a)
+#define MPD_PROBE2(name, a, b)
+#endif
+
+#endif
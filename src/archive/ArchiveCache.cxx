@@ -0,0 +1,113 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "ArchiveCache.hxx"
+#include "ArchiveFile.hxx"
+#include "ArchivePlugin.hxx"
+#include "fs/Path.hxx"
+#include "fs/FileInfo.hxx"
+#include "thread/Mutex.hxx"
+
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <string>
+
+/**
+ * The maximum number of archives which are kept open.
+ */
+static constexpr unsigned ARCHIVE_CACHE_MAX_SIZE = 4;
+
+struct ArchiveCacheItem {
+	std::string path;
+
+	std::chrono::system_clock::time_point mtime;
+
+	ArchiveFile *file;
+};
+
+static Mutex archive_cache_mutex;
+
+/**
+ * The most recently used archive comes first.  Protected by
+ * #archive_cache_mutex.
+ */
+static std::list<ArchiveCacheItem> archive_cache;
+
+ArchiveFile *
+archive_cache_open(const ArchivePlugin &plugin, Path path)
+{
+	std::chrono::system_clock::time_point mtime;
+
+	try {
+		const FileInfo fi(path);
+		mtime = fi.GetModificationTime();
+	} catch (...) {
+		/* cannot stat the file: bypass the cache and let
+		   archive_file_open() report the error */
+		return archive_file_open(&plugin, path);
+	}
+
+	const std::lock_guard<Mutex> protect(archive_cache_mutex);
+
+	for (auto i = archive_cache.begin(); i != archive_cache.end(); ++i) {
+		if (i->path != path.c_str())
+			continue;
+
+		if (i->mtime == mtime && &i->file->plugin == &plugin) {
+			/* cache hit: move to the front and hand out
+			   another reference */
+			archive_cache.splice(archive_cache.begin(),
+					     archive_cache, i);
+			i->file->Ref();
+			return i->file;
+		}
+
+		/* stale: the file was modified since it was parsed */
+		i->file->Close();
+		archive_cache.erase(i);
+		break;
+	}
+
+	ArchiveFile *file = archive_file_open(&plugin, path);
+
+	/* one reference is kept by the cache, another one is handed
+	   out to the caller */
+	file->Ref();
+	archive_cache.emplace_front(ArchiveCacheItem{path.c_str(), mtime,
+						     file});
+
+	while (archive_cache.size() > ARCHIVE_CACHE_MAX_SIZE) {
+		archive_cache.back().file->Close();
+		archive_cache.pop_back();
+	}
+
+	return file;
+}
+
+void
+archive_cache_flush() noexcept
+{
+	const std::lock_guard<Mutex> protect(archive_cache_mutex);
+
+	for (auto &i : archive_cache)
+		i.file->Close();
+	archive_cache.clear();
+}
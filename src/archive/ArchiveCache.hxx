@@ -0,0 +1,49 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_ARCHIVE_CACHE_HXX
+#define MPD_ARCHIVE_CACHE_HXX
+
+#include "check.h"
+
+struct ArchivePlugin;
+class ArchiveFile;
+class Path;
+
+/**
+ * Open an archive file, reusing a recently used #ArchiveFile instance
+ * if the file has not been modified since it was parsed.  Playing
+ * consecutive songs from one archive thus parses the archive's
+ * directory only once.
+ *
+ * The returned instance must be disposed of with ArchiveFile::Close(),
+ * just like one returned by archive_file_open().
+ *
+ * Throws std::runtime_error on error.
+ */
+ArchiveFile *
+archive_cache_open(const ArchivePlugin &plugin, Path path);
+
+/**
+ * Release all cached #ArchiveFile references.
+ */
+void
+archive_cache_flush() noexcept;
+
+#endif
@@ -40,6 +40,12 @@ protected:
 	~ArchiveFile() {}
 
 public:
+	/**
+	 * Increment the reference counter.  Each reference must be
+	 * released by calling Close().
+	 */
+	virtual void Ref() = 0;
+
 	virtual void Close() = 0;
 
 	/**
@@ -19,6 +19,7 @@
 
 #include "config.h"
 #include "ArchiveList.hxx"
+#include "ArchiveCache.hxx"
 #include "ArchivePlugin.hxx"
 #include "util/StringUtil.hxx"
 #include "plugins/Bzip2ArchivePlugin.hxx"
@@ -83,6 +84,8 @@ void archive_plugin_init_all(void)
 
 void archive_plugin_deinit_all(void)
 {
+	archive_cache_flush();
+
 	archive_plugins_for_each_enabled(plugin)
 		if (plugin->finish != nullptr)
 			plugin->finish();
@@ -33,11 +33,13 @@
 
 #include <cdio/iso9660.h>
 
+#include <algorithm>
+
+#include <assert.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define CEILING(x, y) ((x+(y-1))/y)
-
 class Iso9660ArchiveFile final : public ArchiveFile {
 	RefCount ref;
 
@@ -144,6 +146,16 @@ class Iso9660InputStream final : public InputStream {
 
 	iso9660_stat_t *statbuf;
 
+	/**
+	 * libiso9660 can only read whole blocks at block-aligned
+	 * offsets.  This buffer holds the most recently read block,
+	 * so Read() can serve arbitrary byte ranges from it; large
+	 * aligned requests bypass it and read directly into the
+	 * caller's buffer.
+	 */
+	uint8_t buffer[ISO_BLOCKSIZE];
+	size_t buffer_fill = 0, buffer_position = 0;
+
 public:
 	Iso9660InputStream(Iso9660ArchiveFile &_archive, const char *_uri,
 			   Mutex &_mutex, Cond &_cond,
@@ -182,34 +194,54 @@ Iso9660ArchiveFile::OpenStream(const char *pathname,
 size_t
 Iso9660InputStream::Read(void *ptr, size_t read_size)
 {
-	int readed = 0;
-	int no_blocks, cur_block;
-	size_t left_bytes = statbuf->size - offset;
-
-	if (left_bytes < read_size) {
-		no_blocks = CEILING(left_bytes, ISO_BLOCKSIZE);
-	} else {
-		no_blocks = read_size / ISO_BLOCKSIZE;
-	}
-
-	if (no_blocks == 0)
+	const offset_type remaining = size - offset;
+	if (remaining == 0)
 		return 0;
 
-	cur_block = offset / ISO_BLOCKSIZE;
+	if (offset_type(read_size) > remaining)
+		read_size = remaining;
+
+	if (buffer_position < buffer_fill) {
+		/* serve the rest of the buffered block */
+		size_t nbytes = std::min(read_size,
+					 buffer_fill - buffer_position);
+		memcpy(ptr, buffer + buffer_position, nbytes);
+		buffer_position += nbytes;
+		offset += nbytes;
+		return nbytes;
+	}
 
-	readed = archive.SeekRead(ptr, statbuf->lsn + cur_block,
-				  no_blocks);
+	/* the buffer is exhausted, which means the current offset is
+	   block-aligned */
+	assert(offset % ISO_BLOCKSIZE == 0);
 
-	if (readed != no_blocks * ISO_BLOCKSIZE)
-		throw FormatRuntimeError("error reading ISO file at lsn %lu",
-					 (unsigned long)cur_block);
+	const lsn_t lsn = statbuf->lsn + offset / ISO_BLOCKSIZE;
 
-	if (left_bytes < read_size) {
-		readed = left_bytes;
+	if (read_size >= ISO_BLOCKSIZE) {
+		/* aligned bulk read: bypass the block buffer and
+		   read directly into the caller's buffer */
+		const long no_blocks = read_size / ISO_BLOCKSIZE;
+		long nbytes = archive.SeekRead(ptr, lsn, no_blocks);
+		if (nbytes != no_blocks * (long)ISO_BLOCKSIZE)
+			throw FormatRuntimeError("error reading ISO file at lsn %lu",
+						 (unsigned long)lsn);
+
+		offset += nbytes;
+		return nbytes;
 	}
 
-	offset += readed;
-	return readed;
+	/* partial block: read it into the block buffer and copy the
+	   requested range out of it */
+	long nbytes = archive.SeekRead(buffer, lsn, 1);
+	if (nbytes != (long)ISO_BLOCKSIZE)
+		throw FormatRuntimeError("error reading ISO file at lsn %lu",
+					 (unsigned long)lsn);
+
+	buffer_fill = std::min<offset_type>(ISO_BLOCKSIZE, remaining);
+	buffer_position = std::min(read_size, buffer_fill);
+	memcpy(ptr, buffer, buffer_position);
+	offset += buffer_position;
+	return buffer_position;
 }
 
 bool
@@ -46,6 +46,10 @@ public:
 		zzip_dir_close(dir);
 	}
 
+	void Ref() override {
+		ref.Increment();
+	}
+
 	void Unref() {
 		if (ref.Decrement())
 			delete this;
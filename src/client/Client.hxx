@@ -31,11 +31,13 @@
 #include <boost/intrusive/link_mode.hpp>
 #include <boost/intrusive/list_hook.hpp>
 
+#include <map>
 #include <set>
 #include <string>
 #include <list>
 
 #include <stddef.h>
+#include <stdint.h>
 
 class SocketAddress;
 class UniqueSocketDescriptor;
@@ -80,6 +82,44 @@ public:
 	 */
 	TagMask tag_mask = TagMask::All();
 
+	/**
+	 * Does this client want song records framed as binary
+	 * length-prefixed field lists instead of "key: value" lines?
+	 * Controlled by the "binaryoutput" command.
+	 */
+	bool binary_output = false;
+
+	/**
+	 * The last URI scheme (including "://") which was verified to
+	 * be supported, e.g. "http://".  This is a one-entry cache
+	 * for LocateUri(): bulk loads usually add many songs with the
+	 * same scheme, and the cache skips scanning the list of
+	 * supported schemes for each of them.  "mutable" because URI
+	 * classification does not modify the client's protocol state.
+	 */
+	mutable std::string verified_uri_scheme;
+
+	/**
+	 * Execution counters for one protocol command, collected by
+	 * client_process_line() and printed by the "clientstats"
+	 * command.
+	 */
+	struct CommandStats {
+		uint64_t count = 0;
+
+		/** cumulative execution time in microseconds */
+		uint64_t total_us = 0;
+
+		/** the slowest single execution in microseconds */
+		uint64_t max_us = 0;
+	};
+
+	/**
+	 * Per-command execution counters of this client, keyed by
+	 * command name.  Only accessed from the main thread.
+	 */
+	std::map<std::string, CommandStats> command_stats;
+
 	/**
 	 * A list of channel names this client is subscribed to.
 	 */
@@ -151,7 +191,26 @@ public:
 	 * Send "idle" response to this client.
 	 */
 	void IdleNotify() noexcept;
+
+	/**
+	 * Add idle flags and notify the client immediately if it is
+	 * waiting.
+	 */
 	void IdleAdd(unsigned flags) noexcept;
+
+	/**
+	 * Accumulate idle flags without notifying the client.  Used
+	 * to batch burst mutations; IdleFlush() sends one merged
+	 * notification later.
+	 */
+	void IdleAppend(unsigned flags) noexcept;
+
+	/**
+	 * Notify the client of all accumulated idle flags it is
+	 * subscribed to.
+	 */
+	void IdleFlush() noexcept;
+
 	bool IdleWait(unsigned flags) noexcept;
 
 	enum class SubscribeResult {
@@ -191,6 +250,8 @@ public:
 	 */
 	void AllowFile(Path path_fs) const;
 
+	using FullyBufferedSocket::GetOutputBufferSize;
+
 	Partition &GetPartition() noexcept {
 		return *partition;
 	}
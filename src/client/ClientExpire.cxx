@@ -19,6 +19,7 @@
 
 #include "config.h"
 #include "ClientInternal.hxx"
+#include "util/PeakBuffer.hxx"
 #include "Log.hxx"
 
 void
@@ -40,4 +41,9 @@ Client::OnTimeout() noexcept
 	}
 
 	Close();
+
+	/* a client timing out means this connection has been idle
+	   for minutes; use the occasion to give the thread's spare
+	   output peak buffer back to the kernel */
+	PeakBuffer::DiscardSpare();
 }
@@ -46,16 +46,31 @@ Client::IdleNotify() noexcept
 }
 
 void
-Client::IdleAdd(unsigned flags) noexcept
+Client::IdleAppend(unsigned flags) noexcept
 {
 	if (IsExpired())
 		return;
 
 	idle_flags |= flags;
+}
+
+void
+Client::IdleFlush() noexcept
+{
+	if (IsExpired())
+		return;
+
 	if (idle_waiting && (idle_flags & idle_subscriptions))
 		IdleNotify();
 }
 
+void
+Client::IdleAdd(unsigned flags) noexcept
+{
+	IdleAppend(flags);
+	IdleFlush();
+}
+
 bool
 Client::IdleWait(unsigned flags) noexcept
 {
@@ -44,5 +44,12 @@ ClientList::IdleAdd(unsigned flags)
 	assert(flags != 0);
 
 	for (auto &client : list)
-		client.IdleAdd(flags);
+		client.IdleAppend(flags);
+}
+
+void
+ClientList::IdleFlush()
+{
+	for (auto &client : list)
+		client.IdleFlush();
 }
@@ -59,7 +59,16 @@ public:
 
 	void CloseAll();
 
+	/**
+	 * Accumulate idle flags on all clients without notifying
+	 * them; call IdleFlush() to send the merged notifications.
+	 */
 	void IdleAdd(unsigned flags);
+
+	/**
+	 * Notify all clients of their accumulated idle flags.
+	 */
+	void IdleFlush();
 };
 
 #endif
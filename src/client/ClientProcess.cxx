@@ -19,16 +19,64 @@
 
 #include "config.h"
 #include "ClientInternal.hxx"
+#include "BulkEdit.hxx"
 #include "protocol/Result.hxx"
 #include "command/AllCommands.hxx"
+#include "Tracepoint.hxx"
 #include "Log.hxx"
 #include "util/StringAPI.hxx"
 #include "util/CharUtil.hxx"
 
+#include <chrono>
+
+#include <string.h>
+
 #define CLIENT_LIST_MODE_BEGIN "command_list_begin"
 #define CLIENT_LIST_OK_MODE_BEGIN "command_list_ok_begin"
 #define CLIENT_LIST_MODE_END "command_list_end"
 
+/**
+ * Commands which take longer than this are logged with their
+ * duration, to help identify the client which saturates the main
+ * loop.
+ */
+static constexpr std::chrono::steady_clock::duration SLOW_COMMAND_THRESHOLD =
+	std::chrono::milliseconds(250);
+
+/**
+ * Run one command through command_process(), updating the client's
+ * per-command execution counters (see Client::command_stats) and
+ * logging commands which exceed #SLOW_COMMAND_THRESHOLD.
+ */
+static CommandResult
+client_process_command(Client &client, unsigned num, char *line)
+{
+	/* copy the command name before command_process() tokenizes
+	   the line in-place */
+	const std::string name(line, strcspn(line, " \t"));
+
+	const auto start = std::chrono::steady_clock::now();
+	const CommandResult ret = command_process(client, num, line);
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+
+	const uint64_t elapsed_us =
+		std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+
+	auto &stats = client.command_stats[name];
+	++stats.count;
+	stats.total_us += elapsed_us;
+	if (elapsed_us > stats.max_us)
+		stats.max_us = elapsed_us;
+
+	if (elapsed >= SLOW_COMMAND_THRESHOLD)
+		FormatWarning(client_domain,
+			      "[%u] command \"%s\" took %luus",
+			      client.num, name.c_str(),
+			      (unsigned long)elapsed_us);
+
+	return ret;
+}
+
 static CommandResult
 client_process_command_list(Client &client, bool list_ok,
 			    std::list<std::string> &&list)
@@ -36,11 +84,18 @@ client_process_command_list(Client &client, bool list_ok,
 	CommandResult ret = CommandResult::OK;
 	unsigned num = 0;
 
+	/* bulk edit: a command list with many queue edits
+	   (e.g. thousands of "add" commands) shall bump the playlist
+	   version and emit the "playlist" idle event only once */
+	const ScopeBulkEdit bulk_edit(client.GetPartition());
+
 	for (auto &&i : list) {
 		char *cmd = &*i.begin();
 
 		FormatDebug(client_domain, "process command \"%s\"", cmd);
-		ret = command_process(client, num++, cmd);
+		MPD_PROBE2(client_command_begin, client.num, cmd);
+		ret = client_process_command(client, num++, cmd);
+		MPD_PROBE2(client_command_end, client.num, int(ret));
 		FormatDebug(client_domain, "command returned %i", int(ret));
 		if (ret != CommandResult::OK || client.IsExpired())
 			break;
@@ -131,7 +186,9 @@ client_process_line(Client &client, char *line)
 			FormatDebug(client_domain,
 				    "[%u] process command \"%s\"",
 				    client.num, line);
-			ret = command_process(client, 0, line);
+			MPD_PROBE2(client_command_begin, client.num, line);
+			ret = client_process_command(client, 0, line);
+			MPD_PROBE2(client_command_end, client.num, int(ret));
 			FormatDebug(client_domain,
 				    "[%u] command returned %i",
 				    client.num, int(ret));
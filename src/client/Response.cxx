@@ -23,6 +23,9 @@
 #include "util/FormatString.hxx"
 #include "util/AllocatedString.hxx"
 
+#include <stdio.h>
+#include <string.h>
+
 TagMask
 Response::GetTagMask() const noexcept
 {
@@ -32,6 +35,11 @@ Response::GetTagMask() const noexcept
 bool
 Response::Write(const void *data, size_t length)
 {
+	if (capture != nullptr) {
+		capture->append((const char *)data, length);
+		return true;
+	}
+
 	return client.Write(data, length);
 }
 
@@ -57,6 +65,113 @@ Response::Format(const char *fmt, ...)
 	return success;
 }
 
+/**
+ * Append the decimal representation of the given number and return
+ * the new end pointer.
+ */
+static char *
+AppendUnsigned(char *p, unsigned value) noexcept
+{
+	char tmp[16];
+	char *t = tmp + sizeof(tmp);
+
+	do {
+		*--t = '0' + value % 10;
+		value /= 10;
+	} while (value > 0);
+
+	const size_t length = tmp + sizeof(tmp) - t;
+	memcpy(p, t, length);
+	return p + length;
+}
+
+bool
+Response::WritePair(const char *name, const char *value)
+{
+	const size_t name_length = strlen(name);
+	const size_t value_length = strlen(value);
+
+	char buffer[1024];
+	if (name_length + value_length + 3 > sizeof(buffer))
+		/* an over-long value: fall back to the allocating
+		   path */
+		return Format("%s: %s\n", name, value);
+
+	char *p = buffer;
+	memcpy(p, name, name_length);
+	p += name_length;
+	*p++ = ':';
+	*p++ = ' ';
+	memcpy(p, value, value_length);
+	p += value_length;
+	*p++ = '\n';
+
+	return Write(buffer, p - buffer);
+}
+
+bool
+Response::WritePair(const char *name, unsigned value)
+{
+	const size_t name_length = strlen(name);
+
+	char buffer[64];
+	if (name_length + 3 + 16 > sizeof(buffer))
+		return Format("%s: %u\n", name, value);
+
+	char *p = buffer;
+	memcpy(p, name, name_length);
+	p += name_length;
+	*p++ = ':';
+	*p++ = ' ';
+	p = AppendUnsigned(p, value);
+	*p++ = '\n';
+
+	return Write(buffer, p - buffer);
+}
+
+bool
+Response::IsBinaryOutput() const noexcept
+{
+	return GetClient().binary_output;
+}
+
+void
+Response::BinaryField(uint8_t id, const char *value,
+		      size_t length) noexcept
+{
+	if (length > 0xffff)
+		/* the length prefix is 16 bit; truncate (such values
+		   cannot legally occur in a tag) */
+		length = 0xffff;
+
+	binary_record.push_back((char)id);
+	binary_record.push_back((char)(length & 0xff));
+	binary_record.push_back((char)(length >> 8));
+	binary_record.append(value, length);
+}
+
+void
+Response::BinaryField(uint8_t id, const char *value) noexcept
+{
+	BinaryField(id, value, strlen(value));
+}
+
+bool
+Response::FlushBinaryRecord()
+{
+	char header[32];
+	const int header_length =
+		snprintf(header, sizeof(header), "binary: %zu\n",
+			 binary_record.length());
+
+	bool success = Write(header, header_length) &&
+		Write(binary_record.data(), binary_record.length()) &&
+		Write("\n", 1);
+
+	binary_record.clear();
+	return success;
+}
+
 void
 Response::Error(enum ack code, const char *msg)
 {
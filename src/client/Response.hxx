@@ -24,8 +24,11 @@
 #include "protocol/Ack.hxx"
 #include "Compiler.h"
 
+#include <string>
+
 #include <stddef.h>
 #include <stdarg.h>
+#include <stdint.h>
 
 class Client;
 class TagMask;
@@ -44,6 +47,21 @@ class Response {
 	 */
 	const char *command;
 
+	/**
+	 * If not nullptr, then Write() appends all data to this
+	 * string instead of sending it to the client.  Used to build
+	 * cached protocol fragments (see QueuePrint.cxx).
+	 */
+	std::string *capture = nullptr;
+
+	/**
+	 * The binary song record being built by BinaryField(), sent
+	 * by FlushBinaryRecord().  Only used when the client has
+	 * enabled the binary framing (see the "binaryoutput"
+	 * command).
+	 */
+	std::string binary_record;
+
 public:
 	Response(Client &_client, unsigned _list_index)
 		:client(_client), list_index(_list_index), command("") {}
@@ -72,11 +90,53 @@ public:
 		command = _command;
 	}
 
+	/**
+	 * Redirect all Write() output into the given string (or back
+	 * to the client if nullptr is passed).
+	 */
+	void SetCapture(std::string *_capture) noexcept {
+		capture = _capture;
+	}
+
 	bool Write(const void *data, size_t length);
 	bool Write(const char *data);
 	bool FormatV(const char *fmt, va_list args);
 	bool Format(const char *fmt, ...);
 
+	/**
+	 * Write a "name: value" line, bypassing the printf machinery.
+	 * This is the hot path when a client lists many songs, where
+	 * vsnprintf() format parsing used to dominate.
+	 */
+	bool WritePair(const char *name, const char *value);
+	bool WritePair(const char *name, unsigned value);
+
+	/**
+	 * Has this client opted into binary song records?  See the
+	 * "binaryoutput" command.
+	 */
+	gcc_pure
+	bool IsBinaryOutput() const noexcept;
+
+	/**
+	 * Append one field to the pending binary record: a one-byte
+	 * field id, a 16 bit little-endian value length and the
+	 * value bytes.  Field ids below 0x80 are #TagType values
+	 * (see tag/Type.h); the rest are defined in SongPrint.cxx
+	 * and documented with the "binaryoutput" command.
+	 */
+	void BinaryField(uint8_t id, const char *value,
+			 size_t length) noexcept;
+
+	void BinaryField(uint8_t id, const char *value) noexcept;
+
+	/**
+	 * Send the pending binary record, framed like an "albumart"
+	 * chunk: a "binary: SIZE" line, the payload and a trailing
+	 * newline.
+	 */
+	bool FlushBinaryRecord();
+
 	void Error(enum ack code, const char *msg);
 	void FormatError(enum ack code, const char *fmt, ...);
 };
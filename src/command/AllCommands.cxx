@@ -85,10 +85,12 @@ static constexpr struct command commands[] = {
 	{ "addid", PERMISSION_ADD, 1, 2, handle_addid },
 	{ "addtagid", PERMISSION_ADD, 3, 3, handle_addtagid },
 	{ "albumart", PERMISSION_READ, 2, 2, handle_album_art },
+	{ "binaryoutput", PERMISSION_READ, 1, 1, handle_binaryoutput },
 	{ "channels", PERMISSION_READ, 0, 0, handle_channels },
 	{ "clear", PERMISSION_CONTROL, 0, 0, handle_clear },
 	{ "clearerror", PERMISSION_CONTROL, 0, 0, handle_clearerror },
 	{ "cleartagid", PERMISSION_ADD, 1, 2, handle_cleartagid },
+	{ "clientstats", PERMISSION_ADMIN, 0, 0, handle_clientstats },
 	{ "close", PERMISSION_NONE, -1, -1, handle_close },
 	{ "commands", PERMISSION_NONE, 0, 0, handle_commands },
 	{ "config", PERMISSION_ADMIN, 0, 0, handle_config },
@@ -98,6 +100,9 @@ static constexpr struct command commands[] = {
 #endif
 	{ "crossfade", PERMISSION_CONTROL, 1, 1, handle_crossfade },
 	{ "currentsong", PERMISSION_READ, 0, 0, handle_currentsong },
+#ifdef ENABLE_DATABASE
+	{ "dbsync", PERMISSION_READ, 0, 2, handle_dbsync },
+#endif
 	{ "decoders", PERMISSION_READ, 0, 0, handle_decoders },
 	{ "delete", PERMISSION_CONTROL, 1, 1, handle_delete },
 	{ "deleteid", PERMISSION_CONTROL, 1, 1, handle_deleteid },
@@ -109,6 +114,7 @@ static constexpr struct command commands[] = {
 #endif
 	{ "idle", PERMISSION_READ, 0, -1, handle_idle },
 	{ "kill", PERMISSION_ADMIN, -1, -1, handle_kill },
+	{ "latencyinfo", PERMISSION_READ, 0, 0, handle_latencyinfo },
 #ifdef ENABLE_DATABASE
 	{ "list", PERMISSION_READ, 1, -1, handle_list },
 	{ "listall", PERMISSION_READ, 0, 1, handle_listall },
@@ -127,6 +133,7 @@ static constexpr struct command commands[] = {
 	{ "listplaylists", PERMISSION_READ, 0, 0, handle_listplaylists },
 	{ "load", PERMISSION_ADD, 1, 2, handle_load },
 	{ "lsinfo", PERMISSION_READ, 0, 1, handle_lsinfo },
+	{ "memstats", PERMISSION_READ, 0, 0, handle_memstats },
 	{ "mixrampdb", PERMISSION_CONTROL, 1, 1, handle_mixrampdb },
 	{ "mixrampdelay", PERMISSION_CONTROL, 1, 1, handle_mixrampdelay },
 #ifdef ENABLE_DATABASE
@@ -142,6 +149,7 @@ static constexpr struct command commands[] = {
 	{ "partition", PERMISSION_READ, 1, 1, handle_partition },
 	{ "password", PERMISSION_NONE, 1, 1, handle_password },
 	{ "pause", PERMISSION_CONTROL, 0, 1, handle_pause },
+	{ "perfstats", PERMISSION_READ, 0, 0, handle_perfstats },
 	{ "ping", PERMISSION_NONE, 0, 0, handle_ping },
 	{ "play", PERMISSION_CONTROL, 0, 1, handle_play },
 	{ "playid", PERMISSION_CONTROL, 0, 1, handle_playid },
@@ -159,6 +167,8 @@ static constexpr struct command commands[] = {
 	{ "previous", PERMISSION_CONTROL, 0, 0, handle_previous },
 	{ "prio", PERMISSION_CONTROL, 2, -1, handle_prio },
 	{ "prioid", PERMISSION_CONTROL, 2, -1, handle_prioid },
+	{ "profile", PERMISSION_ADMIN, 1, 2, handle_profile },
+	{ "queuefind", PERMISSION_READ, 1, 1, handle_queuefind },
 	{ "random", PERMISSION_CONTROL, 1, 1, handle_random },
 	{ "rangeid", PERMISSION_ADD, 2, 2, handle_rangeid },
 	{ "readcomments", PERMISSION_READ, 1, 1, handle_read_comments },
@@ -275,6 +285,20 @@ handle_not_commands(Client &client, gcc_unused Request request, Response &r)
 	return PrintUnavailableCommands(r, client.GetPermission());
 }
 
+/**
+ * Maps the first character of a command name ('a'..'z') to the range
+ * of #commands entries starting with that character.  Built once by
+ * command_init(); command_lookup() then only needs to binary-search
+ * within one small bucket.
+ */
+struct CommandNameRange {
+	unsigned char begin, end;
+};
+
+static CommandNameRange command_name_index[26];
+
+static_assert(num_commands <= 255, "Command index overflow");
+
 void
 command_init()
 {
@@ -283,6 +307,20 @@ command_init()
 	for (unsigned i = 0; i < num_commands - 1; ++i)
 		assert(strcmp(commands[i].cmd, commands[i + 1].cmd) < 0);
 #endif
+
+	unsigned i = 0;
+	for (unsigned c = 0; c < 26; ++c) {
+		command_name_index[c].begin = i;
+
+		while (i < num_commands &&
+		       unsigned(commands[i].cmd[0] - 'a') == c)
+			++i;
+
+		command_name_index[c].end = i;
+	}
+
+	/* all command names are lower-case */
+	assert(i == num_commands);
 }
 
 void
@@ -293,9 +331,15 @@ command_finish()
 static const struct command *
 command_lookup(const char *name)
 {
-	unsigned a = 0, b = num_commands, i;
+	if (name[0] < 'a' || name[0] > 'z')
+		return nullptr;
+
+	const auto &range = command_name_index[name[0] - 'a'];
+	unsigned a = range.begin, b = range.end, i;
+	if (a == b)
+		return nullptr;
 
-	/* binary search */
+	/* binary search within the bucket */
 	do {
 		i = (a + b) / 2;
 
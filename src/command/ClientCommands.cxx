@@ -110,3 +110,11 @@ handle_tagtypes(Client &client, Request request, Response &r)
 		return CommandResult::ERROR;
 	}
 }
+
+CommandResult
+handle_binaryoutput(Client &client, Request request,
+		    gcc_unused Response &r)
+{
+	client.binary_output = request.ParseBool(0);
+	return CommandResult::OK;
+}
@@ -17,6 +17,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#define __STDC_FORMAT_MACROS /* for PRIu64 */
+
 #include "config.h"
 #include "DatabaseCommands.hxx"
 #include "Request.hxx"
@@ -25,6 +27,7 @@
 #include "db/DatabasePrint.hxx"
 #include "db/Count.hxx"
 #include "db/Selection.hxx"
+#include "db/plugins/simple/SimpleDatabasePlugin.hxx"
 #include "CommandError.hxx"
 #include "client/Client.hxx"
 #include "client/Response.hxx"
@@ -37,6 +40,9 @@
 
 #include <memory>
 
+#include <inttypes.h> /* for PRIu64 */
+#include <stdlib.h>
+
 CommandResult
 handle_listfiles_db(Client &client, Response &r, const char *uri)
 {
@@ -283,3 +289,75 @@ handle_listallinfo(Client &client, Request args, Response &r)
 			   true, false);
 	return CommandResult::OK;
 }
+
+CommandResult
+handle_dbsync(Client &client, Request args, Response &r)
+{
+	const Database &db = client.GetDatabaseOrThrow();
+	if (!db.IsPlugin(simple_db_plugin)) {
+		r.Error(ACK_ERROR_NO_EXIST,
+			"Not supported by this database plugin");
+		return CommandResult::ERROR;
+	}
+
+	const auto &simple = (const SimpleDatabase &)db;
+
+	const auto status = simple.GetSyncStatus();
+	r.Format("sync_id: %" PRIx64 "\n"
+		 "generation: %" PRIu64 "\n",
+		 uint64_t(status.id), uint64_t(status.generation));
+
+	if (args.empty())
+		/* just polling the current stamp */
+		return CommandResult::OK;
+
+	if (args.size != 2) {
+		r.Error(ACK_ERROR_ARG, "Missing generation");
+		return CommandResult::ERROR;
+	}
+
+	char *endptr;
+	const uint64_t id = strtoull(args[0], &endptr, 16);
+	if (endptr == args[0] || *endptr != 0) {
+		r.Error(ACK_ERROR_ARG, "Malformed sync id");
+		return CommandResult::ERROR;
+	}
+
+	const uint64_t generation = strtoull(args[1], &endptr, 10);
+	if (endptr == args[1] || *endptr != 0) {
+		r.Error(ACK_ERROR_ARG, "Malformed generation");
+		return CommandResult::ERROR;
+	}
+
+	const bool available =
+		simple.VisitSyncRecords(id, generation,
+					[&r](const SimpleDatabase::SyncRecord &record){
+			const char *name;
+			switch (record.op) {
+			case SimpleDatabase::SyncRecord::Op::MODIFIED:
+				name = "modified";
+				break;
+
+			case SimpleDatabase::SyncRecord::Op::REMOVED:
+				name = "removed";
+				break;
+
+			case SimpleDatabase::SyncRecord::Op::REMOVED_DIRECTORY:
+				name = "removed_directory";
+				break;
+
+			default:
+				gcc_unreachable();
+			}
+
+			r.Format("%s: %s\n", name, record.uri.c_str());
+		});
+
+	if (!available)
+		/* the delta cannot be served; the peer must fetch a
+		   full copy (e.g. "listallinfo") and start over from
+		   the current generation */
+		r.Write("full: 1\n");
+
+	return CommandResult::OK;
+}
@@ -50,6 +50,9 @@ handle_searchaddpl(Client &client, Request request, Response &response);
 CommandResult
 handle_count(Client &client, Request request, Response &response);
 
+CommandResult
+handle_dbsync(Client &client, Request request, Response &response);
+
 CommandResult
 handle_listall(Client &client, Request request, Response &response);
 
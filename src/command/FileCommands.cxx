@@ -42,6 +42,10 @@
 #include "thread/Mutex.hxx"
 #include "thread/Cond.hxx"
 
+#include <algorithm>
+#include <list>
+#include <memory>
+
 #include <assert.h>
 #include <inttypes.h> /* for PRIu64 */
 
@@ -263,43 +267,116 @@ find_stream_art(const char *directory, Mutex &mutex, Cond &cond)
 	return nullptr;
 }
 
-static CommandResult
-read_stream_art(Response &r, const char *uri, size_t offset)
-{
-	std::string art_directory = PathTraitsUTF8::GetParent(uri);
+struct ArtCacheEntry {
+	/** the UTF-8 URI of the directory this art belongs to */
+	std::string directory;
 
-	Mutex mutex;
-	Cond cond;
+	std::unique_ptr<uint8_t[]> data;
 
-	InputStreamPtr is = find_stream_art(art_directory.c_str(), mutex, cond);
+	size_t size;
+};
 
-	if (is == nullptr) {
-		r.Error(ACK_ERROR_NO_EXIST, "No file exists");
-		return CommandResult::ERROR;
-	}
-	if (!is->KnownSize()) {
-		r.Error(ACK_ERROR_NO_EXIST, "Cannot get size for stream");
-		return CommandResult::ERROR;
-	}
+/** maximum number of directories in #art_cache */
+static constexpr unsigned ART_CACHE_MAX_ENTRIES = 8;
 
-	const size_t art_file_size = is->GetSize();
+/** art files bigger than this are not cached */
+static constexpr size_t ART_CACHE_MAX_SIZE = 16 * 1024 * 1024;
 
-	constexpr size_t CHUNK_SIZE = 8192;
-	uint8_t buffer[CHUNK_SIZE];
-	size_t read_size;
+/**
+ * A small cache of recently served art files, most recently used
+ * first.  Clients fetch big art files in many small "albumart"
+ * requests; without this cache, every one of them would probe the
+ * candidate file names and read the file again.  It is only accessed
+ * by the client thread, so no locking is needed.  A replaced art
+ * file may be served stale until its entry has been evicted.
+ */
+static std::list<ArtCacheEntry> art_cache;
+
+static const ArtCacheEntry *
+art_cache_lookup(const char *directory) noexcept
+{
+	for (auto i = art_cache.begin(); i != art_cache.end(); ++i)
+		if (i->directory == directory) {
+			/* move to the front (most recently used) */
+			art_cache.splice(art_cache.begin(), art_cache, i);
+			return &art_cache.front();
+		}
 
-	is->Seek(offset);
-	read_size = is->Read(&buffer, CHUNK_SIZE);
+	return nullptr;
+}
 
+static void
+print_art_chunk(Response &r, uint64_t art_file_size,
+		const uint8_t *chunk, size_t chunk_size)
+{
 	r.Format("size: %" PRIu64 "\n"
-			 "binary: %u\n",
-			 art_file_size,
-			 read_size
-			 );
+		 "binary: %u\n",
+		 art_file_size,
+		 unsigned(chunk_size));
 
-	r.Write(buffer, read_size);
+	r.Write(chunk, chunk_size);
 	r.Write("\n");
+}
+
+static CommandResult
+read_stream_art(Response &r, const char *uri, size_t offset)
+{
+	std::string art_directory = PathTraitsUTF8::GetParent(uri);
+
+	const ArtCacheEntry *entry = art_cache_lookup(art_directory.c_str());
+	if (entry == nullptr) {
+		Mutex mutex;
+		Cond cond;
+
+		InputStreamPtr is = find_stream_art(art_directory.c_str(),
+						    mutex, cond);
+
+		if (is == nullptr) {
+			r.Error(ACK_ERROR_NO_EXIST, "No file exists");
+			return CommandResult::ERROR;
+		}
+		if (!is->KnownSize()) {
+			r.Error(ACK_ERROR_NO_EXIST, "Cannot get size for stream");
+			return CommandResult::ERROR;
+		}
+
+		const size_t art_file_size = is->GetSize();
+
+		if (art_file_size > ART_CACHE_MAX_SIZE) {
+			/* too big for the cache: serve this chunk
+			   straight from the stream */
+			constexpr size_t CHUNK_SIZE = 8192;
+			uint8_t buffer[CHUNK_SIZE];
+
+			is->Seek(offset);
+			size_t read_size = is->Read(&buffer, CHUNK_SIZE);
+
+			print_art_chunk(r, art_file_size,
+					buffer, read_size);
+			return CommandResult::OK;
+		}
+
+		std::unique_ptr<uint8_t[]> data(new uint8_t[art_file_size]);
+		is->ReadFull(data.get(), art_file_size);
+
+		art_cache.emplace_front(ArtCacheEntry{std::move(art_directory),
+						      std::move(data),
+						      art_file_size});
+		if (art_cache.size() > ART_CACHE_MAX_ENTRIES)
+			art_cache.pop_back();
+
+		entry = &art_cache.front();
+	}
+
+	if (offset > entry->size) {
+		r.Error(ACK_ERROR_ARG, "Bad file offset");
+		return CommandResult::ERROR;
+	}
+
+	constexpr size_t CHUNK_SIZE = 8192;
+	const size_t read_size = std::min(CHUNK_SIZE, entry->size - offset);
 
+	print_art_chunk(r, entry->size, entry->data.get() + offset, read_size);
 	return CommandResult::OK;
 }
 
@@ -40,9 +40,13 @@
 #include "util/StringAPI.hxx"
 #include "fs/AllocatedPath.hxx"
 #include "Stats.hxx"
+#include "PerfStats.hxx"
+#include "MemoryStats.hxx"
+#include "Profiler.hxx"
 #include "PlaylistFile.hxx"
 #include "db/PlaylistVector.hxx"
 #include "client/Client.hxx"
+#include "client/ClientList.hxx"
 #include "client/Response.hxx"
 #include "Partition.hxx"
 #include "Instance.hxx"
@@ -94,7 +98,7 @@ handle_kill(gcc_unused Client &client, gcc_unused Request request,
 }
 
 static void
-print_tag(TagType type, const char *value, void *ctx)
+print_tag(TagType type, StringView value, void *ctx)
 {
 	auto &r = *(Response *)ctx;
 
@@ -373,6 +377,61 @@ handle_stats(Client &client, gcc_unused Request args, Response &r)
 	return CommandResult::OK;
 }
 
+CommandResult
+handle_perfstats(gcc_unused Client &client, gcc_unused Request args,
+		 Response &r)
+{
+	perf_stats_print(r);
+	return CommandResult::OK;
+}
+
+CommandResult
+handle_memstats(Client &client, gcc_unused Request args, Response &r)
+{
+	memory_stats_print(r, client.GetInstance());
+	return CommandResult::OK;
+}
+
+CommandResult
+handle_clientstats(Client &client, gcc_unused Request args, Response &r)
+{
+	for (const auto &c : *client.GetInstance().client_list) {
+		r.Format("client: %u\n", c.num);
+		if (c.uid >= 0)
+			r.Format("uid: %d\n", c.uid);
+
+		for (const auto &i : c.command_stats)
+			r.Format("command: %s\n"
+				 "count: %lu\n"
+				 "time_us: %lu\n"
+				 "max_us: %lu\n",
+				 i.first.c_str(),
+				 (unsigned long)i.second.count,
+				 (unsigned long)i.second.total_us,
+				 (unsigned long)i.second.max_us);
+	}
+
+	return CommandResult::OK;
+}
+
+CommandResult
+handle_profile(gcc_unused Client &client, Request args, Response &r)
+{
+	const char *cmd = args.front();
+
+	if (StringIsEqual(cmd, "start")) {
+		unsigned hz = args.ParseOptional(1, 99);
+		profiler_start(hz);
+	} else if (StringIsEqual(cmd, "stop")) {
+		profiler_stop(r);
+	} else {
+		r.Error(ACK_ERROR_ARG, "expected \"start\" or \"stop\"");
+		return CommandResult::ERROR;
+	}
+
+	return CommandResult::OK;
+}
+
 CommandResult
 handle_config(Client &client, gcc_unused Request args, Response &r)
 {
@@ -56,6 +56,18 @@ handle_volume(Client &client, Request request, Response &response);
 CommandResult
 handle_stats(Client &client, Request request, Response &response);
 
+CommandResult
+handle_perfstats(Client &client, Request request, Response &response);
+
+CommandResult
+handle_memstats(Client &client, Request request, Response &response);
+
+CommandResult
+handle_clientstats(Client &client, Request request, Response &response);
+
+CommandResult
+handle_profile(Client &client, Request request, Response &response);
+
 CommandResult
 handle_config(Client &client, Request request, Response &response);
 
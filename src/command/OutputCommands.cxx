@@ -22,6 +22,8 @@
 #include "Request.hxx"
 #include "output/Print.hxx"
 #include "output/OutputCommand.hxx"
+#include "output/MultipleOutputs.hxx"
+#include "output/Control.hxx"
 #include "client/Client.hxx"
 #include "client/Response.hxx"
 #include "Partition.hxx"
@@ -126,3 +128,42 @@ handle_devices(Client &client, gcc_unused Request args, Response &r)
 	printAudioDevices(r, client.GetPartition().outputs);
 	return CommandResult::OK;
 }
+
+static constexpr double
+ToMs(std::chrono::steady_clock::duration d) noexcept
+{
+	return std::chrono::duration<double, std::milli>(d).count();
+}
+
+CommandResult
+handle_latencyinfo(Client &client, gcc_unused Request args, Response &r)
+{
+	assert(args.empty());
+
+	const auto &outputs = client.GetPartition().outputs;
+
+	for (unsigned i = 0, n = outputs.Size(); i < n; ++i) {
+		const auto &ao = outputs.Get(i);
+
+		r.Format("outputid: %u\n"
+			 "outputname: %s\n",
+			 i, ao.GetName());
+
+		const auto info = ao.GetLatencyInfo();
+		if (!info.valid)
+			/* nothing has been played since the device
+			   was opened */
+			continue;
+
+		r.Format("pipeline_ms: %.3f\n"
+			 "filter_ms: %.3f\n"
+			 "device_ms: %.3f\n"
+			 "total_ms: %.3f\n",
+			 ToMs(info.pipeline),
+			 ToMs(info.filter),
+			 ToMs(info.device),
+			 ToMs(info.pipeline + info.device));
+	}
+
+	return CommandResult::OK;
+}
@@ -104,6 +104,7 @@ handle_newpartition(Client &client, Request request, Response &response)
 					 16384,
 					 1024,
 					 128,
+					 0,
 					 AudioFormat::Undefined(),
 					 ReplayGainConfig());
 	auto &partition = instance.partitions.back();
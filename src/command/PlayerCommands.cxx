@@ -132,22 +132,15 @@ handle_status(Client &client, gcc_unused Request args, Response &r)
 	if (volume >= 0)
 		r.Format("volume: %i\n", volume);
 
-	r.Format(COMMAND_STATUS_REPEAT ": %i\n"
-		 COMMAND_STATUS_RANDOM ": %i\n"
-		 COMMAND_STATUS_SINGLE ": %i\n"
-		 COMMAND_STATUS_CONSUME ": %i\n"
-		 COMMAND_STATUS_PLAYLIST ": %li\n"
-		 COMMAND_STATUS_PLAYLIST_LENGTH ": %i\n"
-		 COMMAND_STATUS_MIXRAMPDB ": %f\n"
-		 COMMAND_STATUS_STATE ": %s\n",
-		 playlist.GetRepeat(),
-		 playlist.GetRandom(),
-		 playlist.GetSingle(),
-		 playlist.GetConsume(),
-		 (unsigned long)playlist.GetVersion(),
-		 playlist.GetLength(),
-		 pc.GetMixRampDb(),
-		 state);
+	r.WritePair(COMMAND_STATUS_REPEAT, (unsigned)playlist.GetRepeat());
+	r.WritePair(COMMAND_STATUS_RANDOM, (unsigned)playlist.GetRandom());
+	r.WritePair(COMMAND_STATUS_SINGLE, (unsigned)playlist.GetSingle());
+	r.WritePair(COMMAND_STATUS_CONSUME, (unsigned)playlist.GetConsume());
+	r.WritePair(COMMAND_STATUS_PLAYLIST, playlist.GetVersion());
+	r.WritePair(COMMAND_STATUS_PLAYLIST_LENGTH, playlist.GetLength());
+	r.Format(COMMAND_STATUS_MIXRAMPDB ": %f\n",
+		 pc.GetMixRampDb());
+	r.WritePair(COMMAND_STATUS_STATE, state);
 
 	if (pc.GetCrossFade() > 0)
 		r.Format(COMMAND_STATUS_CROSSFADE ": %i\n",
@@ -159,29 +152,27 @@ handle_status(Client &client, gcc_unused Request args, Response &r)
 
 	song = playlist.GetCurrentPosition();
 	if (song >= 0) {
-		r.Format(COMMAND_STATUS_SONG ": %i\n"
-			 COMMAND_STATUS_SONGID ": %u\n",
-			 song, playlist.PositionToId(song));
+		r.WritePair(COMMAND_STATUS_SONG, (unsigned)song);
+		r.WritePair(COMMAND_STATUS_SONGID, playlist.PositionToId(song));
 	}
 
 	if (player_status.state != PlayerState::STOP) {
 		r.Format(COMMAND_STATUS_TIME ": %i:%i\n"
-			 "elapsed: %1.3f\n"
-			 COMMAND_STATUS_BITRATE ": %u\n",
+			 "elapsed: %1.3f\n",
 			 player_status.elapsed_time.RoundS(),
 			 player_status.total_time.IsNegative()
 			 ? 0u
 			 : unsigned(player_status.total_time.RoundS()),
-			 player_status.elapsed_time.ToDoubleS(),
-			 player_status.bit_rate);
+			 player_status.elapsed_time.ToDoubleS());
+		r.WritePair(COMMAND_STATUS_BITRATE, player_status.bit_rate);
 
 		if (!player_status.total_time.IsNegative())
 			r.Format("duration: %1.3f\n",
 				 player_status.total_time.ToDoubleS());
 
 		if (player_status.audio_format.IsDefined())
-			r.Format(COMMAND_STATUS_AUDIO ": %s\n",
-				 ToString(player_status.audio_format).c_str());
+			r.WritePair(COMMAND_STATUS_AUDIO,
+				    ToString(player_status.audio_format).c_str());
 	}
 
 #ifdef ENABLE_DATABASE
@@ -203,10 +194,11 @@ handle_status(Client &client, gcc_unused Request args, Response &r)
 	}
 
 	song = playlist.GetNextPosition();
-	if (song >= 0)
-		r.Format(COMMAND_STATUS_NEXTSONG ": %i\n"
-			 COMMAND_STATUS_NEXTSONGID ": %u\n",
-			 song, playlist.PositionToId(song));
+	if (song >= 0) {
+		r.WritePair(COMMAND_STATUS_NEXTSONG, (unsigned)song);
+		r.WritePair(COMMAND_STATUS_NEXTSONGID,
+			    playlist.PositionToId(song));
+	}
 
 	return CommandResult::OK;
 }
@@ -279,6 +279,15 @@ handle_playlistsearch(Client &client, Request args, Response &r)
 	return handle_playlist_match(client, args, r, true);
 }
 
+CommandResult
+handle_queuefind(Client &client, Request args, Response &r)
+{
+	/* unlike "playlistfind", this looks up the exact URI in the
+	   queue's hash index instead of scanning all items */
+	playlist_print_find_uri(r, client.GetPlaylist(), args.front());
+	return CommandResult::OK;
+}
+
 CommandResult
 handle_prio(Client &client, Request args, gcc_unused Response &r)
 {
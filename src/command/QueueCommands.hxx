@@ -68,6 +68,9 @@ handle_playlistfind(Client &client, Request request, Response &response);
 CommandResult
 handle_playlistsearch(Client &client, Request request, Response &response);
 
+CommandResult
+handle_queuefind(Client &client, Request request, Response &response);
+
 CommandResult
 handle_prio(Client &client, Request request, Response &response);
 
@@ -58,7 +58,11 @@ enum class ConfigOption {
 	VOLUME_NORMALIZATION,
 	SAMPLERATE_CONVERTER,
 	AUDIO_BUFFER_SIZE,
+	AUDIO_BUFFER_NUMA_INTERLEAVE,
+	AUDIO_BUFFER_MLOCK,
 	BUFFER_BEFORE_PLAY,
+	BUFFER_RESERVE_TIME,
+	INPUT_BUFFER_SIZE,
 	HTTP_PROXY_HOST,
 	HTTP_PROXY_PORT,
 	HTTP_PROXY_USER,
@@ -75,9 +79,24 @@ enum class ConfigOption {
 	GAPLESS_MP3_PLAYBACK,
 	AUTO_UPDATE,
 	AUTO_UPDATE_DEPTH,
+	UPDATE_THREADS,
+	UPDATE_SKIP_UNCHANGED,
 	DESPOTIFY_USER,
 	DESPOTIFY_PASSWORD,
 	DESPOTIFY_HIGH_BITRATE,
+	PLAYER_THREAD_AFFINITY,
+	DECODER_THREAD_AFFINITY,
+	OUTPUT_THREAD_AFFINITY,
+	UPDATE_THREAD_AFFINITY,
+	REALTIME_POLICY,
+	REALTIME_PRIORITY,
+	LOG_ASYNC,
+	MEMSTATS_INTERVAL,
+	EVENT_LOOP_BUDGET,
+	REJECT_DUPLICATES,
+	AUDIO_CHUNK_SIZE,
+	PLAYER_TRACE_FILE,
+	ALLOCATION_AUDIT,
 	MAX
 };
 
@@ -53,7 +53,11 @@ const ConfigTemplate config_param_templates[] = {
 	{ "volume_normalization" },
 	{ "samplerate_converter" },
 	{ "audio_buffer_size" },
+	{ "audio_buffer_numa_interleave" },
+	{ "audio_buffer_mlock" },
 	{ "buffer_before_play" },
+	{ "buffer_reserve_time" },
+	{ "input_buffer_size" },
 	{ "http_proxy_host", false, true },
 	{ "http_proxy_port", false, true },
 	{ "http_proxy_user", false, true },
@@ -70,9 +74,24 @@ const ConfigTemplate config_param_templates[] = {
 	{ "gapless_mp3_playback" },
 	{ "auto_update" },
 	{ "auto_update_depth" },
+	{ "update_threads" },
+	{ "update_skip_unchanged" },
 	{ "despotify_user", false, true },
 	{ "despotify_password", false, true },
 	{ "despotify_high_bitrate", false, true },
+	{ "player_thread_affinity" },
+	{ "decoder_thread_affinity" },
+	{ "output_thread_affinity" },
+	{ "update_thread_affinity" },
+	{ "realtime_policy" },
+	{ "realtime_priority" },
+	{ "log_async" },
+	{ "memstats_interval" },
+	{ "event_loop_budget" },
+	{ "reject_duplicates" },
+	{ "audio_chunk_size" },
+	{ "player_trace_file" },
+	{ "allocation_audit" },
 };
 
 static constexpr unsigned n_config_param_templates =
@@ -21,6 +21,7 @@
 #include "Count.hxx"
 #include "Selection.hxx"
 #include "Interface.hxx"
+#include "plugins/simple/SimpleDatabasePlugin.hxx"
 #include "Partition.hxx"
 #include "client/Response.hxx"
 #include "LightSong.hxx"
@@ -118,6 +119,16 @@ PrintSongCount(Response &r, const Partition &partition, const char *name,
 
 		SearchStats stats;
 
+		if (filter == nullptr && db.IsPlugin(simple_db_plugin) &&
+		    ((const SimpleDatabase &)db).GetSongCount(selection,
+							      stats.n_songs,
+							      stats.total_duration)) {
+			/* served from the per-directory aggregates,
+			   without visiting any song */
+			PrintSearchStats(r, stats);
+			return;
+		}
+
 		using namespace std::placeholders;
 		const auto f = std::bind(stats_visitor_song, std::ref(stats),
 					 _1);
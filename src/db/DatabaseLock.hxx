@@ -30,6 +30,8 @@
 #include "thread/Mutex.hxx"
 #include "Compiler.h"
 
+#include <thread>
+
 #include <assert.h>
 
 extern Mutex db_mutex;
@@ -107,6 +109,44 @@ public:
 	}
 };
 
+/**
+ * Like #ScopeDatabaseLock, but for long-running bulk insertions
+ * (loading the database file): Yield() briefly releases the lock
+ * every few calls, so readers can visit the already inserted part of
+ * the tree instead of being starved until the whole load is done.
+ */
+class ScopeDatabaseLoadLock {
+	unsigned counter = 0;
+
+public:
+	ScopeDatabaseLoadLock() {
+		db_lock();
+	}
+
+	~ScopeDatabaseLoadLock() {
+		db_unlock();
+	}
+
+	ScopeDatabaseLoadLock(const ScopeDatabaseLoadLock &) = delete;
+	ScopeDatabaseLoadLock &operator=(const ScopeDatabaseLoadLock &) = delete;
+
+	/**
+	 * Give waiting threads a chance to acquire the database
+	 * lock.  May only be called when the tree is in a consistent
+	 * state.
+	 */
+	void Yield() noexcept {
+		if (++counter % 1024 != 0)
+			return;
+
+		db_unlock();
+		/* without this, we would usually re-acquire the mutex
+		   immediately, because mutexes are not fair */
+		std::this_thread::yield();
+		db_lock();
+	}
+};
+
 /**
  * Unlock the database while in the current scope.
  */
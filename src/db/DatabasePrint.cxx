@@ -19,6 +19,7 @@
 
 #include "config.h"
 #include "DatabasePrint.hxx"
+#include "DatabaseSort.hxx"
 #include "Selection.hxx"
 #include "SongFilter.hxx"
 #include "SongPrint.hxx"
@@ -28,9 +29,11 @@
 #include "client/Response.hxx"
 #include "Partition.hxx"
 #include "tag/Tag.hxx"
+#include "tag/Builder.hxx"
 #include "tag/Mask.hxx"
 #include "LightSong.hxx"
 #include "LightDirectory.hxx"
+#include "plugins/simple/SimpleDatabasePlugin.hxx"
 #include "PlaylistInfo.hxx"
 #include "Interface.hxx"
 #include "fs/Traits.hxx"
@@ -38,6 +41,16 @@
 
 #include <functional>
 
+namespace {
+
+/**
+ * Thrown by the windowed song visitor to terminate the database
+ * visit early once the end of the requested window has been passed.
+ */
+struct StopDatabaseVisit {};
+
+}
+
 static const char *
 ApplyBaseFlag(const char *uri, bool base)
 {
@@ -139,34 +152,22 @@ PrintPlaylistFull(Response &r, bool base,
 		time_print(r, "Last-Modified", playlist.mtime);
 }
 
-static bool
-CompareNumeric(const char *a, const char *b)
-{
-	long a_value = strtol(a, nullptr, 10);
-	long b_value = strtol(b, nullptr, 10);
-
-	return a_value < b_value;
-}
-
-static bool
-CompareTags(TagType type, bool descending, const Tag &a, const Tag &b)
+/**
+ * Copy a #Tag, keeping only the items matching the given mask (plus
+ * the duration and the "has_playlist" flag).
+ */
+static Tag
+FilterTag(const Tag &src, TagMask mask)
 {
-	const char *a_value = a.GetSortValue(type);
-	const char *b_value = b.GetSortValue(type);
+	TagBuilder builder;
+	builder.SetDuration(src.duration);
+	builder.SetHasPlaylist(src.has_playlist);
 
-	if (descending) {
-		using std::swap;
-		swap(a_value, b_value);
-	}
-
-	switch (type) {
-	case TAG_DISC:
-	case TAG_TRACK:
-		return CompareNumeric(a_value, b_value);
+	for (const auto &item : src)
+		if (mask.Test(item.type))
+			builder.AddItem(item.type, item.value);
 
-	default:
-		return strcmp(a_value, b_value) < 0;
-	}
+	return builder.Commit();
 }
 
 void
@@ -193,18 +194,61 @@ db_selection_print(Response &r, Partition &partition,
 		: VisitPlaylist();
 
 	if (sort == TAG_NUM_OF_ITEM_TYPES) {
+		/* without directory/playlist visitors, the visit
+		   delivers only songs, and can be aborted as soon as
+		   the window has been filled; "search"/"find" with a
+		   window are in this category */
+		const bool can_stop_early = selection.filter != nullptr;
+
 		if (window_start > 0 ||
 		    window_end < (unsigned)std::numeric_limits<int>::max())
-			s = [s, window_start, window_end, &i](const LightSong &song){
+			s = [s, window_start, window_end, &i,
+			     can_stop_early](const LightSong &song){
 				const bool in_window = i >= window_start && i < window_end;
 				++i;
 				if (in_window)
 					s(song);
+				else if (can_stop_early && i > window_end)
+					/* everything from here on is
+					   beyond the window: stop
+					   walking the result set */
+					throw StopDatabaseVisit();
 			};
 
-		db.Visit(selection, d, s, p);
+		try {
+			db.Visit(selection, d, s, p);
+		} catch (StopDatabaseVisit) {
+		}
 	} else {
-		// TODO: allow the database plugin to sort internally
+		if (db.IsPlugin(simple_db_plugin)) {
+			/* push the sort down into the database
+			   plugin: it serves repeated queries from its
+			   cache, already in their final order */
+			DatabaseSelection sorted_selection(selection);
+			sorted_selection.sort = sort;
+			sorted_selection.descending = descending;
+
+			const VisitSong ws = [&s, window_start, window_end,
+					      &i](const LightSong &song){
+				const bool in_window = i >= window_start && i < window_end;
+				++i;
+				if (in_window)
+					s(song);
+				else if (i > window_end)
+					throw StopDatabaseVisit();
+			};
+
+			bool handled;
+			try {
+				handled = ((const SimpleDatabase &)db)
+					.VisitSorted(sorted_selection, ws);
+			} catch (StopDatabaseVisit) {
+				handled = true;
+			}
+
+			if (handled)
+				return;
+		}
 
 		/* the client has asked us to sort the result; this is
 		   pretty expensive, because instead of streaming the
@@ -212,29 +256,33 @@ db_selection_print(Response &r, Partition &partition,
 		   this std::vector, and then sort it */
 		std::vector<DetachedSong> songs;
 
+		/* push the client's tag mask down into the copy: tag
+		   items which would not be printed anyway are not
+		   copied at all, which saves a lot of tag pool
+		   traffic for clients which have narrowed their mask
+		   with "tagtypes"; the tags the sort may consult must
+		   be kept even if they are masked */
+		TagMask copy_mask = r.GetTagMask();
+		if (sort != TagType(SORT_TAG_LAST_MODIFIED))
+			copy_mask |= Tag::GetSortValueMask(sort);
+
+		const bool filter_tags = copy_mask != TagMask::All();
+
 		{
-			auto collect_songs = [&songs](const LightSong &song){
-				songs.emplace_back(song);
+			auto collect_songs = [&songs, filter_tags,
+					      copy_mask](const LightSong &song){
+				if (filter_tags)
+					songs.emplace_back(song,
+							   FilterTag(*song.tag,
+								     copy_mask));
+				else
+					songs.emplace_back(song);
 			};
 
 			db.Visit(selection, d, collect_songs, p);
 		}
 
-		if (sort == TagType(SORT_TAG_LAST_MODIFIED))
-			std::stable_sort(songs.begin(), songs.end(),
-					 [descending](const DetachedSong &a, const DetachedSong &b){
-						 return descending
-							 ? a.GetLastModified() > b.GetLastModified()
-							 : a.GetLastModified() < b.GetLastModified();
-					 });
-		else
-			std::stable_sort(songs.begin(), songs.end(),
-					 [sort, descending](const DetachedSong &a,
-							    const DetachedSong &b){
-						 return CompareTags(sort, descending,
-								    a.GetTag(),
-								    b.GetTag());
-					 });
+		SortDetachedSongs(songs, sort, descending);
 
 		if (window_end < songs.size())
 			songs.erase(std::next(songs.begin(), window_end),
@@ -34,8 +34,14 @@ DatabaseDetachSong(const Storage *storage, const LightSong &song)
 	assert(detached.IsInDatabase());
 
 	if (!detached.HasRealURI() && storage != nullptr) {
-		const auto uri = song.GetURI();
-		detached.SetRealURI(storage->MapUTF8(uri.c_str()));
+		if (song.directory == nullptr)
+			/* no directory prefix to compose - skip the
+			   GetURI() temporary */
+			detached.SetRealURI(storage->MapUTF8(song.uri));
+		else {
+			const auto uri = song.GetURI();
+			detached.SetRealURI(storage->MapUTF8(uri.c_str()));
+		}
 	}
 
 	return detached;
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "DatabaseSort.hxx"
+#include "SongFilter.hxx"
+#include "DetachedSong.hxx"
+#include "tag/Tag.hxx"
+
+#include <algorithm>
+
+#include <stdlib.h>
+#include <string.h>
+
+static bool
+CompareNumeric(const char *a, const char *b)
+{
+	long a_value = strtol(a, nullptr, 10);
+	long b_value = strtol(b, nullptr, 10);
+
+	return a_value < b_value;
+}
+
+static bool
+CompareTags(TagType type, bool descending, const Tag &a, const Tag &b)
+{
+	const char *a_value = a.GetSortValue(type);
+	const char *b_value = b.GetSortValue(type);
+
+	if (descending) {
+		using std::swap;
+		swap(a_value, b_value);
+	}
+
+	switch (type) {
+	case TAG_DISC:
+	case TAG_TRACK:
+		return CompareNumeric(a_value, b_value);
+
+	default:
+		return strcmp(a_value, b_value) < 0;
+	}
+}
+
+void
+SortDetachedSongs(std::vector<DetachedSong> &songs,
+		  TagType sort, bool descending)
+{
+	if (sort == TagType(SORT_TAG_LAST_MODIFIED))
+		std::stable_sort(songs.begin(), songs.end(),
+				 [descending](const DetachedSong &a, const DetachedSong &b){
+					 return descending
+						 ? a.GetLastModified() > b.GetLastModified()
+						 : a.GetLastModified() < b.GetLastModified();
+				 });
+	else
+		std::stable_sort(songs.begin(), songs.end(),
+				 [sort, descending](const DetachedSong &a,
+						    const DetachedSong &b){
+					 return CompareTags(sort, descending,
+							    a.GetTag(),
+							    b.GetTag());
+				 });
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_DATABASE_SORT_HXX
+#define MPD_DATABASE_SORT_HXX
+
+#include "tag/Type.h"
+
+#include <vector>
+
+class DetachedSong;
+
+/**
+ * Sort the given songs as requested by the "sort" parameter of
+ * "find"/"search" (a stable sort, so equal songs keep their database
+ * order).
+ *
+ * @param sort the sort tag; #SORT_TAG_LAST_MODIFIED means sort by
+ * file modification time
+ */
+void
+SortDetachedSongs(std::vector<DetachedSong> &songs,
+		  TagType sort, bool descending);
+
+#endif
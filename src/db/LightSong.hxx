@@ -27,6 +27,7 @@
 #include <chrono>
 
 struct Tag;
+struct ReplayGainInfo;
 
 /**
  * A reference to a song file.  Unlike the other "Song" classes in the
@@ -61,6 +62,12 @@ struct LightSong {
 	 */
 	const Tag *tag;
 
+	/**
+	 * The song's replay gain, as collected by the tag scan.  May
+	 * be nullptr if unknown/unavailable.
+	 */
+	const ReplayGainInfo *replay_gain;
+
 	/**
 	 * The time stamp of the last file modification.  A negative
 	 * value means that this is unknown/unavailable.
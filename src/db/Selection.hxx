@@ -21,6 +21,7 @@
 #define MPD_DATABASE_SELECTION_HXX
 
 #include "Compiler.h"
+#include "tag/Type.h"
 
 #include <string>
 
@@ -41,6 +42,21 @@ struct DatabaseSelection {
 
 	const SongFilter *filter;
 
+	/**
+	 * Sort the visited songs by this tag.
+	 * #TAG_NUM_OF_ITEM_TYPES means don't sort;
+	 * #SORT_TAG_LAST_MODIFIED means sort by file modification
+	 * time.  Not all #Database implementations support this
+	 * attribute (see SimpleDatabase::VisitSorted()); callers must
+	 * be prepared to sort the result themselves.
+	 */
+	TagType sort = TAG_NUM_OF_ITEM_TYPES;
+
+	/**
+	 * Sort in reverse order?
+	 */
+	bool descending = false;
+
 	DatabaseSelection(const char *_uri, bool _recursive,
 			  const SongFilter *_filter=nullptr);
 
@@ -44,6 +44,7 @@
 #include <mpd/client.h>
 #include <mpd/async.h>
 
+#include <algorithm>
 #include <cassert>
 #include <string>
 #include <list>
@@ -86,6 +87,14 @@ class ProxyDatabase final : public Database, SocketMonitor, IdleMonitor {
 	const unsigned port;
 	const bool keepalive;
 
+	/**
+	 * The number of "lsinfo" requests sent to the other MPD in one
+	 * command list while walking the directory tree, so a Visit()
+	 * is bounded by bandwidth instead of one round trip per
+	 * directory.
+	 */
+	const unsigned pipeline_depth;
+
 	struct mpd_connection *connection;
 
 	/* this is mutable because GetStats() must be "const" */
@@ -342,7 +351,9 @@ ProxyDatabase::ProxyDatabase(EventLoop &_loop, DatabaseListener &_listener,
 	 listener(_listener),
 	 host(block.GetBlockValue("host", "")),
 	 port(block.GetBlockValue("port", 0u)),
-	 keepalive(block.GetBlockValue("keepalive", false))
+	 keepalive(block.GetBlockValue("keepalive", false)),
+	 pipeline_depth(std::max(block.GetBlockValue("pipeline_depth", 16u),
+				 1u))
 {
 }
 
@@ -556,17 +567,8 @@ ProxyDatabase::ReturnSong(const LightSong *_song) const
 }
 
 static void
-Visit(struct mpd_connection *connection, const char *uri,
-      bool recursive, const SongFilter *filter,
-      VisitDirectory visit_directory, VisitSong visit_song,
-      VisitPlaylist visit_playlist);
-
-static void
-Visit(struct mpd_connection *connection,
-      bool recursive, const SongFilter *filter,
-      const struct mpd_directory *directory,
-      VisitDirectory visit_directory, VisitSong visit_song,
-      VisitPlaylist visit_playlist)
+Visit(bool recursive, const struct mpd_directory *directory,
+      VisitDirectory visit_directory, std::list<std::string> &pending)
 {
 	const char *path = mpd_directory_get_path(directory);
 
@@ -582,8 +584,9 @@ Visit(struct mpd_connection *connection,
 		visit_directory(LightDirectory(path, mtime));
 
 	if (recursive)
-		Visit(connection, path, recursive, filter,
-		      visit_directory, visit_song, visit_playlist);
+		/* schedule this directory for the next "lsinfo"
+		   batch */
+		pending.emplace_back(path);
 }
 
 gcc_pure
@@ -649,6 +652,10 @@ public:
 	}
 };
 
+/**
+ * Receive the entities of one "lsinfo" response, without finishing
+ * the whole (possibly batched) response.
+ */
 static std::list<ProxyEntity>
 ReceiveEntities(struct mpd_connection *connection)
 {
@@ -657,41 +664,80 @@ ReceiveEntities(struct mpd_connection *connection)
 	while ((entity = mpd_recv_entity(connection)) != nullptr)
 		entities.push_back(ProxyEntity(entity));
 
-	mpd_response_finish(connection);
 	return entities;
 }
 
 static void
-Visit(struct mpd_connection *connection, const char *uri,
+Visit(struct mpd_connection *connection, unsigned pipeline_depth,
+      const char *uri,
       bool recursive, const SongFilter *filter,
       VisitDirectory visit_directory, VisitSong visit_song,
       VisitPlaylist visit_playlist)
 {
-	if (!mpd_send_list_meta(connection, uri))
-		ThrowError(connection);
+	/* breadth-first walk: all directories of one level are listed
+	   with one pipelined batch of "lsinfo" requests, so the
+	   number of round trips depends on the depth of the tree, not
+	   on the number of directories */
 
-	std::list<ProxyEntity> entities(ReceiveEntities(connection));
-	CheckError(connection);
+	std::list<std::string> pending;
+	pending.emplace_back(uri);
 
-	for (const auto &entity : entities) {
-		switch (mpd_entity_get_type(entity)) {
-		case MPD_ENTITY_TYPE_UNKNOWN:
-			break;
+	while (!pending.empty()) {
+		std::list<std::string> batch;
+		while (!pending.empty() && batch.size() < pipeline_depth)
+			batch.splice(batch.end(), pending, pending.begin());
 
-		case MPD_ENTITY_TYPE_DIRECTORY:
-			Visit(connection, recursive, filter,
-			      mpd_entity_get_directory(entity),
-			      visit_directory, visit_song, visit_playlist);
-			break;
+		const bool list = batch.size() > 1;
+		if (list && !mpd_command_list_begin(connection, true))
+			ThrowError(connection);
 
-		case MPD_ENTITY_TYPE_SONG:
-			Visit(filter, mpd_entity_get_song(entity), visit_song);
-			break;
+		for (const auto &i : batch)
+			if (!mpd_send_list_meta(connection, i.c_str()))
+				ThrowError(connection);
 
-		case MPD_ENTITY_TYPE_PLAYLIST:
-			Visit(mpd_entity_get_playlist(entity),
-			      visit_playlist);
-			break;
+		if (list && !mpd_command_list_end(connection))
+			ThrowError(connection);
+
+		/* receive all responses before invoking the visitors,
+		   so a throwing visitor cannot leave the connection in
+		   the middle of a response */
+		std::list<std::list<ProxyEntity>> responses;
+		for (size_t remaining = batch.size(); remaining > 0;
+		     --remaining) {
+			responses.emplace_back(ReceiveEntities(connection));
+
+			if (list && remaining > 1 &&
+			    !mpd_response_next(connection))
+				ThrowError(connection);
+		}
+
+		if (!mpd_response_finish(connection))
+			ThrowError(connection);
+
+		for (const auto &entities : responses) {
+			for (const auto &entity : entities) {
+				switch (mpd_entity_get_type(entity)) {
+				case MPD_ENTITY_TYPE_UNKNOWN:
+					break;
+
+				case MPD_ENTITY_TYPE_DIRECTORY:
+					Visit(recursive,
+					      mpd_entity_get_directory(entity),
+					      visit_directory, pending);
+					break;
+
+				case MPD_ENTITY_TYPE_SONG:
+					Visit(filter,
+					      mpd_entity_get_song(entity),
+					      visit_song);
+					break;
+
+				case MPD_ENTITY_TYPE_PLAYLIST:
+					Visit(mpd_entity_get_playlist(entity),
+					      visit_playlist);
+					break;
+				}
+			}
 		}
 	}
 }
@@ -766,7 +812,7 @@ ProxyDatabase::Visit(const DatabaseSelection &selection,
 	}
 
 	/* fall back to recursive walk (slow!) */
-	::Visit(connection, selection.uri.c_str(),
+	::Visit(connection, pipeline_depth, selection.uri.c_str(),
 		selection.recursive, selection.filter,
 		visit_directory, visit_song, visit_playlist);
 }
@@ -0,0 +1,426 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "DatabaseBinary.hxx"
+#include "Directory.hxx"
+#include "Song.hxx"
+#include "db/DatabaseLock.hxx"
+#include "db/PlaylistVector.hxx"
+#include "DetachedSong.hxx"
+#include "fs/io/BufferedOutputStream.hxx"
+#include "fs/io/FileReader.hxx"
+#include "fs/Charset.hxx"
+#include "tag/Tag.hxx"
+#include "tag/Builder.hxx"
+#include "tag/ParseName.hxx"
+#include "tag/Settings.hxx"
+#include "util/ChronoUtil.hxx"
+#include "util/RuntimeError.hxx"
+#include "util/ScopeExit.hxx"
+
+#include <memory>
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+static constexpr uint32_t BINARY_DB_MAGIC = 0x4d504442; /* "MPDB" */
+static constexpr uint32_t BINARY_DB_FORMAT = 1;
+
+/* Directory::device values are stored as one byte */
+static constexpr uint8_t BINARY_DEVICE_PLAIN = 0;
+static constexpr uint8_t BINARY_DEVICE_INARCHIVE = 1;
+static constexpr uint8_t BINARY_DEVICE_CONTAINER = 2;
+
+namespace {
+
+/**
+ * Serializes scalars and length-prefixed strings to an
+ * #OutputStream.  All integers are written in host byte order; the
+ * file is a local cache, not an interchange format.
+ */
+class BinaryWriter {
+	BufferedOutputStream &os;
+
+public:
+	explicit BinaryWriter(BufferedOutputStream &_os):os(_os) {}
+
+	void WriteU8(uint8_t value) {
+		os.Write(&value, sizeof(value));
+	}
+
+	void WriteU16(uint16_t value) {
+		os.Write(&value, sizeof(value));
+	}
+
+	void WriteU32(uint32_t value) {
+		os.Write(&value, sizeof(value));
+	}
+
+	void WriteU64(uint64_t value) {
+		os.Write(&value, sizeof(value));
+	}
+
+	void WriteString(const char *s) {
+		const size_t length = strlen(s);
+		WriteU32(length);
+		os.Write(s, length);
+	}
+
+	void WriteTimePoint(std::chrono::system_clock::time_point t) {
+		WriteU64(IsNegative(t)
+			 ? uint64_t(0)
+			 : uint64_t(std::chrono::system_clock::to_time_t(t)));
+	}
+};
+
+/**
+ * A bounds-checked cursor over the raw bytes of a binary database
+ * file.  Throws std::runtime_error when the file is truncated.
+ */
+class BinaryReader {
+	const uint8_t *p;
+	const uint8_t *const end;
+
+public:
+	BinaryReader(const void *data, size_t size)
+		:p((const uint8_t *)data), end(p + size) {}
+
+	bool IsEmpty() const {
+		return p == end;
+	}
+
+	const void *ReadRaw(size_t size) {
+		if (size_t(end - p) < size)
+			throw std::runtime_error("Truncated binary database file");
+
+		const void *result = p;
+		p += size;
+		return result;
+	}
+
+	uint8_t ReadU8() {
+		uint8_t value;
+		memcpy(&value, ReadRaw(sizeof(value)), sizeof(value));
+		return value;
+	}
+
+	uint16_t ReadU16() {
+		uint16_t value;
+		memcpy(&value, ReadRaw(sizeof(value)), sizeof(value));
+		return value;
+	}
+
+	uint32_t ReadU32() {
+		uint32_t value;
+		memcpy(&value, ReadRaw(sizeof(value)), sizeof(value));
+		return value;
+	}
+
+	uint64_t ReadU64() {
+		uint64_t value;
+		memcpy(&value, ReadRaw(sizeof(value)), sizeof(value));
+		return value;
+	}
+
+	std::string ReadString() {
+		const size_t length = ReadU32();
+		const char *data = (const char *)ReadRaw(length);
+		return std::string(data, length);
+	}
+
+	std::chrono::system_clock::time_point ReadTimePoint() {
+		const uint64_t value = ReadU64();
+		return value == 0
+			? std::chrono::system_clock::time_point::min()
+			: std::chrono::system_clock::from_time_t(value);
+	}
+};
+
+}
+
+gcc_const
+static uint8_t
+DeviceToBinary(unsigned device) noexcept
+{
+	switch (device) {
+	case DEVICE_INARCHIVE:
+		return BINARY_DEVICE_INARCHIVE;
+
+	case DEVICE_CONTAINER:
+		return BINARY_DEVICE_CONTAINER;
+
+	default:
+		return BINARY_DEVICE_PLAIN;
+	}
+}
+
+gcc_const
+static unsigned
+DeviceFromBinary(uint8_t value) noexcept
+{
+	switch (value) {
+	case BINARY_DEVICE_INARCHIVE:
+		return DEVICE_INARCHIVE;
+
+	case BINARY_DEVICE_CONTAINER:
+		return DEVICE_CONTAINER;
+
+	default:
+		return 0;
+	}
+}
+
+static void
+SaveSong(BinaryWriter &w, const Song &song)
+{
+	w.WriteString(song.uri);
+	w.WriteTimePoint(song.mtime);
+	w.WriteU32(song.start_time.ToMS());
+	w.WriteU32(song.end_time.ToMS());
+
+	const Tag &tag = song.tag;
+	w.WriteU32(tag.duration.IsNegative()
+		   ? uint32_t(-1)
+		   : uint32_t(tag.duration.ToMS()));
+	w.WriteU8(tag.has_playlist);
+	w.WriteU16(tag.num_items);
+
+	for (const auto &item : tag) {
+		w.WriteU8(item.type);
+		w.WriteString(item.value);
+	}
+}
+
+static void
+SaveDirectory(BinaryWriter &w, const Directory &directory)
+{
+	uint32_t n_children = 0;
+	for (const auto &child : directory.children)
+		if (!child.IsMount())
+			++n_children;
+
+	w.WriteU32(n_children);
+
+	for (const auto &child : directory.children) {
+		if (child.IsMount())
+			continue;
+
+		w.WriteString(child.GetName());
+		w.WriteTimePoint(child.mtime);
+		w.WriteU8(DeviceToBinary(child.device));
+
+		SaveDirectory(w, child);
+	}
+
+	uint32_t n_songs = 0;
+	for (const auto &song : directory.songs) {
+		(void)song;
+		++n_songs;
+	}
+
+	w.WriteU32(n_songs);
+	for (const auto &song : directory.songs)
+		SaveSong(w, song);
+
+	uint32_t n_playlists = 0;
+	for (const auto &pi : directory.playlists) {
+		(void)pi;
+		++n_playlists;
+	}
+
+	w.WriteU32(n_playlists);
+	for (const auto &pi : directory.playlists) {
+		w.WriteString(pi.name.c_str());
+		w.WriteTimePoint(pi.mtime);
+	}
+}
+
+void
+db_binary_save(BufferedOutputStream &os, const Directory &music_root)
+{
+	BinaryWriter w(os);
+
+	w.WriteU32(BINARY_DB_MAGIC);
+	w.WriteU32(BINARY_DB_FORMAT);
+	w.WriteString(GetFSCharset());
+
+	uint32_t n_tags = 0;
+	for (unsigned i = 0; i < TAG_NUM_OF_ITEM_TYPES; ++i)
+		if (IsTagEnabled(i))
+			++n_tags;
+
+	w.WriteU32(n_tags);
+	for (unsigned i = 0; i < TAG_NUM_OF_ITEM_TYPES; ++i)
+		if (IsTagEnabled(i))
+			w.WriteString(tag_item_names[i]);
+
+	SaveDirectory(w, music_root);
+}
+
+static void
+LoadSong(BinaryReader &r, Directory &directory)
+{
+	const auto uri = r.ReadString();
+
+	if (directory.FindSong(uri.c_str()) != nullptr)
+		throw FormatRuntimeError("Duplicate song '%s'", uri.c_str());
+
+	DetachedSong song(uri.c_str());
+	song.SetLastModified(r.ReadTimePoint());
+	song.SetStartTime(SongTime::FromMS(r.ReadU32()));
+	song.SetEndTime(SongTime::FromMS(r.ReadU32()));
+
+	const uint32_t duration_ms = r.ReadU32();
+	const bool has_playlist = r.ReadU8();
+	const unsigned n_items = r.ReadU16();
+
+	TagBuilder tag;
+	if (duration_ms != uint32_t(-1))
+		tag.SetDuration(SignedSongTime::FromMS(duration_ms));
+	tag.SetHasPlaylist(has_playlist);
+
+	for (unsigned i = 0; i < n_items; ++i) {
+		const uint8_t type = r.ReadU8();
+		const auto value = r.ReadString();
+
+		if (type >= TAG_NUM_OF_ITEM_TYPES)
+			throw std::runtime_error("Unrecognized tag in binary database file");
+
+		tag.AddItem(TagType(type), value.c_str());
+	}
+
+	song.SetTag(tag.Commit());
+
+	directory.AddSong(Song::NewFrom(std::move(song), directory));
+}
+
+static void
+LoadDirectory(BinaryReader &r, Directory &directory,
+	      ScopeDatabaseLoadLock &lock)
+{
+	const uint32_t n_children = r.ReadU32();
+	for (uint32_t i = 0; i < n_children; ++i) {
+		const auto name = r.ReadString();
+
+		if (directory.FindChild(name.c_str()) != nullptr)
+			throw FormatRuntimeError("Duplicate subdirectory '%s'",
+						 name.c_str());
+
+		Directory *child = directory.CreateChild(name.c_str());
+		child->mtime = r.ReadTimePoint();
+		child->device = DeviceFromBinary(r.ReadU8());
+
+		LoadDirectory(r, *child, lock);
+	}
+
+	const uint32_t n_songs = r.ReadU32();
+	for (uint32_t i = 0; i < n_songs; ++i) {
+		LoadSong(r, directory);
+		lock.Yield();
+	}
+
+	const uint32_t n_playlists = r.ReadU32();
+	for (uint32_t i = 0; i < n_playlists; ++i) {
+		auto name = r.ReadString();
+		const auto mtime = r.ReadTimePoint();
+		directory.playlists.UpdateOrInsert(PlaylistInfo(std::move(name),
+								mtime));
+	}
+}
+
+static void
+LoadBuffer(const void *data, size_t size, Directory &music_root)
+{
+	BinaryReader r(data, size);
+
+	if (r.ReadU32() != BINARY_DB_MAGIC)
+		throw std::runtime_error("Not a binary database file");
+
+	if (r.ReadU32() != BINARY_DB_FORMAT)
+		throw std::runtime_error("Binary database format mismatch, "
+					 "discarding database file");
+
+	const auto charset = r.ReadString();
+	const char *const old_charset = GetFSCharset();
+	if (*old_charset != 0 && charset != old_charset)
+		throw FormatRuntimeError("Existing database has charset "
+					 "\"%s\" instead of \"%s\"; "
+					 "discarding database file",
+					 charset.c_str(), old_charset);
+
+	bool tags[TAG_NUM_OF_ITEM_TYPES];
+	memset(tags, false, sizeof(tags));
+
+	const uint32_t n_tags = r.ReadU32();
+	for (uint32_t i = 0; i < n_tags; ++i) {
+		const auto name = r.ReadString();
+		TagType tag = tag_name_parse(name.c_str());
+		if (tag == TAG_NUM_OF_ITEM_TYPES)
+			throw FormatRuntimeError("Unrecognized tag '%s', "
+						 "discarding database file",
+						 name.c_str());
+
+		tags[tag] = true;
+	}
+
+	for (unsigned i = 0; i < TAG_NUM_OF_ITEM_TYPES; ++i)
+		if (IsTagEnabled(i) && !tags[i])
+			throw std::runtime_error("Tag list mismatch, "
+						 "discarding database file");
+
+	ScopeDatabaseLoadLock protect;
+	LoadDirectory(r, music_root, protect);
+
+	if (!r.IsEmpty())
+		throw std::runtime_error("Trailing garbage in binary database file");
+}
+
+void
+db_binary_load(Path path, Directory &music_root)
+{
+	FileReader file(path);
+	const uint64_t size = file.GetSize();
+
+#ifndef _WIN32
+	/* map the file; parsing only bumps a pointer over the
+	   mapping, so a warm start touches each page exactly once */
+	void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED,
+			  file.GetFD().Get(), 0);
+	if (data != MAP_FAILED) {
+		AtScopeExit(data, size) { munmap(data, size); };
+		madvise(data, size, MADV_SEQUENTIAL);
+		/* start asynchronous read-ahead of the whole file
+		   now, so parsing overlaps with the disk instead of
+		   stalling on each page fault */
+		madvise(data, size, MADV_WILLNEED);
+		LoadBuffer(data, size, music_root);
+		return;
+	}
+#endif
+
+	/* fall back to reading the whole file into memory */
+	std::unique_ptr<uint8_t[]> buffer(new uint8_t[size]);
+	size_t nbytes = file.Read(buffer.get(), size);
+	LoadBuffer(buffer.get(), nbytes, music_root);
+}
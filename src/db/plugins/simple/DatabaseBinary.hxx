@@ -0,0 +1,49 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_DATABASE_BINARY_HXX
+#define MPD_DATABASE_BINARY_HXX
+
+#include "check.h"
+
+struct Directory;
+class BufferedOutputStream;
+class Path;
+
+/**
+ * Write the whole database to the given stream using the compact
+ * binary format.  Unlike the text format, this is not meant to be
+ * portable between hosts; it is a cache that can be re-parsed without
+ * any per-line text processing.
+ */
+void
+db_binary_save(BufferedOutputStream &os, const Directory &music_root);
+
+/**
+ * Load the database from a binary database file written by
+ * db_binary_save().  The file is mapped (or read in one piece) and
+ * parsed sequentially.
+ *
+ * Throws on error, e.g. if the file is not a binary database or was
+ * written with an incompatible tag configuration.
+ */
+void
+db_binary_load(Path path, Directory &music_root);
+
+#endif
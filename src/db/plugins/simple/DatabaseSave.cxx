@@ -24,12 +24,16 @@
 #include "DirectorySave.hxx"
 #include "fs/io/BufferedOutputStream.hxx"
 #include "fs/io/TextFile.hxx"
+#include "fs/io/MmapTextFile.hxx"
 #include "tag/ParseName.hxx"
 #include "tag/Settings.hxx"
 #include "fs/Charset.hxx"
+#include "fs/Path.hxx"
 #include "util/StringCompare.hxx"
 #include "util/RuntimeError.hxx"
 
+#include <memory>
+
 #include <string.h>
 #include <stdlib.h>
 
@@ -65,7 +69,7 @@ db_save_internal(BufferedOutputStream &os, const Directory &music_root)
 }
 
 void
-db_load_internal(TextFile &file, Directory &music_root)
+db_load_internal(LineReader &file, Directory &music_root)
 {
 	char *line;
 	unsigned format = 0;
@@ -127,6 +131,26 @@ db_load_internal(TextFile &file, Directory &music_root)
 			throw std::runtime_error("Tag list mismatch, "
 						 "discarding database file");
 
-	const ScopeDatabaseLock protect;
-	directory_load(file, music_root);
+	ScopeDatabaseLoadLock protect;
+	directory_load(file, music_root, protect);
+}
+
+void
+db_load_internal(Path path, Directory &music_root)
+{
+	std::unique_ptr<MmapTextFile> mapped;
+
+	try {
+		mapped.reset(new MmapTextFile(path));
+	} catch (...) {
+		/* cannot map the file (or it is gzip-compressed):
+		   fall back to the buffered reader below */
+	}
+
+	if (mapped != nullptr) {
+		db_load_internal(*mapped, music_root);
+	} else {
+		TextFile file(path);
+		db_load_internal(file, music_root);
+	}
 }
@@ -22,7 +22,8 @@
 
 struct Directory;
 class BufferedOutputStream;
-class TextFile;
+class LineReader;
+class Path;
 
 void
 db_save_internal(BufferedOutputStream &os, const Directory &root);
@@ -31,6 +32,17 @@ db_save_internal(BufferedOutputStream &os, const Directory &root);
  * Throws #std::runtime_error on error.
  */
 void
-db_load_internal(TextFile &file, Directory &root);
+db_load_internal(LineReader &file, Directory &root);
+
+/**
+ * Load the text format database from the given file.  This attempts
+ * to parse the file in place via a memory mapping, falling back to
+ * buffered line reads if the file cannot be mapped (e.g. because it
+ * is gzip-compressed).
+ *
+ * Throws #std::runtime_error on error.
+ */
+void
+db_load_internal(Path path, Directory &root);
 
 #endif
@@ -31,15 +31,20 @@
 #include "lib/icu/Collate.hxx"
 #include "fs/Traits.hxx"
 #include "util/Alloc.hxx"
+#include "util/AllocatedString.hxx"
 #include "util/DeleteDisposer.hxx"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
 
-Directory::Directory(std::string &&_path_utf8, Directory *_parent)
+Directory::Directory(std::string &&_name_utf8, Directory *_parent)
 	:parent(_parent),
-	 path(std::move(_path_utf8))
+	 name(std::move(_name_utf8))
 {
 }
 
@@ -57,16 +62,49 @@ Directory::Delete()
 	assert(holding_db_lock());
 	assert(parent != nullptr);
 
+	/* subtract this subtree's aggregates from all ancestors */
+	for (Directory *d = parent; d != nullptr; d = d->parent) {
+		assert(d->total_song_count >= total_song_count);
+		assert(d->total_duration >= total_duration);
+
+		d->total_song_count -= total_song_count;
+		d->total_duration -= total_duration;
+	}
+
+	parent->child_index.erase(GetName());
 	parent->children.erase_and_dispose(parent->children.iterator_to(*this),
 					   DeleteDisposer());
 }
 
-const char *
-Directory::GetName() const noexcept
+std::string
+Directory::GetPath() const noexcept
+{
+	if (IsRoot())
+		return std::string();
+
+	/* compute the result length first, so the string is
+	   allocated exactly once */
+	size_t length = name.length();
+	for (const Directory *i = parent; !i->IsRoot(); i = i->parent)
+		length += i->name.length() + 1;
+
+	std::string result;
+	result.reserve(length);
+	BuildPath(result);
+	return result;
+}
+
+void
+Directory::BuildPath(std::string &result) const noexcept
 {
 	assert(!IsRoot());
 
-	return PathTraitsUTF8::GetBase(path.c_str());
+	if (!parent->IsRoot()) {
+		parent->BuildPath(result);
+		result.push_back(PathTraitsUTF8::SEPARATOR);
+	}
+
+	result.append(name);
 }
 
 Directory *
@@ -76,25 +114,19 @@ Directory::CreateChild(const char *name_utf8)
 	assert(name_utf8 != nullptr);
 	assert(*name_utf8 != 0);
 
-	std::string path_utf8 = IsRoot()
-		? std::string(name_utf8)
-		: PathTraitsUTF8::Build(GetPath(), name_utf8);
-
-	Directory *child = new Directory(std::move(path_utf8), this);
+	Directory *child = new Directory(std::string(name_utf8), this);
 	children.push_back(*child);
+	child_index.emplace(child->GetName(), child);
 	return child;
 }
 
 const Directory *
-Directory::FindChild(const char *name) const noexcept
+Directory::FindChild(const char *name_utf8) const noexcept
 {
 	assert(holding_db_lock());
 
-	for (const auto &child : children)
-		if (strcmp(child.GetName(), name) == 0)
-			return &child;
-
-	return nullptr;
+	auto i = child_index.find(name_utf8);
+	return i != child_index.end() ? i->second : nullptr;
 }
 
 void
@@ -106,10 +138,11 @@ Directory::PruneEmpty() noexcept
 	     child != end;) {
 		child->PruneEmpty();
 
-		if (child->IsEmpty() && !child->IsMount())
+		if (child->IsEmpty() && !child->IsMount()) {
+			child_index.erase(child->GetName());
 			child = children.erase_and_dispose(child,
 							   DeleteDisposer());
-		else
+		} else
 			++child;
 	}
 }
@@ -123,18 +156,35 @@ Directory::LookupDirectory(const char *uri) noexcept
 	if (isRootDirectory(uri))
 		return { this, nullptr };
 
-	char *duplicated = xstrdup(uri), *name = duplicated;
-
 	Directory *d = this;
+	const char *name_utf8 = uri;
 	while (true) {
-		char *slash = strchr(name, '/');
-		if (slash == name)
+		const char *slash = strchr(name_utf8, '/');
+		if (slash == name_utf8)
 			break;
 
-		if (slash != nullptr)
-			*slash = '\0';
+		Directory *tmp;
+		if (slash == nullptr) {
+			tmp = d->FindChild(name_utf8);
+		} else {
+			/* copy the segment into a null-terminated
+			   stack buffer, so the index lookup does not
+			   require a heap allocation */
+			char buffer[256];
+			const size_t length = slash - name_utf8;
+			if (length < sizeof(buffer)) {
+				memcpy(buffer, name_utf8, length);
+				buffer[length] = '\0';
+				tmp = d->FindChild(buffer);
+			} else {
+				/* pathologically long segment: rare
+				   enough to afford the allocation */
+				char *allocated = xstrndup(name_utf8, length);
+				tmp = d->FindChild(allocated);
+				free(allocated);
+			}
+		}
 
-		Directory *tmp = d->FindChild(name);
 		if (tmp == nullptr)
 			/* not found */
 			break;
@@ -143,20 +193,14 @@ Directory::LookupDirectory(const char *uri) noexcept
 
 		if (slash == nullptr) {
 			/* found everything */
-			name = nullptr;
+			name_utf8 = nullptr;
 			break;
 		}
 
-		name = slash + 1;
+		name_utf8 = slash + 1;
 	}
 
-	free(duplicated);
-
-	const char *rest = name == nullptr
-		? nullptr
-		: uri + (name - duplicated);
-
-	return { d, rest };
+	return { d, name_utf8 };
 }
 
 void
@@ -167,6 +211,9 @@ Directory::AddSong(Song *song)
 	assert(song->parent == this);
 
 	songs.push_back(*song);
+	song_index.emplace(song->uri, song);
+
+	ApplySongAggregates(*song, 1);
 }
 
 void
@@ -176,48 +223,192 @@ Directory::RemoveSong(Song *song) noexcept
 	assert(song != nullptr);
 	assert(song->parent == this);
 
+	song_index.erase(song->uri);
 	songs.erase(songs.iterator_to(*song));
+
+	ApplySongAggregates(*song, -1);
 }
 
-const Song *
-Directory::FindSong(const char *name_utf8) const noexcept
+/**
+ * One song's contribution to the duration aggregates; unknown
+ * durations count as zero.
+ */
+static std::chrono::duration<uint64_t, SongTime::period>
+AggregateDuration(SignedSongTime duration) noexcept
+{
+	if (duration.IsNegative())
+		return {};
+
+	return std::chrono::duration<uint64_t, SongTime::period>(duration.count());
+}
+
+void
+Directory::ApplySongAggregates(const Song &song, int sign) noexcept
 {
 	assert(holding_db_lock());
-	assert(name_utf8 != nullptr);
+	assert(sign == 1 || sign == -1);
+
+	const auto duration = AggregateDuration(song.GetDuration());
+
+	for (Directory *d = this; d != nullptr; d = d->parent) {
+		if (sign > 0) {
+			++d->total_song_count;
+			d->total_duration += duration;
+
+			if (song.mtime > d->max_song_mtime)
+				d->max_song_mtime = song.mtime;
+
+			d->tag_bloom.AddTag(song.tag);
+		} else {
+			assert(d->total_song_count > 0);
+			assert(d->total_duration >= duration);
 
-	for (auto &song : songs) {
-		assert(song.parent == this);
+			--d->total_song_count;
+			d->total_duration -= duration;
+		}
+	}
+}
 
-		if (strcmp(song.uri, name_utf8) == 0)
-			return &song;
+void
+Directory::UpdateSongDuration(SignedSongTime old_duration,
+			      SignedSongTime new_duration) noexcept
+{
+	assert(holding_db_lock());
+
+	const auto old_value = AggregateDuration(old_duration);
+	const auto new_value = AggregateDuration(new_duration);
+	if (old_value == new_value)
+		return;
+
+	for (Directory *d = this; d != nullptr; d = d->parent) {
+		assert(d->total_duration >= old_value);
+
+		d->total_duration -= old_value;
+		d->total_duration += new_value;
 	}
+}
 
-	return nullptr;
+void
+Directory::NoteSongMtime(std::chrono::system_clock::time_point song_mtime) noexcept
+{
+	assert(holding_db_lock());
+
+	for (Directory *d = this; d != nullptr && d->max_song_mtime < song_mtime;
+	     d = d->parent)
+		d->max_song_mtime = song_mtime;
+}
+
+void
+Directory::NoteSongTag(const Tag &tag) noexcept
+{
+	assert(holding_db_lock());
+
+	for (Directory *d = this; d != nullptr; d = d->parent)
+		d->tag_bloom.AddTag(tag);
+}
+
+const Song *
+Directory::FindSong(const char *name_utf8) const noexcept
+{
+	assert(holding_db_lock());
+	assert(name_utf8 != nullptr);
+
+	auto i = song_index.find(name_utf8);
+	return i != song_index.end() ? i->second : nullptr;
 }
 
+#ifndef HAVE_ICU
+
 gcc_pure
 static bool
 directory_cmp(const Directory &a, const Directory &b) noexcept
 {
-	return IcuCollate(a.path.c_str(), b.path.c_str()) < 0;
+	return IcuCollate(a.name.c_str(), b.name.c_str()) < 0;
 }
 
+#endif
+
 void
 Directory::Sort() noexcept
 {
 	assert(holding_db_lock());
 
+#ifdef HAVE_ICU
+	/* precompute one collation key per child and sort with
+	   byte-wise key comparisons (cf. song_list_sort()) */
+
+	std::vector<std::pair<AllocatedString<>, Directory *>> keys;
+	for (auto &child : children)
+		keys.emplace_back(IcuSortKey(child.name.c_str()), &child);
+
+	std::stable_sort(keys.begin(), keys.end(),
+			 [](const decltype(keys)::value_type &a,
+			    const decltype(keys)::value_type &b){
+				 if (!a.first.IsNull() && !b.first.IsNull())
+					 return strcmp(a.first.c_str(),
+						       b.first.c_str()) < 0;
+
+				 /* key computation failed; collate
+				    the original strings */
+				 return IcuCollate(a.second->name.c_str(),
+						   b.second->name.c_str()) < 0;
+			 });
+
+	children.clear();
+	for (auto &i : keys)
+		children.push_back(*i.second);
+#else
 	children.sort(directory_cmp);
+#endif
+
 	song_list_sort(songs);
 
 	for (auto &child : children)
 		child.Sort();
 }
 
+size_t
+Directory::GetTotalMemoryUsage() const noexcept
+{
+	assert(holding_db_lock());
+
+	size_t result = sizeof(*this) + name.length();
+
+	for (const auto &song : songs)
+		result += sizeof(song) + strlen(song.uri)
+			+ song.tag.num_items * sizeof(TagItem *);
+
+	for (const auto &child : children)
+		result += child.GetTotalMemoryUsage();
+
+	return result;
+}
+
 void
 Directory::Walk(bool recursive, const SongFilter *filter,
 		VisitDirectory visit_directory, VisitSong visit_song,
 		VisitPlaylist visit_playlist) const
+{
+	/* pre-compute the filter's pruning keys once for the whole
+	   walk; especially the Bloom filter probe involves case
+	   folding the needles, which must not happen once per
+	   directory */
+	const auto since = filter != nullptr
+		? filter->GetModifiedSince()
+		: std::chrono::system_clock::time_point::min();
+	const TagBloomQuery bloom_query(filter);
+
+	Walk2(recursive, filter, bloom_query, since,
+	      std::move(visit_directory), std::move(visit_song),
+	      std::move(visit_playlist));
+}
+
+void
+Directory::Walk2(bool recursive, const SongFilter *filter,
+		 const TagBloomQuery &bloom_query,
+		 std::chrono::system_clock::time_point since,
+		 VisitDirectory visit_directory, VisitSong visit_song,
+		 VisitPlaylist visit_playlist) const
 {
 	if (IsMount()) {
 		assert(IsEmpty());
@@ -226,39 +417,56 @@ Directory::Walk(bool recursive, const SongFilter *filter,
 		   because the child's SimpleDatabasePlugin::Visit()
 		   call will lock it again */
 		const ScopeDatabaseUnlock unlock;
-		WalkMount(GetPath(), *mounted_database,
+		WalkMount(GetPath().c_str(), *mounted_database,
 			  "", recursive, filter,
 			  visit_directory, visit_song,
 			  visit_playlist);
 		return;
 	}
 
-	if (visit_song) {
+	/* compose this directory's URI once for all songs and
+	   playlists in it */
+	const std::string path_utf8 = GetPath();
+
+	if (visit_song && max_song_mtime >= since &&
+	    bloom_query.MayMatch(tag_bloom)) {
+		const char *directory_uri = IsRoot()
+			? nullptr : path_utf8.c_str();
+
 		for (auto &song : songs){
-			const LightSong song2 = song.Export();
+			const LightSong song2 = song.Export(directory_uri);
 			if (filter == nullptr || filter->Match(song2))
 				visit_song(song2);
 		}
 	}
 
 	if (visit_playlist) {
+		const LightDirectory light(path_utf8.c_str(), mtime);
+
 		for (const PlaylistInfo &p : playlists)
-			visit_playlist(p, Export());
+			visit_playlist(p, light);
 	}
 
 	for (auto &child : children) {
-		if (visit_directory)
-			visit_directory(child.Export());
+		if (visit_directory) {
+			const std::string child_path = child.GetPath();
+			visit_directory(LightDirectory(child_path.c_str(),
+						       child.mtime));
+		}
 
-		if (recursive)
-			child.Walk(recursive, filter,
-				   visit_directory, visit_song,
-				   visit_playlist);
+		if (recursive) {
+			if (!visit_directory && !visit_playlist &&
+			    !child.IsMount() &&
+			    (child.max_song_mtime < since ||
+			     !bloom_query.MayMatch(child.tag_bloom)))
+				/* no song in this subtree can match
+				   the filter, and nothing else is
+				   being visited */
+				continue;
+
+			child.Walk2(recursive, filter, bloom_query, since,
+				    visit_directory, visit_song,
+				    visit_playlist);
+		}
 	}
 }
-
-LightDirectory
-Directory::Export() const noexcept
-{
-	return LightDirectory(GetPath(), mtime);
-}
@@ -25,10 +25,15 @@
 #include "db/Visitor.hxx"
 #include "db/PlaylistVector.hxx"
 #include "Song.hxx"
+#include "SongSlab.hxx"
+#include "TagBloomFilter.hxx"
 
 #include <boost/intrusive/list.hpp>
 
 #include <string>
+#include <unordered_map>
+
+#include <string.h>
 
 /**
  * Virtual directory that is really an archive file or a folder inside
@@ -74,6 +79,52 @@ struct Directory {
 	 */
 	List children;
 
+private:
+	struct NameHash {
+		gcc_pure
+		size_t operator()(const char *s) const noexcept {
+			size_t hash = 5381;
+			while (*s != 0)
+				hash = (hash << 5) + hash + *s++;
+			return hash;
+		}
+	};
+
+	struct NameEqual {
+		gcc_pure
+		bool operator()(const char *a, const char *b) const noexcept {
+			return strcmp(a, b) == 0;
+		}
+	};
+
+	/**
+	 * Maps a child directory's base name to the child, to make
+	 * FindChild() O(1).  The key points into the child's #name
+	 * attribute.
+	 *
+	 * This attribute is protected with the global #db_mutex.
+	 */
+	std::unordered_map<const char *, Directory *,
+			   NameHash, NameEqual> child_index;
+
+	/**
+	 * Maps a song's file name to the #Song, to make FindSong()
+	 * O(1).  The key points into the song's #uri attribute.
+	 *
+	 * This attribute is protected with the global #db_mutex.
+	 */
+	std::unordered_map<const char *, Song *,
+			   NameHash, NameEqual> song_index;
+
+public:
+
+	/**
+	 * The allocator for this directory's #Song objects.  Must be
+	 * declared before #songs so it outlives the song list during
+	 * destruction.
+	 */
+	SongSlab song_slab;
+
 	/**
 	 * A doubly linked list of songs within this directory.
 	 *
@@ -91,7 +142,57 @@ struct Directory {
 
 	uint64_t inode = 0, device = 0;
 
-	const std::string path;
+	/**
+	 * The number of songs in this directory and all of its
+	 * descendants (mounted databases not included).  Maintained
+	 * incrementally by AddSong(), RemoveSong() and Delete(), so
+	 * unfiltered "count" queries can be answered without
+	 * visiting any song objects.
+	 *
+	 * This attribute is protected with the global #db_mutex.
+	 */
+	unsigned total_song_count = 0;
+
+	/**
+	 * The accumulated duration of all songs counted by
+	 * #total_song_count; unknown (negative) durations count as
+	 * zero.
+	 *
+	 * This attribute is protected with the global #db_mutex.
+	 */
+	std::chrono::duration<uint64_t, SongTime::period> total_duration{};
+
+	/**
+	 * An upper bound for the modification time of all songs in
+	 * this directory and its descendants.  It is raised when
+	 * songs are added or rescanned, but never lowered when songs
+	 * are removed, so it may overestimate; that only costs a
+	 * missed pruning opportunity in Walk(), never a wrong result.
+	 *
+	 * This attribute is protected with the global #db_mutex.
+	 */
+	std::chrono::system_clock::time_point max_song_mtime =
+		std::chrono::system_clock::time_point::min();
+
+	/**
+	 * A Bloom filter over the trigrams of the tag values of all
+	 * songs in this directory and its descendants.  Like
+	 * #max_song_mtime, it is only ever widened, so it may
+	 * overestimate after songs have been removed; that only costs
+	 * a missed pruning opportunity in Walk(), never a wrong
+	 * result.
+	 *
+	 * This attribute is protected with the global #db_mutex.
+	 */
+	TagBloomFilter tag_bloom;
+
+	/**
+	 * The base name of this directory (UTF-8).  Empty in the
+	 * root directory.  The full relative URI is composed on
+	 * demand by GetPath(), so deep trees do not store long
+	 * prefixes over and over.
+	 */
+	const std::string name;
 
 	/**
 	 * If this is not nullptr, then this directory does not really
@@ -100,7 +201,7 @@ struct Directory {
 	Database *mounted_database = nullptr;
 
 public:
-	Directory(std::string &&_path_utf8, Directory *_parent);
+	Directory(std::string &&_name_utf8, Directory *_parent);
 	~Directory();
 
 	/**
@@ -136,12 +237,12 @@ public:
 	 * Caller must lock the #db_mutex.
 	 */
 	gcc_pure
-	const Directory *FindChild(const char *name) const noexcept;
+	const Directory *FindChild(const char *name_utf8) const noexcept;
 
 	gcc_pure
-	Directory *FindChild(const char *name) noexcept {
+	Directory *FindChild(const char *name_utf8) noexcept {
 		const Directory *cthis = this;
-		return const_cast<Directory *>(cthis->FindChild(name));
+		return const_cast<Directory *>(cthis->FindChild(name_utf8));
 	}
 
 	/**
@@ -188,16 +289,20 @@ public:
 			playlists.empty();
 	}
 
+	/**
+	 * Compose the full relative URI of this directory.  The root
+	 * directory returns an empty string.
+	 */
 	gcc_pure
-	const char *GetPath() const noexcept {
-		return path.c_str();
-	}
+	std::string GetPath() const noexcept;
 
 	/**
 	 * Returns the base name of the directory.
 	 */
 	gcc_pure
-	const char *GetName() const noexcept;
+	const char *GetName() const noexcept {
+		return name.c_str();
+	}
 
 	/**
 	 * Is this the root directory of the music database?
@@ -252,6 +357,33 @@ public:
 	 */
 	void RemoveSong(Song *song) noexcept;
 
+	/**
+	 * Adjust the duration aggregates of this directory and all
+	 * of its ancestors after a song's metadata has been updated
+	 * in place (i.e. without a RemoveSong()/AddSong() pair).
+	 *
+	 * Caller must lock the #db_mutex.
+	 */
+	void UpdateSongDuration(SignedSongTime old_duration,
+				SignedSongTime new_duration) noexcept;
+
+	/**
+	 * Raise #max_song_mtime of this directory and all of its
+	 * ancestors after a song has been rescanned in place.
+	 *
+	 * Caller must lock the #db_mutex.
+	 */
+	void NoteSongMtime(std::chrono::system_clock::time_point song_mtime) noexcept;
+
+	/**
+	 * Add the given song tag to #tag_bloom of this directory and
+	 * all of its ancestors after a song has been rescanned in
+	 * place.
+	 *
+	 * Caller must lock the #db_mutex.
+	 */
+	void NoteSongTag(const Tag &tag) noexcept;
+
 	/**
 	 * Caller must lock the #db_mutex.
 	 */
@@ -264,6 +396,17 @@ public:
 	 */
 	void Sort() noexcept;
 
+	/**
+	 * Estimate the number of bytes allocated by this directory and
+	 * all of its children and songs, for memory telemetry.  Tag
+	 * values live in the tag pool and are accounted there, not
+	 * here.
+	 *
+	 * Caller must lock the #db_mutex.
+	 */
+	gcc_pure
+	size_t GetTotalMemoryUsage() const noexcept;
+
 	/**
 	 * Caller must lock #db_mutex.
 	 */
@@ -271,8 +414,29 @@ public:
 		  VisitDirectory visit_directory, VisitSong visit_song,
 		  VisitPlaylist visit_playlist) const;
 
-	gcc_pure
-	LightDirectory Export() const noexcept;
+private:
+	/**
+	 * The recursive part of Walk(), with the filter's pruning
+	 * keys pre-computed by the top-level call.
+	 */
+	void Walk2(bool recursive, const SongFilter *match,
+		   const TagBloomQuery &bloom_query,
+		   std::chrono::system_clock::time_point since,
+		   VisitDirectory visit_directory, VisitSong visit_song,
+		   VisitPlaylist visit_playlist) const;
+
+	/**
+	 * Add (sign=1) or subtract (sign=-1) one song's contribution
+	 * from the aggregates of this directory and all of its
+	 * ancestors.
+	 */
+	void ApplySongAggregates(const Song &song, int sign) noexcept;
+
+	/**
+	 * Append this directory's relative URI to the given string.
+	 * Helper for GetPath().
+	 */
+	void BuildPath(std::string &result) const noexcept;
 };
 
 #endif
@@ -24,7 +24,8 @@
 #include "SongSave.hxx"
 #include "DetachedSong.hxx"
 #include "PlaylistDatabase.hxx"
-#include "fs/io/TextFile.hxx"
+#include "db/DatabaseLock.hxx"
+#include "fs/io/LineReader.hxx"
 #include "fs/io/BufferedOutputStream.hxx"
 #include "util/ChronoUtil.hxx"
 #include "util/StringCompare.hxx"
@@ -79,7 +80,8 @@ directory_save(BufferedOutputStream &os, const Directory &directory)
 			os.Format(DIRECTORY_MTIME "%lu\n",
 				  (unsigned long)std::chrono::system_clock::to_time_t(directory.mtime));
 
-		os.Format("%s%s\n", DIRECTORY_BEGIN, directory.GetPath());
+		os.Format("%s%s\n", DIRECTORY_BEGIN,
+			  directory.GetPath().c_str());
 	}
 
 	for (const auto &child : directory.children) {
@@ -96,7 +98,7 @@ directory_save(BufferedOutputStream &os, const Directory &directory)
 	playlist_vector_save(os, directory.playlists);
 
 	if (!directory.IsRoot())
-		os.Format(DIRECTORY_END "%s\n", directory.GetPath());
+		os.Format(DIRECTORY_END "%s\n", directory.GetPath().c_str());
 }
 
 static bool
@@ -116,7 +118,8 @@ ParseLine(Directory &directory, const char *line)
 }
 
 static Directory *
-directory_load_subdir(TextFile &file, Directory &parent, const char *name)
+directory_load_subdir(LineReader &file, Directory &parent, const char *name,
+		      ScopeDatabaseLoadLock &lock)
 {
 	if (parent.FindChild(name) != nullptr)
 		throw FormatRuntimeError("Duplicate subdirectory '%s'", name);
@@ -136,7 +139,7 @@ directory_load_subdir(TextFile &file, Directory &parent, const char *name)
 				throw FormatRuntimeError("Malformed line: %s", line);
 		}
 
-		directory_load(file, *directory);
+		directory_load(file, *directory, lock);
 	} catch (...) {
 		directory->Delete();
 		throw;
@@ -146,7 +149,8 @@ directory_load_subdir(TextFile &file, Directory &parent, const char *name)
 }
 
 void
-directory_load(TextFile &file, Directory &directory)
+directory_load(LineReader &file, Directory &directory,
+	       ScopeDatabaseLoadLock &lock)
 {
 	const char *line;
 
@@ -154,7 +158,7 @@ directory_load(TextFile &file, Directory &directory)
 	       !StringStartsWith(line, DIRECTORY_END)) {
 		const char *p;
 		if ((p = StringAfterPrefix(line, DIRECTORY_DIR))) {
-			directory_load_subdir(file, directory, p);
+			directory_load_subdir(file, directory, p, lock);
 		} else if ((p = StringAfterPrefix(line, SONG_BEGIN))) {
 			const char *name = p;
 
@@ -171,5 +175,7 @@ directory_load(TextFile &file, Directory &directory)
 		} else {
 			throw FormatRuntimeError("Malformed line: %s", line);
 		}
+
+		lock.Yield();
 	}
 }
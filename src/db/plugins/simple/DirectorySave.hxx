@@ -21,16 +21,22 @@
 #define MPD_DIRECTORY_SAVE_HXX
 
 struct Directory;
-class TextFile;
+class LineReader;
 class BufferedOutputStream;
+class ScopeDatabaseLoadLock;
 
 void
 directory_save(BufferedOutputStream &os, const Directory &directory);
 
 /**
+ * Load the directory tree, periodically yielding the database lock
+ * (which the caller holds via the given #ScopeDatabaseLoadLock) so
+ * the partially loaded tree can already be visited.
+ *
  * Throws #std::runtime_error on error.
  */
 void
-directory_load(TextFile &file, Directory &directory);
+directory_load(LineReader &file, Directory &directory,
+	       ScopeDatabaseLoadLock &lock);
 
 #endif
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "QueryCache.hxx"
+#include "db/LightSong.hxx"
+
+bool
+QueryCache::Get(const std::string &key, const VisitSong &visit_song)
+{
+	const std::lock_guard<Mutex> protect(mutex);
+
+	for (auto i = entries.begin(); i != entries.end(); ++i) {
+		if (i->key != key)
+			continue;
+
+		/* move the entry to the front of the LRU list */
+		entries.splice(entries.begin(), entries, i);
+
+		for (const auto &song : i->songs)
+			visit_song((LightSong)song);
+
+		return true;
+	}
+
+	return false;
+}
+
+void
+QueryCache::Put(std::string &&key, std::vector<DetachedSong> &&songs) noexcept
+{
+	if (songs.size() > MAX_SONGS)
+		return;
+
+	const std::lock_guard<Mutex> protect(mutex);
+
+	for (auto i = entries.begin(); i != entries.end(); ++i) {
+		if (i->key == key) {
+			/* somebody else has just inserted the same
+			   query */
+			return;
+		}
+	}
+
+	if (entries.size() >= MAX_ENTRIES)
+		entries.pop_back();
+
+	entries.emplace_front(std::move(key), std::move(songs));
+}
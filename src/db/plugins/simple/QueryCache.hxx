@@ -0,0 +1,99 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_DB_QUERY_CACHE_HXX
+#define MPD_DB_QUERY_CACHE_HXX
+
+#include "check.h"
+#include "db/Visitor.hxx"
+#include "DetachedSong.hxx"
+#include "thread/Mutex.hxx"
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * A small LRU cache for song selections on a #SimpleDatabase.
+ * Clients tend to repeat the very same "find"/"search" queries between
+ * database updates; this cache replays the result without walking the
+ * directory tree again.
+ *
+ * The cached songs are deep copies (#DetachedSong), so the cache does
+ * not keep pointers into the directory tree and survives concurrent
+ * updates; it must merely be flushed whenever the database is
+ * modified.
+ */
+class QueryCache {
+	/**
+	 * The maximum number of cached selections.  When the cache is
+	 * full, the least recently used entry is evicted.
+	 */
+	static constexpr unsigned MAX_ENTRIES = 32;
+
+	struct Entry {
+		std::string key;
+		std::vector<DetachedSong> songs;
+
+		template<typename K, typename S>
+		Entry(K &&_key, S &&_songs)
+			:key(std::forward<K>(_key)),
+			 songs(std::forward<S>(_songs)) {}
+	};
+
+	Mutex mutex;
+
+	/**
+	 * All cache entries, most recently used first.
+	 */
+	std::list<Entry> entries;
+
+public:
+	/**
+	 * The maximum number of songs in one cache entry; larger
+	 * results are not cached, to put a bound on the memory usage.
+	 */
+	static constexpr size_t MAX_SONGS = 4096;
+
+	/**
+	 * Look up a cached result and replay it to the given visitor.
+	 *
+	 * @return true if the key was found (and the visitor was
+	 * called for each cached song)
+	 */
+	bool Get(const std::string &key, const VisitSong &visit_song);
+
+	/**
+	 * Store a complete query result.  Results larger than
+	 * #MAX_SONGS are discarded.
+	 */
+	void Put(std::string &&key, std::vector<DetachedSong> &&songs) noexcept;
+
+	/**
+	 * Discard all cached results.  Call this whenever the database
+	 * is modified.
+	 */
+	void Flush() noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+		entries.clear();
+	}
+};
+
+#endif
@@ -23,6 +23,7 @@
 #include "Mount.hxx"
 #include "db/DatabasePlugin.hxx"
 #include "db/Selection.hxx"
+#include "SongFilter.hxx"
 #include "db/Helpers.hxx"
 #include "db/Stats.hxx"
 #include "db/UniqueTags.hxx"
@@ -30,24 +31,35 @@
 #include "Directory.hxx"
 #include "Song.hxx"
 #include "DatabaseSave.hxx"
+#include "DatabaseBinary.hxx"
 #include "db/DatabaseLock.hxx"
 #include "db/DatabaseError.hxx"
+#include "db/DatabaseSort.hxx"
 #include "tag/Mask.hxx"
 #include "fs/io/TextFile.hxx"
 #include "fs/io/BufferedOutputStream.hxx"
 #include "fs/io/FileOutputStream.hxx"
+#include "fs/io/WriteBehindOutputStream.hxx"
 #include "fs/FileInfo.hxx"
 #include "config/Block.hxx"
 #include "fs/FileSystem.hxx"
 #include "util/CharUtil.hxx"
 #include "util/Domain.hxx"
+#include "thread/Thread.hxx"
 #include "Log.hxx"
 
 #ifdef ENABLE_ZLIB
-#include "fs/io/GzipOutputStream.hxx"
+#include "fs/io/ParallelGzipOutputStream.hxx"
 #endif
 
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <forward_list>
 #include <memory>
+#include <random>
+#include <thread>
+#include <utility>
 
 #include <errno.h>
 
@@ -59,7 +71,12 @@ inline SimpleDatabase::SimpleDatabase(const ConfigBlock &block)
 #ifdef ENABLE_ZLIB
 	 compress(block.GetBlockValue("compress", true)),
 #endif
+	 binary_format(block.GetBlockValue("binary", false)),
+	 journal(block.GetBlockValue("journal", false)
+		 ? new UpdateJournal()
+		 : nullptr),
 	 cache_path(block.GetPath("cache_directory")),
+	 load_thread(BIND_THIS_METHOD(LoadTask)),
 	 prefixed_light_song(nullptr)
 {
 	if (path.IsNull())
@@ -79,7 +96,9 @@ inline SimpleDatabase::SimpleDatabase(AllocatedPath &&_path,
 #ifdef ENABLE_ZLIB
 	 compress(_compress),
 #endif
+	 binary_format(false),
 	 cache_path(AllocatedPath::Null()),
+	 load_thread(BIND_THIS_METHOD(LoadTask)),
 	 prefixed_light_song(nullptr) {
 }
 
@@ -150,17 +169,83 @@ SimpleDatabase::Load()
 	assert(!path.IsNull());
 	assert(root != nullptr);
 
-	TextFile file(path);
-
 	LogDebug(simple_db_domain, "reading DB");
 
-	db_load_internal(file, *root);
+	try {
+		db_binary_load(path, *root);
+	} catch (...) {
+		/* not a binary database file (or a broken one): fall
+		   back to the text format; with background loading,
+		   readers may already be walking the progressively
+		   published tree, so swap in a fresh root under the
+		   database lock before deleting the old one */
+		Directory *old_root = Directory::NewRoot();
+
+		{
+			const ScopeDatabaseLock protect;
+			std::swap(root, old_root);
+		}
+
+		delete old_root;
+
+		db_load_internal(path, *root);
+	}
+
+	if (journal != nullptr) {
+		/* apply changes which have not yet been merged into
+		   the database file */
+		const auto journal_path = GetJournalPath();
+		if (PathExists(journal_path)) {
+			TextFile file(journal_path);
+			journal_replay(file, *root);
+		}
+	}
 
 	FileInfo fi;
 	if (GetFileInfo(path, fi))
 		mtime = fi.GetModificationTime();
 }
 
+void
+SimpleDatabase::LoadTask() noexcept
+{
+	try {
+		Load();
+	} catch (const std::exception &e) {
+		LogError(e);
+
+		/* discard the partially loaded tree and start over
+		   with an empty database */
+		Directory *old_root = Directory::NewRoot();
+
+		{
+			const ScopeDatabaseLock protect;
+			std::swap(root, old_root);
+		}
+
+		delete old_root;
+	}
+
+	{
+		const std::lock_guard<Mutex> protect(load_mutex);
+		load_complete.store(true, std::memory_order_release);
+	}
+
+	load_cond.broadcast();
+
+	/* now that the tree is complete, build the hot projections
+	   (while the loader was running, nothing was cached) */
+	PrewarmUniqueTagsCache();
+}
+
+void
+SimpleDatabase::WaitLoaded() const noexcept
+{
+	const std::lock_guard<Mutex> protect(load_mutex);
+	while (!load_complete.load(std::memory_order_relaxed))
+		load_cond.wait(load_mutex);
+}
+
 void
 SimpleDatabase::Open()
 {
@@ -169,20 +254,40 @@ SimpleDatabase::Open()
 	root = Directory::NewRoot();
 	mtime = std::chrono::system_clock::time_point::min();
 
+	/* start a fresh "dbsync" epoch: generation numbers from an
+	   earlier run (or another instance) must not be mistaken for
+	   ours */
+	{
+		std::random_device rd;
+		sync_id = (uint_least64_t(rd()) << 32) | rd();
+		sync_generation = 0;
+		sync_changelog.clear();
+	}
+
 #ifndef NDEBUG
 	borrowed_song_count = 0;
 #endif
 
-	try {
-		Load();
-	} catch (const std::exception &e) {
-		LogError(e);
-
-		delete root;
-
+	if (!PathExists(path))
+		/* fail right now (instead of in the loader thread)
+		   if we will not be able to create the database
+		   file, so a misconfiguration aborts startup with a
+		   useful error message */
 		Check();
 
-		root = Directory::NewRoot();
+	/* read the database file in a background thread: the (still
+	   empty) root is visible right away, and the loader
+	   publishes directories as it parses them, so clients can
+	   browse the first entries long before the whole file has
+	   been read */
+	load_complete.store(false, std::memory_order_relaxed);
+
+	try {
+		load_thread.Start();
+	} catch (...) {
+		load_complete.store(true, std::memory_order_relaxed);
+		delete root;
+		throw;
 	}
 }
 
@@ -193,6 +298,9 @@ SimpleDatabase::Close()
 	assert(prefixed_light_song == nullptr);
 	assert(borrowed_song_count == 0);
 
+	if (load_thread.IsDefined())
+		load_thread.Join();
+
 	delete root;
 }
 
@@ -203,6 +311,11 @@ SimpleDatabase::GetSong(const char *uri) const
 	assert(prefixed_light_song == nullptr);
 	assert(borrowed_song_count == 0);
 
+	/* a song lookup must not fail just because the loader has
+	   not reached the file yet ("add", playlist and state file
+	   restore depend on it) */
+	WaitLoaded();
+
 	ScopeDatabaseLock protect;
 
 	auto r = root->LookupDirectory(uri);
@@ -217,7 +330,8 @@ SimpleDatabase::GetSong(const char *uri) const
 			return nullptr;
 
 		prefixed_light_song =
-			new PrefixedLightSong(*song, r.directory->GetPath());
+			new PrefixedLightSong(*song,
+					      r.directory->GetPath().c_str());
 		return prefixed_light_song;
 	}
 
@@ -237,7 +351,9 @@ SimpleDatabase::GetSong(const char *uri) const
 		throw DatabaseError(DatabaseErrorCode::NOT_FOUND,
 				    "No such song");
 
-	light_song = song->Export();
+	light_song_directory = song->parent->GetPath();
+	light_song = song->Export(song->parent->IsRoot()
+				  ? nullptr : light_song_directory.c_str());
 
 #ifndef NDEBUG
 	++borrowed_song_count;
@@ -263,12 +379,251 @@ SimpleDatabase::ReturnSong(gcc_unused const LightSong *song) const
 #endif
 }
 
+/**
+ * Serialize a #DatabaseSelection into a #QueryCache key.
+ *
+ * @return false if the selection cannot be serialized (and must not
+ * be cached)
+ */
+static bool
+MakeQueryCacheKey(const DatabaseSelection &selection,
+		  std::string &key) noexcept
+{
+	if (selection.filter == nullptr || selection.filter->IsEmpty())
+		/* not worth caching: an unfiltered walk just streams
+		   the tree, and its result may be huge */
+		return false;
+
+	key = selection.uri;
+	key.push_back('\0');
+	key.push_back(selection.recursive ? '1' : '0');
+	key.append(std::to_string(selection.sort));
+	key.push_back(selection.descending ? 'd' : 'a');
+
+	for (const auto &item : selection.filter->GetItems()) {
+		if (item.GetTag() == LOCATE_TAG_MODIFIED_SINCE)
+			/* the time stamp is not accessible for
+			   serialization */
+			return false;
+
+		key.push_back('\0');
+		key.append(std::to_string(item.GetTag()));
+		key.push_back(item.GetFoldCase() ? 'f' : 's');
+		key.append(item.GetValue());
+	}
+
+	return true;
+}
+
+/**
+ * Collect all songs in the given subtree which match the filter, in
+ * the same order in which a sequential Directory::Walk() would have
+ * visited them.
+ */
+static void
+CollectSubtreeSongs(const Directory &directory, const SongFilter &filter,
+		    const TagBloomQuery &bloom_query,
+		    std::chrono::system_clock::time_point since,
+		    std::vector<LightSong> &result,
+		    std::deque<std::string> &directory_uris)
+{
+	if (!directory.IsMount() &&
+	    (directory.max_song_mtime < since ||
+	     !bloom_query.MayMatch(directory.tag_bloom)))
+		/* no song in this subtree can match the filter */
+		return;
+
+	if (!directory.songs.empty()) {
+		/* compose the directory URI once and keep it in
+		   #directory_uris (whose elements are never
+		   reallocated), because the collected #LightSong
+		   instances point into it */
+		directory_uris.emplace_back(directory.GetPath());
+		const char *directory_uri = directory_uris.back().c_str();
+
+		for (const auto &song : directory.songs) {
+			const LightSong song2 = song.Export(directory_uri);
+			if (filter.Match(song2))
+				result.push_back(song2);
+		}
+	}
+
+	for (const auto &child : directory.children)
+		CollectSubtreeSongs(child, filter, bloom_query, since,
+				    result, directory_uris);
+}
+
+/**
+ * Shared state of a parallel filtered walk: the subtrees still to be
+ * claimed by worker threads, and the matches collected per subtree.
+ */
+struct ParallelWalk {
+	const SongFilter &filter;
+
+	/**
+	 * The filter's modified-since threshold, computed once for
+	 * all workers (see SongFilter::GetModifiedSince()).
+	 */
+	const std::chrono::system_clock::time_point since;
+
+	/**
+	 * The filter's Bloom filter probe, computed once for all
+	 * workers.
+	 */
+	const TagBloomQuery bloom_query;
+
+	std::vector<const Directory *> subtrees;
+
+	/**
+	 * One result vector per subtree, so the workers never write
+	 * to shared data and the matches can be delivered in
+	 * sequential walk order afterwards.
+	 */
+	std::vector<std::vector<LightSong>> results;
+
+	/**
+	 * The composed directory URIs referenced by #results, one
+	 * container per subtree.
+	 */
+	std::vector<std::deque<std::string>> result_uris;
+
+	/**
+	 * The index of the next unclaimed subtree.
+	 */
+	std::atomic_size_t next{0};
+
+	/**
+	 * The first exception thrown by a worker
+	 * (e.g. #std::bad_alloc), rethrown by the coordinator.
+	 */
+	std::exception_ptr error;
+	Mutex error_mutex;
+
+	explicit ParallelWalk(const SongFilter &_filter)
+		:filter(_filter), since(_filter.GetModifiedSince()),
+		 bloom_query(&_filter) {}
+
+	void Run() noexcept;
+};
+
+void
+ParallelWalk::Run() noexcept
+try {
+	size_t i;
+	while ((i = next.fetch_add(1, std::memory_order_relaxed)) < subtrees.size())
+		CollectSubtreeSongs(*subtrees[i], filter, bloom_query, since,
+				    results[i], result_uris[i]);
+} catch (...) {
+	const std::lock_guard<Mutex> protect(error_mutex);
+	if (!error)
+		error = std::current_exception();
+}
+
+/**
+ * A filtered recursive walk over the given directory, distributed
+ * over one worker thread per CPU, one top-level subtree at a time.
+ * The caller must hold the database lock for the whole call: that
+ * freezes the directory tree, which makes it safe for the workers to
+ * read it without further locking.  Matches are delivered to the
+ * visitor from the calling thread, in the same order as a sequential
+ * Directory::Walk().
+ */
+static void
+WalkParallel(const Directory &root, const SongFilter &filter,
+	     const VisitSong &visit_song)
+{
+	assert(holding_db_lock());
+
+	ParallelWalk ctx(filter);
+	for (const auto &child : root.children)
+		ctx.subtrees.push_back(&child);
+
+	const size_t n_cpus = std::thread::hardware_concurrency();
+	const size_t n_threads = std::min(ctx.subtrees.size(),
+					  n_cpus > 0 ? n_cpus : 1);
+	if (n_threads < 2) {
+		/* not worth spawning threads */
+		root.Walk(true, &filter, VisitDirectory(), visit_song,
+			  VisitPlaylist());
+		return;
+	}
+
+	ctx.results.resize(ctx.subtrees.size());
+	ctx.result_uris.resize(ctx.subtrees.size());
+
+	std::forward_list<Thread> threads;
+	for (size_t i = 1; i < n_threads; ++i) {
+		threads.emplace_front(BIND_METHOD(ctx, &ParallelWalk::Run));
+
+		try {
+			threads.front().Start();
+		} catch (...) {
+			/* failing to start more workers is not fatal;
+			   the already running ones and the calling
+			   thread will finish the job */
+			threads.pop_front();
+			break;
+		}
+	}
+
+	/* the calling thread participates, too */
+	ctx.Run();
+
+	for (auto &thread : threads)
+		thread.Join();
+
+	if (ctx.error)
+		std::rethrow_exception(ctx.error);
+
+	/* deliver the matches in sequential walk order: first the
+	   songs of the root itself, then each subtree */
+
+	for (const auto &song : root.songs) {
+		const LightSong song2 = song.Export(nullptr);
+		if (filter.Match(song2))
+			visit_song(song2);
+	}
+
+	for (const auto &result : ctx.results)
+		for (const auto &song : result)
+			visit_song(song);
+}
+
 void
 SimpleDatabase::Visit(const DatabaseSelection &selection,
 		      VisitDirectory visit_directory,
 		      VisitSong visit_song,
 		      VisitPlaylist visit_playlist) const
 {
+	/* only song-only selections are cached; these are what
+	   "find"/"search" emit, and clients repeat them a lot.
+	   While the loader is still running, the result would be
+	   incomplete and must not be cached. */
+	std::string cache_key;
+	const bool cacheable = !visit_directory && !visit_playlist &&
+		visit_song && mount_count == 0 && IsLoaded() &&
+		MakeQueryCacheKey(selection, cache_key);
+
+	if (cacheable && query_cache.Get(cache_key, visit_song))
+		return;
+
+	std::vector<DetachedSong> collected;
+	bool collected_overflow = false;
+	if (cacheable) {
+		/* wrap the visitor to collect a deep copy of the
+		   result for the cache */
+		const VisitSong next = std::move(visit_song);
+		visit_song = [&collected, &collected_overflow,
+			      next](const LightSong &song){
+			next(song);
+
+			if (collected.size() < QueryCache::MAX_SONGS)
+				collected.emplace_back(song);
+			else
+				collected_overflow = true;
+		};
+	}
+
 	ScopeDatabaseLock protect;
 
 	auto r = root->LookupDirectory(selection.uri.c_str());
@@ -277,7 +632,8 @@ SimpleDatabase::Visit(const DatabaseSelection &selection,
 		/* pass the request and the remaining uri to the mounted database */
 		protect.unlock();
 
-		WalkMount(r.directory->GetPath(), *(r.directory->mounted_database),
+		WalkMount(r.directory->GetPath().c_str(),
+			  *(r.directory->mounted_database),
 			(r.uri == nullptr)?"":r.uri, selection.recursive, selection.filter,
 			visit_directory, visit_song, visit_playlist);
 
@@ -288,11 +644,49 @@ SimpleDatabase::Visit(const DatabaseSelection &selection,
 		/* it's a directory */
 
 		if (selection.recursive && visit_directory)
-			visit_directory(r.directory->Export());
-
-		r.directory->Walk(selection.recursive, selection.filter,
-				  visit_directory, visit_song,
-				  visit_playlist);
+			visit_directory(LightDirectory(r.directory->GetPath().c_str(),
+						       r.directory->mtime));
+
+		if (visit_song && !visit_directory && !visit_playlist &&
+		    mount_count == 0) {
+			/* song-only walk: copy the matching songs
+			   into a snapshot while holding the lock,
+			   then release it before serializing them to
+			   the client, so a long response cannot
+			   stall the update thread or other
+			   clients */
+			std::vector<DetachedSong> snapshot;
+			const VisitSong collect =
+				[&snapshot](const LightSong &song){
+					snapshot.emplace_back(song);
+				};
+
+			if (selection.recursive &&
+			    selection.filter != nullptr)
+				/* a filtered song-only walk (the
+				   "find"/"search" pattern) can be
+				   spread across all CPUs */
+				WalkParallel(*r.directory,
+					     *selection.filter, collect);
+			else
+				r.directory->Walk(selection.recursive,
+						  selection.filter,
+						  VisitDirectory(), collect,
+						  VisitPlaylist());
+
+			protect.unlock();
+
+			for (const auto &song : snapshot)
+				visit_song((LightSong)song);
+		} else
+			r.directory->Walk(selection.recursive,
+					  selection.filter,
+					  visit_directory, visit_song,
+					  visit_playlist);
+
+		if (cacheable && !collected_overflow)
+			query_cache.Put(std::move(cache_key),
+					std::move(collected));
 		return;
 	}
 
@@ -300,10 +694,18 @@ SimpleDatabase::Visit(const DatabaseSelection &selection,
 		if (visit_song) {
 			Song *song = r.directory->FindSong(r.uri);
 			if (song != nullptr) {
-				const LightSong song2 = song->Export();
+				const std::string directory_uri =
+					r.directory->GetPath();
+				const LightSong song2 =
+					song->Export(r.directory->IsRoot()
+						     ? nullptr
+						     : directory_uri.c_str());
 				if (selection.Match(song2))
 					visit_song(song2);
 
+				if (cacheable && !collected_overflow)
+					query_cache.Put(std::move(cache_key),
+							std::move(collected));
 				return;
 			}
 		}
@@ -313,23 +715,314 @@ SimpleDatabase::Visit(const DatabaseSelection &selection,
 			    "No such directory");
 }
 
+bool
+SimpleDatabase::VisitSorted(const DatabaseSelection &selection,
+			    const VisitSong &visit_song) const
+{
+	assert(selection.sort != TAG_NUM_OF_ITEM_TYPES);
+
+	std::string cache_key;
+	if (mount_count > 0 || !IsLoaded() ||
+	    !MakeQueryCacheKey(selection, cache_key))
+		return false;
+
+	if (query_cache.Get(cache_key, visit_song))
+		return true;
+
+	/* collect the matches through the regular (unsorted) code
+	   path, sort them, and remember the sorted result; repeating
+	   the same query will then stream the songs in their final
+	   order without sorting again */
+
+	std::vector<DetachedSong> songs;
+
+	{
+		DatabaseSelection collect_selection(selection);
+		collect_selection.sort = TAG_NUM_OF_ITEM_TYPES;
+		collect_selection.descending = false;
+
+		Visit(collect_selection, VisitDirectory(),
+		      VisitSong([&songs](const LightSong &song){
+			      songs.emplace_back(song);
+		      }),
+		      VisitPlaylist());
+	}
+
+	SortDetachedSongs(songs, selection.sort, selection.descending);
+
+	if (songs.size() <= QueryCache::MAX_SONGS)
+		/* store the sorted copy before replaying it, because
+		   the visitor may abort the replay with an
+		   exception */
+		query_cache.Put(std::move(cache_key),
+				std::vector<DetachedSong>(songs));
+
+	for (const auto &song : songs)
+		visit_song((LightSong)song);
+
+	return true;
+}
+
+gcc_pure
+static uint_least64_t
+UniqueTagsCacheKey(TagType tag_type, TagMask group_mask) noexcept
+{
+	uint_least64_t mask = 0;
+	for (unsigned i = 0; i < TAG_NUM_OF_ITEM_TYPES; ++i)
+		if (group_mask.Test(TagType(i)))
+			mask |= uint_least64_t(1) << i;
+
+	return (uint_least64_t(tag_type) << 32) | mask;
+}
+
 void
 SimpleDatabase::VisitUniqueTags(const DatabaseSelection &selection,
 				TagType tag_type, TagMask group_mask,
 				VisitTag visit_tag) const
 {
-	::VisitUniqueTags(*this, selection, tag_type, group_mask, visit_tag);
+	if (!selection.uri.empty() || selection.filter != nullptr ||
+	    !IsLoaded()) {
+		/* only whole-database selections are cached (and
+		   nothing is while the loader is still running) */
+		::VisitUniqueTags(*this, selection, tag_type, group_mask,
+				  visit_tag);
+		return;
+	}
+
+	const auto key = UniqueTagsCacheKey(tag_type, group_mask);
+
+	{
+		const std::lock_guard<Mutex> protect(unique_tags_cache_mutex);
+		auto i = unique_tags_cache.find(key);
+		if (i != unique_tags_cache.end()) {
+			const auto &cached = i->second;
+			for (const auto &tag : cached)
+				visit_tag(tag);
+			return;
+		}
+	}
+
+	std::vector<Tag> result;
+	::VisitUniqueTags(*this, selection, tag_type, group_mask,
+			  [&result](const Tag &tag){
+				  result.emplace_back(tag);
+			  });
+
+	for (const auto &tag : result)
+		visit_tag(tag);
+
+	const std::lock_guard<Mutex> protect(unique_tags_cache_mutex);
+	unique_tags_cache.emplace(key, std::move(result));
+}
+
+void
+SimpleDatabase::PrewarmUniqueTagsCache() const noexcept
+try {
+	/* the group-by projections which dominate typical frontend
+	   load: artist -> albums, albumartist -> albums and genre ->
+	   artists; building them here means no client ever pays for
+	   the full database walk */
+	static constexpr struct {
+		TagType type, group;
+	} projections[] = {
+		{ TAG_ALBUM, TAG_ARTIST },
+		{ TAG_ALBUM, TAG_ALBUM_ARTIST },
+		{ TAG_ARTIST, TAG_GENRE },
+	};
+
+	const DatabaseSelection selection("", true);
+
+	for (const auto &p : projections)
+		VisitUniqueTags(selection, p.type, TagMask(p.group),
+				[](const Tag &){});
+} catch (...) {
+	/* prewarming is best-effort; on error, the query path will
+	   simply rebuild the projection lazily */
+}
+
+bool
+SimpleDatabase::GetSongCount(const DatabaseSelection &selection,
+			     unsigned &song_count,
+			     std::chrono::duration<uint64_t, SongTime::period> &total_duration) const noexcept
+{
+	if (selection.filter != nullptr || !selection.recursive ||
+	    mount_count > 0)
+		return false;
+
+	const ScopeDatabaseLock protect;
+
+	const auto r = root->LookupDirectory(selection.uri.c_str());
+	if (r.uri != nullptr)
+		/* the URI does not refer to a directory */
+		return false;
+
+	song_count = r.directory->total_song_count;
+	total_duration = r.directory->total_duration;
+	return true;
 }
 
 DatabaseStats
 SimpleDatabase::GetStats(const DatabaseSelection &selection) const
 {
-	return ::GetStats(*this, selection);
+	if (!selection.uri.empty() || selection.filter != nullptr ||
+	    !selection.recursive || mount_count > 0 || !IsLoaded())
+		/* only the whole-database selection is cached (and
+		   nothing is while the loader is still running) */
+		return ::GetStats(*this, selection);
+
+	{
+		const std::lock_guard<Mutex> protect(stats_cache_mutex);
+		if (stats_cache_valid)
+			return stats_cache;
+	}
+
+	const auto stats = ::GetStats(*this, selection);
+
+	const std::lock_guard<Mutex> protect(stats_cache_mutex);
+	stats_cache = stats;
+	stats_cache_valid = true;
+	return stats;
+}
+
+AllocatedPath
+SimpleDatabase::GetJournalPath() const
+{
+	return AllocatedPath::FromUTF8Throw((path_utf8 + ".journal").c_str());
+}
+
+bool
+SimpleDatabase::SaveJournal() noexcept
+try {
+	const auto journal_path = GetJournalPath();
+
+	{
+		FileOutputStream fos(journal_path,
+				     FileOutputStream::Mode::APPEND_OR_CREATE);
+		BufferedOutputStream bos(fos);
+		journal->Save(bos, *root);
+		bos.Flush();
+		fos.Commit();
+	}
+
+	journal->Clear();
+
+	/* once the journal has grown to a significant fraction of
+	   the database file, fold it into a full rewrite */
+	const FileInfo journal_info(journal_path);
+	const FileInfo db_info(path);
+	return journal_info.GetSize() * 4 < db_info.GetSize();
+} catch (...) {
+	LogError(std::current_exception());
+	return false;
+}
+
+void
+SimpleDatabase::RecordSyncChanges() noexcept
+{
+	const std::lock_guard<Mutex> protect(sync_mutex);
+
+	if (journal == nullptr || journal->IsOverflowed()) {
+		/* some changes were not (or could not be) recorded:
+		   existing records no longer describe the difference
+		   between any older generation and now; peers must do
+		   a full copy */
+		sync_changelog.clear();
+		++sync_generation;
+		return;
+	}
+
+	try {
+		journal->ForEachRecord([this](UpdateJournal::Op op,
+					      const char *uri){
+			SyncRecord::Op sync_op;
+			switch (op) {
+			case UpdateJournal::Op::ADD_SONG:
+				sync_op = SyncRecord::Op::MODIFIED;
+				break;
+
+			case UpdateJournal::Op::REMOVE_SONG:
+				sync_op = SyncRecord::Op::REMOVED;
+				break;
+
+			case UpdateJournal::Op::REMOVE_DIRECTORY:
+				sync_op = SyncRecord::Op::REMOVED_DIRECTORY;
+				break;
+
+			default:
+				gcc_unreachable();
+			}
+
+			sync_changelog.emplace_back(SyncRecord{++sync_generation,
+							       sync_op, uri});
+		});
+
+		while (sync_changelog.size() > MAX_SYNC_RECORDS)
+			sync_changelog.pop_front();
+	} catch (...) {
+		/* out of memory: give up on the delta */
+		sync_changelog.clear();
+		++sync_generation;
+	}
+}
+
+SimpleDatabase::SyncStatus
+SimpleDatabase::GetSyncStatus() const noexcept
+{
+	const std::lock_guard<Mutex> protect(sync_mutex);
+	return {sync_id, sync_generation};
+}
+
+bool
+SimpleDatabase::VisitSyncRecords(uint_least64_t id, uint_least64_t generation,
+				 const std::function<void(const SyncRecord &)> &f) const
+{
+	const std::lock_guard<Mutex> protect(sync_mutex);
+
+	if (id != sync_id || generation > sync_generation)
+		return false;
+
+	if (generation == sync_generation)
+		/* already up to date; the empty delta is valid */
+		return true;
+
+	if (sync_changelog.empty() ||
+	    sync_changelog.front().generation > generation + 1)
+		/* the records between the peer's generation and our
+		   oldest one have been dropped (or were never
+		   recorded) */
+		return false;
+
+	for (const auto &record : sync_changelog)
+		if (record.generation > generation)
+			f(record);
+
+	return true;
 }
 
 void
 SimpleDatabase::Save()
 {
+	/* never write the database file while the loader is still
+	   filling the tree */
+	WaitLoaded();
+
+	/* the update has modified the database */
+	FlushCaches();
+
+	/* stamp the changes for "dbsync" before the journal is
+	   cleared below */
+	RecordSyncChanges();
+
+	/* rebuild the hot projections right away, in the update
+	   thread, instead of letting the first "list" query pay for
+	   it */
+	PrewarmUniqueTagsCache();
+
+	if (journal != nullptr && FileExists() &&
+	    !journal->IsOverflowed() && !journal->IsEmpty() &&
+	    SaveJournal())
+		return;
+
 	{
 		const ScopeDatabaseLock protect;
 
@@ -344,19 +1037,26 @@ SimpleDatabase::Save()
 
 	FileOutputStream fos(path);
 
-	OutputStream *os = &fos;
+	/* let a background thread do the disk writes, so the update
+	   thread is not stalled by disk latency */
+	WriteBehindOutputStream wbos(fos);
+
+	OutputStream *os = &wbos;
 
 #ifdef ENABLE_ZLIB
-	std::unique_ptr<GzipOutputStream> gzip;
-	if (compress) {
-		gzip.reset(new GzipOutputStream(*os));
+	std::unique_ptr<ParallelGzipOutputStream> gzip;
+	if (!binary_format && compress) {
+		gzip.reset(new ParallelGzipOutputStream(*os));
 		os = gzip.get();
 	}
 #endif
 
 	BufferedOutputStream bos(*os);
 
-	db_save_internal(bos, *root);
+	if (binary_format)
+		db_binary_save(bos, *root);
+	else
+		db_save_internal(bos, *root);
 
 	bos.Flush();
 
@@ -367,8 +1067,16 @@ SimpleDatabase::Save()
 	}
 #endif
 
+	wbos.Flush();
 	fos.Commit();
 
+	if (journal != nullptr) {
+		/* the rewrite contains everything; discard the
+		   journal */
+		journal->Clear();
+		RemoveFile(GetJournalPath());
+	}
+
 	FileInfo fi;
 	if (GetFileInfo(path, fi))
 		mtime = fi.GetModificationTime();
@@ -384,6 +1092,10 @@ SimpleDatabase::Mount(const char *uri, Database *db)
 #endif
 	assert(*uri != 0);
 
+	/* the mount point must not collide with a directory the
+	   loader has not yet published */
+	WaitLoaded();
+
 	ScopeDatabaseLock protect;
 
 	auto r = root->LookupDirectory(uri);
@@ -397,6 +1109,9 @@ SimpleDatabase::Mount(const char *uri, Database *db)
 
 	Directory *mnt = r.directory->CreateChild(r.uri);
 	mnt->mounted_database = db;
+	++mount_count;
+
+	FlushCaches();
 }
 
 static constexpr bool
@@ -466,12 +1181,19 @@ SimpleDatabase::LockUmountSteal(const char *uri)
 bool
 SimpleDatabase::Unmount(const char *uri)
 {
+	WaitLoaded();
+
 	Database *db = LockUmountSteal(uri);
 	if (db == nullptr)
 		return false;
 
 	db->Close();
 	delete db;
+
+	assert(mount_count > 0);
+	--mount_count;
+
+	FlushCaches();
 	return true;
 }
 
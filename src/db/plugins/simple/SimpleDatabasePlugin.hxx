@@ -21,12 +21,30 @@
 #define MPD_SIMPLE_DATABASE_PLUGIN_HXX
 
 #include "check.h"
+#include "QueryCache.hxx"
+#include "UpdateJournal.hxx"
 #include "db/Interface.hxx"
+#include "db/Stats.hxx"
 #include "fs/AllocatedPath.hxx"
 #include "db/LightSong.hxx"
+#include "tag/Tag.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+#include "thread/Thread.hxx"
 #include "Compiler.h"
 
+#include <memory>
+
+#include <atomic>
 #include <cassert>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
 
 struct ConfigBlock;
 struct Directory;
@@ -43,6 +61,19 @@ class SimpleDatabase : public Database {
 	bool compress;
 #endif
 
+	/**
+	 * Save the database in the compact binary format instead of
+	 * the portable text format?  Loading tries both formats, so
+	 * switching this setting "just works".
+	 */
+	bool binary_format;
+
+	/**
+	 * If non-nullptr, then incremental updates are appended to a
+	 * journal file instead of rewriting the whole database file.
+	 */
+	std::unique_ptr<UpdateJournal> journal;
+
 	/**
 	 * The path where cache files for Mount() are located.
 	 */
@@ -50,6 +81,30 @@ class SimpleDatabase : public Database {
 
 	Directory *root;
 
+	/**
+	 * The thread which reads the database file after Open().
+	 * The tree is published progressively while it runs: the
+	 * loader yields the database lock periodically, so clients
+	 * can already browse the directories which have been parsed
+	 * so far.
+	 */
+	Thread load_thread;
+
+	/**
+	 * Protects #load_complete for WaitLoaded().
+	 */
+	mutable Mutex load_mutex;
+
+	mutable Cond load_cond;
+
+	/**
+	 * Has the background loader finished?  While this is false,
+	 * the directory tree is still growing: read-only visits see
+	 * a consistent (but incomplete) snapshot, results must not
+	 * be cached, and writers must call WaitLoaded() first.
+	 */
+	std::atomic_bool load_complete{true};
+
 	std::chrono::system_clock::time_point mtime;
 
 	/**
@@ -63,10 +118,107 @@ class SimpleDatabase : public Database {
 	 */
 	mutable LightSong light_song;
 
+	/**
+	 * The composed directory URI referenced by #light_song,
+	 * which must stay around until ReturnSong() is called.
+	 */
+	mutable std::string light_song_directory;
+
 #ifndef NDEBUG
 	mutable unsigned borrowed_song_count;
 #endif
 
+	/**
+	 * Protects #unique_tags_cache.
+	 */
+	mutable Mutex unique_tags_cache_mutex;
+
+	/**
+	 * Caches VisitUniqueTags() results for unfiltered
+	 * whole-database selections, keyed by tag type and group
+	 * mask.  Flushed whenever the database is modified.
+	 */
+	mutable std::map<uint_least64_t, std::vector<Tag>> unique_tags_cache;
+
+	/**
+	 * Caches Visit() song results, keyed by the serialized
+	 * #DatabaseSelection.  Flushed whenever the database is
+	 * modified.
+	 */
+	mutable QueryCache query_cache;
+
+	/**
+	 * Protects #stats_cache and #stats_cache_valid.
+	 */
+	mutable Mutex stats_cache_mutex;
+
+	/**
+	 * Caches GetStats() for the whole-database selection, which
+	 * monitoring tools tend to poll periodically.  Flushed
+	 * whenever the database is modified.
+	 */
+	mutable DatabaseStats stats_cache;
+
+	mutable bool stats_cache_valid = false;
+
+	/**
+	 * The number of mounted databases.  While other databases are
+	 * mounted, the #QueryCache is bypassed, because modifications
+	 * of a mounted database do not flush our caches.
+	 */
+	unsigned mount_count = 0;
+
+public:
+	/**
+	 * One entry of the "dbsync" changelog: the URI of a song (or
+	 * directory) which was modified or removed, stamped with the
+	 * generation at which the change was recorded.
+	 */
+	struct SyncRecord {
+		uint_least64_t generation;
+
+		enum class Op : uint_least8_t {
+			MODIFIED,
+			REMOVED,
+			REMOVED_DIRECTORY,
+		} op;
+
+		std::string uri;
+	};
+
+private:
+	/**
+	 * The maximum number of entries in #sync_changelog; older
+	 * entries are dropped, and peers which have fallen further
+	 * behind must do a full copy.
+	 */
+	static constexpr size_t MAX_SYNC_RECORDS = 8192;
+
+	/**
+	 * Protects #sync_generation and #sync_changelog.
+	 */
+	mutable Mutex sync_mutex;
+
+	/**
+	 * A random identifier generated at Open(), so a peer cannot
+	 * apply a delta from a different database (or an earlier run
+	 * of this one) whose generation numbers mean something else.
+	 */
+	uint_least64_t sync_id;
+
+	/**
+	 * The generation of the most recently recorded change.
+	 */
+	uint_least64_t sync_generation = 0;
+
+	/**
+	 * The most recent change records, oldest first, populated
+	 * from the #UpdateJournal when a modification is saved.
+	 * Cleared when a change cannot be represented as records
+	 * (journal overflow), which forces peers to do a full copy.
+	 */
+	std::deque<SyncRecord> sync_changelog;
+
 	SimpleDatabase(const ConfigBlock &block);
 
 	SimpleDatabase(AllocatedPath &&_path, bool _compress);
@@ -86,6 +238,31 @@ public:
 
 	void Save();
 
+	/**
+	 * The #UpdateJournal which collects changes during updates,
+	 * or nullptr if journaling is disabled.
+	 */
+	UpdateJournal *GetUpdateJournal() noexcept {
+		return journal.get();
+	}
+
+	/**
+	 * Has the background loader started by Open() finished?
+	 * While it is running, the directory tree is incomplete, but
+	 * may already be visited.
+	 */
+	bool IsLoaded() const noexcept {
+		return load_complete.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Block until the background loader started by Open() has
+	 * finished.  Must be called before modifying the directory
+	 * tree (updates, mounts) or saving it, and before lookups
+	 * which must not miss songs the loader has not yet reached.
+	 */
+	void WaitLoaded() const noexcept;
+
 	/**
 	 * Returns true if there is a valid database file on the disk.
 	 */
@@ -121,12 +298,62 @@ public:
 		   VisitSong visit_song,
 		   VisitPlaylist visit_playlist) const override;
 
+	/**
+	 * Like Visit(), but deliver the songs ordered by
+	 * selection.sort.  The sorted result is kept in the query
+	 * cache, so repeating the same query streams the songs in
+	 * their final order without sorting again.
+	 *
+	 * @return false if the selection cannot be served this way
+	 * (mounts, or the selection cannot be serialized into a
+	 * cache key); the caller shall collect and sort the result
+	 * itself
+	 */
+	bool VisitSorted(const DatabaseSelection &selection,
+			 const VisitSong &visit_song) const;
+
 	void VisitUniqueTags(const DatabaseSelection &selection,
 			     TagType tag_type, TagMask group_mask,
 			     VisitTag visit_tag) const override;
 
 	DatabaseStats GetStats(const DatabaseSelection &selection) const override;
 
+	/**
+	 * Attempt to answer an unfiltered (or base-URI-only) song
+	 * count from the per-directory aggregates, without visiting
+	 * any song objects.
+	 *
+	 * @return false if the selection cannot be served this way
+	 * (filter present, not recursive, mounts, or the URI does
+	 * not refer to a directory)
+	 */
+	bool GetSongCount(const DatabaseSelection &selection,
+			  unsigned &song_count,
+			  std::chrono::duration<uint64_t, SongTime::period> &total_duration) const noexcept;
+
+	/**
+	 * The current "dbsync" stamp: a peer which has applied all
+	 * changes up to #generation within the epoch #id is in sync.
+	 */
+	struct SyncStatus {
+		uint_least64_t id;
+		uint_least64_t generation;
+	};
+
+	gcc_pure
+	SyncStatus GetSyncStatus() const noexcept;
+
+	/**
+	 * Invoke the callback for each change record newer than the
+	 * given generation, oldest first.
+	 *
+	 * @return false if the delta is not available (wrong epoch,
+	 * records already dropped, or changes which could not be
+	 * recorded); the peer must do a full copy instead
+	 */
+	bool VisitSyncRecords(uint_least64_t id, uint_least64_t generation,
+			      const std::function<void(const SyncRecord &)> &f) const;
+
 	std::chrono::system_clock::time_point GetUpdateStamp() const noexcept override {
 		return mtime;
 	}
@@ -141,6 +368,55 @@ private:
 	 */
 	void Load();
 
+	/**
+	 * The background loader thread started by Open(); runs
+	 * Load() and then wakes up all WaitLoaded() callers.
+	 */
+	void LoadTask() noexcept;
+
+	AllocatedPath GetJournalPath() const;
+
+	/**
+	 * Append the journal records to the journal file.
+	 *
+	 * @return false if the journal could not be written or is due
+	 * for compaction; the caller shall do a full save then
+	 */
+	bool SaveJournal() noexcept;
+
+	/**
+	 * Append the journal records to the "dbsync" changelog (or
+	 * invalidate it if the journal has overflowed).  Called by
+	 * Save() before the journal is cleared.
+	 */
+	void RecordSyncChanges() noexcept;
+
+	/**
+	 * Rebuilds the hot group-by projections in the
+	 * #unique_tags_cache ("list album group artist" etc.), so
+	 * that the first client query after a database modification
+	 * does not have to walk the whole directory tree.
+	 */
+	void PrewarmUniqueTagsCache() const noexcept;
+
+	/**
+	 * Discard all cached query results because the database has
+	 * been modified.
+	 */
+	void FlushCaches() noexcept {
+		{
+			const std::lock_guard<Mutex> protect(unique_tags_cache_mutex);
+			unique_tags_cache.clear();
+		}
+
+		query_cache.Flush();
+
+		{
+			const std::lock_guard<Mutex> protect(stats_cache_mutex);
+			stats_cache_valid = false;
+		}
+	}
+
 	Database *LockUmountSteal(const char *uri);
 };
 
@@ -29,7 +29,8 @@
 #include <string.h>
 
 inline Song::Song(const char *_uri, size_t uri_length, Directory &_parent)
-	:parent(&_parent), mtime(std::chrono::system_clock::time_point::min()),
+	:replay_gain(ReplayGainInfo::Undefined()),
+	 parent(&_parent), mtime(std::chrono::system_clock::time_point::min()),
 	 start_time(SongTime::zero()), end_time(SongTime::zero())
 {
 	memcpy(uri, _uri, uri_length + 1);
@@ -48,9 +49,21 @@ song_alloc(const char *uri, Directory &parent)
 	uri_length = strlen(uri);
 	assert(uri_length);
 
-	return NewVarSize<Song>(sizeof(Song::uri),
-				uri_length + 1,
-				uri, uri_length, parent);
+	/* try the parent directory's slab first */
+	void *p = parent.song_slab.Allocate(sizeof(Song) - sizeof(Song::uri)
+					    + uri_length + 1);
+	if (p != nullptr) {
+		Song *song = ::new(p) Song(uri, uri_length, parent);
+		song->in_slab = true;
+		return song;
+	}
+
+	/* does not fit in a slice: regular heap allocation */
+	Song *song = NewVarSize<Song>(sizeof(Song::uri),
+				      uri_length + 1,
+				      uri, uri_length, parent);
+	song->in_slab = false;
+	return song;
 }
 
 Song *
@@ -58,6 +71,7 @@ Song::NewFrom(DetachedSong &&other, Directory &parent)
 {
 	Song *song = song_alloc(other.GetURI(), parent);
 	song->tag = std::move(other.WritableTag());
+	song->replay_gain = other.GetReplayGain();
 	song->mtime = other.GetLastModified();
 	song->start_time = other.GetStartTime();
 	song->end_time = other.GetEndTime();
@@ -73,7 +87,12 @@ Song::NewFile(const char *path, Directory &parent)
 void
 Song::Free()
 {
-	DeleteVarSize(this);
+	if (in_slab) {
+		SongSlab &slab = parent->song_slab;
+		this->~Song();
+		slab.Free(this);
+	} else
+		DeleteVarSize(this);
 }
 
 std::string
@@ -84,11 +103,7 @@ Song::GetURI() const noexcept
 	if (parent->IsRoot())
 		return std::string(uri);
 	else {
-		const char *path = parent->GetPath();
-
-		std::string result;
-		result.reserve(strlen(path) + 1 + strlen(uri));
-		result.assign(path);
+		std::string result = parent->GetPath();
 		result.push_back('/');
 		result.append(uri);
 		return result;
@@ -96,14 +111,16 @@ Song::GetURI() const noexcept
 }
 
 LightSong
-Song::Export() const noexcept
+Song::Export(const char *directory_uri) const noexcept
 {
+	assert(parent->IsRoot() == (directory_uri == nullptr));
+
 	LightSong dest;
-	dest.directory = parent->IsRoot()
-		? nullptr : parent->GetPath();
+	dest.directory = directory_uri;
 	dest.uri = uri;
 	dest.real_uri = nullptr;
 	dest.tag = &tag;
+	dest.replay_gain = replay_gain.IsDefined() ? &replay_gain : nullptr;
 	dest.mtime = mtime;
 	dest.start_time = start_time;
 	dest.end_time = end_time;
@@ -23,6 +23,7 @@
 #include "check.h"
 #include "Chrono.hxx"
 #include "tag/Tag.hxx"
+#include "ReplayGainInfo.hxx"
 #include "Compiler.h"
 
 #include <boost/intrusive/list.hpp>
@@ -33,6 +34,7 @@
 
 struct LightSong;
 struct Directory;
+struct StorageFileInfo;
 class DetachedSong;
 class Storage;
 class ArchiveFile;
@@ -64,6 +66,15 @@ struct Song {
 
 	Tag tag;
 
+	/**
+	 * The song's replay gain, as read from its tags during the
+	 * database update.  Undefined (see
+	 * ReplayGainInfo::IsDefined()) if the file has no replay gain
+	 * tags.  Storing it here allows setting up the gain at song
+	 * start, before the decoder plugin has parsed the tags again.
+	 */
+	ReplayGainInfo replay_gain;
+
 	/**
 	 * The #Directory that contains this song.  Must be
 	 * non-nullptr.  directory this way.
@@ -87,6 +98,12 @@ struct Song {
 	 */
 	SongTime end_time;
 
+	/**
+	 * Was this object allocated from the parent directory's
+	 * #SongSlab?  If not, it lives on the regular heap.
+	 */
+	bool in_slab;
+
 	/**
 	 * The file name.
 	 */
@@ -106,14 +123,22 @@ struct Song {
 	 * allocate a new song structure with a local file name and attempt to
 	 * load its metadata.  If all decoder plugin fail to read its meta
 	 * data, nullptr is returned.
+	 *
+	 * @param info the attributes of this file, as already
+	 * obtained from the directory listing by the caller; this
+	 * avoids querying the storage again, which on remote storage
+	 * would be one network round trip per file
 	 */
 	gcc_malloc
 	static Song *LoadFile(Storage &storage, const char *name_utf8,
-			      Directory &parent);
+			      Directory &parent, const StorageFileInfo &info);
 
 	void Free();
 
-	bool UpdateFile(Storage &storage);
+	/**
+	 * @see LoadFile() for the meaning of the "info" parameter
+	 */
+	bool UpdateFile(Storage &storage, const StorageFileInfo &info);
 
 #ifdef ENABLE_ARCHIVE
 	static Song *LoadFromArchive(ArchiveFile &archive,
@@ -129,8 +154,35 @@ struct Song {
 	gcc_pure
 	std::string GetURI() const noexcept;
 
+	/**
+	 * Returns the effective duration of this (sub)song, like
+	 * LightSong::GetDuration(): the start/end offsets take
+	 * precedence over the tag's duration.
+	 */
+	gcc_pure
+	SignedSongTime GetDuration() const noexcept {
+		SongTime a = start_time, b = end_time;
+		if (!b.IsPositive()) {
+			if (tag.duration.IsNegative())
+				return tag.duration;
+
+			b = SongTime(tag.duration);
+		}
+
+		return SignedSongTime(b - a);
+	}
+
+	/**
+	 * Convert this object to a #LightSong.
+	 *
+	 * @param directory_uri the composed URI of the parent
+	 * directory (or nullptr if the parent is the root); since
+	 * directory URIs are composed on demand, the caller owns
+	 * this string and must keep it around as long as the
+	 * returned object is used
+	 */
 	gcc_pure
-	LightSong Export() const noexcept;
+	LightSong Export(const char *directory_uri) const noexcept;
 };
 
 typedef boost::intrusive::list<Song,
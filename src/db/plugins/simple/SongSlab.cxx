@@ -0,0 +1,70 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "SongSlab.hxx"
+
+#include <mutex>
+
+#include <assert.h>
+
+SongSlab::~SongSlab()
+{
+	while (head != nullptr) {
+		Block *block = head;
+		head = block->next;
+		delete block;
+	}
+}
+
+void *
+SongSlab::Allocate(size_t size) noexcept
+{
+	if (size > SLICE_SIZE)
+		return nullptr;
+
+	const std::lock_guard<Mutex> protect(mutex);
+
+	if (free_list != nullptr) {
+		FreeSlice *slice = free_list;
+		free_list = slice->next;
+		return slice;
+	}
+
+	if (head == nullptr || head->used + SLICE_SIZE > BLOCK_SIZE)
+		head = new Block(head);
+
+	assert(head->used + SLICE_SIZE <= BLOCK_SIZE);
+
+	void *p = head->data + head->used;
+	head->used += SLICE_SIZE;
+	return p;
+}
+
+void
+SongSlab::Free(void *p) noexcept
+{
+	assert(p != nullptr);
+
+	const std::lock_guard<Mutex> protect(mutex);
+
+	auto *slice = (FreeSlice *)p;
+	slice->next = free_list;
+	free_list = slice;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_SONG_SLAB_HXX
+#define MPD_SONG_SLAB_HXX
+
+#include "check.h"
+#include "thread/Mutex.hxx"
+
+#include <stddef.h>
+
+/**
+ * A simple slab allocator for the #Song objects of one #Directory.
+ * Songs of a directory are allocated from large blocks which are
+ * freed wholesale when the directory is deleted, which keeps the
+ * songs of one directory adjacent in memory and avoids per-song
+ * allocator overhead.
+ *
+ * All slices have the same fixed size; allocation requests which do
+ * not fit return nullptr, and the caller falls back to the heap.
+ *
+ * This class is thread-safe because songs may be allocated from
+ * update scan worker threads without holding the #db_mutex.
+ */
+class SongSlab {
+	/**
+	 * The fixed slice size.  Large enough for a #Song with a
+	 * typical file name.
+	 */
+	static constexpr size_t SLICE_SIZE = 256;
+
+	/**
+	 * The payload size of one block; each block holds 64 slices.
+	 */
+	static constexpr size_t BLOCK_SIZE = 64 * SLICE_SIZE;
+
+	struct Block {
+		Block *const next;
+		size_t used = 0;
+		char data[BLOCK_SIZE];
+
+		explicit Block(Block *_next):next(_next) {}
+	};
+
+	/**
+	 * Overlaid on freed slices to form the free list.
+	 */
+	struct FreeSlice {
+		FreeSlice *next;
+	};
+
+	Mutex mutex;
+
+	Block *head = nullptr;
+
+	FreeSlice *free_list = nullptr;
+
+public:
+	SongSlab() = default;
+
+	SongSlab(const SongSlab &) = delete;
+	SongSlab &operator=(const SongSlab &) = delete;
+
+	~SongSlab();
+
+	/**
+	 * Allocate a slice of at least the given size.  Returns
+	 * nullptr if the size exceeds the slice size; the caller
+	 * must fall back to a regular heap allocation then.
+	 */
+	void *Allocate(size_t size) noexcept;
+
+	/**
+	 * Return a slice obtained from Allocate() to the free list.
+	 */
+	void Free(void *p) noexcept;
+};
+
+#endif
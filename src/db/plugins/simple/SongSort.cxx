@@ -22,8 +22,15 @@
 #include "Song.hxx"
 #include "tag/Tag.hxx"
 #include "lib/icu/Collate.hxx"
+#include "util/AllocatedString.hxx"
+
+#include <algorithm>
+#include <vector>
 
 #include <stdlib.h>
+#include <string.h>
+
+#ifndef HAVE_ICU
 
 static int
 compare_utf8_string(const char *a, const char *b) noexcept
@@ -48,16 +55,17 @@ compare_string_tag_item(const Tag &a, const Tag &b, TagType type) noexcept
 				   b.GetValue(type));
 }
 
-/**
- * Compare two tag values which should contain an integer value
- * (e.g. disc or track number).  Either one may be nullptr.
- */
-static int
-compare_number_string(const char *a, const char *b) noexcept
+#endif
+
+static long
+parse_number_string(const char *s) noexcept
 {
-	long ai = a == nullptr ? 0 : strtol(a, nullptr, 10);
-	long bi = b == nullptr ? 0 : strtol(b, nullptr, 10);
+	return s == nullptr ? 0 : strtol(s, nullptr, 10);
+}
 
+static int
+compare_numbers(long ai, long bi) noexcept
+{
 	if (ai <= 0)
 		return bi <= 0 ? 0 : -1;
 
@@ -67,6 +75,19 @@ compare_number_string(const char *a, const char *b) noexcept
 	return ai - bi;
 }
 
+#ifndef HAVE_ICU
+
+/**
+ * Compare two tag values which should contain an integer value
+ * (e.g. disc or track number).  Either one may be nullptr.
+ */
+static int
+compare_number_string(const char *a, const char *b) noexcept
+{
+	return compare_numbers(parse_number_string(a),
+			       parse_number_string(b));
+}
+
 static int
 compare_tag_item(const Tag &a, const Tag &b, TagType type) noexcept
 {
@@ -74,6 +95,106 @@ compare_tag_item(const Tag &a, const Tag &b, TagType type) noexcept
 				     b.GetValue(type));
 }
 
+#endif
+
+#ifdef HAVE_ICU
+
+/**
+ * The sort attributes of one #Song, precomputed so the sort performs
+ * one collation key computation per string instead of one collation
+ * per comparison pair.
+ */
+struct SongSortKey {
+	Song *song;
+
+	/**
+	 * The album tag value (may be nullptr) and its collation
+	 * key; the key may be "null" if the computation failed, in
+	 * which case the comparison falls back to IcuCollate().
+	 */
+	const char *album;
+	AllocatedString<> album_key;
+
+	AllocatedString<> uri_key;
+
+	long disc, track;
+};
+
+static int
+compare_sort_key(const char *a, const AllocatedString<> &a_key,
+		 const char *b, const AllocatedString<> &b_key) noexcept
+{
+	if (a == nullptr)
+		return b == nullptr ? 0 : -1;
+
+	if (b == nullptr)
+		return 1;
+
+	if (!a_key.IsNull() && !b_key.IsNull())
+		return strcmp(a_key.c_str(), b_key.c_str());
+
+	return IcuCollate(a, b);
+}
+
+gcc_pure
+static bool
+song_key_cmp(const SongSortKey &a, const SongSortKey &b) noexcept
+{
+	int ret;
+
+	/* first sort by album */
+	ret = compare_sort_key(a.album, a.album_key,
+			       b.album, b.album_key);
+	if (ret != 0)
+		return ret < 0;
+
+	/* then sort by disc */
+	ret = compare_numbers(a.disc, b.disc);
+	if (ret != 0)
+		return ret < 0;
+
+	/* then by track number */
+	ret = compare_numbers(a.track, b.track);
+	if (ret != 0)
+		return ret < 0;
+
+	/* still no difference?  compare file name */
+	return compare_sort_key(a.song->uri, a.uri_key,
+				b.song->uri, b.uri_key) < 0;
+}
+
+void
+song_list_sort(SongList &songs) noexcept
+{
+	/* decorate-sort-undecorate: precompute each song's sort
+	   attributes, sort the decorated array with byte-wise key
+	   comparisons and rebuild the intrusive list in the new
+	   order */
+
+	std::vector<SongSortKey> v;
+
+	for (auto &song : songs) {
+		const char *album = song.tag.GetValue(TAG_ALBUM);
+
+		v.push_back(SongSortKey{
+			&song,
+			album,
+			album != nullptr ? IcuSortKey(album) : nullptr,
+			IcuSortKey(song.uri),
+			parse_number_string(song.tag.GetValue(TAG_DISC)),
+			parse_number_string(song.tag.GetValue(TAG_TRACK)),
+		});
+	}
+
+	std::stable_sort(v.begin(), v.end(), song_key_cmp);
+
+	songs.clear();
+	for (auto &i : v)
+		songs.push_back(*i.song);
+}
+
+#else
+
 /* Only used for sorting/searchin a songvec, not general purpose compares */
 gcc_pure
 static bool
@@ -105,3 +226,5 @@ song_list_sort(SongList &songs) noexcept
 {
 	songs.sort(song_cmp);
 }
+
+#endif
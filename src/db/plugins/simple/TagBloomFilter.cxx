@@ -0,0 +1,98 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "TagBloomFilter.hxx"
+#include "SongFilter.hxx"
+#include "tag/Tag.hxx"
+#include "tag/Pool.hxx"
+#include "lib/icu/CaseFold.hxx"
+#include "util/AllocatedString.hxx"
+#include "util/CharUtil.hxx"
+
+/**
+ * Iterate over all trigrams of the ASCII-lowercased text and invoke
+ * the given function for each of them.
+ */
+template<typename F>
+static void
+ForEachTrigram(const char *text, F &&f) noexcept
+{
+	uint_least32_t window = 0;
+	unsigned n = 0;
+
+	for (const char *p = text; *p != 0; ++p) {
+		const auto ch = (unsigned char)ToLowerASCII(*p);
+		window = ((window << 8) | ch) & 0xffffff;
+
+		if (++n >= 3)
+			f(window);
+	}
+}
+
+inline void
+TagBloomFilter::AddText(const char *text) noexcept
+{
+	ForEachTrigram(text, [this](uint_least32_t trigram){
+		const auto p = Positions(trigram);
+		bits[p.first / 64] |= uint_least64_t(1) << (p.first % 64);
+		bits[p.second / 64] |= uint_least64_t(1) << (p.second % 64);
+	});
+}
+
+void
+TagBloomFilter::AddTag(const Tag &tag) noexcept
+{
+	for (const auto &item : tag)
+		AddText(tag_pool_get_folded(item));
+}
+
+TagBloomQuery::TagBloomQuery(const SongFilter *filter)
+{
+	if (filter == nullptr)
+		return;
+
+	for (const auto &item : filter->GetItems()) {
+		if (item.GetTag() >= TAG_NUM_OF_ITEM_TYPES &&
+		    item.GetTag() != LOCATE_TAG_ANY_TYPE)
+			/* not a tag value match ("file", "base",
+			   "modified-since"): the Bloom filter cannot
+			   help */
+			continue;
+
+		/* fold the needle exactly like the filter itself
+		   does, so its trigrams live in the same domain as
+		   those collected by TagBloomFilter::AddTag() */
+#ifdef HAVE_ICU_CASE_FOLD
+		const auto folded = IcuCaseFold(item.GetValue());
+		if (folded.IsNull())
+			continue;
+
+		const char *needle = folded.c_str();
+#else
+		const char *needle = item.GetValue();
+#endif
+
+		ForEachTrigram(needle, [this](uint_least32_t trigram){
+			const auto p = TagBloomFilter::Positions(trigram);
+			positions.push_back(p.first);
+			positions.push_back(p.second);
+		});
+	}
+}
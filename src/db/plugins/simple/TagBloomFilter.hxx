@@ -0,0 +1,122 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_TAG_BLOOM_FILTER_HXX
+#define MPD_TAG_BLOOM_FILTER_HXX
+
+#include "check.h"
+#include "Compiler.h"
+
+#include <array>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+
+struct Tag;
+class SongFilter;
+
+/**
+ * A small Bloom filter over the trigrams of tag values, kept per
+ * #Directory as an aggregate over its whole subtree.  A filtered walk
+ * consults it (via #TagBloomQuery) to skip subtrees which cannot
+ * contain a matching song, which turns worst-case full scans of huge
+ * databases into scans of the few subtrees that may match.
+ *
+ * The trigrams are taken from the case-folded tag values (see
+ * tag_pool_get_folded()), additionally ASCII-lowercased, and the
+ * query side folds its needles the same way, so a missing trigram
+ * proves the absence of a match; a present trigram proves nothing.
+ * Bits are never cleared when songs are removed, so the filter may
+ * overestimate over time; that only costs pruning opportunities,
+ * never correctness.
+ */
+class TagBloomFilter {
+	static constexpr unsigned N_BITS = 1024;
+
+	std::array<uint_least64_t, N_BITS / 64> bits{{}};
+
+public:
+	void Clear() noexcept {
+		bits.fill(0);
+	}
+
+	/**
+	 * Add all trigrams of all values of the given tag.  The tag
+	 * items must live in the tag pool (true for all database
+	 * songs), because their cached case-folded variants are used.
+	 */
+	void AddTag(const Tag &tag) noexcept;
+
+	bool IsSet(unsigned position) const noexcept {
+		return (bits[position / 64] &
+			(uint_least64_t(1) << (position % 64))) != 0;
+	}
+
+	/**
+	 * Compute the two bit positions of one trigram; used by both
+	 * the filter and the query side.
+	 */
+	static std::pair<unsigned, unsigned> Positions(uint_least32_t trigram) noexcept {
+		return {
+			unsigned((trigram * 2654435761u) % N_BITS),
+			unsigned(((trigram * 0x9E3779B1u) >> 13) % N_BITS),
+		};
+	}
+
+private:
+	void AddText(const char *text) noexcept;
+};
+
+/**
+ * The pre-computed Bloom filter probe for a #SongFilter: the bit
+ * positions of all needle trigrams which must be present in a
+ * subtree's #TagBloomFilter for any song in it to match.  Computing
+ * this involves case folding the needles, so it is done once per walk
+ * instead of once per directory.
+ */
+class TagBloomQuery {
+	/**
+	 * All required bit positions; empty if the filter has no
+	 * needle usable for pruning.
+	 */
+	std::vector<unsigned> positions;
+
+public:
+	/**
+	 * @param filter the song filter, or nullptr (which never
+	 * prunes)
+	 */
+	explicit TagBloomQuery(const SongFilter *filter);
+
+	/**
+	 * May a subtree summarized by the given filter contain a
+	 * matching song?
+	 */
+	gcc_pure
+	bool MayMatch(const TagBloomFilter &bloom) const noexcept {
+		for (unsigned position : positions)
+			if (!bloom.IsSet(position))
+				return false;
+
+		return true;
+	}
+};
+
+#endif
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "UpdateJournal.hxx"
+#include "Directory.hxx"
+#include "Song.hxx"
+#include "SongSave.hxx"
+#include "DetachedSong.hxx"
+#include "db/DatabaseLock.hxx"
+#include "fs/io/BufferedOutputStream.hxx"
+#include "fs/io/LineReader.hxx"
+#include "util/StringCompare.hxx"
+#include "util/RuntimeError.hxx"
+
+#include <string.h>
+
+#define JOURNAL_REMOVE_SONG "remove_song: "
+#define JOURNAL_REMOVE_DIRECTORY "remove_directory: "
+#define JOURNAL_ADD "add: "
+
+static void
+SaveAddSong(BufferedOutputStream &os, Directory &root, const char *uri)
+{
+	const ScopeDatabaseLock protect;
+
+	auto r = root.LookupDirectory(uri);
+	if (r.uri == nullptr || strchr(r.uri, '/') != nullptr)
+		/* not a song URI */
+		return;
+
+	const Song *song = r.directory->FindSong(r.uri);
+	if (song == nullptr)
+		/* deleted meanwhile; the removal has its own
+		   record */
+		return;
+
+	os.Format(JOURNAL_ADD "%s\n", r.directory->GetPath().c_str());
+	song_save(os, *song);
+}
+
+void
+UpdateJournal::Save(BufferedOutputStream &os, Directory &root)
+{
+	const std::lock_guard<Mutex> protect(mutex);
+
+	for (const auto &record : records) {
+		switch (record.op) {
+		case Op::ADD_SONG:
+			SaveAddSong(os, root, record.uri.c_str());
+			break;
+
+		case Op::REMOVE_SONG:
+			os.Format(JOURNAL_REMOVE_SONG "%s\n",
+				  record.uri.c_str());
+			break;
+
+		case Op::REMOVE_DIRECTORY:
+			os.Format(JOURNAL_REMOVE_DIRECTORY "%s\n",
+				  record.uri.c_str());
+			break;
+		}
+	}
+}
+
+/**
+ * Look up the given directory URI, creating missing path components
+ * on the way.
+ *
+ * Caller must lock the #db_mutex.
+ */
+static Directory &
+MakeDirectoryChain(Directory &root, const char *uri)
+{
+	Directory *directory = &root;
+
+	std::string remaining(uri);
+	while (!remaining.empty()) {
+		const auto slash = remaining.find('/');
+		const auto name = remaining.substr(0, slash);
+
+		if (!name.empty())
+			directory = directory->MakeChild(name.c_str());
+
+		if (slash == std::string::npos)
+			break;
+
+		remaining.erase(0, slash + 1);
+	}
+
+	return *directory;
+}
+
+static void
+ReplayRemoveSong(Directory &root, const char *uri)
+{
+	const ScopeDatabaseLock protect;
+
+	auto r = root.LookupDirectory(uri);
+	if (r.uri == nullptr || strchr(r.uri, '/') != nullptr)
+		return;
+
+	Song *song = r.directory->FindSong(r.uri);
+	if (song == nullptr)
+		return;
+
+	r.directory->RemoveSong(song);
+	song->Free();
+}
+
+static void
+ReplayRemoveDirectory(Directory &root, const char *uri)
+{
+	const ScopeDatabaseLock protect;
+
+	auto r = root.LookupDirectory(uri);
+	if (r.uri != nullptr || r.directory->IsRoot())
+		return;
+
+	r.directory->Delete();
+}
+
+static void
+ReplayAddSong(LineReader &file, Directory &root, const char *parent_uri)
+{
+	const char *line = file.ReadLine();
+	if (line == nullptr)
+		throw std::runtime_error("Unexpected end of journal file");
+
+	const char *name = StringAfterPrefix(line, SONG_BEGIN);
+	if (name == nullptr)
+		throw FormatRuntimeError("Malformed journal line: %s", line);
+
+	auto song = song_load(file, name);
+
+	const ScopeDatabaseLock protect;
+
+	Directory &directory = MakeDirectoryChain(root, parent_uri);
+
+	Song *old_song = directory.FindSong(name);
+	if (old_song != nullptr) {
+		/* replace the existing song */
+		directory.RemoveSong(old_song);
+		old_song->Free();
+	}
+
+	directory.AddSong(Song::NewFrom(std::move(*song), directory));
+}
+
+void
+journal_replay(LineReader &file, Directory &root)
+{
+	const char *line;
+	while ((line = file.ReadLine()) != nullptr) {
+		const char *p;
+
+		if ((p = StringAfterPrefix(line, JOURNAL_ADD))) {
+			/* copy the parent URI because ReadLine()
+			   invalidates the buffer */
+			const std::string parent_uri(p);
+			ReplayAddSong(file, root, parent_uri.c_str());
+		} else if ((p = StringAfterPrefix(line, JOURNAL_REMOVE_SONG))) {
+			ReplayRemoveSong(root, p);
+		} else if ((p = StringAfterPrefix(line, JOURNAL_REMOVE_DIRECTORY))) {
+			ReplayRemoveDirectory(root, p);
+		} else {
+			throw FormatRuntimeError("Malformed journal line: %s",
+						 line);
+		}
+	}
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_UPDATE_JOURNAL_HXX
+#define MPD_UPDATE_JOURNAL_HXX
+
+#include "check.h"
+#include "thread/Mutex.hxx"
+
+#include <list>
+#include <mutex>
+#include <string>
+
+#include <stdint.h>
+
+struct Directory;
+class BufferedOutputStream;
+class LineReader;
+
+/**
+ * Collects the changes applied to a #SimpleDatabase during an update,
+ * so SimpleDatabase::Save() can append just those changes to a
+ * journal file instead of rewriting the whole database file.
+ *
+ * Change types which are not journaled (e.g. playlist or archive
+ * changes) set the "overflow" flag, which forces the next save to be
+ * a full rewrite.
+ */
+class UpdateJournal {
+public:
+	enum class Op : uint8_t {
+		ADD_SONG,
+		REMOVE_SONG,
+		REMOVE_DIRECTORY,
+	};
+
+private:
+	struct Record {
+		Op op;
+		std::string uri;
+
+		Record(Op _op, std::string &&_uri)
+			:op(_op), uri(std::move(_uri)) {}
+	};
+
+	mutable Mutex mutex;
+
+	std::list<Record> records;
+
+	bool overflow = false;
+
+public:
+	/**
+	 * A song was added or its tags were re-read.  On replay, the
+	 * song record replaces any existing song with the same URI.
+	 */
+	void RecordSongAdded(std::string &&uri) {
+		const std::lock_guard<Mutex> protect(mutex);
+		records.emplace_back(Op::ADD_SONG, std::move(uri));
+	}
+
+	void RecordSongRemoved(std::string &&uri) {
+		const std::lock_guard<Mutex> protect(mutex);
+		records.emplace_back(Op::REMOVE_SONG, std::move(uri));
+	}
+
+	void RecordDirectoryRemoved(std::string &&uri) {
+		const std::lock_guard<Mutex> protect(mutex);
+		records.emplace_back(Op::REMOVE_DIRECTORY, std::move(uri));
+	}
+
+	/**
+	 * A change was made which cannot be represented in the
+	 * journal; the next save must rewrite the database file.
+	 */
+	void SetOverflow() {
+		const std::lock_guard<Mutex> protect(mutex);
+		overflow = true;
+	}
+
+	bool IsOverflowed() const {
+		const std::lock_guard<Mutex> protect(mutex);
+		return overflow;
+	}
+
+	bool IsEmpty() const {
+		const std::lock_guard<Mutex> protect(mutex);
+		return records.empty();
+	}
+
+	/**
+	 * Invoke the callback for each record, in the order in which
+	 * the changes were made (for the "dbsync" changelog).
+	 */
+	template<typename F>
+	void ForEachRecord(F &&f) const {
+		const std::lock_guard<Mutex> protect(mutex);
+		for (const auto &record : records)
+			f(record.op, record.uri.c_str());
+	}
+
+	void Clear() {
+		const std::lock_guard<Mutex> protect(mutex);
+		records.clear();
+		overflow = false;
+	}
+
+	/**
+	 * Append all records to the journal file.  For added songs,
+	 * the current state of the song is looked up in the given
+	 * tree and serialized; songs which have been deleted
+	 * meanwhile are skipped.
+	 *
+	 * Caller must not lock the #db_mutex.
+	 */
+	void Save(BufferedOutputStream &os, Directory &root);
+};
+
+/**
+ * Replay a journal file on top of a freshly loaded database.
+ *
+ * Throws on fatal errors; the caller should discard the database
+ * then.
+ */
+void
+journal_replay(LineReader &file, Directory &root);
+
+#endif
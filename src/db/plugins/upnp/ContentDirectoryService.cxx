@@ -184,3 +184,29 @@ ContentDirectoryService::getMetadata(UpnpClient_Handle hdl,
 	ReadResultTag(dirbuf, response.get());
 	return dirbuf;
 }
+
+unsigned
+ContentDirectoryService::getSystemUpdateID(UpnpClient_Handle hdl) const
+{
+	UniqueIxmlDocument request(MakeActionHelper("GetSystemUpdateID",
+						    m_serviceType.c_str()));
+	if (!request)
+		throw std::runtime_error("UpnpMakeAction() failed");
+
+	IXML_Document *_response;
+	auto code = UpnpSendAction(hdl, m_actionURL.c_str(),
+				   m_serviceType.c_str(),
+				   0 /*devUDN*/, request.get(), &_response);
+	if (code != UPNP_E_SUCCESS)
+		throw FormatRuntimeError("UpnpSendAction() failed: %s",
+					 UpnpGetErrorMessage(code));
+
+	UniqueIxmlDocument response(_response);
+
+	const char *value = ixmlwrap::getFirstElementValue(response.get(),
+							   "Id");
+	if (value == nullptr)
+		throw std::runtime_error("Bad GetSystemUpdateID response");
+
+	return ParseUnsigned(value);
+}
@@ -240,5 +240,21 @@ void
 UPnPDirContent::Parse(const char *input)
 {
 	UPnPDirParser parser(*this);
-	parser.Parse(input, strlen(input), true);
+
+	/* feed the document incrementally instead of in one gulp:
+	   expat then only ever buffers one chunk (plus a partial
+	   token), instead of copying the whole document - which can
+	   be several megabytes for large containers - into its
+	   internal buffer, and finished objects are moved into the
+	   result vector while parsing is still in progress */
+	constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+	size_t remaining = strlen(input);
+	while (remaining > CHUNK_SIZE) {
+		parser.Parse(input, CHUNK_SIZE, false);
+		input += CHUNK_SIZE;
+		remaining -= CHUNK_SIZE;
+	}
+
+	parser.Parse(input, remaining, true);
 }
@@ -37,6 +37,9 @@ public:
 	UPnPDirContent() = default;
 	UPnPDirContent(UPnPDirContent &&) = default;
 
+	/* copies are needed to hand out cached directory listings */
+	UPnPDirContent(const UPnPDirContent &) = default;
+
 	~UPnPDirContent();
 
 	gcc_pure
@@ -76,6 +76,9 @@ public:
 	UPnPDirObject() = default;
 	UPnPDirObject(UPnPDirObject &&) = default;
 
+	/* copies are needed to hand out cached directory listings */
+	UPnPDirObject(const UPnPDirObject &) = default;
+
 	~UPnPDirObject() noexcept;
 
 	UPnPDirObject &operator=(UPnPDirObject &&) = default;
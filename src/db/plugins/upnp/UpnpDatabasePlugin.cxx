@@ -37,9 +37,12 @@
 #include "tag/Table.hxx"
 #include "tag/Mask.hxx"
 #include "fs/Traits.hxx"
+#include "thread/Mutex.hxx"
 #include "Log.hxx"
 #include "SongFilter.hxx"
 
+#include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <set>
@@ -73,6 +76,30 @@ class UpnpDatabase : public Database {
 	UpnpClient_Handle handle;
 	UPnPDeviceDirectory *discovery;
 
+	struct CachedContainer {
+		unsigned update_id;
+		UPnPDirContent content;
+	};
+
+	/**
+	 * Protects #container_cache.
+	 */
+	mutable Mutex container_cache_mutex;
+
+	/**
+	 * Caches Browse responses, keyed by the server's device id
+	 * and the container's object id.  An entry is only used while
+	 * the server's SystemUpdateID still matches the one it was
+	 * fetched with, so unchanged containers are not re-fetched on
+	 * every browse.
+	 */
+	mutable std::map<std::string, CachedContainer> container_cache;
+
+	/**
+	 * The maximum number of cached containers.
+	 */
+	static constexpr size_t MAX_CACHED_CONTAINERS = 64;
+
 public:
 	explicit UpnpDatabase(EventLoop &_event_loop)
 		:Database(upnp_db_plugin),
@@ -133,6 +160,13 @@ private:
 	UPnPDirObject ReadNode(const ContentDirectoryService &server,
 			       const char *objid) const;
 
+	/**
+	 * Read a container's children list, consulting
+	 * #container_cache first.
+	 */
+	UPnPDirContent ReadContainer(const ContentDirectoryService &server,
+				     const char *objid) const;
+
 	/**
 	 * Get the path for an object Id. This works much like pwd,
 	 * except easier cause our inodes have a parent id. Not used
@@ -319,6 +353,7 @@ visitSong(const UPnPDirObject &meta, const char *path,
 	song.uri = path;
 	song.real_uri = meta.url.c_str();
 	song.tag = &meta.tag;
+	song.replay_gain = nullptr;
 	song.mtime = std::chrono::system_clock::time_point::min();
 	song.start_time = song.end_time = SongTime::zero();
 
@@ -386,6 +421,52 @@ UpnpDatabase::ReadNode(const ContentDirectoryService &server,
 	return std::move(dirbuf.objects.front());
 }
 
+UPnPDirContent
+UpnpDatabase::ReadContainer(const ContentDirectoryService &server,
+			    const char *objid) const
+{
+	unsigned update_id;
+	try {
+		update_id = server.getSystemUpdateID(handle);
+	} catch (...) {
+		/* this server does not implement GetSystemUpdateID:
+		   bypass the cache, there is no way to validate it */
+		return server.readDir(handle, objid);
+	}
+
+	const std::string key = server.GetURI() + '\0' + objid;
+
+	{
+		const std::lock_guard<Mutex> protect(container_cache_mutex);
+		auto i = container_cache.find(key);
+		if (i != container_cache.end()) {
+			if (i->second.update_id == update_id)
+				return i->second.content;
+
+			/* stale: the server has been modified since
+			   this entry was fetched */
+			container_cache.erase(i);
+		}
+	}
+
+	auto content = server.readDir(handle, objid);
+
+	{
+		const std::lock_guard<Mutex> protect(container_cache_mutex);
+
+		if (container_cache.size() >= MAX_CACHED_CONTAINERS)
+			/* primitive eviction; the cache is small and
+			   refills quickly */
+			container_cache.clear();
+
+		container_cache.emplace(key,
+					CachedContainer{update_id,
+							UPnPDirContent(content)});
+	}
+
+	return content;
+}
+
 std::string
 UpnpDatabase::BuildPath(const ContentDirectoryService &server,
 			const UPnPDirObject& idirent) const
@@ -420,7 +501,7 @@ UpnpDatabase::Namei(const ContentDirectoryService &server,
 
 	// Walk the path elements, read each directory and try to find the next one
 	for (auto i = vpath.begin(), last = std::prev(vpath.end());; ++i) {
-		auto dirbuf = server.readDir(handle, objid.c_str());
+		auto dirbuf = ReadContainer(server, objid.c_str());
 
 		// Look for the name in the sub-container list
 		UPnPDirObject *child = dirbuf.FindObject(i->c_str());
@@ -567,7 +648,7 @@ UpnpDatabase::VisitServer(const ContentDirectoryService &server,
 	/* Target was a a container. Visit it. We could read slices
 	   and loop here, but it's not useful as mpd will only return
 	   data to the client when we're done anyway. */
-	for (const auto &dirent : server.readDir(handle, tdirent.id.c_str()).objects) {
+	for (const auto &dirent : ReadContainer(server, tdirent.id.c_str()).objects) {
 		const std::string uri = PathTraitsUTF8::Build(base_uri,
 							      dirent.name.c_str());
 		VisitObject(dirent, uri.c_str(),
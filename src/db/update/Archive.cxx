@@ -26,6 +26,7 @@
 #include "storage/StorageInterface.hxx"
 #include "fs/AllocatedPath.hxx"
 #include "storage/FileInfo.hxx"
+#include "archive/ArchiveCache.hxx"
 #include "archive/ArchiveList.hxx"
 #include "archive/ArchivePlugin.hxx"
 #include "archive/ArchiveFile.hxx"
@@ -92,14 +93,20 @@ UpdateWalk::UpdateArchiveTree(ArchiveFile &archive, Directory &directory,
 
 				modified = true;
 				FormatDefault(update_domain, "added %s/%s",
-					      directory.GetPath(), name);
+					      directory.GetPath().c_str(), name);
 			}
 		} else {
+			const auto old_duration = song->GetDuration();
 			if (!song->UpdateFileInArchive(archive)) {
 				FormatDebug(update_domain,
 					    "deleting unrecognized file %s/%s",
-					    directory.GetPath(), name);
+					    directory.GetPath().c_str(), name);
 				editor.LockDeleteSong(directory, song);
+			} else {
+				const ScopeDatabaseLock protect;
+				directory.UpdateSongDuration(old_duration,
+							     song->GetDuration());
+				directory.NoteSongMtime(song->mtime);
 			}
 		}
 	}
@@ -143,7 +150,7 @@ UpdateWalk::UpdateArchiveFile(Directory &parent, const char *name,
 		   changed since - don't consider updating it */
 		return;
 
-	const auto path_fs = storage.MapChildFS(parent.GetPath(), name);
+	const auto path_fs = storage.MapChildFS(parent.GetPath().c_str(), name);
 	if (path_fs.IsNull())
 		/* not a local file: skip, because the archive API
 		   supports only local files */
@@ -152,7 +159,7 @@ UpdateWalk::UpdateArchiveFile(Directory &parent, const char *name,
 	/* open archive */
 	ArchiveFile *file;
 	try {
-		file = archive_file_open(&plugin, path_fs);
+		file = archive_cache_open(plugin, path_fs);
 	} catch (...) {
 		LogError(std::current_exception());
 		if (directory != nullptr)
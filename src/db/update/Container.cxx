@@ -57,20 +57,14 @@ UpdateWalk::MakeDirectoryIfModified(Directory &parent, const char *name,
 	return directory;
 }
 
-static bool
-SupportsContainerSuffix(const DecoderPlugin &plugin, const char *suffix)
-{
-	return plugin.container_scan != nullptr &&
-		plugin.SupportsSuffix(suffix);
-}
-
 bool
 UpdateWalk::UpdateContainerFile(Directory &directory,
 				const char *name, const char *suffix,
 				const StorageFileInfo &info)
 {
-	const DecoderPlugin *_plugin = decoder_plugins_find([suffix](const DecoderPlugin &plugin){
-			return SupportsContainerSuffix(plugin, suffix);
+	const DecoderPlugin *_plugin =
+		decoder_plugins_find_suffix(suffix, [](const DecoderPlugin &plugin){
+			return plugin.container_scan != nullptr;
 		});
 	if (_plugin == nullptr)
 		return false;
@@ -87,7 +81,7 @@ UpdateWalk::UpdateContainerFile(Directory &directory,
 		contdir->device = DEVICE_CONTAINER;
 	}
 
-	const auto pathname = storage.MapFS(contdir->GetPath());
+	const auto pathname = storage.MapFS(contdir->GetPath().c_str());
 	if (pathname.IsNull()) {
 		/* not a local file: skip, because the container API
 		   supports only local files */
@@ -110,7 +104,7 @@ UpdateWalk::UpdateContainerFile(Directory &directory,
 			song->mtime = info.mtime;
 
 			FormatDefault(update_domain, "added %s/%s",
-				      contdir->GetPath(), song->uri);
+				      contdir->GetPath().c_str(), song->uri);
 
 			{
 				const ScopeDatabaseLock protect;
@@ -24,6 +24,7 @@
 #include "db/DatabaseLock.hxx"
 #include "db/plugins/simple/Directory.hxx"
 #include "db/plugins/simple/Song.hxx"
+#include "db/plugins/simple/UpdateJournal.hxx"
 
 #include <assert.h>
 
@@ -32,6 +33,9 @@ DatabaseEditor::DeleteSong(Directory &dir, Song *del)
 {
 	assert(del->parent == &dir);
 
+	if (journal != nullptr)
+		journal->RecordSongRemoved(del->GetURI());
+
 	/* first, prevent traversers in main task from getting this */
 	dir.RemoveSong(del);
 
@@ -76,6 +80,9 @@ DatabaseEditor::DeleteDirectory(Directory *directory)
 {
 	assert(directory->parent != nullptr);
 
+	if (journal != nullptr)
+		journal->RecordDirectoryRemoved(directory->GetPath().c_str());
+
 	ClearDirectory(*directory);
 
 	directory->Delete();
@@ -26,13 +26,21 @@
 
 struct Directory;
 struct Song;
+class UpdateJournal;
 
 class DatabaseEditor final {
 	UpdateRemoveService remove;
 
+	/**
+	 * If non-nullptr, then all deletions are recorded here for
+	 * incremental database saves.
+	 */
+	UpdateJournal *const journal;
+
 public:
-	DatabaseEditor(EventLoop &_loop, DatabaseListener &_listener)
-		:remove(_loop, _listener) {}
+	DatabaseEditor(EventLoop &_loop, DatabaseListener &_listener,
+		       UpdateJournal *_journal=nullptr)
+		:remove(_loop, _listener), journal(_journal) {}
 
 	/**
 	 * Caller must lock the #db_mutex.
@@ -32,6 +32,18 @@
 static constexpr std::chrono::steady_clock::duration INOTIFY_UPDATE_DELAY =
 	std::chrono::seconds(5);
 
+/**
+ * The upper bound for the adaptive debounce delay.
+ */
+static constexpr std::chrono::steady_clock::duration INOTIFY_UPDATE_DELAY_MAX =
+	std::chrono::seconds(30);
+
+/**
+ * When the queue grows beyond this size, paths are merged into their
+ * common ancestors.
+ */
+static constexpr size_t INOTIFY_MAX_QUEUE_SIZE = 64;
+
 void
 InotifyQueue::OnDelay()
 {
@@ -67,10 +79,8 @@ path_in(const char *path, const char *possible_parent) noexcept
 }
 
 void
-InotifyQueue::Enqueue(const char *uri_utf8)
+InotifyQueue::AddPath(const char *uri_utf8)
 {
-	delay_event.Schedule(INOTIFY_UPDATE_DELAY);
-
 	for (auto i = queue.begin(), end = queue.end(); i != end;) {
 		const char *current_uri = i->c_str();
 
@@ -89,3 +99,48 @@ InotifyQueue::Enqueue(const char *uri_utf8)
 
 	queue.emplace_back(uri_utf8);
 }
+
+void
+InotifyQueue::Coalesce() noexcept
+{
+	while (queue.size() > INOTIFY_MAX_QUEUE_SIZE) {
+		/* strip the last component from every queued path
+		   and merge the results; repeating this walks the
+		   paths up towards their common ancestors */
+		std::list<std::string> old;
+		old.swap(queue);
+
+		for (const auto &uri : old) {
+			const auto slash = uri.rfind('/');
+			if (slash == std::string::npos) {
+				/* a top-level path: give up and
+				   update the whole database */
+				queue.clear();
+				queue.emplace_back();
+				return;
+			}
+
+			AddPath(uri.substr(0, slash).c_str());
+		}
+	}
+}
+
+void
+InotifyQueue::Enqueue(const char *uri_utf8)
+{
+	AddPath(uri_utf8);
+
+	if (queue.size() > INOTIFY_MAX_QUEUE_SIZE)
+		Coalesce();
+
+	/* adaptive debounce: the more paths are pending, the longer
+	   we wait for the burst to settle, so a bulk import ends up
+	   as one update of a whole subtree instead of a storm of
+	   small jobs */
+	auto delay = INOTIFY_UPDATE_DELAY +
+		std::chrono::seconds(queue.size() / 4);
+	if (delay > INOTIFY_UPDATE_DELAY_MAX)
+		delay = INOTIFY_UPDATE_DELAY_MAX;
+
+	delay_event.Schedule(delay);
+}
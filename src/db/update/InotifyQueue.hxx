@@ -42,6 +42,20 @@ public:
 	void Enqueue(const char *uri_utf8);
 
 private:
+	/**
+	 * Insert one path into the queue, merging it with enqueued
+	 * paths which contain it or are contained in it.
+	 */
+	void AddPath(const char *uri_utf8);
+
+	/**
+	 * Merge the queued paths into their common ancestors until
+	 * the queue is small enough.  Called when a bulk import
+	 * floods the queue, so it collapses into one subtree update
+	 * instead of a storm of small ones.
+	 */
+	void Coalesce() noexcept;
+
 	void OnDelay();
 };
 
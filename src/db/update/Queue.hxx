@@ -25,6 +25,7 @@
 
 #include <string>
 #include <list>
+#include <utility>
 
 class SimpleDatabase;
 class Storage;
@@ -63,6 +64,26 @@ public:
 
 	UpdateQueueItem Pop();
 
+	/**
+	 * Remove and return the first item accepted by the given
+	 * predicate (e.g. one whose database and storage are not
+	 * being walked right now), or an undefined item if there is
+	 * none.
+	 */
+	template<typename P>
+	UpdateQueueItem Pop(P &&predicate) {
+		for (auto i = update_queue.begin(), end = update_queue.end();
+		     i != end; ++i) {
+			if (predicate(*i)) {
+				auto item = std::move(*i);
+				update_queue.erase(i);
+				return item;
+			}
+		}
+
+		return UpdateQueueItem();
+	}
+
 	void Clear() {
 		update_queue.clear();
 	}
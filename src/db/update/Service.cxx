@@ -30,6 +30,8 @@
 #include "Log.hxx"
 #include "thread/Thread.hxx"
 #include "thread/Util.hxx"
+#include "ThreadConfig.hxx"
+#include "config/ConfigOption.hxx"
 
 #ifndef NDEBUG
 #include "event/Loop.hxx"
@@ -42,8 +44,7 @@ UpdateService::UpdateService(EventLoop &_loop, SimpleDatabase &_db,
 			     DatabaseListener &_listener)
 	:defer(_loop, BIND_THIS_METHOD(RunDeferred)),
 	 db(_db), storage(_storage),
-	 listener(_listener),
-	 update_thread(BIND_THIS_METHOD(Task))
+	 listener(_listener)
 {
 }
 
@@ -51,12 +52,33 @@ UpdateService::~UpdateService()
 {
 	CancelAllAsync();
 
-	if (update_thread.IsDefined())
-		update_thread.Join();
+	for (auto &job : jobs)
+		if (job.thread.IsDefined())
+			job.thread.Join();
+}
+
+UpdateService::Job::Job(UpdateService &_service, UpdateQueueItem &&_item)
+	:service(_service), item(std::move(_item)),
+	 walk(new UpdateWalk(service.GetEventLoop(), service.listener,
+			     *item.storage, item.db->GetUpdateJournal())),
+	 thread(BIND_THIS_METHOD(Task))
+{
+}
 
+UpdateService::Job::~Job()
+{
 	delete walk;
 }
 
+void
+UpdateService::Job::Start()
+{
+	thread.Start();
+
+	FormatDebug(update_domain,
+		    "spawned thread for update job id %i", item.id);
+}
+
 void
 UpdateService::CancelAllAsync()
 {
@@ -64,8 +86,8 @@ UpdateService::CancelAllAsync()
 
 	queue.Clear();
 
-	if (walk != nullptr)
-		walk->Cancel();
+	for (auto &job : jobs)
+		job.walk->Cancel();
 }
 
 void
@@ -83,77 +105,86 @@ UpdateService::CancelMount(const char *uri)
 	if (!lr.directory->IsMount())
 		return;
 
-	bool cancel_current = false;
-
 	Storage *storage2 = storage.GetMount(uri);
-	if (storage2 != nullptr) {
+	if (storage2 != nullptr)
 		queue.Erase(*storage2);
-		cancel_current = next.IsDefined() && next.storage == storage2;
-	}
 
+	SimpleDatabase *db2 = nullptr;
 	Database &_db2 = *lr.directory->mounted_database;
 	if (_db2.IsPlugin(simple_db_plugin)) {
-		SimpleDatabase &db2 = static_cast<SimpleDatabase &>(_db2);
-		queue.Erase(db2);
-		cancel_current |= next.IsDefined() && next.db == &db2;
+		db2 = static_cast<SimpleDatabase *>(&_db2);
+		queue.Erase(*db2);
 	}
 
-	if (cancel_current && walk != nullptr) {
-		walk->Cancel();
+	for (auto &job : jobs) {
+		if (job.item.storage != storage2 && job.item.db != db2)
+			continue;
 
-		if (update_thread.IsDefined())
-			update_thread.Join();
+		job.walk->Cancel();
+
+		if (job.thread.IsDefined())
+			job.thread.Join();
 	}
 }
 
 inline void
-UpdateService::Task()
+UpdateService::Job::Task() noexcept
 {
-	assert(walk != nullptr);
+	/* after a restart, the database may still be loading in the
+	   background; the walker must not edit a tree which the
+	   loader is still building */
+	item.db->WaitLoaded();
 
-	if (!next.path_utf8.empty())
+	if (!item.path_utf8.empty())
 		FormatDebug(update_domain, "starting: %s",
-			    next.path_utf8.c_str());
+			    item.path_utf8.c_str());
 	else
 		LogDebug(update_domain, "starting");
 
 	SetThreadIdlePriority();
+	ApplyThreadAffinity(ConfigOption::UPDATE_THREAD_AFFINITY);
 
-	modified = walk->Walk(next.db->GetRoot(), next.path_utf8.c_str(),
-			      next.discard);
+	modified = walk->Walk(item.db->GetRoot(), item.path_utf8.c_str(),
+			      item.discard);
 
-	if (modified || !next.db->FileExists()) {
+	if (modified || !item.db->FileExists()) {
 		try {
-			next.db->Save();
+			item.db->Save();
 		} catch (const std::exception &e) {
 			LogError(e, "Failed to save database");
 		}
 	}
 
-	if (!next.path_utf8.empty())
+	if (!item.path_utf8.empty())
 		FormatDebug(update_domain, "finished: %s",
-			    next.path_utf8.c_str());
+			    item.path_utf8.c_str());
 	else
 		LogDebug(update_domain, "finished");
 
-	defer.Schedule();
+	finished.store(true, std::memory_order_release);
+	service.defer.Schedule();
 }
 
-void
-UpdateService::StartThread(UpdateQueueItem &&i)
+bool
+UpdateService::IsBusy(const SimpleDatabase &db2,
+		      const Storage &storage2) const noexcept
 {
-	assert(GetEventLoop().IsInside());
-	assert(walk == nullptr);
-
-	modified = false;
+	for (const auto &job : jobs)
+		if (job.item.db == &db2 || job.item.storage == &storage2)
+			return true;
 
-	next = std::move(i);
-	walk = new UpdateWalk(GetEventLoop(), listener, *next.storage);
+	return false;
+}
 
-	update_thread.Start();
+void
+UpdateService::StartJob(UpdateQueueItem &&i)
+{
+	assert(GetEventLoop().IsInside());
+	assert(jobs.size() < MAX_JOBS);
+	assert(!IsBusy(*i.db, *i.storage));
 
-	FormatDebug(update_domain,
-		    "spawned thread for update job id %i", next.id);
+	jobs.emplace_back(*this, std::move(i));
+	jobs.back().Start();
 }
 
 unsigned
@@ -216,7 +247,7 @@ UpdateService::Enqueue(const char *path, bool discard)
 		   happen */
 		return 0;
 
-	if (walk != nullptr) {
+	if (jobs.size() >= MAX_JOBS || IsBusy(*db2, *storage2)) {
 		const unsigned id = GenerateId();
 		if (!queue.Push(*db2, *storage2, path, discard, id))
 			return 0;
@@ -226,7 +257,7 @@ UpdateService::Enqueue(const char *path, bool discard)
 	}
 
 	const unsigned id = update_task_id = GenerateId();
-	StartThread(UpdateQueueItem(*db2, *storage2, path, discard, id));
+	StartJob(UpdateQueueItem(*db2, *storage2, path, discard, id));
 
 	idle_add(IDLE_UPDATE);
 
@@ -234,33 +265,43 @@ UpdateService::Enqueue(const char *path, bool discard)
 }
 
 /**
- * Called in the main thread after the database update is finished.
+ * Called in the main thread after an update job has finished.
  */
 void
 UpdateService::RunDeferred() noexcept
 {
-	assert(next.IsDefined());
-	assert(walk != nullptr);
+	/* reap all finished jobs; several may have finished before
+	   this deferred call got to run */
+	for (auto i = jobs.begin(); i != jobs.end();) {
+		if (!i->finished.load(std::memory_order_acquire)) {
+			++i;
+			continue;
+		}
 
-	/* wait for thread to finish only if it wasn't cancelled by
-	   CancelMount() */
-	if (update_thread.IsDefined())
-		update_thread.Join();
+		/* the thread may already have been joined by
+		   CancelMount() */
+		if (i->thread.IsDefined())
+			i->thread.Join();
 
-	delete walk;
-	walk = nullptr;
+		const bool modified = i->modified;
+		i = jobs.erase(i);
 
-	next = UpdateQueueItem();
+		idle_add(IDLE_UPDATE);
 
-	idle_add(IDLE_UPDATE);
+		if (modified)
+			/* send "idle" events */
+			listener.OnDatabaseModified();
+	}
 
-	if (modified)
-		/* send "idle" events */
-		listener.OnDatabaseModified();
+	/* schedule queued paths whose database and storage are now
+	   idle */
+	while (jobs.size() < MAX_JOBS) {
+		auto i = queue.Pop([this](const UpdateQueueItem &item){
+			return !IsBusy(*item.db, *item.storage);
+		});
+		if (!i.IsDefined())
+			break;
 
-	auto i = queue.Pop();
-	if (i.IsDefined()) {
-		/* schedule the next path */
-		StartThread(std::move(i));
+		StartJob(std::move(i));
 	}
 }
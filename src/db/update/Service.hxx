@@ -26,15 +26,27 @@
 #include "thread/Thread.hxx"
 #include "Compiler.h"
 
+#include <atomic>
+#include <list>
+
 class SimpleDatabase;
 class DatabaseListener;
 class UpdateWalk;
 class CompositeStorage;
 
 /**
- * This class manages the update queue and runs the update thread.
+ * This class manages the update queue and runs the update threads.
+ * Each mount point has its own database and storage, and updates for
+ * different mounts run concurrently (one walker per mount), so a slow
+ * network share never delays updates of faster storages.
  */
 class UpdateService final {
+	/**
+	 * The maximum number of concurrently running update jobs;
+	 * further jobs stay in the queue until a slot is free.
+	 */
+	static constexpr unsigned MAX_JOBS = 4;
+
 	DeferEvent defer;
 
 	SimpleDatabase &db;
@@ -42,9 +54,36 @@ class UpdateService final {
 
 	DatabaseListener &listener;
 
-	bool modified;
+	/**
+	 * One running update: its queue item, its walker and the
+	 * thread the walk runs in.  At any time, there is at most one
+	 * job per database and per storage.
+	 */
+	struct Job {
+		UpdateService &service;
+
+		UpdateQueueItem item;
+
+		UpdateWalk *walk;
+
+		Thread thread;
 
-	Thread update_thread;
+		bool modified = false;
+
+		/**
+		 * Set by Task() when the walk has finished; the main
+		 * thread joins the thread and removes the job.
+		 */
+		std::atomic_bool finished{false};
+
+		Job(UpdateService &_service, UpdateQueueItem &&_item);
+		~Job();
+
+		void Start();
+
+		/* the update thread */
+		void Task() noexcept;
+	};
 
 	static constexpr unsigned update_task_id_max = 1 << 15;
 
@@ -52,9 +91,10 @@ class UpdateService final {
 
 	UpdateQueue queue;
 
-	UpdateQueueItem next;
-
-	UpdateWalk *walk = nullptr;
+	/**
+	 * All running jobs.  Modified only in the main thread.
+	 */
+	std::list<Job> jobs;
 
 public:
 	UpdateService(EventLoop &_loop, SimpleDatabase &_db,
@@ -69,10 +109,11 @@ public:
 
 	/**
 	 * Returns a non-zero job id when we are currently updating
-	 * the database.
+	 * the database.  With several jobs running, the oldest one is
+	 * reported.
 	 */
 	unsigned GetId() const {
-		return next.id;
+		return jobs.empty() ? 0 : jobs.front().item.id;
 	}
 
 	/**
@@ -102,10 +143,17 @@ private:
 	/* DeferEvent callback */
 	void RunDeferred() noexcept;
 
-	/* the update thread */
-	void Task();
+	/**
+	 * Is an update currently running for the given database or
+	 * storage?  Such items must wait in the queue: two walkers
+	 * must never edit the same directory tree or scan the same
+	 * storage at the same time.
+	 */
+	gcc_pure
+	bool IsBusy(const SimpleDatabase &db2,
+		    const Storage &storage2) const noexcept;
 
-	void StartThread(UpdateQueueItem &&i);
+	void StartJob(UpdateQueueItem &&i);
 
 	unsigned GenerateId();
 };
@@ -57,7 +57,7 @@ DirectoryExists(Storage &storage, const Directory &directory) noexcept
 	StorageFileInfo info;
 
 	try {
-		info = storage.GetInfo(directory.GetPath(), true);
+		info = storage.GetInfo(directory.GetPath().c_str(), true);
 	} catch (...) {
 		return false;
 	}
@@ -72,7 +72,7 @@ static StorageFileInfo
 GetDirectoryChildInfo(Storage &storage, const Directory &directory,
 		      const char *name_utf8)
 {
-	const auto uri_utf8 = PathTraitsUTF8::Build(directory.GetPath(),
+	const auto uri_utf8 = PathTraitsUTF8::Build(directory.GetPath().c_str(),
 						    name_utf8);
 	return storage.GetInfo(uri_utf8.c_str(), true);
 }
@@ -99,7 +99,7 @@ directory_child_access(Storage &storage, const Directory &directory,
 	(void)mode;
 	return true;
 #else
-	const auto path = storage.MapChildFS(directory.GetPath(), name);
+	const auto path = storage.MapChildFS(directory.GetPath().c_str(), name);
 	if (path.IsNull())
 		/* does not point to local file: silently ignore the
 		   check */
@@ -24,6 +24,7 @@
 #include "db/DatabaseLock.hxx"
 #include "db/plugins/simple/Directory.hxx"
 #include "db/plugins/simple/Song.hxx"
+#include "db/plugins/simple/UpdateJournal.hxx"
 #include "decoder/DecoderList.hxx"
 #include "storage/FileInfo.hxx"
 #include "Log.hxx"
@@ -44,7 +45,7 @@ UpdateWalk::UpdateSongFile2(Directory &directory,
 	if (!directory_child_access(storage, directory, name, R_OK)) {
 		FormatError(update_domain,
 			    "no read permissions on %s/%s",
-			    directory.GetPath(), name);
+			    directory.GetPath().c_str(), name);
 		if (song != nullptr)
 			editor.LockDeleteSong(directory, song);
 
@@ -53,6 +54,10 @@ UpdateWalk::UpdateSongFile2(Directory &directory,
 
 	if (!(song != nullptr && info.mtime == song->mtime && !walk_discard) &&
 	    UpdateContainerFile(directory, name, suffix, info)) {
+		if (journal != nullptr)
+			/* container contents are not journaled */
+			journal->SetOverflow();
+
 		if (song != nullptr)
 			editor.LockDeleteSong(directory, song);
 
@@ -61,12 +66,12 @@ UpdateWalk::UpdateSongFile2(Directory &directory,
 
 	if (song == nullptr) {
 		FormatDebug(update_domain, "reading %s/%s",
-			    directory.GetPath(), name);
-		song = Song::LoadFile(storage, name, directory);
+			    directory.GetPath().c_str(), name);
+		song = Song::LoadFile(storage, name, directory, info);
 		if (song == nullptr) {
 			FormatDebug(update_domain,
 				    "ignoring unrecognized file %s/%s",
-				    directory.GetPath(), name);
+				    directory.GetPath().c_str(), name);
 			return;
 		}
 
@@ -75,17 +80,35 @@ UpdateWalk::UpdateSongFile2(Directory &directory,
 			directory.AddSong(song);
 		}
 
+		if (journal != nullptr)
+			journal->RecordSongAdded(song->GetURI());
+
 		modified = true;
 		FormatDefault(update_domain, "added %s/%s",
-			      directory.GetPath(), name);
+			      directory.GetPath().c_str(), name);
 	} else if (info.mtime != song->mtime || walk_discard) {
 		FormatDefault(update_domain, "updating %s/%s",
-			      directory.GetPath(), name);
-		if (!song->UpdateFile(storage)) {
+			      directory.GetPath().c_str(), name);
+		const auto old_duration = song->GetDuration();
+		if (!song->UpdateFile(storage, info)) {
 			FormatDebug(update_domain,
 				    "deleting unrecognized file %s/%s",
-				    directory.GetPath(), name);
+				    directory.GetPath().c_str(), name);
 			editor.LockDeleteSong(directory, song);
+		} else {
+			{
+				/* the song was modified in place;
+				   adjust the per-directory duration
+				   aggregates */
+				const ScopeDatabaseLock protect;
+				directory.UpdateSongDuration(old_duration,
+							     song->GetDuration());
+				directory.NoteSongMtime(song->mtime);
+				directory.NoteSongTag(song->tag);
+			}
+
+			if (journal != nullptr)
+				journal->RecordSongAdded(song->GetURI());
 		}
 
 		modified = true;
@@ -100,6 +123,14 @@ UpdateWalk::UpdateSongFile(Directory &directory,
 	if (!decoder_plugins_supports_suffix(suffix))
 		return false;
 
-	UpdateSongFile2(directory, name, suffix, info);
+	if (HaveScanWorkers()) {
+		/* defer the tag scan to the worker pool; the results
+		   are merged into the directory under the db_lock */
+		const std::lock_guard<Mutex> protect(scan_mutex);
+		scan_queue.emplace_back(directory, name, suffix, info);
+		scan_cond.signal();
+	} else
+		UpdateSongFile2(directory, name, suffix, info);
+
 	return true;
 }
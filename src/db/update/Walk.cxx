@@ -27,6 +27,7 @@
 #include "db/Uri.hxx"
 #include "db/plugins/simple/Directory.hxx"
 #include "db/plugins/simple/Song.hxx"
+#include "db/plugins/simple/UpdateJournal.hxx"
 #include "storage/StorageInterface.hxx"
 #include "playlist/PlaylistRegistry.hxx"
 #include "ExcludeList.hxx"
@@ -50,10 +51,12 @@
 #include <errno.h>
 
 UpdateWalk::UpdateWalk(EventLoop &_loop, DatabaseListener &_listener,
-		       Storage &_storage)
+		       Storage &_storage,
+		       UpdateJournal *_journal)
 	:cancel(false),
 	 storage(_storage),
-	 editor(_loop, _listener)
+	 journal(_journal),
+	 editor(_loop, _listener, _journal)
 {
 #ifndef _WIN32
 	follow_inside_symlinks =
@@ -64,6 +67,9 @@ UpdateWalk::UpdateWalk(EventLoop &_loop, DatabaseListener &_listener,
 		config_get_bool(ConfigOption::FOLLOW_OUTSIDE_SYMLINKS,
 				DEFAULT_FOLLOW_OUTSIDE_SYMLINKS);
 #endif
+
+	skip_unchanged_directories =
+		config_get_bool(ConfigOption::UPDATE_SKIP_UNCHANGED, false);
 }
 
 static void
@@ -138,7 +144,7 @@ static bool
 update_directory_stat(Storage &storage, Directory &directory)
 {
 	StorageFileInfo info;
-	if (!GetInfo(storage, directory.GetPath(), info))
+	if (!GetInfo(storage, directory.GetPath().c_str(), info))
 		return false;
 
 	directory_set_stat(directory, info);
@@ -195,8 +201,14 @@ UpdateWalk::UpdatePlaylistFile(Directory &directory,
 	PlaylistInfo pi(name, info.mtime);
 
 	const ScopeDatabaseLock protect;
-	if (directory.playlists.UpdateOrInsert(std::move(pi)))
+	if (directory.playlists.UpdateOrInsert(std::move(pi))) {
 		modified = true;
+
+		if (journal != nullptr)
+			/* playlist changes are not journaled */
+			journal->SetOverflow();
+	}
+
 	return true;
 }
 
@@ -208,9 +220,17 @@ UpdateWalk::UpdateRegularFile(Directory &directory,
 	if (suffix == nullptr)
 		return false;
 
-	return UpdateSongFile(directory, name, suffix, info) ||
-		UpdateArchiveFile(directory, name, suffix, info) ||
-		UpdatePlaylistFile(directory, name, suffix, info);
+	if (UpdateSongFile(directory, name, suffix, info))
+		return true;
+
+	if (UpdateArchiveFile(directory, name, suffix, info)) {
+		if (journal != nullptr)
+			/* archive contents are not journaled */
+			journal->SetOverflow();
+		return true;
+	}
+
+	return UpdatePlaylistFile(directory, name, suffix, info);
 }
 
 void
@@ -259,7 +279,7 @@ UpdateWalk::SkipSymlink(const Directory *directory,
 			const char *utf8_name) const noexcept
 {
 #ifndef _WIN32
-	const auto path_fs = storage.MapChildFS(directory->GetPath(),
+	const auto path_fs = storage.MapChildFS(directory->GetPath().c_str(),
 						utf8_name);
 	if (path_fs.IsNull())
 		/* not a local file: don't skip */
@@ -334,10 +354,39 @@ UpdateWalk::UpdateDirectory(Directory &directory,
 
 	directory_set_stat(directory, info);
 
+	if (skip_unchanged_directories && !walk_discard &&
+	    info.mtime != std::chrono::system_clock::time_point::min() &&
+	    directory.mtime == info.mtime) {
+		/* this directory itself is unchanged, so no names
+		   have been added or removed: do not re-enumerate
+		   its entries; only descend into the known
+		   subdirectories, which track their own time
+		   stamps */
+		bool success = true;
+
+		directory.ForEachChildSafe([&](Directory &child){
+			if (cancel || child.IsMount())
+				return;
+
+			StorageFileInfo child_info;
+			if (!GetInfo(storage, child.GetPath().c_str(), child_info) ||
+			    !child_info.IsDirectory()) {
+				editor.LockDeleteDirectory(&child);
+				modified = true;
+				return;
+			}
+
+			if (!UpdateDirectory(child, exclude_list, child_info))
+				success = false;
+		});
+
+		return success;
+	}
+
 	std::unique_ptr<StorageDirectoryReader> reader;
 
 	try {
-		reader.reset(storage.OpenDirectory(directory.GetPath()));
+		reader.reset(storage.OpenDirectory(directory.GetPath().c_str()));
 	} catch (...) {
 		LogError(std::current_exception());
 		return false;
@@ -347,7 +396,7 @@ UpdateWalk::UpdateDirectory(Directory &directory,
 
 	{
 		const auto exclude_path_fs =
-			storage.MapChildFS(directory.GetPath(), ".mpdignore");
+			storage.MapChildFS(directory.GetPath().c_str(), ".mpdignore");
 		if (!exclude_path_fs.IsNull())
 			child_exclude_list.LoadFile(exclude_path_fs);
 	}
@@ -369,19 +418,27 @@ UpdateWalk::UpdateDirectory(Directory &directory,
 		}
 
 		if (SkipSymlink(&directory, name_utf8)) {
-			modified |= editor.DeleteNameIn(directory, name_utf8);
+			if (editor.DeleteNameIn(directory, name_utf8))
+				modified = true;
 			continue;
 		}
 
 		StorageFileInfo info2;
 		if (!GetInfo(*reader, info2)) {
-			modified |= editor.DeleteNameIn(directory, name_utf8);
+			if (editor.DeleteNameIn(directory, name_utf8))
+				modified = true;
 			continue;
 		}
 
 		UpdateDirectoryChild(directory, child_exclude_list, name_utf8, info2);
 	}
 
+	/* all scan tasks for this directory must be finished before
+	   the time stamp is committed, so an interrupted update does
+	   not mark the directory as complete */
+	if (HaveScanWorkers())
+		WaitScanDrain();
+
 	directory.mtime = info.mtime;
 
 	return true;
@@ -464,13 +521,15 @@ try {
 	const char *name = PathTraitsUTF8::GetBase(uri);
 
 	if (SkipSymlink(parent, name)) {
-		modified |= editor.DeleteNameIn(*parent, name);
+		if (editor.DeleteNameIn(*parent, name))
+			modified = true;
 		return;
 	}
 
 	StorageFileInfo info;
 	if (!GetInfo(storage, uri, info)) {
-		modified |= editor.DeleteNameIn(*parent, name);
+		if (editor.DeleteNameIn(*parent, name))
+			modified = true;
 		return;
 	}
 
@@ -481,23 +540,128 @@ try {
 	LogError(e);
 }
 
+void
+UpdateWalk::ScanWorker() noexcept
+{
+	std::unique_lock<Mutex> lock(scan_mutex);
+
+	while (true) {
+		while (scan_queue.empty() && !scan_stop)
+			scan_cond.wait(scan_mutex);
+
+		if (scan_queue.empty()) {
+			assert(scan_stop);
+			break;
+		}
+
+		ScanTask task = std::move(scan_queue.front());
+		scan_queue.pop_front();
+		++scan_busy;
+		lock.unlock();
+
+		try {
+			UpdateSongFile2(task.directory,
+					task.name.c_str(),
+					task.suffix.c_str(),
+					task.info);
+		} catch (const std::exception &e) {
+			LogError(e);
+		}
+
+		lock.lock();
+		if (--scan_busy == 0 && scan_queue.empty())
+			scan_drain_cond.broadcast();
+	}
+}
+
+void
+UpdateWalk::StartScanWorkers()
+{
+	assert(scan_threads.empty());
+	assert(scan_queue.empty());
+
+	const unsigned n = config_get_unsigned(ConfigOption::UPDATE_THREADS,
+					       1);
+	if (n < 2)
+		/* keep the old single-threaded code path */
+		return;
+
+	scan_stop = false;
+
+	try {
+		for (unsigned i = 0; i < n; ++i) {
+			scan_threads.emplace_back(BIND_THIS_METHOD(ScanWorker));
+			scan_threads.back().Start();
+		}
+	} catch (...) {
+		scan_threads.pop_back();
+		StopScanWorkers();
+		throw;
+	}
+}
+
+void
+UpdateWalk::WaitScanDrain() noexcept
+{
+	const std::lock_guard<Mutex> protect(scan_mutex);
+
+	if (cancel)
+		/* forget all queued tasks so the update can finish as
+		   quickly as possible */
+		scan_queue.clear();
+
+	while (!scan_queue.empty() || scan_busy > 0)
+		scan_drain_cond.wait(scan_mutex);
+}
+
+void
+UpdateWalk::StopScanWorkers() noexcept
+{
+	if (scan_threads.empty())
+		return;
+
+	WaitScanDrain();
+
+	{
+		const std::lock_guard<Mutex> protect(scan_mutex);
+		scan_stop = true;
+		scan_cond.broadcast();
+	}
+
+	for (auto &thread : scan_threads)
+		thread.Join();
+
+	scan_threads.clear();
+}
+
 bool
 UpdateWalk::Walk(Directory &root, const char *path, bool discard)
 {
 	walk_discard = discard;
 	modified = false;
 
-	if (path != nullptr && !isRootDirectory(path)) {
-		UpdateUri(root, path);
-	} else {
-		StorageFileInfo info;
-		if (!GetInfo(storage, "", info))
-			return false;
+	StartScanWorkers();
 
-		ExcludeList exclude_list;
+	try {
+		if (path != nullptr && !isRootDirectory(path)) {
+			UpdateUri(root, path);
+		} else {
+			StorageFileInfo info;
+			if (!GetInfo(storage, "", info)) {
+				StopScanWorkers();
+				return false;
+			}
 
-		UpdateDirectory(root, exclude_list, info);
+			ExcludeList exclude_list;
+
+			UpdateDirectory(root, exclude_list, info);
+		}
+	} catch (...) {
+		StopScanWorkers();
+		throw;
 	}
 
+	StopScanWorkers();
+
 	return modified;
 }
@@ -22,14 +22,22 @@
 
 #include "check.h"
 #include "Editor.hxx"
+#include "storage/FileInfo.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+#include "thread/Thread.hxx"
 #include "Compiler.h"
 
-struct StorageFileInfo;
+#include <atomic>
+#include <list>
+#include <string>
+
 struct Directory;
 struct ArchivePlugin;
 class ArchiveFile;
 class Storage;
 class ExcludeList;
+class UpdateJournal;
 
 class UpdateWalk final {
 #ifdef ENABLE_ARCHIVE
@@ -45,7 +53,20 @@ class UpdateWalk final {
 #endif
 
 	bool walk_discard;
-	bool modified;
+
+	/**
+	 * Skip re-enumerating directories whose mtime has not
+	 * changed?  Only known subdirectories are descended into
+	 * then, which makes no-op rescans on slow network storage
+	 * vastly cheaper, at the cost of missing songs which were
+	 * modified in place without touching the directory.
+	 */
+	bool skip_unchanged_directories;
+
+	/**
+	 * May be set by scan worker threads, too.
+	 */
+	std::atomic_bool modified;
 
 	/**
 	 * Set to true by the main thread when the update thread shall
@@ -56,11 +77,59 @@ class UpdateWalk final {
 
 	Storage &storage;
 
+	/**
+	 * Records changes for incremental database saves; may be
+	 * nullptr.
+	 */
+	UpdateJournal *const journal;
+
 	DatabaseEditor editor;
 
+	/**
+	 * A song file whose tag scan has been deferred to the scan
+	 * worker pool.
+	 */
+	struct ScanTask {
+		Directory &directory;
+		std::string name, suffix;
+		StorageFileInfo info;
+
+		ScanTask(Directory &_directory,
+			 const char *_name, const char *_suffix,
+			 const StorageFileInfo &_info)
+			:directory(_directory),
+			 name(_name), suffix(_suffix), info(_info) {}
+	};
+
+	/**
+	 * Protects #scan_queue, #scan_busy and #scan_stop.
+	 */
+	Mutex scan_mutex;
+
+	/**
+	 * Signalled when a task has been added to #scan_queue (or
+	 * when #scan_stop has been set).
+	 */
+	Cond scan_cond;
+
+	/**
+	 * Signalled by a worker whenever the queue has run empty and
+	 * no worker is busy anymore.
+	 */
+	Cond scan_drain_cond;
+
+	std::list<ScanTask> scan_queue;
+
+	std::list<Thread> scan_threads;
+
+	unsigned scan_busy = 0;
+
+	bool scan_stop = false;
+
 public:
 	UpdateWalk(EventLoop &_loop, DatabaseListener &_listener,
-		   Storage &_storage);
+		   Storage &_storage,
+		   UpdateJournal *_journal=nullptr);
 
 	/**
 	 * Cancel the current update and quit the Walk() method as
@@ -75,6 +144,11 @@ public:
 	 */
 	bool Walk(Directory &root, const char *path, bool discard);
 
+private:
+	bool HaveScanWorkers() const noexcept {
+		return !scan_threads.empty();
+	}
+
 private:
 	gcc_pure
 	bool SkipSymlink(const Directory *directory,
@@ -155,6 +229,26 @@ private:
 						 const char *uri);
 
 	void UpdateUri(Directory &root, const char *uri);
+
+	/**
+	 * Start the scan worker pool if more than one update thread
+	 * is configured.
+	 */
+	void StartScanWorkers();
+
+	/**
+	 * Wait until all queued scan tasks have been completed and
+	 * shut down the worker pool.
+	 */
+	void StopScanWorkers() noexcept;
+
+	/**
+	 * Wait until all currently queued scan tasks have been
+	 * completed.
+	 */
+	void WaitScanDrain() noexcept;
+
+	void ScanWorker() noexcept;
 };
 
 #endif
@@ -27,10 +27,12 @@
 #include "MusicPipe.hxx"
 #include "MusicBuffer.hxx"
 #include "MusicChunk.hxx"
+#include "PerfStats.hxx"
 #include "pcm/PcmConvert.hxx"
 #include "tag/Tag.hxx"
 #include "Log.hxx"
 #include "input/InputStream.hxx"
+#include "util/AllocAudit.hxx"
 #include "util/ConstBuffer.hxx"
 #include "util/StringBuffer.hxx"
 
@@ -98,7 +100,15 @@ DecoderBridge::GetChunk() noexcept
 		return current_chunk;
 
 	do {
-		current_chunk = dc.buffer->Allocate();
+		if (dc.chunk_reserve > 0 &&
+		    dc.buffer->GetFreeCount() <= dc.chunk_reserve)
+			/* keep some chunks free for the next song's
+			   decoder, so its first chunks do not have to
+			   wait for the pipe to drain */
+			current_chunk = nullptr;
+		else
+			current_chunk = dc.buffer->Allocate();
+
 		if (current_chunk != nullptr) {
 			current_chunk->replay_gain_serial = replay_gain_serial;
 			if (replay_gain_serial != 0)
@@ -121,11 +131,21 @@ DecoderBridge::FlushChunk()
 	assert(!initial_seek_pending);
 	assert(current_chunk != nullptr);
 
+	/* publishing a chunk is a steady-state hot path and must not
+	   allocate */
+	const ScopeAllocForbidden alloc_forbidden;
+
 	auto *chunk = std::exchange(current_chunk, nullptr);
 	if (chunk->IsEmpty())
 		dc.buffer->Return(chunk);
-	else
+	else {
+		perf_stats.decoder_chunks.fetch_add(1,
+						    std::memory_order_relaxed);
+		perf_stats.decoder_bytes.fetch_add(chunk->length,
+						   std::memory_order_relaxed);
+		chunk->decode_time = std::chrono::steady_clock::now();
 		dc.pipe->Push(chunk);
+	}
 
 	const std::lock_guard<Mutex> protect(dc.mutex);
 	if (dc.client_is_waiting)
@@ -523,6 +543,91 @@ DecoderBridge::SubmitData(InputStream *is,
 	return DecoderCommand::NONE;
 }
 
+WritableBuffer<void>
+DecoderBridge::GetWriteBuffer(InputStream *is, uint16_t kbit_rate)
+{
+	assert(dc.state == DecoderState::DECODE);
+	assert(dc.pipe != nullptr);
+
+	if (convert != nullptr)
+		/* the data would have to pass through the
+		   #PcmConvert; the plugin must use SubmitData() */
+		return nullptr;
+
+	assert(dc.in_audio_format == dc.out_audio_format);
+
+	if (LockGetVirtualCommand() != DecoderCommand::NONE)
+		/* make the plugin notice the command via
+		   GetCommand() */
+		return nullptr;
+
+	assert(!initial_seek_pending);
+	assert(!initial_seek_running);
+
+	/* send stream tags */
+
+	if (UpdateStreamTag(is)) {
+		DecoderCommand cmd;
+		if (decoder_tag != nullptr)
+			/* merge with tag from decoder plugin */
+			cmd = DoSendTag(*Tag::Merge(*decoder_tag,
+						    *stream_tag));
+		else
+			/* send only the stream tag */
+			cmd = DoSendTag(*stream_tag);
+
+		if (cmd != DecoderCommand::NONE)
+			return nullptr;
+	}
+
+	while (true) {
+		auto *chunk = GetChunk();
+		if (chunk == nullptr) {
+			assert(dc.command != DecoderCommand::NONE);
+			return nullptr;
+		}
+
+		const auto dest =
+			chunk->Write(dc.out_audio_format,
+				     SongTime::FromS(timestamp) -
+				     dc.song->GetStartTime(),
+				     kbit_rate);
+		if (dest.size >= dc.out_audio_format.GetFrameSize())
+			/* the API guarantees room for at least one
+			   frame */
+			return dest;
+
+		/* the chunk is full, flush it */
+		FlushChunk();
+	}
+}
+
+DecoderCommand
+DecoderBridge::CommitWriteBuffer(size_t length)
+{
+	assert(dc.state == DecoderState::DECODE);
+	assert(convert == nullptr);
+	assert(current_chunk != nullptr);
+	assert(length % dc.out_audio_format.GetFrameSize() == 0);
+
+	/* expand the music pipe chunk */
+
+	if (current_chunk->Expand(dc.out_audio_format, length))
+		/* the chunk is full, flush it */
+		FlushChunk();
+
+	timestamp += (double)length /
+		dc.out_audio_format.GetTimeToSize();
+
+	if (dc.end_time.IsPositive() &&
+	    timestamp >= dc.end_time.ToDoubleS())
+		/* the end of this range has been reached: stop
+		   decoding */
+		return DecoderCommand::STOP;
+
+	return DecoderCommand::NONE;
+}
+
 DecoderCommand
 DecoderBridge::SubmitTag(InputStream *is, Tag &&tag)
 {
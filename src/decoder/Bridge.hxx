@@ -146,6 +146,9 @@ public:
 	DecoderCommand SubmitData(InputStream *is,
 				  const void *data, size_t length,
 				  uint16_t kbit_rate) override;
+	WritableBuffer<void> GetWriteBuffer(InputStream *is,
+					    uint16_t kbit_rate) override;
+	DecoderCommand CommitWriteBuffer(size_t length) override;
 	DecoderCommand SubmitTag(InputStream *is, Tag &&tag) override ;
 	void SubmitReplayGain(const ReplayGainInfo *replay_gain_info) override;
 	void SubmitMixRamp(MixRampInfo &&mix_ramp) override;
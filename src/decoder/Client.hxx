@@ -24,6 +24,7 @@
 #include "DecoderCommand.hxx"
 #include "Chrono.hxx"
 #include "input/Ptr.hxx"
+#include "util/WritableBuffer.hxx"
 #include "Compiler.h"
 
 #include <stdint.h>
@@ -138,6 +139,48 @@ public:
 		return SubmitData(&is, data, length, kbit_rate);
 	}
 
+	/**
+	 * Obtain a buffer which the decoder plugin may decode
+	 * directly into, avoiding one copy through the plugin's own
+	 * buffer.  The buffer is guaranteed to hold at least one
+	 * frame.  After writing a whole number of frames into it, call
+	 * CommitWriteBuffer().
+	 *
+	 * This is an optional optimization for plugins which emit data
+	 * in the song's audio format; a nullptr return value is not an
+	 * error, it merely means that no such buffer is available
+	 * (e.g. because the data needs to be converted first), and the
+	 * plugin must fall back to SubmitData().
+	 *
+	 * @param is an input stream which is buffering while we are
+	 * waiting for the player
+	 * @param kbit_rate the current bit rate of the source file
+	 * @return a writable buffer, or nullptr if the plugin shall
+	 * use SubmitData() instead
+	 */
+	virtual WritableBuffer<void> GetWriteBuffer(gcc_unused InputStream *is,
+						    gcc_unused uint16_t kbit_rate) {
+		return nullptr;
+	}
+
+	WritableBuffer<void> GetWriteBuffer(InputStream &is,
+					    uint16_t kbit_rate) {
+		return GetWriteBuffer(&is, kbit_rate);
+	}
+
+	/**
+	 * Finish writing to the buffer returned by GetWriteBuffer().
+	 *
+	 * @param length the number of bytes which were written; must
+	 * be a whole number of frames and must not exceed the buffer
+	 * size
+	 * @return the current command, or DecoderCommand::NONE if
+	 * there is no command pending
+	 */
+	virtual DecoderCommand CommitWriteBuffer(gcc_unused size_t length) {
+		return DecoderCommand::NONE;
+	}
+
 	/**
 	 * This function is called by the decoder plugin when it has
 	 * successfully decoded a tag.
@@ -20,6 +20,7 @@
 #include "config.h"
 #include "DecoderBuffer.hxx"
 #include "DecoderAPI.hxx"
+#include "input/InputStream.hxx"
 
 bool
 DecoderBuffer::Fill()
@@ -65,5 +66,17 @@ DecoderBuffer::Skip(size_t nbytes)
 	buffer.Clear();
 	nbytes -= r.size;
 
+	if (is.CheapSeeking()) {
+		/* seek forward instead of reading and discarding;
+		   this skips large ID3 tags (e.g. embedded cover
+		   art) without copying them through the buffer */
+		try {
+			is.LockSeek(is.GetOffset() + nbytes);
+			return true;
+		} catch (...) {
+			/* fall back to reading */
+		}
+	}
+
 	return decoder_skip(client, is, nbytes);
 }
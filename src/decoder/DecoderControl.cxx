@@ -29,9 +29,11 @@
 
 DecoderControl::DecoderControl(Mutex &_mutex, Cond &_client_cond,
 			       const AudioFormat _configured_audio_format,
-			       const ReplayGainConfig &_replay_gain_config) noexcept
+			       const ReplayGainConfig &_replay_gain_config,
+			       unsigned _player_id) noexcept
 	:thread(BIND_THIS_METHOD(RunThread)),
 	 mutex(_mutex), client_cond(_client_cond),
+	 player_id(_player_id),
 	 configured_audio_format(_configured_audio_format),
 	 replay_gain_config(_replay_gain_config) {}
 
@@ -22,6 +22,8 @@
 
 #include "DecoderCommand.hxx"
 #include "AudioFormat.hxx"
+#include "player/CommandTrace.hxx"
+#include "Tracepoint.hxx"
 #include "MixRampInfo.hxx"
 #include "thread/Mutex.hxx"
 #include "thread/Cond.hxx"
@@ -31,6 +33,7 @@
 #include "ReplayGainMode.hxx"
 
 #include <exception>
+#include <string>
 #include <utility>
 #include <memory>
 
@@ -45,6 +48,7 @@
 class DetachedSong;
 class MusicBuffer;
 class MusicPipe;
+struct DecoderPlugin;
 
 enum class DecoderState : uint8_t {
 	STOP = 0,
@@ -115,6 +119,27 @@ struct DecoderControl {
 	bool seekable;
 	SongTime seek_time;
 
+	/**
+	 * The plugin which successfully decoded the previous local
+	 * file, and the file name suffix it was chosen for.  The next
+	 * song with the same suffix tries this plugin first, skipping
+	 * the probe loop; this is the common case during album
+	 * playback.
+	 *
+	 * These attributes are only used by the decoder thread and
+	 * need no protection.
+	 */
+	const DecoderPlugin *last_plugin = nullptr;
+
+	std::string last_plugin_suffix;
+
+	/**
+	 * The id of the #PlayerControl which owns this decoder.  It
+	 * is used to spread per-partition decoder threads round-robin
+	 * across the CPUs of a configured affinity list.
+	 */
+	const unsigned player_id;
+
 	/**
 	 * The "audio_output_format" setting.
 	 */
@@ -160,6 +185,15 @@ struct DecoderControl {
 	 */
 	MusicPipe *pipe;
 
+	/**
+	 * The number of chunks to keep free in #buffer while
+	 * decoding, so the next song's decoder can start filling them
+	 * right away (the "buffer_reserve_time" setting).  Written by
+	 * the player thread, read by the decoder thread; a stale
+	 * value is harmless.
+	 */
+	unsigned chunk_reserve = 0;
+
 	const ReplayGainConfig replay_gain_config;
 	ReplayGainMode replay_gain_mode = ReplayGainMode::OFF;
 
@@ -174,7 +208,8 @@ struct DecoderControl {
 	 */
 	DecoderControl(Mutex &_mutex, Cond &_client_cond,
 		       const AudioFormat _configured_audio_format,
-		       const ReplayGainConfig &_replay_gain_config) noexcept;
+		       const ReplayGainConfig &_replay_gain_config,
+		       unsigned _player_id=0) noexcept;
 	~DecoderControl() noexcept;
 
 	/**
@@ -330,6 +365,8 @@ private:
 	 * object.
 	 */
 	void SynchronousCommandLocked(DecoderCommand cmd) noexcept {
+		player_trace(cmd);
+
 		command = cmd;
 		Signal();
 		WaitCommandLocked();
@@ -343,9 +380,15 @@ private:
 	 * object.
 	 */
 	void LockSynchronousCommand(DecoderCommand cmd) noexcept {
-		const std::lock_guard<Mutex> protect(mutex);
-		ClearError();
-		SynchronousCommandLocked(cmd);
+		MPD_PROBE1(decoder_command_begin, unsigned(cmd));
+
+		{
+			const std::lock_guard<Mutex> protect(mutex);
+			ClearError();
+			SynchronousCommandLocked(cmd);
+		}
+
+		MPD_PROBE1(decoder_command_end, unsigned(cmd));
 	}
 
 	void LockAsynchronousCommand(DecoderCommand cmd) noexcept {
@@ -44,6 +44,12 @@
 #include "plugins/FluidsynthDecoderPlugin.hxx"
 #include "plugins/SidplayDecoderPlugin.hxx"
 #include "util/Macros.hxx"
+#include "util/CharUtil.hxx"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <string.h>
 
@@ -117,6 +123,59 @@ static constexpr unsigned num_decoder_plugins =
 /** which plugins have been initialized successfully? */
 bool decoder_plugins_enabled[num_decoder_plugins];
 
+typedef std::unordered_map<std::string, std::vector<unsigned>> DecoderDispatchMap;
+
+/**
+ * Maps each supported file name suffix / MIME type (in lower case) to
+ * the indices of the enabled plugins supporting it, in the order of
+ * the #decoder_plugins array.  Built by decoder_plugin_init_all(), so
+ * per-file plugin selection is one hash lookup instead of string
+ * comparisons against every plugin.
+ */
+static DecoderDispatchMap decoder_suffix_map, decoder_mime_type_map;
+
+static std::string
+ToLowerCase(const char *s) noexcept
+{
+	std::string result(s);
+	std::transform(result.begin(), result.end(), result.begin(),
+		       static_cast<char(*)(char)>(ToLowerASCII));
+	return result;
+}
+
+static void
+FillDispatchMap(DecoderDispatchMap &map, const char *const*keys,
+		unsigned plugin_index) noexcept
+{
+	if (keys == nullptr)
+		return;
+
+	for (auto i = keys; *i != nullptr; ++i)
+		map[ToLowerCase(*i)].push_back(plugin_index);
+}
+
+static ConstBuffer<unsigned>
+LookupDispatchMap(const DecoderDispatchMap &map, const char *key) noexcept
+{
+	auto i = map.find(ToLowerCase(key));
+	if (i == map.end())
+		return ConstBuffer<unsigned>::Null();
+
+	return {i->second.data(), i->second.size()};
+}
+
+ConstBuffer<unsigned>
+decoder_plugins_indices_by_suffix(const char *suffix) noexcept
+{
+	return LookupDispatchMap(decoder_suffix_map, suffix);
+}
+
+ConstBuffer<unsigned>
+decoder_plugins_indices_by_mime_type(const char *mime_type) noexcept
+{
+	return LookupDispatchMap(decoder_mime_type_map, mime_type);
+}
+
 const struct DecoderPlugin *
 decoder_plugin_from_name(const char *name) noexcept
 {
@@ -144,10 +203,25 @@ void decoder_plugin_init_all(void)
 		if (plugin.Init(*param))
 			decoder_plugins_enabled[i] = true;
 	}
+
+	/* now that the set of enabled plugins is known, build the
+	   suffix/MIME type dispatch tables */
+
+	for (unsigned i = 0; decoder_plugins[i] != nullptr; ++i) {
+		if (!decoder_plugins_enabled[i])
+			continue;
+
+		const DecoderPlugin &plugin = *decoder_plugins[i];
+		FillDispatchMap(decoder_suffix_map, plugin.suffixes, i);
+		FillDispatchMap(decoder_mime_type_map, plugin.mime_types, i);
+	}
 }
 
 void decoder_plugin_deinit_all(void)
 {
+	decoder_suffix_map.clear();
+	decoder_mime_type_map.clear();
+
 	decoder_plugins_for_each_enabled([=](const DecoderPlugin &plugin){
 			plugin.Finish();
 		});
@@ -156,7 +230,5 @@ void decoder_plugin_deinit_all(void)
 bool
 decoder_plugins_supports_suffix(const char *suffix) noexcept
 {
-	return decoder_plugins_try([suffix](const DecoderPlugin &plugin){
-			return plugin.SupportsSuffix(suffix);
-		});
+	return !decoder_plugins_indices_by_suffix(suffix).empty();
 }
@@ -20,6 +20,7 @@
 #ifndef MPD_DECODER_LIST_HXX
 #define MPD_DECODER_LIST_HXX
 
+#include "util/ConstBuffer.hxx"
 #include "Compiler.h"
 
 struct DecoderPlugin;
@@ -41,6 +42,27 @@ decoder_plugin_init_all();
 void
 decoder_plugin_deinit_all();
 
+/**
+ * Look up the indices (into #decoder_plugins) of all enabled plugins
+ * which declare support for the given file name suffix
+ * (case-insensitive), in array order.  The underlying table is built
+ * once by decoder_plugin_init_all(), turning per-file plugin
+ * selection into a single hash lookup.
+ *
+ * @param suffix the file name suffix (must not be nullptr)
+ */
+gcc_pure
+ConstBuffer<unsigned>
+decoder_plugins_indices_by_suffix(const char *suffix) noexcept;
+
+/**
+ * Like decoder_plugins_indices_by_suffix(), but for a MIME type
+ * (without parameters, see GetMimeTypeBase()).
+ */
+gcc_pure
+ConstBuffer<unsigned>
+decoder_plugins_indices_by_mime_type(const char *mime_type) noexcept;
+
 template<typename F>
 static inline const DecoderPlugin *
 decoder_plugins_find(F f)
@@ -63,6 +85,78 @@ decoder_plugins_try(F f)
 	return false;
 }
 
+/**
+ * Invoke the given function for each enabled plugin supporting the
+ * given suffix, until it returns true.
+ */
+template<typename F>
+static inline bool
+decoder_plugins_try_suffix(const char *suffix, F f)
+{
+	for (unsigned i : decoder_plugins_indices_by_suffix(suffix))
+		if (f(*decoder_plugins[i]))
+			return true;
+
+	return false;
+}
+
+/**
+ * Like decoder_plugins_try_suffix(), but accept plugins which support
+ * either the suffix or the MIME type; each matching plugin is tried
+ * once, in the order of the #decoder_plugins array.  Both parameters
+ * may be nullptr.
+ */
+template<typename F>
+static inline bool
+decoder_plugins_try_suffix_or_mime_type(const char *suffix,
+					const char *mime_type, F f)
+{
+	const auto a = suffix != nullptr
+		? decoder_plugins_indices_by_suffix(suffix)
+		: ConstBuffer<unsigned>::Null();
+	const auto b = mime_type != nullptr
+		? decoder_plugins_indices_by_mime_type(mime_type)
+		: ConstBuffer<unsigned>::Null();
+
+	/* merge the two (ascending) index lists */
+	size_t ai = 0, bi = 0;
+	while (ai < a.size || bi < b.size) {
+		unsigned i;
+		if (bi == b.size)
+			i = a[ai++];
+		else if (ai == a.size)
+			i = b[bi++];
+		else if (a[ai] < b[bi])
+			i = a[ai++];
+		else if (a[ai] > b[bi])
+			i = b[bi++];
+		else {
+			i = a[ai++];
+			++bi;
+		}
+
+		if (f(*decoder_plugins[i]))
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * Find the first enabled plugin supporting the given suffix for which
+ * the given function returns true.
+ */
+template<typename F>
+static inline const DecoderPlugin *
+decoder_plugins_find_suffix(const char *suffix, F f)
+{
+	for (unsigned i : decoder_plugins_indices_by_suffix(suffix))
+		if (f(*decoder_plugins[i]))
+			return decoder_plugins[i];
+
+	return nullptr;
+}
+
 template<typename F>
 static inline void
 decoder_plugins_for_each(F f)
@@ -38,6 +38,9 @@
 #include "util/Domain.hxx"
 #include "util/ScopeExit.hxx"
 #include "thread/Name.hxx"
+#include "Profiler.hxx"
+#include "ThreadConfig.hxx"
+#include "config/ConfigOption.hxx"
 #include "tag/ApeReplayGain.hxx"
 #include "Log.hxx"
 
@@ -168,45 +171,12 @@ decoder_file_decode(const DecoderPlugin &plugin,
 	return bridge.dc.state != DecoderState::START;
 }
 
-gcc_pure
-static bool
-decoder_check_plugin_mime(const DecoderPlugin &plugin,
-			  const InputStream &is) noexcept
-{
-	assert(plugin.stream_decode != nullptr);
-
-	const char *mime_type = is.GetMimeType();
-	return mime_type != nullptr &&
-		plugin.SupportsMimeType(GetMimeTypeBase(mime_type).c_str());
-}
-
-gcc_pure
-static bool
-decoder_check_plugin_suffix(const DecoderPlugin &plugin,
-			    const char *suffix) noexcept
-{
-	assert(plugin.stream_decode != nullptr);
-
-	return suffix != nullptr && plugin.SupportsSuffix(suffix);
-}
-
-gcc_pure
-static bool
-decoder_check_plugin(const DecoderPlugin &plugin, const InputStream &is,
-		     const char *suffix) noexcept
-{
-	return plugin.stream_decode != nullptr &&
-		(decoder_check_plugin_mime(plugin, is) ||
-		 decoder_check_plugin_suffix(plugin, suffix));
-}
-
 static bool
 decoder_run_stream_plugin(DecoderBridge &bridge, InputStream &is,
-			  const char *suffix,
 			  const DecoderPlugin &plugin,
 			  bool &tried_r)
 {
-	if (!decoder_check_plugin(plugin, is, suffix))
+	if (plugin.stream_decode == nullptr)
 		return false;
 
 	bridge.error = std::exception_ptr();
@@ -222,11 +192,17 @@ decoder_run_stream_locked(DecoderBridge &bridge, InputStream &is,
 	UriSuffixBuffer suffix_buffer;
 	const char *const suffix = uri_get_suffix(uri, suffix_buffer);
 
+	const char *mime_type = is.GetMimeType();
+	std::string mime_base;
+	const char *mime = nullptr;
+	if (mime_type != nullptr)
+		mime = (mime_base = GetMimeTypeBase(mime_type)).c_str();
+
 	using namespace std::placeholders;
 	const auto f = std::bind(decoder_run_stream_plugin,
-				 std::ref(bridge), std::ref(is), suffix,
+				 std::ref(bridge), std::ref(is),
 				 _1, std::ref(tried_r));
-	return decoder_plugins_try(f);
+	return decoder_plugins_try_suffix_or_mime_type(suffix, mime, f);
 }
 
 /**
@@ -358,13 +334,14 @@ TryContainerDecoder(DecoderBridge &bridge, Path path_fs, const char *suffix,
 static bool
 TryContainerDecoder(DecoderBridge &bridge, Path path_fs, const char *suffix)
 {
-	return decoder_plugins_try([&bridge, path_fs,
-				    suffix](const DecoderPlugin &plugin){
-					   return TryContainerDecoder(bridge,
-								      path_fs,
-								      suffix,
-								      plugin);
-				   });
+	return decoder_plugins_try_suffix(suffix,
+					  [&bridge, path_fs,
+					   suffix](const DecoderPlugin &plugin){
+						  return TryContainerDecoder(bridge,
+									     path_fs,
+									     suffix,
+									     plugin);
+					  });
 }
 
 /**
@@ -398,13 +375,37 @@ decoder_run_file(DecoderBridge &bridge, const char *uri_utf8, Path path_fs)
 	MaybeLoadReplayGain(bridge, *input_stream);
 
 	auto &is = *input_stream;
-	return decoder_plugins_try([&bridge, path_fs, suffix,
-				    &is](const DecoderPlugin &plugin){
-					   return TryDecoderFile(bridge,
-								 path_fs,
-								 suffix,
-								 is,
-								 plugin);
+
+	DecoderControl &dc = bridge.dc;
+
+	/* try the plugin which handled the previous song with the
+	   same suffix first, skipping the probe loop for consecutive
+	   tracks of the same type */
+	const DecoderPlugin *const last_plugin =
+		dc.last_plugin != nullptr && dc.last_plugin_suffix == suffix
+		? dc.last_plugin
+		: nullptr;
+	if (last_plugin != nullptr &&
+	    TryDecoderFile(bridge, path_fs, suffix, is, *last_plugin))
+		return true;
+
+	return decoder_plugins_try_suffix(suffix,
+					  [&bridge, &dc, path_fs, suffix, &is,
+				    last_plugin](const DecoderPlugin &plugin){
+					   if (&plugin == last_plugin)
+						   /* already tried above */
+						   return false;
+
+					   if (!TryDecoderFile(bridge,
+							       path_fs,
+							       suffix,
+							       is,
+							       plugin))
+						   return false;
+
+					   dc.last_plugin = &plugin;
+					   dc.last_plugin_suffix = suffix;
+					   return true;
 				   });
 }
 
@@ -456,6 +457,14 @@ decoder_run_song(DecoderControl &dc,
 	{
 		const ScopeUnlock unlock(dc.mutex);
 
+		/* if the song's replay gain is already known (e.g. it
+		   was collected by the database update), submit it
+		   now, so the very first chunks are decoded with the
+		   correct gain; the decoder plugin will overwrite it
+		   as soon as it has parsed the tags itself */
+		if (song.GetReplayGain().IsDefined())
+			bridge.SubmitReplayGain(&song.GetReplayGain());
+
 		AtScopeExit(&bridge) {
 			/* flush the last chunk */
 			if (bridge.current_chunk != nullptr)
@@ -518,6 +527,10 @@ DecoderControl::RunThread() noexcept
 {
 	SetThreadName("decoder");
 
+	const ProfilerThreadScope profiler_scope("decoder");
+
+	ApplyThreadAffinity(ConfigOption::DECODER_THREAD_AFFINITY, player_id);
+
 	const std::lock_guard<Mutex> protect(mutex);
 
 	do {
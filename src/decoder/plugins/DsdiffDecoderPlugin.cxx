@@ -342,13 +342,6 @@ dsdiff_read_metadata(DecoderClient *client, InputStream &is,
 	}
 }
 
-static void
-bit_reverse_buffer(uint8_t *p, uint8_t *end)
-{
-	for (; p < end; ++p)
-		*p = bit_reverse(*p);
-}
-
 static offset_type
 FrameToOffset(uint64_t frame, unsigned channels)
 {
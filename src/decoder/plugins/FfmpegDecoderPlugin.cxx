@@ -38,6 +38,7 @@
 #include "tag/MixRamp.hxx"
 #include "input/InputStream.hxx"
 #include "CheckAudioFormat.hxx"
+#include "AudioFormat.hxx"
 #include "util/ScopeExit.hxx"
 #include "util/ConstBuffer.hxx"
 #include "LogV.hxx"
@@ -53,6 +54,8 @@ extern "C" {
 #endif
 }
 
+#include <algorithm>
+
 #include <assert.h>
 #include <string.h>
 
@@ -242,6 +245,90 @@ PtsToPcmFrame(uint64_t pts, const AVStream &stream,
 	return av_rescale_q(pts, stream.time_base, codec_context.time_base);
 }
 
+/**
+ * Interleave the planar PCM data of a non-empty #AVFrame directly
+ * into buffers obtained from DecoderClient::GetWriteBuffer(),
+ * avoiding the copy through the plugin's interleave buffer.
+ *
+ * @return true if the frame was consumed (#cmd is valid), false if
+ * no direct buffer is available and the caller must fall back to
+ * copy_interleave_frame()
+ */
+static bool
+FfmpegSendFrameDirect(DecoderClient &client, InputStream &is,
+		      const AVCodecContext &codec_context,
+		      const AVFrame &frame,
+		      size_t &skip_bytes,
+		      DecoderCommand &cmd)
+{
+	const unsigned channels = codec_context.channels;
+	const size_t sample_size =
+		av_get_bytes_per_sample(codec_context.sample_fmt);
+	const size_t frame_size = channels * sample_size;
+	const uint16_t kbit_rate = codec_context.bit_rate / 1000;
+
+	const uint8_t *planes[MAX_CHANNELS];
+	for (unsigned i = 0; i < channels; ++i)
+		planes[i] = frame.extended_data[i];
+
+	size_t n_frames = frame.nb_samples;
+
+	/* skip_bytes is always a multiple of the PCM frame size (see
+	   ffmpeg_send_packet()) */
+	size_t skip_frames = skip_bytes / frame_size;
+	if (skip_frames >= n_frames) {
+		skip_bytes -= n_frames * frame_size;
+		cmd = DecoderCommand::NONE;
+		return true;
+	}
+
+	auto w = client.GetWriteBuffer(is, kbit_rate);
+	if (w.IsNull()) {
+		cmd = client.GetCommand();
+		/* with no command pending, the data needs to be
+		   converted, and the caller must copy it through the
+		   interleave buffer */
+		return cmd != DecoderCommand::NONE;
+	}
+
+	if (skip_frames > 0) {
+		for (unsigned i = 0; i < channels; ++i)
+			planes[i] += skip_frames * sample_size;
+		n_frames -= skip_frames;
+		skip_bytes = 0;
+	}
+
+	while (true) {
+		size_t n = std::min(n_frames, w.size / frame_size);
+		PcmInterleave(w.data,
+			      ConstBuffer<const void *>((const void *const*)planes,
+							channels),
+			      n, sample_size);
+
+		cmd = client.CommitWriteBuffer(n * frame_size);
+		if (cmd != DecoderCommand::NONE)
+			return true;
+
+		n_frames -= n;
+		if (n_frames == 0)
+			break;
+
+		for (unsigned i = 0; i < channels; ++i)
+			planes[i] += n * sample_size;
+
+		w = client.GetWriteBuffer(is, kbit_rate);
+		if (w.IsNull()) {
+			/* a command has arrived while we were
+			   waiting for a free chunk */
+			cmd = client.GetCommand();
+			return true;
+		}
+	}
+
+	cmd = DecoderCommand::NONE;
+	return true;
+}
+
 /**
  * Invoke DecoderClient::SubmitData() with the contents of an
  * #AVFrame.
@@ -253,6 +340,15 @@ FfmpegSendFrame(DecoderClient &client, InputStream &is,
 		size_t &skip_bytes,
 		FfmpegBuffer &buffer)
 {
+	if (av_sample_fmt_is_planar(codec_context.sample_fmt) &&
+	    codec_context.channels > 1) {
+		/* try to interleave straight into a MusicChunk */
+		DecoderCommand cmd;
+		if (FfmpegSendFrameDirect(client, is, codec_context, frame,
+					  skip_bytes, cmd))
+			return cmd;
+	}
+
 	ConstBuffer<void> output_buffer;
 
 	try {
@@ -28,6 +28,13 @@
 #include "tag/ReplayGain.hxx"
 #include "tag/MixRamp.hxx"
 #include "CheckAudioFormat.hxx"
+#include "fs/AllocatedPath.hxx"
+#include "fs/FileInfo.hxx"
+#include "fs/Limits.hxx"
+#include "fs/Traits.hxx"
+#include "fs/io/FileReader.hxx"
+#include "fs/io/FileOutputStream.hxx"
+#include "fs/io/BufferedOutputStream.hxx"
 #include "util/StringCompare.hxx"
 #include "util/Domain.hxx"
 #include "Log.hxx"
@@ -38,6 +45,7 @@
 #include <id3tag.h>
 #endif
 
+#include <algorithm>
 #include <stdexcept>
 
 #include <assert.h>
@@ -69,6 +77,12 @@ static constexpr Domain mad_domain("mad");
 
 static bool gapless_playback;
 
+/**
+ * The directory where seek tables are cached across decodes; a
+ * "nulled" path (the default) disables the cache.
+ */
+static AllocatedPath seek_table_cache_dir = nullptr;
+
 gcc_const
 static SongTime
 ToSongTime(mad_timer_t t) noexcept
@@ -107,13 +121,92 @@ mad_fixed_to_24_buffer(int32_t *dest, const struct mad_synth *synth,
 }
 
 static bool
-mp3_plugin_init(gcc_unused const ConfigBlock &block)
+mp3_plugin_init(const ConfigBlock &block)
 {
 	gapless_playback = config_get_bool(ConfigOption::GAPLESS_MP3_PLAYBACK,
 					   DEFAULT_GAPLESS_MP3_PLAYBACK);
+
+	seek_table_cache_dir = block.GetPath("seek_table_cache");
+
 	return true;
 }
 
+/**
+ * The header of a cached seek table file.  All fields are
+ * native-endian, because the cache never leaves this machine.
+ */
+struct SeekTableHeader {
+	static constexpr uint32_t MAGIC = 0x4d535431; /* "MST1" */
+
+	uint32_t magic;
+
+	/** the length of the song URI following this header */
+	uint32_t uri_length;
+
+	/** the size of the song file in bytes */
+	uint64_t size;
+
+	/** the modification time of the song file */
+	int64_t mtime;
+
+	/** the number of #SeekTableEntry records after the URI */
+	uint32_t n_frames;
+
+	uint32_t reserved;
+};
+
+/**
+ * One frame in a cached seek table: the byte offset of the frame and
+ * the play time at its beginning (the two halves of a #mad_timer_t).
+ */
+struct SeekTableEntry {
+	int64_t offset;
+	int64_t seconds;
+	uint64_t fraction;
+};
+
+gcc_pure
+static uint64_t
+SeekTableCacheHash(const char *uri) noexcept
+{
+	/* FNV-1a */
+	uint64_t h = 0xcbf29ce484222325;
+	while (*uri != 0) {
+		h ^= (unsigned char)*uri++;
+		h *= 0x100000001b3;
+	}
+
+	return h;
+}
+
+gcc_pure
+static AllocatedPath
+SeekTableCachePath(const char *uri) noexcept
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.mst",
+		 (unsigned long long)SeekTableCacheHash(uri));
+	return AllocatedPath::Build(seek_table_cache_dir, name);
+}
+
+/**
+ * Determine the modification time of a local song file, for
+ * validating a cached seek table.
+ *
+ * @return true on success
+ */
+static bool
+SeekTableCacheMtime(const char *uri, int64_t &mtime) noexcept
+{
+	try {
+		const FileInfo fi(AllocatedPath::FromUTF8Throw(uri));
+		mtime = std::chrono::system_clock::to_time_t(fi.GetModificationTime());
+		return true;
+	} catch (...) {
+		return false;
+	}
+}
+
 struct MadDecoder {
 	static constexpr size_t READ_BUFFER_SIZE = 40960;
 	static constexpr size_t MP3_DATA_OUTPUT_BUFFER_SIZE = 2048;
@@ -133,6 +226,14 @@ struct MadDecoder {
 	unsigned long highest_frame = 0;
 	unsigned long max_frames = 0;
 	unsigned long current_frame = 0;
+
+	/**
+	 * The number of frames which were loaded from the seek table
+	 * cache; the table is only written back when more frames have
+	 * been discovered.
+	 */
+	unsigned long cached_frames = 0;
+
 	unsigned int drop_start_frames = 0;
 	unsigned int drop_end_frames = 0;
 	unsigned int drop_start_samples = 0;
@@ -176,6 +277,25 @@ struct MadDecoder {
 		times = new mad_timer_t[max_frames];
 	}
 
+	/**
+	 * Attempt to load a cached seek table for this song.  On
+	 * success, #frame_offsets and #times are pre-filled, making
+	 * seeks to already-visited positions instant.
+	 */
+	void LoadSeekTable() noexcept;
+
+	/**
+	 * Store the seek table built during this decode, so the next
+	 * decode of this song does not have to scan for seeking.
+	 */
+	void SaveSeekTable() noexcept;
+
+	/**
+	 * Is the seek table cache applicable to this stream at all?
+	 */
+	gcc_pure
+	bool CheckSeekTableCache(const char *uri) const noexcept;
+
 	gcc_pure
 	long TimeToFrame(SongTime t) const noexcept;
 
@@ -831,6 +951,118 @@ MadDecoder::~MadDecoder()
 	delete[] times;
 }
 
+inline bool
+MadDecoder::CheckSeekTableCache(const char *uri) const noexcept
+{
+	/* only seekable local files are cached; remote streams have
+	   no modification time to validate the table against */
+	return !seek_table_cache_dir.IsNull() &&
+		input_stream.IsSeekable() && input_stream.KnownSize() &&
+		uri != nullptr && PathTraitsUTF8::IsAbsolute(uri);
+}
+
+void
+MadDecoder::LoadSeekTable() noexcept
+{
+	assert(frame_offsets != nullptr);
+	assert(highest_frame == 0);
+
+	const char *uri = input_stream.GetURI();
+	if (!CheckSeekTableCache(uri))
+		return;
+
+	int64_t mtime;
+	if (!SeekTableCacheMtime(uri, mtime))
+		return;
+
+	try {
+		FileReader file(SeekTableCachePath(uri));
+
+		SeekTableHeader header;
+		if (file.Read(&header, sizeof(header)) != sizeof(header) ||
+		    header.magic != SeekTableHeader::MAGIC ||
+		    header.uri_length != strlen(uri) ||
+		    header.size != input_stream.GetSize() ||
+		    header.mtime != mtime ||
+		    header.n_frames == 0 ||
+		    header.n_frames > max_frames)
+			/* stale or foreign cache file */
+			return;
+
+		/* compare the URI to defend against hash
+		   collisions */
+		char uri_buffer[MPD_PATH_MAX];
+		if (header.uri_length >= sizeof(uri_buffer) ||
+		    file.Read(uri_buffer, header.uri_length) != header.uri_length ||
+		    memcmp(uri_buffer, uri, header.uri_length) != 0)
+			return;
+
+		SeekTableEntry entries[256];
+		for (unsigned long i = 0; i < header.n_frames;) {
+			const size_t n = std::min(size_t(header.n_frames - i),
+						  sizeof(entries) / sizeof(entries[0]));
+			const size_t nbytes = n * sizeof(entries[0]);
+			if (file.Read(entries, nbytes) != nbytes)
+				/* truncated: discard the table */
+				return;
+
+			for (size_t j = 0; j < n; ++j, ++i) {
+				frame_offsets[i] = entries[j].offset;
+				times[i].seconds = entries[j].seconds;
+				times[i].fraction = entries[j].fraction;
+			}
+		}
+
+		highest_frame = cached_frames = header.n_frames;
+	} catch (...) {
+		/* no cache file for this song - that's ok */
+	}
+}
+
+void
+MadDecoder::SaveSeekTable() noexcept
+{
+	if (highest_frame <= cached_frames)
+		/* nothing new to store */
+		return;
+
+	const char *uri = input_stream.GetURI();
+	if (!CheckSeekTableCache(uri))
+		return;
+
+	int64_t mtime;
+	if (!SeekTableCacheMtime(uri, mtime))
+		return;
+
+	try {
+		FileOutputStream file(SeekTableCachePath(uri));
+		BufferedOutputStream bos(file);
+
+		SeekTableHeader header;
+		header.magic = SeekTableHeader::MAGIC;
+		header.uri_length = strlen(uri);
+		header.size = input_stream.GetSize();
+		header.mtime = mtime;
+		header.n_frames = highest_frame;
+		header.reserved = 0;
+		bos.Write(&header, sizeof(header));
+		bos.Write(uri, header.uri_length);
+
+		for (unsigned long i = 0; i < highest_frame; ++i) {
+			SeekTableEntry entry;
+			entry.offset = frame_offsets[i];
+			entry.seconds = times[i].seconds;
+			entry.fraction = times[i].fraction;
+			bos.Write(&entry, sizeof(entry));
+		}
+
+		bos.Flush();
+		file.Commit();
+	} catch (...) {
+		LogError(std::current_exception());
+	}
+}
+
 /* this is primarily used for getting total time for tags */
 static std::pair<bool, SignedSongTime>
 mad_decoder_total_file_time(InputStream &is)
@@ -858,11 +1090,13 @@ MadDecoder::TimeToFrame(SongTime t) const noexcept
 void
 MadDecoder::UpdateTimerNextFrame()
 {
+	/* this frame's header has just been decoded; with a (partly)
+	   cached seek table, this may be the first assignment */
+	bit_rate = frame.header.bitrate;
+
 	if (current_frame >= highest_frame) {
 		/* record this frame's properties in frame_offsets
 		   (for seeking) and times */
-		bit_rate = frame.header.bitrate;
-
 		if (current_frame >= max_frames)
 			/* cap current_frame */
 			current_frame = max_frames - 1;
@@ -1046,6 +1280,7 @@ mp3_decode(DecoderClient &client, InputStream &input_stream)
 	}
 
 	data.AllocateBuffers();
+	data.LoadSeekTable();
 
 	client.Ready(CheckAudioFormat(data.frame.header.samplerate,
 				      SampleFormat::S24_P32,
@@ -1059,6 +1294,8 @@ mp3_decode(DecoderClient &client, InputStream &input_stream)
 	}
 
 	while (data.Read()) {}
+
+	data.SaveSeekTable();
 }
 
 static bool
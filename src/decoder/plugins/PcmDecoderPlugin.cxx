@@ -159,35 +159,103 @@ pcm_stream_decode(DecoderClient &client, InputStream &is)
 	   results for a full source buffer */
 	int32_t unpack_buffer[buffer.GetCapacity() / 3];
 
+	/* audio/L24 expands each sample from 3 to 4 bytes and thus
+	   cannot be decoded into the destination buffer */
+	bool direct = !l24;
+
 	DecoderCommand cmd;
 	do {
-		if (!FillBuffer(client, is, buffer))
-			break;
-
-		auto r = buffer.Read();
-		/* round down to the nearest frame size, because we
-		   must not pass partial frames to
-		   DecoderClient::SubmitData() */
-		r.size -= r.size % in_frame_size;
-		buffer.Consume(r.size);
-
-		if (reverse_endian)
-			/* make sure we deliver samples in host byte order */
-			reverse_bytes_16((uint16_t *)r.data,
-					 (uint16_t *)r.data,
-					 (uint16_t *)(r.data + r.size));
-		else if (l24) {
-			/* convert big-endian packed 24 bit
-			   (audio/L24) to native-endian 24 bit (in 32
-			   bit integers) */
-			pcm_unpack_24be(unpack_buffer, r.begin(), r.end());
-			r.data = (uint8_t *)&unpack_buffer[0];
-			r.size = (r.size / 3) * 4;
+		if (direct) {
+			/* read directly into a MusicChunk, avoiding
+			   the copy through our FIFO buffer */
+			auto w = client.GetWriteBuffer(is, 0);
+			if (w.IsNull()) {
+				cmd = client.GetCommand();
+				if (cmd == DecoderCommand::NONE) {
+					/* no direct buffer available
+					   (the data needs to be
+					   converted): fall back to
+					   SubmitData() */
+					direct = false;
+					continue;
+				}
+			} else {
+				/* round down to the nearest frame
+				   size, because we must not commit
+				   partial frames */
+				w.size -= w.size % in_frame_size;
+
+				size_t nbytes = decoder_read(client, is,
+							     w.data, w.size);
+				if (nbytes == 0) {
+					if (is.LockIsEOF())
+						break;
+
+					cmd = client.GetCommand();
+				} else {
+					const size_t rest =
+						nbytes % in_frame_size;
+					if (rest != 0) {
+						/* the read has ended
+						   in the middle of a
+						   frame: complete
+						   it */
+						if (decoder_read_full(&client, is,
+								      (uint8_t *)w.data + nbytes,
+								      in_frame_size - rest))
+							nbytes += in_frame_size - rest;
+						else
+							/* discard the
+							   partial frame
+							   at the end of
+							   the stream */
+							nbytes -= rest;
+					}
+
+					if (reverse_endian)
+						/* make sure we deliver
+						   samples in host byte
+						   order */
+						reverse_bytes_16((uint16_t *)w.data,
+								 (uint16_t *)w.data,
+								 (uint16_t *)((uint8_t *)w.data + nbytes));
+
+					cmd = nbytes > 0
+						? client.CommitWriteBuffer(nbytes)
+						: client.GetCommand();
+				}
+			}
+		} else {
+			if (!FillBuffer(client, is, buffer))
+				break;
+
+			auto r = buffer.Read();
+			/* round down to the nearest frame size,
+			   because we must not pass partial frames to
+			   DecoderClient::SubmitData() */
+			r.size -= r.size % in_frame_size;
+			buffer.Consume(r.size);
+
+			if (reverse_endian)
+				/* make sure we deliver samples in
+				   host byte order */
+				reverse_bytes_16((uint16_t *)r.data,
+						 (uint16_t *)r.data,
+						 (uint16_t *)(r.data + r.size));
+			else if (l24) {
+				/* convert big-endian packed 24 bit
+				   (audio/L24) to native-endian 24 bit
+				   (in 32 bit integers) */
+				pcm_unpack_24be(unpack_buffer, r.begin(), r.end());
+				r.data = (uint8_t *)&unpack_buffer[0];
+				r.size = (r.size / 3) * 4;
+			}
+
+			cmd = !r.empty()
+				? client.SubmitData(is, r.data, r.size, 0)
+				: client.GetCommand();
 		}
 
-		cmd = !r.empty()
-			? client.SubmitData(is, r.data, r.size, 0)
-			: client.GetCommand();
 		if (cmd == DecoderCommand::SEEK) {
 			uint64_t frame = client.GetSeekFrame();
 			offset_type offset = frame * in_frame_size;
@@ -21,6 +21,7 @@
 #define MPD_ENCODER_INTERFACE_HXX
 
 #include "EncoderPlugin.hxx"
+#include "util/ConstBuffer.hxx"
 #include "Compiler.h"
 
 #include <assert.h>
@@ -107,6 +108,23 @@ public:
 	 * @return the number of bytes written to #dest
 	 */
 	virtual size_t Read(void *dest, size_t length) = 0;
+
+	/**
+	 * Reads encoded data from the encoder without copying, if
+	 * the encoder supports it (e.g. the PCM passthrough
+	 * encoders).  Call this repeatedly until nullptr is
+	 * returned, then fall back to Read().
+	 *
+	 * The returned span is only valid until the next call to
+	 * this encoder; it may point into the buffer most recently
+	 * passed to Write().
+	 *
+	 * @return a span of encoded data, or nullptr if nothing can
+	 * be returned without copying
+	 */
+	virtual ConstBuffer<void> ReadZeroCopy() noexcept {
+		return nullptr;
+	}
 };
 
 class PreparedEncoder {
@@ -26,6 +26,15 @@ void
 EncoderToOutputStream(OutputStream &os, Encoder &encoder)
 {
 	while (true) {
+		/* if the encoder can hand its output through without
+		   copying, write the span directly */
+
+		const auto span = encoder.ReadZeroCopy();
+		if (!span.IsNull()) {
+			os.Write(span.data, span.size);
+			continue;
+		}
+
 		/* read from the encoder */
 
 		char buffer[32768];
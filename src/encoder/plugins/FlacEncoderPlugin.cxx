@@ -32,6 +32,12 @@
 #error libFLAC is too old
 #endif
 
+#if FLAC_API_VERSION_CURRENT >= 14
+/* libFLAC supports multi-threaded encoding since 1.5.0 */
+#define HAVE_FLAC_ENCODER_THREADS
+#include <thread>
+#endif
+
 class FlacEncoder final : public Encoder {
 	const AudioFormat audio_format;
 
@@ -83,6 +89,13 @@ private:
 class PreparedFlacEncoder final : public PreparedEncoder {
 	const unsigned compression;
 
+	/**
+	 * The number of encoder worker threads, passed to
+	 * FLAC__stream_encoder_set_num_threads(); 0 means one per
+	 * CPU.
+	 */
+	const unsigned threads;
+
 public:
 	PreparedFlacEncoder(const ConfigBlock &block);
 
@@ -95,8 +108,13 @@ public:
 };
 
 PreparedFlacEncoder::PreparedFlacEncoder(const ConfigBlock &block)
-	:compression(block.GetBlockValue("compression", 5u))
+	:compression(block.GetBlockValue("compression", 5u)),
+	 threads(block.GetBlockValue("threads", 1u))
 {
+#ifndef HAVE_FLAC_ENCODER_THREADS
+	if (threads != 1)
+		throw std::runtime_error("The \"threads\" option requires libFLAC 1.5");
+#endif
 }
 
 static PreparedEncoder *
@@ -107,12 +125,25 @@ flac_encoder_init(const ConfigBlock &block)
 
 static void
 flac_encoder_setup(FLAC__StreamEncoder *fse, unsigned compression,
+		   unsigned threads,
 		   const AudioFormat &audio_format, unsigned bits_per_sample)
 {
 	if (!FLAC__stream_encoder_set_compression_level(fse, compression))
 		throw FormatRuntimeError("error setting flac compression to %d",
 					 compression);
 
+#ifdef HAVE_FLAC_ENCODER_THREADS
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+
+	if (threads > 1 &&
+	    FLAC__stream_encoder_set_num_threads(fse, threads) != FLAC__STREAM_ENCODER_SET_NUM_THREADS_OK)
+		throw FormatRuntimeError("error setting flac threads to %d",
+					 threads);
+#else
+	(void)threads;
+#endif
+
 	if (!FLAC__stream_encoder_set_channels(fse, audio_format.channels))
 		throw FormatRuntimeError("error setting flac channels num to %d",
 					 audio_format.channels);
@@ -175,7 +206,7 @@ PreparedFlacEncoder::Open(AudioFormat &audio_format)
 		throw std::runtime_error("FLAC__stream_encoder_new() failed");
 
 	try {
-		flac_encoder_setup(fse, compression,
+		flac_encoder_setup(fse, compression, threads,
 				   audio_format, bits_per_sample);
 	} catch (...) {
 		FLAC__stream_encoder_delete(fse);
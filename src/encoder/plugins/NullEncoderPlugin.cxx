@@ -20,12 +20,28 @@
 #include "config.h"
 #include "NullEncoderPlugin.hxx"
 #include "../EncoderAPI.hxx"
+#include "util/ConstBuffer.hxx"
 #include "util/DynamicFifoBuffer.hxx"
 #include "Compiler.h"
 
+#include <algorithm>
+
+#include <string.h>
+
 class NullEncoder final : public Encoder {
+	/**
+	 * Spill storage for the rare case in which Write() is called
+	 * again before #pending has been drained.
+	 */
 	DynamicFifoBuffer<uint8_t> buffer;
 
+	/**
+	 * The span most recently passed to Write(), borrowed from
+	 * the caller instead of copied; all callers drain the
+	 * encoder before they reuse the source buffer.
+	 */
+	ConstBuffer<uint8_t> pending = nullptr;
+
 public:
 	NullEncoder()
 		:Encoder(false),
@@ -33,11 +49,43 @@ public:
 
 	/* virtual methods from class Encoder */
 	void Write(const void *data, size_t length) override {
-		buffer.Append((const uint8_t *)data, length);
+		if (!pending.empty())
+			/* not yet drained: spill the old span, so its
+			   bytes are delivered first */
+			buffer.Append(pending.data, pending.size);
+
+		pending = {(const uint8_t *)data, length};
 	}
 
 	size_t Read(void *dest, size_t length) override {
-		return buffer.Read((uint8_t *)dest, length);
+		size_t nbytes = buffer.Read((uint8_t *)dest, length);
+
+		if (nbytes < length && !pending.empty()) {
+			const size_t n = std::min(length - nbytes,
+						  pending.size);
+			memcpy((uint8_t *)dest + nbytes, pending.data, n);
+			pending.skip_front(n);
+			nbytes += n;
+		}
+
+		return nbytes;
+	}
+
+	ConstBuffer<void> ReadZeroCopy() noexcept override {
+		const auto r = buffer.Read();
+		if (!r.empty()) {
+			/* the data stays in place until the next
+			   Append() */
+			buffer.Consume(r.size);
+			return {r.data, r.size};
+		}
+
+		if (pending.empty())
+			return nullptr;
+
+		const auto result = pending;
+		pending = nullptr;
+		return result.ToVoid();
 	}
 };
 
@@ -23,11 +23,16 @@
 #include "config.h"
 #include "../EncoderAPI.hxx"
 #include "lib/xiph/OggStreamState.hxx"
-#include "lib/xiph/OggPage.hxx"
 #include "lib/xiph/OggSerial.hxx"
+#include "util/DynamicFifoBuffer.hxx"
 
 #include <ogg/ogg.h>
 
+#include <algorithm>
+
+#include <string.h>
+#include <stdint.h>
+
 /**
  * An abstract base class which contains code common to all encoders
  * with Ogg container output.
@@ -37,6 +42,16 @@ class OggEncoder : public Encoder {
 	   headers on the first read */
 	bool flush = true;
 
+	/**
+	 * Assembles the current #ogg_page (header and body).  The
+	 * buffer belongs to the encoder instance and is reused for
+	 * all pages, so the steady-state read path does not
+	 * allocate; it also carries the remainder of a page which
+	 * was larger than the caller's buffer over to the next
+	 * Read() call, instead of discarding it.
+	 */
+	DynamicFifoBuffer<uint8_t> page_buffer{16384};
+
 protected:
 	OggStreamState stream;
 
@@ -52,19 +67,29 @@ public:
 	}
 
 	size_t Read(void *dest, size_t length) override {
-		ogg_page page;
-		bool success = stream.PageOut(page);
-		if (!success) {
-			if (flush) {
-				flush = false;
-				success = stream.Flush(page);
+		auto r = page_buffer.Read();
+		if (r.empty()) {
+			ogg_page page;
+			bool success = stream.PageOut(page);
+			if (!success) {
+				if (flush) {
+					flush = false;
+					success = stream.Flush(page);
+				}
+
+				if (!success)
+					return 0;
 			}
 
-			if (!success)
-				return 0;
+			page_buffer.Append(page.header, page.header_len);
+			page_buffer.Append(page.body, page.body_len);
+			r = page_buffer.Read();
 		}
 
-		return ReadPage(page, dest, length);
+		const size_t nbytes = std::min(length, size_t(r.size));
+		memcpy(dest, r.data, nbytes);
+		page_buffer.Consume(nbytes);
+		return nbytes;
 	}
 };
 
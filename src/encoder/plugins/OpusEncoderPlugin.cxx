@@ -36,11 +36,25 @@
 namespace {
 
 class OpusEncoder final : public OggEncoder {
+	/**
+	 * The number of Opus frames accumulated before the encoder
+	 * runs: input is gathered in one large buffer and encoded in
+	 * a batch, which reduces the per-Write() bookkeeping for
+	 * always-on streaming outputs.
+	 */
+	static constexpr size_t BATCH_FRAMES = 8;
+
 	const AudioFormat audio_format;
 
 	const size_t frame_size;
 
-	const size_t buffer_frames, buffer_size;
+	/**
+	 * The number of PCM frames in one Opus frame (20 ms), and
+	 * its size in bytes.
+	 */
+	const size_t buffer_frames, opus_frame_bytes;
+
+	const size_t buffer_size;
 	size_t buffer_position = 0;
 	uint8_t *const buffer;
 
@@ -65,6 +79,7 @@ public:
 	size_t Read(void *dest, size_t length) override;
 
 private:
+	void EncodeFrame(const uint8_t *src, bool eos);
 	void DoEncode(bool eos);
 	void WriteSilence(unsigned fill_frames);
 
@@ -129,7 +144,8 @@ OpusEncoder::OpusEncoder(AudioFormat &_audio_format, ::OpusEncoder *_enc)
 	 audio_format(_audio_format),
 	 frame_size(_audio_format.GetFrameSize()),
 	 buffer_frames(_audio_format.sample_rate / 50),
-	 buffer_size(frame_size * buffer_frames),
+	 opus_frame_bytes(frame_size * buffer_frames),
+	 buffer_size(opus_frame_bytes * BATCH_FRAMES),
 	 buffer((unsigned char *)xalloc(buffer_size)),
 	 enc(_enc)
 {
@@ -181,19 +197,17 @@ OpusEncoder::~OpusEncoder()
 }
 
 void
-OpusEncoder::DoEncode(bool eos)
+OpusEncoder::EncodeFrame(const uint8_t *src, bool eos)
 {
-	assert(buffer_position == buffer_size);
-
 	opus_int32 result =
 		audio_format.format == SampleFormat::S16
 		? opus_encode(enc,
-			      (const opus_int16 *)buffer,
+			      (const opus_int16 *)src,
 			      buffer_frames,
 			      buffer2,
 			      sizeof(buffer2))
 		: opus_encode_float(enc,
-				    (const float *)buffer,
+				    (const float *)src,
 				    buffer_frames,
 				    buffer2,
 				    sizeof(buffer2));
@@ -210,6 +224,19 @@ OpusEncoder::DoEncode(bool eos)
 	packet.granulepos = granulepos;
 	packet.packetno = packetno++;
 	stream.PacketIn(packet);
+}
+
+void
+OpusEncoder::DoEncode(bool eos)
+{
+	assert(eos || buffer_position == buffer_size);
+	assert(buffer_position % opus_frame_bytes == 0);
+
+	/* encode all complete Opus frames in the accumulation
+	   buffer in one batch */
+	for (size_t i = 0; i < buffer_position; i += opus_frame_bytes)
+		EncodeFrame(buffer + i,
+			    eos && i + opus_frame_bytes >= buffer_position);
 
 	buffer_position = 0;
 }
@@ -219,9 +246,16 @@ OpusEncoder::End()
 {
 	Flush();
 
-	memset(buffer + buffer_position, 0,
-	       buffer_size - buffer_position);
-	buffer_position = buffer_size;
+	/* round the remainder up to a whole Opus frame, padding
+	   with silence; if the buffer is empty, encode one whole
+	   silence frame to carry the end-of-stream flag */
+	size_t rounded = ((buffer_position + opus_frame_bytes - 1)
+			  / opus_frame_bytes) * opus_frame_bytes;
+	if (rounded == 0)
+		rounded = opus_frame_bytes;
+
+	memset(buffer + buffer_position, 0, rounded - buffer_position);
+	buffer_position = rounded;
 
 	DoEncode(true);
 }
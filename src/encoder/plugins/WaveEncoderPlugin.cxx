@@ -21,8 +21,11 @@
 #include "WaveEncoderPlugin.hxx"
 #include "../EncoderAPI.hxx"
 #include "system/ByteOrder.hxx"
+#include "util/ConstBuffer.hxx"
 #include "util/DynamicFifoBuffer.hxx"
 
+#include <algorithm>
+
 #include <assert.h>
 #include <string.h>
 
@@ -31,8 +34,27 @@ static constexpr uint16_t WAVE_FORMAT_PCM = 1;
 class WaveEncoder final : public Encoder {
 	unsigned bits;
 
+	/**
+	 * Do the samples need to be rewritten (byte-swapped or
+	 * 24-bit-packed) before they can be sent to the client?  If
+	 * not, Write() passes the caller's buffer through without
+	 * copying.
+	 */
+	bool processed;
+
+	/**
+	 * Holds the header, rewritten samples, and spilled spans if
+	 * Write() is called again before #pending has been drained.
+	 */
 	DynamicFifoBuffer<uint8_t> buffer;
 
+	/**
+	 * The span most recently passed to Write(), borrowed from
+	 * the caller instead of copied; all callers drain the
+	 * encoder before they reuse the source buffer.
+	 */
+	ConstBuffer<uint8_t> pending = nullptr;
+
 public:
 	WaveEncoder(AudioFormat &audio_format);
 
@@ -40,7 +62,34 @@ public:
 	void Write(const void *data, size_t length) override;
 
 	size_t Read(void *dest, size_t length) override {
-		return buffer.Read((uint8_t *)dest, length);
+		size_t nbytes = buffer.Read((uint8_t *)dest, length);
+
+		if (nbytes < length && !pending.empty()) {
+			const size_t n = std::min(length - nbytes,
+						  pending.size);
+			memcpy((uint8_t *)dest + nbytes, pending.data, n);
+			pending.skip_front(n);
+			nbytes += n;
+		}
+
+		return nbytes;
+	}
+
+	ConstBuffer<void> ReadZeroCopy() noexcept override {
+		const auto r = buffer.Read();
+		if (!r.empty()) {
+			/* the data stays in place until the next
+			   Append() */
+			buffer.Consume(r.size);
+			return {r.data, r.size};
+		}
+
+		if (pending.empty())
+			return nullptr;
+
+		const auto result = pending;
+		pending = nullptr;
+		return result.ToVoid();
 	}
 };
 
@@ -132,6 +181,10 @@ WaveEncoder::WaveEncoder(AudioFormat &audio_format)
 		break;
 	}
 
+	/* on little-endian machines, only 24 bit samples need to be
+	   repacked; everything else is passed through */
+	processed = IsLittleEndian() ? bits == 24 : bits != 8;
+
 	auto range = buffer.Write();
 	assert(range.size >= sizeof(WaveHeader));
 	auto *header = (WaveHeader *)range.data;
@@ -189,6 +242,18 @@ pcm24_to_wave(uint8_t *dst8, const uint32_t *src32, size_t length)
 void
 WaveEncoder::Write(const void *src, size_t length)
 {
+	if (!processed) {
+		/* the samples are already in wire format: pass the
+		   caller's buffer through without copying */
+		if (!pending.empty())
+			/* not yet drained: spill the old span, so
+			   its bytes are delivered first */
+			buffer.Append(pending.data, pending.size);
+
+		pending = {(const uint8_t *)src, length};
+		return;
+	}
+
 	uint8_t *dst = buffer.Write(length);
 
 	if (IsLittleEndian()) {
@@ -20,11 +20,20 @@
 #include "config.h"
 #include "FullyBufferedSocket.hxx"
 #include "net/SocketError.hxx"
+#include "util/WritableBuffer.hxx"
 #include "Compiler.h"
 
+#include <algorithm>
+
 #include <assert.h>
 #include <string.h>
 
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
+
+#ifdef _WIN32
+
 FullyBufferedSocket::ssize_t
 FullyBufferedSocket::DirectWrite(const void *data, size_t length) noexcept
 {
@@ -46,11 +55,40 @@ FullyBufferedSocket::DirectWrite(const void *data, size_t length) noexcept
 	return nbytes;
 }
 
+#else
+
+FullyBufferedSocket::ssize_t
+FullyBufferedSocket::DirectWriteV(const struct iovec *v, size_t n,
+				  bool more) noexcept
+{
+	const auto nbytes = GetSocket().WriteV(v, n, more);
+	if (gcc_unlikely(nbytes < 0)) {
+		const auto code = GetSocketError();
+		if (IsSocketErrorAgain(code))
+			return 0;
+
+		IdleMonitor::Cancel();
+		BufferedSocket::Cancel();
+
+		if (IsSocketErrorClosed(code))
+			OnSocketClosed();
+		else
+			OnSocketError(std::make_exception_ptr(MakeSocketError(code, "Failed to send to socket")));
+	}
+
+	return nbytes;
+}
+
+#endif
+
 bool
-FullyBufferedSocket::Flush() noexcept
+FullyBufferedSocket::Flush(bool more) noexcept
 {
 	assert(IsDefined());
 
+#ifdef _WIN32
+	(void)more;
+
 	const auto data = output.Read();
 	if (data.empty()) {
 		IdleMonitor::Cancel();
@@ -63,6 +101,34 @@ FullyBufferedSocket::Flush() noexcept
 		return nbytes == 0;
 
 	output.Consume(nbytes);
+#else
+	/* send both internal buffers of the #PeakBuffer with one
+	   system call */
+
+	WritableBuffer<void> v[2];
+	const unsigned n = output.Read2(v);
+	if (n == 0) {
+		IdleMonitor::Cancel();
+		CancelWrite();
+		return true;
+	}
+
+	struct iovec iov[2];
+	for (unsigned i = 0; i < n; ++i) {
+		iov[i].iov_base = v[i].data;
+		iov[i].iov_len = v[i].size;
+	}
+
+	auto nbytes = DirectWriteV(iov, n, more);
+	if (gcc_unlikely(nbytes <= 0))
+		return nbytes == 0;
+
+	for (unsigned i = 0; nbytes > 0 && i < n; ++i) {
+		const size_t consume = std::min(size_t(nbytes), v[i].size);
+		output.Consume(consume);
+		nbytes -= consume;
+	}
+#endif
 
 	if (output.empty()) {
 		IdleMonitor::Cancel();
@@ -87,6 +153,26 @@ FullyBufferedSocket::Write(const void *data, size_t length) noexcept
 		return false;
 	}
 
+	if (output.GetSize() >= flush_watermark) {
+		/* while a command handler runs, the EventLoop is
+		   stalled and cannot invoke OnIdle(); without this
+		   direct flush, a large response would be buffered
+		   completely before the first byte is sent; the
+		   command handler will append more data, so let the
+		   kernel hold back partial packets */
+		if (!Flush(true))
+			return false;
+
+		if (!output.empty()) {
+			/* the socket did not accept everything; let
+			   the EventLoop deliver the rest */
+			IdleMonitor::Cancel();
+			ScheduleWrite();
+		}
+
+		return true;
+	}
+
 	if (was_empty)
 		IdleMonitor::Schedule();
 	return true;
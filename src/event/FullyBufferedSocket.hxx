@@ -25,36 +25,63 @@
 #include "IdleMonitor.hxx"
 #include "util/PeakBuffer.hxx"
 
+struct iovec;
+
 /**
  * A #BufferedSocket specialization that adds an output buffer.
  */
 class FullyBufferedSocket : protected BufferedSocket, private IdleMonitor {
 	PeakBuffer output;
 
+	/**
+	 * When the output buffer grows beyond this number of bytes,
+	 * Write() attempts to flush directly to the socket instead of
+	 * waiting for the #IdleMonitor.  This keeps memory usage
+	 * bounded during long-running commands which generate a large
+	 * response without returning to the #EventLoop.
+	 */
+	const size_t flush_watermark;
+
 public:
 	FullyBufferedSocket(SocketDescriptor _fd, EventLoop &_loop,
 			    size_t normal_size, size_t peak_size=0) noexcept
 		:BufferedSocket(_fd, _loop), IdleMonitor(_loop),
-		 output(normal_size, peak_size) {
+		 output(normal_size, peak_size),
+		 flush_watermark(normal_size) {
 	}
 
 	using BufferedSocket::IsDefined;
 
+	/**
+	 * Returns the number of bytes currently stored in the output
+	 * buffer, for memory telemetry.
+	 */
+	size_t GetOutputBufferSize() const noexcept {
+		return output.GetSize();
+	}
+
 	void Close() noexcept {
 		IdleMonitor::Cancel();
 		BufferedSocket::Close();
 	}
 
 private:
+#ifdef _WIN32
 	ssize_t DirectWrite(const void *data, size_t length) noexcept;
+#else
+	ssize_t DirectWriteV(const struct iovec *v, size_t n,
+			     bool more) noexcept;
+#endif
 
 protected:
 	/**
 	 * Send data from the output buffer to the socket.
 	 *
+	 * @param more true if the caller will generate more data
+	 * soon (a hint for the kernel's packetization)
 	 * @return false if the socket has been closed
 	 */
-	bool Flush() noexcept;
+	bool Flush(bool more=false) noexcept;
 
 	/**
 	 * @return false if the socket has been closed
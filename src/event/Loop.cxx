@@ -22,7 +22,12 @@
 #include "SocketMonitor.hxx"
 #include "IdleMonitor.hxx"
 #include "DeferEvent.hxx"
+#include "PerfStats.hxx"
 #include "util/ScopeExit.hxx"
+#include "util/Domain.hxx"
+#include "Log.hxx"
+
+static constexpr Domain event_domain("event");
 
 EventLoop::EventLoop(ThreadId _thread)
 	:SocketMonitor(*this), thread(_thread)
@@ -86,7 +91,21 @@ EventLoop::AddTimer(TimerEvent &t, std::chrono::steady_clock::duration d)
 {
 	assert(IsInside());
 
-	t.due = now + d;
+	t.deadline = now + d;
+
+	if (t.timer_set_hook.is_linked()) {
+		if (t.deadline >= t.due)
+			/* postponed: the set position remains valid,
+			   and Run() will reinsert the timer when the
+			   old deadline has passed; this makes
+			   re-arming an active timeout (e.g. client
+			   expiry on every command) cheap */
+			return;
+
+		timers.erase(timers.iterator_to(t));
+	}
+
+	t.due = t.deadline;
 	timers.insert(t);
 	again = true;
 }
@@ -99,6 +118,31 @@ EventLoop::CancelTimer(TimerEvent &t)
 	timers.erase(timers.iterator_to(t));
 }
 
+void
+EventLoop::FinishHandlerTiming(std::chrono::steady_clock::time_point start,
+			       const char *type, const void *handler,
+			       int socket_fd) noexcept
+{
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+
+	if (handler_histogram != nullptr)
+		handler_histogram->Record(elapsed);
+
+	if (elapsed > handler_budget) {
+		const unsigned long elapsed_ms = (unsigned long)
+			std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+
+		if (socket_fd >= 0)
+			FormatWarning(event_domain,
+				      "%s handler %p (fd %d) blocked the event loop for %lums",
+				      type, handler, socket_fd, elapsed_ms);
+		else
+			FormatWarning(event_domain,
+				      "%s handler %p blocked the event loop for %lums",
+				      type, handler, elapsed_ms);
+	}
+}
+
 /**
  * Convert the given timeout specification to a milliseconds integer,
  * to be used by functions like poll() and epoll_wait().  Any negative
@@ -108,7 +152,12 @@ static constexpr int
 ExportTimeoutMS(std::chrono::steady_clock::duration timeout)
 {
 	return timeout >= timeout.zero()
-		? int(std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count())
+		/* round up: waking up slightly late is cheaper than
+		   waking up too early and polling again with a zero
+		   timeout until the timer is finally due; this also
+		   coalesces timers due within the same millisecond
+		   into one wakeup */
+		? int(std::chrono::duration_cast<std::chrono::milliseconds>(timeout + std::chrono::microseconds(999)).count())
 		: -1;
 }
 
@@ -146,7 +195,21 @@ EventLoop::Run()
 
 			timers.erase(i);
 
-			t.Run();
+			if (t.deadline > now) {
+				/* the deadline was postponed lazily
+				   by AddTimer(); move the timer to
+				   its real position */
+				t.due = t.deadline;
+				timers.insert(t);
+				continue;
+			}
+
+			if (HasHandlerBudget()) {
+				const auto start = std::chrono::steady_clock::now();
+				t.Run();
+				FinishHandlerTiming(start, "timer", &t);
+			} else
+				t.Run();
 
 			if (quit)
 				return;
@@ -157,7 +220,13 @@ EventLoop::Run()
 		while (!idle.empty()) {
 			IdleMonitor &m = idle.front();
 			idle.pop_front();
-			m.Run();
+
+			if (HasHandlerBudget()) {
+				const auto start = std::chrono::steady_clock::now();
+				m.Run();
+				FinishHandlerTiming(start, "idle", &m);
+			} else
+				m.Run();
 
 			if (quit)
 				return;
@@ -196,7 +265,15 @@ EventLoop::Run()
 					break;
 
 				auto m = (SocketMonitor *)poll_result.GetObject(i);
-				m->Dispatch(events);
+
+				if (HasHandlerBudget()) {
+					const int socket_fd = m->GetSocket().Get();
+					const auto start = std::chrono::steady_clock::now();
+					m->Dispatch(events);
+					FinishHandlerTiming(start, "socket",
+							    m, socket_fd);
+				} else
+					m->Dispatch(events);
 			}
 		}
 
@@ -251,7 +328,13 @@ EventLoop::HandleDeferred()
 		deferred.pop_front();
 
 		const ScopeUnlock unlock(mutex);
-		m.RunDeferred();
+
+		if (HasHandlerBudget()) {
+			const auto start = std::chrono::steady_clock::now();
+			m.RunDeferred();
+			FinishHandlerTiming(start, "deferred", &m);
+		} else
+			m.RunDeferred();
 	}
 }
 
@@ -39,6 +39,8 @@
 
 #include <assert.h>
 
+class PerfLatencyHistogram;
+
 /**
  * An event loop that polls for events on file/socket descriptors.
  *
@@ -101,6 +103,22 @@ class EventLoop final : SocketMonitor
 	 */
 	bool busy = true;
 
+	/**
+	 * When positive, each handler invocation is timed, and one
+	 * which blocks the loop for longer than this budget is
+	 * logged.
+	 *
+	 * @see SetHandlerBudget()
+	 */
+	std::chrono::steady_clock::duration handler_budget =
+		std::chrono::steady_clock::duration::zero();
+
+	/**
+	 * An optional histogram which receives the duration of each
+	 * handler invocation while #handler_budget is enabled.
+	 */
+	PerfLatencyHistogram *handler_histogram = nullptr;
+
 	PollGroup poll_group;
 	PollResult poll_result;
 
@@ -174,6 +192,22 @@ public:
 	 */
 	void RemoveDeferred(DeferEvent &d) noexcept;
 
+	/**
+	 * Enable the handler watchdog: every callback dispatched by
+	 * this loop is timed, the duration is recorded in the given
+	 * histogram (if any), and a handler which blocks the loop for
+	 * longer than the given budget is logged with its type and
+	 * identity.  This turns multi-hundred-millisecond command
+	 * responses into an attributable log message.
+	 *
+	 * This method is not thread-safe; call it before Run().
+	 */
+	void SetHandlerBudget(std::chrono::steady_clock::duration budget,
+			      PerfLatencyHistogram *histogram=nullptr) noexcept {
+		handler_budget = budget;
+		handler_histogram = histogram;
+	}
+
 	/**
 	 * The main function of this class.  It will loop until
 	 * Break() gets called.  Can be called only once.
@@ -181,6 +215,22 @@ public:
 	void Run();
 
 private:
+	bool HasHandlerBudget() const noexcept {
+		return handler_budget > std::chrono::steady_clock::duration::zero();
+	}
+
+	/**
+	 * Finish timing one handler invocation: record the duration
+	 * in the histogram and log the handler when it has exceeded
+	 * the budget.
+	 *
+	 * @param socket_fd the file descriptor the handler was
+	 * dispatched for, or -1
+	 */
+	void FinishHandlerTiming(std::chrono::steady_clock::time_point start,
+				 const char *type, const void *handler,
+				 int socket_fd=-1) noexcept;
+
 	/**
 	 * Invoke all pending DeferEvents.
 	 *
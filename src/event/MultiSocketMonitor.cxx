@@ -53,9 +53,37 @@ MultiSocketMonitor::ClearSocketList() noexcept
 
 #ifndef _WIN32
 
+inline bool
+MultiSocketMonitor::SameSocketList(const pollfd *pfds,
+				   unsigned n) const noexcept
+{
+	const pollfd *const end = pfds + n;
+	unsigned found = 0;
+
+	for (const auto &i : fds) {
+		const int fd = i.GetSocket().Get();
+		auto p = std::find_if(pfds, end,
+				      [fd](const struct pollfd &pfd){
+					      return pfd.fd == fd;
+				      });
+		if (p == end || unsigned(p->events) != i.GetEvents())
+			return false;
+
+		++found;
+	}
+
+	return found == n;
+}
+
 void
 MultiSocketMonitor::ReplaceSocketList(pollfd *pfds, unsigned n) noexcept
 {
+	/* fast path: in steady state, the descriptors and their
+	   events are the same in every cycle, and all registrations
+	   can be kept as they are */
+	if (SameSocketList(pfds, n))
+		return;
+
 	pollfd *const end = pfds + n;
 
 	UpdateSocketList([pfds, end](SocketDescriptor fd) -> unsigned {
@@ -192,6 +192,16 @@ public:
 	 * May only be called from PrepareSockets().
 	 */
 	void ReplaceSocketList(pollfd *pfds, unsigned n) noexcept;
+
+private:
+	/**
+	 * Does the given pollfd array describe exactly the sockets
+	 * which are currently being monitored?
+	 */
+	gcc_pure
+	bool SameSocketList(const pollfd *pfds, unsigned n) const noexcept;
+
+public:
 #endif
 
 protected:
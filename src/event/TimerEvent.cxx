@@ -31,7 +31,5 @@ TimerEvent::Cancel() noexcept
 void
 TimerEvent::Schedule(std::chrono::steady_clock::duration d) noexcept
 {
-	Cancel();
-
 	loop.AddTimer(*this, d);
 }
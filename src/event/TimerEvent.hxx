@@ -49,11 +49,21 @@ class TimerEvent final {
 	const Callback callback;
 
 	/**
-	 * When is this timer due?  This is only valid if IsActive()
+	 * When is this timer due?  This is the sorting key inside
+	 * the #EventLoop's timer set, and is only valid if IsActive()
 	 * returns true.
 	 */
 	std::chrono::steady_clock::time_point due;
 
+	/**
+	 * The current deadline.  It may be later than #due if
+	 * Schedule() has postponed an already-scheduled timer: in
+	 * that case, the set position is left untouched, and the
+	 * #EventLoop reinserts the timer when #due has passed,
+	 * instead of reordering the set on every Schedule() call.
+	 */
+	std::chrono::steady_clock::time_point deadline;
+
 public:
 	TimerEvent(EventLoop &_loop, Callback _callback) noexcept
 		:loop(_loop), callback(_callback) {
@@ -26,12 +26,13 @@
 #define MPD_FILTER_INTERNAL_HXX
 
 #include "AudioFormat.hxx"
+#include "util/ConstBuffer.hxx"
+#include "util/WritableBuffer.hxx"
 
 #include <assert.h>
 #include <stddef.h>
 
 struct AudioFormat;
-template<typename T> struct ConstBuffer;
 
 class Filter {
 protected:
@@ -69,6 +70,32 @@ public:
 	 * or Reset() call)
 	 */
 	virtual ConstBuffer<void> FilterPCM(ConstBuffer<void> src) = 0;
+
+	/**
+	 * Like FilterPCM(), but the input buffer is writable: the
+	 * filter may overwrite it instead of copying into an internal
+	 * buffer, fusing its pass with the previous one as far as
+	 * memory traffic is concerned.  The default implementation
+	 * falls back to FilterPCM().
+	 *
+	 * Throws std::runtime_error on error.
+	 */
+	virtual ConstBuffer<void> FilterInPlace(WritableBuffer<void> src) {
+		return FilterPCM({src.data, src.size});
+	}
+
+	/**
+	 * Flush pending data and return it.  This should be called
+	 * after the last FilterPCM() call, e.g. while the output
+	 * device is being drained.
+	 *
+	 * Throws std::runtime_error on error.
+	 *
+	 * @return the remaining data (nullptr if there is none)
+	 */
+	virtual ConstBuffer<void> Flush() {
+		return nullptr;
+	}
 };
 
 class PreparedFilter {
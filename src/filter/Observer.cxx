@@ -76,6 +76,14 @@ public:
 	ConstBuffer<void> FilterPCM(ConstBuffer<void> src) override {
 		return filter->FilterPCM(src);
 	}
+
+	ConstBuffer<void> FilterInPlace(WritableBuffer<void> src) override {
+		return filter->FilterInPlace(src);
+	}
+
+	ConstBuffer<void> Flush() override {
+		return filter->Flush();
+	}
 };
 
 Filter *
@@ -56,6 +56,7 @@ public:
 	}
 
 	ConstBuffer<void> FilterPCM(ConstBuffer<void> src) override;
+	ConstBuffer<void> FilterInPlace(WritableBuffer<void> src) override;
 };
 
 class PreparedAutoConvertFilter final : public PreparedFilter {
@@ -106,6 +107,18 @@ AutoConvertFilter::FilterPCM(ConstBuffer<void> src)
 	return filter->FilterPCM(src);
 }
 
+ConstBuffer<void>
+AutoConvertFilter::FilterInPlace(WritableBuffer<void> src)
+{
+	if (convert != nullptr) {
+		auto data = convert->FilterInPlace(src);
+		return filter->FilterInPlace({const_cast<void *>(data.data),
+					      data.size});
+	}
+
+	return filter->FilterInPlace(src);
+}
+
 PreparedFilter *
 autoconvert_filter_new(PreparedFilter *filter)
 {
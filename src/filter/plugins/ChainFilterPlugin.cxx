@@ -64,6 +64,12 @@ public:
 	/* virtual methods from class Filter */
 	void Reset() override;
 	ConstBuffer<void> FilterPCM(ConstBuffer<void> src) override;
+	ConstBuffer<void> FilterInPlace(WritableBuffer<void> src) override;
+	ConstBuffer<void> Flush() override;
+
+private:
+	ConstBuffer<void> ApplyFilterChain(ConstBuffer<void> src,
+					   bool writable);
 };
 
 class PreparedChainFilter final : public PreparedFilter {
@@ -139,18 +145,59 @@ ChainFilter::Reset()
 }
 
 ConstBuffer<void>
-ChainFilter::FilterPCM(ConstBuffer<void> src)
+ChainFilter::ApplyFilterChain(ConstBuffer<void> src, bool writable)
 {
 	for (auto &child : children) {
 		/* feed the output of the previous filter as input
 		   into the current one */
-		src = child.filter->FilterPCM(src);
+		const auto dest = writable
+			? child.filter->FilterInPlace({const_cast<void *>(src.data),
+						       src.size})
+			: child.filter->FilterPCM(src);
+
+		if (dest.data != src.data)
+			/* the filter returned its own buffer, which
+			   the next one may overwrite; filters which
+			   do not modify the data pass the input
+			   through unchanged */
+			writable = true;
+
+		src = dest;
 	}
 
 	/* return the output of the last filter */
 	return src;
 }
 
+ConstBuffer<void>
+ChainFilter::FilterPCM(ConstBuffer<void> src)
+{
+	return ApplyFilterChain(src, false);
+}
+
+ConstBuffer<void>
+ChainFilter::FilterInPlace(WritableBuffer<void> src)
+{
+	return ApplyFilterChain({src.data, src.size}, true);
+}
+
+ConstBuffer<void>
+ChainFilter::Flush()
+{
+	for (auto i = children.begin(), end = children.end(); i != end; ++i) {
+		auto data = i->filter->Flush();
+		if (!data.IsNull()) {
+			/* pass it through the remaining filters */
+			for (auto k = std::next(i); k != end; ++k)
+				data = k->filter->FilterPCM(data);
+
+			return data;
+		}
+	}
+
+	return nullptr;
+}
+
 const FilterPlugin chain_filter_plugin = {
 	"chain",
 	chain_filter_init,
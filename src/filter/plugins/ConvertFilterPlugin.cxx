@@ -57,6 +57,24 @@ public:
 	}
 
 	ConstBuffer<void> FilterPCM(ConstBuffer<void> src) override;
+
+	ConstBuffer<void> FilterInPlace(WritableBuffer<void> src) override {
+		assert(in_audio_format.IsValid());
+
+		if (out_audio_format == in_audio_format)
+			/* optimized special case: no-op */
+			return { src.data, src.size };
+
+		return state.Convert(src);
+	}
+
+	ConstBuffer<void> Flush() override {
+		if (out_audio_format == in_audio_format)
+			/* optimized special case: no-op */
+			return nullptr;
+
+		return state.Flush();
+	}
 };
 
 class PreparedConvertFilter final : public PreparedFilter {
@@ -45,6 +45,7 @@ public:
 
 	/* virtual methods from class Filter */
 	ConstBuffer<void> FilterPCM(ConstBuffer<void> src) override;
+	ConstBuffer<void> FilterInPlace(WritableBuffer<void> src) override;
 };
 
 class PreparedNormalizeFilter final : public PreparedFilter {
@@ -62,7 +63,11 @@ normalize_filter_init(gcc_unused const ConfigBlock &block)
 Filter *
 PreparedNormalizeFilter::Open(AudioFormat &audio_format)
 {
-	audio_format.format = SampleFormat::S16;
+	/* the compressor code has a native float implementation;
+	   convert everything but S16 to float instead of degrading it
+	   to S16 */
+	if (audio_format.format != SampleFormat::S16)
+		audio_format.format = SampleFormat::FLOAT;
 
 	return new NormalizeFilter(audio_format);
 }
@@ -70,11 +75,23 @@ PreparedNormalizeFilter::Open(AudioFormat &audio_format)
 ConstBuffer<void>
 NormalizeFilter::FilterPCM(ConstBuffer<void> src)
 {
-	int16_t *dest = (int16_t *)buffer.Get(src.size);
+	void *dest = buffer.Get(src.size);
 	memcpy(dest, src.data, src.size);
 
-	Compressor_Process_int16(compressor, dest, src.size / 2);
-	return { (const void *)dest, src.size };
+	return FilterInPlace({dest, src.size});
+}
+
+ConstBuffer<void>
+NormalizeFilter::FilterInPlace(WritableBuffer<void> src)
+{
+	if (GetOutAudioFormat().format == SampleFormat::FLOAT)
+		Compressor_Process_float(compressor, (float *)src.data,
+					 src.size / 4);
+	else
+		Compressor_Process_int16(compressor, (int16_t *)src.data,
+					 src.size / 2);
+
+	return { src.data, src.size };
 }
 
 const FilterPlugin normalize_filter_plugin = {
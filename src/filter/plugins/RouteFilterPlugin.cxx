@@ -222,50 +222,97 @@ PreparedRouteFilter::Open(AudioFormat &audio_format)
 	return new RouteFilter(audio_format, min_output_channels, sources);
 }
 
+/**
+ * Copy one channel from a strided source to a strided destination.
+ * The strides are in samples, not in bytes.
+ */
+template<typename T>
+static void
+CopyChannel(T *gcc_restrict dest, unsigned dest_step,
+	    const T *gcc_restrict src, unsigned src_step,
+	    size_t number_of_frames) noexcept
+{
+	for (size_t i = 0; i < number_of_frames; ++i)
+		dest[i * dest_step] = src[i * src_step];
+}
+
+/**
+ * Fill one strided channel of the destination with the given silence
+ * sample.  The stride is in samples, not in bytes.
+ */
+template<typename T>
+static void
+FillChannel(T *dest, unsigned dest_step, T silence,
+	    size_t number_of_frames) noexcept
+{
+	for (size_t i = 0; i < number_of_frames; ++i)
+		dest[i * dest_step] = silence;
+}
+
+template<typename T>
+static void
+RouteChannels(T *dest, unsigned n_dest_channels,
+	      const T *src, unsigned n_src_channels,
+	      const std::array<int8_t, MAX_CHANNELS> &sources,
+	      SampleFormat format,
+	      size_t number_of_frames) noexcept
+{
+	// The format-specific silence pattern, one sample wide
+	T silence;
+	PcmSilence({&silence, sizeof(silence)}, format);
+
+	for (unsigned c = 0; c < n_dest_channels; ++c) {
+		if (sources[c] == -1 ||
+		    (unsigned)sources[c] >= n_src_channels)
+			// No source for this destination output,
+			// give it zeroes as input
+			FillChannel(dest + c, n_dest_channels, silence,
+				    number_of_frames);
+		else
+			// Get the data from channel sources[c]
+			// and copy it to the output
+			CopyChannel(dest + c, n_dest_channels,
+				    src + sources[c], n_src_channels,
+				    number_of_frames);
+	}
+}
+
 ConstBuffer<void>
 RouteFilter::FilterPCM(ConstBuffer<void> src)
 {
 	size_t number_of_frames = src.size / input_frame_size;
 
-	const size_t bytes_per_frame_per_channel = input_format.GetSampleSize();
-
-	// A moving pointer that always refers to channel 0 in the input, at the currently handled frame
-	const uint8_t *base_source = (const uint8_t *)src.data;
-
 	// Grow our reusable buffer, if needed, and set the moving pointer
 	const size_t result_size = number_of_frames * output_frame_size;
 	void *const result = output_buffer.Get(result_size);
 
-	// A moving pointer that always refers to the currently filled channel of the currently handled frame, in the output
-	uint8_t *chan_destination = (uint8_t *)result;
-
-	// Perform our copy operations, with N input channels and M output channels
-	for (unsigned int s=0; s<number_of_frames; ++s) {
-
-		// Need to perform one copy per output channel
-		for (unsigned c = 0; c < out_audio_format.channels; ++c) {
-			if (sources[c] == -1 ||
-			    (unsigned)sources[c] >= input_format.channels) {
-				// No source for this destination output,
-				// give it zeroes as input
-				PcmSilence({chan_destination, bytes_per_frame_per_channel},
-					   input_format.format);
-			} else {
-				// Get the data from channel sources[c]
-				// and copy it to the output
-				const uint8_t *data = base_source +
-					(sources[c] * bytes_per_frame_per_channel);
-				memcpy(chan_destination,
-					  data,
-					  bytes_per_frame_per_channel);
-			}
-			// Move on to the next output channel
-			chan_destination += bytes_per_frame_per_channel;
-		}
-
-
-		// Go on to the next N input samples
-		base_source += input_frame_size;
+	// Perform one strided pass per output channel instead of one
+	// tiny memcpy per frame and channel; the fixed-size
+	// assignment loops below get vectorized by the compiler
+	switch (input_format.GetSampleSize()) {
+	case 1:
+		RouteChannels((uint8_t *)result, out_audio_format.channels,
+			      (const uint8_t *)src.data, input_format.channels,
+			      sources, input_format.format,
+			      number_of_frames);
+		break;
+
+	case 2:
+		RouteChannels((uint16_t *)result, out_audio_format.channels,
+			      (const uint16_t *)src.data, input_format.channels,
+			      sources, input_format.format,
+			      number_of_frames);
+		break;
+
+	case 4:
+		RouteChannels((uint32_t *)result, out_audio_format.channels,
+			      (const uint32_t *)src.data, input_format.channels,
+			      sources, input_format.format,
+			      number_of_frames);
+		break;
+
+	default:
+		gcc_unreachable();
 	}
 
 	// Here it is, ladies and gentlemen! Rerouted data!
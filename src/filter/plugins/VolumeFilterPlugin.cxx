@@ -47,6 +47,7 @@ public:
 
 	/* virtual methods from class Filter */
 	ConstBuffer<void> FilterPCM(ConstBuffer<void> src) override;
+	ConstBuffer<void> FilterInPlace(WritableBuffer<void> src) override;
 };
 
 class PreparedVolumeFilter final : public PreparedFilter {
@@ -73,6 +74,13 @@ VolumeFilter::FilterPCM(ConstBuffer<void> src)
 	return pv.Apply(src);
 }
 
+ConstBuffer<void>
+VolumeFilter::FilterInPlace(WritableBuffer<void> src)
+{
+	const auto dest = pv.ApplyInPlace(src);
+	return { dest.data, dest.size };
+}
+
 const FilterPlugin volume_filter_plugin = {
 	"volume",
 	volume_filter_init,
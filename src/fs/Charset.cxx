@@ -23,6 +23,8 @@
 #include "Log.hxx"
 #include "lib/icu/Converter.hxx"
 #include "util/AllocatedString.hxx"
+#include "util/CharUtil.hxx"
+#include "thread/Mutex.hxx"
 
 #ifdef _WIN32
 #include "lib/icu/Win32.hxx"
@@ -30,7 +32,10 @@
 #endif
 
 #include <algorithm>
+#include <list>
+#include <map>
 #include <stdexcept>
+#include <utility>
 
 #include <assert.h>
 #include <string.h>
@@ -41,6 +46,81 @@ static std::string fs_charset;
 
 static IcuConverter *fs_converter;
 
+/**
+ * Is this string plain ASCII?  Then it is the same in every
+ * (ASCII-compatible) filesystem charset, and the converter can be
+ * bypassed entirely.
+ */
+gcc_pure
+static bool
+IsPureASCII(const char *p) noexcept
+{
+	for (; *p != 0; ++p)
+		if (!IsASCII(*p))
+			return false;
+
+	return true;
+}
+
+/**
+ * A thread-safe LRU cache for charset conversion results.  Paths
+ * (especially directories) cross the converter over and over during
+ * an update, and the conversion result never changes while the
+ * converter exists.
+ */
+class PathConversionCache {
+	static constexpr size_t MAX_SIZE = 512;
+
+	Mutex mutex;
+
+	/**
+	 * All cached conversions, most recently used first.
+	 */
+	std::list<std::pair<std::string, std::string>> items;
+
+	std::map<std::string, decltype(items)::iterator> index;
+
+public:
+	bool Get(const char *src, std::string &result) noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+
+		auto i = index.find(src);
+		if (i == index.end())
+			return false;
+
+		items.splice(items.begin(), items, i->second);
+		result = i->second->second;
+		return true;
+	}
+
+	void Put(const char *src, std::string value) noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+
+		auto i = index.find(src);
+		if (i != index.end()) {
+			items.splice(items.begin(), items, i->second);
+			return;
+		}
+
+		while (items.size() >= MAX_SIZE) {
+			index.erase(items.back().first);
+			items.pop_back();
+		}
+
+		items.emplace_front(src, std::move(value));
+		index.emplace(items.front().first, items.begin());
+	}
+
+	void Clear() noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+
+		items.clear();
+		index.clear();
+	}
+};
+
+static PathConversionCache to_utf8_cache, from_utf8_cache;
+
 void
 SetFSCharset(const char *charset)
 {
@@ -60,6 +140,9 @@ void
 DeinitFSCharset() noexcept
 {
 #ifdef HAVE_ICU_CONVERTER
+	to_utf8_cache.Clear();
+	from_utf8_cache.Clear();
+
 	delete fs_converter;
 	fs_converter = nullptr;
 #endif
@@ -110,8 +193,17 @@ PathToUTF8(PathTraitsFS::const_pointer_type path_fs)
 		return FixSeparators(path_fs);
 #ifdef HAVE_FS_CHARSET
 
+	if (IsPureASCII(path_fs))
+		return FixSeparators(path_fs);
+
+	PathTraitsUTF8::string result;
+	if (to_utf8_cache.Get(path_fs, result))
+		return FixSeparators(std::move(result));
+
 	const auto buffer = fs_converter->ToUTF8(path_fs);
-	return FixSeparators(PathTraitsUTF8::string(buffer.c_str()));
+	result = buffer.c_str();
+	to_utf8_cache.Put(path_fs, result);
+	return FixSeparators(std::move(result));
 #endif
 #endif
 }
@@ -133,8 +225,17 @@ PathFromUTF8(PathTraitsUTF8::const_pointer_type path_utf8)
 	if (fs_converter == nullptr)
 		return path_utf8;
 
+	if (IsPureASCII(path_utf8))
+		return path_utf8;
+
+	PathTraitsFS::string result;
+	if (from_utf8_cache.Get(path_utf8, result))
+		return result;
+
 	const auto buffer = fs_converter->FromUTF8(path_utf8);
-	return PathTraitsFS::string(buffer.c_str());
+	result = buffer.c_str();
+	from_utf8_cache.Put(path_utf8, result);
+	return result;
 #endif
 }
 
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_LINE_READER_HXX
+#define MPD_LINE_READER_HXX
+
+#include "check.h"
+
+/**
+ * An interface for reading a text file line by line.  The line is
+ * writable, and the callee may modify it in place (e.g. to tokenize
+ * it).
+ */
+class LineReader {
+public:
+	/**
+	 * Reads a line, and strips the trailing newline (and carriage
+	 * return).  The returned string is writable and remains valid
+	 * until the next call.
+	 *
+	 * @return a pointer to the line, or nullptr on end-of-file
+	 */
+	virtual char *ReadLine() = 0;
+};
+
+#endif
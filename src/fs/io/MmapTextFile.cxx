@@ -0,0 +1,112 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "MmapTextFile.hxx"
+#include "FileReader.hxx"
+#include "fs/Path.hxx"
+
+#include <stdexcept>
+
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+MmapTextFile::MmapTextFile(Path path_fs)
+{
+	FileReader file(path_fs);
+	size = file.GetSize();
+
+	if (size > 0) {
+#ifndef _WIN32
+		/* map the file copy-on-write; this way, lines can be
+		   null-terminated in place without modifying the file
+		   and without copying the data */
+		void *p = mmap(nullptr, size, PROT_READ|PROT_WRITE,
+			       MAP_PRIVATE, file.GetFD().Get(), 0);
+		if (p != MAP_FAILED) {
+			madvise(p, size, MADV_SEQUENTIAL);
+			/* start asynchronous read-ahead of the whole
+			   file now, so parsing overlaps with the disk
+			   instead of stalling on each page fault */
+			madvise(p, size, MADV_WILLNEED);
+			data = (char *)p;
+			mapped = true;
+		}
+#endif
+
+		if (!mapped) {
+			/* fall back to reading the whole file into a
+			   heap buffer */
+			data = new char[size];
+			size = file.Read(data, size);
+		}
+	}
+
+	cursor = data;
+	end = data + size;
+
+	if (size >= 2 && data[0] == 0x1f && (unsigned char)data[1] == 0x8b)
+		/* this is a gzip header; let the caller retry with
+		   #TextFile, which can decompress it */
+		throw std::runtime_error("File is gzip-compressed");
+}
+
+MmapTextFile::~MmapTextFile() noexcept
+{
+#ifndef _WIN32
+	if (mapped) {
+		munmap(data, size);
+		return;
+	}
+#endif
+
+	delete[] data;
+}
+
+char *
+MmapTextFile::ReadLine()
+{
+	if (cursor >= end)
+		return nullptr;
+
+	char *line = cursor;
+	char *newline = (char *)memchr(line, '\n', end - line);
+	if (newline == nullptr) {
+		/* the last line is not newline-terminated; the
+		   mapping may stop exactly at a page boundary, so
+		   copy the line to get room for the null
+		   terminator */
+		tail.assign(line, end - line);
+		if (!tail.empty() && tail.back() == '\r')
+			tail.pop_back();
+
+		cursor = end;
+		return &tail[0];
+	}
+
+	cursor = newline + 1;
+
+	if (newline > line && newline[-1] == '\r')
+		--newline;
+	*newline = 0;
+	return line;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_MMAP_TEXT_FILE_HXX
+#define MPD_MMAP_TEXT_FILE_HXX
+
+#include "check.h"
+#include "LineReader.hxx"
+
+#include <string>
+
+#include <stddef.h>
+
+class Path;
+
+/**
+ * A #LineReader implementation which maps the whole file into memory
+ * and parses it in place, without any copying or per-line heap
+ * allocations.  The file is mapped privately, so lines can be
+ * null-terminated right inside the mapping.
+ *
+ * Unlike #TextFile, this class cannot read gzip-compressed files; the
+ * constructor throws if it finds a gzip header, and the caller is
+ * expected to fall back to #TextFile.
+ */
+class MmapTextFile final : public LineReader {
+	char *data = nullptr;
+	size_t size = 0;
+
+	char *cursor, *end;
+
+	/**
+	 * Was the file really mapped?  If not, #data is a heap
+	 * buffer.
+	 */
+	bool mapped = false;
+
+	/**
+	 * A copy of the last line if it is not newline-terminated,
+	 * because then there may be no room in the mapping for the
+	 * null terminator.
+	 */
+	std::string tail;
+
+public:
+	/**
+	 * Throws on error.
+	 */
+	explicit MmapTextFile(Path path_fs);
+
+	MmapTextFile(const MmapTextFile &other) = delete;
+
+	~MmapTextFile() noexcept;
+
+	/* virtual methods from class LineReader */
+	char *ReadLine() override;
+};
+
+#endif
@@ -0,0 +1,254 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "ParallelGzipOutputStream.hxx"
+#include "lib/zlib/Error.hxx"
+#include "util/ScopeExit.hxx"
+
+#include <algorithm>
+#include <thread>
+
+#include <assert.h>
+
+ParallelGzipOutputStream::ParallelGzipOutputStream(OutputStream &_next)
+	:next(_next)
+{
+	/* the fixed gzip header: deflate compression, no flags, no
+	   modification time, unknown OS */
+	static constexpr Bytef header[] = {
+		0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 0xff,
+	};
+
+	next.Write(header, sizeof(header));
+
+	unsigned n_threads = std::thread::hardware_concurrency();
+	if (n_threads < 1)
+		n_threads = 1;
+
+	for (unsigned i = 0; i < n_threads; ++i) {
+		threads.emplace_front(BIND_THIS_METHOD(Run));
+
+		try {
+			threads.front().Start();
+		} catch (...) {
+			threads.pop_front();
+			if (threads.empty())
+				/* not even one worker: we can't
+				   compress anything */
+				throw;
+
+			/* fewer workers, but still operational */
+			break;
+		}
+	}
+}
+
+ParallelGzipOutputStream::~ParallelGzipOutputStream() noexcept
+{
+	mutex.lock();
+	stop = true;
+	cond.broadcast();
+	mutex.unlock();
+
+	for (auto &thread : threads)
+		thread.Join();
+}
+
+/**
+ * Compress one block with an independent raw deflate stream.  All but
+ * the last block end with a full flush, which both aligns the output
+ * to a byte boundary and resets the dictionary; this is what makes
+ * the blocks independent of each other.
+ *
+ * Throws #ZlibError on error.
+ */
+void
+ParallelGzipOutputStream::DeflateJob(Job &job)
+{
+	z_stream z;
+	z.zalloc = Z_NULL;
+	z.zfree = Z_NULL;
+	z.opaque = Z_NULL;
+
+	constexpr int raw_deflate = -15;
+
+	int result = deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+				  raw_deflate, 8, Z_DEFAULT_STRATEGY);
+	if (result != Z_OK)
+		throw ZlibError(result);
+
+	AtScopeExit(&z) { deflateEnd(&z); };
+
+	/* deflateBound() is for a whole stream; add a bit of slack
+	   for the full-flush marker */
+	job.output.resize(deflateBound(&z, job.input.size()) + 16);
+
+	/* zlib's API requires a non-const input pointer */
+	z.next_in = const_cast<Bytef *>(job.input.data());
+	z.avail_in = job.input.size();
+	z.next_out = job.output.data();
+	z.avail_out = job.output.size();
+
+	result = deflate(&z, job.last ? Z_FINISH : Z_FULL_FLUSH);
+	if (job.last ? result != Z_STREAM_END : result != Z_OK)
+		throw ZlibError(result);
+
+	job.output.resize(job.output.size() - z.avail_out);
+	job.crc = crc32(crc32(0L, Z_NULL, 0),
+			job.input.data(), job.input.size());
+}
+
+inline void
+ParallelGzipOutputStream::Run() noexcept
+{
+	mutex.lock();
+
+	while (true) {
+		Job *job = nullptr;
+		for (auto &i : jobs)
+			if (i.state == Job::State::PENDING) {
+				job = &i;
+				break;
+			}
+
+		if (job == nullptr) {
+			if (stop)
+				break;
+
+			cond.wait(mutex);
+			continue;
+		}
+
+		job->state = Job::State::RUNNING;
+		mutex.unlock();
+
+		std::exception_ptr e;
+		try {
+			DeflateJob(*job);
+		} catch (...) {
+			e = std::current_exception();
+		}
+
+		mutex.lock();
+		if (e && !error)
+			error = e;
+		job->state = Job::State::DONE;
+
+		/* wake up the producer (and idle workers) */
+		cond.broadcast();
+	}
+
+	mutex.unlock();
+}
+
+void
+ParallelGzipOutputStream::WriteCompleted()
+{
+	while (!jobs.empty() &&
+	       jobs.front().state == Job::State::DONE) {
+		Job job = std::move(jobs.front());
+		jobs.pop_front();
+
+		mutex.unlock();
+		crc = crc32_combine(crc, job.crc, job.input.size());
+		next.Write(job.output.data(), job.output.size());
+		mutex.lock();
+	}
+}
+
+void
+ParallelGzipOutputStream::SubmitBlock(bool last)
+{
+	total_size += block.size();
+
+	mutex.lock();
+
+	jobs.emplace_back();
+	jobs.back().input = std::move(block);
+	jobs.back().last = last;
+	block.clear();
+
+	cond.broadcast();
+
+	/* opportunistically flush finished blocks, so memory usage
+	   stays bounded while the workers keep running */
+	WriteCompleted();
+
+	if (error) {
+		std::exception_ptr e = error;
+		mutex.unlock();
+		std::rethrow_exception(e);
+	}
+
+	mutex.unlock();
+}
+
+void
+ParallelGzipOutputStream::Write(const void *_data, size_t size)
+{
+	const Bytef *data = (const Bytef *)_data;
+
+	while (size > 0) {
+		size_t n = std::min(size, BLOCK_SIZE - block.size());
+		block.insert(block.end(), data, data + n);
+		data += n;
+		size -= n;
+
+		if (block.size() == BLOCK_SIZE)
+			SubmitBlock(false);
+	}
+}
+
+void
+ParallelGzipOutputStream::Flush()
+{
+	/* submit the remainder; even if it is empty, the final job is
+	   needed to terminate the deflate stream */
+	SubmitBlock(true);
+
+	mutex.lock();
+	while (true) {
+		WriteCompleted();
+
+		if (error) {
+			std::exception_ptr e = error;
+			mutex.unlock();
+			std::rethrow_exception(e);
+		}
+
+		if (jobs.empty())
+			break;
+
+		cond.wait(mutex);
+	}
+	mutex.unlock();
+
+	/* the gzip trailer: CRC32 and uncompressed size, both
+	   little-endian (RFC 1952) */
+	const uLong isize = total_size & 0xffffffff;
+	const Bytef trailer[8] = {
+		Bytef(crc), Bytef(crc >> 8),
+		Bytef(crc >> 16), Bytef(crc >> 24),
+		Bytef(isize), Bytef(isize >> 8),
+		Bytef(isize >> 16), Bytef(isize >> 24),
+	};
+
+	next.Write(trailer, sizeof(trailer));
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_PARALLEL_GZIP_OUTPUT_STREAM_HXX
+#define MPD_PARALLEL_GZIP_OUTPUT_STREAM_HXX
+
+#include "check.h"
+#include "OutputStream.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+#include "thread/Thread.hxx"
+
+#include <zlib.h>
+
+#include <exception>
+#include <forward_list>
+#include <list>
+#include <vector>
+
+#include <stdint.h>
+
+/**
+ * Like #GzipOutputStream, but compresses blocks of input on several
+ * worker threads (in the style of pigz).  Each block is deflated
+ * independently and terminated with a full flush, so the
+ * concatenation is one plain "gzip" stream which any standard reader
+ * can decompress.
+ *
+ * Don't forget to call Flush() before destructing this object.
+ */
+class ParallelGzipOutputStream final : public OutputStream {
+	/**
+	 * The uncompressed size of one work unit.  Large enough to
+	 * keep the full-flush overhead and the dictionary resets
+	 * negligible, small enough to give all workers something to
+	 * do.
+	 */
+	static constexpr size_t BLOCK_SIZE = 256 * 1024;
+
+	struct Job {
+		std::vector<Bytef> input;
+		std::vector<Bytef> output;
+
+		/**
+		 * The CRC32 of #input, filled by the worker.
+		 */
+		uLong crc = 0;
+
+		enum class State : uint8_t {
+			PENDING, RUNNING, DONE,
+		} state = State::PENDING;
+
+		/**
+		 * Is this the final block which terminates the
+		 * deflate stream?
+		 */
+		bool last = false;
+	};
+
+	OutputStream &next;
+
+	Mutex mutex;
+	Cond cond;
+
+	/**
+	 * Jobs in submission order.  Workers pick the first PENDING
+	 * one; the producer pops DONE jobs off the front and writes
+	 * them to #next.
+	 */
+	std::list<Job> jobs;
+
+	/**
+	 * The first error thrown by a worker, rethrown to the
+	 * producer.
+	 */
+	std::exception_ptr error;
+
+	std::forward_list<Thread> threads;
+
+	/**
+	 * The input block currently being filled by Write().
+	 */
+	std::vector<Bytef> block;
+
+	/**
+	 * The CRC32 of all data written so far, combined from the
+	 * per-block values in order.
+	 */
+	uLong crc = 0;
+
+	/**
+	 * The total uncompressed size (modulo 2**32, as mandated by
+	 * RFC 1952).
+	 */
+	uLong total_size = 0;
+
+	bool stop = false;
+
+public:
+	/**
+	 * Construct the filter and start the worker threads.
+	 */
+	explicit ParallelGzipOutputStream(OutputStream &_next);
+	~ParallelGzipOutputStream() noexcept;
+
+	/**
+	 * Finish the file: compress the remaining input, wait for all
+	 * workers, and write the gzip trailer.
+	 */
+	void Flush();
+
+	/* virtual methods from class OutputStream */
+	void Write(const void *data, size_t size) override;
+
+private:
+	static void DeflateJob(Job &job);
+
+	void SubmitBlock(bool last);
+
+	/**
+	 * Write all completed jobs at the front of the queue to
+	 * #next.  Caller must lock #mutex, which is released while
+	 * writing.
+	 */
+	void WriteCompleted();
+
+	void Run() noexcept;
+};
+
+#endif
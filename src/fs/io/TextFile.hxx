@@ -22,13 +22,14 @@
 
 #include "check.h"
 #include "Compiler.h"
+#include "LineReader.hxx"
 
 class Path;
 class FileReader;
 class AutoGunzipReader;
 class BufferedReader;
 
-class TextFile {
+class TextFile final : public LineReader {
 	FileReader *const file_reader;
 
 #ifdef ENABLE_ZLIB
@@ -51,7 +52,7 @@ public:
 	 *
 	 * @return a pointer to the line, or nullptr on end-of-file
 	 */
-	char *ReadLine();
+	char *ReadLine() override;
 };
 
 #endif
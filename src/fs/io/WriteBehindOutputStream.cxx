@@ -0,0 +1,110 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "WriteBehindOutputStream.hxx"
+
+WriteBehindOutputStream::WriteBehindOutputStream(OutputStream &_next)
+	:next(_next), thread(BIND_THIS_METHOD(Run))
+{
+	thread.Start();
+}
+
+WriteBehindOutputStream::~WriteBehindOutputStream() noexcept
+{
+	mutex.lock();
+	stop = true;
+	cond.broadcast();
+	mutex.unlock();
+
+	thread.Join();
+}
+
+void
+WriteBehindOutputStream::Run() noexcept
+{
+	mutex.lock();
+
+	while (true) {
+		if (!chunks.empty() && !error) {
+			auto chunk = std::move(chunks.front());
+			chunks.pop_front();
+			busy = true;
+			mutex.unlock();
+
+			std::exception_ptr e;
+			try {
+				next.Write(chunk.data(), chunk.size());
+			} catch (...) {
+				e = std::current_exception();
+			}
+
+			mutex.lock();
+			busy = false;
+			dirty -= chunk.size();
+			if (e)
+				error = e;
+			cond.broadcast();
+		} else if (stop) {
+			break;
+		} else {
+			cond.wait(mutex);
+		}
+	}
+
+	mutex.unlock();
+}
+
+void
+WriteBehindOutputStream::Write(const void *_data, size_t size)
+{
+	const uint8_t *data = (const uint8_t *)_data;
+
+	mutex.lock();
+
+	while (dirty >= MAX_DIRTY && !error)
+		cond.wait(mutex);
+
+	if (error) {
+		std::exception_ptr e = error;
+		mutex.unlock();
+		std::rethrow_exception(e);
+	}
+
+	chunks.emplace_back(data, data + size);
+	dirty += size;
+	cond.broadcast();
+
+	mutex.unlock();
+}
+
+void
+WriteBehindOutputStream::Flush()
+{
+	mutex.lock();
+
+	while ((!chunks.empty() || busy) && !error)
+		cond.wait(mutex);
+
+	std::exception_ptr e = error;
+	mutex.unlock();
+
+	if (e)
+		std::rethrow_exception(e);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_WRITE_BEHIND_OUTPUT_STREAM_HXX
+#define MPD_WRITE_BEHIND_OUTPUT_STREAM_HXX
+
+#include "check.h"
+#include "OutputStream.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+#include "thread/Thread.hxx"
+
+#include <exception>
+#include <list>
+#include <vector>
+
+#include <stdint.h>
+
+/**
+ * A filter which copies all written data into a bounded dirty buffer
+ * and forwards it to the next #OutputStream on a background thread,
+ * so the caller does not stall on disk latency.  Write() blocks only
+ * when the dirty buffer is full.
+ *
+ * Call Flush() to wait for all data to be written (and to rethrow
+ * errors from the background thread) before finishing the underlying
+ * stream.
+ */
+class WriteBehindOutputStream final : public OutputStream {
+	/**
+	 * The maximum amount of data queued for the background
+	 * thread; beyond this, Write() blocks, to keep memory usage
+	 * bounded when the disk cannot keep up.
+	 */
+	static constexpr size_t MAX_DIRTY = 1024 * 1024;
+
+	OutputStream &next;
+
+	Mutex mutex;
+	Cond cond;
+
+	/**
+	 * Chunks which have not yet been forwarded to #next.
+	 */
+	std::list<std::vector<uint8_t>> chunks;
+
+	/**
+	 * The total size of #chunks plus the chunk currently being
+	 * written by the thread.
+	 */
+	size_t dirty = 0;
+
+	/**
+	 * An error thrown by the background thread, rethrown to the
+	 * caller.
+	 */
+	std::exception_ptr error;
+
+	/**
+	 * Is the thread currently writing a chunk to #next?
+	 */
+	bool busy = false;
+
+	bool stop = false;
+
+	Thread thread;
+
+public:
+	/**
+	 * Construct the filter and start the background thread.
+	 */
+	explicit WriteBehindOutputStream(OutputStream &_next);
+	~WriteBehindOutputStream() noexcept;
+
+	/**
+	 * Wait for the background thread to catch up.
+	 *
+	 * Throws an error thrown by the background thread.
+	 */
+	void Flush();
+
+	/* virtual methods from class OutputStream */
+	void Write(const void *data, size_t size) override;
+
+private:
+	void Run() noexcept;
+};
+
+#endif
@@ -23,6 +23,7 @@
 #include "tag/Tag.hxx"
 #include "thread/Cond.hxx"
 #include "event/Loop.hxx"
+#include "Log.hxx"
 
 #include <stdexcept>
 
@@ -45,6 +46,14 @@ AsyncInputStream::AsyncInputStream(EventLoop &event_loop, const char *_url,
 
 AsyncInputStream::~AsyncInputStream()
 {
+	if (pause_count > 0 || starved_for > std::chrono::milliseconds(0)) {
+		const auto starved_ms = std::chrono::duration_cast<std::chrono::milliseconds>(starved_for).count();
+		FormatDebug(input_domain,
+			    "closing %s: paused %u times, client starved for %lums",
+			    GetURI(), pause_count,
+			    (unsigned long)starved_ms);
+	}
+
 	buffer.Clear();
 }
 
@@ -65,6 +74,9 @@ AsyncInputStream::Pause() noexcept
 {
 	assert(GetEventLoop().IsInside());
 
+	if (!paused)
+		++pause_count;
+
 	paused = true;
 }
 
@@ -175,7 +187,7 @@ AsyncInputStream::Read(void *ptr, size_t read_size)
 	assert(!GetEventLoop().IsInside());
 
 	/* wait for data */
-	CircularBuffer<uint8_t>::Range r;
+	SpscCircularBuffer<uint8_t>::Range r;
 	while (true) {
 		Check();
 
@@ -183,12 +195,22 @@ AsyncInputStream::Read(void *ptr, size_t read_size)
 		if (!r.empty() || IsEOF())
 			break;
 
+		const auto wait_start = std::chrono::steady_clock::now();
 		cond.wait(mutex);
+		starved_for += std::chrono::steady_clock::now() - wait_start;
 	}
 
 	const size_t nbytes = std::min(read_size, r.size);
-	memcpy(ptr, r.data, nbytes);
-	buffer.Consume(nbytes);
+
+	{
+		/* the buffer is single-producer/single-consumer, and
+		   the I/O thread never touches the range we are
+		   reading from; unlocking here lets it refill the
+		   buffer while we copy */
+		const ScopeUnlock unlock(mutex);
+		memcpy(ptr, r.data, nbytes);
+		buffer.Consume(nbytes);
+	}
 
 	offset += (offset_type)nbytes;
 
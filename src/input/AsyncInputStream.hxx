@@ -23,8 +23,9 @@
 #include "InputStream.hxx"
 #include "event/DeferEvent.hxx"
 #include "util/HugeAllocator.hxx"
-#include "util/CircularBuffer.hxx"
+#include "util/SpscCircularBuffer.hxx"
 
+#include <chrono>
 #include <exception>
 
 /**
@@ -43,9 +44,28 @@ class AsyncInputStream : public InputStream {
 
 	HugeArray<uint8_t> allocation;
 
-	CircularBuffer<uint8_t> buffer;
+	/**
+	 * The ring buffer filled by the I/O thread and consumed by
+	 * the client thread.  Being single-producer/single-consumer,
+	 * it can be used from both sides without holding the mutex.
+	 */
+	SpscCircularBuffer<uint8_t> buffer;
 	const size_t resume_at;
 
+	/**
+	 * The number of times the stream was paused because the
+	 * buffer was full.  Logged on close to help with tuning the
+	 * buffer size and the resume threshold.
+	 */
+	unsigned pause_count = 0;
+
+	/**
+	 * The total time the client has spent waiting for data in
+	 * Read() while the buffer was empty.  Logged on close.
+	 */
+	std::chrono::steady_clock::duration starved_for =
+		std::chrono::steady_clock::duration::zero();
+
 	bool open = true;
 
 	/**
@@ -126,7 +146,7 @@ protected:
 		return buffer.GetSpace();
 	}
 
-	CircularBuffer<uint8_t>::Range PrepareWriteBuffer() noexcept {
+	SpscCircularBuffer<uint8_t>::Range PrepareWriteBuffer() noexcept {
 		return buffer.Write();
 	}
 
@@ -0,0 +1,250 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "BufferingInputStream.hxx"
+#include "tag/Tag.hxx"
+#include "thread/Cond.hxx"
+#include "thread/Name.hxx"
+
+#include <algorithm>
+
+#include <assert.h>
+#include <string.h>
+
+size_t input_buffer_size;
+
+BufferingInputStream::BufferingInputStream(InputStreamPtr _input,
+					   size_t _buffer_size)
+	:InputStream(_input->GetURI(), _input->mutex, _input->cond),
+	 input(std::move(_input)),
+	 thread(BIND_THIS_METHOD(ThreadFunc)),
+	 allocation(_buffer_size),
+	 buffer(&allocation.front(), allocation.size())
+{
+	allocation.ForkCow(false);
+
+	thread.Start();
+}
+
+BufferingInputStream::~BufferingInputStream()
+{
+	{
+		const std::lock_guard<Mutex> lock(mutex);
+		close = true;
+		cond.broadcast();
+	}
+
+	thread.Join();
+}
+
+void
+BufferingInputStream::ThreadFunc()
+{
+	SetThreadName("input_buffer");
+
+	const std::lock_guard<Mutex> lock(mutex);
+
+	try {
+		input->WaitReady();
+		input->Check();
+	} catch (...) {
+		postponed_exception = std::current_exception();
+		SetReady();
+		return;
+	}
+
+	/* copy attributes from the wrapped stream */
+	seekable = input->IsSeekable();
+	if (input->KnownSize())
+		size = input->GetSize();
+	if (input->HasMimeType())
+		SetMimeType(input->GetMimeType());
+
+	/* we're ready, tell it to our client */
+	SetReady();
+
+	while (!close) {
+		assert(!postponed_exception);
+
+		if (seek_pending) {
+			buffer.Clear();
+			input_eof = false;
+
+			try {
+				input->Seek(seek_offset);
+			} catch (...) {
+				postponed_exception = std::current_exception();
+				seek_pending = false;
+				cond.broadcast();
+				return;
+			}
+
+			seek_pending = false;
+			cond.broadcast();
+			continue;
+		}
+
+		auto w = buffer.Write();
+		if (!w.empty() && !input_eof && input->IsAvailable()) {
+			size_t nbytes;
+
+			try {
+				nbytes = input->Read(w.data, w.size);
+			} catch (...) {
+				postponed_exception = std::current_exception();
+				cond.broadcast();
+				return;
+			}
+
+			if (nbytes == 0) {
+				input_eof = true;
+				cond.broadcast();
+				continue;
+			}
+
+			buffer.Append(nbytes);
+			cond.broadcast();
+		} else
+			/* buffer full, end-of-file or no data
+			   available yet; wait until the client
+			   consumes data, the wrapped stream produces
+			   some or a seek/close request arrives */
+			cond.wait(mutex);
+	}
+}
+
+void
+BufferingInputStream::Check()
+{
+	assert(!thread.IsInside());
+
+	if (postponed_exception)
+		std::rethrow_exception(postponed_exception);
+
+	input->Check();
+}
+
+void
+BufferingInputStream::Update()
+{
+	input->Update();
+}
+
+void
+BufferingInputStream::Seek(offset_type new_offset)
+{
+	assert(!thread.IsInside());
+
+	if (new_offset == offset)
+		return;
+
+	if (new_offset > offset) {
+		/* if the data between the current position and the
+		   new one has already been buffered, consume it
+		   instead of seeking the wrapped stream */
+		offset_type remaining = new_offset - offset;
+
+		while (remaining > 0) {
+			const auto r = buffer.Read();
+			if (r.empty())
+				break;
+
+			size_t nbytes = std::min<offset_type>(remaining,
+							      r.size);
+			buffer.Consume(nbytes);
+			remaining -= nbytes;
+		}
+
+		if (remaining == 0) {
+			offset = new_offset;
+			cond.broadcast();
+			return;
+		}
+	}
+
+	seek_offset = new_offset;
+	seek_pending = true;
+	cond.broadcast();
+
+	while (seek_pending && !postponed_exception)
+		cond.wait(mutex);
+
+	if (postponed_exception)
+		std::rethrow_exception(postponed_exception);
+
+	offset = new_offset;
+}
+
+bool
+BufferingInputStream::IsEOF() noexcept
+{
+	assert(!thread.IsInside());
+
+	return input_eof && buffer.empty();
+}
+
+std::unique_ptr<Tag>
+BufferingInputStream::ReadTag()
+{
+	return input->ReadTag();
+}
+
+bool
+BufferingInputStream::IsAvailable() noexcept
+{
+	assert(!thread.IsInside());
+
+	return !buffer.empty() || input_eof || postponed_exception;
+}
+
+size_t
+BufferingInputStream::Read(void *ptr, size_t read_size)
+{
+	assert(!thread.IsInside());
+
+	while (true) {
+		if (postponed_exception)
+			std::rethrow_exception(postponed_exception);
+
+		const auto r = buffer.Read();
+		if (!r.empty()) {
+			size_t nbytes = std::min(read_size, r.size);
+			memcpy(ptr, r.data, nbytes);
+			buffer.Consume(nbytes);
+			cond.broadcast();
+			offset += nbytes;
+			return nbytes;
+		}
+
+		if (input_eof)
+			return 0;
+
+		cond.wait(mutex);
+	}
+}
+
+InputStream *
+input_buffering_open(InputStream *is, size_t buffer_size)
+{
+	assert(is != nullptr);
+	assert(buffer_size > 0);
+
+	return new BufferingInputStream(InputStreamPtr(is), buffer_size);
+}
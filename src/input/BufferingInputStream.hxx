@@ -0,0 +1,108 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_BUFFERING_INPUT_STREAM_HXX
+#define MPD_BUFFERING_INPUT_STREAM_HXX
+
+#include "check.h"
+#include "InputStream.hxx"
+#include "Ptr.hxx"
+#include "thread/Thread.hxx"
+#include "util/HugeAllocator.hxx"
+#include "util/CircularBuffer.hxx"
+
+#include <exception>
+
+#include <stdint.h>
+
+/**
+ * An #InputStream which reads ahead from another #InputStream in a
+ * dedicated thread, decoupling the (synchronous, possibly slow)
+ * backend from the decoder thread.  As long as the ring buffer is not
+ * empty, the decoder never blocks on the network.
+ *
+ * Unlike #ThreadInputStream, this class wraps an already existing
+ * stream and supports seeking and tags by forwarding them to the
+ * wrapped stream.
+ */
+class BufferingInputStream final : public InputStream {
+	InputStreamPtr input;
+
+	Thread thread;
+
+	std::exception_ptr postponed_exception;
+
+	HugeArray<uint8_t> allocation;
+
+	CircularBuffer<uint8_t> buffer;
+
+	/**
+	 * Shall the stream be closed?
+	 */
+	bool close = false;
+
+	/**
+	 * Has the end of the wrapped stream been seen by the thread?
+	 */
+	bool input_eof = false;
+
+	/**
+	 * Is there a seek request which the thread has not yet
+	 * carried out?
+	 */
+	bool seek_pending = false;
+
+	offset_type seek_offset;
+
+public:
+	/**
+	 * @param _input the stream to be wrapped; it does not need to
+	 * be "ready" yet
+	 */
+	BufferingInputStream(InputStreamPtr _input, size_t _buffer_size);
+
+	virtual ~BufferingInputStream();
+
+	/* virtual methods from InputStream */
+	void Check() override;
+	void Update() override;
+	void Seek(offset_type new_offset) override;
+	bool IsEOF() noexcept override;
+	std::unique_ptr<Tag> ReadTag() override;
+	bool IsAvailable() noexcept override;
+	size_t Read(void *ptr, size_t size) override;
+
+private:
+	void ThreadFunc();
+};
+
+/**
+ * The configured read-ahead buffer size in bytes; zero means
+ * buffering is disabled.  Set by input_stream_global_init().
+ */
+extern size_t input_buffer_size;
+
+/**
+ * Wraps the given #InputStream in a #BufferingInputStream.
+ */
+gcc_nonnull_all
+InputStream *
+input_buffering_open(InputStream *is, size_t buffer_size);
+
+#endif
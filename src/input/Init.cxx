@@ -21,6 +21,7 @@
 #include "Init.hxx"
 #include "Registry.hxx"
 #include "InputPlugin.hxx"
+#include "BufferingInputStream.hxx"
 #include "config/ConfigGlobal.hxx"
 #include "config/ConfigOption.hxx"
 #include "config/Block.hxx"
@@ -37,6 +38,10 @@ input_stream_global_init(EventLoop &event_loop)
 {
 	const ConfigBlock empty;
 
+	input_buffer_size = (size_t)
+		config_get_positive(ConfigOption::INPUT_BUFFER_SIZE, 0)
+		* 1024;
+
 	for (unsigned i = 0; input_plugins[i] != nullptr; ++i) {
 		const InputPlugin *plugin = input_plugins[i];
 
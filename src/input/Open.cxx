@@ -23,6 +23,7 @@
 #include "InputPlugin.hxx"
 #include "LocalOpen.hxx"
 #include "Domain.hxx"
+#include "BufferingInputStream.hxx"
 #include "plugins/RewindInputPlugin.hxx"
 #include "fs/Traits.hxx"
 #include "fs/AllocatedPath.hxx"
@@ -45,6 +46,14 @@ InputStream::Open(const char *url,
 		if (is != nullptr) {
 			is = input_rewind_open(is);
 
+			if (input_buffer_size > 0)
+				/* add read-ahead buffering for remote
+				   streams; local files are served
+				   from the page cache and don't need
+				   it */
+				is = input_buffering_open(is,
+							  input_buffer_size);
+
 			return InputStreamPtr(is);
 		}
 	}
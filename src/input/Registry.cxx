@@ -21,6 +21,7 @@
 #include "Registry.hxx"
 #include "util/Macros.hxx"
 #include "plugins/FileInputPlugin.hxx"
+#include "plugins/FaultInputPlugin.hxx"
 
 #ifdef ENABLE_ALSA
 #include "plugins/AlsaInputPlugin.hxx"
@@ -56,6 +57,7 @@
 
 const InputPlugin *const input_plugins[] = {
 	&input_plugin_file,
+	&input_plugin_fault,
 #ifdef ENABLE_ALSA
 	&input_plugin_alsa,
 #endif
@@ -19,6 +19,7 @@
 
 #include "config.h"
 #include "ArchiveInputPlugin.hxx"
+#include "archive/ArchiveCache.hxx"
 #include "archive/ArchiveDomain.hxx"
 #include "archive/ArchiveLookup.hxx"
 #include "archive/ArchiveList.hxx"
@@ -60,7 +61,7 @@ OpenArchiveInputStream(Path path, Mutex &mutex, Cond &cond)
 		return nullptr;
 	}
 
-	auto file = archive_file_open(arplug, Path::FromFS(archive));
+	auto file = archive_cache_open(*arplug, Path::FromFS(archive));
 
 	AtScopeExit(file) {
 		file->Close();
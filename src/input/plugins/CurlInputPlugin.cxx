@@ -64,6 +64,12 @@ static const size_t CURL_MAX_BUFFERED = 512 * 1024;
  */
 static const size_t CURL_RESUME_AT = 384 * 1024;
 
+/**
+ * The configured buffer watermarks; initialized from the
+ * #ConfigBlock with the above defaults.
+ */
+static size_t curl_max_buffered, curl_resume_at;
+
 struct CurlInputStream final : public AsyncInputStream, CurlResponseHandler {
 	/* some buffers which were passed to libcurl, which we have
 	   too free */
@@ -77,8 +83,8 @@ struct CurlInputStream final : public AsyncInputStream, CurlResponseHandler {
 	CurlInputStream(EventLoop &event_loop, const char *_url,
 			Mutex &_mutex, Cond &_cond)
 		:AsyncInputStream(event_loop, _url, _mutex, _cond,
-				  CURL_MAX_BUFFERED,
-				  CURL_RESUME_AT),
+				  curl_max_buffered,
+				  curl_resume_at),
 		 icy(new IcyInputStream(this)) {
 	}
 
@@ -331,6 +337,13 @@ input_curl_init(EventLoop &event_loop, const ConfigBlock &block)
 
 	verify_peer = block.GetBlockValue("verify_peer", true);
 	verify_host = block.GetBlockValue("verify_host", true);
+
+	curl_max_buffered = block.GetBlockValue("max_buffered",
+						(unsigned)CURL_MAX_BUFFERED);
+	curl_resume_at = block.GetBlockValue("resume_at",
+					     (unsigned)CURL_RESUME_AT);
+	if (curl_resume_at >= curl_max_buffered)
+		throw std::runtime_error("resume_at must be smaller than max_buffered");
 }
 
 static void
@@ -353,6 +366,15 @@ CurlInputStream::InitEasy()
 	request = new CurlRequest(**curl_init, GetURI(), *this);
 
 	request->SetOption(CURLOPT_HTTP200ALIASES, http_200_aliases);
+
+#if LIBCURL_VERSION_NUM >= 0x072f00
+	/* opt in to HTTP/2 over TLS so requests to the same host can
+	   be multiplexed over the pooled connection; plain http:// and
+	   servers without HTTP/2 fall back to HTTP/1.1 */
+	request->SetOption(CURLOPT_HTTP_VERSION,
+			   (long)CURL_HTTP_VERSION_2TLS);
+#endif
+
 	request->SetOption(CURLOPT_FOLLOWLOCATION, 1l);
 	request->SetOption(CURLOPT_MAXREDIRS, 5l);
 	request->SetOption(CURLOPT_FAILONERROR, 1l);
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "FaultInputPlugin.hxx"
+#include "FaultInjectionConfig.hxx"
+#include "../InputPlugin.hxx"
+#include "../ProxyInputStream.hxx"
+#include "config/Block.hxx"
+#include "thread/Mutex.hxx"
+#include "util/StringCompare.hxx"
+#include "util/RuntimeError.hxx"
+
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+#include <stdlib.h>
+
+static constexpr char FAULT_SCHEME[] = "fault://";
+
+/**
+ * The default fault profile, configured in the "fault" input block.
+ * URI options override it per stream.
+ */
+static FaultInjectionConfig fault_input_config;
+
+class FaultInputStream final : public ProxyInputStream {
+	const FaultInjectionConfig config;
+
+	std::minstd_rand prng;
+
+	std::uniform_real_distribution<double> error_dist{0.0, 1.0};
+
+	/**
+	 * When was the first byte read?  Reference point for the
+	 * bandwidth cap.
+	 */
+	std::chrono::steady_clock::time_point start;
+
+	/** total payload bytes delivered so far */
+	uint64_t total_bytes = 0;
+
+public:
+	FaultInputStream(InputStream *_input,
+			 const FaultInjectionConfig &_config)
+		:ProxyInputStream(_input),
+		 config(_config),
+		 prng(config.seed) {}
+
+	/* virtual methods from InputStream */
+	size_t Read(void *ptr, size_t read_size) override;
+	void Seek(offset_type new_offset) override;
+
+private:
+	/**
+	 * Sleep with the mutex released, like a real device blocked
+	 * on slow storage would.
+	 */
+	void Delay(std::chrono::steady_clock::duration d) {
+		const ScopeUnlock unlock(mutex);
+		std::this_thread::sleep_for(d);
+	}
+
+	void ApplyLatency() {
+		if (config.latency > config.latency.zero())
+			Delay(config.latency);
+	}
+
+	/**
+	 * Delay until the configured bandwidth budget covers the
+	 * bytes delivered so far.
+	 */
+	void ApplyBandwidth();
+};
+
+void
+FaultInputStream::ApplyBandwidth()
+{
+	if (config.bandwidth == 0)
+		return;
+
+	if (total_bytes == 0) {
+		start = std::chrono::steady_clock::now();
+		return;
+	}
+
+	const auto budget = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(double(total_bytes) / config.bandwidth));
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+	if (budget > elapsed)
+		Delay(budget - elapsed);
+}
+
+size_t
+FaultInputStream::Read(void *ptr, size_t read_size)
+{
+	ApplyLatency();
+
+	if (config.error_rate > 0 &&
+	    error_dist(prng) < config.error_rate)
+		throw std::runtime_error("injected I/O error");
+
+	ApplyBandwidth();
+
+	size_t nbytes = ProxyInputStream::Read(ptr, read_size);
+	total_bytes += nbytes;
+	return nbytes;
+}
+
+void
+FaultInputStream::Seek(offset_type new_offset)
+{
+	ApplyLatency();
+
+	ProxyInputStream::Seek(new_offset);
+}
+
+static void
+input_fault_init(EventLoop &, const ConfigBlock &block)
+{
+	fault_input_config.latency =
+		std::chrono::milliseconds(block.GetBlockValue("latency_ms",
+							      0u));
+	fault_input_config.bandwidth =
+		uint64_t(block.GetBlockValue("bandwidth_kbps", 0u)) * 1024;
+	fault_input_config.seed = block.GetBlockValue("seed", 42u);
+
+	const char *s = block.GetBlockValue("error_rate");
+	if (s != nullptr) {
+		char *endptr;
+		double value = strtod(s, &endptr);
+		if (endptr == s || *endptr != 0 ||
+		    value < 0 || value > 100)
+			throw FormatRuntimeError("Invalid error_rate: %s", s);
+
+		fault_input_config.error_rate = value / 100.0;
+	}
+}
+
+static InputStream *
+input_fault_open(const char *uri, Mutex &mutex, Cond &cond)
+{
+	const char *tail = StringAfterPrefix(uri, FAULT_SCHEME);
+	if (tail == nullptr)
+		return nullptr;
+
+	FaultInjectionConfig config = fault_input_config;
+	const char *inner_uri = ParseFaultOptions(config, tail);
+
+	auto inner = InputStream::Open(inner_uri, mutex, cond);
+	return new FaultInputStream(inner.release(), config);
+}
+
+const InputPlugin input_plugin_fault = {
+	"fault",
+	input_fault_init,
+	nullptr,
+	input_fault_open,
+};
@@ -31,8 +31,22 @@
 #include <fcntl.h>
 
 class FileInputStream final : public InputStream {
+	/**
+	 * Tell the kernel to drop the page cache behind the read
+	 * cursor in steps of this size.  Files smaller than twice
+	 * this size are never dropped, so short tracks which are
+	 * replayed soon stay cached.
+	 */
+	static constexpr offset_type DROP_STEP = 8 * 1024 * 1024;
+
 	FileReader reader;
 
+	/**
+	 * Everything before this offset has already been dropped
+	 * from the page cache.
+	 */
+	offset_type drop_offset = 0;
+
 public:
 	FileInputStream(const char *path, FileReader &&_reader, off_t _size,
 			Mutex &_mutex, Cond &_cond)
@@ -93,6 +107,12 @@ FileInputStream::Seek(offset_type new_offset)
 	}
 
 	offset = new_offset;
+
+	if (new_offset < drop_offset)
+		/* pages behind the new position were already
+		   dropped; start over so they get dropped again
+		   after being re-read */
+		drop_offset = new_offset;
 }
 
 size_t
@@ -106,6 +126,22 @@ FileInputStream::Read(void *ptr, size_t read_size)
 	}
 
 	offset += nbytes;
+
+#ifdef POSIX_FADV_DONTNEED
+	if (offset - drop_offset >= 2 * DROP_STEP) {
+		/* this stream will not read that data again, so
+		   evict it from the page cache instead of letting
+		   played audio push out more useful data (such as
+		   the database); keep one step behind the cursor
+		   cached for decoders which seek back a little */
+		const offset_type end = offset - DROP_STEP;
+		posix_fadvise(reader.GetFD().Get(), (off_t)drop_offset,
+			      (off_t)(end - drop_offset),
+			      POSIX_FADV_DONTNEED);
+		drop_offset = end;
+	}
+#endif
+
 	return nbytes;
 }
 
@@ -23,9 +23,12 @@
 #include "../InputPlugin.hxx"
 #include "lib/nfs/Glue.hxx"
 #include "lib/nfs/FileReader.hxx"
+#include "config/Block.hxx"
 #include "thread/Cond.hxx"
 #include "util/StringCompare.hxx"
 
+#include <stdexcept>
+
 #include <string.h>
 
 /**
@@ -40,17 +43,45 @@ static const size_t NFS_MAX_BUFFERED = 512 * 1024;
  */
 static const size_t NFS_RESUME_AT = 384 * 1024;
 
+/**
+ * Request this number of bytes per read operation.
+ */
+static const size_t NFS_READ_SIZE = 32768;
+
+/**
+ * Keep up to this number of read operations in flight, so the
+ * round-trip latency to the server does not limit the throughput.
+ */
+static const size_t NFS_MAX_IN_FLIGHT = 8;
+
+/**
+ * The configured buffer watermarks; initialized from the
+ * #ConfigBlock with the above defaults.
+ */
+static size_t nfs_max_buffered, nfs_resume_at;
+
 class NfsInputStream final : NfsFileReader, public AsyncInputStream {
+	/**
+	 * The offset of the next data to be submitted to
+	 * AppendToBuffer().
+	 */
 	uint64_t next_offset;
 
+	/**
+	 * The offset of the next read operation to be issued; ahead
+	 * of #next_offset by the number of bytes currently in
+	 * flight.
+	 */
+	uint64_t issue_offset;
+
 	bool reconnect_on_resume = false, reconnecting = false;
 
 public:
 	NfsInputStream(const char *_uri, Mutex &_mutex, Cond &_cond)
 		:AsyncInputStream(NfsFileReader::GetEventLoop(),
 				  _uri, _mutex, _cond,
-				  NFS_MAX_BUFFERED,
-				  NFS_RESUME_AT) {}
+				  nfs_max_buffered,
+				  nfs_resume_at) {}
 
 	virtual ~NfsInputStream() {
 		DeferClose();
@@ -82,25 +113,36 @@ NfsInputStream::DoRead()
 {
 	assert(NfsFileReader::IsIdle());
 
-	int64_t remaining = size - next_offset;
-	if (remaining <= 0)
-		return;
-
-	const size_t buffer_space = GetBufferSpace();
-	if (buffer_space == 0) {
-		Pause();
-		return;
-	}
-
-	size_t nbytes = std::min<size_t>(std::min<uint64_t>(remaining, 32768),
-					 buffer_space);
-
-	try {
-		const ScopeUnlock unlock(mutex);
-		NfsFileReader::Read(next_offset, nbytes);
-	} catch (...) {
-		postponed_exception = std::current_exception();
-		cond.broadcast();
+	while (GetPendingReadCount() < NFS_MAX_IN_FLIGHT) {
+		int64_t remaining = size - issue_offset;
+		if (remaining <= 0)
+			return;
+
+		/* the bytes already in flight will be appended to
+		   the buffer when they arrive, so only the rest of
+		   the buffer may be requested */
+		const size_t in_flight = issue_offset - next_offset;
+		const size_t buffer_space = GetBufferSpace();
+		if (buffer_space <= in_flight) {
+			if (GetPendingReadCount() == 0)
+				Pause();
+			return;
+		}
+
+		size_t nbytes = std::min<size_t>(std::min<uint64_t>(remaining,
+								    NFS_READ_SIZE),
+						 buffer_space - in_flight);
+
+		try {
+			const ScopeUnlock unlock(mutex);
+			NfsFileReader::Read(issue_offset, nbytes);
+		} catch (...) {
+			postponed_exception = std::current_exception();
+			cond.broadcast();
+			return;
+		}
+
+		issue_offset += nbytes;
 	}
 }
 
@@ -135,7 +177,7 @@ NfsInputStream::DoSeek(offset_type new_offset)
 		NfsFileReader::CancelRead();
 	}
 
-	next_offset = offset = new_offset;
+	next_offset = issue_offset = offset = new_offset;
 	SeekDone();
 	DoRead();
 }
@@ -149,13 +191,14 @@ NfsInputStream::OnNfsFileOpen(uint64_t _size) noexcept
 		/* reconnect has succeeded */
 
 		reconnecting = false;
+		issue_offset = next_offset;
 		DoRead();
 		return;
 	}
 
 	size = _size;
 	seekable = true;
-	next_offset = 0;
+	next_offset = issue_offset = 0;
 	SetReady();
 	DoRead();
 }
@@ -170,6 +213,11 @@ NfsInputStream::OnNfsFileRead(const void *data, size_t data_size) noexcept
 
 	next_offset += data_size;
 
+	if (GetPendingReadCount() == 0)
+		/* resynchronize after a short read; NfsFileReader
+		   has discarded the now misaligned requests */
+		issue_offset = next_offset;
+
 	DoRead();
 }
 
@@ -205,9 +253,16 @@ NfsInputStream::OnNfsFileError(std::exception_ptr &&e) noexcept
  */
 
 static void
-input_nfs_init(EventLoop &event_loop, const ConfigBlock &)
+input_nfs_init(EventLoop &event_loop, const ConfigBlock &block)
 {
 	nfs_init(event_loop);
+
+	nfs_max_buffered = block.GetBlockValue("max_buffered",
+					       (unsigned)NFS_MAX_BUFFERED);
+	nfs_resume_at = block.GetBlockValue("resume_at",
+					    (unsigned)NFS_RESUME_AT);
+	if (nfs_resume_at >= nfs_max_buffered)
+		throw std::runtime_error("resume_at must be smaller than max_buffered");
 }
 
 static void
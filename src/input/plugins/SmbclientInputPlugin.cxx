@@ -20,7 +20,7 @@
 #include "config.h"
 #include "SmbclientInputPlugin.hxx"
 #include "lib/smbclient/Init.hxx"
-#include "lib/smbclient/Mutex.hxx"
+#include "lib/smbclient/Context.hxx"
 #include "../InputStream.hxx"
 #include "../InputPlugin.hxx"
 #include "PluginUnavailable.hxx"
@@ -33,24 +33,23 @@
 
 class SmbclientInputStream final : public InputStream {
 	SMBCCTX *ctx;
-	int fd;
+	SMBCFILE *file;
 
 public:
 	SmbclientInputStream(const char *_uri,
 			     Mutex &_mutex, Cond &_cond,
-			     SMBCCTX *_ctx, int _fd, const struct stat &st)
+			     SMBCCTX *_ctx, SMBCFILE *_file,
+			     const struct stat &st)
 		:InputStream(_uri, _mutex, _cond),
-		 ctx(_ctx), fd(_fd) {
+		 ctx(_ctx), file(_file) {
 		seekable = true;
 		size = st.st_size;
 		SetReady();
 	}
 
 	~SmbclientInputStream() {
-		smbclient_mutex.lock();
-		smbc_close(fd);
-		smbc_free_context(ctx, 1);
-		smbclient_mutex.unlock();
+		smbc_getFunctionClose(ctx)(ctx, file);
+		SmbclientFreeContext(ctx);
 	}
 
 	/* virtual methods from InputStream */
@@ -90,36 +89,27 @@ input_smbclient_open(const char *uri,
 	if (!StringStartsWith(uri, "smb://"))
 		return nullptr;
 
-	const std::lock_guard<Mutex> protect(smbclient_mutex);
+	/* each stream gets its own SMBCCTX, so concurrent streams
+	   don't serialize on the global lock; only context
+	   creation/destruction is synchronized */
+	SMBCCTX *ctx = SmbclientNewContext();
 
-	SMBCCTX *ctx = smbc_new_context();
-	if (ctx == nullptr)
-		throw MakeErrno("smbc_new_context() failed");
-
-	SMBCCTX *ctx2 = smbc_init_context(ctx);
-	if (ctx2 == nullptr) {
-		int e = errno;
-		smbc_free_context(ctx, 1);
-		throw MakeErrno(e, "smbc_init_context() failed");
-	}
-
-	ctx = ctx2;
-
-	int fd = smbc_open(uri, O_RDONLY, 0);
-	if (fd < 0) {
+	SMBCFILE *file = smbc_getFunctionOpen(ctx)(ctx, uri, O_RDONLY, 0);
+	if (file == nullptr) {
 		int e = errno;
-		smbc_free_context(ctx, 1);
+		SmbclientFreeContext(ctx);
 		throw MakeErrno(e, "smbc_open() failed");
 	}
 
 	struct stat st;
-	if (smbc_fstat(fd, &st) < 0) {
+	if (smbc_getFunctionFstat(ctx)(ctx, file, &st) < 0) {
 		int e = errno;
-		smbc_free_context(ctx, 1);
+		smbc_getFunctionClose(ctx)(ctx, file);
+		SmbclientFreeContext(ctx);
 		throw MakeErrno(e, "smbc_fstat() failed");
 	}
 
-	return new SmbclientInputStream(uri, mutex, cond, ctx, fd, st);
+	return new SmbclientInputStream(uri, mutex, cond, ctx, file, st);
 }
 
 size_t
@@ -129,8 +119,7 @@ SmbclientInputStream::Read(void *ptr, size_t read_size)
 
 	{
 		const ScopeUnlock unlock(mutex);
-		const std::lock_guard<Mutex> lock(smbclient_mutex);
-		nbytes = smbc_read(fd, ptr, read_size);
+		nbytes = smbc_getFunctionRead(ctx)(ctx, file, ptr, read_size);
 	}
 
 	if (nbytes < 0)
@@ -147,8 +136,8 @@ SmbclientInputStream::Seek(offset_type new_offset)
 
 	{
 		const ScopeUnlock unlock(mutex);
-		const std::lock_guard<Mutex> lock(smbclient_mutex);
-		result = smbc_lseek(fd, new_offset, SEEK_SET);
+		result = smbc_getFunctionLseek(ctx)(ctx, file, new_offset,
+						    SEEK_SET);
 	}
 
 	if (result < 0)
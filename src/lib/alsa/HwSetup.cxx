@@ -177,7 +177,7 @@ SetupSampleFormat(snd_pcm_t *pcm, snd_pcm_hw_params_t *hwparams,
 }
 
 HwResult
-SetupHw(snd_pcm_t *pcm,
+SetupHw(snd_pcm_t *pcm, bool &mmap,
 	unsigned buffer_time, unsigned period_time,
 	AudioFormat &audio_format, PcmExport::Params &params)
 {
@@ -193,11 +193,22 @@ SetupHw(snd_pcm_t *pcm,
 		throw FormatRuntimeError("snd_pcm_hw_params_any() failed: %s",
 					 snd_strerror(-err));
 
-	err = snd_pcm_hw_params_set_access(pcm, hwparams,
-					   SND_PCM_ACCESS_RW_INTERLEAVED);
-	if (err < 0)
-		throw FormatRuntimeError("snd_pcm_hw_params_set_access() failed: %s",
-					 snd_strerror(-err));
+	if (mmap) {
+		err = snd_pcm_hw_params_set_access(pcm, hwparams,
+						   SND_PCM_ACCESS_MMAP_INTERLEAVED);
+		if (err < 0)
+			/* the device doesn't support mmap; fall back
+			   to snd_pcm_writei() */
+			mmap = false;
+	}
+
+	if (!mmap) {
+		err = snd_pcm_hw_params_set_access(pcm, hwparams,
+						   SND_PCM_ACCESS_RW_INTERLEAVED);
+		if (err < 0)
+			throw FormatRuntimeError("snd_pcm_hw_params_set_access() failed: %s",
+						 snd_strerror(-err));
+	}
 
 	err = SetupSampleFormat(pcm, hwparams,
 				audio_format.format, params);
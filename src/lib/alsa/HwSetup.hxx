@@ -37,6 +37,10 @@ struct HwResult {
 /**
  * Wrapper for snd_pcm_hw_params().
  *
+ * @param mmap attempt to configure
+ * #SND_PCM_ACCESS_MMAP_INTERLEAVED?  Cleared by this function if the
+ * device does not support it and #SND_PCM_ACCESS_RW_INTERLEAVED was
+ * configured instead
  * @param buffer_time the configured buffer time, or 0 if not configured
  * @param period_time the configured period time, or 0 if not configured
  * @param audio_format an #AudioFormat to be configured (or modified)
@@ -44,7 +48,7 @@ struct HwResult {
  * @param params to be modified by this function
  */
 HwResult
-SetupHw(snd_pcm_t *pcm,
+SetupHw(snd_pcm_t *pcm, bool &mmap,
 	unsigned buffer_time, unsigned period_time,
 	AudioFormat &audio_format, PcmExport::Params &params);
 
@@ -104,6 +104,20 @@ CurlGlobal::CurlGlobal(EventLoop &_loop)
 
 	multi.SetOption(CURLMOPT_TIMERFUNCTION, TimerFunction);
 	multi.SetOption(CURLMOPT_TIMERDATA, this);
+
+#if LIBCURL_VERSION_NUM >= 0x072b00
+	/* multiplex requests to the same host over one HTTP/2
+	   connection */
+	multi.SetOption(CURLMOPT_PIPELINING, (long)CURLPIPE_MULTIPLEX);
+#endif
+
+	/* the default connection cache is proportional to the number
+	   of easy handles, which is usually just one or two here;
+	   keep more connections around so that opening many streams
+	   one after another against the same host (e.g. a radio
+	   relay) reuses them instead of paying the TLS handshake and
+	   TCP slow-start every time */
+	multi.SetOption(CURLMOPT_MAXCONNECTS, 16l);
 }
 
 int
@@ -185,6 +199,34 @@ CurlGlobal::Remove(CURL *easy) noexcept
 	InvalidateSockets();
 }
 
+std::string
+CurlGlobal::GetResolveCacheEntry(const std::string &key) const noexcept
+{
+	const std::lock_guard<Mutex> protect(resolve_cache_mutex);
+
+	auto i = resolve_cache.find(key);
+	return i != resolve_cache.end()
+		? i->second
+		: std::string();
+}
+
+void
+CurlGlobal::AddResolveCacheEntry(const std::string &key,
+				 const char *address) noexcept
+{
+	auto entry = key + ':' + address;
+
+	const std::lock_guard<Mutex> protect(resolve_cache_mutex);
+	resolve_cache[key] = std::move(entry);
+}
+
+void
+CurlGlobal::RemoveResolveCacheEntry(const std::string &key) noexcept
+{
+	const std::lock_guard<Mutex> protect(resolve_cache_mutex);
+	resolve_cache.erase(key);
+}
+
 static CurlRequest *
 ToRequest(CURL *easy) noexcept
 {
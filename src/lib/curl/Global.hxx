@@ -33,6 +33,10 @@
 #include "Multi.hxx"
 #include "event/TimerEvent.hxx"
 #include "event/DeferEvent.hxx"
+#include "thread/Mutex.hxx"
+
+#include <map>
+#include <string>
 
 class CurlSocket;
 class CurlRequest;
@@ -47,6 +51,22 @@ class CurlGlobal final {
 
 	TimerEvent timeout_event;
 
+	/**
+	 * Protects #resolve_cache; it is read by threads constructing
+	 * a #CurlRequest and updated from the event loop thread.
+	 */
+	mutable Mutex resolve_cache_mutex;
+
+	/**
+	 * Maps "host:port" to an entry in CURLOPT_RESOLVE format
+	 * ("host:port:address"), learned from finished transfers.
+	 * New requests to a known server are primed with it, so the
+	 * name resolution - which blocks the whole transfer loop
+	 * unless libcurl was built with an asynchronous resolver - is
+	 * skipped for repeated connections.
+	 */
+	std::map<std::string, std::string> resolve_cache;
+
 public:
 	explicit CurlGlobal(EventLoop &_loop);
 
@@ -57,6 +77,26 @@ public:
 	void Add(CURL *easy, CurlRequest &request);
 	void Remove(CURL *easy) noexcept;
 
+	/**
+	 * Look up the known address of the given "host:port" key.
+	 *
+	 * @return an entry in CURLOPT_RESOLVE format, or an empty
+	 * string if the server has not been seen yet
+	 */
+	std::string GetResolveCacheEntry(const std::string &key) const noexcept;
+
+	/**
+	 * Remember a server's address after a successful transfer.
+	 */
+	void AddResolveCacheEntry(const std::string &key,
+				  const char *address) noexcept;
+
+	/**
+	 * Forget a server's address, e.g. after a failed connection
+	 * attempt (the server may have moved).
+	 */
+	void RemoveResolveCacheEntry(const std::string &key) noexcept;
+
 	/**
 	 * Check for finished HTTP responses.
 	 *
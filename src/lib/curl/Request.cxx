@@ -42,8 +42,48 @@
 #include <algorithm>
 
 #include <assert.h>
+#include <stdio.h>
 #include <string.h>
 
+/**
+ * Build the "host:port" resolve cache key for a URL, or an empty
+ * string if there is nothing worth caching - a non-HTTP scheme, a
+ * numeric address or an IPv6 literal.  (A host name starting with a
+ * digit is also skipped; that merely misses the optimization for
+ * such hosts.)
+ */
+gcc_pure
+static std::string
+MakeResolveKey(const char *url) noexcept
+{
+	unsigned default_port;
+	if (memcmp(url, "http://", 7) == 0)
+		default_port = 80;
+	else if (memcmp(url, "https://", 8) == 0)
+		default_port = 443;
+	else
+		return {};
+
+	const char *p = strchr(url, ':') + 3;
+
+	/* find the end of the authority and strip the user info */
+	const char *end = p + strcspn(p, "/");
+	const char *at = (const char *)memchr(p, '@', end - p);
+	if (at != nullptr)
+		p = at + 1;
+
+	if (p == end || *p == '[' || IsDigitASCII(*p))
+		return {};
+
+	if (memchr(p, ':', end - p) != nullptr)
+		/* the URL specifies a port */
+		return std::string(p, end);
+
+	char buffer[16];
+	snprintf(buffer, sizeof(buffer), ":%u", default_port);
+	return std::string(p, end) + buffer;
+}
+
 CurlRequest::CurlRequest(CurlGlobal &_global, const char *url,
 			 CurlResponseHandler &_handler)
 	:global(_global), handler(_handler),
@@ -64,6 +104,19 @@ CurlRequest::CurlRequest(CurlGlobal &_global, const char *url,
 	easy.SetOption(CURLOPT_NOSIGNAL, 1l);
 	easy.SetOption(CURLOPT_CONNECTTIMEOUT, 10l);
 	easy.SetOption(CURLOPT_URL, url);
+
+	resolve_key = MakeResolveKey(url);
+	if (!resolve_key.empty()) {
+		const auto entry = global.GetResolveCacheEntry(resolve_key);
+		if (!entry.empty()) {
+			/* the server's address is already known:
+			   prime libcurl with it, skipping the name
+			   resolution which would block the transfer
+			   loop */
+			resolve_list.Append(entry.c_str());
+			easy.SetOption(CURLOPT_RESOLVE, resolve_list.Get());
+		}
+	}
 }
 
 CurlRequest::~CurlRequest() noexcept
@@ -147,6 +200,25 @@ CurlRequest::Done(CURLcode result) noexcept
 {
 	Stop();
 
+	if (!resolve_key.empty()) {
+		if (result == CURLE_OK) {
+			/* remember the server's address for future
+			   requests */
+			char *address = nullptr;
+			if (curl_easy_getinfo(easy.Get(),
+					      CURLINFO_PRIMARY_IP,
+					      &address) == CURLE_OK &&
+			    address != nullptr && *address != 0)
+				global.AddResolveCacheEntry(resolve_key,
+							    address);
+		} else if (result == CURLE_COULDNT_RESOLVE_HOST ||
+			   result == CURLE_COULDNT_CONNECT ||
+			   result == CURLE_OPERATION_TIMEDOUT)
+			/* the server may have moved: resolve its name
+			   again on the next attempt */
+			global.RemoveResolveCacheEntry(resolve_key);
+	}
+
 	try {
 		if (result != CURLE_OK) {
 			StripRight(error_buffer);
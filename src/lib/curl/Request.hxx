@@ -31,6 +31,7 @@
 #define CURL_REQUEST_HXX
 
 #include "Easy.hxx"
+#include "Slist.hxx"
 #include "event/DeferEvent.hxx"
 
 #include <map>
@@ -69,6 +70,19 @@ class CurlRequest final {
 
 	DeferEvent postpone_error_event;
 
+	/**
+	 * The "host:port" key of this request's URL in #CurlGlobal's
+	 * resolve cache, or empty if the URL has no cacheable host
+	 * name.
+	 */
+	std::string resolve_key;
+
+	/**
+	 * The list passed to CURLOPT_RESOLVE; it must stay allocated
+	 * while the easy handle exists.
+	 */
+	CurlSlist resolve_list;
+
 	/** error message provided by libcurl */
 	char error_buffer[CURL_ERROR_SIZE];
 
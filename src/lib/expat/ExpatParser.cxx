@@ -30,6 +30,23 @@ ExpatParser::Parse(const char *data, size_t length, bool is_final)
 		throw ExpatError(parser);
 }
 
+void *
+ExpatParser::GetBuffer(size_t size)
+{
+	void *buffer = XML_GetBuffer(parser, size);
+	if (buffer == nullptr)
+		throw ExpatError(parser);
+
+	return buffer;
+}
+
+void
+ExpatParser::ParseBuffer(size_t length, bool is_final)
+{
+	if (XML_ParseBuffer(parser, length, is_final) != XML_STATUS_OK)
+		throw ExpatError(parser);
+}
+
 const char *
 ExpatParser::GetAttribute(const XML_Char **atts,
 			  const char *name) noexcept
@@ -74,6 +74,23 @@ public:
 
 	void Parse(const char *data, size_t length, bool is_final);
 
+	/**
+	 * Obtain a buffer of the given size from expat.  Fill it and
+	 * then call ParseBuffer(); this saves one copy compared to
+	 * Parse().
+	 *
+	 * Throws #ExpatError on error.
+	 */
+	void *GetBuffer(size_t size);
+
+	/**
+	 * Parse data which has been written into the buffer returned
+	 * by GetBuffer().
+	 *
+	 * Throws #ExpatError on error.
+	 */
+	void ParseBuffer(size_t length, bool is_final);
+
 	void Parse(InputStream &is);
 
 	gcc_pure
@@ -27,13 +27,14 @@ ExpatParser::Parse(InputStream &is)
 	assert(is.IsReady());
 
 	while (true) {
-		char buffer[4096];
-		size_t nbytes = is.LockRead(buffer, sizeof(buffer));
+		/* read directly into expat's buffer, saving one copy
+		   per chunk */
+		constexpr size_t CHUNK_SIZE = 4096;
+		void *buffer = GetBuffer(CHUNK_SIZE);
+
+		size_t nbytes = is.LockRead(buffer, CHUNK_SIZE);
+		ParseBuffer(nbytes, nbytes == 0);
 		if (nbytes == 0)
 			break;
-
-		Parse(buffer, nbytes, false);
 	}
-
-	Parse("", 0, true);
 }
@@ -23,6 +23,7 @@
 
 #ifdef HAVE_ICU
 #include "Util.hxx"
+#include "util/AllocatedArray.hxx"
 #include "util/RuntimeError.hxx"
 
 #include <unicode/ucol.h>
@@ -139,3 +140,32 @@ IcuCollate(const char *a, const char *b) noexcept
 	return strcoll(a, b);
 #endif
 }
+
+#ifdef HAVE_ICU
+
+AllocatedString<char>
+IcuSortKey(const char *src) noexcept
+try {
+	assert(collator != nullptr);
+
+	const auto su = UCharFromUTF8(src);
+
+	const int32_t size = ucol_getSortKey(collator,
+					     su.begin(), su.size(),
+					     nullptr, 0);
+	if (size <= 0)
+		return nullptr;
+
+	auto result = new char[size];
+	ucol_getSortKey(collator, su.begin(), su.size(),
+			(uint8_t *)result, size);
+
+	/* the sort key is a null-terminated byte string */
+	return AllocatedString<char>::Donate(result);
+} catch (...) {
+	/* invalid UTF-8 or out of memory; the caller falls back to
+	   IcuCollate() */
+	return nullptr;
+}
+
+#endif
@@ -36,4 +36,21 @@ gcc_pure gcc_nonnull_all
 int
 IcuCollate(const char *a, const char *b) noexcept;
 
+#ifdef HAVE_ICU
+
+template<typename T> class AllocatedString;
+
+/**
+ * Compute a binary collation key for the given UTF-8 string.  Two
+ * keys can be compared with strcmp() as a cheap substitute for
+ * calling IcuCollate() on the original strings, which pays off when
+ * the same string takes part in many comparisons (e.g. sorting).
+ * Returns a "null" instance on error.
+ */
+gcc_nonnull_all
+AllocatedString<char>
+IcuSortKey(const char *src) noexcept;
+
+#endif
+
 #endif
@@ -64,3 +64,13 @@ IcuCompare::IsIn(const char *haystack) const noexcept
 	return false;
 #endif
 }
+
+#ifdef HAVE_ICU_CASE_FOLD
+
+bool
+IcuCompare::IsInFolded(const char *folded_haystack) const noexcept
+{
+	return StringFind(folded_haystack, needle.c_str()) != nullptr;
+}
+
+#endif
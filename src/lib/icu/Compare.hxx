@@ -21,6 +21,7 @@
 #define MPD_ICU_COMPARE_HXX
 
 #include "check.h"
+#include "CaseFold.hxx"
 #include "Compiler.h"
 #include "util/AllocatedString.hxx"
 
@@ -50,6 +51,15 @@ public:
 
 	gcc_pure
 	bool IsIn(const char *haystack) const noexcept;
+
+#ifdef HAVE_ICU_CASE_FOLD
+	/**
+	 * Like IsIn(), but the haystack has already been case-folded
+	 * (e.g. a cached copy), saving the per-comparison fold.
+	 */
+	gcc_pure
+	bool IsInFolded(const char *folded_haystack) const noexcept;
+#endif
 };
 
 #endif
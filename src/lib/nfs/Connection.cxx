@@ -223,7 +223,7 @@ NfsConnection::Stat(const char *path, NfsCallback &callback)
 		throw;
 	}
 
-	ScheduleSocket();
+	DeferScheduleSocket();
 }
 
 void
@@ -240,7 +240,7 @@ NfsConnection::OpenDirectory(const char *path, NfsCallback &callback)
 		throw;
 	}
 
-	ScheduleSocket();
+	DeferScheduleSocket();
 }
 
 const struct nfsdirent *
@@ -273,7 +273,7 @@ NfsConnection::Open(const char *path, int flags, NfsCallback &callback)
 		throw;
 	}
 
-	ScheduleSocket();
+	DeferScheduleSocket();
 }
 
 void
@@ -290,7 +290,7 @@ NfsConnection::Stat(struct nfsfh *fh, NfsCallback &callback)
 		throw;
 	}
 
-	ScheduleSocket();
+	DeferScheduleSocket();
 }
 
 void
@@ -308,7 +308,7 @@ NfsConnection::Read(struct nfsfh *fh, uint64_t offset, size_t size,
 		throw;
 	}
 
-	ScheduleSocket();
+	DeferScheduleSocket();
 }
 
 void
@@ -338,7 +338,7 @@ NfsConnection::Close(struct nfsfh *fh) noexcept
 	assert(GetEventLoop().IsInside());
 
 	InternalClose(fh);
-	ScheduleSocket();
+	DeferScheduleSocket();
 }
 
 void
@@ -368,6 +368,8 @@ NfsConnection::DestroyContext() noexcept
 	   new leases */
 	defer_new_lease.Cancel();
 
+	defer_schedule_socket.Cancel();
+
 	if (SocketMonitor::IsDefined())
 		SocketMonitor::Steal();
 
@@ -511,8 +513,13 @@ NfsConnection::OnSocketReady(unsigned flags) noexcept
 	in_event = false;
 #endif
 
-	if (context != nullptr)
+	if (context != nullptr) {
+		/* the event mask is now up to date; no need to run a
+		   deferred update scheduled by an operation started
+		   from one of the callbacks */
+		defer_schedule_socket.Cancel();
 		ScheduleSocket();
+	}
 
 	return !closed;
 }
@@ -92,6 +92,17 @@ class NfsConnection : SocketMonitor {
 	};
 
 	DeferEvent defer_new_lease;
+
+	/**
+	 * Coalesces socket event mask updates: each started operation
+	 * may toggle the interest in POLLOUT, and going through the
+	 * #EventLoop's "deferred" stage means a whole batch of
+	 * operations started in one loop iteration results in at most
+	 * one epoll_ctl() call, right before the loop goes back to
+	 * sleep.
+	 */
+	DeferEvent defer_schedule_socket;
+
 	TimerEvent mount_timeout_event;
 
 	std::string server, export_name;
@@ -141,6 +152,8 @@ public:
 		      const char *_server, const char *_export_name) noexcept
 		:SocketMonitor(_loop),
 		 defer_new_lease(_loop, BIND_THIS_METHOD(RunDeferred)),
+		 defer_schedule_socket(_loop,
+				       BIND_THIS_METHOD(OnDeferredScheduleSocket)),
 		 mount_timeout_event(_loop, BIND_THIS_METHOD(OnMountTimeout)),
 		 server(_server), export_name(_export_name),
 		 context(nullptr) {}
@@ -225,6 +238,14 @@ private:
 
 	void ScheduleSocket() noexcept;
 
+	/**
+	 * Schedule a deferred ScheduleSocket() call (see
+	 * #defer_schedule_socket).
+	 */
+	void DeferScheduleSocket() noexcept {
+		defer_schedule_socket.Schedule();
+	}
+
 	/**
 	 * Wrapper for nfs_service().
 	 */
@@ -238,6 +259,11 @@ private:
 
 	/* DeferEvent callback */
 	void RunDeferred() noexcept;
+
+	/* callback for #defer_schedule_socket */
+	void OnDeferredScheduleSocket() noexcept {
+		ScheduleSocket();
+	}
 };
 
 #endif
@@ -66,11 +66,25 @@ NfsFileReader::CancelOrClose() noexcept
 	assert(state != State::INITIAL &&
 	       state != State::DEFER);
 
-	if (state == State::IDLE)
-		/* no async operation in progress: can close
-		   immediately */
-		connection->Close(fh);
-	else if (state > State::OPEN)
+	if (state == State::IDLE) {
+		if (read_requests.empty()) {
+			/* no async operation in progress: can close
+			   immediately */
+			connection->Close(fh);
+		} else {
+			/* cancel all in-flight reads; the last one
+			   carries the deferred nfs_close_async()
+			   call */
+			while (read_requests.size() > 1) {
+				connection->Cancel(read_requests.front());
+				read_requests.pop_front();
+			}
+
+			connection->CancelAndClose(fh,
+						   read_requests.front());
+			read_requests.clear();
+		}
+	} else if (state > State::OPEN)
 		/* one async operation in progress: cancel it and
 		   defer the nfs_close_async() call */
 		connection->CancelAndClose(fh, *this);
@@ -130,17 +144,30 @@ NfsFileReader::Read(uint64_t offset, size_t size)
 {
 	assert(state == State::IDLE);
 
-	connection->Read(fh, offset, size, *this);
-	state = State::READ;
+	read_requests.emplace_back(*this, offset, size);
+
+	try {
+		connection->Read(fh, offset, size, read_requests.back());
+	} catch (...) {
+		read_requests.pop_back();
+		throw;
+	}
+}
+
+void
+NfsFileReader::CancelAllReads() noexcept
+{
+	for (auto &r : read_requests)
+		connection->Cancel(r);
+
+	read_requests.clear();
 }
 
 void
 NfsFileReader::CancelRead() noexcept
 {
-	if (state == State::READ) {
-		connection->Cancel(*this);
-		state = State::IDLE;
-	}
+	if (state == State::IDLE)
+		CancelAllReads();
 }
 
 void
@@ -216,7 +243,70 @@ NfsFileReader::StatCallback(const struct stat *st) noexcept
 }
 
 void
-NfsFileReader::OnNfsCallback(unsigned status, void *data) noexcept
+NfsFileReader::ReadCallback(ReadRequest &r, unsigned status,
+			    const void *data) noexcept
+{
+	assert(state == State::IDLE);
+	assert(!read_requests.empty());
+
+	if (&r != &read_requests.front()) {
+		/* completed out of order: stash the data until all
+		   predecessors have been delivered */
+		r.data.reset(new uint8_t[status]);
+		memcpy(r.data.get(), data, status);
+		r.nbytes = status;
+		r.done = true;
+		return;
+	}
+
+	const bool short_read = status < r.size;
+	read_requests.pop_front();
+
+	if (short_read)
+		/* the server returned fewer bytes than requested
+		   (premature end-of-file or a small rsize limit);
+		   all following requests are misaligned now and must
+		   be discarded */
+		CancelAllReads();
+
+	OnNfsFileRead(data, status);
+
+	/* deliver all requests which have already completed out of
+	   order and are next in line now */
+	while (!read_requests.empty() && read_requests.front().done) {
+		auto &next = read_requests.front();
+		const auto next_data = std::move(next.data);
+		const size_t nbytes = next.nbytes;
+		const bool next_short = nbytes < next.size;
+		read_requests.pop_front();
+
+		if (next_short)
+			CancelAllReads();
+
+		OnNfsFileRead(next_data.get(), nbytes);
+	}
+}
+
+void
+NfsFileReader::ReadError(ReadRequest &r, std::exception_ptr &&e) noexcept
+{
+	assert(state == State::IDLE);
+	assert(!read_requests.empty());
+
+	/* discard all other in-flight reads; their data would be
+	   misaligned after this failure, and the consumer is about to
+	   see the error anyway */
+	for (auto &other : read_requests)
+		if (&other != &r)
+			connection->Cancel(other);
+
+	read_requests.clear();
+
+	OnNfsFileError(std::move(e));
+}
+
+void
+NfsFileReader::OnNfsCallback(gcc_unused unsigned status, void *data) noexcept
 {
 	switch (state) {
 	case State::INITIAL:
@@ -233,11 +323,6 @@ NfsFileReader::OnNfsCallback(unsigned status, void *data) noexcept
 	case State::STAT:
 		StatCallback((const struct stat *)data);
 		break;
-
-	case State::READ:
-		state = State::IDLE;
-		OnNfsFileRead(data, status);
-		break;
 	}
 }
 
@@ -262,10 +347,6 @@ NfsFileReader::OnNfsError(std::exception_ptr &&e) noexcept
 		connection->Close(fh);
 		state = State::INITIAL;
 		break;
-
-	case State::READ:
-		state = State::IDLE;
-		break;
 	}
 
 	OnNfsFileError(std::move(e));
@@ -28,6 +28,8 @@
 
 #include <string>
 #include <exception>
+#include <list>
+#include <memory>
 
 #include <stdint.h>
 #include <stddef.h>
@@ -50,12 +52,53 @@ class NfsFileReader : NfsLease, NfsCallback {
 		MOUNT,
 		OPEN,
 		STAT,
-		READ,
 		IDLE,
 	};
 
 	State state = State::INITIAL;
 
+	/**
+	 * One pending nfs_pread_async() call.  Each read gets its own
+	 * #NfsCallback instance so that several of them can be in
+	 * flight at the same time, hiding the server round-trip
+	 * latency.
+	 */
+	struct ReadRequest final : NfsCallback {
+		NfsFileReader &reader;
+
+		const uint64_t offset;
+		const size_t size;
+
+		/**
+		 * If this request completes before its predecessors,
+		 * the data is copied here until it is its turn to be
+		 * delivered.
+		 */
+		std::unique_ptr<uint8_t[]> data;
+		size_t nbytes = 0;
+		bool done = false;
+
+		ReadRequest(NfsFileReader &_reader,
+			    uint64_t _offset, size_t _size) noexcept
+			:reader(_reader), offset(_offset), size(_size) {}
+
+		/* virtual methods from NfsCallback */
+		void OnNfsCallback(unsigned status, void *_data) noexcept override {
+			reader.ReadCallback(*this, status, _data);
+		}
+
+		void OnNfsError(std::exception_ptr &&e) noexcept override {
+			reader.ReadError(*this, std::move(e));
+		}
+	};
+
+	/**
+	 * All in-flight read requests, in issue order.  Completions
+	 * are delivered to OnNfsFileRead() in this order, even if the
+	 * server replies out of order.
+	 */
+	std::list<ReadRequest> read_requests;
+
 	std::string server, export_name;
 	const char *path;
 
@@ -85,8 +128,9 @@ public:
 
 	/**
 	 * Attempt to read from the file.  This may only be done after
-	 * OnNfsFileOpen() has been called.  Only one read operation
-	 * may be performed at a time.
+	 * OnNfsFileOpen() has been called.  Several read operations
+	 * may be in flight at the same time; they are delivered to
+	 * OnNfsFileRead() in issue order.
 	 *
 	 * This method is not thread-safe and must be called from
 	 * within the I/O thread.
@@ -96,7 +140,7 @@ public:
 	void Read(uint64_t offset, size_t size);
 
 	/**
-	 * Cancel the most recent Read() call.
+	 * Cancel all pending Read() calls.
 	 *
 	 * This method is not thread-safe and must be called from
 	 * within the I/O thread.
@@ -107,6 +151,15 @@ public:
 		return state == State::IDLE;
 	}
 
+	/**
+	 * The number of read operations which have been issued but
+	 * not yet delivered to OnNfsFileRead().
+	 */
+	gcc_pure
+	size_t GetPendingReadCount() const noexcept {
+		return read_requests.size();
+	}
+
 protected:
 	/**
 	 * The file has been opened successfully.  It is a regular
@@ -141,6 +194,16 @@ private:
 	void OpenCallback(nfsfh *_fh) noexcept;
 	void StatCallback(const struct stat *st) noexcept;
 
+	void ReadCallback(ReadRequest &r, unsigned status,
+			  const void *data) noexcept;
+	void ReadError(ReadRequest &r, std::exception_ptr &&e) noexcept;
+
+	/**
+	 * Cancel all in-flight read requests without delivering
+	 * them.
+	 */
+	void CancelAllReads() noexcept;
+
 	/* virtual methods from NfsLease */
 	void OnNfsConnectionReady() noexcept final;
 	void OnNfsConnectionFailed(std::exception_ptr e) noexcept final;
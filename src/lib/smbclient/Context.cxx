@@ -0,0 +1,98 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "Context.hxx"
+#include "Mutex.hxx"
+#include "thread/Mutex.hxx"
+#include "system/Error.hxx"
+
+#include <libsmbclient.h>
+
+#include <forward_list>
+
+#include <string.h>
+
+/**
+ * Keep up to this number of idle contexts around; each of them keeps
+ * its server connections alive, so the next stream to the same
+ * server skips connect and authentication.
+ */
+static constexpr unsigned SMBCLIENT_MAX_POOLED_CONTEXTS = 4;
+
+/**
+ * Idle contexts available for reuse.  Protected by #smbclient_mutex.
+ */
+static std::forward_list<SMBCCTX *> smbclient_context_pool;
+static unsigned smbclient_n_pooled_contexts;
+
+void
+SmbclientAuthCallback(gcc_unused const char *srv,
+		      gcc_unused const char *shr,
+		      char *wg, gcc_unused int wglen,
+		      char *un, gcc_unused int unlen,
+		      char *pw, gcc_unused int pwlen)
+{
+	// TODO: implement
+	strcpy(wg, "WORKGROUP");
+	strcpy(un, "");
+	strcpy(pw, "");
+}
+
+SMBCCTX *
+SmbclientNewContext()
+{
+	const std::lock_guard<Mutex> protect(smbclient_mutex);
+
+	if (!smbclient_context_pool.empty()) {
+		SMBCCTX *ctx = smbclient_context_pool.front();
+		smbclient_context_pool.pop_front();
+		--smbclient_n_pooled_contexts;
+		return ctx;
+	}
+
+	SMBCCTX *ctx = smbc_new_context();
+	if (ctx == nullptr)
+		throw MakeErrno("smbc_new_context() failed");
+
+	smbc_setFunctionAuthData(ctx, SmbclientAuthCallback);
+
+	SMBCCTX *ctx2 = smbc_init_context(ctx);
+	if (ctx2 == nullptr) {
+		int e = errno;
+		smbc_free_context(ctx, 1);
+		throw MakeErrno(e, "smbc_init_context() failed");
+	}
+
+	return ctx2;
+}
+
+void
+SmbclientFreeContext(SMBCCTX *ctx) noexcept
+{
+	const std::lock_guard<Mutex> protect(smbclient_mutex);
+
+	if (smbclient_n_pooled_contexts < SMBCLIENT_MAX_POOLED_CONTEXTS) {
+		smbclient_context_pool.push_front(ctx);
+		++smbclient_n_pooled_contexts;
+		return;
+	}
+
+	smbc_free_context(ctx, 1);
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_SMBCLIENT_CONTEXT_HXX
+#define MPD_SMBCLIENT_CONTEXT_HXX
+
+#include "check.h"
+#include "Compiler.h"
+
+typedef struct _SMBCCTX SMBCCTX;
+
+/**
+ * The authentication callback which is installed in every #SMBCCTX
+ * created by SmbclientNewContext() (and in the deprecated global
+ * context, see SmbclientInit()).
+ */
+void
+SmbclientAuthCallback(const char *srv, const char *shr,
+		      char *wg, int wglen,
+		      char *un, int unlen,
+		      char *pw, int pwlen);
+
+/**
+ * Obtain a #SMBCCTX instance, either a pooled one or a freshly
+ * created one.  Unlike the deprecated global context, each instance
+ * may be used without holding #smbclient_mutex, as long as no two
+ * threads use the same instance at the same time.
+ *
+ * Throws std::runtime_error on error.
+ */
+SMBCCTX *
+SmbclientNewContext();
+
+/**
+ * Return a context obtained from SmbclientNewContext().  It is put
+ * back into the pool (keeping its server connections alive for the
+ * next stream) or destroyed if the pool is full.
+ */
+void
+SmbclientFreeContext(SMBCCTX *ctx) noexcept;
+
+#endif
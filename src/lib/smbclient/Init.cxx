@@ -19,33 +19,19 @@
 
 #include "config.h"
 #include "Init.hxx"
+#include "Context.hxx"
 #include "Mutex.hxx"
 #include "thread/Mutex.hxx"
 #include "system/Error.hxx"
 
 #include <libsmbclient.h>
 
-#include <string.h>
-
-static void
-mpd_smbc_get_auth_data(gcc_unused const char *srv,
-		       gcc_unused const char *shr,
-		       char *wg, gcc_unused int wglen,
-		       char *un, gcc_unused int unlen,
-		       char *pw, gcc_unused int pwlen)
-{
-	// TODO: implement
-	strcpy(wg, "WORKGROUP");
-	strcpy(un, "");
-	strcpy(pw, "");
-}
-
 void
 SmbclientInit()
 {
 	const std::lock_guard<Mutex> protect(smbclient_mutex);
 
 	constexpr int debug = 0;
-	if (smbc_init(mpd_smbc_get_auth_data, debug) < 0)
+	if (smbc_init(SmbclientAuthCallback, debug) < 0)
 		throw MakeErrno("smbc_init() failed");
 }
@@ -104,6 +104,13 @@ public:
 	UPnPDirContent getMetadata(UpnpClient_Handle handle,
 				   const char *objectId) const;
 
+	/** Retrieve the server's SystemUpdateID, which changes
+	 * whenever the content directory is modified.
+	 *
+	 * Throws std::runtime_error on error.
+	 */
+	unsigned getSystemUpdateID(UpnpClient_Handle handle) const;
+
 	/** Retrieve search capabilities
 	 *
 	 * Throws std::runtime_error on error.
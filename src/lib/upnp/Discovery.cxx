@@ -73,7 +73,7 @@ UPnPDeviceDirectory::Downloader::OnEnd()
 {
 	AtScopeExit(this) { Destroy(); };
 
-	ContentDirectoryDescriptor d(std::move(id),
+	ContentDirectoryDescriptor d(std::move(id), std::string(url),
 				     std::chrono::steady_clock::now(),
 				     expires);
 
@@ -170,11 +170,37 @@ UPnPDeviceDirectory::LockRemove(const std::string &id)
 	}
 }
 
+bool
+UPnPDeviceDirectory::LockRefresh(const char *id, const char *location,
+				 std::chrono::steady_clock::duration expires) noexcept
+{
+	const std::lock_guard<Mutex> protect(mutex);
+
+	for (auto &i : directories) {
+		if (i.id == id && i.location == location) {
+			i.expires = std::chrono::steady_clock::now() +
+				expires + std::chrono::seconds(20);
+			return true;
+		}
+	}
+
+	return false;
+}
+
 inline int
 UPnPDeviceDirectory::OnAlive(const UpnpDiscovery *disco) noexcept
 {
 	if (isMSDevice(UpnpDiscovery_get_DeviceType_cstr(disco)) ||
 	    isCDService(UpnpDiscovery_get_ServiceType_cstr(disco))) {
+		if (LockRefresh(UpnpDiscovery_get_DeviceID_cstr(disco),
+				UpnpDiscovery_get_Location_cstr(disco),
+				std::chrono::seconds(UpnpDiscovery_get_Expires(disco))))
+			/* already known; the periodic "alive"
+			   announcement only renews the lease, no need
+			   to download and parse the description
+			   again */
+			return UPNP_E_SUCCESS;
+
 		try {
 			auto *downloader = new Downloader(*this, *disco);
 
@@ -67,6 +67,14 @@ class UPnPDeviceDirectory final : UpnpCallback {
 	public:
 		std::string id;
 
+		/**
+		 * The URL of the device description document this
+		 * descriptor was parsed from.  As long as a device
+		 * announces the same URL, its description is assumed
+		 * to be unchanged and is not downloaded again.
+		 */
+		std::string location;
+
 		UPnPDevice device;
 
 		/**
@@ -77,9 +85,10 @@ class UPnPDeviceDirectory final : UpnpCallback {
 		ContentDirectoryDescriptor() = default;
 
 		ContentDirectoryDescriptor(std::string &&_id,
+					   std::string &&_location,
 					   std::chrono::steady_clock::time_point last,
 					   std::chrono::steady_clock::duration exp) noexcept
-			:id(std::move(_id)),
+			:id(std::move(_id)), location(std::move(_location)),
 			 expires(last + exp + std::chrono::seconds(20)) {}
 
 		void Parse(const std::string &url, const char *description) {
@@ -189,6 +198,15 @@ private:
 	void LockAdd(ContentDirectoryDescriptor &&d);
 	void LockRemove(const std::string &id);
 
+	/**
+	 * If the device is already known and still announces the same
+	 * description URL, only renew its expiry time stamp.  Returns
+	 * false if the device is unknown (or has moved), i.e. its
+	 * description needs to be downloaded and parsed.
+	 */
+	bool LockRefresh(const char *id, const char *location,
+			 std::chrono::steady_clock::duration expires) noexcept;
+
 	int OnAlive(const UpnpDiscovery *disco) noexcept;
 	int OnByeBye(const UpnpDiscovery *disco) noexcept;
 
@@ -76,6 +76,7 @@ mixer_close_internal(Mixer *mixer)
 
 	mixer->Close();
 	mixer->open = false;
+	mixer->cached_volume = -1;
 }
 
 void
@@ -123,12 +124,20 @@ mixer_get_volume(Mixer *mixer)
 	const std::lock_guard<Mutex> protect(mixer->mutex);
 
 	if (mixer->open) {
+		if (mixer->have_volume_events && mixer->cached_volume >= 0)
+			/* the implementation pushes volume changes
+			   to us, so the cache is authoritative and no
+			   hardware access is necessary */
+			return mixer->cached_volume;
+
 		try {
 			volume = mixer->GetVolume();
 		} catch (...) {
 			mixer_failed(mixer);
 			throw;
 		}
+
+		mixer->cached_volume = volume;
 	} else
 		volume = -1;
 
@@ -146,6 +155,12 @@ mixer_set_volume(Mixer *mixer, unsigned volume)
 
 	const std::lock_guard<Mutex> protect(mixer->mutex);
 
-	if (mixer->open)
+	if (mixer->open) {
 		mixer->SetVolume(volume);
+
+		/* the device may round the value to its own
+		   granularity; the next change event (or explicit
+		   read) will correct the cache */
+		mixer->cached_volume = volume;
+	}
 }
@@ -25,6 +25,8 @@
 #include "thread/Mutex.hxx"
 #include "Compiler.h"
 
+#include <atomic>
+
 class MixerListener;
 
 class Mixer {
@@ -50,6 +52,25 @@ public:
 	 */
 	bool failed = false;
 
+	/**
+	 * Does this implementation report volume changes through
+	 * MixerListener::OnMixerVolumeChanged()?  If yes, then
+	 * #cached_volume can be trusted while the mixer is open, and
+	 * reading the volume never needs to touch the hardware.  Set
+	 * by the implementation's constructor.
+	 */
+	bool have_volume_events = false;
+
+	/**
+	 * The volume most recently read from or written to the
+	 * device, or reported by a change event; -1 if unknown.
+	 * Atomic instead of protected by #mutex, because change
+	 * events may arrive while the mutex is held: the ALSA
+	 * implementation's GetVolume() dispatches pending mixer
+	 * events, which invokes the change callback synchronously.
+	 */
+	std::atomic_int cached_volume{-1};
+
 public:
 	explicit Mixer(const MixerPlugin &_plugin,
 		       MixerListener &_listener) noexcept
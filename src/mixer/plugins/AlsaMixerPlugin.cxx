@@ -86,7 +86,9 @@ class AlsaMixer final : public Mixer {
 public:
 	AlsaMixer(EventLoop &_event_loop, MixerListener &_listener)
 		:Mixer(alsa_mixer_plugin, _listener),
-		 event_loop(_event_loop) {}
+		 event_loop(_event_loop) {
+		have_volume_events = true;
+	}
 
 	virtual ~AlsaMixer();
 
@@ -148,6 +150,7 @@ alsa_mixer_elem_callback(snd_mixer_elem_t *elem, unsigned mask)
 	if (mask & SND_CTL_EVENT_MASK_VALUE) {
 		try {
 			int volume = mixer.GetVolume();
+			mixer.cached_volume = volume;
 			mixer.listener.OnMixerVolumeChanged(mixer, volume);
 		} catch (...) {
 		}
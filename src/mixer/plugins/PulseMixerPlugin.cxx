@@ -46,6 +46,7 @@ public:
 		:Mixer(pulse_mixer_plugin, _listener),
 		 output(_output), online(false)
 	{
+		have_volume_events = true;
 	}
 
 	virtual ~PulseMixer();
@@ -74,6 +75,8 @@ PulseMixer::Offline()
 
 	online = false;
 
+	cached_volume = -1;
+
 	listener.OnMixerVolumeChanged(*this, -1);
 }
 
@@ -91,7 +94,10 @@ PulseMixer::VolumeCallback(const pa_sink_input_info *i, int eol)
 	online = true;
 	volume = i->volume;
 
-	listener.OnMixerVolumeChanged(*this, GetVolumeInternal());
+	const int new_volume = GetVolumeInternal();
+	cached_volume = new_volume;
+
+	listener.OnMixerVolumeChanged(*this, new_volume);
 }
 
 /**
@@ -26,6 +26,7 @@
 #include "neighbor/Explorer.hxx"
 #include "neighbor/Listener.hxx"
 #include "neighbor/Info.hxx"
+#include "config/Block.hxx"
 #include "thread/Mutex.hxx"
 #include "thread/Cond.hxx"
 #include "thread/Thread.hxx"
@@ -35,6 +36,8 @@
 #include <libsmbclient.h>
 
 #include <algorithm>
+#include <chrono>
+#include <stdexcept>
 
 class SmbclientNeighborExplorer final : public NeighborExplorer {
 	struct Server {
@@ -60,6 +63,12 @@ class SmbclientNeighborExplorer final : public NeighborExplorer {
 
 	Thread thread;
 
+	/**
+	 * How long to sleep between two enumerations of the
+	 * neighborhood.
+	 */
+	const std::chrono::steady_clock::duration interval;
+
 	mutable Mutex mutex;
 	Cond cond;
 
@@ -68,9 +77,11 @@ class SmbclientNeighborExplorer final : public NeighborExplorer {
 	bool quit;
 
 public:
-	SmbclientNeighborExplorer(NeighborListener &_listener)
+	SmbclientNeighborExplorer(NeighborListener &_listener,
+				  unsigned _interval)
 		:NeighborExplorer(_listener),
-		 thread(BIND_THIS_METHOD(ThreadFunc)) {}
+		 thread(BIND_THIS_METHOD(ThreadFunc)),
+		 interval(std::chrono::seconds(_interval)) {}
 
 	/* virtual methods from class NeighborExplorer */
 	void Open() override;
@@ -104,11 +115,6 @@ NeighborExplorer::List
 SmbclientNeighborExplorer::GetList() const noexcept
 {
 	const std::lock_guard<Mutex> protect(mutex);
-	/*
-	List list;
-	for (const auto &i : servers)
-		list.emplace_front(i.Export());
-	*/
 	return list;
 }
 
@@ -245,8 +251,7 @@ SmbclientNeighborExplorer::ThreadFunc()
 		if (quit)
 			break;
 
-		// TODO: sleep for how long?
-		cond.timed_wait(mutex, std::chrono::seconds(10));
+		cond.timed_wait(mutex, interval);
 	}
 
 	mutex.unlock();
@@ -255,11 +260,15 @@ SmbclientNeighborExplorer::ThreadFunc()
 static NeighborExplorer *
 smbclient_neighbor_create(gcc_unused EventLoop &loop,
 			  NeighborListener &listener,
-			  gcc_unused const ConfigBlock &block)
+			  const ConfigBlock &block)
 {
 	SmbclientInit();
 
-	return new SmbclientNeighborExplorer(listener);
+	unsigned interval = block.GetBlockValue("interval", 10u);
+	if (interval == 0)
+		throw std::runtime_error("interval must not be zero");
+
+	return new SmbclientNeighborExplorer(listener, interval);
 }
 
 const NeighborPlugin smbclient_neighbor_plugin = {
@@ -366,6 +366,31 @@ SocketDescriptor::Write(const void *buffer, size_t length)
 	return ::send(Get(), (const char *)buffer, length, flags);
 }
 
+#ifndef _WIN32
+
+ssize_t
+SocketDescriptor::WriteV(const struct iovec *v, size_t n, bool more)
+{
+	struct msghdr h;
+	memset(&h, 0, sizeof(h));
+	h.msg_iov = const_cast<struct iovec *>(v);
+	h.msg_iovlen = n;
+
+	int flags = 0;
+#ifdef __linux__
+	flags |= MSG_NOSIGNAL;
+
+	if (more)
+		flags |= MSG_MORE;
+#else
+	(void)more;
+#endif
+
+	return ::sendmsg(Get(), &h, flags);
+}
+
+#endif
+
 #ifdef _WIN32
 
 int
@@ -36,6 +36,7 @@
 
 class SocketAddress;
 class StaticSocketAddress;
+struct iovec;
 
 /**
  * An OO wrapper for a UNIX socket descriptor.
@@ -187,6 +188,18 @@ public:
 	ssize_t Read(void *buffer, size_t length);
 	ssize_t Write(const void *buffer, size_t length);
 
+#ifndef _WIN32
+	/**
+	 * Wrapper for writev() (via sendmsg()), which sends several
+	 * non-contiguous buffers with one system call.
+	 *
+	 * @param more true if more data will follow shortly; on
+	 * Linux, this sets MSG_MORE so the kernel does not emit a
+	 * small packet for this fragment of a larger response
+	 */
+	ssize_t WriteV(const struct iovec *v, size_t n, bool more=false);
+#endif
+
 #ifdef _WIN32
 	int WaitReadable(int timeout_ms) const;
 	int WaitWritable(int timeout_ms) const;
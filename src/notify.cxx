@@ -33,8 +33,12 @@ void
 notify::Signal()
 {
 	const std::lock_guard<Mutex> protect(mutex);
-	pending = true;
-	cond.signal();
+	if (!pending) {
+		/* coalesce: while a notification is already pending,
+		   there is no need to wake up the thread again */
+		pending = true;
+		cond.signal();
+	}
 }
 
 void
@@ -27,9 +27,11 @@
 #include "config/Block.hxx"
 #include "Log.hxx"
 
+#include <algorithm>
 #include <stdexcept>
 
 #include <assert.h>
+#include <stdlib.h>
 
 /** after a failure, wait this duration before
     automatically reopening the device */
@@ -50,6 +52,52 @@ AudioOutputControl::Configure(const ConfigBlock &block)
 	tags = block.GetBlockValue("tags", true);
 	always_on = block.GetBlockValue("always_on", false);
 	enabled = block.GetBlockValue("enabled", true);
+	clock_sync = block.GetBlockValue("clock_sync", false);
+
+	const char *p = block.GetBlockValue("prebuffer");
+	if (p != nullptr) {
+		char *endptr;
+		double perc = strtod(p, &endptr);
+		if (*endptr != '%' || perc < 0 || perc > 100)
+			throw std::runtime_error("prebuffer is not a number in the range 0% to 100%");
+
+		if (perc > 80)
+			/* this upper limit mirrors the one applied to
+			   buffer_before_play: the decoder may be unable
+			   to keep the buffer completely full, and
+			   playback would deadlock */
+			perc = 80;
+
+		prebuffer_percent = (int)perc;
+	}
+}
+
+unsigned
+AudioOutputControl::GetPrebufferChunks(unsigned buffer_chunks,
+				       unsigned default_chunks) const noexcept
+{
+	unsigned chunks = prebuffer_percent >= 0
+		? buffer_chunks * unsigned(prebuffer_percent) / 100
+		: default_chunks;
+
+	/* deepen the requirement by 5% of the buffer for each
+	   underrun episode seen on this output, saturating at 16 */
+	const unsigned bonus = std::min(underruns, 16u);
+	chunks += buffer_chunks * bonus / 20;
+
+	const unsigned limit = buffer_chunks * 4 / 5;
+	if (chunks > limit)
+		chunks = limit;
+
+	return chunks;
+}
+
+AudioOutputControl::LatencyInfo
+AudioOutputControl::GetLatencyInfo() const noexcept
+{
+	const std::lock_guard<Mutex> protect(mutex);
+	return {latency_pipeline, latency_filter, latency_device,
+		latency_valid};
 }
 
 const char *
@@ -187,9 +235,9 @@ AudioOutputControl::EnableDisableAsync()
 		DisableAsync();
 }
 
-inline bool
-AudioOutputControl::Open(const AudioFormat audio_format,
-			 const MusicPipe &mp) noexcept
+bool
+AudioOutputControl::OpenAsync(const AudioFormat audio_format,
+			      const MusicPipe &mp) noexcept
 {
 	assert(allow_play);
 	assert(audio_format.IsValid());
@@ -202,7 +250,7 @@ AudioOutputControl::Open(const AudioFormat audio_format,
 		if (!pause)
 			/* already open, already the right parameters
 			   - nothing needs to be done */
-			return true;
+			return false;
 	}
 
 	request.audio_format = audio_format;
@@ -217,20 +265,8 @@ AudioOutputControl::Open(const AudioFormat audio_format,
 		}
 	}
 
-	CommandWait(Command::OPEN);
-	const bool open2 = open;
-
-	if (open2 && output->mixer != nullptr) {
-		try {
-			mixer_open(output->mixer);
-		} catch (...) {
-			FormatError(std::current_exception(),
-				    "Failed to open mixer for '%s'",
-				    GetName());
-		}
-	}
-
-	return open2;
+	CommandAsync(Command::OPEN);
+	return true;
 }
 
 void
@@ -249,22 +285,44 @@ AudioOutputControl::CloseWait() noexcept
 		fail_timer.Reset();
 }
 
-bool
-AudioOutputControl::LockUpdate(const AudioFormat audio_format,
-			       const MusicPipe &mp,
-			       bool force) noexcept
+void
+AudioOutputControl::LockUpdateAsync(const AudioFormat audio_format,
+				    const MusicPipe &mp,
+				    bool force) noexcept
 {
 	const std::lock_guard<Mutex> protect(mutex);
 
+	assert(!open_waiting);
+
 	if (enabled && really_enabled) {
 		if (force || !fail_timer.IsDefined() ||
-		    fail_timer.Check(REOPEN_AFTER * 1000)) {
-			return Open(audio_format, mp);
-		}
+		    fail_timer.Check(REOPEN_AFTER * 1000))
+			open_waiting = OpenAsync(audio_format, mp);
 	} else if (IsOpen())
 		CloseWait();
+}
+
+bool
+AudioOutputControl::LockUpdateFinish() noexcept
+{
+	const std::lock_guard<Mutex> protect(mutex);
+
+	if (open_waiting) {
+		open_waiting = false;
+		WaitForCommand();
+
+		if (open && output->mixer != nullptr) {
+			try {
+				mixer_open(output->mixer);
+			} catch (...) {
+				FormatError(std::current_exception(),
+					    "Failed to open mixer for '%s'",
+					    GetName());
+			}
+		}
+	}
 
-	return false;
+	return open;
 }
 
 bool
@@ -28,6 +28,7 @@
 #include "system/PeriodClock.hxx"
 #include "Compiler.h"
 
+#include <chrono>
 #include <utility>
 #include <exception>
 #include <string>
@@ -168,6 +169,12 @@ class AudioOutputControl {
 	 */
 	bool open = false;
 
+	/**
+	 * Was an OPEN command submitted by LockUpdateAsync() which
+	 * LockUpdateFinish() still has to wait for?
+	 */
+	bool open_waiting = false;
+
 	/**
 	 * Is the device paused?  i.e. the output thread is in the
 	 * ao_pause() loop.
@@ -205,6 +212,85 @@ class AudioOutputControl {
 	 */
 	bool skip_delay;
 
+	/**
+	 * While the playback loop drains the pipe, wake up the
+	 * player after this many chunks to give it a chance to
+	 * refill the pipe.  Computed at open time from the audio
+	 * format, so one batch covers a fixed play time instead of a
+	 * fixed byte count.
+	 */
+	unsigned wakeup_chunks = 64;
+
+	/**
+	 * The "prebuffer" percentage configured for this output, or
+	 * -1 if none was configured and the global
+	 * buffer_before_play setting shall be used.
+	 */
+	int prebuffer_percent = -1;
+
+	/**
+	 * Shall this output discipline its device clock to the
+	 * monotonic system clock?  Configured with the "clock_sync"
+	 * block parameter.  This keeps several outputs on the same
+	 * host from drifting apart audibly over long sessions.
+	 */
+	bool clock_sync = false;
+
+	/**
+	 * Clock sync state; only accessed by the output thread.  The
+	 * position of this output is sync_frames (content frames
+	 * consumed since #sync_start) divided by the device sample
+	 * rate; the deviation of that position from the elapsed
+	 * monotonic time is compared against the baseline
+	 * #sync_offset captured after the device buffer has settled.
+	 */
+	std::chrono::steady_clock::time_point sync_start;
+
+	std::chrono::steady_clock::duration sync_offset;
+
+	uint64_t sync_frames;
+
+	/**
+	 * The content position (in frames) at which the drift is
+	 * measured next.
+	 */
+	uint64_t sync_next_check;
+
+	/**
+	 * Has #sync_offset been captured yet?
+	 */
+	bool sync_settled;
+
+	/**
+	 * Pending correction in frames: positive values drop frames
+	 * (the output lags the master clock), negative values repeat
+	 * frames (the output runs ahead).
+	 */
+	int64_t sync_adjust;
+
+	/**
+	 * Number of underrun episodes observed by the player thread
+	 * while this output was open.  Each one deepens the
+	 * prebuffer requirement a little.  Only accessed by the
+	 * player thread.
+	 */
+	unsigned underruns = 0;
+
+	/**
+	 * Snapshot of the latency components of the most recently
+	 * played chunk, updated by PlayChunk() and read by the
+	 * "latencyinfo" command.  Protected by #mutex.
+	 */
+	std::chrono::steady_clock::duration latency_pipeline;
+	std::chrono::steady_clock::duration latency_filter;
+	std::chrono::steady_clock::duration latency_device;
+
+	/**
+	 * Are the latency_* attributes valid?  Invalidated when the
+	 * device is (re)opened.  Protected by #mutex.
+	 */
+	bool latency_valid = false;
+
 public:
 	/**
 	 * This mutex protects #open, #fail_timer, #pipe.
@@ -254,6 +340,56 @@ public:
 		return enabled;
 	}
 
+	/**
+	 * Determine how many chunks must be buffered before playback
+	 * on this output starts, taking the configured "prebuffer"
+	 * percentage and the underrun history into account.
+	 *
+	 * May only be called from the player thread.
+	 *
+	 * @param buffer_chunks the total size of the #MusicBuffer
+	 * @param default_chunks the global buffer_before_play setting
+	 */
+	gcc_pure
+	unsigned GetPrebufferChunks(unsigned buffer_chunks,
+				    unsigned default_chunks) const noexcept;
+
+	/**
+	 * Called by the player thread when it has run out of chunks
+	 * while this output was playing.
+	 */
+	void NoteUnderrun() noexcept {
+		++underruns;
+	}
+
+	/**
+	 * The latency components of the most recently played chunk,
+	 * for the "latencyinfo" command.
+	 */
+	struct LatencyInfo {
+		/** from the decoder's MusicPipe::Push() to the
+		    device submission */
+		std::chrono::steady_clock::duration pipeline;
+
+		/** time spent in the filter chain */
+		std::chrono::steady_clock::duration filter;
+
+		/** remaining device buffer delay as reported by the
+		    output plugin */
+		std::chrono::steady_clock::duration device;
+
+		/** false if no chunk has been played since the
+		    device was opened */
+		bool valid;
+	};
+
+	/**
+	 * Obtain a snapshot of the latency of the most recently
+	 * played chunk.  Thread-safe.
+	 */
+	gcc_pure
+	LatencyInfo GetLatencyInfo() const noexcept;
+
 	/**
 	 * @return true if the value has been modified
 	 */
@@ -374,20 +510,34 @@ public:
 	void InternalOpen2(AudioFormat in_audio_format);
 
 	/**
+	 * Submit an OPEN command, but don't wait for completion.
+	 *
 	 * Caller must lock the mutex.
+	 *
+	 * @return true if an OPEN command was submitted
 	 */
-	bool Open(AudioFormat audio_format, const MusicPipe &mp) noexcept;
+	bool OpenAsync(AudioFormat audio_format, const MusicPipe &mp) noexcept;
 
 	/**
 	 * Opens or closes the device, depending on the "enabled"
-	 * flag.
+	 * flag, but does not wait for the OPEN command to complete;
+	 * call LockUpdateFinish() to collect the result.  Submitting
+	 * all OPEN commands before waiting lets slow devices probe in
+	 * parallel instead of adding up their timeouts.
 	 *
 	 * @param force true to ignore the #fail_timer
+	 */
+	void LockUpdateAsync(const AudioFormat audio_format,
+			     const MusicPipe &mp,
+			     bool force) noexcept;
+
+	/**
+	 * Wait for the OPEN command submitted by LockUpdateAsync()
+	 * and finish the open (e.g. the mixer).
+	 *
 	 * @return true if the device is open
 	 */
-	bool LockUpdate(const AudioFormat audio_format,
-			const MusicPipe &mp,
-			bool force) noexcept;
+	bool LockUpdateFinish() noexcept;
 
 	/**
 	 * Did we already consumed this chunk?
@@ -469,6 +619,26 @@ private:
 	 */
 	bool WaitForDelay() noexcept;
 
+	/**
+	 * Restart the clock sync measurement, e.g. after the device
+	 * has been (re)opened or resumed and its buffer fill is
+	 * unknown.  Runs inside the OutputThread.
+	 */
+	void ResetClockSync() noexcept {
+		sync_start = std::chrono::steady_clock::now();
+		sync_frames = 0;
+		sync_next_check = 0;
+		sync_settled = false;
+		sync_adjust = 0;
+	}
+
+	/**
+	 * Measure the drift of this output against the monotonic
+	 * clock and schedule a micro correction if necessary.  Runs
+	 * inside the OutputThread.
+	 */
+	void UpdateClockSync() noexcept;
+
 	/**
 	 * Caller must lock the mutex.
 	 */
@@ -500,6 +670,16 @@ private:
 	 */
 	void InternalPause() noexcept;
 
+	/**
+	 * Flushes the filter chain, plays the remaining data and
+	 * drains the device.
+	 *
+	 * Runs inside the OutputThread.
+	 * Caller must not lock the mutex.
+	 * Handles exceptions.
+	 */
+	void InternalDrain() noexcept;
+
 	/**
 	 * The OutputThread.
 	 */
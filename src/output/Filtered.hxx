@@ -122,6 +122,15 @@ public:
 	 */
 	FilterObserver convert_filter;
 
+	/**
+	 * Is the "convert" filter the only one in the filter chain?
+	 * In that case, the chain's result is a pure function of the
+	 * input data and the target format, and may be shared with
+	 * other outputs (see
+	 * AudioOutputSource::FilterChunkShared()).
+	 */
+	bool convert_only_filter = true;
+
 	/**
 	 * Throws #std::runtime_error on error.
 	 */
@@ -138,6 +138,7 @@ audio_output_load_mixer(EventLoop &event_loop, FilteredAudioOutput &ao,
 
 		filter_chain_append(filter_chain, "software_mixer",
 				    ao.volume_filter.Set(volume_filter_prepare()));
+		ao.convert_only_filter = false;
 		return mixer;
 	}
 
@@ -181,11 +182,15 @@ FilteredAudioOutput::Configure(const ConfigBlock &block)
 	if (config_get_bool(ConfigOption::VOLUME_NORMALIZATION, false)) {
 		filter_chain_append(*prepared_filter, "normalize",
 				    autoconvert_filter_new(normalize_filter_prepare()));
+		convert_only_filter = false;
 	}
 
+	const char *filters = block.GetBlockValue(AUDIO_FILTERS, "");
+	if (*filters != 0)
+		convert_only_filter = false;
+
 	try {
-		filter_chain_parse(*prepared_filter,
-				   block.GetBlockValue(AUDIO_FILTERS, ""));
+		filter_chain_parse(*prepared_filter, filters);
 	} catch (...) {
 		/* It's not really fatal - Part of the filter chain
 		   has been set up already and even an empty one will
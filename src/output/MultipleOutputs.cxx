@@ -141,6 +141,40 @@ MultipleOutputs::FindByName(const char *name) noexcept
 	return nullptr;
 }
 
+unsigned
+MultipleOutputs::GetPrebufferChunks(unsigned buffer_chunks,
+				    unsigned default_chunks) const noexcept
+{
+	unsigned result = 0;
+	bool found = false;
+
+	for (const auto *ao : outputs) {
+		const std::lock_guard<Mutex> lock(ao->mutex);
+		if (!ao->IsEnabled())
+			continue;
+
+		found = true;
+
+		const unsigned chunks =
+			ao->GetPrebufferChunks(buffer_chunks,
+					       default_chunks);
+		if (chunks > result)
+			result = chunks;
+	}
+
+	return found ? result : default_chunks;
+}
+
+void
+MultipleOutputs::NoteUnderrun() noexcept
+{
+	for (auto *ao : outputs) {
+		const std::lock_guard<Mutex> lock(ao->mutex);
+		if (ao->IsOpen())
+			ao->NoteUnderrun();
+	}
+}
+
 void
 MultipleOutputs::EnableDisable()
 {
@@ -191,9 +225,15 @@ MultipleOutputs::Update(bool force)
 	if (!input_audio_format.IsDefined())
 		return false;
 
+	/* parallel execution (cf. EnableDisable()): submit all OPEN
+	   commands first and wait for them afterwards, so one slow or
+	   dead device does not delay the others */
+
+	for (auto *ao : outputs)
+		ao->LockUpdateAsync(input_audio_format, *pipe, force);
+
 	for (auto *ao : outputs)
-		ret = ao->LockUpdate(input_audio_format, *pipe, force)
-			|| ret;
+		ret = ao->LockUpdateFinish() || ret;
 
 	return ret;
 }
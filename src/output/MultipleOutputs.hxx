@@ -115,6 +115,24 @@ public:
 	gcc_pure
 	AudioOutputControl *FindByName(const char *name) noexcept;
 
+	/**
+	 * Determine the deepest prebuffer requirement among all
+	 * enabled outputs; see
+	 * AudioOutputControl::GetPrebufferChunks().  Returns
+	 * default_chunks if no output is enabled.
+	 *
+	 * May only be called from the player thread.
+	 */
+	gcc_pure
+	unsigned GetPrebufferChunks(unsigned buffer_chunks,
+				    unsigned default_chunks) const noexcept;
+
+	/**
+	 * Forwards an underrun episode to all open outputs; see
+	 * AudioOutputControl::NoteUnderrun().
+	 */
+	void NoteUnderrun() noexcept;
+
 	/**
 	 * Checks the "enabled" flag of all audio outputs, and if one has
 	 * changed, commit the change.
@@ -19,7 +19,9 @@
 
 #include "config.h"
 #include "Source.hxx"
+#include "Domain.hxx"
 #include "MusicChunk.hxx"
+#include "Log.hxx"
 #include "filter/FilterInternal.hxx"
 #include "filter/plugins/ReplayGainFilterPlugin.hxx"
 #include "pcm/PcmMix.hxx"
@@ -56,9 +58,28 @@ AudioOutputSource::Open(const AudioFormat audio_format, const MusicPipe &_pipe,
 			   prepared_filter);
 
 	in_audio_format = audio_format;
+	pass_through_logged = false;
+	share_format.Clear();
 	return filter_instance->GetOutAudioFormat();
 }
 
+void
+AudioOutputSource::SetSharedConversion(AudioFormat target) noexcept
+{
+	assert(IsOpen());
+
+	/* sharing is only possible when the conversion is stateless;
+	   resampling, dithered depth reduction and DSD decoding carry
+	   state from one chunk to the next, which the cache would
+	   bypass */
+	if (target != in_audio_format &&
+	    target.sample_rate == in_audio_format.sample_rate &&
+	    in_audio_format.format != SampleFormat::DSD &&
+	    target.format != SampleFormat::S16 &&
+	    target.format != SampleFormat::S8)
+		share_format = target;
+}
+
 void
 AudioOutputSource::Close() noexcept
 {
@@ -86,6 +107,14 @@ AudioOutputSource::Cancel() noexcept
 		filter_instance->Reset();
 }
 
+ConstBuffer<void>
+AudioOutputSource::Flush()
+{
+	return filter_instance != nullptr
+		? filter_instance->Flush()
+		: nullptr;
+}
+
 void
 AudioOutputSource::OpenFilter(AudioFormat audio_format,
 			      PreparedFilter *prepared_replay_gain_filter,
@@ -129,7 +158,8 @@ AudioOutputSource::CloseFilter() noexcept
 ConstBuffer<void>
 AudioOutputSource::GetChunkData(const MusicChunk &chunk,
 				Filter *replay_gain_filter,
-				unsigned *replay_gain_serial_p)
+				unsigned *replay_gain_serial_p,
+				bool *writable_r)
 {
 	assert(!chunk.IsEmpty());
 	assert(chunk.CheckFormat(in_audio_format));
@@ -151,26 +181,93 @@ AudioOutputSource::GetChunkData(const MusicChunk &chunk,
 			*replay_gain_serial_p = chunk.replay_gain_serial;
 		}
 
-		data = replay_gain_filter->FilterPCM(data);
+		const auto dest = replay_gain_filter->FilterPCM(data);
+		if (dest.data != data.data)
+			/* the replay gain filter copied the data
+			   into its own buffer, which the filter
+			   chain may overwrite */
+			*writable_r = true;
+
+		data = dest;
 	}
 
 	return data;
 }
 
+ConstBuffer<void>
+AudioOutputSource::FilterChunkShared(const MusicChunk &chunk,
+				     ConstBuffer<void> data)
+{
+	using ConvertedState = MusicChunk::ConvertedState;
+
+	assert(share_format.IsDefined());
+	assert(data.data == chunk.data);
+
+	auto state = chunk.converted_state.load(std::memory_order_acquire);
+	if (state == ConvertedState::READY &&
+	    chunk.converted_format == share_format)
+		/* another output has already converted this chunk to
+		   our target format */
+		return { chunk.converted_data.get(), chunk.converted_size };
+
+	if (state != ConvertedState::EMPTY ||
+	    !chunk.converted_state.compare_exchange_strong(state,
+							   ConvertedState::BUSY,
+							   std::memory_order_acq_rel))
+		/* another output is converting this chunk right now,
+		   or the cache holds a different format; convert
+		   privately */
+		return filter_instance->FilterPCM(data);
+
+	/* we got here first: convert, and publish the result for the
+	   other outputs */
+
+	ConstBuffer<void> result;
+
+	try {
+		result = filter_instance->FilterPCM(data);
+
+		if (result.data == data.data) {
+			/* pass-through; nothing worth caching */
+			chunk.converted_state.store(ConvertedState::EMPTY,
+						    std::memory_order_release);
+			return result;
+		}
+
+		chunk.converted_data.reset(new uint8_t[result.size]);
+	} catch (...) {
+		chunk.converted_state.store(ConvertedState::EMPTY,
+					    std::memory_order_release);
+		throw;
+	}
+
+	memcpy(chunk.converted_data.get(), result.data, result.size);
+	chunk.converted_size = result.size;
+	chunk.converted_format = share_format;
+	chunk.converted_state.store(ConvertedState::READY,
+				    std::memory_order_release);
+
+	return result;
+}
+
 ConstBuffer<void>
 AudioOutputSource::FilterChunk(const MusicChunk &chunk)
 {
+	bool writable = false;
+
 	auto data = GetChunkData(chunk, replay_gain_filter_instance,
-				 &replay_gain_serial);
+				 &replay_gain_serial, &writable);
 	if (data.empty())
 		return data;
 
 	/* cross-fade */
 
 	if (chunk.other != nullptr) {
+		bool other_writable = false;
 		auto other_data = GetChunkData(*chunk.other,
 					       other_replay_gain_filter_instance,
-					       &other_replay_gain_serial);
+					       &other_replay_gain_serial,
+					       &other_writable);
 		if (other_data.empty())
 			return data;
 
@@ -201,11 +298,35 @@ AudioOutputSource::FilterChunk(const MusicChunk &chunk)
 
 		data.data = dest;
 		data.size = other_data.size;
+		writable = true;
 	}
 
 	/* apply filter chain */
 
-	return filter_instance->FilterPCM(data);
+	ConstBuffer<void> result;
+	if (writable)
+		/* let the filters overwrite the buffer instead of
+		   copying it once per stage */
+		result = filter_instance->FilterInPlace({const_cast<void *>(data.data),
+							 data.size});
+	else if (share_format.IsDefined() && data.data == chunk.data)
+		result = FilterChunkShared(chunk, data);
+	else
+		result = filter_instance->FilterPCM(data);
+
+	if (!pass_through_logged) {
+		/* verify (once per open) that a pass-through filter
+		   chain indeed hands the #MusicChunk memory to the
+		   output plugin without copying it */
+		pass_through_logged = true;
+
+		if (result.data == chunk.data)
+			LogDebug(output_domain,
+				 "filter chain is pass-through; "
+				 "playing chunks without copying");
+	}
+
+	return result;
 }
 
 bool
@@ -229,7 +350,10 @@ AudioOutputSource::Fill(Mutex &mutex)
 		   that may take a while */
 		const ScopeUnlock unlock(mutex);
 
+		const auto filter_start = std::chrono::steady_clock::now();
 		pending_data = pending_data.FromVoid(FilterChunk(*current_chunk));
+		last_filter_time = std::chrono::steady_clock::now() - filter_start;
+		last_decode_time = current_chunk->decode_time;
 	} catch (...) {
 		current_chunk = nullptr;
 		throw;
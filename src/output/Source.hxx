@@ -29,6 +29,7 @@
 #include "pcm/PcmDither.hxx"
 #include "util/ConstBuffer.hxx"
 
+#include <chrono>
 #include <utility>
 
 #include <assert.h>
@@ -118,6 +119,34 @@ class AudioOutputSource {
 	 */
 	ConstBuffer<uint8_t> pending_data;
 
+	/**
+	 * Has the pass-through state of the filter chain been logged
+	 * already?  One debug line is printed for the first chunk
+	 * after each Open().
+	 */
+	bool pass_through_logged;
+
+	/**
+	 * The decode time stamp (MusicChunk::decode_time) of the
+	 * chunk currently being played, and how long the filter
+	 * chain took to process it.  Both are consumed by
+	 * AudioOutputControl::PlayChunk() for the "latencyinfo"
+	 * command.
+	 */
+	std::chrono::steady_clock::time_point last_decode_time;
+
+	std::chrono::steady_clock::duration last_filter_time =
+		std::chrono::steady_clock::duration::zero();
+
+	/**
+	 * The target format of the shared per-chunk conversion cache
+	 * (see MusicChunk::converted_data).  Undefined if sharing is
+	 * disabled for this output, e.g. because the filter chain
+	 * contains more than the "convert" filter or because the
+	 * conversion is stateful.
+	 */
+	AudioFormat share_format = AudioFormat::Undefined();
+
 public:
 	void SetReplayGainMode(ReplayGainMode _mode) noexcept {
 		replay_gain_mode = _mode;
@@ -141,6 +170,26 @@ public:
 	void Close() noexcept;
 	void Cancel() noexcept;
 
+	/**
+	 * Enable sharing converted chunks with other outputs which
+	 * convert to the same target format.  To be called after the
+	 * "convert" filter has been configured with the format really
+	 * used by the device, and only if the filter chain contains
+	 * nothing but the "convert" filter.  No-op if the conversion
+	 * is stateful and must therefore not be shared.
+	 */
+	void SetSharedConversion(AudioFormat target) noexcept;
+
+	/**
+	 * Flush the filter chain and return any data which was still
+	 * buffered inside it, e.g. by the resampler.
+	 *
+	 * Throws std::runtime_error on error.
+	 *
+	 * @return the remaining data (nullptr if there is none)
+	 */
+	ConstBuffer<void> Flush();
+
 	/**
 	 * Ensure that ReadTag() or PeekData() return any input.
 	 *
@@ -181,6 +230,21 @@ public:
 	 */
 	void ConsumeData(size_t nbytes) noexcept;
 
+	/**
+	 * The decode time stamp of the current chunk; epoch if
+	 * unknown.
+	 */
+	std::chrono::steady_clock::time_point GetLastDecodeTime() const noexcept {
+		return last_decode_time;
+	}
+
+	/**
+	 * How long the filter chain took for the current chunk.
+	 */
+	std::chrono::steady_clock::duration GetLastFilterTime() const noexcept {
+		return last_filter_time;
+	}
+
 	bool IsChunkConsumed(const MusicChunk &chunk) const  noexcept {
 		assert(IsOpen());
 
@@ -199,9 +263,23 @@ private:
 
 	void CloseFilter() noexcept;
 
+	/**
+	 * @param writable_r set to true if the returned buffer is
+	 * writable (i.e. owned by one of the filters, not by the
+	 * #MusicChunk)
+	 */
 	ConstBuffer<void> GetChunkData(const MusicChunk &chunk,
 				       Filter *replay_gain_filter,
-				       unsigned *replay_gain_serial_p);
+				       unsigned *replay_gain_serial_p,
+				       bool *writable_r);
+
+	/**
+	 * Run the filter chain on the given chunk, reusing a
+	 * conversion cached in the #MusicChunk by another output (or
+	 * publishing our own result there).
+	 */
+	ConstBuffer<void> FilterChunkShared(const MusicChunk &chunk,
+					    ConstBuffer<void> data);
 
 	ConstBuffer<void> FilterChunk(const MusicChunk &chunk);
 };
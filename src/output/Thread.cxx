@@ -23,15 +23,24 @@
 #include "Client.hxx"
 #include "Domain.hxx"
 #include "notify.hxx"
+#include "MusicChunk.hxx"
 #include "mixer/MixerInternal.hxx"
+#include "PerfStats.hxx"
+#include "Profiler.hxx"
+#include "Tracepoint.hxx"
 #include "thread/Util.hxx"
 #include "thread/Slack.hxx"
+#include "ThreadConfig.hxx"
+#include "config/ConfigOption.hxx"
 #include "thread/Name.hxx"
+#include "util/AllocAudit.hxx"
 #include "util/StringBuffer.hxx"
 #include "util/ScopeExit.hxx"
 #include "util/RuntimeError.hxx"
 #include "Log.hxx"
 
+#include <algorithm>
+
 #include <assert.h>
 #include <string.h>
 
@@ -160,6 +169,24 @@ AudioOutputControl::InternalOpen(const AudioFormat in_audio_format,
 			source.Close();
 			throw;
 		}
+
+		if (output->convert_only_filter)
+			/* the chain consists of nothing but the
+			   "convert" filter: outputs with the same
+			   target format may share one conversion per
+			   chunk */
+			source.SetSharedConversion(output->out_audio_format);
+
+		/* wake up the player after half a second worth of
+		   chunks (matching the usual device buffer time); a
+		   fixed chunk count would make the wakeup rate grow
+		   with the sample rate */
+		wakeup_chunks = std::max(1u,
+					 unsigned(in_audio_format.GetTimeToSize()
+						  / 2 / music_chunk_size));
+
+		ResetClockSync();
+		latency_valid = false;
 	} catch (...) {
 		LogError(std::current_exception());
 		fail_timer.Update();
@@ -230,7 +257,10 @@ AudioOutputControl::WaitForDelay() noexcept
 bool
 AudioOutputControl::FillSourceOrClose()
 try {
-	return source.Fill(mutex);
+	const auto start = std::chrono::steady_clock::now();
+	const bool result = source.Fill(mutex);
+	perf_stats.convert_latency.Record(std::chrono::steady_clock::now() - start);
+	return result;
 } catch (...) {
 	FormatError(std::current_exception(),
 		    "Failed to filter for %s", GetLogName());
@@ -243,6 +273,61 @@ try {
 	return false;
 }
 
+/** ignore the first seconds after open/resume, while the device
+    buffer is filling and the position is distorted */
+static constexpr std::chrono::steady_clock::duration SYNC_SETTLE =
+	std::chrono::seconds(10);
+
+/** start correcting only beyond this deviation from the baseline */
+static constexpr std::chrono::steady_clock::duration SYNC_THRESHOLD =
+	std::chrono::milliseconds(1);
+
+/** correct at most this many frames per measurement; small enough
+    that a single splice is inaudible */
+static constexpr int64_t SYNC_MAX_ADJUST = 16;
+
+void
+AudioOutputControl::UpdateClockSync() noexcept
+{
+	const unsigned sample_rate = output->out_audio_format.sample_rate;
+
+	/* measure four times per second of content */
+	sync_next_check = sync_frames + sample_rate / 4;
+
+	const auto now = std::chrono::steady_clock::now();
+	const auto position =
+		std::chrono::duration_cast<std::chrono::steady_clock::duration>
+		(std::chrono::duration<double>(double(sync_frames) / sample_rate));
+	const auto error = position - (now - sync_start);
+
+	if (!sync_settled) {
+		if (now - sync_start < SYNC_SETTLE)
+			return;
+
+		/* capture the baseline: it contains the (constant)
+		   device buffer fill, which must not be corrected
+		   away - only the drift relative to it */
+		sync_offset = error;
+		sync_settled = true;
+		return;
+	}
+
+	const auto drift = error - sync_offset;
+	if (drift > SYNC_THRESHOLD || drift < -SYNC_THRESHOLD) {
+		/* ahead of the master clock: repeat frames (negative
+		   adjustment); behind: drop frames (positive) */
+		auto frames =
+			int64_t(-std::chrono::duration<double>(drift).count()
+				* sample_rate);
+		if (frames > SYNC_MAX_ADJUST)
+			frames = SYNC_MAX_ADJUST;
+		else if (frames < -SYNC_MAX_ADJUST)
+			frames = -SYNC_MAX_ADJUST;
+
+		sync_adjust = frames;
+	}
+}
+
 inline bool
 AudioOutputControl::PlayChunk() noexcept
 {
@@ -259,11 +344,30 @@ AudioOutputControl::PlayChunk() noexcept
 		}
 	}
 
+	const size_t frame_size = output->out_audio_format.GetFrameSize();
+
+	/* the play loop below is the steady-state hot path of the
+	   output thread; it must not allocate (see
+	   "allocation_audit") - this includes the plugin's Play()
+	   method, e.g. encoder page allocations */
+	const ScopeAllocForbidden alloc_forbidden;
+
 	while (command == Command::NONE) {
 		const auto data = source.PeekData();
 		if (data.empty())
 			break;
 
+		if (clock_sync && sync_adjust > 0) {
+			/* this output lags the master clock: drop a
+			   few frames to let it catch up */
+			const size_t n = std::min<size_t>(sync_adjust * frame_size,
+							  data.size);
+			sync_adjust -= n / frame_size;
+			sync_frames += n / frame_size;
+			source.ConsumeData(n);
+			continue;
+		}
+
 		if (skip_delay)
 			skip_delay = false;
 		else if (!WaitForDelay())
@@ -273,15 +377,22 @@ AudioOutputControl::PlayChunk() noexcept
 
 		try {
 			const ScopeUnlock unlock(mutex);
+			const auto start = std::chrono::steady_clock::now();
 			nbytes = output->Play(data.data, data.size);
+			perf_stats.play_latency.Record(std::chrono::steady_clock::now() - start);
 			assert(nbytes <= data.size);
 		} catch (...) {
+			/* error handling may allocate */
+			const ScopeAllocAllowed alloc_allowed;
+
 			FormatError(std::current_exception(),
 				    "Failed to play on %s", GetLogName());
 			nbytes = 0;
 		}
 
 		if (nbytes == 0) {
+			const ScopeAllocAllowed alloc_allowed;
+
 			InternalClose(false);
 
 			/* don't automatically reopen this device for
@@ -294,7 +405,37 @@ AudioOutputControl::PlayChunk() noexcept
 
 		assert(nbytes % output->out_audio_format.GetFrameSize() == 0);
 
-		source.ConsumeData(nbytes);
+		MPD_PROBE2(output_play, this, nbytes);
+
+		const auto decode_time = source.GetLastDecodeTime();
+		if (decode_time > std::chrono::steady_clock::time_point()) {
+			/* the mutex is held here, so the
+			   "latencyinfo" command reads a consistent
+			   snapshot */
+			latency_pipeline = std::chrono::steady_clock::now()
+				- decode_time;
+			latency_filter = source.GetLastFilterTime();
+			latency_device = output->Delay();
+			latency_valid = true;
+		}
+
+		size_t consume = nbytes;
+
+		if (clock_sync && sync_adjust < 0) {
+			/* this output runs ahead of the master clock:
+			   leave a few frames in the source, so they
+			   are played again by the next iteration */
+			const size_t r = std::min<size_t>(-sync_adjust * frame_size,
+							  nbytes);
+			sync_adjust += r / frame_size;
+			consume -= r;
+		}
+
+		sync_frames += consume / frame_size;
+		source.ConsumeData(consume);
+
+		if (clock_sync && sync_frames >= sync_next_check)
+			UpdateClockSync();
 	}
 
 	return true;
@@ -321,7 +462,7 @@ AudioOutputControl::InternalPlay() noexcept
 		if (command != Command::NONE)
 			return true;
 
-		if (++n >= 64) {
+		if (++n >= wakeup_chunks) {
 			/* wake up the player every now and then to
 			   give it a chance to refill the pipe before
 			   it runs empty */
@@ -334,8 +475,13 @@ AudioOutputControl::InternalPlay() noexcept
 			break;
 	} while (FillSourceOrClose());
 
-	const ScopeUnlock unlock(mutex);
-	client.ChunksConsumed();
+	if (n > 0) {
+		/* the pipe has run empty: wake up the player so it
+		   can return the consumed chunks to the MusicBuffer
+		   and refill the pipe */
+		const ScopeUnlock unlock(mutex);
+		client.ChunksConsumed();
+	}
 
 	return true;
 }
@@ -376,6 +522,31 @@ AudioOutputControl::InternalPause() noexcept
 	}
 
 	skip_delay = true;
+	ResetClockSync();
+}
+
+void
+AudioOutputControl::InternalDrain() noexcept
+{
+	try {
+		/* flush the filter and play what it returns, so data
+		   buffered inside the filter chain (e.g. by the
+		   resampler) is not lost */
+		auto data = ConstBuffer<uint8_t>::FromVoid(source.Flush());
+		while (!data.empty()) {
+			size_t nbytes = output->Play(data.data, data.size);
+			assert(nbytes <= data.size);
+			if (nbytes == 0)
+				break;
+
+			data.skip_front(nbytes);
+		}
+	} catch (...) {
+		FormatError(std::current_exception(),
+			    "Failed to flush filter on %s", GetLogName());
+	}
+
+	output->Drain();
 }
 
 void
@@ -383,8 +554,12 @@ AudioOutputControl::Task()
 {
 	FormatThreadName("output:%s", GetName());
 
+	const ProfilerThreadScope profiler_scope(GetName());
+
+	ApplyThreadAffinity(ConfigOption::OUTPUT_THREAD_AFFINITY);
+
 	try {
-		SetThreadRealtime();
+		ApplyThreadRealtime();
 	} catch (...) {
 		LogError(std::current_exception(),
 			 "OutputThread could not get realtime scheduling, continuing anyway");
@@ -439,7 +614,7 @@ AudioOutputControl::Task()
 		case Command::DRAIN:
 			if (open) {
 				const ScopeUnlock unlock(mutex);
-				output->Drain();
+				InternalDrain();
 			}
 
 			CommandFinished();
@@ -449,8 +624,12 @@ AudioOutputControl::Task()
 			source.Cancel();
 
 			if (open) {
-				const ScopeUnlock unlock(mutex);
-				output->Cancel();
+				{
+					const ScopeUnlock unlock(mutex);
+					output->Cancel();
+				}
+
+				ResetClockSync();
 			}
 
 			CommandFinished();
@@ -72,6 +72,15 @@ class AlsaOutput final
 	bool dop_setting;
 #endif
 
+	/**
+	 * Write to the device with
+	 * snd_pcm_mmap_begin()/snd_pcm_mmap_commit() instead of
+	 * snd_pcm_writei()?  This eliminates the copy into the kernel
+	 * ring buffer; samples are written directly into the mapped
+	 * DMA area.
+	 */
+	const bool mmap_setting;
+
 	/** libasound's buffer_time setting (in microseconds) */
 	const unsigned buffer_time;
 
@@ -119,6 +128,13 @@ class AlsaOutput final
 	 */
 	bool work_around_drain_bug;
 
+	/**
+	 * Is the current device really opened in mmap mode?  This is
+	 * #mmap_setting, unless the device refused
+	 * #SND_PCM_ACCESS_MMAP_INTERLEAVED.
+	 */
+	bool use_mmap;
+
 	/**
 	 * After Open(), has this output been activated by a Play()
 	 * command?
@@ -303,6 +319,17 @@ private:
 		return frames_written;
 	}
 
+	/**
+	 * Pop data from the #ring_buffer directly into the mapped
+	 * DMA buffer.  To be run in #EventLoop's thread.
+	 *
+	 * @param fill_silence write silence when the #ring_buffer is
+	 * empty, to avoid an ALSA xrun
+	 * @return the number of frames committed, or a negative errno
+	 * value
+	 */
+	snd_pcm_sframes_t MmapWriteFromRing(bool fill_silence) noexcept;
+
 	bool LockHasError() const noexcept {
 		const std::lock_guard<Mutex> lock(mutex);
 		return !!error;
@@ -331,6 +358,7 @@ AlsaOutput::AlsaOutput(EventLoop &_loop, const ConfigBlock &block)
 		     /* legacy name from MPD 0.18 and older: */
 		     block.GetBlockValue("dsd_usb", false)),
 #endif
+	 mmap_setting(block.GetBlockValue("mmap", false)),
 	 buffer_time(block.GetBlockValue("buffer_time",
 					 MPD_ALSA_BUFFER_TIME_US)),
 	 period_time(block.GetBlockValue("period_time", 0u))
@@ -456,13 +484,14 @@ inline void
 AlsaOutput::Setup(AudioFormat &audio_format,
 		  PcmExport::Params &params)
 {
-	const auto hw_result = Alsa::SetupHw(pcm,
+	const auto hw_result = Alsa::SetupHw(pcm, use_mmap,
 					     buffer_time, period_time,
 					     audio_format, params);
 
-	FormatDebug(alsa_output_domain, "format=%s (%s)",
+	FormatDebug(alsa_output_domain, "format=%s (%s) access=%s",
 		    snd_pcm_format_name(hw_result.format),
-		    snd_pcm_format_description(hw_result.format));
+		    snd_pcm_format_description(hw_result.format),
+		    use_mmap ? "mmap" : "rw");
 
 	FormatDebug(alsa_output_domain, "buffer_size=%u period_size=%u",
 		    (unsigned)hw_result.buffer_size,
@@ -593,6 +622,8 @@ AlsaOutput::Open(AudioFormat &audio_format)
 	bool dop;
 #endif
 
+	use_mmap = mmap_setting;
+
 	{
 		const std::lock_guard<Mutex> lock(attributes_mutex);
 #ifdef ENABLE_DSD
@@ -711,36 +742,136 @@ AlsaOutput::Recover(int err) noexcept
 	return err;
 }
 
+inline snd_pcm_sframes_t
+AlsaOutput::MmapWriteFromRing(bool fill_silence) noexcept
+{
+	snd_pcm_sframes_t avail = snd_pcm_avail_update(pcm);
+	if (avail <= 0)
+		return avail;
+
+	const snd_pcm_channel_area_t *areas;
+	snd_pcm_uframes_t offset;
+	snd_pcm_uframes_t frames = avail;
+	int err = snd_pcm_mmap_begin(pcm, &areas, &offset, &frames);
+	if (err < 0)
+		return err;
+
+	/* in SND_PCM_ACCESS_MMAP_INTERLEAVED mode, all channels
+	   share one contiguous area */
+	uint8_t *dest = (uint8_t *)areas[0].addr +
+		areas[0].first / 8 + offset * out_frame_size;
+
+	size_t n_frames = std::min<size_t>(frames,
+					   ring_buffer->read_available() / out_frame_size);
+	const bool from_ring = n_frames > 0;
+	if (from_ring) {
+		gcc_unused size_t nbytes =
+			ring_buffer->pop(dest, n_frames * out_frame_size);
+		assert(nbytes == n_frames * out_frame_size);
+	} else if (fill_silence) {
+		/* insert some silence if the ring buffer has no data
+		   yet, to avoid an ALSA xrun */
+		n_frames = std::min<snd_pcm_uframes_t>(frames,
+						       period_frames);
+		memcpy(dest, silence, n_frames * out_frame_size);
+	} else {
+		snd_pcm_mmap_commit(pcm, offset, 0);
+		return 0;
+	}
+
+	auto committed = snd_pcm_mmap_commit(pcm, offset, n_frames);
+	if (committed < 0)
+		return committed;
+
+	if ((snd_pcm_uframes_t)committed != n_frames)
+		return -EPIPE;
+
+	if (from_ring) {
+		const std::lock_guard<Mutex> lock(mutex);
+		/* notify the OutputThread that there is now room in
+		   ring_buffer */
+		cond.signal();
+	}
+
+	/* unlike snd_pcm_writei(), committing mmap data does not
+	   start the device automatically; start it as soon as the
+	   start threshold (one period of free space left) has been
+	   reached */
+	if (snd_pcm_state(pcm) == SND_PCM_STATE_PREPARED) {
+		avail = snd_pcm_avail_update(pcm);
+		if (avail >= 0 &&
+		    (snd_pcm_uframes_t)avail <= period_frames) {
+			err = snd_pcm_start(pcm);
+			if (err < 0)
+				return err;
+		}
+	}
+
+	return committed;
+}
+
 inline bool
 AlsaOutput::DrainInternal() noexcept
 {
-	if (snd_pcm_state(pcm) != SND_PCM_STATE_RUNNING) {
-		CancelInternal();
-		return true;
-	}
+	if (use_mmap) {
+		/* commit the remaining ring buffer data into the
+		   mapped DMA buffer */
+		if (ring_buffer->read_available() >= out_frame_size) {
+			auto r = MmapWriteFromRing(false);
+			if (r < 0 && r != -EAGAIN) {
+				CancelInternal();
+				return true;
+			}
 
-	/* drain ring_buffer */
-	CopyRingToPeriodBuffer();
+			if (ring_buffer->read_available() >= out_frame_size)
+				/* not everything fit into the DMA
+				   buffer; try again in the next
+				   iteration */
+				return false;
+		}
 
-	auto period_position = period_buffer.GetPeriodPosition(out_frame_size);
-	if (period_position > 0)
-		/* generate some silence to finish the partial
-		   period */
-		period_buffer.FillWithSilence(silence, out_frame_size);
+		if (snd_pcm_state(pcm) == SND_PCM_STATE_PREPARED)
+			/* the start threshold was never reached;
+			   start the device now, or the committed data
+			   would never be played */
+			snd_pcm_start(pcm);
 
-	/* drain period_buffer */
-	if (!period_buffer.IsEmpty()) {
-		auto frames_written = WriteFromPeriodBuffer();
-		if (frames_written < 0 && errno != EAGAIN) {
+		const auto state = snd_pcm_state(pcm);
+		if (state != SND_PCM_STATE_RUNNING &&
+		    state != SND_PCM_STATE_DRAINING) {
+			CancelInternal();
+			return true;
+		}
+	} else {
+		if (snd_pcm_state(pcm) != SND_PCM_STATE_RUNNING) {
 			CancelInternal();
 			return true;
 		}
 
-		if (!period_buffer.IsEmpty())
-			/* need to call WriteFromPeriodBuffer() again
-			   in the next iteration, so don't finish the
-			   drain just yet */
-			return false;
+		/* drain ring_buffer */
+		CopyRingToPeriodBuffer();
+
+		auto period_position = period_buffer.GetPeriodPosition(out_frame_size);
+		if (period_position > 0)
+			/* generate some silence to finish the partial
+			   period */
+			period_buffer.FillWithSilence(silence, out_frame_size);
+
+		/* drain period_buffer */
+		if (!period_buffer.IsEmpty()) {
+			auto frames_written = WriteFromPeriodBuffer();
+			if (frames_written < 0 && errno != EAGAIN) {
+				CancelInternal();
+				return true;
+			}
+
+			if (!period_buffer.IsEmpty())
+				/* need to call
+				   WriteFromPeriodBuffer() again in
+				   the next iteration, so don't finish
+				   the drain just yet */
+				return false;
+		}
 	}
 
 	/* .. and finally drain the ALSA hardware buffer */
@@ -903,6 +1034,26 @@ try {
 						 snd_strerror(-err));
 	}
 
+	if (use_mmap) {
+		/* pop the ring buffer directly into the mapped DMA
+		   buffer, bypassing the period buffer */
+		auto frames_written = MmapWriteFromRing(true);
+		if (frames_written < 0) {
+			if (frames_written == -EAGAIN ||
+			    frames_written == -EINTR)
+				/* try again in the next
+				   DispatchSockets() call which is
+				   still scheduled */
+				return;
+
+			if (Recover(frames_written) < 0)
+				throw FormatRuntimeError("snd_pcm_mmap_commit() failed: %s",
+							 snd_strerror(-frames_written));
+		}
+
+		return;
+	}
+
 	CopyRingToPeriodBuffer();
 
 	if (period_buffer.IsEmpty())
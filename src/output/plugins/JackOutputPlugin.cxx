@@ -28,6 +28,8 @@
 #include "util/Domain.hxx"
 #include "Log.hxx"
 
+#include <algorithm>
+
 #include <assert.h>
 
 #include <jack/jack.h>
@@ -477,14 +479,24 @@ JackOutput::Start()
 	assert(client != nullptr);
 	assert(audio_format.channels <= num_source_ports);
 
+	/* size the ring buffers from the actual JACK period: they
+	   must ride out the scheduling jitter of the OutputThread,
+	   which is proportional to the period length, not to the
+	   fixed default; the configured "ringbuffer_size" remains a
+	   lower bound */
+	const size_t required_size =
+		std::max(ringbuffer_size,
+			 4 * jack_get_buffer_size(client) * jack_sample_size);
+
 	/* allocate the ring buffers on the first open(); these
 	   persist until MPD exits.  It's too unsafe to delete them
 	   because we can never know when mpd_jack_process() gets
-	   called */
+	   called; if the period has grown meanwhile, we keep the old
+	   (smaller) buffers and merely wake up more often */
 	for (unsigned i = 0; i < num_source_ports; ++i) {
 		if (ringbuffer[i] == nullptr)
 			ringbuffer[i] =
-				jack_ringbuffer_create(ringbuffer_size);
+				jack_ringbuffer_create(required_size);
 
 		/* clear the ring buffer to be sure that data from
 		   previous playbacks are gone */
@@ -594,6 +606,34 @@ JackOutput::Open(AudioFormat &new_audio_format)
 	Start();
 }
 
+/**
+ * Copy one channel from the interleaved source to a planar
+ * destination.  With the "restrict" qualifiers and the constant
+ * stride, the compiler can vectorize the strided loads.
+ */
+static void
+Deinterleave(float *gcc_restrict dest, const float *gcc_restrict src,
+	     size_t n_frames, unsigned n_channels) noexcept
+{
+	for (size_t i = 0; i < n_frames; ++i)
+		dest[i] = src[i * n_channels];
+}
+
+/**
+ * Special case for stereo, by far the most common layout: one pass
+ * over the source, which the compiler turns into unpack instructions
+ * instead of two strided gathers.
+ */
+static void
+DeinterleaveStereo(float *gcc_restrict left, float *gcc_restrict right,
+		   const float *gcc_restrict src, size_t n_frames) noexcept
+{
+	for (size_t i = 0; i < n_frames; ++i) {
+		left[i] = src[i * 2];
+		right[i] = src[i * 2 + 1];
+	}
+}
+
 inline size_t
 JackOutput::WriteSamples(const float *src, size_t n_frames)
 {
@@ -623,9 +663,11 @@ JackOutput::WriteSamples(const float *src, size_t n_frames)
 
 	const size_t result = n_frames = std::min(space, n_frames);
 
-	while (n_frames-- > 0)
+	if (n_channels == 2)
+		DeinterleaveStereo(dest[0], dest[1], src, n_frames);
+	else
 		for (unsigned i = 0; i < n_channels; ++i)
-			*dest[i]++ = *src++;
+			Deinterleave(dest[i], src + i, n_frames, n_channels);
 
 	const size_t per_channel_advance = result * jack_sample_size;
 	for (unsigned i = 0; i < n_channels; ++i)
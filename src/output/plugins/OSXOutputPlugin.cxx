@@ -25,7 +25,6 @@
 #include "util/RuntimeError.hxx"
 #include "util/Domain.hxx"
 #include "thread/Mutex.hxx"
-#include "thread/Cond.hxx"
 #include "system/ByteOrder.hxx"
 #include "Log.hxx"
 
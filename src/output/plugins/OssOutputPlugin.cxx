@@ -36,6 +36,7 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <assert.h>
 
@@ -79,6 +80,18 @@ class OssOutput final : AudioOutput {
 	 */
 	int oss_format;
 
+	/**
+	 * A write-combining buffer: Play() copies incoming chunks
+	 * here, and the data is submitted to the device with one
+	 * write() per buffer fill instead of one per chunk.
+	 */
+	uint8_t staging[32768];
+
+	/**
+	 * The number of bytes pending in #staging.
+	 */
+	size_t staged = 0;
+
 #ifdef AFMT_S24_PACKED
 	static constexpr unsigned oss_flags = FLAG_ENABLE_DISABLE;
 #else
@@ -110,6 +123,7 @@ public:
 	}
 
 	size_t Play(const void *chunk, size_t size) override;
+	void Drain() override;
 	void Cancel() noexcept override;
 
 private:
@@ -118,6 +132,21 @@ private:
 	 */
 	void Setup(AudioFormat &audio_format);
 
+	/**
+	 * Write the given buffer to the device completely, retrying
+	 * after partial writes.
+	 *
+	 * Throws #std::runtime_error on error.
+	 */
+	void WriteAll(const uint8_t *data, size_t size);
+
+	/**
+	 * Submit the #staging buffer to the device.
+	 *
+	 * Throws #std::runtime_error on error.
+	 */
+	void FlushStaging();
+
 	/**
 	 * Reopen the device with the saved audio_format, without any probing.
 	 *
@@ -236,6 +265,8 @@ OssOutput::DoClose()
 {
 	if (fd.IsDefined())
 		fd.Close();
+
+	staged = 0;
 }
 
 /**
@@ -648,6 +679,8 @@ try {
 void
 OssOutput::Cancel() noexcept
 {
+	staged = 0;
+
 	if (fd.IsDefined()) {
 		ioctl(fd.Get(), SNDCTL_DSP_RESET, 0);
 		DoClose();
@@ -658,17 +691,43 @@ OssOutput::Cancel() noexcept
 #endif
 }
 
+void
+OssOutput::WriteAll(const uint8_t *data, size_t size)
+{
+	while (size > 0) {
+		ssize_t ret = fd.Write(data, size);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+
+			throw FormatErrno("Write error on %s", device);
+		}
+
+		data += ret;
+		size -= ret;
+	}
+}
+
+void
+OssOutput::FlushStaging()
+{
+	const size_t size = staged;
+	staged = 0;
+
+	WriteAll(staging, size);
+}
+
 size_t
 OssOutput::Play(const void *chunk, size_t size)
 {
-	ssize_t ret;
-
 	assert(size > 0);
 
 	/* reopen the device since it was closed by dropBufferedAudio */
 	if (!fd.IsDefined())
 		Reopen();
 
+	const size_t source_size = size;
+
 #ifdef AFMT_S24_PACKED
 	const auto e = pcm_export->Export({chunk, size});
 	chunk = e.data;
@@ -677,18 +736,26 @@ OssOutput::Play(const void *chunk, size_t size)
 
 	assert(size > 0);
 
-	while (true) {
-		ret = fd.Write(chunk, size);
-		if (ret > 0) {
-#ifdef AFMT_S24_PACKED
-			ret = pcm_export->CalcSourceSize(ret);
-#endif
-			return ret;
-		}
+	if (staged + size > sizeof(staging))
+		FlushStaging();
 
-		if (ret < 0 && errno != EINTR)
-			throw FormatErrno("Write error on %s", device);
+	if (size >= sizeof(staging))
+		/* doesn't fit in the staging buffer (which is empty
+		   now): write it directly */
+		WriteAll((const uint8_t *)chunk, size);
+	else {
+		memcpy(staging + staged, chunk, size);
+		staged += size;
 	}
+
+	return source_size;
+}
+
+void
+OssOutput::Drain()
+{
+	if (fd.IsDefined())
+		FlushStaging();
 }
 
 const struct AudioOutputPlugin oss_output_plugin = {
@@ -40,6 +40,7 @@
 #include <assert.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define MPD_PULSE_NAME "Music Player Daemon"
 
@@ -788,10 +789,26 @@ PulseOutput::Play(const void *chunk, size_t size)
 		/* don't send more than possible */
 		size = writable;
 
+	/* ask PulseAudio for its internal write buffer and fill that
+	   one directly; this saves the copy into an internal memblock
+	   which pa_stream_write() would otherwise do */
+
+	void *buffer;
+	size_t nbytes = size;
+	int result = pa_stream_begin_write(stream, &buffer, &nbytes);
+	if (result < 0)
+		throw MakePulseError(context,
+				     "pa_stream_begin_write() failed");
+
+	if (nbytes < size)
+		size = nbytes;
+
+	memcpy(buffer, chunk, size);
+
 	writable -= size;
 
-	int result = pa_stream_write(stream, chunk, size, nullptr,
-				     0, PA_SEEK_RELATIVE);
+	result = pa_stream_write(stream, buffer, size, nullptr,
+				 0, PA_SEEK_RELATIVE);
 	if (result < 0)
 		throw MakePulseError(context, "pa_stream_write() failed");
 
@@ -29,6 +29,7 @@
 #include "Log.hxx"
 #include "fs/AllocatedPath.hxx"
 #include "fs/io/FileOutputStream.hxx"
+#include "fs/io/WriteBehindOutputStream.hxx"
 #include "util/Domain.hxx"
 #include "util/ScopeExit.hxx"
 
@@ -69,6 +70,14 @@ class RecorderOutput final : AudioOutput {
 	 */
 	FileOutputStream *file;
 
+	/**
+	 * A write-behind filter in front of #file: encoded data is
+	 * queued in a bounded buffer and written by a background
+	 * thread, so disk latency (e.g. RAID flushes) does not stall
+	 * the output thread's Play() path.
+	 */
+	WriteBehindOutputStream *write_behind;
+
 	RecorderOutput(const ConfigBlock &block);
 
 public:
@@ -129,8 +138,9 @@ inline void
 RecorderOutput::EncoderToFile()
 {
 	assert(file != nullptr);
+	assert(write_behind != nullptr);
 
-	EncoderToOutputStream(*file, *encoder);
+	EncoderToOutputStream(*write_behind, *encoder);
 }
 
 void
@@ -142,12 +152,14 @@ RecorderOutput::Open(AudioFormat &audio_format)
 		assert(!path.IsNull());
 
 		file = new FileOutputStream(path);
+		write_behind = new WriteBehindOutputStream(*file);
 	} else {
 		/* don't open the file just yet; wait until we have
 		   a tag that we can use to build the path */
 		assert(path.IsNull());
 
 		file = nullptr;
+		write_behind = nullptr;
 	}
 
 	/* open the encoder */
@@ -155,6 +167,7 @@ RecorderOutput::Open(AudioFormat &audio_format)
 	try {
 		encoder = prepared_encoder->Open(audio_format);
 	} catch (...) {
+		delete write_behind;
 		delete file;
 		throw;
 	}
@@ -195,6 +208,19 @@ RecorderOutput::Commit()
 
 	delete encoder;
 
+	/* wait for the write-behind thread to catch up (and rethrow
+	   its errors) before committing the file */
+
+	try {
+		write_behind->Flush();
+	} catch (...) {
+		delete write_behind;
+		delete file;
+		throw;
+	}
+
+	delete write_behind;
+
 	try {
 		file->Commit();
 	} catch (...) {
@@ -243,6 +269,7 @@ RecorderOutput::FinishFormat()
 	}
 
 	file = nullptr;
+	write_behind = nullptr;
 	path.SetNull();
 }
 
@@ -254,12 +281,14 @@ RecorderOutput::ReopenFormat(AllocatedPath &&new_path)
 	assert(file == nullptr);
 
 	FileOutputStream *new_file = new FileOutputStream(new_path);
+	auto *new_write_behind = new WriteBehindOutputStream(*new_file);
 
 	AudioFormat new_audio_format = effective_audio_format;
 
 	try {
 		encoder = prepared_encoder->Open(new_audio_format);
 	} catch (...) {
+		delete new_write_behind;
 		delete new_file;
 		throw;
 	}
@@ -269,15 +298,17 @@ RecorderOutput::ReopenFormat(AllocatedPath &&new_path)
 	assert(new_audio_format == effective_audio_format);
 
 	try {
-		EncoderToOutputStream(*new_file, *encoder);
+		EncoderToOutputStream(*new_write_behind, *encoder);
 	} catch (...) {
 		delete encoder;
+		delete new_write_behind;
 		delete new_file;
 		throw;
 	}
 
 	path = std::move(new_path);
 	file = new_file;
+	write_behind = new_write_behind;
 
 	FormatDebug(recorder_domain, "Recording to \"%s\"",
 		    path.ToUTF8().c_str());
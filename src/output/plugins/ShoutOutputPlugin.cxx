@@ -20,8 +20,14 @@
 #include "config.h"
 #include "ShoutOutputPlugin.hxx"
 #include "../OutputAPI.hxx"
+#include "../Timer.hxx"
 #include "encoder/EncoderInterface.hxx"
 #include "encoder/Configured.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+#include "thread/Thread.hxx"
+#include "thread/Name.hxx"
+#include "system/PeriodClock.hxx"
 #include "util/RuntimeError.hxx"
 #include "util/Domain.hxx"
 #include "util/ScopeExit.hxx"
@@ -32,6 +38,9 @@
 
 #include <stdexcept>
 #include <memory>
+#include <list>
+#include <vector>
+#include <string>
 
 #include <assert.h>
 #include <stdlib.h>
@@ -48,8 +57,60 @@ struct ShoutOutput final : AudioOutput {
 
 	int timeout = DEFAULT_CONN_TIMEOUT;
 
+	/**
+	 * The maximum number of encoded bytes queued for the sender
+	 * thread; beyond this, the oldest data is dropped, so a
+	 * stalled server never backpressures into the shared player
+	 * pipeline.
+	 */
+	size_t jitter_buffer_size;
+
 	uint8_t buffer[32768];
 
+	/**
+	 * Paces Play() to the (nominal) real-time rate of the audio
+	 * format, because the server connection no longer throttles
+	 * the output thread.
+	 */
+	Timer *timer;
+
+	/**
+	 * Protects #queue, #queued, #pending_metadata, #stop_sender
+	 * and #connected.
+	 */
+	Mutex mutex;
+	Cond cond;
+
+	/**
+	 * Encoded data waiting to be sent by the sender thread.
+	 */
+	std::list<std::vector<uint8_t>> queue;
+
+	/**
+	 * The total size of #queue in bytes.
+	 */
+	size_t queued = 0;
+
+	/**
+	 * An icy-metadata "song" string waiting to be submitted by
+	 * the sender thread (because shout_set_metadata() may block,
+	 * it must not run in the output thread).  Empty means none.
+	 */
+	std::string pending_metadata;
+
+	bool stop_sender;
+
+	/**
+	 * Does the sender thread believe the connection is alive?
+	 * Cleared when shout_send() fails; the sender then reconnects
+	 * with ShoutOpen() while Play() keeps filling the queue.
+	 */
+	bool connected;
+
+	Thread sender_thread;
+
+	PeriodClock throttle_drop_log;
+
 	explicit ShoutOutput(const ConfigBlock &block);
 	~ShoutOutput();
 
@@ -67,6 +128,18 @@ struct ShoutOutput final : AudioOutput {
 
 private:
 	void WritePage();
+
+	/**
+	 * Move pending data from the encoder to the sender queue,
+	 * dropping the oldest queued data when the jitter buffer
+	 * overflows.
+	 */
+	void EnqueuePage();
+
+	bool SendChunk(const uint8_t *data, size_t size) noexcept;
+	bool TryReconnect() noexcept;
+	void SendMetadata(const char *song) noexcept;
+	void RunSender() noexcept;
 };
 
 static int shout_init_count;
@@ -99,7 +172,8 @@ ShoutSetAudioInfo(shout_t *shout_conn, const AudioFormat &audio_format)
 ShoutOutput::ShoutOutput(const ConfigBlock &block)
 	:AudioOutput(FLAG_PAUSE|FLAG_NEED_FULLY_DEFINED_AUDIO_FORMAT),
 	 shout_conn(shout_new()),
-	 prepared_encoder(CreateConfiguredEncoder(block, true))
+	 prepared_encoder(CreateConfiguredEncoder(block, true)),
+	 sender_thread(BIND_THIS_METHOD(RunSender))
 {
 	const char *host = require_block_string(block, "host");
 	const char *mount = require_block_string(block, "mount");
@@ -159,6 +233,9 @@ ShoutOutput::ShoutOutput(const ConfigBlock &block)
 	/* optional paramters */
 	timeout = block.GetBlockValue("timeout", DEFAULT_CONN_TIMEOUT);
 
+	jitter_buffer_size = block.GetBlockValue("jitter_buffer_size",
+						 256 * 1024u);
+
 	value = block.GetBlockValue("genre");
 	if (value != nullptr && shout_set_genre(shout_conn, value))
 		throw std::runtime_error(shout_get_error(shout_conn));
@@ -245,18 +322,183 @@ ShoutOutput::WritePage()
 	EncoderToShout(shout_conn, *encoder, buffer, sizeof(buffer));
 }
 
+inline void
+ShoutOutput::EnqueuePage()
+{
+	assert(encoder != nullptr);
+
+	bool dropped = false;
+
+	while (true) {
+		size_t nbytes = encoder->Read(buffer, sizeof(buffer));
+		if (nbytes == 0)
+			break;
+
+		const std::lock_guard<Mutex> lock(mutex);
+
+		/* drop-oldest: a stalled server costs us the oldest
+		   data, never playback */
+		while (queued + nbytes > jitter_buffer_size &&
+		       !queue.empty()) {
+			queued -= queue.front().size();
+			queue.pop_front();
+			dropped = true;
+		}
+
+		queue.emplace_back(buffer, buffer + nbytes);
+		queued += nbytes;
+		cond.signal();
+	}
+
+	if (dropped && throttle_drop_log.CheckUpdate(std::chrono::seconds(30)))
+		FormatWarning(shout_output_domain,
+			      "shout server %s:%i is too slow, dropping oldest data",
+			      shout_get_host(shout_conn),
+			      shout_get_port(shout_conn));
+}
+
+inline bool
+ShoutOutput::SendChunk(const uint8_t *data, size_t size) noexcept
+{
+	int err = shout_send(shout_conn, data, size);
+	if (err != SHOUTERR_SUCCESS) {
+		FormatWarning(shout_output_domain,
+			      "Lost shout connection to %s:%i: %s",
+			      shout_get_host(shout_conn),
+			      shout_get_port(shout_conn),
+			      shout_get_error(shout_conn));
+		return false;
+	}
+
+	return true;
+}
+
+inline bool
+ShoutOutput::TryReconnect() noexcept
+{
+	if (shout_get_connected(shout_conn) != SHOUTERR_UNCONNECTED)
+		shout_close(shout_conn);
+
+	try {
+		ShoutOpen(shout_conn);
+	} catch (...) {
+		LogError(std::current_exception());
+		return false;
+	}
+
+	FormatDefault(shout_output_domain,
+		      "Reconnected to shout server %s:%i",
+		      shout_get_host(shout_conn),
+		      shout_get_port(shout_conn));
+	return true;
+}
+
+inline void
+ShoutOutput::SendMetadata(const char *song) noexcept
+{
+	const auto meta = shout_metadata_new();
+	AtScopeExit(meta) { shout_metadata_free(meta); };
+
+	shout_metadata_add(meta, "song", song);
+	if (SHOUTERR_SUCCESS != shout_set_metadata(shout_conn, meta)) {
+		LogWarning(shout_output_domain,
+			   "error setting shout metadata");
+	}
+}
+
+void
+ShoutOutput::RunSender() noexcept
+{
+	SetThreadName("shout_send");
+
+	mutex.lock();
+
+	while (true) {
+		if (!connected) {
+			if (stop_sender)
+				/* discard whatever is left; we cannot
+				   deliver it anyway */
+				break;
+
+			mutex.unlock();
+			const bool success = TryReconnect();
+			mutex.lock();
+
+			connected = success;
+			if (!success)
+				/* retry after a while; Play() keeps
+				   filling (and trimming) the queue
+				   meanwhile */
+				cond.timed_wait(mutex,
+						std::chrono::seconds(5));
+
+			continue;
+		}
+
+		if (!pending_metadata.empty()) {
+			const auto song = std::move(pending_metadata);
+			pending_metadata.clear();
+			mutex.unlock();
+
+			SendMetadata(song.c_str());
+
+			mutex.lock();
+			continue;
+		}
+
+		if (!queue.empty()) {
+			auto chunk = std::move(queue.front());
+			queue.pop_front();
+			queued -= chunk.size();
+			mutex.unlock();
+
+			const bool success =
+				SendChunk(chunk.data(), chunk.size());
+
+			mutex.lock();
+			if (!success)
+				/* the chunk is lost; reconnect and
+				   resume with the newest data */
+				connected = false;
+		} else if (stop_sender) {
+			break;
+		} else {
+			cond.wait(mutex);
+		}
+	}
+
+	mutex.unlock();
+}
+
 void
 ShoutOutput::Close() noexcept
 {
 	try {
 		encoder->End();
-		WritePage();
+		EnqueuePage();
 	} catch (...) {
 		/* ignore */
 	}
 
 	delete encoder;
 
+	/* stop the sender thread; it drains the queue first if the
+	   connection is still alive */
+
+	{
+		const std::lock_guard<Mutex> lock(mutex);
+		stop_sender = true;
+		cond.signal();
+	}
+
+	sender_thread.Join();
+
+	queue.clear();
+	queued = 0;
+	pending_metadata.clear();
+
+	delete timer;
+
 	if (shout_get_connected(shout_conn) != SHOUTERR_UNCONNECTED &&
 	    shout_close(shout_conn) != SHOUTERR_SUCCESS) {
 		FormatWarning(shout_output_domain,
@@ -268,7 +510,11 @@ ShoutOutput::Close() noexcept
 void
 ShoutOutput::Cancel() noexcept
 {
-	/* needs to be implemented for shout */
+	/* discard whatever has not been sent yet */
+
+	const std::lock_guard<Mutex> lock(mutex);
+	queue.clear();
+	queued = 0;
 }
 
 static void
@@ -295,28 +541,42 @@ ShoutOutput::Open(AudioFormat &audio_format)
 	try {
 		ShoutSetAudioInfo(shout_conn, audio_format);
 		ShoutOpen(shout_conn);
+
+		/* send the stream header synchronously; the sender
+		   thread is not running yet */
 		WritePage();
 	} catch (...) {
 		delete encoder;
 		throw;
 	}
+
+	timer = new Timer(audio_format);
+
+	stop_sender = false;
+	connected = true;
+	sender_thread.Start();
 }
 
 std::chrono::steady_clock::duration
 ShoutOutput::Delay() const noexcept
 {
-	int delay = shout_delay(shout_conn);
-	if (delay < 0)
-		delay = 0;
-
-	return std::chrono::milliseconds(delay);
+	/* the server connection no longer throttles us; pace Play()
+	   to the nominal rate of the audio format instead (cf. the
+	   httpd output) */
+	return timer->IsStarted()
+		? timer->GetDelay()
+		: std::chrono::steady_clock::duration::zero();
 }
 
 size_t
 ShoutOutput::Play(const void *chunk, size_t size)
 {
+	if (!timer->IsStarted())
+		timer->Start();
+	timer->Add(size);
+
 	encoder->Write(chunk, size);
-	WritePage();
+	EnqueuePage();
 	return size;
 }
 
@@ -325,8 +585,7 @@ ShoutOutput::Pause()
 {
 	static char silence[1020];
 
-	encoder->Write(silence, sizeof(silence));
-	WritePage();
+	Play(silence, sizeof(silence));
 
 	return true;
 }
@@ -349,25 +608,22 @@ ShoutOutput::SendTag(const Tag &tag)
 		/* encoder plugin supports stream tags */
 
 		encoder->PreTag();
-		WritePage();
+		EnqueuePage();
 		encoder->SendTag(tag);
 	} else {
-		/* no stream tag support: fall back to icy-metadata */
-
-		const auto meta = shout_metadata_new();
-		AtScopeExit(meta) { shout_metadata_free(meta); };
+		/* no stream tag support: fall back to icy-metadata;
+		   shout_set_metadata() talks to the server and may
+		   block, so hand it to the sender thread */
 
 		char song[1024];
 		shout_tag_to_metadata(tag, song, sizeof(song));
 
-		shout_metadata_add(meta, "song", song);
-		if (SHOUTERR_SUCCESS != shout_set_metadata(shout_conn, meta)) {
-			LogWarning(shout_output_domain,
-				   "error setting shout metadata");
-		}
+		const std::lock_guard<Mutex> lock(mutex);
+		pending_metadata = song;
+		cond.signal();
 	}
 
-	WritePage();
+	EnqueuePage();
 }
 
 const struct AudioOutputPlugin shout_output_plugin = {
@@ -32,6 +32,10 @@
 #include <string.h>
 #include <stdio.h>
 
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
+
 HttpdClient::~HttpdClient()
 {
 	if (IsDefined())
@@ -207,7 +211,7 @@ HttpdClient::ClearQueue()
 		queue_size -= page->GetSize();
 #endif
 
-		pages.pop();
+		pages.pop_front();
 	}
 
 	assert(queue_size == 0);
@@ -242,6 +246,75 @@ HttpdClient::TryWritePageN(const Page &page, size_t position, ssize_t n)
 		: TryWritePage(page, position);
 }
 
+#ifndef _WIN32
+
+inline bool
+HttpdClient::TryWriteV()
+{
+	assert(current_page != nullptr);
+	assert(!pages.empty());
+
+	static constexpr size_t MAX_PAGES = 16;
+	struct iovec v[MAX_PAGES];
+
+	v[0].iov_base = const_cast<uint8_t *>(current_page->GetData())
+		+ current_position;
+	v[0].iov_len = current_page->GetSize() - current_position;
+	size_t n = 1;
+
+	for (auto i = pages.begin(); i != pages.end() && n < MAX_PAGES;
+	     ++i, ++n) {
+		v[n].iov_base = const_cast<uint8_t *>((*i)->GetData());
+		v[n].iov_len = (*i)->GetSize();
+	}
+
+	ssize_t nbytes = GetSocket().WriteV(v, n);
+	if (nbytes < 0) {
+		auto e = GetSocketError();
+		if (IsSocketErrorAgain(e))
+			return true;
+
+		if (!IsSocketErrorClosed(e)) {
+			SocketErrorMessage msg(e);
+			FormatWarning(httpd_output_domain,
+				      "failed to write to client: %s",
+				      (const char *)msg);
+		}
+
+		Close();
+		return false;
+	}
+
+	/* mark the written bytes as consumed, popping all pages
+	   which were sent completely */
+
+	current_position += nbytes;
+	while (current_position >= current_page->GetSize()) {
+		current_position -= current_page->GetSize();
+		current_page.reset();
+
+		if (pages.empty())
+			break;
+
+		current_page = std::move(pages.front());
+		pages.pop_front();
+
+		assert(queue_size >= current_page->GetSize());
+		queue_size -= current_page->GetSize();
+	}
+
+	if (current_page == nullptr) {
+		assert(current_position == 0);
+
+		/* all pages are sent: remove the event source */
+		CancelWrite();
+	}
+
+	return true;
+}
+
+#endif
+
 ssize_t
 HttpdClient::GetBytesTillMetaData() const noexcept
 {
@@ -268,8 +341,8 @@ HttpdClient::TryWrite()
 			return true;
 		}
 
-		current_page = pages.front();
-		pages.pop();
+		current_page = std::move(pages.front());
+		pages.pop_front();
 		current_position = 0;
 
 		assert(queue_size >= current_page->GetSize());
@@ -328,6 +401,16 @@ HttpdClient::TryWrite()
 			metadata_current_position = 0;
 		}
 	} else {
+#ifndef _WIN32
+		if (!metadata_requested && !pages.empty())
+			/* stitch the queued pages together and send
+			   them with one system call; this is only
+			   done without Icy metadata, because the
+			   metadata accounting needs to stop at each
+			   metaint boundary */
+			return TryWriteV();
+#endif
+
 		ssize_t nbytes =
 			TryWritePageN(*current_page, current_position,
 				      bytes_to_write);
@@ -380,7 +463,7 @@ HttpdClient::PushPage(PagePtr page)
 	}
 
 	queue_size += page->GetSize();
-	pages.emplace(std::move(page));
+	pages.emplace_back(std::move(page));
 
 	ScheduleWrite();
 }
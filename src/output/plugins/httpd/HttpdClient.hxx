@@ -27,7 +27,6 @@
 #include <boost/intrusive/link_mode.hpp>
 #include <boost/intrusive/list_hook.hpp>
 
-#include <queue>
 #include <list>
 
 #include <stddef.h>
@@ -58,9 +57,11 @@ class HttpdClient final
 	} state = State::REQUEST;
 
 	/**
-	 * A queue of #Page objects to be sent to the client.
+	 * A queue of #Page objects to be sent to the client.  All
+	 * clients of one #HttpdOutput share the same #Page instances;
+	 * this list only adds references.
 	 */
-	std::queue<PagePtr, std::list<PagePtr>> pages;
+	std::list<PagePtr> pages;
 
 	/**
 	 * The sum of all page sizes in #pages.
@@ -175,6 +176,14 @@ public:
 	ssize_t TryWritePage(const Page &page, size_t position);
 	ssize_t TryWritePageN(const Page &page, size_t position, ssize_t n);
 
+#ifndef _WIN32
+	/**
+	 * Submit the current page and as many queued pages as
+	 * possible with a single writev() system call.
+	 */
+	bool TryWriteV();
+#endif
+
 	bool TryWrite();
 
 	/**
@@ -28,6 +28,8 @@
 #include "HttpdClient.hxx"
 #include "output/Interface.hxx"
 #include "output/Timer.hxx"
+#include "AudioFormat.hxx"
+#include "system/PeriodClock.hxx"
 #include "thread/Mutex.hxx"
 #include "thread/Cond.hxx"
 #include "event/ServerSocket.hxx"
@@ -64,6 +66,39 @@ class HttpdOutput final : AudioOutput, ServerSocket {
 	std::unique_ptr<PreparedEncoder> prepared_encoder;
 	Encoder *encoder = nullptr;
 
+	/**
+	 * Is #encoder currently open?  While no client is connected,
+	 * the encoder is closed lazily to stop wasting CPU and
+	 * memory, and reopened on the first connect.
+	 */
+	bool encoder_open = false;
+
+	/**
+	 * Does the encoder plugin embed tags in the stream?  A cached
+	 * copy of Encoder::ImplementsTag() which remains available
+	 * while the encoder is closed.
+	 */
+	bool encoder_implements_tag = false;
+
+	/**
+	 * The (negotiated) audio format the encoder was opened with,
+	 * for reopening it lazily when a client connects.
+	 */
+	AudioFormat encoder_audio_format;
+
+	/**
+	 * Time stamp of the last client disconnect; when #linger has
+	 * passed without a new client, the encoder is closed.
+	 */
+	PeriodClock idle_clock;
+
+	/**
+	 * Keep the encoder open this long after the last client has
+	 * disconnected, to avoid tearing it down and regenerating the
+	 * stream header each time a flaky client reconnects.
+	 */
+	std::chrono::steady_clock::duration linger;
+
 	/**
 	 * Number of bytes which were fed into the encoder, without
 	 * ever receiving new output.  This is used to estimate
@@ -179,6 +214,15 @@ public:
 	 */
 	void OpenEncoder(AudioFormat &audio_format);
 
+private:
+	/**
+	 * Close the encoder because no client has been connected for
+	 * a while.  Caller must lock the mutex.
+	 */
+	void LazyCloseEncoder() noexcept;
+
+public:
+
 	/**
 	 * Caller must lock the mutex.
 	 */
@@ -62,6 +62,8 @@ HttpdOutput::HttpdOutput(EventLoop &_loop, const ConfigBlock &block)
 
 	clients_max = block.GetBlockValue("max_clients", 0u);
 
+	linger = std::chrono::seconds(block.GetBlockValue("linger", 10u));
+
 	/* set up bind_to_address */
 
 	const char *bind_to_address = block.GetBlockValue("bind_to_address");
@@ -104,7 +106,7 @@ inline void
 HttpdOutput::AddClient(UniqueSocketDescriptor fd)
 {
 	auto *client = new HttpdClient(*this, std::move(fd), GetEventLoop(),
-				       !encoder->ImplementsTag());
+				       !encoder_implements_tag);
 	clients.push_front(*client);
 
 	/* pass metadata to client */
@@ -186,6 +188,17 @@ HttpdOutput::ReadPage()
 		unflushed_input = 0;
 	}
 
+	{
+		/* zero-copy fast path: the encoder hands its output
+		   through without copying (PCM passthrough), and the
+		   only copy is the one into the page */
+		const auto span = encoder->ReadZeroCopy();
+		if (!span.IsNull()) {
+			unflushed_input = 0;
+			return std::make_shared<Page>(span.data, span.size);
+		}
+	}
+
 	size_t size = 0;
 	do {
 		size_t nbytes = encoder->Read(buffer + size,
@@ -208,6 +221,8 @@ inline void
 HttpdOutput::OpenEncoder(AudioFormat &audio_format)
 {
 	encoder = prepared_encoder->Open(audio_format);
+	encoder_open = true;
+	encoder_implements_tag = encoder->ImplementsTag();
 
 	/* we have to remember the encoder header, i.e. the first
 	   bytes of encoder output after opening it, because it has to
@@ -217,6 +232,19 @@ HttpdOutput::OpenEncoder(AudioFormat &audio_format)
 	unflushed_input = 0;
 }
 
+void
+HttpdOutput::LazyCloseEncoder() noexcept
+{
+	assert(encoder_open);
+
+	delete encoder;
+	encoder = nullptr;
+	encoder_open = false;
+
+	header.reset();
+	unflushed_input = 0;
+}
+
 void
 HttpdOutput::Open(AudioFormat &audio_format)
 {
@@ -227,6 +255,9 @@ HttpdOutput::Open(AudioFormat &audio_format)
 
 	OpenEncoder(audio_format);
 
+	encoder_audio_format = audio_format;
+	idle_clock.Reset();
+
 	/* initialize other attributes */
 
 	timer = new Timer(audio_format);
@@ -253,6 +284,8 @@ HttpdOutput::Close() noexcept
 	header.reset();
 
 	delete encoder;
+	encoder = nullptr;
+	encoder_open = false;
 }
 
 void
@@ -343,8 +376,34 @@ HttpdOutput::Play(const void *chunk, size_t size)
 {
 	pause = false;
 
-	if (LockHasClients())
+	if (LockHasClients()) {
+		idle_clock.Reset();
+
+		if (!encoder_open) {
+			/* the encoder was closed while nobody was
+			   listening: reopen it, and send the new
+			   stream header to the waiting clients */
+			{
+				const std::lock_guard<Mutex> protect(mutex);
+				OpenEncoder(encoder_audio_format);
+			}
+
+			if (header != nullptr)
+				BroadcastPage(header);
+		}
+
 		EncodeAndPlay(chunk, size);
+	} else if (encoder_open) {
+		if (!idle_clock.IsDefined())
+			idle_clock.Update();
+		else if (idle_clock.Check(linger)) {
+			/* no client for "linger" seconds: close the
+			   encoder until somebody connects again */
+			const std::lock_guard<Mutex> protect(mutex);
+			if (!HasClients())
+				LazyCloseEncoder();
+		}
+	}
 
 	if (!timer->IsStarted())
 		timer->Start();
@@ -369,9 +428,15 @@ HttpdOutput::Pause()
 void
 HttpdOutput::SendTag(const Tag &tag)
 {
-	if (encoder->ImplementsTag()) {
+	if (encoder_implements_tag) {
 		/* embed encoder tags */
 
+		if (!encoder_open)
+			/* the encoder is closed because nobody is
+			   listening; the reopen will generate a fresh
+			   header from the new song anyway */
+			return;
+
 		/* flush the current stream, and end it */
 
 		try {
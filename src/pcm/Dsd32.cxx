@@ -22,6 +22,53 @@
 #include "PcmBuffer.hxx"
 #include "util/ConstBuffer.hxx"
 
+#if defined(__GNUC__) && defined(__x86_64__)
+
+#include <tmmintrin.h>
+
+static inline bool
+HaveSsse3() noexcept
+{
+	static const bool value = __builtin_cpu_supports("ssse3");
+	return value;
+}
+
+/**
+ * Repack 16 source bytes into 4 samples per iteration with one
+ * "pshufb"; the shuffle mask gathers the channel-strided byte
+ * quadruples and is built once per call from the channel count.
+ *
+ * @return the number of samples processed (a multiple of 4)
+ */
+__attribute__((target("ssse3")))
+static size_t
+Dsd8To32Ssse3(uint32_t *dest, const uint8_t *src, size_t n_samples,
+	      unsigned channels) noexcept
+{
+	uint8_t mask[16];
+	for (unsigned s = 0; s < 4; ++s) {
+		const unsigned group = s / channels, c = s % channels;
+		const unsigned base = group * 4 * channels;
+
+		/* the oldest byte is the most significant one */
+		mask[4 * s] = base + 3 * channels + c;
+		mask[4 * s + 1] = base + 2 * channels + c;
+		mask[4 * s + 2] = base + channels + c;
+		mask[4 * s + 3] = base + c;
+	}
+
+	const __m128i shuffle = _mm_loadu_si128((const __m128i *)mask);
+
+	for (size_t i = 0; i < n_samples / 4; ++i, src += 16, dest += 4)
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)src),
+						  shuffle));
+
+	return n_samples - n_samples % 4;
+}
+
+#endif /* __x86_64__ */
+
 /**
  * Construct a 32 bit integer from four bytes.
  */
@@ -54,7 +101,20 @@ Dsd8To32(PcmBuffer &buffer, unsigned channels,
 	uint32_t *const dest0 = buffer.GetT<uint32_t>(out_samples);
 	uint32_t *dest = dest0;
 
-	for (size_t i = 0; i < out_frames; ++i) {
+	size_t out_frames_rest = out_frames;
+
+#if defined(__GNUC__) && defined(__x86_64__)
+	if ((channels & (channels - 1)) == 0 && channels <= 4 &&
+	    HaveSsse3()) {
+		const size_t done = Dsd8To32Ssse3(dest, src, out_samples,
+						  channels);
+		dest += done;
+		src += done * 4;
+		out_frames_rest -= done / channels;
+	}
+#endif
+
+	for (size_t i = 0; i < out_frames_rest; ++i) {
 		for (size_t c = 0; c < channels; ++c)
 			*dest++ = Dsd8To32Sample(src++, channels);
 
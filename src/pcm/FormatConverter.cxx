@@ -21,6 +21,7 @@
 #include "FormatConverter.hxx"
 #include "PcmFormat.hxx"
 #include "util/ConstBuffer.hxx"
+#include "util/WritableBuffer.hxx"
 #include "util/RuntimeError.hxx"
 
 #include <assert.h>
@@ -31,23 +32,20 @@ PcmFormatConverter::Open(SampleFormat _src_format, SampleFormat _dest_format)
 	assert(_src_format != SampleFormat::UNDEFINED);
 	assert(_dest_format != SampleFormat::UNDEFINED);
 
-	switch (_dest_format) {
-	case SampleFormat::UNDEFINED:
-		assert(false);
-		gcc_unreachable();
+	/* look up the conversion functions once; Convert() will jump
+	   there directly, without checking the formats again for each
+	   buffer */
 
-	case SampleFormat::S8:
-	case SampleFormat::DSD:
+	convert_function = pcm_lookup_convert_function(_src_format,
+						       _dest_format);
+	if (convert_function == nullptr)
 		throw FormatRuntimeError("PCM conversion from %s to %s is not implemented",
 					 sample_format_to_string(_src_format),
 					 sample_format_to_string(_dest_format));
 
-	case SampleFormat::S16:
-	case SampleFormat::S24_P32:
-	case SampleFormat::S32:
-	case SampleFormat::FLOAT:
-		break;
-	}
+	convert_in_place_function =
+		pcm_lookup_convert_in_place_function(_src_format,
+						     _dest_format);
 
 	src_format = _src_format;
 	dest_format = _dest_format;
@@ -65,34 +63,20 @@ PcmFormatConverter::Close() noexcept
 ConstBuffer<void>
 PcmFormatConverter::Convert(ConstBuffer<void> src) noexcept
 {
-	switch (dest_format) {
-	case SampleFormat::UNDEFINED:
-	case SampleFormat::S8:
-	case SampleFormat::DSD:
-		assert(false);
-		gcc_unreachable();
-
-	case SampleFormat::S16:
-		return pcm_convert_to_16(buffer, dither,
-					 src_format,
-					 src).ToVoid();
-
-	case SampleFormat::S24_P32:
-		return pcm_convert_to_24(buffer,
-					 src_format,
-					 src).ToVoid();
+	return convert_function(buffer, dither, src);
+}
 
-	case SampleFormat::S32:
-		return pcm_convert_to_32(buffer,
-					 src_format,
-					 src).ToVoid();
+bool
+PcmFormatConverter::CanConvertInPlace() const noexcept
+{
+	return convert_in_place_function != nullptr;
+}
 
-	case SampleFormat::FLOAT:
-		return pcm_convert_to_float(buffer,
-					    src_format,
-					    src).ToVoid();
-	}
+WritableBuffer<void>
+PcmFormatConverter::ConvertInPlace(WritableBuffer<void> src) noexcept
+{
+	assert(CanConvertInPlace());
 
-	assert(false);
-	gcc_unreachable();
+	convert_in_place_function(src);
+	return src;
 }
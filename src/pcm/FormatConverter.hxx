@@ -22,6 +22,7 @@
 
 #include "check.h"
 #include "SampleFormat.hxx"
+#include "PcmFormat.hxx"
 #include "PcmBuffer.hxx"
 #include "PcmDither.hxx"
 
@@ -30,6 +31,7 @@
 #endif
 
 template<typename T> struct ConstBuffer;
+template<typename T> struct WritableBuffer;
 
 /**
  * A class that converts samples from one format to another.
@@ -37,6 +39,19 @@ template<typename T> struct ConstBuffer;
 class PcmFormatConverter {
 	SampleFormat src_format, dest_format;
 
+	/**
+	 * The conversion function, looked up once by Open().
+	 * Convert() jumps there directly, without any per-buffer
+	 * format dispatch.
+	 */
+	PcmConvertFunction convert_function;
+
+	/**
+	 * The in-place variant, or nullptr if this format pair cannot
+	 * be converted in place.
+	 */
+	PcmConvertInPlaceFunction convert_in_place_function;
+
 	PcmBuffer buffer;
 	PcmDither dither;
 
@@ -75,6 +90,24 @@ public:
 	 */
 	gcc_pure
 	ConstBuffer<void> Convert(ConstBuffer<void> src) noexcept;
+
+	/**
+	 * Check whether this conversion may be performed in place,
+	 * i.e. both sample formats have the same size and Convert()
+	 * could overwrite its source buffer instead of copying to an
+	 * internal one.
+	 */
+	gcc_pure
+	bool CanConvertInPlace() const noexcept;
+
+	/**
+	 * Convert a block of PCM data, overwriting the source buffer.
+	 * May only be called if CanConvertInPlace() returned true.
+	 *
+	 * @param src the input buffer, which will be overwritten
+	 * @return the destination buffer (inside the input buffer)
+	 */
+	WritableBuffer<void> ConvertInPlace(WritableBuffer<void> src) noexcept;
 };
 
 #endif
@@ -61,6 +61,11 @@ public:
 	void Reset();
 
 	ConstBuffer<void> Resample(ConstBuffer<void> src);
+
+	/**
+	 * @see PcmResampler::Flush()
+	 */
+	ConstBuffer<void> Flush();
 };
 
 #endif
@@ -20,8 +20,103 @@
 #include "config.h"
 #include "Interleave.hxx"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include <string.h>
 
+#ifdef __SSE2__
+
+/**
+ * Interleave two planar 16 bit channels, 8 frames per iteration.
+ *
+ * @return the number of frames processed (a multiple of 8)
+ */
+static size_t
+PcmInterleaveStereo16Sse2(int16_t *gcc_restrict dest,
+			  const int16_t *gcc_restrict src1,
+			  const int16_t *gcc_restrict src2,
+			  size_t n_frames) noexcept
+{
+	for (size_t i = 0; i + 8 <= n_frames; i += 8, dest += 16) {
+		const __m128i a = _mm_loadu_si128((const __m128i *)(src1 + i));
+		const __m128i b = _mm_loadu_si128((const __m128i *)(src2 + i));
+
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_unpacklo_epi16(a, b));
+		_mm_storeu_si128((__m128i *)(dest + 8),
+				 _mm_unpackhi_epi16(a, b));
+	}
+
+	return n_frames - n_frames % 8;
+}
+
+/**
+ * Interleave two planar 32 bit channels, 4 frames per iteration.
+ *
+ * @return the number of frames processed (a multiple of 4)
+ */
+static size_t
+PcmInterleaveStereo32Sse2(int32_t *gcc_restrict dest,
+			  const int32_t *gcc_restrict src1,
+			  const int32_t *gcc_restrict src2,
+			  size_t n_frames) noexcept
+{
+	for (size_t i = 0; i + 4 <= n_frames; i += 4, dest += 8) {
+		const __m128i a = _mm_loadu_si128((const __m128i *)(src1 + i));
+		const __m128i b = _mm_loadu_si128((const __m128i *)(src2 + i));
+
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_unpacklo_epi32(a, b));
+		_mm_storeu_si128((__m128i *)(dest + 4),
+				 _mm_unpackhi_epi32(a, b));
+	}
+
+	return n_frames - n_frames % 4;
+}
+
+/**
+ * Interleave an even number of planar 32 bit channels, 4 frames per
+ * iteration: each channel pair is transposed with unpack
+ * instructions and scattered into the frames with 8 byte stores.
+ *
+ * @return the number of frames processed (a multiple of 4)
+ */
+static size_t
+PcmInterleave32Sse2(int32_t *gcc_restrict dest,
+		    const ConstBuffer<const int32_t *> src,
+		    size_t n_frames) noexcept
+{
+	const size_t channels = src.size;
+
+	for (size_t i = 0; i + 4 <= n_frames; i += 4) {
+		int32_t *frame = dest + i * channels;
+
+		for (size_t c = 0; c < channels; c += 2) {
+			const __m128i a =
+				_mm_loadu_si128((const __m128i *)(src[c] + i));
+			const __m128i b =
+				_mm_loadu_si128((const __m128i *)(src[c + 1] + i));
+
+			const __m128 lo =
+				_mm_castsi128_ps(_mm_unpacklo_epi32(a, b));
+			const __m128 hi =
+				_mm_castsi128_ps(_mm_unpackhi_epi32(a, b));
+
+			float *d = (float *)(frame + c);
+			_mm_storel_pi((__m64 *)d, lo);
+			_mm_storeh_pi((__m64 *)(d + channels), lo);
+			_mm_storel_pi((__m64 *)(d + 2 * channels), hi);
+			_mm_storeh_pi((__m64 *)(d + 3 * channels), hi);
+		}
+	}
+
+	return n_frames - n_frames % 4;
+}
+
+#endif /* __SSE2__ */
+
 static void
 GenericPcmInterleave(uint8_t *gcc_restrict dest,
 		     ConstBuffer<const uint8_t *> src,
@@ -75,6 +170,18 @@ PcmInterleave16(int16_t *gcc_restrict dest,
 		const ConstBuffer<const int16_t *> src,
 		size_t n_frames)
 {
+#ifdef __SSE2__
+	if (src.size == 2) {
+		const size_t done = PcmInterleaveStereo16Sse2(dest,
+							      src[0], src[1],
+							      n_frames);
+		PcmInterleaveStereo(dest + done * 2,
+				    src[0] + done, src[1] + done,
+				    n_frames - done);
+		return;
+	}
+#endif
+
 	PcmInterleaveT(dest, src, n_frames);
 }
 
@@ -83,6 +190,33 @@ PcmInterleave32(int32_t *gcc_restrict dest,
 		const ConstBuffer<const int32_t *> src,
 		size_t n_frames)
 {
+#ifdef __SSE2__
+	if (src.size == 2) {
+		const size_t done = PcmInterleaveStereo32Sse2(dest,
+							      src[0], src[1],
+							      n_frames);
+		PcmInterleaveStereo(dest + done * 2,
+				    src[0] + done, src[1] + done,
+				    n_frames - done);
+		return;
+	}
+
+	if (src.size % 2 == 0 && src.size <= 8) {
+		const size_t done = PcmInterleave32Sse2(dest, src, n_frames);
+		if (done > 0) {
+			const int32_t *tail[8];
+			for (size_t c = 0; c < src.size; ++c)
+				tail[c] = src[c] + done;
+
+			PcmInterleaveT(dest + done * src.size,
+				       ConstBuffer<const int32_t *>(tail,
+								    src.size),
+				       n_frames - done);
+			return;
+		}
+	}
+#endif
+
 	PcmInterleaveT(dest, src, n_frames);
 }
 
@@ -19,6 +19,7 @@
 
 #include "config.h"
 #include "PcmBuffer.hxx"
+#include "util/HeapProfile.hxx"
 
 void *
 PcmBuffer::Get(size_t new_size)
@@ -28,5 +29,13 @@ PcmBuffer::Get(size_t new_size)
 		   assumed to be an error condition */
 		new_size = 1;
 
-	return buffer.Get(new_size);
+	const size_t old_capacity = buffer.GetCapacity();
+
+	void *p = buffer.Get(new_size);
+
+	if (buffer.GetCapacity() != old_capacity)
+		heap_profile_record(HeapTag::PCM_BUFFER,
+				    buffer.GetCapacity());
+
+	return p;
 }
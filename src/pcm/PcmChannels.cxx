@@ -26,6 +26,10 @@
 #include "util/ConstBuffer.hxx"
 #include "util/WritableBuffer.hxx"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include <array>
 #include <algorithm>
 
@@ -95,6 +99,347 @@ NToStereo(typename Traits::pointer_type dest,
 	return dest;
 }
 
+/* generic fall-backs for the per-format optimized entry points
+   below */
+
+template<SampleFormat F, class Traits=SampleTraits<F>>
+static void
+MonoToStereoOpt(typename Traits::pointer_type dest,
+		typename Traits::const_pointer_type src,
+		typename Traits::const_pointer_type end)
+{
+	MonoToStereo(dest, src, end);
+}
+
+template<SampleFormat F, class Traits=SampleTraits<F>>
+static void
+StereoToMonoOpt(typename Traits::pointer_type dest,
+		typename Traits::const_pointer_type src,
+		typename Traits::const_pointer_type end)
+{
+	StereoToMono<F, Traits>(dest, src, end);
+}
+
+template<SampleFormat F, class Traits=SampleTraits<F>>
+static void
+NToStereoOpt(typename Traits::pointer_type dest,
+	     unsigned src_channels,
+	     typename Traits::const_pointer_type src,
+	     typename Traits::const_pointer_type end)
+{
+	NToStereo<F, Traits>(dest, src_channels, src, end);
+}
+
+#ifdef __SSE2__
+
+/**
+ * Divide by two, rounding towards zero like C++ integer division.
+ */
+static inline __m128i
+TruncDiv2(__m128i x) noexcept
+{
+	return _mm_srai_epi32(_mm_add_epi32(x, _mm_srli_epi32(x, 31)), 1);
+}
+
+/**
+ * Duplicate 16 bit samples, 8 per iteration.
+ */
+static void
+MonoToStereo16Sse2(int16_t *gcc_restrict &dest,
+		   const int16_t *gcc_restrict &src,
+		   const int16_t *end) noexcept
+{
+	for (; src + 8 <= end; src += 8, dest += 16) {
+		const __m128i v = _mm_loadu_si128((const __m128i *)src);
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_unpacklo_epi16(v, v));
+		_mm_storeu_si128((__m128i *)(dest + 8),
+				 _mm_unpackhi_epi16(v, v));
+	}
+}
+
+/**
+ * Duplicate 32 bit (or float) samples, 4 per iteration.
+ */
+static void
+MonoToStereo32Sse2(int32_t *gcc_restrict &dest,
+		   const int32_t *gcc_restrict &src,
+		   const int32_t *end) noexcept
+{
+	for (; src + 4 <= end; src += 4, dest += 8) {
+		const __m128i v = _mm_loadu_si128((const __m128i *)src);
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_unpacklo_epi32(v, v));
+		_mm_storeu_si128((__m128i *)(dest + 4),
+				 _mm_unpackhi_epi32(v, v));
+	}
+}
+
+template<>
+void
+MonoToStereoOpt<SampleFormat::S16>(int16_t *dest,
+				   const int16_t *src, const int16_t *end)
+{
+	MonoToStereo16Sse2(dest, src, end);
+	MonoToStereo(dest, src, end);
+}
+
+template<>
+void
+MonoToStereoOpt<SampleFormat::S24_P32>(int32_t *dest,
+				       const int32_t *src, const int32_t *end)
+{
+	MonoToStereo32Sse2(dest, src, end);
+	MonoToStereo(dest, src, end);
+}
+
+template<>
+void
+MonoToStereoOpt<SampleFormat::S32>(int32_t *dest,
+				   const int32_t *src, const int32_t *end)
+{
+	MonoToStereo32Sse2(dest, src, end);
+	MonoToStereo(dest, src, end);
+}
+
+template<>
+void
+MonoToStereoOpt<SampleFormat::FLOAT>(float *dest,
+				     const float *src, const float *end)
+{
+	auto *d = (int32_t *)dest;
+	auto *s = (const int32_t *)src;
+	MonoToStereo32Sse2(d, s, (const int32_t *)end);
+	MonoToStereo((float *)d, (const float *)s, end);
+}
+
+template<>
+void
+StereoToMonoOpt<SampleFormat::S16>(int16_t *dest,
+				   const int16_t *src, const int16_t *end)
+{
+	/* (L+R) per frame via one "madd" with a vector of ones */
+	const __m128i ones = _mm_set1_epi16(1);
+
+	for (; src + 16 <= end; src += 16, dest += 8) {
+		const __m128i s0 =
+			TruncDiv2(_mm_madd_epi16(_mm_loadu_si128((const __m128i *)src),
+						 ones));
+		const __m128i s1 =
+			TruncDiv2(_mm_madd_epi16(_mm_loadu_si128((const __m128i *)(src + 8)),
+						 ones));
+
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_packs_epi32(s0, s1));
+	}
+
+	StereoToMono<SampleFormat::S16>(dest, src, end);
+}
+
+template<>
+void
+StereoToMonoOpt<SampleFormat::S24_P32>(int32_t *dest,
+				       const int32_t *src, const int32_t *end)
+{
+	/* 24 bit sums still fit 32 bit lanes */
+	for (; src + 8 <= end; src += 8, dest += 4) {
+		const __m128 v0 =
+			_mm_castsi128_ps(_mm_loadu_si128((const __m128i *)src));
+		const __m128 v1 =
+			_mm_castsi128_ps(_mm_loadu_si128((const __m128i *)(src + 4)));
+
+		const __m128i l =
+			_mm_castps_si128(_mm_shuffle_ps(v0, v1,
+							_MM_SHUFFLE(2, 0, 2, 0)));
+		const __m128i r =
+			_mm_castps_si128(_mm_shuffle_ps(v0, v1,
+							_MM_SHUFFLE(3, 1, 3, 1)));
+
+		_mm_storeu_si128((__m128i *)dest,
+				 TruncDiv2(_mm_add_epi32(l, r)));
+	}
+
+	StereoToMono<SampleFormat::S24_P32>(dest, src, end);
+}
+
+template<>
+void
+StereoToMonoOpt<SampleFormat::S32>(int32_t *dest,
+				   const int32_t *src, const int32_t *end)
+{
+	/* the sum can overflow 32 bits; average in double precision,
+	   truncating like the scalar code */
+	for (; src + 8 <= end; src += 8, dest += 4) {
+		const __m128 v0 =
+			_mm_castsi128_ps(_mm_loadu_si128((const __m128i *)src));
+		const __m128 v1 =
+			_mm_castsi128_ps(_mm_loadu_si128((const __m128i *)(src + 4)));
+
+		const __m128i l =
+			_mm_castps_si128(_mm_shuffle_ps(v0, v1,
+							_MM_SHUFFLE(2, 0, 2, 0)));
+		const __m128i r =
+			_mm_castps_si128(_mm_shuffle_ps(v0, v1,
+							_MM_SHUFFLE(3, 1, 3, 1)));
+
+		const __m128d s0 =
+			_mm_mul_pd(_mm_add_pd(_mm_cvtepi32_pd(l),
+					      _mm_cvtepi32_pd(r)),
+				   _mm_set1_pd(0.5));
+		const __m128d s1 =
+			_mm_mul_pd(_mm_add_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(l, l)),
+					      _mm_cvtepi32_pd(_mm_unpackhi_epi64(r, r))),
+				   _mm_set1_pd(0.5));
+
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_unpacklo_epi64(_mm_cvttpd_epi32(s0),
+						    _mm_cvttpd_epi32(s1)));
+	}
+
+	StereoToMono<SampleFormat::S32>(dest, src, end);
+}
+
+template<>
+void
+StereoToMonoOpt<SampleFormat::FLOAT>(float *dest,
+				     const float *src, const float *end)
+{
+	for (; src + 8 <= end; src += 8, dest += 4) {
+		const __m128 v0 = _mm_loadu_ps(src);
+		const __m128 v1 = _mm_loadu_ps(src + 4);
+
+		const __m128 l = _mm_shuffle_ps(v0, v1,
+						_MM_SHUFFLE(2, 0, 2, 0));
+		const __m128 r = _mm_shuffle_ps(v0, v1,
+						_MM_SHUFFLE(3, 1, 3, 1));
+
+		_mm_storeu_ps(dest, _mm_mul_ps(_mm_add_ps(l, r),
+					       _mm_set1_ps(0.5f)));
+	}
+
+	StereoToMono<SampleFormat::FLOAT>(dest, src, end);
+}
+
+template<>
+void
+NToStereoOpt<SampleFormat::S16>(int16_t *dest,
+				unsigned src_channels,
+				const int16_t *src, const int16_t *end)
+{
+	if (src_channels == 8) {
+		/* four frames per iteration: sum each frame pairwise
+		   with "madd", transpose the partial sums and finish
+		   the reduction vertically */
+		const __m128i ones = _mm_set1_epi16(1);
+
+		for (; src + 32 <= end; src += 32, dest += 8) {
+			const __m128i p0 =
+				_mm_madd_epi16(_mm_loadu_si128((const __m128i *)src),
+					       ones);
+			const __m128i p1 =
+				_mm_madd_epi16(_mm_loadu_si128((const __m128i *)(src + 8)),
+					       ones);
+			const __m128i p2 =
+				_mm_madd_epi16(_mm_loadu_si128((const __m128i *)(src + 16)),
+					       ones);
+			const __m128i p3 =
+				_mm_madd_epi16(_mm_loadu_si128((const __m128i *)(src + 24)),
+					       ones);
+
+			const __m128i u =
+				_mm_add_epi32(_mm_unpacklo_epi32(p0, p1),
+					      _mm_unpackhi_epi32(p0, p1));
+			const __m128i w =
+				_mm_add_epi32(_mm_unpacklo_epi32(p2, p3),
+					      _mm_unpackhi_epi32(p2, p3));
+
+			__m128i sum =
+				_mm_add_epi32(_mm_unpacklo_epi64(u, w),
+					      _mm_unpackhi_epi64(u, w));
+
+			/* divide by 8, rounding towards zero */
+			const __m128i bias =
+				_mm_srli_epi32(_mm_srai_epi32(sum, 31), 29);
+			sum = _mm_srai_epi32(_mm_add_epi32(sum, bias), 3);
+
+			const __m128i mono = _mm_packs_epi32(sum, sum);
+			_mm_storeu_si128((__m128i *)dest,
+					 _mm_unpacklo_epi16(mono, mono));
+		}
+	} else if (src_channels == 6) {
+		/* two frames per iteration; the last two lanes of
+		   each 16 byte load belong to the next frame and are
+		   masked away */
+		const __m128i ones = _mm_set1_epi16(1);
+		const __m128i mask = _mm_set_epi32(0, -1, -1, -1);
+
+		/* the second load must not overrun the buffer */
+		for (; src + 14 <= end; src += 12, dest += 4) {
+			__m128i f0 =
+				_mm_and_si128(_mm_loadu_si128((const __m128i *)src),
+					      mask);
+			__m128i f1 =
+				_mm_and_si128(_mm_loadu_si128((const __m128i *)(src + 6)),
+					      mask);
+
+			f0 = _mm_madd_epi16(f0, ones);
+			f1 = _mm_madd_epi16(f1, ones);
+
+			/* horizontal sums of both frames */
+			f0 = _mm_add_epi32(f0, _mm_shuffle_epi32(f0, _MM_SHUFFLE(1, 0, 3, 2)));
+			f0 = _mm_add_epi32(f0, _mm_shuffle_epi32(f0, _MM_SHUFFLE(2, 3, 0, 1)));
+			f1 = _mm_add_epi32(f1, _mm_shuffle_epi32(f1, _MM_SHUFFLE(1, 0, 3, 2)));
+			f1 = _mm_add_epi32(f1, _mm_shuffle_epi32(f1, _MM_SHUFFLE(2, 3, 0, 1)));
+
+			/* divide by 6 in double precision, which
+			   truncates exactly like the scalar code */
+			const __m128i sum = _mm_unpacklo_epi32(f0, f1);
+			const __m128i mono =
+				_mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(sum),
+							    _mm_set1_pd(6.0)));
+
+			const __m128i packed = _mm_packs_epi32(mono, mono);
+			_mm_storel_epi64((__m128i *)dest,
+					 _mm_unpacklo_epi16(packed, packed));
+		}
+	}
+
+	NToStereo<SampleFormat::S16>(dest, src_channels, src, end);
+}
+
+template<>
+void
+NToStereoOpt<SampleFormat::FLOAT>(float *dest,
+				  unsigned src_channels,
+				  const float *src, const float *end)
+{
+	if (src_channels == 8) {
+		for (; src + 8 <= end; src += 8, dest += 2) {
+			__m128 v = _mm_add_ps(_mm_loadu_ps(src),
+					      _mm_loadu_ps(src + 4));
+			v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+			v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+			v = _mm_div_ps(v, _mm_set1_ps(8.0f));
+			_mm_storel_pi((__m64 *)dest, v);
+		}
+	} else if (src_channels == 6) {
+		for (; src + 6 <= end; src += 6, dest += 2) {
+			const __m128 tail =
+				_mm_loadl_pi(_mm_setzero_ps(),
+					     (const __m64 *)(src + 4));
+			__m128 v = _mm_add_ps(_mm_loadu_ps(src), tail);
+			v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+			v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+			v = _mm_div_ps(v, _mm_set1_ps(6.0f));
+			_mm_storel_pi((__m64 *)dest, v);
+		}
+	}
+
+	NToStereo<SampleFormat::FLOAT>(dest, src_channels, src, end);
+}
+
+#endif /* __SSE2__ */
+
 /**
  * Convert stereo to N channels (where N > 2).  Left and right map to
  * the first two channels (front left and front right), and the
@@ -165,11 +510,11 @@ ConvertChannels(PcmBuffer &buffer,
 	auto dest = buffer.GetT<typename Traits::value_type>(dest_size);
 
 	if (src_channels == 1 && dest_channels == 2)
-		MonoToStereo(dest, src.begin(), src.end());
+		MonoToStereoOpt<F>(dest, src.begin(), src.end());
 	else if (src_channels == 2 && dest_channels == 1)
-		StereoToMono<F>(dest, src.begin(), src.end());
+		StereoToMonoOpt<F>(dest, src.begin(), src.end());
 	else if (dest_channels == 2)
-		NToStereo<F>(dest, src_channels, src.begin(), src.end());
+		NToStereoOpt<F>(dest, src_channels, src.begin(), src.end());
 	else if (src_channels == 2 && dest_channels > 2)
 		StereoToN<F, Traits>(dest, dest_channels,
 				     src.begin(), src.end());
@@ -21,6 +21,7 @@
 #include "PcmConvert.hxx"
 #include "ConfiguredResampler.hxx"
 #include "util/ConstBuffer.hxx"
+#include "util/WritableBuffer.hxx"
 
 #include <assert.h>
 
@@ -130,6 +131,22 @@ PcmConvert::Reset()
 ConstBuffer<void>
 PcmConvert::Convert(ConstBuffer<void> buffer)
 {
+	return Convert(buffer, false);
+}
+
+ConstBuffer<void>
+PcmConvert::Convert(WritableBuffer<void> buffer)
+{
+	return Convert({buffer.data, buffer.size}, true);
+}
+
+ConstBuffer<void>
+PcmConvert::Convert(ConstBuffer<void> buffer, bool writable)
+{
+	/* "writable" tracks whether "buffer" may be overwritten,
+	   i.e. it was passed in as such or it points into a buffer
+	   owned by one of our stages */
+
 #ifdef ENABLE_DSD
 	if (src_format.format == SampleFormat::DSD) {
 		auto s = ConstBuffer<uint8_t>::FromVoid(buffer);
@@ -138,14 +155,54 @@ PcmConvert::Convert(ConstBuffer<void> buffer)
 			throw std::runtime_error("DSD to PCM conversion failed");
 
 		buffer = d.ToVoid();
+		writable = true;
 	}
 #endif
 
-	if (enable_resampler)
+	if (enable_resampler) {
 		buffer = resampler.Resample(buffer);
+		writable = true;
+	}
 
-	if (enable_format)
-		buffer = format_converter.Convert(buffer);
+	if (enable_format) {
+		if (writable && format_converter.CanConvertInPlace()) {
+			/* the previous stage's output is ours and
+			   both sample formats have the same size:
+			   convert in place, saving one copy */
+			auto w = format_converter.ConvertInPlace({const_cast<void *>(buffer.data),
+								  buffer.size});
+			buffer = {w.data, w.size};
+		} else
+			buffer = format_converter.Convert(buffer);
+	}
+
+	if (enable_channels)
+		buffer = channels_converter.Convert(buffer);
+
+	return buffer;
+}
+
+ConstBuffer<void>
+PcmConvert::Flush()
+{
+	if (!enable_resampler)
+		/* only the resampler buffers data between calls */
+		return nullptr;
+
+	auto buffer = resampler.Flush();
+	if (buffer.IsNull())
+		return nullptr;
+
+	if (enable_format) {
+		if (format_converter.CanConvertInPlace()) {
+			/* the resampler's output is ours, convert it
+			   in place */
+			auto w = format_converter.ConvertInPlace({const_cast<void *>(buffer.data),
+								  buffer.size});
+			buffer = {w.data, w.size};
+		} else
+			buffer = format_converter.Convert(buffer);
+	}
 
 	if (enable_channels)
 		buffer = channels_converter.Convert(buffer);
@@ -31,6 +31,7 @@
 #endif
 
 template<typename T> struct ConstBuffer;
+template<typename T> struct WritableBuffer;
 
 /**
  * This object is statically allocated (within another struct), and
@@ -81,6 +82,27 @@ public:
 	 * @return the destination buffer
 	 */
 	ConstBuffer<void> Convert(ConstBuffer<void> src);
+
+	/**
+	 * Like Convert(), but the source buffer is writable and may
+	 * be overwritten by intermediate conversion stages.
+	 *
+	 * Throws std::runtime_error on error.
+	 */
+	ConstBuffer<void> Convert(WritableBuffer<void> src);
+
+	/**
+	 * Flushes data buffered inside the resampler and returns it,
+	 * converted to the destination format.
+	 *
+	 * Throws std::runtime_error on error.
+	 *
+	 * @return the remaining data (nullptr if there is none)
+	 */
+	ConstBuffer<void> Flush();
+
+private:
+	ConstBuffer<void> Convert(ConstBuffer<void> src, bool writable);
 };
 
 void
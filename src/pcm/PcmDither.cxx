@@ -22,6 +22,10 @@
 #include "PcmPrng.hxx"
 #include "Traits.hxx"
 
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 template<typename T, T MIN, T MAX, unsigned scale_bits>
 inline T
 PcmDither::Dither(T sample)
@@ -98,12 +102,116 @@ PcmDither::DitherConvert(typename DT::pointer_type dest,
 		*dest++ = DitherConvert<ST, DT>(*src++);
 }
 
+#if defined(__GNUC__) && defined(__x86_64__)
+
+/**
+ * The multiplier of the LCG from pcm_prng() composed with itself #n
+ * times, i.e. x advances n steps via x*Multiplier(n)+Increment(n).
+ */
+static constexpr uint32_t
+PcmPrngMultiplier(unsigned n) noexcept
+{
+	return n == 0
+		? 1
+		: uint32_t(0x0019660d) * PcmPrngMultiplier(n - 1);
+}
+
+static constexpr uint32_t
+PcmPrngIncrement(unsigned n) noexcept
+{
+	return n == 0
+		? 0
+		: uint32_t(0x0019660d) * PcmPrngIncrement(n - 1) +
+		uint32_t(0x3c6ef35f);
+}
+
+static inline bool
+pcm_dither_have_avx2() noexcept
+{
+	static const bool value = __builtin_cpu_supports("avx2");
+	return value;
+}
+
+__attribute__((target("avx2")))
+inline size_t
+PcmDither::Dither24To16Avx2(int16_t *dest, const int32_t *src,
+			    size_t n) noexcept
+{
+	constexpr unsigned scale_bits = 8;
+
+	if (n < 8)
+		return 0;
+
+	/* seed the lanes with consecutive PRNG states; sample i uses
+	   states i and i+1 for the triangular dither, just like the
+	   scalar code */
+	uint32_t seed[9];
+	seed[0] = random;
+	for (unsigned i = 1; i < 9; ++i)
+		seed[i] = pcm_prng(seed[i - 1]);
+
+	__m256i prev = _mm256_loadu_si256((const __m256i *)&seed[0]);
+	__m256i cur = _mm256_loadu_si256((const __m256i *)&seed[1]);
+
+	const __m256i jump_a = _mm256_set1_epi32(PcmPrngMultiplier(8));
+	const __m256i jump_c = _mm256_set1_epi32(PcmPrngIncrement(8));
+	const __m256i vmask = _mm256_set1_epi32((1 << scale_bits) - 1);
+	const __m256i vround = _mm256_set1_epi32(1 << (scale_bits - 1));
+
+	__m256i last = cur;
+
+	for (size_t i = 0; i < n / 8; ++i, src += 8, dest += 8) {
+		const __m256i sample =
+			_mm256_loadu_si256((const __m256i *)src);
+
+		/* triangular dither: difference of two consecutive
+		   uniform PRNG values */
+		const __m256i tpdf =
+			_mm256_sub_epi32(_mm256_and_si256(cur, vmask),
+					 _mm256_and_si256(prev, vmask));
+
+		__m256i t = _mm256_add_epi32(_mm256_add_epi32(sample, vround),
+					     tpdf);
+		t = _mm256_srai_epi32(t, scale_bits);
+
+		/* the saturating pack implements the clipping */
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_packs_epi32(_mm256_castsi256_si128(t),
+						 _mm256_extracti128_si256(t, 1)));
+
+		last = cur;
+
+		/* advance every lane by 8 PRNG steps */
+		prev = _mm256_add_epi32(_mm256_mullo_epi32(prev, jump_a),
+					jump_c);
+		cur = _mm256_add_epi32(_mm256_mullo_epi32(cur, jump_a),
+				       jump_c);
+	}
+
+	/* continue the same PRNG stream in the scalar code */
+	random = _mm256_extract_epi32(last, 7);
+
+	return n - n % 8;
+}
+
+#endif /* __x86_64__ */
+
 inline void
 PcmDither::Dither24To16(int16_t *dest, const int32_t *src,
 			const int32_t *src_end)
 {
 	typedef SampleTraits<SampleFormat::S24_P32> ST;
 	typedef SampleTraits<SampleFormat::S16> DT;
+
+#if defined(__GNUC__) && defined(__x86_64__)
+	if (pcm_dither_have_avx2()) {
+		const size_t done = Dither24To16Avx2(dest, src,
+						     src_end - src);
+		dest += done;
+		src += done;
+	}
+#endif
+
 	DitherConvert<ST, DT>(dest, src, src_end);
 }
 
@@ -20,6 +20,7 @@
 #ifndef MPD_PCM_DITHER_HXX
 #define MPD_PCM_DITHER_HXX
 
+#include <stddef.h>
 #include <stdint.h>
 
 enum class SampleFormat : uint8_t;
@@ -79,6 +80,20 @@ private:
 	void DitherConvert(typename DT::pointer_type dest,
 			   typename ST::const_pointer_type src,
 			   typename ST::const_pointer_type src_end);
+
+#if defined(__GNUC__) && defined(__x86_64__)
+	/**
+	 * Dither a whole buffer of 24 bit samples down to 16 bits
+	 * using AVX2, 8 samples at a time.  Each vector lane runs the
+	 * LCG from pcm_prng() with a stride of 8 steps, so the
+	 * triangular dither sequence is the same as in the scalar
+	 * code; only the error feedback term is omitted.
+	 *
+	 * @return the number of samples processed (a multiple of 8)
+	 */
+	size_t Dither24To16Avx2(int16_t *dest, const int32_t *src,
+				size_t n) noexcept;
+#endif
 };
 
 #endif
@@ -25,6 +25,56 @@
 
 #include <assert.h>
 
+#if defined(__GNUC__) && defined(__x86_64__)
+
+#include <tmmintrin.h>
+
+static inline bool
+HaveSsse3() noexcept
+{
+	static const bool value = __builtin_cpu_supports("ssse3");
+	return value;
+}
+
+/**
+ * Build stereo DoP frames from 16 source bytes (4 DSD frames) per
+ * iteration: "pshufb" places the two DSD bytes of each output sample
+ * and the 0x05/0xfa markers are merged with a bitwise "or".
+ *
+ * @return the number of DoP samples written (a multiple of 8)
+ */
+__attribute__((target("ssse3")))
+static size_t
+DsdToDopStereoSsse3(uint32_t *dest, const uint8_t *src,
+		    size_t n_samples) noexcept
+{
+	const __m128i lower = _mm_set_epi8(-1, -1, 5, 7,
+					   -1, -1, 4, 6,
+					   -1, -1, 1, 3,
+					   -1, -1, 0, 2);
+	const __m128i upper = _mm_set_epi8(-1, -1, 13, 15,
+					   -1, -1, 12, 14,
+					   -1, -1, 9, 11,
+					   -1, -1, 8, 10);
+	const __m128i marker = _mm_set_epi32(0xfffa0000, 0xfffa0000,
+					     0xff050000, 0xff050000);
+
+	for (size_t i = 0; i < n_samples / 8; ++i, src += 16, dest += 8) {
+		const __m128i v = _mm_loadu_si128((const __m128i *)src);
+
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_or_si128(_mm_shuffle_epi8(v, lower),
+					      marker));
+		_mm_storeu_si128((__m128i *)(dest + 4),
+				 _mm_or_si128(_mm_shuffle_epi8(v, upper),
+					      marker));
+	}
+
+	return n_samples - n_samples % 8;
+}
+
+#endif /* __x86_64__ */
+
 constexpr
 static inline uint32_t
 pcm_two_dsd_to_dop_marker1(uint8_t a, uint8_t b) noexcept
@@ -58,7 +108,19 @@ pcm_dsd_to_dop(PcmBuffer &buffer, unsigned channels,
 		*dest = dest0;
 
 	auto src = _src.data;
-	for (unsigned i = num_frames / 2; i > 0; --i) {
+	unsigned num_groups = num_frames / 2;
+
+#if defined(__GNUC__) && defined(__x86_64__)
+	if (channels == 2 && HaveSsse3()) {
+		const size_t done = DsdToDopStereoSsse3(dest, src,
+							num_samples);
+		dest += done;
+		src += done * 2;
+		num_groups -= done / 4;
+	}
+#endif
+
+	for (unsigned i = num_groups; i > 0; --i) {
 		for (unsigned c = channels; c > 0; --c) {
 			/* each 24 bit sample has 16 DSD sample bits
 			   plus the magic 0x05 marker */
@@ -25,20 +25,26 @@
 #include "FloatConvert.hxx"
 #include "ShiftConvert.hxx"
 #include "util/ConstBuffer.hxx"
+#include "util/WritableBuffer.hxx"
+
+#include <assert.h>
 
 #include "PcmDither.cxx" // including the .cxx file to get inlined templates
 
 /**
  * Wrapper for a class that converts one sample at a time into one
  * that converts a buffer at a time.
+ *
+ * The pointers are not "restrict" because pcm_convert_in_place()
+ * passes the same buffer for input and output.
  */
 template<typename C>
 struct PerSampleConvert : C {
 	typedef typename C::SrcTraits SrcTraits;
 	typedef typename C::DstTraits DstTraits;
 
-	void Convert(typename DstTraits::pointer_type gcc_restrict out,
-		     typename SrcTraits::const_pointer_type gcc_restrict in,
+	void Convert(typename DstTraits::pointer_type out,
+		     typename SrcTraits::const_pointer_type in,
 		     size_t n) const {
 		for (size_t i = 0; i != n; ++i)
 			out[i] = C::Convert(in[i]);
@@ -116,6 +122,27 @@ struct FloatToInteger<SampleFormat::S16, SampleTraits<SampleFormat::S16>>
 
 #endif
 
+#ifdef __SSE2__
+#include "Sse.hxx"
+
+template<>
+struct FloatToInteger<SampleFormat::S16, SampleTraits<SampleFormat::S16>>
+	: GlueOptimizedConvert<SseFloatTo16,
+			       PortableFloatToInteger<SampleFormat::S16>> {};
+
+template<>
+struct FloatToInteger<SampleFormat::S24_P32,
+		      SampleTraits<SampleFormat::S24_P32>>
+	: GlueOptimizedConvert<SseFloatTo24,
+			       PortableFloatToInteger<SampleFormat::S24_P32>> {};
+
+template<>
+struct FloatToInteger<SampleFormat::S32, SampleTraits<SampleFormat::S32>>
+	: GlueOptimizedConvert<SseFloatTo32,
+			       PortableFloatToInteger<SampleFormat::S32>> {};
+
+#endif
+
 template<class C>
 static ConstBuffer<typename C::DstTraits::value_type>
 AllocateConvert(PcmBuffer &buffer, C convert,
@@ -330,6 +357,22 @@ pcm_convert_to_32(PcmBuffer &buffer,
 struct Convert8ToFloat
 	: PerSampleConvert<IntegerToFloatSampleConvert<SampleFormat::S8>> {};
 
+#ifdef __SSE2__
+
+struct Convert16ToFloat
+	: GlueOptimizedConvert<SseS16ToFloat,
+			       PerSampleConvert<IntegerToFloatSampleConvert<SampleFormat::S16>>> {};
+
+struct Convert24ToFloat
+	: GlueOptimizedConvert<SseIntegerToFloat<SampleFormat::S24_P32>,
+			       PerSampleConvert<IntegerToFloatSampleConvert<SampleFormat::S24_P32>>> {};
+
+struct Convert32ToFloat
+	: GlueOptimizedConvert<SseIntegerToFloat<SampleFormat::S32>,
+			       PerSampleConvert<IntegerToFloatSampleConvert<SampleFormat::S32>>> {};
+
+#else
+
 struct Convert16ToFloat
 	: PerSampleConvert<IntegerToFloatSampleConvert<SampleFormat::S16>> {};
 
@@ -339,6 +382,8 @@ struct Convert24ToFloat
 struct Convert32ToFloat
 	: PerSampleConvert<IntegerToFloatSampleConvert<SampleFormat::S32>> {};
 
+#endif
+
 static ConstBuffer<float>
 pcm_allocate_8_to_float(PcmBuffer &buffer, ConstBuffer<int8_t> src)
 {
@@ -394,3 +439,278 @@ pcm_convert_to_float(PcmBuffer &buffer,
 
 	return nullptr;
 }
+
+/**
+ * Instantiate a #PcmConvertFunction from a converter class.
+ */
+template<class C>
+static ConstBuffer<void>
+ConvertFunction(PcmBuffer &buffer, gcc_unused PcmDither &dither,
+		ConstBuffer<void> src)
+{
+	typedef typename C::SrcTraits::value_type SV;
+
+	return AllocateConvert(buffer, C(),
+			       ConstBuffer<SV>::FromVoid(src)).ToVoid();
+}
+
+/**
+ * Like ConvertFunction(), but for converter classes which need the
+ * #PcmDither instance (conversions to 16 bit).
+ */
+template<class C>
+static ConstBuffer<void>
+DitherConvertFunction(PcmBuffer &buffer, PcmDither &dither,
+		      ConstBuffer<void> src)
+{
+	typedef typename C::SrcTraits::value_type SV;
+
+	return AllocateConvert(buffer, C(dither),
+			       ConstBuffer<SV>::FromVoid(src)).ToVoid();
+}
+
+static ConstBuffer<void>
+PassThroughFunction(gcc_unused PcmBuffer &buffer,
+		    gcc_unused PcmDither &dither,
+		    ConstBuffer<void> src)
+{
+	return src;
+}
+
+static PcmConvertFunction
+pcm_lookup_convert_to_16(SampleFormat src_format) noexcept
+{
+	switch (src_format) {
+	case SampleFormat::UNDEFINED:
+	case SampleFormat::DSD:
+		break;
+
+	case SampleFormat::S8:
+		return ConvertFunction<Convert8To16>;
+
+	case SampleFormat::S16:
+		return PassThroughFunction;
+
+	case SampleFormat::S24_P32:
+		return DitherConvertFunction<Convert24To16>;
+
+	case SampleFormat::S32:
+		return DitherConvertFunction<Convert32To16>;
+
+	case SampleFormat::FLOAT:
+		return ConvertFunction<FloatToInteger<SampleFormat::S16>>;
+	}
+
+	return nullptr;
+}
+
+static PcmConvertFunction
+pcm_lookup_convert_to_24(SampleFormat src_format) noexcept
+{
+	switch (src_format) {
+	case SampleFormat::UNDEFINED:
+	case SampleFormat::DSD:
+		break;
+
+	case SampleFormat::S8:
+		return ConvertFunction<Convert8To24>;
+
+	case SampleFormat::S16:
+		return ConvertFunction<Convert16To24>;
+
+	case SampleFormat::S24_P32:
+		return PassThroughFunction;
+
+	case SampleFormat::S32:
+		return ConvertFunction<Convert32To24>;
+
+	case SampleFormat::FLOAT:
+		return ConvertFunction<FloatToInteger<SampleFormat::S24_P32>>;
+	}
+
+	return nullptr;
+}
+
+static PcmConvertFunction
+pcm_lookup_convert_to_32(SampleFormat src_format) noexcept
+{
+	switch (src_format) {
+	case SampleFormat::UNDEFINED:
+	case SampleFormat::DSD:
+		break;
+
+	case SampleFormat::S8:
+		return ConvertFunction<Convert8To32>;
+
+	case SampleFormat::S16:
+		return ConvertFunction<Convert16To32>;
+
+	case SampleFormat::S24_P32:
+		return ConvertFunction<Convert24To32>;
+
+	case SampleFormat::S32:
+		return PassThroughFunction;
+
+	case SampleFormat::FLOAT:
+		return ConvertFunction<FloatToInteger<SampleFormat::S32>>;
+	}
+
+	return nullptr;
+}
+
+static PcmConvertFunction
+pcm_lookup_convert_to_float(SampleFormat src_format) noexcept
+{
+	switch (src_format) {
+	case SampleFormat::UNDEFINED:
+	case SampleFormat::DSD:
+		break;
+
+	case SampleFormat::S8:
+		return ConvertFunction<Convert8ToFloat>;
+
+	case SampleFormat::S16:
+		return ConvertFunction<Convert16ToFloat>;
+
+	case SampleFormat::S24_P32:
+		return ConvertFunction<Convert24ToFloat>;
+
+	case SampleFormat::S32:
+		return ConvertFunction<Convert32ToFloat>;
+
+	case SampleFormat::FLOAT:
+		return PassThroughFunction;
+	}
+
+	return nullptr;
+}
+
+PcmConvertFunction
+pcm_lookup_convert_function(SampleFormat src_format,
+			    SampleFormat dest_format) noexcept
+{
+	switch (dest_format) {
+	case SampleFormat::UNDEFINED:
+	case SampleFormat::S8:
+	case SampleFormat::DSD:
+		break;
+
+	case SampleFormat::S16:
+		return pcm_lookup_convert_to_16(src_format);
+
+	case SampleFormat::S24_P32:
+		return pcm_lookup_convert_to_24(src_format);
+
+	case SampleFormat::S32:
+		return pcm_lookup_convert_to_32(src_format);
+
+	case SampleFormat::FLOAT:
+		return pcm_lookup_convert_to_float(src_format);
+	}
+
+	return nullptr;
+}
+
+bool
+pcm_can_convert_in_place(SampleFormat src_format,
+			 SampleFormat dest_format) noexcept
+{
+	return sample_format_size(src_format) == sizeof(int32_t) &&
+		sample_format_size(dest_format) == sizeof(int32_t);
+}
+
+/**
+ * Run a converter over a buffer, overwriting the input; this is only
+ * legal for conversions between equally sized sample formats.
+ */
+template<class C>
+static void
+ConvertInPlace(C convert, WritableBuffer<void> buffer)
+{
+	static_assert(sizeof(typename C::SrcTraits::value_type) ==
+		      sizeof(typename C::DstTraits::value_type),
+		      "Source and destination sample size must match");
+
+	const auto src = WritableBuffer<typename C::SrcTraits::value_type>::FromVoid(buffer);
+	convert.Convert((typename C::DstTraits::pointer_type)buffer.data,
+			src.data, src.size);
+}
+
+void
+pcm_convert_in_place(SampleFormat src_format, SampleFormat dest_format,
+		     WritableBuffer<void> buffer) noexcept
+{
+	assert(pcm_can_convert_in_place(src_format, dest_format));
+
+	switch (src_format) {
+	case SampleFormat::S24_P32:
+		if (dest_format == SampleFormat::S32)
+			ConvertInPlace(Convert24To32(), buffer);
+		else if (dest_format == SampleFormat::FLOAT)
+			ConvertInPlace(Convert24ToFloat(), buffer);
+		break;
+
+	case SampleFormat::S32:
+		if (dest_format == SampleFormat::S24_P32)
+			ConvertInPlace(Convert32To24(), buffer);
+		else if (dest_format == SampleFormat::FLOAT)
+			ConvertInPlace(Convert32ToFloat(), buffer);
+		break;
+
+	case SampleFormat::FLOAT:
+		if (dest_format == SampleFormat::S24_P32)
+			ConvertInPlace(FloatToInteger<SampleFormat::S24_P32>(),
+				       buffer);
+		else if (dest_format == SampleFormat::S32)
+			ConvertInPlace(FloatToInteger<SampleFormat::S32>(),
+				       buffer);
+		break;
+
+	default:
+		assert(false);
+		gcc_unreachable();
+	}
+}
+
+/**
+ * Instantiate a #PcmConvertInPlaceFunction from a converter class.
+ */
+template<class C>
+static void
+ConvertInPlaceFunction(WritableBuffer<void> buffer)
+{
+	ConvertInPlace(C(), buffer);
+}
+
+PcmConvertInPlaceFunction
+pcm_lookup_convert_in_place_function(SampleFormat src_format,
+				     SampleFormat dest_format) noexcept
+{
+	switch (src_format) {
+	case SampleFormat::S24_P32:
+		if (dest_format == SampleFormat::S32)
+			return ConvertInPlaceFunction<Convert24To32>;
+		else if (dest_format == SampleFormat::FLOAT)
+			return ConvertInPlaceFunction<Convert24ToFloat>;
+		break;
+
+	case SampleFormat::S32:
+		if (dest_format == SampleFormat::S24_P32)
+			return ConvertInPlaceFunction<Convert32To24>;
+		else if (dest_format == SampleFormat::FLOAT)
+			return ConvertInPlaceFunction<Convert32ToFloat>;
+		break;
+
+	case SampleFormat::FLOAT:
+		if (dest_format == SampleFormat::S24_P32)
+			return ConvertInPlaceFunction<FloatToInteger<SampleFormat::S24_P32>>;
+		else if (dest_format == SampleFormat::S32)
+			return ConvertInPlaceFunction<FloatToInteger<SampleFormat::S32>>;
+		break;
+
+	default:
+		break;
+	}
+
+	return nullptr;
+}
@@ -25,6 +25,7 @@
 #include <stdint.h>
 
 template<typename T> struct ConstBuffer;
+template<typename T> struct WritableBuffer;
 class PcmBuffer;
 class PcmDither;
 
@@ -78,4 +79,71 @@ ConstBuffer<float>
 pcm_convert_to_float(PcmBuffer &buffer,
 		     SampleFormat src_format, ConstBuffer<void> src) noexcept;
 
+/**
+ * A function which converts a buffer of PCM samples to another sample
+ * format, allocating the destination from the given #PcmBuffer.  It
+ * is looked up once per format pair with
+ * pcm_lookup_convert_function(), which eliminates the per-buffer
+ * format dispatch of the pcm_convert_to_*() functions.
+ *
+ * @param buffer a #PcmBuffer object
+ * @param dither a #PcmDither object; it is used only by conversions
+ * to 16 bit
+ * @param src the source PCM buffer
+ * @return the destination buffer
+ */
+typedef ConstBuffer<void> (*PcmConvertFunction)(PcmBuffer &buffer,
+						PcmDither &dither,
+						ConstBuffer<void> src);
+
+/**
+ * Look up the conversion function for the given sample format pair.
+ *
+ * @return the function, or nullptr if this conversion is not
+ * implemented
+ */
+gcc_const
+PcmConvertFunction
+pcm_lookup_convert_function(SampleFormat src_format,
+			    SampleFormat dest_format) noexcept;
+
+/**
+ * Like #PcmConvertFunction, but converts between two sample formats
+ * of the same size, overwriting the given buffer (see
+ * pcm_convert_in_place()).
+ */
+typedef void (*PcmConvertInPlaceFunction)(WritableBuffer<void> buffer);
+
+/**
+ * Look up the in-place conversion function for the given sample
+ * format pair.
+ *
+ * @return the function, or nullptr if this conversion cannot be
+ * performed in place
+ */
+gcc_const
+PcmConvertInPlaceFunction
+pcm_lookup_convert_in_place_function(SampleFormat src_format,
+				     SampleFormat dest_format) noexcept;
+
+/**
+ * Check whether pcm_convert_in_place() implements this conversion,
+ * i.e. both sample formats have the same size.
+ */
+gcc_const
+bool
+pcm_can_convert_in_place(SampleFormat src_format,
+			 SampleFormat dest_format) noexcept;
+
+/**
+ * Converts PCM samples to another sample format of the same size,
+ * overwriting the given buffer.  May only be called if
+ * pcm_can_convert_in_place() returned true.
+ *
+ * @param buffer the source and destination PCM buffer
+ */
+void
+pcm_convert_in_place(SampleFormat src_format, SampleFormat dest_format,
+		     WritableBuffer<void> buffer) noexcept;
+
 #endif
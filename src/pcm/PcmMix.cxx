@@ -26,6 +26,10 @@
 
 #include "PcmDither.cxx" // including the .cxx file to get inlined templates
 
+#ifdef __SSE2__
+#include "Sse.hxx"
+#endif
+
 #include <assert.h>
 #include <math.h>
 
@@ -70,10 +74,71 @@ PcmAddVolumeVoid(PcmDither &dither,
 				volume1, volume2);
 }
 
+static void
+pcm_add_vol_16(PcmDither &dither, int16_t *a, const int16_t *b, size_t n,
+	       int volume1, int volume2)
+{
+#ifdef __SSE2__
+	SseMixS16().Apply(a, b, n, volume1, volume2);
+
+	const size_t done = n - n % SseMixS16::BLOCK_SIZE;
+	a += done;
+	b += done;
+	n -= done;
+#endif
+
+	PcmAddVolume<SampleFormat::S16>(dither, a, b, n, volume1, volume2);
+}
+
+static void
+pcm_add_vol_24(PcmDither &dither, int32_t *a, const int32_t *b, size_t n,
+	       int volume1, int volume2)
+{
+#ifdef __SSE2__
+	SseMixS32().Apply(a, b, n, volume1, volume2);
+
+	const size_t done = n - n % SseMixS32::BLOCK_SIZE;
+	a += done;
+	b += done;
+	n -= done;
+#endif
+
+	PcmAddVolume<SampleFormat::S24_P32>(dither, a, b, n,
+					    volume1, volume2);
+}
+
+static void
+pcm_add_vol_32(PcmDither &dither, int32_t *a, const int32_t *b, size_t n,
+	       int volume1, int volume2)
+{
+#ifdef __SSE2__
+	SseMixS32().Apply(a, b, n, volume1, volume2);
+
+	const size_t done = n - n % SseMixS32::BLOCK_SIZE;
+	a += done;
+	b += done;
+	n -= done;
+#endif
+
+	PcmAddVolume<SampleFormat::S32>(dither, a, b, n, volume1, volume2);
+}
+
 static void
 pcm_add_vol_float(float *buffer1, const float *buffer2,
 		  unsigned num_samples, float volume1, float volume2)
 {
+#ifdef __SSE2__
+	/* float samples need no clamping, so the vector loop is a
+	   plain multiply-add */
+	SseMixFloat().Apply(buffer1, buffer2, num_samples,
+			    volume1, volume2);
+
+	const size_t done = num_samples - num_samples % SseMixFloat::BLOCK_SIZE;
+	buffer1 += done;
+	buffer2 += done;
+	num_samples -= done;
+#endif
+
 	while (num_samples > 0) {
 		float sample1 = *buffer1;
 		float sample2 = *buffer2++;
@@ -102,21 +167,21 @@ pcm_add_vol(PcmDither &dither, void *buffer1, const void *buffer2, size_t size,
 		return true;
 
 	case SampleFormat::S16:
-		PcmAddVolumeVoid<SampleFormat::S16>(dither,
-						    buffer1, buffer2, size,
-						    vol1, vol2);
+		pcm_add_vol_16(dither, (int16_t *)buffer1,
+			       (const int16_t *)buffer2,
+			       size / 2, vol1, vol2);
 		return true;
 
 	case SampleFormat::S24_P32:
-		PcmAddVolumeVoid<SampleFormat::S24_P32>(dither,
-							buffer1, buffer2, size,
-							vol1, vol2);
+		pcm_add_vol_24(dither, (int32_t *)buffer1,
+			       (const int32_t *)buffer2,
+			       size / 4, vol1, vol2);
 		return true;
 
 	case SampleFormat::S32:
-		PcmAddVolumeVoid<SampleFormat::S32>(dither,
-						    buffer1, buffer2, size,
-						    vol1, vol2);
+		pcm_add_vol_32(dither, (int32_t *)buffer1,
+			       (const int32_t *)buffer2,
+			       size / 4, vol1, vol2);
 		return true;
 
 	case SampleFormat::FLOAT:
@@ -162,9 +227,34 @@ PcmAddVoid(void *a, const void *b, size_t size)
 			  size / sample_size);
 }
 
+static void
+pcm_add_16(int16_t *a, const int16_t *b, size_t n)
+{
+#ifdef __SSE2__
+	/* the saturating vector add matches PcmClamp() exactly */
+	SseAddS16().Apply(a, b, n);
+
+	const size_t done = n - n % SseAddS16::BLOCK_SIZE;
+	a += done;
+	b += done;
+	n -= done;
+#endif
+
+	PcmAdd<SampleFormat::S16>(a, b, n);
+}
+
 static void
 pcm_add_float(float *buffer1, const float *buffer2, unsigned num_samples)
 {
+#ifdef __SSE2__
+	SseAddFloat().Apply(buffer1, buffer2, num_samples);
+
+	const size_t done = num_samples - num_samples % SseAddFloat::BLOCK_SIZE;
+	buffer1 += done;
+	buffer2 += done;
+	num_samples -= done;
+#endif
+
 	while (num_samples > 0) {
 		float sample1 = *buffer1;
 		float sample2 = *buffer2++;
@@ -188,7 +278,9 @@ pcm_add(void *buffer1, const void *buffer2, size_t size,
 		return true;
 
 	case SampleFormat::S16:
-		PcmAddVoid<SampleFormat::S16>(buffer1, buffer2, size);
+		assert(size % 2 == 0);
+		pcm_add_16((int16_t *)buffer1, (const int16_t *)buffer2,
+			   size / 2);
 		return true;
 
 	case SampleFormat::S24_P32:
@@ -20,6 +20,102 @@
 #include "PcmPack.hxx"
 #include "system/ByteOrder.hxx"
 
+#if defined(__GNUC__) && defined(__x86_64__)
+
+#include <tmmintrin.h>
+
+static inline bool
+HaveSsse3() noexcept
+{
+	static const bool value = __builtin_cpu_supports("ssse3");
+	return value;
+}
+
+/**
+ * Pack 16 samples (64 bytes) into 48 bytes per iteration using
+ * "pshufb": every input vector is compressed to 12 bytes, and the
+ * four fragments are recombined into three stores.
+ *
+ * @return the number of samples processed (a multiple of 16)
+ */
+__attribute__((target("ssse3")))
+static size_t
+PackS24Ssse3(uint8_t *dest, const int32_t *src, size_t n) noexcept
+{
+	const __m128i compress = _mm_set_epi8(-1, -1, -1, -1,
+					      14, 13, 12,
+					      10, 9, 8,
+					      6, 5, 4,
+					      2, 1, 0);
+
+	for (size_t i = 0; i < n / 16; ++i, src += 16, dest += 48) {
+		const __m128i s0 =
+			_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)src),
+					 compress);
+		const __m128i s1 =
+			_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + 4)),
+					 compress);
+		const __m128i s2 =
+			_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + 8)),
+					 compress);
+		const __m128i s3 =
+			_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + 12)),
+					 compress);
+
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_or_si128(s0, _mm_slli_si128(s1, 12)));
+		_mm_storeu_si128((__m128i *)(dest + 16),
+				 _mm_or_si128(_mm_srli_si128(s1, 4),
+					      _mm_slli_si128(s2, 8)));
+		_mm_storeu_si128((__m128i *)(dest + 32),
+				 _mm_or_si128(_mm_srli_si128(s2, 8),
+					      _mm_slli_si128(s3, 4)));
+	}
+
+	return n - n % 16;
+}
+
+/**
+ * Unpack 48 bytes into 16 samples per iteration using "pshufb": each
+ * group of 12 bytes is expanded into the upper three bytes of four
+ * 32 bit lanes, and an arithmetic shift extends the sign.
+ *
+ * @return the number of samples processed (a multiple of 16)
+ */
+__attribute__((target("ssse3")))
+static size_t
+UnpackS24Ssse3(int32_t *dest, const uint8_t *src, size_t n) noexcept
+{
+	const __m128i expand = _mm_set_epi8(11, 10, 9, -1,
+					    8, 7, 6, -1,
+					    5, 4, 3, -1,
+					    2, 1, 0, -1);
+
+	for (size_t i = 0; i < n / 16; ++i, src += 48, dest += 16) {
+		const __m128i x0 = _mm_loadu_si128((const __m128i *)src);
+		const __m128i x1 = _mm_loadu_si128((const __m128i *)(src + 16));
+		const __m128i x2 = _mm_loadu_si128((const __m128i *)(src + 32));
+
+		const __m128i g0 = x0;
+		const __m128i g1 = _mm_alignr_epi8(x1, x0, 12);
+		const __m128i g2 = _mm_alignr_epi8(x2, x1, 8);
+		const __m128i g3 = _mm_srli_si128(x2, 4);
+
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_srai_epi32(_mm_shuffle_epi8(g0, expand), 8));
+		_mm_storeu_si128((__m128i *)(dest + 4),
+				 _mm_srai_epi32(_mm_shuffle_epi8(g1, expand), 8));
+		_mm_storeu_si128((__m128i *)(dest + 8),
+				 _mm_srai_epi32(_mm_shuffle_epi8(g2, expand), 8));
+		_mm_storeu_si128((__m128i *)(dest + 12),
+				 _mm_srai_epi32(_mm_shuffle_epi8(g3, expand), 8));
+	}
+
+	return n - n % 16;
+}
+
+#endif /* __x86_64__ */
+
 static void
 pack_sample(uint8_t *dest, const int32_t *src0) noexcept
 {
@@ -36,6 +132,14 @@ pack_sample(uint8_t *dest, const int32_t *src0) noexcept
 void
 pcm_pack_24(uint8_t *dest, const int32_t *src, const int32_t *src_end) noexcept
 {
+#if defined(__GNUC__) && defined(__x86_64__)
+	if (HaveSsse3()) {
+		const size_t done = PackS24Ssse3(dest, src, src_end - src);
+		dest += done * 3;
+		src += done;
+	}
+#endif
+
 	/* duplicate loop to help the compiler's optimizer (constant
 	   parameter to the pack_sample() inline function) */
 
@@ -90,6 +194,15 @@ void
 pcm_unpack_24(int32_t *dest,
 	      const uint8_t *src, const uint8_t *src_end) noexcept
 {
+#if defined(__GNUC__) && defined(__x86_64__)
+	if (HaveSsse3()) {
+		const size_t done = UnpackS24Ssse3(dest, src,
+						   (src_end - src) / 3);
+		dest += done;
+		src += done * 3;
+	}
+#endif
+
 	while (src < src_end) {
 		*dest++ = ReadS24(src);
 		src += 3;
@@ -70,6 +70,19 @@ public:
 	 * filter_close() or filter_filter())
 	 */
 	virtual ConstBuffer<void> Resample(ConstBuffer<void> src) = 0;
+
+	/**
+	 * Flush pending data and return it.  This should be called
+	 * after the last Resample() call, e.g. while draining the
+	 * output device.
+	 *
+	 * Throws std::runtime_error on error.
+	 *
+	 * @return the remaining data (nullptr if there is none)
+	 */
+	virtual ConstBuffer<void> Flush() {
+		return nullptr;
+	}
 };
 
 #endif
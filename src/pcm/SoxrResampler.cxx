@@ -41,6 +41,14 @@ static constexpr unsigned long SOXR_INVALID_RECIPE = -1;
 
 static soxr_quality_spec_t soxr_quality;
 static soxr_runtime_spec_t soxr_runtime;
+static bool soxr_multithreaded;
+
+/**
+ * When multi-threaded resampling is enabled, input is staged until at
+ * least this many frames are available; the tiny chunks MPD usually
+ * feeds would leave libsoxr's worker threads mostly idle.
+ */
+static constexpr size_t SOXR_BATCH_FRAMES = 4096;
 
 static constexpr struct {
 	unsigned long recipe;
@@ -100,6 +108,9 @@ pcm_resample_soxr_global_init(const ConfigBlock &block)
 
 	const unsigned n_threads = block.GetBlockValue("threads", 1);
 	soxr_runtime = soxr_runtime_spec(n_threads);
+
+	/* zero means "automatic", i.e. one thread per CPU */
+	soxr_multithreaded = n_threads != 1;
 }
 
 AudioFormat
@@ -119,6 +130,7 @@ SoxrPcmResampler::Open(AudioFormat &af, unsigned new_sample_rate)
 	FormatDebug(soxr_domain, "soxr engine '%s'", soxr_engine(soxr));
 
 	channels = af.channels;
+	staged_frames = 0;
 
 	ratio = float(new_sample_rate) / float(af.sample_rate);
 	FormatDebug(soxr_domain,
@@ -139,6 +151,13 @@ SoxrPcmResampler::Close()
 	soxr_delete(soxr);
 }
 
+void
+SoxrPcmResampler::Reset()
+{
+	staged_frames = 0;
+	soxr_clear(soxr);
+}
+
 ConstBuffer<void>
 SoxrPcmResampler::Resample(ConstBuffer<void> src)
 {
@@ -147,16 +166,99 @@ SoxrPcmResampler::Resample(ConstBuffer<void> src)
 
 	const size_t n_frames = src.size / frame_size;
 
+	if (soxr_multithreaded &&
+	    staged_frames + n_frames < SOXR_BATCH_FRAMES) {
+		/* stage the input and wait for more; larger batches
+		   keep libsoxr's worker threads busy */
+		float *staging = (float *)
+			staging_buffer.Get(SOXR_BATCH_FRAMES * frame_size);
+		memcpy(staging + staged_frames * channels,
+		       src.data, src.size);
+		staged_frames += n_frames;
+		return { staging, 0 };
+	}
+
+	const size_t total_frames = staged_frames + n_frames;
+
 	/* always round up: worst case output buffer size */
-	const size_t o_frames = size_t(n_frames * ratio) + 1;
+	const size_t o_frames = size_t(total_frames * ratio) + 2;
 
 	float *output_buffer = (float *)buffer.Get(o_frames * frame_size);
+	size_t o_total = 0;
+
+	if (staged_frames > 0) {
+		const float *staging = (const float *)
+			staging_buffer.Get(SOXR_BATCH_FRAMES * frame_size);
+
+		size_t i_done, o_done;
+		soxr_error_t e = soxr_process(soxr, staging, staged_frames,
+					      &i_done,
+					      output_buffer, o_frames,
+					      &o_done);
+		if (e != nullptr)
+			throw FormatRuntimeError("soxr error: %s", e);
+
+		staged_frames = 0;
+		o_total += o_done;
+	}
 
 	size_t i_done, o_done;
 	soxr_error_t e = soxr_process(soxr, src.data, n_frames, &i_done,
-				      output_buffer, o_frames, &o_done);
+				      output_buffer + o_total * channels,
+				      o_frames - o_total, &o_done);
 	if (e != nullptr)
 		throw FormatRuntimeError("soxr error: %s", e);
 
-	return { output_buffer, o_done * frame_size };
+	o_total += o_done;
+
+	return { output_buffer, o_total * frame_size };
+}
+
+ConstBuffer<void>
+SoxrPcmResampler::Flush()
+{
+	const size_t frame_size = channels * sizeof(float);
+
+	/* worst case: the staged input plus what is still buffered
+	   inside libsoxr */
+	const size_t o_frames = size_t(staged_frames * ratio) +
+		size_t(soxr_delay(soxr)) + 2;
+
+	float *output_buffer = (float *)buffer.Get(o_frames * frame_size);
+	size_t o_total = 0;
+
+	if (staged_frames > 0) {
+		const float *staging = (const float *)
+			staging_buffer.Get(SOXR_BATCH_FRAMES * frame_size);
+
+		size_t i_done, o_done;
+		soxr_error_t e = soxr_process(soxr, staging, staged_frames,
+					      &i_done,
+					      output_buffer, o_frames,
+					      &o_done);
+		if (e != nullptr)
+			throw FormatRuntimeError("soxr error: %s", e);
+
+		staged_frames = 0;
+		o_total += o_done;
+	}
+
+	/* indicate end-of-input to drain libsoxr's internal buffer */
+	size_t o_done;
+	soxr_error_t e = soxr_process(soxr, nullptr, 0, nullptr,
+				      output_buffer + o_total * channels,
+				      o_frames - o_total, &o_done);
+	if (e != nullptr)
+		throw FormatRuntimeError("soxr error: %s", e);
+
+	o_total += o_done;
+
+	/* reset the engine so this instance can be reused for fresh
+	   input */
+	soxr_clear(soxr);
+
+	if (o_total == 0)
+		return nullptr;
+
+	return { output_buffer, o_total * frame_size };
 }
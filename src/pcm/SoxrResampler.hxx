@@ -38,10 +38,25 @@ class SoxrPcmResampler final : public PcmResampler {
 
 	PcmBuffer buffer;
 
+	/**
+	 * Staging area for input when multi-threaded resampling is
+	 * enabled; feeding libsoxr in larger batches gives its worker
+	 * threads enough work to be useful.
+	 */
+	PcmBuffer staging_buffer;
+
+	/**
+	 * The number of input frames currently waiting in
+	 * #staging_buffer.
+	 */
+	size_t staged_frames;
+
 public:
 	AudioFormat Open(AudioFormat &af, unsigned new_sample_rate) override;
 	void Close() override;
+	void Reset() override;
 	ConstBuffer<void> Resample(ConstBuffer<void> src) override;
+	ConstBuffer<void> Flush() override;
 };
 
 void
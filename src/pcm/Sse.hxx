@@ -0,0 +1,509 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_PCM_SSE_HXX
+#define MPD_PCM_SSE_HXX
+
+#include "Volume.hxx"
+#include "Traits.hxx"
+#include "Compiler.h"
+
+#include <emmintrin.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Apply software volume to 16 bit samples using SSE2, 8 samples per
+ * iteration.  Instead of the dithering used by the scalar code, this
+ * rounds to nearest, like the NEON conversion kernel does.
+ */
+struct SseVolumeS16 {
+	static constexpr size_t BLOCK_SIZE = 8;
+
+	void Apply(int16_t *dst, const int16_t *src, size_t n,
+		   int volume) const {
+		const __m128i factor = _mm_set1_epi16(volume);
+		const __m128i rounding =
+			_mm_set1_epi32(1 << (PCM_VOLUME_BITS - 1));
+
+		for (size_t i = 0; i < n / BLOCK_SIZE;
+		     ++i, src += BLOCK_SIZE, dst += BLOCK_SIZE) {
+			const __m128i value =
+				_mm_loadu_si128((const __m128i *)src);
+
+			/* full 32 bit products from the 16x16
+			   multiplication */
+			const __m128i lo = _mm_mullo_epi16(value, factor);
+			const __m128i hi = _mm_mulhi_epi16(value, factor);
+			__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+			__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+
+			/* round and shift back to 16 bits */
+			p0 = _mm_srai_epi32(_mm_add_epi32(p0, rounding),
+					    PCM_VOLUME_BITS);
+			p1 = _mm_srai_epi32(_mm_add_epi32(p1, rounding),
+					    PCM_VOLUME_BITS);
+
+			/* pack with saturation, in case the volume
+			   was above 100% */
+			_mm_storeu_si128((__m128i *)dst,
+					 _mm_packs_epi32(p0, p1));
+		}
+	}
+};
+
+/**
+ * Apply software volume to 32 bit (or padded 24 bit) samples using
+ * SSE2, 4 samples per iteration.  The samples are scaled in double
+ * precision, which represents the product exactly, and rounded to
+ * nearest.
+ */
+struct SseVolumeS32 {
+	static constexpr size_t BLOCK_SIZE = 4;
+
+	void Apply(int32_t *dst, const int32_t *src, size_t n,
+		   int volume) const {
+		const __m128d factor =
+			_mm_set1_pd((double)volume /
+				    (double)(1 << PCM_VOLUME_BITS));
+		const __m128d min = _mm_set1_pd(-2147483648.0);
+		const __m128d max = _mm_set1_pd(2147483647.0);
+
+		for (size_t i = 0; i < n / BLOCK_SIZE;
+		     ++i, src += BLOCK_SIZE, dst += BLOCK_SIZE) {
+			const __m128i value =
+				_mm_loadu_si128((const __m128i *)src);
+
+			__m128d d0 = _mm_cvtepi32_pd(value);
+			__m128d d1 = _mm_cvtepi32_pd(_mm_shuffle_epi32(value,
+								       _MM_SHUFFLE(1, 0, 3, 2)));
+
+			d0 = _mm_mul_pd(d0, factor);
+			d1 = _mm_mul_pd(d1, factor);
+
+			/* clamp, in case the volume was above 100% */
+			d0 = _mm_min_pd(_mm_max_pd(d0, min), max);
+			d1 = _mm_min_pd(_mm_max_pd(d1, min), max);
+
+			const __m128i r0 = _mm_cvtpd_epi32(d0);
+			const __m128i r1 = _mm_cvtpd_epi32(d1);
+
+			_mm_storeu_si128((__m128i *)dst,
+					 _mm_unpacklo_epi64(r0, r1));
+		}
+	}
+};
+
+/**
+ * Apply software volume to float samples using SSE, 4 samples per
+ * iteration.
+ */
+struct SseVolumeFloat {
+	static constexpr size_t BLOCK_SIZE = 4;
+
+	void Apply(float *dst, const float *src, size_t n,
+		   float volume) const {
+		const __m128 factor = _mm_set1_ps(volume);
+
+		for (size_t i = 0; i < n / BLOCK_SIZE;
+		     ++i, src += BLOCK_SIZE, dst += BLOCK_SIZE)
+			_mm_storeu_ps(dst, _mm_mul_ps(_mm_loadu_ps(src),
+						      factor));
+	}
+};
+
+/**
+ * Convert floating point samples to 16 bit signed integer using
+ * SSE2, 8 samples per iteration.  Out-of-range samples are clamped;
+ * rounding is to nearest, like in #NeonFloatTo16.
+ */
+struct SseFloatTo16 {
+	static constexpr SampleFormat src_format = SampleFormat::FLOAT;
+	static constexpr SampleFormat dst_format = SampleFormat::S16;
+	typedef SampleTraits<src_format> SrcTraits;
+	typedef SampleTraits<dst_format> DstTraits;
+
+	static constexpr size_t BLOCK_SIZE = 8;
+
+	void Convert(int16_t *dst, const float *src, size_t n) const {
+		const __m128 factor =
+			_mm_set1_ps(1 << (DstTraits::BITS - 1));
+		const __m128 min = _mm_set1_ps(-32768.0f);
+		const __m128 max = _mm_set1_ps(32767.0f);
+
+		for (size_t i = 0; i < n / BLOCK_SIZE;
+		     ++i, src += BLOCK_SIZE, dst += BLOCK_SIZE) {
+			__m128 a = _mm_mul_ps(_mm_loadu_ps(src), factor);
+			__m128 b = _mm_mul_ps(_mm_loadu_ps(src + 4), factor);
+
+			a = _mm_min_ps(_mm_max_ps(a, min), max);
+			b = _mm_min_ps(_mm_max_ps(b, min), max);
+
+			_mm_storeu_si128((__m128i *)dst,
+					 _mm_packs_epi32(_mm_cvtps_epi32(a),
+							 _mm_cvtps_epi32(b)));
+		}
+	}
+};
+
+/**
+ * Convert floating point samples to (padded) 24 bit signed integer
+ * using SSE2, 4 samples per iteration.
+ */
+struct SseFloatTo24 {
+	static constexpr SampleFormat src_format = SampleFormat::FLOAT;
+	static constexpr SampleFormat dst_format = SampleFormat::S24_P32;
+	typedef SampleTraits<src_format> SrcTraits;
+	typedef SampleTraits<dst_format> DstTraits;
+
+	static constexpr size_t BLOCK_SIZE = 4;
+
+	void Convert(int32_t *dst, const float *src, size_t n) const {
+		const __m128 factor =
+			_mm_set1_ps(1 << (DstTraits::BITS - 1));
+		const __m128 min = _mm_set1_ps(-8388608.0f);
+		const __m128 max = _mm_set1_ps(8388607.0f);
+
+		for (size_t i = 0; i < n / BLOCK_SIZE;
+		     ++i, src += BLOCK_SIZE, dst += BLOCK_SIZE) {
+			__m128 a = _mm_mul_ps(_mm_loadu_ps(src), factor);
+			a = _mm_min_ps(_mm_max_ps(a, min), max);
+			_mm_storeu_si128((__m128i *)dst,
+					 _mm_cvtps_epi32(a));
+		}
+	}
+};
+
+/**
+ * Convert floating point samples to 32 bit signed integer using
+ * SSE2, 4 samples per iteration.  The scaling is done in double
+ * precision, because the 32 bit integer range exceeds the precision
+ * of a float.
+ */
+struct SseFloatTo32 {
+	static constexpr SampleFormat src_format = SampleFormat::FLOAT;
+	static constexpr SampleFormat dst_format = SampleFormat::S32;
+	typedef SampleTraits<src_format> SrcTraits;
+	typedef SampleTraits<dst_format> DstTraits;
+
+	static constexpr size_t BLOCK_SIZE = 4;
+
+	void Convert(int32_t *dst, const float *src, size_t n) const {
+		const __m128d factor = _mm_set1_pd(2147483648.0);
+		const __m128d min = _mm_set1_pd(-2147483648.0);
+		const __m128d max = _mm_set1_pd(2147483647.0);
+
+		for (size_t i = 0; i < n / BLOCK_SIZE;
+		     ++i, src += BLOCK_SIZE, dst += BLOCK_SIZE) {
+			const __m128 value = _mm_loadu_ps(src);
+
+			__m128d d0 = _mm_cvtps_pd(value);
+			__m128d d1 = _mm_cvtps_pd(_mm_movehl_ps(value,
+								value));
+
+			d0 = _mm_mul_pd(d0, factor);
+			d1 = _mm_mul_pd(d1, factor);
+
+			d0 = _mm_min_pd(_mm_max_pd(d0, min), max);
+			d1 = _mm_min_pd(_mm_max_pd(d1, min), max);
+
+			_mm_storeu_si128((__m128i *)dst,
+					 _mm_unpacklo_epi64(_mm_cvtpd_epi32(d0),
+							    _mm_cvtpd_epi32(d1)));
+		}
+	}
+};
+
+/**
+ * Convert 16 bit signed integer samples to floating point using
+ * SSE2, 8 samples per iteration.
+ */
+struct SseS16ToFloat {
+	static constexpr SampleFormat src_format = SampleFormat::S16;
+	static constexpr SampleFormat dst_format = SampleFormat::FLOAT;
+	typedef SampleTraits<src_format> SrcTraits;
+	typedef SampleTraits<dst_format> DstTraits;
+
+	static constexpr size_t BLOCK_SIZE = 8;
+
+	void Convert(float *dst, const int16_t *src, size_t n) const {
+		const __m128 factor =
+			_mm_set1_ps(0.5f / (1 << (SrcTraits::BITS - 2)));
+
+		for (size_t i = 0; i < n / BLOCK_SIZE;
+		     ++i, src += BLOCK_SIZE, dst += BLOCK_SIZE) {
+			const __m128i value =
+				_mm_loadu_si128((const __m128i *)src);
+
+			/* sign-extend to 32 bits */
+			const __m128i lo =
+				_mm_srai_epi32(_mm_unpacklo_epi16(value,
+								  value), 16);
+			const __m128i hi =
+				_mm_srai_epi32(_mm_unpackhi_epi16(value,
+								  value), 16);
+
+			_mm_storeu_ps(dst,
+				      _mm_mul_ps(_mm_cvtepi32_ps(lo),
+						 factor));
+			_mm_storeu_ps(dst + 4,
+				      _mm_mul_ps(_mm_cvtepi32_ps(hi),
+						 factor));
+		}
+	}
+};
+
+/**
+ * Convert 32 bit (or padded 24 bit) signed integer samples to
+ * floating point using SSE2, 4 samples per iteration.
+ */
+template<SampleFormat F, class Traits=SampleTraits<F>>
+struct SseIntegerToFloat {
+	static constexpr SampleFormat src_format = F;
+	static constexpr SampleFormat dst_format = SampleFormat::FLOAT;
+	typedef Traits SrcTraits;
+	typedef SampleTraits<dst_format> DstTraits;
+
+	static constexpr size_t BLOCK_SIZE = 4;
+
+	void Convert(float *dst, const int32_t *src, size_t n) const {
+		const __m128 factor =
+			_mm_set1_ps(0.5f / (1 << (SrcTraits::BITS - 2)));
+
+		for (size_t i = 0; i < n / BLOCK_SIZE;
+		     ++i, src += BLOCK_SIZE, dst += BLOCK_SIZE) {
+			const __m128i value =
+				_mm_loadu_si128((const __m128i *)src);
+			_mm_storeu_ps(dst,
+				      _mm_mul_ps(_mm_cvtepi32_ps(value),
+						 factor));
+		}
+	}
+};
+
+/**
+ * Mix two 16 bit sample buffers with individual volumes using SSE2,
+ * 8 samples per iteration.  The products are computed pairwise with
+ * one "madd" instruction; rounding is to nearest with saturation.
+ */
+struct SseMixS16 {
+	static constexpr size_t BLOCK_SIZE = 8;
+
+	void Apply(int16_t *a, const int16_t *b, size_t n,
+		   int volume1, int volume2) const {
+		const __m128i factor =
+			_mm_set1_epi32(((uint32_t)(uint16_t)volume2 << 16) |
+				       (uint16_t)volume1);
+		const __m128i rounding =
+			_mm_set1_epi32(1 << (PCM_VOLUME_BITS - 1));
+
+		for (size_t i = 0; i < n / BLOCK_SIZE;
+		     ++i, a += BLOCK_SIZE, b += BLOCK_SIZE) {
+			const __m128i va =
+				_mm_loadu_si128((const __m128i *)a);
+			const __m128i vb =
+				_mm_loadu_si128((const __m128i *)b);
+
+			/* interleave to (a0,b0),(a1,b1),... and let
+			   madd compute a*volume1+b*volume2 */
+			__m128i p0 = _mm_madd_epi16(_mm_unpacklo_epi16(va, vb),
+						    factor);
+			__m128i p1 = _mm_madd_epi16(_mm_unpackhi_epi16(va, vb),
+						    factor);
+
+			p0 = _mm_srai_epi32(_mm_add_epi32(p0, rounding),
+					    PCM_VOLUME_BITS);
+			p1 = _mm_srai_epi32(_mm_add_epi32(p1, rounding),
+					    PCM_VOLUME_BITS);
+
+			_mm_storeu_si128((__m128i *)a,
+					 _mm_packs_epi32(p0, p1));
+		}
+	}
+};
+
+/**
+ * Mix two 32 bit (or padded 24 bit) sample buffers with individual
+ * volumes using SSE2, 4 samples per iteration.  The samples are
+ * mixed in double precision, which represents the products exactly,
+ * with clamping and rounding to nearest.
+ */
+struct SseMixS32 {
+	static constexpr size_t BLOCK_SIZE = 4;
+
+	void Apply(int32_t *a, const int32_t *b, size_t n,
+		   int volume1, int volume2) const {
+		const __m128d f1 =
+			_mm_set1_pd((double)volume1 /
+				    (double)(1 << PCM_VOLUME_BITS));
+		const __m128d f2 =
+			_mm_set1_pd((double)volume2 /
+				    (double)(1 << PCM_VOLUME_BITS));
+		const __m128d min = _mm_set1_pd(-2147483648.0);
+		const __m128d max = _mm_set1_pd(2147483647.0);
+
+		for (size_t i = 0; i < n / BLOCK_SIZE;
+		     ++i, a += BLOCK_SIZE, b += BLOCK_SIZE) {
+			const __m128i va =
+				_mm_loadu_si128((const __m128i *)a);
+			const __m128i vb =
+				_mm_loadu_si128((const __m128i *)b);
+
+			const __m128d a0 = _mm_cvtepi32_pd(va);
+			const __m128d a1 = _mm_cvtepi32_pd(_mm_shuffle_epi32(va,
+									     _MM_SHUFFLE(1, 0, 3, 2)));
+			const __m128d b0 = _mm_cvtepi32_pd(vb);
+			const __m128d b1 = _mm_cvtepi32_pd(_mm_shuffle_epi32(vb,
+									     _MM_SHUFFLE(1, 0, 3, 2)));
+
+			__m128d r0 = _mm_add_pd(_mm_mul_pd(a0, f1),
+						_mm_mul_pd(b0, f2));
+			__m128d r1 = _mm_add_pd(_mm_mul_pd(a1, f1),
+						_mm_mul_pd(b1, f2));
+
+			r0 = _mm_min_pd(_mm_max_pd(r0, min), max);
+			r1 = _mm_min_pd(_mm_max_pd(r1, min), max);
+
+			_mm_storeu_si128((__m128i *)a,
+					 _mm_unpacklo_epi64(_mm_cvtpd_epi32(r0),
+							    _mm_cvtpd_epi32(r1)));
+		}
+	}
+};
+
+/**
+ * Mix two float sample buffers with individual volumes using SSE, 4
+ * samples per iteration.  No clamping is needed for float samples.
+ */
+struct SseMixFloat {
+	static constexpr size_t BLOCK_SIZE = 4;
+
+	void Apply(float *a, const float *b, size_t n,
+		   float volume1, float volume2) const {
+		const __m128 f1 = _mm_set1_ps(volume1);
+		const __m128 f2 = _mm_set1_ps(volume2);
+
+		for (size_t i = 0; i < n / BLOCK_SIZE;
+		     ++i, a += BLOCK_SIZE, b += BLOCK_SIZE)
+			_mm_storeu_ps(a,
+				      _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a),
+							    f1),
+						 _mm_mul_ps(_mm_loadu_ps(b),
+							    f2)));
+	}
+};
+
+/**
+ * Add two 16 bit sample buffers with saturation using SSE2, 8
+ * samples per iteration.  The saturating add matches the scalar
+ * PcmClamp semantics exactly.
+ */
+struct SseAddS16 {
+	static constexpr size_t BLOCK_SIZE = 8;
+
+	void Apply(int16_t *a, const int16_t *b, size_t n) const {
+		for (size_t i = 0; i < n / BLOCK_SIZE;
+		     ++i, a += BLOCK_SIZE, b += BLOCK_SIZE)
+			_mm_storeu_si128((__m128i *)a,
+					 _mm_adds_epi16(_mm_loadu_si128((const __m128i *)a),
+							_mm_loadu_si128((const __m128i *)b)));
+	}
+};
+
+/**
+ * Add two float sample buffers using SSE, 4 samples per iteration.
+ */
+struct SseAddFloat {
+	static constexpr size_t BLOCK_SIZE = 4;
+
+	void Apply(float *a, const float *b, size_t n) const {
+		for (size_t i = 0; i < n / BLOCK_SIZE;
+		     ++i, a += BLOCK_SIZE, b += BLOCK_SIZE)
+			_mm_storeu_ps(a, _mm_add_ps(_mm_loadu_ps(a),
+						    _mm_loadu_ps(b)));
+	}
+};
+
+#if defined(__GNUC__) && defined(__x86_64__)
+/* the AVX variants are compiled with a "target" attribute and
+   selected at runtime, because AVX cannot be assumed at compile
+   time */
+
+#include <immintrin.h>
+
+/**
+ * Like #SseVolumeS16, but with AVX2, 16 samples per iteration.
+ */
+struct Avx2VolumeS16 {
+	static constexpr size_t BLOCK_SIZE = 16;
+
+	__attribute__((target("avx2")))
+	void Apply(int16_t *dst, const int16_t *src, size_t n,
+		   int volume) const {
+		const __m256i factor = _mm256_set1_epi16(volume);
+		const __m256i rounding =
+			_mm256_set1_epi32(1 << (PCM_VOLUME_BITS - 1));
+
+		for (size_t i = 0; i < n / BLOCK_SIZE;
+		     ++i, src += BLOCK_SIZE, dst += BLOCK_SIZE) {
+			const __m256i value =
+				_mm256_loadu_si256((const __m256i *)src);
+
+			const __m256i lo = _mm256_mullo_epi16(value, factor);
+			const __m256i hi = _mm256_mulhi_epi16(value, factor);
+			__m256i p0 = _mm256_unpacklo_epi16(lo, hi);
+			__m256i p1 = _mm256_unpackhi_epi16(lo, hi);
+
+			p0 = _mm256_srai_epi32(_mm256_add_epi32(p0, rounding),
+					       PCM_VOLUME_BITS);
+			p1 = _mm256_srai_epi32(_mm256_add_epi32(p1, rounding),
+					       PCM_VOLUME_BITS);
+
+			/* note: packs works per 128 bit lane, which
+			   matches the per-lane unpacklo/unpackhi
+			   above, so the order comes out right */
+			_mm256_storeu_si256((__m256i *)dst,
+					    _mm256_packs_epi32(p0, p1));
+		}
+	}
+};
+
+/**
+ * Like #SseVolumeFloat, but with AVX, 8 samples per iteration.
+ */
+struct AvxVolumeFloat {
+	static constexpr size_t BLOCK_SIZE = 8;
+
+	__attribute__((target("avx")))
+	void Apply(float *dst, const float *src, size_t n,
+		   float volume) const {
+		const __m256 factor = _mm256_set1_ps(volume);
+
+		for (size_t i = 0; i < n / BLOCK_SIZE;
+		     ++i, src += BLOCK_SIZE, dst += BLOCK_SIZE)
+			_mm256_storeu_ps(dst,
+					 _mm256_mul_ps(_mm256_loadu_ps(src),
+						       factor));
+	}
+};
+
+#endif /* AVX */
+
+#endif
@@ -27,10 +27,48 @@
 
 #include "PcmDither.cxx" // including the .cxx file to get inlined templates
 
+#ifdef __SSE2__
+#include "Sse.hxx"
+#endif
+
 #include <assert.h>
 #include <stdint.h>
 #include <string.h>
 
+#ifdef __SSE2__
+
+/**
+ * Is AVX2 available at runtime?
+ */
+gcc_const
+static bool
+HaveAvx2() noexcept
+{
+#if defined(__GNUC__) && defined(__x86_64__)
+	static const bool value = __builtin_cpu_supports("avx2");
+	return value;
+#else
+	return false;
+#endif
+}
+
+/**
+ * Is AVX available at runtime?
+ */
+gcc_const
+static bool
+HaveAvx() noexcept
+{
+#if defined(__GNUC__) && defined(__x86_64__)
+	static const bool value = __builtin_cpu_supports("avx");
+	return value;
+#else
+	return false;
+#endif
+}
+
+#endif /* __SSE2__ */
+
 template<SampleFormat F, class Traits=SampleTraits<F>>
 static inline typename Traits::value_type
 pcm_volume_sample(PcmDither &dither,
@@ -69,6 +107,26 @@ pcm_volume_change_16(PcmDither &dither,
 		     int16_t *dest, const int16_t *src, size_t n,
 		     int volume)
 {
+#ifdef __SSE2__
+	size_t done;
+
+#if defined(__GNUC__) && defined(__x86_64__)
+	if (HaveAvx2()) {
+		Avx2VolumeS16().Apply(dest, src, n, volume);
+		done = n - n % Avx2VolumeS16::BLOCK_SIZE;
+	} else
+#endif
+	{
+		SseVolumeS16().Apply(dest, src, n, volume);
+		done = n - n % SseVolumeS16::BLOCK_SIZE;
+	}
+
+	/* use the scalar code for the trailing samples */
+	dest += done;
+	src += done;
+	n -= done;
+#endif
+
 	pcm_volume_change<SampleFormat::S16>(dither, dest, src, n, volume);
 }
 
@@ -77,6 +135,15 @@ pcm_volume_change_24(PcmDither &dither,
 		     int32_t *dest, const int32_t *src, size_t n,
 		     int volume)
 {
+#ifdef __SSE2__
+	SseVolumeS32().Apply(dest, src, n, volume);
+
+	const size_t done = n - n % SseVolumeS32::BLOCK_SIZE;
+	dest += done;
+	src += done;
+	n -= done;
+#endif
+
 	pcm_volume_change<SampleFormat::S24_P32>(dither, dest, src, n,
 						 volume);
 }
@@ -86,6 +153,15 @@ pcm_volume_change_32(PcmDither &dither,
 		     int32_t *dest, const int32_t *src, size_t n,
 		     int volume)
 {
+#ifdef __SSE2__
+	SseVolumeS32().Apply(dest, src, n, volume);
+
+	const size_t done = n - n % SseVolumeS32::BLOCK_SIZE;
+	dest += done;
+	src += done;
+	n -= done;
+#endif
+
 	pcm_volume_change<SampleFormat::S32>(dither, dest, src, n, volume);
 }
 
@@ -93,6 +169,25 @@ static void
 pcm_volume_change_float(float *dest, const float *src, size_t n,
 			float volume)
 {
+#ifdef __SSE2__
+	size_t done;
+
+#if defined(__GNUC__) && defined(__x86_64__)
+	if (HaveAvx()) {
+		AvxVolumeFloat().Apply(dest, src, n, volume);
+		done = n - n % AvxVolumeFloat::BLOCK_SIZE;
+	} else
+#endif
+	{
+		SseVolumeFloat().Apply(dest, src, n, volume);
+		done = n - n % SseVolumeFloat::BLOCK_SIZE;
+	}
+
+	dest += done;
+	src += done;
+	n -= done;
+#endif
+
 	for (size_t i = 0; i != n; ++i)
 		dest[i] = src[i] * volume;
 }
@@ -122,18 +217,13 @@ PcmVolume::Open(SampleFormat _format)
 	format = _format;
 }
 
-ConstBuffer<void>
-PcmVolume::Apply(ConstBuffer<void> src) noexcept
+void
+PcmVolume::ApplyTo(void *data, ConstBuffer<void> src) noexcept
 {
-	if (volume == PCM_VOLUME_1)
-		return src;
-
-	void *data = buffer.Get(src.size);
-
 	if (volume == 0) {
 		/* optimized special case: 0% volume = memset(0) */
 		PcmSilence({data, src.size}, format);
-		return { data, src.size };
+		return;
 	}
 
 	switch (format) {
@@ -178,8 +268,30 @@ PcmVolume::Apply(ConstBuffer<void> src) noexcept
 
 	case SampleFormat::DSD:
 		// TODO: implement this; currently, it's a no-op
-		return src;
+		break;
 	}
+}
+
+ConstBuffer<void>
+PcmVolume::Apply(ConstBuffer<void> src) noexcept
+{
+	if (volume == PCM_VOLUME_1)
+		return src;
+
+	if (format == SampleFormat::DSD)
+		// TODO: implement this; currently, it's a no-op
+		return src;
 
+	void *data = buffer.Get(src.size);
+	ApplyTo(data, src);
 	return { data, src.size };
 }
+
+WritableBuffer<void>
+PcmVolume::ApplyInPlace(WritableBuffer<void> src) noexcept
+{
+	if (volume != PCM_VOLUME_1)
+		ApplyTo(src.data, {src.data, src.size});
+
+	return src;
+}
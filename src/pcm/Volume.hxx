@@ -29,6 +29,7 @@
 #endif
 
 template<typename T> struct ConstBuffer;
+template<typename T> struct WritableBuffer;
 
 /**
  * Number of fractional bits for a fixed-point volume value.
@@ -113,6 +114,19 @@ public:
 	 */
 	gcc_pure
 	ConstBuffer<void> Apply(ConstBuffer<void> src) noexcept;
+
+	/**
+	 * Apply the volume level, overwriting the given buffer
+	 * instead of copying into an internal one.
+	 */
+	WritableBuffer<void> ApplyInPlace(WritableBuffer<void> src) noexcept;
+
+private:
+	/**
+	 * Apply the volume level to #src, writing the result to
+	 * #dest; both may be the same buffer.
+	 */
+	void ApplyTo(void *dest, ConstBuffer<void> src) noexcept;
 };
 
 #endif
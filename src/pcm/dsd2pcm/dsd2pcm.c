@@ -33,6 +33,10 @@ or implied, of Sebastian Gesemann.
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 #include "dsd2pcm.h"
 
 #define HTAPS    48             /* number of FIR constants */
@@ -116,6 +120,12 @@ static const double htaps[HTAPS] = {
 };
 
 static float ctables[CTABLES][256];
+
+/* the same tables indexed by the bit-reversed octet; this allows
+ * evaluating the symmetric upper filter half without reversing FIFO
+ * bytes in the hot loop */
+static float ctables_rev[CTABLES][256];
+
 static int precalculated = 0;
 
 static void precalc(void)
@@ -134,6 +144,9 @@ static void precalc(void)
 			ctables[CTABLES-1-t][e] = (float)acc;
 		}
 	}
+	for (t=0; t<CTABLES; ++t)
+		for (e=0; e<256; ++e)
+			ctables_rev[t][e] = ctables[t][bit_reverse(e)];
 	precalculated = 1;
 }
 
@@ -180,6 +193,48 @@ extern void dsd2pcm_reset(dsd2pcm_ctx* ptr)
 	 */
 }
 
+#if defined(__GNUC__) && defined(__x86_64__)
+
+/* number of output samples per AVX2 pass */
+#define AVX2_BLOCK 8
+
+/* history bytes needed in addition to one block of fresh input */
+#define AVX2_HISTORY (CTABLES*2-1)
+
+/**
+ * Convolve a block of AVX2_BLOCK output samples at once.  For every
+ * lookup table, the indices of adjacent output samples are adjacent
+ * history bytes, so each table contributes one 8-wide gather for the
+ * lower and one for the upper filter half.
+ *
+ * @param w contiguous history, w[AVX2_HISTORY-1+s] being the newest
+ * octet for output sample s
+ */
+__attribute__((target("avx2")))
+static void translate_block_avx2(const unsigned char *w, float *out)
+{
+	unsigned i;
+	__m256 acc = _mm256_setzero_ps();
+	for (i=0; i<CTABLES; ++i) {
+		const __m256i idx1 =
+			_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(w + (CTABLES*2-1) - i)));
+		const __m256i idx2 =
+			_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(w + i)));
+		acc = _mm256_add_ps(acc, _mm256_i32gather_ps(ctables[i],
+							     idx1, 4));
+		acc = _mm256_add_ps(acc, _mm256_i32gather_ps(ctables_rev[i],
+							     idx2, 4));
+	}
+	_mm256_storeu_ps(out, acc);
+}
+
+static int have_avx2(void)
+{
+	return __builtin_cpu_supports("avx2");
+}
+
+#endif /* __x86_64__ */
+
 extern void dsd2pcm_translate(
 	dsd2pcm_ctx* ptr,
 	size_t samples,
@@ -190,21 +245,51 @@ extern void dsd2pcm_translate(
 	unsigned ffp;
 	unsigned i;
 	unsigned bite1, bite2;
-	unsigned char* p;
 	double acc;
 	ffp = ptr->fifopos;
 	lsbf = lsbf ? 1 : 0;
+
+#if defined(__GNUC__) && defined(__x86_64__)
+	if (have_avx2() && samples >= AVX2_BLOCK) {
+		/* gather the FIFO contents into a contiguous sliding
+		   window, newest byte last */
+		unsigned char window[AVX2_HISTORY + AVX2_BLOCK];
+		float out[AVX2_BLOCK];
+		unsigned s;
+		for (i=0; i<AVX2_HISTORY; ++i)
+			window[AVX2_HISTORY-1-i] =
+				ptr->fifo[(ffp-1-i) & FIFOMASK];
+
+		while (samples >= AVX2_BLOCK) {
+			for (s=0; s<AVX2_BLOCK; ++s) {
+				bite1 = *src & 0xFFu;
+				if (lsbf) bite1 = bit_reverse(bite1);
+				window[AVX2_HISTORY+s] = bite1;
+				ptr->fifo[ffp] = bite1; src += src_stride;
+				ffp = (ffp + 1) & FIFOMASK;
+			}
+
+			translate_block_avx2(window, out);
+
+			for (s=0; s<AVX2_BLOCK; ++s) {
+				*dst = out[s]; dst += dst_stride;
+			}
+
+			memmove(window, window + AVX2_BLOCK, AVX2_HISTORY);
+			samples -= AVX2_BLOCK;
+		}
+	}
+#endif
+
 	while (samples-- > 0) {
 		bite1 = *src & 0xFFu;
 		if (lsbf) bite1 = bit_reverse(bite1);
 		ptr->fifo[ffp] = bite1; src += src_stride;
-		p = ptr->fifo + ((ffp-CTABLES) & FIFOMASK);
-		*p = bit_reverse(*p);
 		acc = 0;
 		for (i=0; i<CTABLES; ++i) {
 			bite1 = ptr->fifo[(ffp              -i) & FIFOMASK] & 0xFF;
 			bite2 = ptr->fifo[(ffp-(CTABLES*2-1)+i) & FIFOMASK] & 0xFF;
-			acc += ctables[i][bite1] + ctables[i][bite2];
+			acc += ctables[i][bite1] + ctables_rev[i][bite2];
 		}
 		*dst = (float)acc; dst += dst_stride;
 		ffp = (ffp + 1) & FIFOMASK;
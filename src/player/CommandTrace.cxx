@@ -0,0 +1,125 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "CommandTrace.hxx"
+#include "Control.hxx"
+#include "decoder/DecoderCommand.hxx"
+#include "thread/Mutex.hxx"
+#include "system/Error.hxx"
+
+#include <chrono>
+
+#include <errno.h>
+#include <stdio.h>
+
+static Mutex trace_mutex;
+static FILE *trace_file;
+static std::chrono::steady_clock::time_point trace_start;
+
+static constexpr const char *player_command_names[] = {
+	"none",
+	"exit",
+	"stop",
+	"pause",
+	"seek",
+	"close_audio",
+	"update_audio",
+	"queue",
+	"cancel",
+	"refresh",
+};
+
+static constexpr const char *decoder_command_names[] = {
+	"none",
+	"start",
+	"stop",
+	"seek",
+};
+
+void
+player_trace_init(const char *path)
+{
+	FILE *file = fopen(path, "w");
+	if (file == nullptr)
+		throw FormatErrno("Failed to create %s", path);
+
+	/* line-buffered, so a crash loses at most one line */
+	setvbuf(file, nullptr, _IOLBF, 0);
+
+	const std::lock_guard<Mutex> protect(trace_mutex);
+	trace_file = file;
+	trace_start = std::chrono::steady_clock::now();
+}
+
+void
+player_trace_finish() noexcept
+{
+	const std::lock_guard<Mutex> protect(trace_mutex);
+
+	if (trace_file != nullptr) {
+		fclose(trace_file);
+		trace_file = nullptr;
+	}
+}
+
+static void
+player_trace_line(const char *seam, const char *rest) noexcept
+{
+	const std::lock_guard<Mutex> protect(trace_mutex);
+
+	if (trace_file == nullptr)
+		return;
+
+	const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>
+		(std::chrono::steady_clock::now() - trace_start).count();
+
+	fprintf(trace_file, "%llu %s %s\n",
+		(unsigned long long)elapsed, seam, rest);
+}
+
+void
+player_trace(PlayerCommand cmd) noexcept
+{
+	if (trace_file == nullptr)
+		return;
+
+	player_trace_line("player", player_command_names[unsigned(cmd)]);
+}
+
+void
+player_trace(DecoderCommand cmd) noexcept
+{
+	if (trace_file == nullptr)
+		return;
+
+	player_trace_line("decoder", decoder_command_names[unsigned(cmd)]);
+}
+
+void
+player_trace_song(const char *uri, unsigned start_ms) noexcept
+{
+	if (trace_file == nullptr)
+		return;
+
+	/* the URI goes last because it may contain spaces */
+	char rest[1024];
+	snprintf(rest, sizeof(rest), "%u %s", start_ms, uri);
+	player_trace_line("song", rest);
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_PLAYER_COMMAND_TRACE_HXX
+#define MPD_PLAYER_COMMAND_TRACE_HXX
+
+#include <stdint.h>
+
+enum class PlayerCommand : uint8_t;
+enum class DecoderCommand : uint8_t;
+
+/**
+ * Start logging the commands crossing the #PlayerControl and
+ * #DecoderControl seams (with microsecond timestamps) to the given
+ * file.  The resulting trace can be replayed deterministically with
+ * the run_player_replay tool.
+ *
+ * Throws #std::runtime_error if the file cannot be created.
+ */
+void
+player_trace_init(const char *path);
+
+void
+player_trace_finish() noexcept;
+
+/**
+ * Log a command submitted to the player thread.  No-op while
+ * tracing is disabled.
+ */
+void
+player_trace(PlayerCommand cmd) noexcept;
+
+/**
+ * Log a command submitted to the decoder thread.
+ */
+void
+player_trace(DecoderCommand cmd) noexcept;
+
+/**
+ * Log the song (and start position in milliseconds) about to be
+ * passed to the player with the next SEEK or QUEUE command.
+ */
+void
+player_trace_song(const char *uri, unsigned start_ms) noexcept;
+
+#endif
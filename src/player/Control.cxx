@@ -27,15 +27,22 @@
 
 #include <assert.h>
 
+/* all PlayerControl instances are constructed in the main thread, so
+   a plain counter suffices */
+static unsigned next_player_id;
+
 PlayerControl::PlayerControl(PlayerListener &_listener,
 			     MultipleOutputs &_outputs,
 			     unsigned _buffer_chunks,
 			     unsigned _buffered_before_play,
+			     unsigned _buffer_reserve_time,
 			     AudioFormat _configured_audio_format,
 			     const ReplayGainConfig &_replay_gain_config) noexcept
 	:listener(_listener), outputs(_outputs),
+	 id(next_player_id++),
 	 buffer_chunks(_buffer_chunks),
 	 buffered_before_play(_buffered_before_play),
+	 buffer_reserve_time(_buffer_reserve_time),
 	 configured_audio_format(_configured_audio_format),
 	 thread(BIND_THIS_METHOD(RunThread)),
 	 replay_gain_config(_replay_gain_config)
@@ -230,6 +237,8 @@ PlayerControl::EnqueueSongLocked(std::unique_ptr<DetachedSong> song) noexcept
 	assert(song != nullptr);
 	assert(next_song == nullptr);
 
+	player_trace_song(song->GetURI(), 0);
+
 	next_song = std::move(song);
 	seek_time = SongTime::zero();
 	SynchronousCommand(PlayerCommand::QUEUE);
@@ -249,6 +258,8 @@ PlayerControl::SeekLocked(std::unique_ptr<DetachedSong> song, SongTime t)
 
 	assert(next_song == nullptr);
 
+	player_trace_song(song->GetURI(), t.ToMS());
+
 	ClearError();
 	next_song = std::move(song);
 	seek_time = t;
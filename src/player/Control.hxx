@@ -22,6 +22,7 @@
 
 #include "output/Client.hxx"
 #include "AudioFormat.hxx"
+#include "CommandTrace.hxx"
 #include "thread/Mutex.hxx"
 #include "thread/Cond.hxx"
 #include "thread/Thread.hxx"
@@ -110,10 +111,26 @@ struct PlayerControl final : AudioOutputClient {
 
 	MultipleOutputs &outputs;
 
+	/**
+	 * A sequence number identifying this player (one per
+	 * partition).  It is used to spread the per-partition player
+	 * and decoder threads round-robin across the CPUs of a
+	 * configured affinity list.
+	 */
+	const unsigned id;
+
 	const unsigned buffer_chunks;
 
 	const unsigned buffered_before_play;
 
+	/**
+	 * The "buffer_reserve_time" setting: while a current song is
+	 * being decoded, keep this many seconds worth of chunks free
+	 * in the #MusicBuffer, so the next song's decoder can fill
+	 * them right away instead of waiting for the pipe to drain.
+	 */
+	const unsigned buffer_reserve_time;
+
 	/**
 	 * The "audio_output_format" setting.
 	 */
@@ -226,6 +243,7 @@ struct PlayerControl final : AudioOutputClient {
 		      MultipleOutputs &_outputs,
 		      unsigned buffer_chunks,
 		      unsigned buffered_before_play,
+		      unsigned _buffer_reserve_time,
 		      AudioFormat _configured_audio_format,
 		      const ReplayGainConfig &_replay_gain_config) noexcept;
 	~PlayerControl() noexcept;
@@ -353,6 +371,8 @@ private:
 	void SynchronousCommand(PlayerCommand cmd) noexcept {
 		assert(command == PlayerCommand::NONE);
 
+		player_trace(cmd);
+
 		command = cmd;
 		Signal();
 		WaitCommandLocked();
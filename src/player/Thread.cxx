@@ -25,18 +25,23 @@
 #include "MusicPipe.hxx"
 #include "MusicBuffer.hxx"
 #include "MusicChunk.hxx"
-#include "pcm/Silence.hxx"
 #include "DetachedSong.hxx"
 #include "CrossFade.hxx"
 #include "Control.hxx"
 #include "output/MultipleOutputs.hxx"
 #include "tag/Tag.hxx"
 #include "Idle.hxx"
+#include "PerfStats.hxx"
+#include "Profiler.hxx"
+#include "ThreadConfig.hxx"
+#include "config/ConfigOption.hxx"
 #include "system/PeriodClock.hxx"
+#include "util/AllocAudit.hxx"
 #include "util/Domain.hxx"
 #include "thread/Name.hxx"
 #include "Log.hxx"
 
+#include <algorithm>
 #include <exception>
 
 #include <string.h>
@@ -81,6 +86,13 @@ class Player {
 	 */
 	bool decoder_woken = false;
 
+	/**
+	 * Has the current underrun episode already been reported to
+	 * the outputs?  This avoids counting one long starvation
+	 * phase as many underruns.
+	 */
+	bool underrun_noted = false;
+
 	/**
 	 * is the player paused?
 	 */
@@ -359,6 +371,12 @@ Player::StartDecoder(MusicPipe &_pipe) noexcept
 
 	SongTime start_time = pc.next_song->GetStartTime() + pc.seek_time;
 
+	if (&_pipe != pipe)
+		/* the next song's decoder may use the chunks which
+		   were kept free while the current song was being
+		   decoded */
+		dc.chunk_reserve = 0;
+
 	dc.Start(std::make_unique<DetachedSong>(*pc.next_song),
 		 start_time, pc.next_song->GetEndTime(),
 		 buffer, _pipe);
@@ -513,6 +531,21 @@ Player::CheckDecoderStartup() noexcept
 		play_audio_format = dc.out_audio_format;
 		decoder_starting = false;
 
+		if (pc.buffer_reserve_time > 0) {
+			/* from now on, this song is the current one:
+			   keep "buffer_reserve_time" seconds worth of
+			   chunks free for the next song's decoder;
+			   the cap avoids a deadlock with the initial
+			   buffering, which waits for
+			   buffered_before_play chunks */
+			unsigned reserve = (unsigned)
+				(play_audio_format.GetTimeToSize()
+				 * pc.buffer_reserve_time / music_chunk_size);
+			const unsigned limit =
+				(pc.buffer_chunks - pc.buffered_before_play) / 2;
+			dc.chunk_reserve = std::min(reserve, limit);
+		}
+
 		idle_add(IDLE_PLAYER);
 
 		if (!paused && !OpenOutput()) {
@@ -539,7 +572,7 @@ Player::SendSilence() noexcept
 	assert(output_open);
 	assert(play_audio_format.IsDefined());
 
-	MusicChunk *chunk = buffer.Allocate();
+	MusicChunk *chunk = buffer.AllocateSilence(play_audio_format.format);
 	if (chunk == nullptr) {
 		/* this is non-fatal, because this means that the
 		   decoder has filled to buffer completely meanwhile;
@@ -556,13 +589,13 @@ Player::SendSilence() noexcept
 	const size_t frame_size = play_audio_format.GetFrameSize();
 	/* this formula ensures that we don't send
 	   partial frames */
-	unsigned num_frames = sizeof(chunk->data) / frame_size;
+	unsigned num_frames = chunk->capacity / frame_size;
 
 	chunk->bit_rate = 0;
 	chunk->time = SignedSongTime::Negative(); /* undefined time stamp */
 	chunk->length = num_frames * frame_size;
 	chunk->replay_gain_serial = MusicChunk::IGNORE_REPLAY_GAIN;
-	PcmSilence({chunk->data, chunk->length}, play_audio_format.format);
+	chunk->decode_time = std::chrono::steady_clock::now();
 
 	try {
 		pc.outputs.Play(chunk);
@@ -806,6 +839,14 @@ play_chunk(PlayerControl &pc,
 inline bool
 Player::PlayNextChunk() noexcept
 {
+	/* this is the steady-state hot path of the player thread; it
+	   must not allocate (see "allocation_audit") */
+	const ScopeAllocForbidden alloc_forbidden;
+
+	perf_stats.buffer_fill.Record(buffer.GetSize() -
+				      buffer.GetFreeCount(),
+				      buffer.GetSize());
+
 	if (!pc.LockWaitOutputConsumed(64))
 		/* the output pipe is still large enough, don't send
 		   another chunk */
@@ -840,8 +881,13 @@ Player::PlayNextChunk() noexcept
 			/* don't send the tags of the new song (which
 			   is being faded in) yet; postpone it until
 			   the current song is faded out */
-			cross_fade_tag = Tag::Merge(std::move(cross_fade_tag),
-						    std::move(other_chunk->tag));
+			{
+				/* merging tags allocates, which is
+				   intentional at song boundaries */
+				const ScopeAllocAllowed alloc_allowed;
+				cross_fade_tag = Tag::Merge(std::move(cross_fade_tag),
+							    std::move(other_chunk->tag));
+			}
 
 			if (pc.cross_fade.mixramp_delay <= 0) {
 				chunk->mix_ratio = ((float)cross_fade_position)
@@ -890,6 +936,7 @@ Player::PlayNextChunk() noexcept
 	/* insert the postponed tag if cross-fading is finished */
 
 	if (xfade_state != CrossFadeState::ACTIVE && cross_fade_tag != nullptr) {
+		const ScopeAllocAllowed alloc_allowed;
 		chunk->tag = Tag::Merge(std::move(chunk->tag),
 					std::move(cross_fade_tag));
 		cross_fade_tag = nullptr;
@@ -900,6 +947,9 @@ Player::PlayNextChunk() noexcept
 	try {
 		play_chunk(pc, *song, chunk, buffer, play_audio_format);
 	} catch (...) {
+		/* error handling may allocate */
+		const ScopeAllocAllowed alloc_allowed;
+
 		LogError(std::current_exception());
 
 		buffer.Return(chunk);
@@ -939,6 +989,7 @@ Player::SongBorder() noexcept
 	FormatDefault(player_domain, "played \"%s\"", song->GetURI());
 
 	throttle_silence_log.Reset();
+	underrun_noted = false;
 
 	ReplacePipe(dc.pipe);
 
@@ -983,7 +1034,18 @@ Player::Run() noexcept
 			   until the buffer is large enough, to
 			   prevent stuttering on slow machines */
 
-			if (pipe->GetSize() < pc.buffered_before_play &&
+			/* ask the outputs how deep they need the
+			   buffer to be, deepened by their underrun
+			   history; clamp against the chunk reserve so
+			   the decoder can always satisfy it */
+			unsigned prebuffer =
+				pc.outputs.GetPrebufferChunks(pc.buffer_chunks,
+							      pc.buffered_before_play);
+			if (dc.chunk_reserve < pc.buffer_chunks &&
+			    prebuffer > pc.buffer_chunks - dc.chunk_reserve - 1)
+				prebuffer = pc.buffer_chunks - dc.chunk_reserve - 1;
+
+			if (pipe->GetSize() < prebuffer &&
 			    !dc.LockIsIdle()) {
 				/* not enough decoded buffer space yet */
 
@@ -1069,6 +1131,8 @@ Player::Run() noexcept
 			/* at least one music chunk is ready - send it
 			   to the audio output */
 
+			underrun_noted = false;
+
 			PlayNextChunk();
 		} else if (pc.outputs.Check() > 0) {
 			/* not enough data from decoder, but the
@@ -1102,6 +1166,13 @@ Player::Run() noexcept
 			   new PCM data in time: send silence (if the
 			   output pipe is empty) */
 
+			if (!underrun_noted) {
+				/* tell the outputs, so they request a
+				   deeper prebuffer next time */
+				underrun_noted = true;
+				pc.outputs.NoteUnderrun();
+			}
+
 			if (throttle_silence_log.CheckUpdate(std::chrono::seconds(5)))
 				FormatWarning(player_domain, "Decoder is too slow; playing silence to avoid xrun");
 
@@ -1150,9 +1221,21 @@ PlayerControl::RunThread() noexcept
 {
 	SetThreadName("player");
 
+	const ProfilerThreadScope profiler_scope("player");
+
+	ApplyThreadAffinity(ConfigOption::PLAYER_THREAD_AFFINITY, id);
+
+	try {
+		ApplyThreadRealtime();
+	} catch (...) {
+		LogError(std::current_exception(),
+			 "PlayerThread could not get realtime scheduling, continuing anyway");
+	}
+
 	DecoderControl dc(mutex, cond,
 			  configured_audio_format,
-			  replay_gain_config);
+			  replay_gain_config,
+			  id);
 	decoder_thread_start(dc);
 
 	MusicBuffer buffer(buffer_chunks);
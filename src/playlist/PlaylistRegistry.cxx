@@ -109,7 +109,7 @@ playlist_list_open_uri_scheme(const char *uri, Mutex &mutex, Cond &cond,
 
 	assert(uri != nullptr);
 
-	const auto scheme = uri_get_scheme(uri);
+	const auto scheme = uri_get_scheme_view(uri);
 	if (scheme.empty())
 		return nullptr;
 
@@ -120,7 +120,7 @@ playlist_list_open_uri_scheme(const char *uri, Mutex &mutex, Cond &cond,
 
 		if (playlist_plugins_enabled[i] && plugin->open_uri != nullptr &&
 		    plugin->schemes != nullptr &&
-		    StringArrayContainsCase(plugin->schemes, scheme.c_str())) {
+		    StringArrayContainsCase(plugin->schemes, scheme)) {
 			playlist = playlist_plugin_open_uri(plugin, uri,
 							    mutex, cond);
 			if (playlist != nullptr)
@@ -23,6 +23,16 @@
 #include "../SongEnumerator.hxx"
 #include "../cue/CueParser.hxx"
 #include "input/TextInputStream.hxx"
+#include "input/InputStream.hxx"
+#include "DetachedSong.hxx"
+#include "fs/AllocatedPath.hxx"
+#include "fs/FileInfo.hxx"
+#include "thread/Mutex.hxx"
+
+#include <chrono>
+#include <list>
+#include <string>
+#include <vector>
 
 class CuePlaylist final : public SongEnumerator {
 	TextInputStream tis;
@@ -36,10 +46,91 @@ class CuePlaylist final : public SongEnumerator {
 	virtual std::unique_ptr<DetachedSong> NextSong() override;
 };
 
+/**
+ * A #SongEnumerator which returns songs parsed earlier, from the
+ * cache below.
+ */
+class CachedCuePlaylist final : public SongEnumerator {
+	std::vector<DetachedSong> songs;
+	size_t position = 0;
+
+ public:
+	explicit CachedCuePlaylist(std::vector<DetachedSong> &&_songs)
+		:songs(std::move(_songs)) {}
+
+	std::unique_ptr<DetachedSong> NextSong() override {
+		if (position >= songs.size())
+			return nullptr;
+
+		return std::make_unique<DetachedSong>(std::move(songs[position++]));
+	}
+};
+
+/* a small LRU cache of parsed CUE sheets: the same sheet gets opened
+   again and again (lsinfo, load, database update), and parsing a
+   large sheet is much more expensive than copying its songs */
+
+struct CueCacheEntry {
+	std::string uri;
+	std::chrono::system_clock::time_point mtime;
+	std::vector<DetachedSong> songs;
+};
+
+static constexpr unsigned CUE_CACHE_MAX = 4;
+
+static Mutex cue_cache_mutex;
+static std::list<CueCacheEntry> cue_cache;
+
 static SongEnumerator *
 cue_playlist_open_stream(InputStreamPtr &&is)
 {
-	return new CuePlaylist(std::move(is));
+	/* the cache is only used for local files, because only those
+	   have a cheap modification time to validate entries with */
+	std::string uri;
+	std::chrono::system_clock::time_point mtime;
+	bool cacheable = false;
+
+	{
+		const auto path = AllocatedPath::FromUTF8(is->GetURI());
+		FileInfo fi;
+		if (!path.IsNull() && GetFileInfo(path, fi)) {
+			uri = is->GetURI();
+			mtime = fi.GetModificationTime();
+			cacheable = true;
+		}
+	}
+
+	if (!cacheable)
+		return new CuePlaylist(std::move(is));
+
+	{
+		const std::lock_guard<Mutex> lock(cue_cache_mutex);
+		for (auto i = cue_cache.begin(); i != cue_cache.end(); ++i)
+			if (i->uri == uri && i->mtime == mtime) {
+				/* hit: bump the entry to the front of
+				   the LRU list and return a copy */
+				cue_cache.splice(cue_cache.begin(),
+						 cue_cache, i);
+				return new CachedCuePlaylist(std::vector<DetachedSong>(i->songs));
+			}
+	}
+
+	/* miss: parse the whole sheet now and remember the result */
+
+	CuePlaylist playlist(std::move(is));
+	std::vector<DetachedSong> songs;
+	std::unique_ptr<DetachedSong> song;
+	while ((song = playlist.NextSong()) != nullptr)
+		songs.emplace_back(std::move(*song));
+
+	{
+		const std::lock_guard<Mutex> lock(cue_cache_mutex);
+		cue_cache.push_front({std::move(uri), mtime, songs});
+		if (cue_cache.size() > CUE_CACHE_MAX)
+			cue_cache.pop_back();
+	}
+
+	return new CachedCuePlaylist(std::move(songs));
 }
 
 std::unique_ptr<DetachedSong>
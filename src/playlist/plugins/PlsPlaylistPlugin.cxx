@@ -125,9 +125,7 @@ ParsePls(TextInputStream &is, std::forward_list<DetachedSong> &songs)
 		return false;
 
 	auto i = songs.before_begin();
-	for (const auto &entry : entries) {
-		const char *uri = entry.file.c_str();
-
+	for (auto &entry : entries) {
 		TagBuilder tag;
 		if (!entry.title.empty())
 			tag.AddItem(TAG_TITLE, entry.title.c_str());
@@ -135,7 +133,8 @@ ParsePls(TextInputStream &is, std::forward_list<DetachedSong> &songs)
 		if (entry.length > 0)
 			tag.SetDuration(SignedSongTime::FromS(entry.length));
 
-		i = songs.emplace_after(i, uri, tag.Commit());
+		i = songs.emplace_after(i, std::move(entry.file),
+					tag.Commit());
 	}
 
 	return true;
@@ -191,7 +191,7 @@ handle_end_map(void *ctx)
 	/* got_url == 1, track finished, make it into a song */
 	data->got_url = 0;
 
-	const std::string u = data->stream_url + "?client_id=" +
+	std::string u = data->stream_url + "?client_id=" +
 		soundcloud_config.apikey;
 
 	TagBuilder tag;
@@ -199,7 +199,7 @@ handle_end_map(void *ctx)
 	if (!data->title.empty())
 		tag.AddItem(TAG_NAME, data->title.c_str());
 
-	data->songs.emplace_front(u.c_str(), tag.Commit());
+	data->songs.emplace_front(std::move(u), tag.Commit());
 
 	return 1;
 }
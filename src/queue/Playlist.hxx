@@ -53,11 +53,22 @@ struct playlist {
 	bool stop_on_error;
 
 	/**
-	 * If true, then a bulk edit has been initiated by
-	 * BeginBulk(), and UpdateQueuedSong() and OnModified() will
-	 * be postponed until CommitBulk()
+	 * If true, then AppendSong() refuses to add a song whose URI
+	 * is already present in the queue, and returns the existing
+	 * id instead (the "reject_duplicates" configuration
+	 * option).
 	 */
-	bool bulk_edit;
+	bool reject_duplicates = false;
+
+	/**
+	 * If non-zero, then this number of bulk edits has been
+	 * initiated by BeginBulk(), and UpdateQueuedSong() and
+	 * OnModified() will be postponed until the outermost
+	 * CommitBulk().  Bulk edits may be nested, e.g. when a
+	 * command list wraps commands which are bulk edits
+	 * themselves.
+	 */
+	unsigned bulk_edit;
 
 	/**
 	 * Has the queue been modified during bulk edit mode?
@@ -93,7 +104,7 @@ struct playlist {
 		:queue(max_length),
 		 listener(_listener),
 		 playing(false),
-		 bulk_edit(false),
+		 bulk_edit(0),
 		 current(-1), queued(-1) {
 	}
 
@@ -220,6 +231,13 @@ protected:
 	void DeleteInternal(PlayerControl &pc,
 			    unsigned song, const DetachedSong **queued_p);
 
+	/**
+	 * Remove the range [start, end) from the queue in one pass,
+	 * and re-locate the "current song pointer".  The current
+	 * song must not be inside the range.
+	 */
+	void DeleteRangeInternal(unsigned start, unsigned end);
+
 public:
 	void DeletePosition(PlayerControl &pc, unsigned position);
 
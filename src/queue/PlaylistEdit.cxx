@@ -63,18 +63,19 @@ playlist::Clear(PlayerControl &pc)
 void
 playlist::BeginBulk()
 {
-	assert(!bulk_edit);
-
-	bulk_edit = true;
-	bulk_modified = false;
+	if (bulk_edit++ == 0)
+		bulk_modified = false;
 }
 
 void
 playlist::CommitBulk(PlayerControl &pc)
 {
-	assert(bulk_edit);
+	assert(bulk_edit > 0);
+
+	if (--bulk_edit > 0)
+		/* postponed until the outermost CommitBulk() */
+		return;
 
-	bulk_edit = false;
 	if (!bulk_modified)
 		return;
 
@@ -94,6 +95,15 @@ playlist::AppendSong(PlayerControl &pc, DetachedSong &&song)
 {
 	unsigned id;
 
+	if (reject_duplicates) {
+		/* optional duplicate suppression: if a song with
+		   this URI is already enqueued, return its id
+		   instead of adding a second copy */
+		const int existing = queue.FindSongURI(song.GetURI());
+		if (existing >= 0)
+			return existing;
+	}
+
 	if (queue.IsFull())
 		throw PlaylistError(PlaylistResult::TOO_LARGE,
 				    "Playlist is too large");
@@ -274,6 +284,21 @@ playlist::DeletePosition(PlayerControl &pc, unsigned song)
 	OnModified();
 }
 
+void
+playlist::DeleteRangeInternal(unsigned start, unsigned end)
+{
+	/* the current song is not inside the range; remember its id,
+	   to re-locate it after the positions have shifted */
+	const int current_id = current >= 0
+		? (int)queue.PositionToId(queue.OrderToPosition(current))
+		: -1;
+
+	queue.DeleteRange(start, end);
+
+	if (current_id >= 0)
+		current = queue.PositionToOrder(queue.IdToPosition(current_id));
+}
+
 void
 playlist::DeleteRange(PlayerControl &pc, unsigned start, unsigned end)
 {
@@ -288,9 +313,27 @@ playlist::DeleteRange(PlayerControl &pc, unsigned start, unsigned end)
 
 	const DetachedSong *queued_song = GetQueuedSong();
 
-	do {
-		DeleteInternal(pc, --end, &queued_song);
-	} while (end != start);
+	/* if the current song is inside the range, remove everything
+	   after it first, then the current song itself - which may
+	   start the song following the range, or stop playback - so
+	   the bulk path never deletes the song being played */
+
+	if (current >= 0) {
+		const unsigned current_position =
+			queue.OrderToPosition(current);
+
+		if (current_position >= start && current_position < end) {
+			if (current_position + 1 < end)
+				DeleteRangeInternal(current_position + 1,
+						    end);
+
+			DeleteInternal(pc, current_position, &queued_song);
+			end = current_position;
+		}
+	}
+
+	if (start < end)
+		DeleteRangeInternal(start, end);
 
 	UpdateQueuedSong(pc, queued_song);
 	OnModified();
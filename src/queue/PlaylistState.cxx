@@ -59,7 +59,8 @@
 
 void
 playlist_state_save(BufferedOutputStream &os, const struct playlist &playlist,
-		    PlayerControl &pc)
+		    PlayerControl &pc,
+		    const std::string *queue_cache)
 {
 	const auto player_status = pc.LockGetStatus();
 
@@ -95,7 +96,10 @@ playlist_state_save(BufferedOutputStream &os, const struct playlist &playlist,
 	os.Format(PLAYLIST_STATE_FILE_MIXRAMPDELAY "%f\n",
 		  pc.GetMixRampDelay());
 	os.Write(PLAYLIST_STATE_FILE_PLAYLIST_BEGIN "\n");
-	queue_save(os, playlist.queue);
+	if (queue_cache != nullptr)
+		os.Write(queue_cache->data(), queue_cache->length());
+	else
+		queue_save(os, playlist.queue);
 	os.Write(PLAYLIST_STATE_FILE_PLAYLIST_END "\n");
 }
 
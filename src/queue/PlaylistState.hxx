@@ -25,15 +25,23 @@
 #ifndef MPD_PLAYLIST_STATE_HXX
 #define MPD_PLAYLIST_STATE_HXX
 
+#include <string>
+
 struct playlist;
 struct PlayerControl;
 class TextFile;
 class BufferedOutputStream;
 class SongLoader;
 
+/**
+ * @param queue_cache if not nullptr, this pre-serialized queue
+ * listing (see queue_save()) is written instead of serializing the
+ * queue again; see StateFile::GetQueueCache()
+ */
 void
 playlist_state_save(BufferedOutputStream &os, const playlist &playlist,
-		    PlayerControl &pc);
+		    PlayerControl &pc,
+		    const std::string *queue_cache=nullptr);
 
 bool
 playlist_state_restore(const char *line, TextFile &file,
@@ -25,6 +25,7 @@ Queue::Queue(unsigned _max_length) noexcept
 	:max_length(_max_length),
 	 items(new Item[max_length]),
 	 order(new unsigned[max_length]),
+	 position_to_order(new unsigned[max_length]),
 	 id_table(max_length * HASH_MULT)
 {
 }
@@ -35,6 +36,7 @@ Queue::~Queue() noexcept
 
 	delete[] items;
 	delete[] order;
+	delete[] position_to_order;
 }
 
 int
@@ -59,6 +61,23 @@ Queue::IncrementVersion() noexcept
 {
 	static unsigned long max = ((uint32_t) 1 << 31) - 1;
 
+	if (pending_overflow) {
+		/* this version's delta is incomplete; all older ring
+		   entries would need it, so they are useless now */
+		change_ring.clear();
+		pending_changes.clear();
+		pending_overflow = false;
+		changes_since = version + 1;
+	} else if (!pending_changes.empty()) {
+		change_ring.push_back({version, std::move(pending_changes)});
+		pending_changes.clear();
+
+		if (change_ring.size() > CHANGE_RING_SIZE) {
+			changes_since = change_ring.front().version + 1;
+			change_ring.pop_front();
+		}
+	}
+
 	version++;
 
 	if (version >= max) {
@@ -66,7 +85,47 @@ Queue::IncrementVersion() noexcept
 			items[i].version = 0;
 
 		version = 1;
+
+		/* the per-item versions have been reset; the change
+		   ring cannot express that, so disable it */
+		change_ring.clear();
+		changes_valid = false;
+	}
+}
+
+bool
+Queue::GetChangedPositions(uint32_t since,
+			   std::vector<unsigned> &positions) const noexcept
+{
+	if (!changes_valid || pending_overflow ||
+	    since < changes_since || since > version)
+		return false;
+
+	for (const auto &delta : change_ring) {
+		if (delta.version < since)
+			continue;
+
+		for (const unsigned id : delta.ids) {
+			const int position = IdToPosition(id);
+			if (position >= 0)
+				positions.push_back(position);
+		}
 	}
+
+	for (const unsigned id : pending_changes) {
+		const int position = IdToPosition(id);
+		if (position >= 0)
+			positions.push_back(position);
+	}
+
+	/* the same id may have been modified in several versions;
+	   sort and deduplicate so the caller prints each row once,
+	   in position order like the full scan would */
+	std::sort(positions.begin(), positions.end());
+	positions.erase(std::unique(positions.begin(), positions.end()),
+			positions.end());
+
+	return true;
 }
 
 void
@@ -91,12 +150,36 @@ Queue::Append(DetachedSong &&song, uint8_t priority) noexcept
 	item.id = id;
 	item.version = version;
 	item.priority = priority;
+	if (priority != 0)
+		++prioritized;
+
+	/* this slot may have been occupied by a deleted song whose
+	   serialization is still cached */
+	item.print_cache.clear();
+
+	uri_to_id.emplace(item.song->GetURI(), id);
+	RecordChange(id);
 
 	order[position] = position;
+	position_to_order[position] = position;
 
 	return id;
 }
 
+void
+Queue::EraseUriIndex(const Item &item) noexcept
+{
+	const auto range = uri_to_id.equal_range(item.song->GetURI());
+	for (auto i = range.first; i != range.second; ++i)
+		if (i->second == item.id) {
+			uri_to_id.erase(i);
+			return;
+		}
+
+	/* unreachable: every item has an index entry */
+	assert(false);
+}
+
 void
 Queue::SwapPositions(unsigned position1, unsigned position2) noexcept
 {
@@ -110,12 +193,15 @@ Queue::SwapPositions(unsigned position1, unsigned position2) noexcept
 
 	id_table.Move(id1, position2);
 	id_table.Move(id2, position1);
+
+	RecordChange(id1);
+	RecordChange(id2);
 }
 
 void
 Queue::MovePostion(unsigned from, unsigned to) noexcept
 {
-	const Item tmp = items[from];
+	Item tmp = std::move(items[from]);
 
 	/* move songs to one less in from->to */
 
@@ -130,7 +216,8 @@ Queue::MovePostion(unsigned from, unsigned to) noexcept
 	/* put song at _to_ */
 
 	id_table.Move(tmp.id, to);
-	items[to] = tmp;
+	RecordChange(tmp.id);
+	items[to] = std::move(tmp);
 	items[to].version = version;
 
 	/* now deal with order */
@@ -145,6 +232,12 @@ Queue::MovePostion(unsigned from, unsigned to) noexcept
 			else if (from == order[i])
 				order[i] = to;
 		}
+
+		RebuildPositionToOrder(0, length);
+	} else {
+		/* in normal order, the mapping is the identity and
+		   needs no update */
+		assert(position_to_order[to] == to);
 	}
 }
 
@@ -152,9 +245,9 @@ void
 Queue::MoveRange(unsigned start, unsigned end, unsigned to) noexcept
 {
 	Item tmp[end - start];
-	// Copy the original block [start,end-1]
+	// Move the original block [start,end-1] out of the way
 	for (unsigned i = start; i < end; i++)
-		tmp[i - start] = items[i];
+		tmp[i - start] = std::move(items[i]);
 
 	// If to > start, we need to move to-start items to start, starting from end
 	for (unsigned i = end; i < end + to - start; i++)
@@ -166,11 +259,12 @@ Queue::MoveRange(unsigned start, unsigned end, unsigned to) noexcept
 	for (int i = start - 1; i >= int(to); i--)
 		MoveItemTo(i, i + end - start);
 
-	// Copy the original block back in, starting at to.
+	// Move the original block back in, starting at to.
 	for (unsigned i = start; i< end; i++)
 	{
 		id_table.Move(tmp[i - start].id, to + i - start);
-		items[to + i - start] = tmp[i-start];
+		RecordChange(tmp[i - start].id);
+		items[to + i - start] = std::move(tmp[i-start]);
 		items[to + i - start].version = version;
 	}
 
@@ -186,6 +280,7 @@ Queue::MoveRange(unsigned start, unsigned end, unsigned to) noexcept
 				order[i] += end - start;
 			else if (start <= order[i] && order[i] < end)
 				order[i] += to - start;
+			position_to_order[order[i]] = i;
 		}
 	}
 }
@@ -207,6 +302,12 @@ Queue::MoveOrder(unsigned from_order, unsigned to_order) noexcept
 	}
 
 	order[to_order] = from_position;
+
+	if (from_order < to_order)
+		RebuildPositionToOrder(from_order, to_order + 1);
+	else
+		RebuildPositionToOrder(to_order, from_order + 1);
+
 	return to_order;
 }
 
@@ -233,6 +334,13 @@ Queue::DeletePosition(unsigned position) noexcept
 {
 	assert(position < length);
 
+	EraseUriIndex(items[position]);
+
+	if (items[position].priority != 0) {
+		assert(prioritized > 0);
+		--prioritized;
+	}
+
 	delete items[position].song;
 
 	const unsigned id = PositionToId(position);
@@ -256,9 +364,57 @@ Queue::DeletePosition(unsigned position) noexcept
 
 	/* readjust values in the order array */
 
-	for (unsigned i = 0; i < length; i++)
+	for (unsigned i = 0; i < length; i++) {
 		if (order[i] > position)
 			--order[i];
+		position_to_order[order[i]] = i;
+	}
+}
+
+void
+Queue::DeleteRange(unsigned start, unsigned end) noexcept
+{
+	assert(start < end);
+	assert(end <= length);
+
+	const unsigned n = end - start;
+
+	/* release the songs and their ids */
+
+	for (unsigned i = start; i < end; i++) {
+		EraseUriIndex(items[i]);
+
+		if (items[i].priority != 0) {
+			assert(prioritized > 0);
+			--prioritized;
+		}
+
+		delete items[i].song;
+		id_table.Erase(items[i].id);
+	}
+
+	/* close the gap in the songs array */
+
+	for (unsigned i = end; i < length; i++)
+		MoveItemTo(i, i - n);
+
+	length -= n;
+
+	/* drop the deleted positions from the order array, and
+	   renumber the remaining ones */
+
+	unsigned o = 0;
+	for (unsigned i = 0; i < length + n; i++) {
+		const unsigned p = order[i];
+		if (p < start)
+			order[o++] = p;
+		else if (p >= end)
+			order[o++] = p - n;
+	}
+
+	assert(o == length);
+
+	RebuildPositionToOrder(0, length);
 }
 
 void
@@ -272,7 +428,10 @@ Queue::Clear() noexcept
 		id_table.Erase(item->id);
 	}
 
+	uri_to_id.clear();
+
 	length = 0;
+	prioritized = 0;
 }
 
 static void
@@ -303,6 +462,7 @@ Queue::ShuffleOrderRange(unsigned start, unsigned end) noexcept
 
 	rand.AutoCreate();
 	std::shuffle(order + start, order + end, rand);
+	RebuildPositionToOrder(start, end);
 }
 
 /**
@@ -319,6 +479,13 @@ Queue::ShuffleOrderRangeWithPriority(unsigned start, unsigned end) noexcept
 	if (start == end)
 		return;
 
+	if (prioritized == 0) {
+		/* no priorities have been set - skip the sort and the
+		   group walk, and shuffle the whole range at once */
+		ShuffleOrderRange(start, end);
+		return;
+	}
+
 	/* first group the range by priority */
 	queue_sort_order_by_priority(this, start, end);
 
@@ -364,13 +531,16 @@ Queue::ShuffleOrderLastWithPriority(unsigned start, unsigned end) noexcept
 	assert(end <= length);
 	assert(start < end);
 
-	/* skip all items at the start which have a higher priority,
-	   because the last item shall only be shuffled within its
-	   priority group */
-	const auto last_priority = items[OrderToPosition(end - 1)].priority;
-	while (items[OrderToPosition(start)].priority != last_priority) {
-		++start;
-		assert(start < end);
+	if (prioritized > 0) {
+		/* skip all items at the start which have a higher
+		   priority, because the last item shall only be
+		   shuffled within its priority group */
+		const auto last_priority =
+			items[OrderToPosition(end - 1)].priority;
+		while (items[OrderToPosition(start)].priority != last_priority) {
+			++start;
+			assert(start < end);
+		}
 	}
 
 	rand.AutoCreate();
@@ -387,11 +557,16 @@ Queue::ShuffleRange(unsigned start, unsigned end) noexcept
 
 	rand.AutoCreate();
 
-	for (unsigned i = start; i < end; i++) {
-		std::uniform_int_distribution<unsigned> distribution(start,
-								     end - 1);
+	/* Fisher-Yates: swap each position with a uniformly chosen
+	   one among itself and its predecessors, which makes all
+	   permutations equally likely */
+	for (unsigned i = end; i > start + 1;) {
+		--i;
+
+		std::uniform_int_distribution<unsigned> distribution(start, i);
 		unsigned ri = distribution(rand);
-		SwapPositions(i, ri);
+		if (ri != i)
+			SwapPositions(i, ri);
 	}
 }
 
@@ -402,14 +577,29 @@ Queue::FindPriorityOrder(unsigned start_order, uint8_t priority,
 	assert(random);
 	assert(start_order <= length);
 
-	for (unsigned i = start_order; i < length; ++i) {
-		const unsigned position = OrderToPosition(i);
-		const Item *item = &items[position];
-		if (item->priority <= priority && i != exclude_order)
-			return i;
+	/* from start_order on, the order array is sorted by priority
+	   (descending); binary-search for the first entry whose
+	   priority is not higher than the given one, pretending the
+	   excluded entry (whose priority has just been changed, so
+	   it may be out of place) does not exist */
+
+	const bool exclude = exclude_order >= start_order &&
+		exclude_order < length;
+
+	unsigned a = start_order, b = exclude ? length - 1 : length;
+	while (a < b) {
+		const unsigned i = (a + b) / 2;
+		const unsigned j = exclude && i >= exclude_order
+			? i + 1 : i;
+
+		if (items[OrderToPosition(j)].priority <= priority)
+			b = i;
+		else
+			a = i + 1;
 	}
 
-	return length;
+	return exclude && a >= exclude_order
+		? a + 1 : a;
 }
 
 unsigned
@@ -417,15 +607,23 @@ Queue::CountSamePriority(unsigned start_order, uint8_t priority) const noexcept
 {
 	assert(random);
 	assert(start_order <= length);
+	assert(start_order == length ||
+	       items[OrderToPosition(start_order)].priority == priority);
 
-	for (unsigned i = start_order; i < length; ++i) {
-		const unsigned position = OrderToPosition(i);
-		const Item *item = &items[position];
-		if (item->priority != priority)
-			return i - start_order;
+	/* binary-search for the end of the priority group, which
+	   starts at start_order (see above for the sort order) */
+
+	unsigned a = start_order, b = length;
+	while (a < b) {
+		const unsigned i = (a + b) / 2;
+
+		if (items[OrderToPosition(i)].priority == priority)
+			a = i + 1;
+		else
+			b = i;
 	}
 
-	return length - start_order;
+	return a - start_order;
 }
 
 bool
@@ -441,6 +639,14 @@ Queue::SetPriority(unsigned position, uint8_t priority, int after_order,
 
 	item->version = version;
 	item->priority = priority;
+	RecordChange(item->id);
+
+	if (old_priority == 0)
+		++prioritized;
+	else if (priority == 0) {
+		assert(prioritized > 0);
+		--prioritized;
+	}
 
 	if (!random || !reorder)
 		/* don't reorder if not in random mode */
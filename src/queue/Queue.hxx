@@ -25,6 +25,10 @@
 #include "util/LazyRandomEngine.hxx"
 
 #include <algorithm>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <assert.h>
 #include <stdint.h>
@@ -67,6 +71,15 @@ struct Queue {
 		 * "random" mode.
 		 */
 		uint8_t priority;
+
+		/**
+		 * A lazily built cache of this song's protocol
+		 * serialization, maintained by QueuePrint.cxx for
+		 * clients with the default tag mask.  An empty
+		 * string means the cache is not valid.  It must be
+		 * cleared whenever the song is modified.
+		 */
+		mutable std::string print_cache;
 	};
 
 	/** configured maximum length of the queue */
@@ -84,9 +97,62 @@ struct Queue {
 	/** map order numbers to positions */
 	unsigned *const order;
 
+	/** map positions to order numbers (the inverse of #order) */
+	unsigned *const position_to_order;
+
 	/** map song ids to positions */
 	IdTable id_table;
 
+	/**
+	 * Maps song URIs to item ids.  This index answers "is this
+	 * song already enqueued?" in constant time instead of a
+	 * linear walk over all items; it is maintained by Append()
+	 * and the deletion methods.  Position moves do not affect
+	 * it, because ids are stable.
+	 */
+	std::unordered_multimap<std::string, unsigned> uri_to_id;
+
+	/**
+	 * One entry of the change ring: the ids of all items which
+	 * were modified while #version was the current version.
+	 */
+	struct ChangeDelta {
+		uint32_t version;
+		std::vector<unsigned> ids;
+	};
+
+	/** maximum number of versions kept in #change_ring */
+	static constexpr unsigned CHANGE_RING_SIZE = 32;
+
+	/** maximum number of ids recorded per version; bigger bulk
+	    edits fall back to the full scan */
+	static constexpr unsigned CHANGE_RING_MAX_IDS = 1024;
+
+	/**
+	 * A bounded ring of per-version deltas, ordered from oldest
+	 * to newest.  It allows "plchanges" with a recent base
+	 * version to collect exactly the modified rows instead of
+	 * scanning the whole queue; see GetChangedPositions().
+	 */
+	std::list<ChangeDelta> change_ring;
+
+	/** the ids modified while the current #version has been
+	    active; moved into #change_ring by IncrementVersion() */
+	std::vector<unsigned> pending_changes;
+
+	/** the oldest base version which #change_ring fully covers */
+	uint32_t changes_since = 1;
+
+	/** did #pending_changes overflow #CHANGE_RING_MAX_IDS? */
+	bool pending_overflow = false;
+
+	/**
+	 * Set to false when the version counter wraps around and all
+	 * per-item versions are reset; the ring cannot represent
+	 * that, so from then on all queries fall back to scanning.
+	 */
+	bool changes_valid = true;
+
 	/** repeat playback when the end of the queue has been
 	    reached? */
 	bool repeat = false;
@@ -100,6 +166,14 @@ struct Queue {
 	/** play back songs in random order? */
 	bool random = false;
 
+	/**
+	 * The number of items with a non-zero priority.  Maintained
+	 * by Append(), SetPriority() and the deletion methods.  As
+	 * long as it is zero, the shuffle methods can skip the
+	 * priority grouping (and its sort) entirely.
+	 */
+	unsigned prioritized = 0;
+
 	/** random number generator for shuffle and random mode */
 	LazyRandomEngine rand;
 
@@ -170,13 +244,9 @@ struct Queue {
 	gcc_pure
 	unsigned PositionToOrder(unsigned position) const noexcept {
 		assert(position < length);
+		assert(order[position_to_order[position]] == position);
 
-		for (unsigned i = 0;; ++i) {
-			assert(i < length);
-
-			if (order[i] == position)
-				return i;
-		}
+		return position_to_order[position];
 	}
 
 	gcc_pure
@@ -212,6 +282,27 @@ struct Queue {
 		return Get(OrderToPosition(_order));
 	}
 
+	/**
+	 * Counts the songs in the queue which have the specified
+	 * URI.  This is a hash table lookup, not a linear scan.
+	 */
+	gcc_pure
+	unsigned CountSongURI(const char *uri) const noexcept {
+		return uri_to_id.count(uri);
+	}
+
+	/**
+	 * Returns the id of one of the songs with the specified URI,
+	 * or -1 if there is no such song.
+	 */
+	gcc_pure
+	int FindSongURI(const char *uri) const noexcept {
+		auto i = uri_to_id.find(uri);
+		return i != uri_to_id.end()
+			? (int)i->second
+			: -1;
+	}
+
 	/**
 	 * Is the song at the specified position newer than the specified
 	 * version?
@@ -234,6 +325,18 @@ struct Queue {
 	gcc_pure
 	int GetNextOrder(unsigned order) const noexcept;
 
+	/**
+	 * Attempts to collect the positions of all songs modified
+	 * since the given version from the change ring, sorted and
+	 * without duplicates.
+	 *
+	 * @return true if the ring covers the requested version;
+	 * false means the caller must fall back to scanning all
+	 * items
+	 */
+	bool GetChangedPositions(uint32_t since,
+				 std::vector<unsigned> &positions) const noexcept;
+
 	/**
 	 * Increments the queue's version number.  This handles integer
 	 * overflow well.
@@ -249,6 +352,19 @@ struct Queue {
 		assert(position < length);
 
 		items[position].version = version;
+		items[position].print_cache.clear();
+		RecordChange(items[position].id);
+	}
+
+	/**
+	 * Access the protocol serialization cache of the song at the
+	 * given position.  An empty string means the cache is not
+	 * valid, and the caller may rebuild it.
+	 */
+	std::string &GetPrintCache(unsigned position) const noexcept {
+		assert(position < length);
+
+		return items[position].print_cache;
 	}
 
 	/**
@@ -280,6 +396,8 @@ struct Queue {
 	 */
 	void SwapOrders(unsigned order1, unsigned order2) noexcept {
 		std::swap(order[order1], order[order2]);
+		position_to_order[order[order1]] = order1;
+		position_to_order[order[order2]] = order2;
 	}
 
 	/**
@@ -322,6 +440,13 @@ struct Queue {
 	 */
 	void DeletePosition(unsigned position) noexcept;
 
+	/**
+	 * Like DeletePosition(), but removes the whole range
+	 * [start, end) with a single pass over the queue, instead of
+	 * one pass per deleted song.
+	 */
+	void DeleteRange(unsigned start, unsigned end) noexcept;
+
 	/**
 	 * Removes all songs from the playlist.
 	 */
@@ -332,7 +457,7 @@ struct Queue {
 	 */
 	void RestoreOrder() noexcept {
 		for (unsigned i = 0; i < length; ++i)
-			order[i] = i;
+			order[i] = position_to_order[i] = i;
 	}
 
 	/**
@@ -377,12 +502,49 @@ struct Queue {
 			      uint8_t priority, int after_order) noexcept;
 
 private:
+	/**
+	 * Removes the given item's entry from the #uri_to_id index.
+	 * Must be called before the item's song is deleted.
+	 */
+	void EraseUriIndex(const Item &item) noexcept;
+
+	/**
+	 * Rebuild the #position_to_order mapping for the given range
+	 * of order numbers, after the #order array has been
+	 * modified.
+	 */
+	void RebuildPositionToOrder(unsigned start_order,
+				    unsigned end_order) noexcept {
+		assert(end_order <= length);
+
+		for (unsigned i = start_order; i < end_order; ++i)
+			position_to_order[order[i]] = i;
+	}
+
+	/**
+	 * Records a modified item id in the pending delta for the
+	 * change ring.
+	 */
+	void RecordChange(unsigned id) noexcept {
+		if (pending_overflow)
+			return;
+
+		if (pending_changes.size() >= CHANGE_RING_MAX_IDS) {
+			pending_changes.clear();
+			pending_overflow = true;
+			return;
+		}
+
+		pending_changes.push_back(id);
+	}
+
 	void MoveItemTo(unsigned from, unsigned to) noexcept {
 		unsigned from_id = items[from].id;
 
-		items[to] = items[from];
+		items[to] = std::move(items[from]);
 		items[to].version = version;
 		id_table.Move(from_id, to);
+		RecordChange(from_id);
 	}
 
 	/**
@@ -23,6 +23,9 @@
 #include "SongFilter.hxx"
 #include "SongPrint.hxx"
 #include "client/Response.hxx"
+#include "tag/Mask.hxx"
+
+#include <vector>
 
 /**
  * Send detailed information about a range of songs in the queue to a
@@ -36,7 +39,23 @@ static void
 queue_print_song_info(Response &r, const Queue &queue,
 		      unsigned position)
 {
-	song_print_info(r, queue.Get(position));
+	if (r.GetTagMask() == TagMask::All() && !r.IsBinaryOutput()) {
+		/* with the default tag mask, the serialization is
+		   the same for all (text mode) clients; build it once, cache it
+		   in the queue item (cleared by
+		   Queue::ModifyAtPosition()), and serve repeated
+		   listings with a plain buffer copy */
+		std::string &cache = queue.GetPrintCache(position);
+		if (cache.empty()) {
+			r.SetCapture(&cache);
+			song_print_info(r, queue.Get(position));
+			r.SetCapture(nullptr);
+		}
+
+		r.Write(cache.data(), cache.length());
+	} else
+		song_print_info(r, queue.Get(position));
+
 	r.Format("Pos: %u\nId: %u\n",
 		 position, queue.PositionToId(position));
 
@@ -82,6 +101,17 @@ queue_print_changes_info(Response &r, const Queue &queue,
 	if (end > queue.GetLength())
 		end = queue.GetLength();
 
+	std::vector<unsigned> positions;
+	if (queue.GetChangedPositions(version, positions)) {
+		/* the change ring covers the base version: print
+		   exactly the modified rows without scanning the
+		   whole queue */
+		for (const unsigned i : positions)
+			if (i >= start && i < end)
+				queue_print_song_info(r, queue, i);
+		return;
+	}
+
 	for (unsigned i = start; i < end; i++)
 		if (queue.IsNewerAtPosition(i, version))
 			queue_print_song_info(r, queue, i);
@@ -100,6 +130,15 @@ queue_print_changes_position(Response &r, const Queue &queue,
 	if (end > queue.GetLength())
 		end = queue.GetLength();
 
+	std::vector<unsigned> positions;
+	if (queue.GetChangedPositions(version, positions)) {
+		for (const unsigned i : positions)
+			if (i >= start && i < end)
+				r.Format("cpos: %i\nId: %i\n",
+					 i, queue.PositionToId(i));
+		return;
+	}
+
 	for (unsigned i = start; i < end; i++)
 		if (queue.IsNewerAtPosition(i, version))
 			r.Format("cpos: %i\nId: %i\n",
@@ -117,3 +156,21 @@ queue_find(Response &r, const Queue &queue,
 			queue_print_song_info(r, queue, i);
 	}
 }
+
+void
+queue_find_uri(Response &r, const Queue &queue, const char *uri)
+{
+	/* collect the matching ids from the URI index and convert
+	   them to positions; the hash table's iteration order is
+	   arbitrary, so sort for a stable response */
+
+	std::vector<unsigned> positions;
+	const auto range = queue.uri_to_id.equal_range(uri);
+	for (auto i = range.first; i != range.second; ++i)
+		positions.push_back(queue.IdToPosition(i->second));
+
+	std::sort(positions.begin(), positions.end());
+
+	for (unsigned position : positions)
+		queue_print_song_info(r, queue, position);
+}
@@ -53,4 +53,11 @@ void
 queue_find(Response &response, const Queue &queue,
 	   const SongFilter &filter);
 
+/**
+ * Print all songs with the given URI, using the queue's URI index
+ * instead of a linear scan.
+ */
+void
+queue_find_uri(Response &response, const Queue &queue, const char *uri);
+
 #endif
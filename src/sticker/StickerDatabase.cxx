@@ -28,6 +28,7 @@
 
 #include <string>
 #include <map>
+#include <list>
 
 #include <assert.h>
 
@@ -36,7 +37,6 @@ struct Sticker {
 };
 
 enum sticker_sql {
-	STICKER_SQL_GET,
 	STICKER_SQL_LIST,
 	STICKER_SQL_UPDATE,
 	STICKER_SQL_INSERT,
@@ -49,8 +49,6 @@ enum sticker_sql {
 };
 
 static const char *const sticker_sql[] = {
-	//[STICKER_SQL_GET] =
-	"SELECT value FROM sticker WHERE type=? AND uri=? AND name=?",
 	//[STICKER_SQL_LIST] =
 	"SELECT name,value FROM sticker WHERE type=? AND uri=?",
 	//[STICKER_SQL_UPDATE] =
@@ -88,6 +86,95 @@ static const char sticker_sql_create[] =
 static sqlite3 *sticker_db;
 static sqlite3_stmt *sticker_stmt[ARRAY_SIZE(sticker_sql)];
 
+struct StickerCacheItem {
+	std::string key;
+	std::map<std::string, std::string> table;
+};
+
+/**
+ * Maximum number of objects in the sticker cache.  Above this, the
+ * least recently used item is evicted.
+ */
+static constexpr size_t STICKER_CACHE_MAX_SIZE = 1024;
+
+/**
+ * A write-through LRU cache of sticker tables, most recently used
+ * first.  Clients (e.g. those rendering song ratings) tend to query
+ * stickers for every song in view, most of which have none; caching
+ * the whole table per object (including the negative result) avoids
+ * repeating those queries.  All writes go through this library, which
+ * keeps the cache coherent.
+ */
+static std::list<StickerCacheItem> sticker_cache;
+static std::map<std::string, std::list<StickerCacheItem>::iterator> sticker_cache_index;
+
+static std::string
+sticker_cache_key(const char *type, const char *uri) noexcept
+{
+	/* a type cannot contain a null byte, so this concatenation
+	   is unambiguous */
+	std::string key(type);
+	key.push_back('\0');
+	key.append(uri);
+	return key;
+}
+
+static const std::map<std::string, std::string> *
+sticker_cache_lookup(const std::string &key) noexcept
+{
+	auto i = sticker_cache_index.find(key);
+	if (i == sticker_cache_index.end())
+		return nullptr;
+
+	/* move the item to the front of the LRU list */
+	sticker_cache.splice(sticker_cache.begin(), sticker_cache,
+			     i->second);
+	return &i->second->table;
+}
+
+static const std::map<std::string, std::string> &
+sticker_cache_store(std::string &&key,
+		    std::map<std::string, std::string> &&table)
+{
+	if (sticker_cache.size() >= STICKER_CACHE_MAX_SIZE) {
+		/* evict the least recently used item */
+		sticker_cache_index.erase(sticker_cache.back().key);
+		sticker_cache.pop_back();
+	}
+
+	sticker_cache.emplace_front(StickerCacheItem{key, std::move(table)});
+	sticker_cache_index.emplace(std::move(key), sticker_cache.begin());
+	return sticker_cache.front().table;
+}
+
+static void
+sticker_cache_update(const char *type, const char *uri,
+		     const char *name, const char *value) noexcept
+{
+	auto i = sticker_cache_index.find(sticker_cache_key(type, uri));
+	if (i != sticker_cache_index.end())
+		i->second->table[name] = value;
+}
+
+static void
+sticker_cache_erase(const char *type, const char *uri) noexcept
+{
+	auto i = sticker_cache_index.find(sticker_cache_key(type, uri));
+	if (i != sticker_cache_index.end()) {
+		sticker_cache.erase(i->second);
+		sticker_cache_index.erase(i);
+	}
+}
+
+static void
+sticker_cache_erase_value(const char *type, const char *uri,
+			  const char *name) noexcept
+{
+	auto i = sticker_cache_index.find(sticker_cache_key(type, uri));
+	if (i != sticker_cache_index.end())
+		i->second->table.erase(name);
+}
+
 static sqlite3_stmt *
 sticker_prepare(const char *sql)
 {
@@ -125,6 +212,15 @@ sticker_global_init(Path path)
 		throw SqliteError(sticker_db, ret,
 				  "Failed to create sticker table");
 
+	/* enable the write-ahead log, which makes sticker updates
+	   cheaper because SQLite need not copy whole pages into a
+	   rollback journal; if this fails (e.g. very old SQLite or an
+	   unsupported file system), SQLite silently keeps the default
+	   journal mode, so errors are ignored here */
+
+	sqlite3_exec(sticker_db, "PRAGMA journal_mode=WAL",
+		     nullptr, nullptr, nullptr);
+
 	/* prepare the statements we're going to use */
 
 	for (unsigned i = 0; i < ARRAY_SIZE(sticker_sql); ++i) {
@@ -148,6 +244,9 @@ sticker_global_finish()
 	}
 
 	sqlite3_close(sticker_db);
+
+	sticker_cache.clear();
+	sticker_cache_index.clear();
 }
 
 bool
@@ -156,33 +255,6 @@ sticker_enabled() noexcept
 	return sticker_db != nullptr;
 }
 
-std::string
-sticker_load_value(const char *type, const char *uri, const char *name)
-{
-	sqlite3_stmt *const stmt = sticker_stmt[STICKER_SQL_GET];
-
-	assert(sticker_enabled());
-	assert(type != nullptr);
-	assert(uri != nullptr);
-	assert(name != nullptr);
-
-	if (StringIsEmpty(name))
-		return std::string();
-
-	BindAll(stmt, type, uri, name);
-
-	AtScopeExit(stmt) {
-		sqlite3_reset(stmt);
-		sqlite3_clear_bindings(stmt);
-	};
-
-	std::string value;
-	if (ExecuteRow(stmt))
-		value = (const char*)sqlite3_column_text(stmt, 0);
-
-	return value;
-}
-
 static void
 sticker_list_values(std::map<std::string, std::string> &table,
 		    const char *type, const char *uri)
@@ -207,6 +279,42 @@ sticker_list_values(std::map<std::string, std::string> &table,
 		});
 }
 
+/**
+ * Obtain the (cached) sticker table for the specified object, loading
+ * it from the database if it is not in the cache.  The returned
+ * reference is invalidated by the next cache operation.
+ *
+ * Throws #SqliteError on error.
+ */
+static const std::map<std::string, std::string> &
+sticker_cache_get(const char *type, const char *uri)
+{
+	auto key = sticker_cache_key(type, uri);
+	const auto *cached = sticker_cache_lookup(key);
+	if (cached != nullptr)
+		return *cached;
+
+	std::map<std::string, std::string> table;
+	sticker_list_values(table, type, uri);
+	return sticker_cache_store(std::move(key), std::move(table));
+}
+
+std::string
+sticker_load_value(const char *type, const char *uri, const char *name)
+{
+	assert(sticker_enabled());
+	assert(type != nullptr);
+	assert(uri != nullptr);
+	assert(name != nullptr);
+
+	if (StringIsEmpty(name))
+		return std::string();
+
+	const auto &table = sticker_cache_get(type, uri);
+	auto i = table.find(name);
+	return i != table.end() ? i->second : std::string();
+}
+
 static bool
 sticker_update_value(const char *type, const char *uri,
 		     const char *name, const char *value)
@@ -275,6 +383,8 @@ sticker_store_value(const char *type, const char *uri,
 
 	if (!sticker_update_value(type, uri, name, value))
 		sticker_insert_value(type, uri, name, value);
+
+	sticker_cache_update(type, uri, name, value);
 }
 
 bool
@@ -294,8 +404,11 @@ sticker_delete(const char *type, const char *uri)
 	};
 
 	bool modified = ExecuteModified(stmt);
-	if (modified)
+	if (modified) {
+		sticker_cache_erase(type, uri);
 		idle_add(IDLE_STICKER);
+	}
+
 	return modified;
 }
 
@@ -316,8 +429,11 @@ sticker_delete_value(const char *type, const char *uri, const char *name)
 	};
 
 	bool modified = ExecuteModified(stmt);
-	if (modified)
+	if (modified) {
+		sticker_cache_erase_value(type, uri, name);
 		idle_add(IDLE_STICKER);
+	}
+
 	return modified;
 }
 
@@ -350,15 +466,13 @@ sticker_foreach(const Sticker &sticker,
 Sticker *
 sticker_load(const char *type, const char *uri)
 {
-	Sticker s;
-
-	sticker_list_values(s.table, type, uri);
+	const auto &table = sticker_cache_get(type, uri);
 
-	if (s.table.empty())
+	if (table.empty())
 		/* don't return empty sticker objects */
 		return nullptr;
 
-	return new Sticker(std::move(s));
+	return new Sticker{table};
 }
 
 static sqlite3_stmt *
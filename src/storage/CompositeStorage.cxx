@@ -23,6 +23,7 @@
 #include "fs/AllocatedPath.hxx"
 #include "util/StringCompare.hxx"
 
+#include <algorithm>
 #include <set>
 #include <stdexcept>
 
@@ -89,20 +90,31 @@ CompositeDirectoryReader::GetInfo(bool follow)
 	return StorageFileInfo(StorageFileInfo::Type::DIRECTORY);
 }
 
-static std::string
-NextSegment(const char *&uri_r)
+static StringView
+NextSegment(const char *&uri_r) noexcept
 {
 	const char *uri = uri_r;
 	const char *slash = strchr(uri, '/');
 	if (slash == nullptr) {
 		uri_r += strlen(uri);
-		return std::string(uri);
+		return StringView(uri);
 	} else {
 		uri_r = slash + 1;
-		return std::string(uri, slash);
+		return StringView(uri, slash);
 	}
 }
 
+int
+CompositeStorage::Directory::NameLess::Compare(StringView a,
+					       StringView b) noexcept
+{
+	int cmp = memcmp(a.data, b.data, std::min(a.size, b.size));
+	if (cmp != 0)
+		return cmp;
+
+	return a.size < b.size ? -1 : (a.size > b.size);
+}
+
 CompositeStorage::Directory::~Directory()
 {
 	delete storage;
@@ -113,7 +125,7 @@ CompositeStorage::Directory::Find(const char *uri) const noexcept
 {
 	const Directory *directory = this;
 	while (*uri != 0) {
-		const std::string name = NextSegment(uri);
+		const auto name = NextSegment(uri);
 		auto i = directory->children.find(name);
 		if (i == directory->children.end())
 			return nullptr;
@@ -129,8 +141,9 @@ CompositeStorage::Directory::Make(const char *uri)
 {
 	Directory *directory = this;
 	while (*uri != 0) {
-		const std::string name = NextSegment(uri);
-		auto i = directory->children.emplace(std::move(name),
+		const auto name = NextSegment(uri);
+		auto i = directory->children.emplace(std::string(name.data,
+								 name.size),
 						     Directory());
 		directory = &i.first->second;
 	}
@@ -155,7 +168,7 @@ CompositeStorage::Directory::Unmount(const char *uri) noexcept
 	if (StringIsEmpty(uri))
 		return Unmount();
 
-	const std::string name = NextSegment(uri);
+	const auto name = NextSegment(uri);
 
 	auto i = children.find(name);
 	if (i == children.end() || !i->second.Unmount(uri))
@@ -239,7 +252,7 @@ CompositeStorage::FindStorage(const char *uri) const noexcept
 
 	const Directory *directory = &root;
 	while (*uri != 0) {
-		const std::string name = NextSegment(uri);
+		const auto name = NextSegment(uri);
 
 		auto i = directory->children.find(name);
 		if (i == directory->children.end())
@@ -23,6 +23,7 @@
 #include "check.h"
 #include "StorageInterface.hxx"
 #include "thread/Mutex.hxx"
+#include "util/StringView.hxx"
 #include "Compiler.h"
 
 #include <string>
@@ -49,7 +50,38 @@ class CompositeStorage final : public Storage {
 		 */
 		Storage *storage;
 
-		std::map<std::string, Directory> children;
+		/**
+		 * A transparent comparator for #children, so lookups
+		 * can pass a #StringView pointing into the given URI
+		 * instead of allocating a copy of each path segment.
+		 */
+		struct NameLess {
+			typedef void is_transparent;
+
+			gcc_pure
+			bool operator()(const std::string &a,
+					const std::string &b) const noexcept {
+				return a < b;
+			}
+
+			gcc_pure
+			bool operator()(const std::string &a,
+					StringView b) const noexcept {
+				return Compare({a.data(), a.length()}, b) < 0;
+			}
+
+			gcc_pure
+			bool operator()(StringView a,
+					const std::string &b) const noexcept {
+				return Compare(a, {b.data(), b.length()}) < 0;
+			}
+
+		private:
+			gcc_pure
+			static int Compare(StringView a, StringView b) noexcept;
+		};
+
+		std::map<std::string, Directory, NameLess> children;
 
 		Directory():storage(nullptr) {}
 		~Directory();
@@ -21,6 +21,7 @@
 #include "Registry.hxx"
 #include "StoragePlugin.hxx"
 #include "plugins/LocalStorage.hxx"
+#include "plugins/FaultStorage.hxx"
 #include "plugins/SmbclientStorage.hxx"
 #include "plugins/NfsStorage.hxx"
 #include "plugins/CurlStorage.hxx"
@@ -30,6 +31,7 @@
 
 const StoragePlugin *const storage_plugins[] = {
 	&local_storage_plugin,
+	&fault_storage_plugin,
 #ifdef ENABLE_SMBCLIENT
 	&smbclient_storage_plugin,
 #endif
@@ -41,22 +41,51 @@
 #include "util/UriUtil.hxx"
 
 #include <algorithm>
+#include <forward_list>
+#include <map>
 #include <memory>
 #include <string>
 #include <list>
 
 #include <assert.h>
 
+class HttpListDirectoryOperation;
+
 class CurlStorage final : public Storage {
 	const std::string base;
 
 	CurlInit curl;
 
+	/**
+	 * The maximum number of speculative PROPFIND requests in
+	 * flight at a time.
+	 */
+	static constexpr unsigned MAX_PREFETCH = 8;
+
+	/**
+	 * Protects #prefetch.
+	 */
+	mutable Mutex prefetch_mutex;
+
+	/**
+	 * Directory listings which were requested speculatively,
+	 * keyed by the collection URI.  While database update walks
+	 * the tree, the listing of a directory reveals its child
+	 * collections, and their PROPFIND requests are started right
+	 * away; when the update thread gets around to the child, the
+	 * response is usually already there, hiding most of the
+	 * server round-trip latency.
+	 */
+	std::map<std::string,
+		 std::unique_ptr<HttpListDirectoryOperation>> prefetch;
+
 public:
 	CurlStorage(EventLoop &_loop, const char *_base)
 		:base(_base),
 		 curl(_loop) {}
 
+	~CurlStorage() override;
+
 	/* virtual methods from class Storage */
 	StorageFileInfo GetInfo(const char *uri_utf8, bool follow) override;
 
@@ -65,6 +94,22 @@ public:
 	std::string MapUTF8(const char *uri_utf8) const noexcept override;
 
 	const char *MapToRelativeUTF8(const char *uri_utf8) const noexcept override;
+
+private:
+	/**
+	 * Remove a pending speculative listing from #prefetch.
+	 *
+	 * @return the operation or nullptr if the URI was not
+	 * prefetched
+	 */
+	std::unique_ptr<HttpListDirectoryOperation> TakePrefetch(const std::string &uri) noexcept;
+
+	/**
+	 * Start speculative PROPFIND requests for the given child
+	 * collections, limited by #MAX_PREFETCH.
+	 */
+	void PrefetchChildren(const std::string &base_uri,
+			      const std::forward_list<std::string> &names) noexcept;
 };
 
 std::string
@@ -469,6 +514,12 @@ class HttpListDirectoryOperation final : public PropfindOperation {
 
 	MemoryStorageDirectoryReader::List entries;
 
+	/**
+	 * The escaped names of all child collections found in the
+	 * response, for speculative prefetching by #CurlStorage.
+	 */
+	std::forward_list<std::string> collections;
+
 public:
 	HttpListDirectoryOperation(CurlGlobal &curl, const char *uri)
 		:PropfindOperation(curl, uri, 1),
@@ -479,6 +530,13 @@ public:
 		return ToReader();
 	}
 
+	/**
+	 * May only be called after Wait().
+	 */
+	const std::forward_list<std::string> &GetCollections() const noexcept {
+		return collections;
+	}
+
 private:
 	StorageDirectoryReader *ToReader() {
 		return new MemoryStorageDirectoryReader(std::move(entries));
@@ -523,6 +581,10 @@ protected:
 		// TODO: unescape
 		const auto name = escaped_name;
 
+		if (r.collection)
+			collections.emplace_front(escaped_name.data,
+						  escaped_name.size);
+
 		entries.emplace_front(std::string(name.data, name.size));
 
 		auto &info = entries.front().info;
@@ -534,6 +596,63 @@ protected:
 	}
 };
 
+CurlStorage::~CurlStorage()
+{
+	/* wait for the pending speculative requests; destructing a
+	   transfer which is still in flight would race with the curl
+	   event loop */
+	for (auto &i : prefetch) {
+		try {
+			i.second->Wait();
+		} catch (...) {
+		}
+	}
+}
+
+std::unique_ptr<HttpListDirectoryOperation>
+CurlStorage::TakePrefetch(const std::string &uri) noexcept
+{
+	const std::lock_guard<Mutex> protect(prefetch_mutex);
+
+	auto i = prefetch.find(uri);
+	if (i == prefetch.end())
+		return nullptr;
+
+	auto result = std::move(i->second);
+	prefetch.erase(i);
+	return result;
+}
+
+void
+CurlStorage::PrefetchChildren(const std::string &base_uri,
+			      const std::forward_list<std::string> &names) noexcept
+{
+	const std::lock_guard<Mutex> protect(prefetch_mutex);
+
+	for (const auto &name : names) {
+		if (prefetch.size() >= MAX_PREFETCH)
+			break;
+
+		std::string uri = base_uri;
+		uri += name;
+		uri.push_back('/');
+
+		auto i = prefetch.find(uri);
+		if (i != prefetch.end())
+			continue;
+
+		try {
+			auto op = std::make_unique<HttpListDirectoryOperation>(*curl,
+									       uri.c_str());
+			prefetch.emplace(std::move(uri), std::move(op));
+		} catch (...) {
+			/* failure to start a speculative request is
+			   not an error; the directory will be listed
+			   on demand */
+		}
+	}
+}
+
 StorageDirectoryReader *
 CurlStorage::OpenDirectory(const char *uri_utf8)
 {
@@ -546,7 +665,20 @@ CurlStorage::OpenDirectory(const char *uri_utf8)
 	if (uri.back() != '/')
 		uri.push_back('/');
 
-	return HttpListDirectoryOperation(*curl, uri.c_str()).Perform();
+	auto operation = TakePrefetch(uri);
+	if (operation == nullptr)
+		operation = std::make_unique<HttpListDirectoryOperation>(*curl,
+									 uri.c_str());
+
+	auto *reader = operation->Perform();
+
+	/* the listing revealed this directory's child collections;
+	   request their listings right away, so the following
+	   OpenDirectory() calls do not have to wait for the whole
+	   server round trip */
+	PrefetchChildren(uri, operation->GetCollections());
+
+	return reader;
 }
 
 static Storage *
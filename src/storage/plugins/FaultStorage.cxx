@@ -0,0 +1,161 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "FaultStorage.hxx"
+#include "FaultInjectionConfig.hxx"
+#include "storage/StoragePlugin.hxx"
+#include "storage/StorageInterface.hxx"
+#include "storage/FileInfo.hxx"
+#include "storage/Registry.hxx"
+#include "fs/Traits.hxx"
+#include "thread/Mutex.hxx"
+#include "util/StringCompare.hxx"
+#include "util/RuntimeError.hxx"
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+static constexpr char FAULT_SCHEME[] = "fault://";
+
+class FaultStorage final : public Storage {
+	const std::string base;
+
+	const FaultInjectionConfig config;
+
+	const std::unique_ptr<Storage> inner;
+
+	/**
+	 * Protects #prng; the update thread pool may call into this
+	 * object concurrently.
+	 */
+	mutable Mutex mutex;
+
+	mutable std::minstd_rand prng;
+
+	mutable std::uniform_real_distribution<double> error_dist{0.0, 1.0};
+
+public:
+	FaultStorage(const char *_base, const FaultInjectionConfig &_config,
+		     Storage *_inner)
+		:base(_base), config(_config), inner(_inner),
+		 prng(config.seed) {}
+
+	/**
+	 * Sleep for the configured latency, and roll for an injected
+	 * error.
+	 *
+	 * Throws std::runtime_error when the roll fails.
+	 */
+	void InjectFault() const {
+		ApplyLatency();
+
+		if (config.error_rate > 0) {
+			const std::lock_guard<Mutex> protect(mutex);
+			if (error_dist(prng) < config.error_rate)
+				throw std::runtime_error("injected storage error");
+		}
+	}
+
+	void ApplyLatency() const noexcept {
+		if (config.latency > config.latency.zero())
+			std::this_thread::sleep_for(config.latency);
+	}
+
+	/* virtual methods from class Storage */
+	StorageFileInfo GetInfo(const char *uri_utf8, bool follow) override {
+		InjectFault();
+		return inner->GetInfo(uri_utf8, follow);
+	}
+
+	StorageDirectoryReader *OpenDirectory(const char *uri_utf8) override;
+
+	std::string MapUTF8(const char *uri_utf8) const noexcept override {
+		if (StringIsEmpty(uri_utf8))
+			return base;
+
+		return PathTraitsUTF8::Build(base.c_str(), uri_utf8);
+	}
+
+	/* the default MapFS() implementation returns "null", which
+	   forces all file access through this wrapper instead of
+	   bypassing it with direct file system calls */
+
+	const char *MapToRelativeUTF8(const char *uri_utf8) const noexcept override {
+		return PathTraitsUTF8::Relative(base.c_str(), uri_utf8);
+	}
+};
+
+class FaultDirectoryReader final : public StorageDirectoryReader {
+	FaultStorage &storage;
+
+	const std::unique_ptr<StorageDirectoryReader> inner;
+
+public:
+	FaultDirectoryReader(FaultStorage &_storage,
+			     StorageDirectoryReader *_inner)
+		:storage(_storage), inner(_inner) {}
+
+	/* virtual methods from class StorageDirectoryReader */
+	const char *Read() noexcept override {
+		/* this method must not throw, so only the latency is
+		   injected here */
+		storage.ApplyLatency();
+		return inner->Read();
+	}
+
+	StorageFileInfo GetInfo(bool follow) override {
+		storage.InjectFault();
+		return inner->GetInfo(follow);
+	}
+};
+
+StorageDirectoryReader *
+FaultStorage::OpenDirectory(const char *uri_utf8)
+{
+	InjectFault();
+	return new FaultDirectoryReader(*this, inner->OpenDirectory(uri_utf8));
+}
+
+static Storage *
+CreateFaultStorageURI(EventLoop &event_loop, const char *uri)
+{
+	const char *tail = StringAfterPrefix(uri, FAULT_SCHEME);
+	if (tail == nullptr)
+		return nullptr;
+
+	FaultInjectionConfig config;
+	const char *inner_uri = ParseFaultOptions(config, tail);
+
+	Storage *inner = CreateStorageURI(event_loop, inner_uri);
+	if (inner == nullptr)
+		throw FormatRuntimeError("Unrecognized storage URI: %s",
+					 inner_uri);
+
+	return new FaultStorage(uri, config, inner);
+}
+
+const StoragePlugin fault_storage_plugin = {
+	"fault",
+	CreateFaultStorageURI,
+};
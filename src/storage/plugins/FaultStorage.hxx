@@ -0,0 +1,35 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_STORAGE_FAULT_HXX
+#define MPD_STORAGE_FAULT_HXX
+
+#include "check.h"
+
+/**
+ * A storage "plugin" which wraps any other storage and injects
+ * configurable latency and random errors, for regression-testing the
+ * update and database code under reproducible degraded I/O.  The URI
+ * syntax is "fault://" followed by an optional "NAME=VALUE&...;"
+ * options segment and the real storage URI, e.g.
+ * "fault://latency_ms=50&error_rate=1;nfs://server/share".
+ */
+extern const struct StoragePlugin fault_storage_plugin;
+
+#endif
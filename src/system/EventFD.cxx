@@ -38,7 +38,14 @@ EventFD::Read()
 	assert(fd.IsDefined());
 
 	eventfd_t value;
-	return fd.Read(&value, sizeof(value)) == (ssize_t)sizeof(value);
+	bool result = fd.Read(&value, sizeof(value)) == (ssize_t)sizeof(value);
+
+	/* clear the flag only after draining the eventfd: this way, a
+	   concurrent Write() can cause a spurious wakeup, but never a
+	   lost one */
+	pending.store(false);
+
+	return result;
 }
 
 void
@@ -46,6 +53,11 @@ EventFD::Write()
 {
 	assert(fd.IsDefined());
 
+	if (pending.exchange(true))
+		/* a wakeup is already pending; skip the redundant
+		   syscall */
+		return;
+
 	static constexpr eventfd_t value = 1;
 	gcc_unused ssize_t nbytes =
 		fd.Write(&value, sizeof(value));
@@ -23,6 +23,8 @@
 #include "check.h"
 #include "UniqueFileDescriptor.hxx"
 
+#include <atomic>
+
 /**
  * A class that wraps eventfd().
  *
@@ -31,6 +33,13 @@
 class EventFD {
 	UniqueFileDescriptor fd;
 
+	/**
+	 * Is a wakeup pending, i.e. has Write() already hit the
+	 * eventfd since the last Read()?  Used to coalesce multiple
+	 * notifications into one syscall per wakeup.
+	 */
+	std::atomic_bool pending{false};
+
 public:
 	EventFD();
 
@@ -71,10 +71,17 @@ EventPipe::Read()
 
 	char buffer[256];
 #ifdef _WIN32
-	return recv(fds[0], buffer, sizeof(buffer), 0) > 0;
+	bool result = recv(fds[0], buffer, sizeof(buffer), 0) > 0;
 #else
-	return read(fds[0], buffer, sizeof(buffer)) > 0;
+	bool result = read(fds[0], buffer, sizeof(buffer)) > 0;
 #endif
+
+	/* clear the flag only after draining the pipe: this way, a
+	   concurrent Write() can cause a spurious wakeup, but never a
+	   lost one */
+	pending.store(false);
+
+	return result;
 }
 
 void
@@ -83,6 +90,11 @@ EventPipe::Write()
 	assert(fds[0] >= 0);
 	assert(fds[1] >= 0);
 
+	if (pending.exchange(true))
+		/* a wakeup is already pending; skip the redundant
+		   syscall */
+		return;
+
 #ifdef _WIN32
 	send(fds[1], "", 1, 0);
 #else
@@ -22,6 +22,8 @@
 
 #include "check.h"
 
+#include <atomic>
+
 /**
  * A pipe that can be used to trigger an event to the read side.
  *
@@ -30,6 +32,13 @@
 class EventPipe {
 	int fds[2];
 
+	/**
+	 * Is a wakeup pending, i.e. has Write() already hit the pipe
+	 * since the last Read()?  Used to coalesce multiple
+	 * notifications into one syscall per wakeup.
+	 */
+	std::atomic_bool pending{false};
+
 public:
 	EventPipe();
 	~EventPipe();
@@ -47,7 +47,8 @@ tag_ape_name_parse(const char *name)
 /**
  * Invoke the given callback for each string inside the given range.
  * The strings are separated by null bytes, but the last one may not
- * be terminated.
+ * be terminated; each one is passed as #StringView without copying
+ * it out of the read buffer.
  */
 template<typename C>
 static void
@@ -59,15 +60,13 @@ ForEachValue(const char *value, const char *end, C &&callback)
 			break;
 
 		if (n > value)
-			callback(value);
+			callback(StringView(value, n));
 
 		value = n + 1;
 	}
 
-	if (value < end) {
-		const std::string value2(value, end);
-		callback(value2.c_str());
-	}
+	if (value < end)
+		callback(StringView(value, end));
 }
 
 /**
@@ -87,8 +86,12 @@ tag_ape_import_item(unsigned long flags,
 
 	if (handler.pair != nullptr)
 		ForEachValue(begin, end, [handler, handler_ctx,
-					  key](const char *_value) {
-				handler.pair(key, _value, handler_ctx);
+					  key](StringView _value) {
+				/* the pair callback expects a
+				   null-terminated string */
+				const std::string copy(_value.data,
+						       _value.size);
+				handler.pair(key, copy.c_str(), handler_ctx);
 			});
 
 	TagType type = tag_ape_name_parse(key);
@@ -96,7 +99,7 @@ tag_ape_import_item(unsigned long flags,
 		return false;
 
 	ForEachValue(begin, end, [handler, handler_ctx,
-				  type](const char *_value) {
+				  type](StringView _value) {
 			tag_handler_invoke_tag(handler, handler_ctx,
 					       type, _value);
 		});
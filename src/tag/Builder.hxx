@@ -174,4 +174,14 @@ private:
 	void AddItemInternal(TagType type, StringView value);
 };
 
+/**
+ * Returns this thread's scratch #TagBuilder, cleared and ready for
+ * use.  Scanning one song after another with the same instance
+ * reuses the item vector's allocation instead of reallocating it per
+ * song.  The caller must stop using the reference before anybody
+ * else on this thread calls this function again.
+ */
+TagBuilder &
+GetScratchTagBuilder() noexcept;
+
 #endif
@@ -27,11 +27,55 @@
 #include <assert.h>
 #include <stdlib.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Skip over a leading run of printable ASCII characters, i.e. bytes
+ * which are trivially valid UTF-8 and need no fixing.  Returns a
+ * pointer to the first byte which needs closer inspection (a control
+ * character or the start of a multi-byte sequence), or the end of
+ * the string.
+ */
+gcc_pure
+static const char *
+SkipPrintableASCII(const char *p, const char *const end) noexcept
+{
+#ifdef __SSE2__
+	/* 16 bytes at a time; the signed comparison flags control
+	   characters (below 0x20) and bytes with the high bit set
+	   (which are negative) alike */
+	const __m128i limit = _mm_set1_epi8(0x20);
+
+	while (p + 16 <= end) {
+		const __m128i chunk =
+			_mm_loadu_si128((const __m128i *)(const void *)p);
+		const unsigned mask =
+			_mm_movemask_epi8(_mm_cmplt_epi8(chunk, limit));
+		if (mask != 0)
+			return p + __builtin_ctz(mask);
+
+		p += 16;
+	}
+#endif
+
+	while (p < end &&
+	       (unsigned char)*p >= 0x20 && (unsigned char)*p < 0x80)
+		++p;
+
+	return p;
+}
+
 gcc_pure
 static const char *
 FindInvalidUTF8(const char *p, const char *const end) noexcept
 {
 	while (p < end) {
+		p = SkipPrintableASCII(p, end);
+		if (p >= end)
+			break;
+
 		const size_t s = SequenceLengthUTF8(*p);
 		if (p + s > end)
 			/* partial sequence at end of string */
@@ -93,9 +137,29 @@ char_is_non_printable(unsigned char ch)
 static const char *
 find_non_printable(StringView p)
 {
-	for (const char &ch : p)
-		if (char_is_non_printable(ch))
-			return &ch;
+	const char *s = p.begin(), *const end = p.end();
+
+#ifdef __SSE2__
+	/* unsigned "ch < 0x20": a byte is below the limit iff
+	   clamping it to 0x1f does not change it */
+	const __m128i limit = _mm_set1_epi8(0x1f);
+
+	while (s + 16 <= end) {
+		const __m128i chunk =
+			_mm_loadu_si128((const __m128i *)(const void *)s);
+		const unsigned mask =
+			_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(chunk, limit),
+							 chunk));
+		if (mask != 0)
+			return s + __builtin_ctz(mask);
+
+		s += 16;
+	}
+#endif
+
+	for (; s != end; ++s)
+		if (char_is_non_printable(*s))
+			return s;
 
 	return nullptr;
 }
@@ -20,10 +20,13 @@
 #include "config.h"
 #include "Handler.hxx"
 #include "Builder.hxx"
+#include "ReplayGain.hxx"
+#include "ReplayGainInfo.hxx"
 #include "util/ASCII.hxx"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 static void
 add_tag_duration(SongTime duration, void *ctx)
@@ -34,15 +37,22 @@ add_tag_duration(SongTime duration, void *ctx)
 }
 
 static void
-add_tag_tag(TagType type, const char *value, void *ctx)
+add_tag_tag(TagType type, StringView value, void *ctx)
 {
 	TagBuilder &tag = *(TagBuilder *)ctx;
 
 	if (type == TAG_TRACK || type == TAG_DISC) {
 		/* filter out this extra data and leading zeroes */
+
+		char buffer[64];
+		if (value.size >= sizeof(buffer))
+			value.size = sizeof(buffer) - 1;
+		memcpy(buffer, value.data, value.size);
+		buffer[value.size] = 0;
+
 		char *end;
-		unsigned n = strtoul(value, &end, 10);
-		if (value != end) {
+		unsigned n = strtoul(buffer, &end, 10);
+		if (buffer != end) {
 			char s[21];
 			if (snprintf(s, 21, "%u", n) > 0)
 				tag.AddItem(type, s);
@@ -72,3 +82,34 @@ const TagHandler full_tag_handler = {
 	full_tag_pair,
 };
 
+static void
+full_replay_gain_tag_duration(SongTime duration, void *ctx)
+{
+	auto &c = *(TagReplayGainContext *)ctx;
+
+	add_tag_duration(duration, &c.builder);
+}
+
+static void
+full_replay_gain_tag_tag(TagType type, StringView value, void *ctx)
+{
+	auto &c = *(TagReplayGainContext *)ctx;
+
+	add_tag_tag(type, value, &c.builder);
+}
+
+static void
+full_replay_gain_tag_pair(const char *name, const char *value, void *ctx)
+{
+	auto &c = *(TagReplayGainContext *)ctx;
+
+	full_tag_pair(name, value, &c.builder);
+	ParseReplayGainTag(c.rgi, name, value);
+}
+
+const TagHandler full_replay_gain_tag_handler = {
+	full_replay_gain_tag_duration,
+	full_replay_gain_tag_tag,
+	full_replay_gain_tag_pair,
+};
+
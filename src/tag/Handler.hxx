@@ -23,9 +23,13 @@
 #include "check.h"
 #include "Type.h"
 #include "Chrono.hxx"
+#include "util/StringView.hxx"
 
 #include <assert.h>
 
+class TagBuilder;
+struct ReplayGainInfo;
+
 /**
  * A callback table for receiving metadata of a song.
  */
@@ -40,10 +44,11 @@ struct TagHandler {
 	/**
 	 * A tag has been read.
 	 *
-	 * @param the value of the tag; the pointer will become
-	 * invalid after returning
+	 * @param the value of the tag; it may point into the
+	 * parser's read buffer, is not necessarily null-terminated
+	 * and will become invalid after returning
 	 */
-	void (*tag)(TagType type, const char *value, void *ctx);
+	void (*tag)(TagType type, StringView value, void *ctx);
 
 	/**
 	 * A name-value pair has been read.  It is the codec specific
@@ -62,15 +67,24 @@ tag_handler_invoke_duration(const TagHandler &handler, void *ctx,
 
 static inline void
 tag_handler_invoke_tag(const TagHandler &handler, void *ctx,
-		       TagType type, const char *value)
+		       TagType type, StringView value)
 {
 	assert((unsigned)type < TAG_NUM_OF_ITEM_TYPES);
-	assert(value != nullptr);
+	assert(!value.IsNull());
 
 	if (handler.tag != nullptr)
 		handler.tag(type, value, ctx);
 }
 
+static inline void
+tag_handler_invoke_tag(const TagHandler &handler, void *ctx,
+		       TagType type, const char *value)
+{
+	assert(value != nullptr);
+
+	tag_handler_invoke_tag(handler, ctx, type, StringView(value));
+}
+
 static inline void
 tag_handler_invoke_pair(const TagHandler &handler, void *ctx,
 			const char *name, const char *value)
@@ -95,4 +109,19 @@ extern const TagHandler add_tag_handler;
  */
 extern const TagHandler full_tag_handler;
 
+/**
+ * The context object for #full_replay_gain_tag_handler.
+ */
+struct TagReplayGainContext {
+	TagBuilder &builder;
+	ReplayGainInfo &rgi;
+};
+
+/**
+ * Like #full_tag_handler, but additionally parses replay gain values
+ * from the name-value pairs into a #ReplayGainInfo.  The context
+ * pointer must point to a #TagReplayGainContext.
+ */
+extern const TagHandler full_replay_gain_tag_handler;
+
 #endif
@@ -23,6 +23,7 @@
 #include "Riff.hxx"
 #include "Aiff.hxx"
 #include "input/InputStream.hxx"
+#include "util/ReusableArray.hxx"
 
 #include <id3tag.h>
 
@@ -30,6 +31,35 @@
 
 static constexpr size_t ID3V1_SIZE = 128;
 
+/**
+ * Don't let the reusable tag buffer keep more than this amount of
+ * memory between files.
+ */
+static constexpr size_t MAX_KEEP_TAG_BUFFER = 1024 * 1024;
+
+/**
+ * A per-thread buffer for loading ID3 tags.  libid3tag needs the
+ * whole tag contiguously in memory, and tags with embedded artwork
+ * are often several megabytes; reusing the buffer avoids one large
+ * allocation per file while scanning.
+ */
+static thread_local ReusableArray<id3_byte_t, 4096> tag_buffer;
+
+static id3_byte_t *
+GetTagBuffer(size_t size)
+{
+	return tag_buffer.Get(size);
+}
+
+static void
+ReleaseTagBuffer() noexcept
+{
+	if (tag_buffer.GetCapacity() > MAX_KEEP_TAG_BUFFER)
+		/* don't let a pathologically large tag pin that much
+		   memory for the rest of the thread's life */
+		tag_buffer.Clear();
+}
+
 gcc_pure
 static inline bool
 tag_is_id3v1(struct id3_tag *tag) noexcept
@@ -59,24 +89,27 @@ try {
 	long tag_size = id3_tag_query(query_buffer, sizeof(query_buffer));
 	if (tag_size <= 0) return nullptr;
 
-	/* Found a tag.  Allocate a buffer and read it in. */
+	/* Found a tag.  Obtain a buffer and read it in. */
 	if (size_t(tag_size) <= sizeof(query_buffer))
 		/* we have enough data already */
 		return UniqueId3Tag(id3_tag_parse(query_buffer, tag_size));
 
-	std::unique_ptr<id3_byte_t[]> tag_buffer(new id3_byte_t[tag_size]);
+	id3_byte_t *tag_data = GetTagBuffer(tag_size);
 
-	/* copy the start of the tag we already have to the allocated
+	/* copy the start of the tag we already have to the reused
 	   buffer */
 	id3_byte_t *end = std::copy_n(query_buffer, sizeof(query_buffer),
-				      tag_buffer.get());
+				      tag_data);
 
 	/* now read the remaining bytes */
 	const size_t remaining = tag_size - sizeof(query_buffer);
 	is.ReadFull(end, remaining);
 
-	return UniqueId3Tag(id3_tag_parse(tag_buffer.get(), tag_size));
+	UniqueId3Tag tag(id3_tag_parse(tag_data, tag_size));
+	ReleaseTagBuffer();
+	return tag;
 } catch (...) {
+	ReleaseTagBuffer();
 	return nullptr;
 }
 
@@ -198,11 +231,14 @@ try {
 		/* too large, don't allocate so much memory */
 		return nullptr;
 
-	std::unique_ptr<id3_byte_t[]> buffer(new id3_byte_t[size]);
-	is.ReadFull(buffer.get(), size);
+	id3_byte_t *buffer = GetTagBuffer(size);
+	is.ReadFull(buffer, size);
 
-	return UniqueId3Tag(id3_tag_parse(buffer.get(), size));
+	UniqueId3Tag tag(id3_tag_parse(buffer, size));
+	ReleaseTagBuffer();
+	return tag;
 } catch (...) {
+	ReleaseTagBuffer();
 	return nullptr;
 }
 
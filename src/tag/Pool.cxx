@@ -20,23 +20,53 @@
 #include "config.h"
 #include "Pool.hxx"
 #include "Item.hxx"
+#include "lib/icu/CaseFold.hxx"
+#include "thread/Mutex.hxx"
+#include "util/AllocatedString.hxx"
 #include "util/Cast.hxx"
 #include "util/VarSize.hxx"
 #include "util/StringView.hxx"
 
+#include <atomic>
 #include <limits>
+#include <mutex>
 
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
 
-Mutex tag_pool_lock;
+static constexpr size_t NUM_SLOTS = 65521;
 
-static constexpr size_t NUM_SLOTS = 4093;
+/**
+ * The number of mutexes protecting the hash table.  Must be a
+ * divisor-friendly fraction of #NUM_SLOTS accesses; each mutex covers
+ * every NUM_SHARDS'th slot chain.
+ */
+static constexpr size_t NUM_SHARDS = 64;
+
+static Mutex tag_pool_mutexes[NUM_SHARDS];
+
+static inline Mutex &
+tag_pool_bucket_mutex(size_t bucket)
+{
+	return tag_pool_mutexes[bucket % NUM_SHARDS];
+}
 
 struct TagPoolSlot {
 	TagPoolSlot *next;
 	unsigned char ref;
+
+#ifdef HAVE_ICU_CASE_FOLD
+	/**
+	 * The case-folded variant of the value, computed lazily by
+	 * tag_pool_get_folded() and kept until the slot is freed.
+	 * Atomic because concurrent readers (e.g. a parallel database
+	 * walk) may fold the same value at the same time.
+	 */
+	std::atomic<char *> folded{nullptr};
+#endif
+
+	/* must be the last attribute (variable size) */
 	TagItem item;
 
 	static constexpr unsigned MAX_REF = std::numeric_limits<decltype(ref)>::max();
@@ -49,6 +79,12 @@ struct TagPoolSlot {
 		item.value[value.size] = 0;
 	}
 
+#ifdef HAVE_ICU_CASE_FOLD
+	~TagPoolSlot() noexcept {
+		delete[] folded.load(std::memory_order_relaxed);
+	}
+#endif
+
 	static TagPoolSlot *Create(TagPoolSlot *_next, TagType type,
 				   StringView value);
 };
@@ -58,6 +94,9 @@ TagPoolSlot::Create(TagPoolSlot *_next, TagType type,
 		    StringView value)
 {
 	TagPoolSlot *dummy;
+	heap_profile_record(HeapTag::TAG_POOL,
+			    sizeof(TagPoolSlot) - sizeof(dummy->item.value) +
+			    value.size + 1);
 	return NewVarSize<TagPoolSlot>(sizeof(dummy->item.value),
 				       value.size + 1,
 				       _next, type,
@@ -66,6 +105,21 @@ TagPoolSlot::Create(TagPoolSlot *_next, TagType type,
 
 static TagPoolSlot *slots[NUM_SLOTS];
 
+/* occupancy counters for the "memstats" command; relaxed atomics
+   because they are only telemetry and exact snapshots are not
+   needed */
+static std::atomic<size_t> tag_pool_n_slots;
+static std::atomic<size_t> tag_pool_n_bytes;
+
+TagPoolStats
+tag_pool_get_stats() noexcept
+{
+	return {
+		tag_pool_n_slots.load(std::memory_order_relaxed),
+		tag_pool_n_bytes.load(std::memory_order_relaxed),
+	};
+}
+
 static inline unsigned
 calc_hash(TagType type, StringView p)
 {
@@ -96,22 +150,25 @@ tag_item_to_slot(TagItem *item)
 	return &ContainerCast(*item, &TagPoolSlot::item);
 }
 
-static inline TagPoolSlot **
-tag_value_slot_p(TagType type, StringView value)
+static inline size_t
+tag_value_bucket(TagType type, StringView value)
 {
-	return &slots[calc_hash(type, value) % NUM_SLOTS];
+	return calc_hash(type, value) % NUM_SLOTS;
 }
 
-static inline TagPoolSlot **
-tag_value_slot_p(TagType type, const char *value)
+static inline size_t
+tag_value_bucket(TagType type, const char *value)
 {
-	return &slots[calc_hash(type, value) % NUM_SLOTS];
+	return calc_hash(type, value) % NUM_SLOTS;
 }
 
-TagItem *
-tag_pool_get_item(TagType type, StringView value)
+/**
+ * Caller must hold the bucket's mutex.
+ */
+static TagItem *
+tag_pool_get_item_locked(size_t bucket, TagType type, StringView value)
 {
-	auto slot_p = tag_value_slot_p(type, value);
+	const auto slot_p = &slots[bucket];
 	for (auto slot = *slot_p; slot != nullptr; slot = slot->next) {
 		if (slot->item.type == type &&
 		    value.Equals(slot->item.value) &&
@@ -124,12 +181,29 @@ tag_pool_get_item(TagType type, StringView value)
 
 	auto slot = TagPoolSlot::Create(*slot_p, type, value);
 	*slot_p = slot;
+
+	tag_pool_n_slots.fetch_add(1, std::memory_order_relaxed);
+	tag_pool_n_bytes.fetch_add(sizeof(*slot) + value.size,
+				   std::memory_order_relaxed);
+
 	return &slot->item;
 }
 
+TagItem *
+tag_pool_get_item(TagType type, StringView value)
+{
+	const size_t bucket = tag_value_bucket(type, value);
+	const std::lock_guard<Mutex> protect(tag_pool_bucket_mutex(bucket));
+
+	return tag_pool_get_item_locked(bucket, type, value);
+}
+
 TagItem *
 tag_pool_dup_item(TagItem *item)
 {
+	const size_t bucket = tag_value_bucket(item->type, item->value);
+	const std::lock_guard<Mutex> protect(tag_pool_bucket_mutex(bucket));
+
 	TagPoolSlot *slot = tag_item_to_slot(item);
 
 	assert(slot->ref > 0);
@@ -140,14 +214,19 @@ tag_pool_dup_item(TagItem *item)
 	} else {
 		/* the reference counter overflows above MAX_REF;
 		   obtain a reference to a different TagPoolSlot which
-		   isn't yet "full" */
-		return tag_pool_get_item(item->type, item->value);
+		   isn't yet "full"; the new slot lands in the same
+		   bucket, whose mutex is already held */
+		return tag_pool_get_item_locked(bucket, item->type,
+						item->value);
 	}
 }
 
 void
 tag_pool_put_item(TagItem *item)
 {
+	const size_t bucket = tag_value_bucket(item->type, item->value);
+	const std::lock_guard<Mutex> protect(tag_pool_bucket_mutex(bucket));
+
 	TagPoolSlot **slot_p, *slot;
 
 	slot = tag_item_to_slot(item);
@@ -157,12 +236,43 @@ tag_pool_put_item(TagItem *item)
 	if (slot->ref > 0)
 		return;
 
-	for (slot_p = tag_value_slot_p(item->type, item->value);
+	for (slot_p = &slots[bucket];
 	     *slot_p != slot;
 	     slot_p = &(*slot_p)->next) {
 		assert(*slot_p != nullptr);
 	}
 
 	*slot_p = slot->next;
+
+	tag_pool_n_slots.fetch_sub(1, std::memory_order_relaxed);
+	tag_pool_n_bytes.fetch_sub(sizeof(*slot) + strlen(slot->item.value),
+				   std::memory_order_relaxed);
+
 	DeleteVarSize(slot);
 }
+
+const char *
+tag_pool_get_folded(const TagItem &item) noexcept
+{
+#ifdef HAVE_ICU_CASE_FOLD
+	auto &slot = *tag_item_to_slot(const_cast<TagItem *>(&item));
+
+	char *folded = slot.folded.load(std::memory_order_acquire);
+	if (folded == nullptr) {
+		folded = IcuCaseFold(item.value).Steal();
+
+		char *expected = nullptr;
+		if (!slot.folded.compare_exchange_strong(expected, folded,
+							 std::memory_order_acq_rel)) {
+			/* lost the race against another thread which
+			   has folded the same value concurrently */
+			delete[] folded;
+			folded = expected;
+		}
+	}
+
+	return folded;
+#else
+	return item.value;
+#endif
+}
@@ -21,13 +21,27 @@
 #define MPD_TAG_POOL_HXX
 
 #include "Type.h"
-#include "thread/Mutex.hxx"
 
-extern Mutex tag_pool_lock;
+#include <stddef.h>
 
 struct TagItem;
 struct StringView;
 
+struct TagPoolStats {
+	/**
+	 * The number of slots (unique tag values) in the pool.
+	 */
+	size_t slots;
+
+	/**
+	 * The approximate number of bytes allocated by all slots.
+	 */
+	size_t bytes;
+};
+
+/* the following functions are thread-safe: the pool's hash table is
+   sharded, and each shard has its own lock */
+
 TagItem *
 tag_pool_get_item(TagType type, StringView value);
 
@@ -37,4 +51,20 @@ tag_pool_dup_item(TagItem *item);
 void
 tag_pool_put_item(TagItem *item);
 
+/**
+ * Returns the case-folded variant of the item's value, for
+ * case-insensitive matching.  It is computed on first use and cached
+ * in the pool for the lifetime of the item, so repeated queries need
+ * not fold the same string again.  In builds without ICU (or another
+ * case folding backend), the value is returned unchanged.
+ */
+const char *
+tag_pool_get_folded(const TagItem &item) noexcept;
+
+/**
+ * Returns the current pool occupancy, for memory telemetry.
+ */
+TagPoolStats
+tag_pool_get_stats() noexcept;
+
 #endif
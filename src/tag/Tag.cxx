@@ -30,10 +30,8 @@ Tag::Clear() noexcept
 	duration = SignedSongTime::Negative();
 	has_playlist = false;
 
-	tag_pool_lock.lock();
 	for (unsigned i = 0; i < num_items; ++i)
 		tag_pool_put_item(items[i]);
-	tag_pool_lock.unlock();
 
 	delete[] items;
 	items = nullptr;
@@ -48,11 +46,9 @@ Tag::Tag(const Tag &other)
 	if (num_items > 0) {
 		items = new TagItem *[num_items];
 
-		tag_pool_lock.lock();
-		for (unsigned i = 0; i < num_items; i++)
+			for (unsigned i = 0; i < num_items; i++)
 			items[i] = tag_pool_dup_item(other.items[i]);
-		tag_pool_lock.unlock();
-	}
+		}
 }
 
 std::unique_ptr<Tag>
@@ -157,3 +153,27 @@ Tag::GetSortValue(TagType type) const noexcept
 
 	return "";
 }
+
+TagMask
+Tag::GetSortValueMask(TagType type) noexcept
+{
+	/* mirrors the lookup order of GetSortValue() */
+
+	auto mask = TagMask(type);
+
+	const auto no_sort_type = DecaySort(type);
+	if (no_sort_type != TAG_NUM_OF_ITEM_TYPES)
+		mask |= no_sort_type;
+
+	auto fallback = Fallback(type);
+	if (fallback != TAG_NUM_OF_ITEM_TYPES)
+		mask |= GetSortValueMask(fallback);
+
+	if (no_sort_type != TAG_NUM_OF_ITEM_TYPES) {
+		fallback = Fallback(no_sort_type);
+		if (fallback != TAG_NUM_OF_ITEM_TYPES)
+			mask |= GetSortValueMask(fallback);
+	}
+
+	return mask;
+}
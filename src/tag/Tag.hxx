@@ -22,6 +22,7 @@
 
 #include "Type.h" // IWYU pragma: export
 #include "Item.hxx" // IWYU pragma: export
+#include "Mask.hxx"
 #include "Chrono.hxx"
 #include "Compiler.h"
 
@@ -152,6 +153,13 @@ struct Tag {
 	gcc_pure gcc_returns_nonnull
 	const char *GetSortValue(TagType type) const noexcept;
 
+	/**
+	 * The set of tag types which GetSortValue() may consult for
+	 * the given type, i.e. the type itself and all its fallbacks.
+	 */
+	gcc_const
+	static TagMask GetSortValueMask(TagType type) noexcept;
+
 	class const_iterator {
 		friend struct Tag;
 		const TagItem *const*cursor;
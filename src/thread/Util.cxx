@@ -77,18 +77,42 @@ SetThreadIdlePriority() noexcept
 };
 
 void
-SetThreadRealtime()
+SetThreadRealtime(unsigned priority, bool round_robin)
 {
 #ifdef __linux__
 	struct sched_param sched_param;
-	sched_param.sched_priority = 50;
+	sched_param.sched_priority = priority;
 
-	int policy = SCHED_FIFO;
+	int policy = round_robin ? SCHED_RR : SCHED_FIFO;
 #ifdef SCHED_RESET_ON_FORK
 	policy |= SCHED_RESET_ON_FORK;
 #endif
 
 	if (sched_setscheduler(0, policy, &sched_param) < 0)
 		throw MakeErrno("sched_setscheduler failed");
+#else
+	(void)priority;
+	(void)round_robin;
 #endif	// __linux__
 };
+
+void
+SetThreadAffinity(uint64_t mask)
+{
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+
+	for (unsigned i = 0; i < 64; ++i)
+		if (mask & (uint64_t(1) << i))
+			CPU_SET(i, &set);
+
+	if (sched_setaffinity(0, sizeof(set), &set) < 0)
+		throw MakeErrno("sched_setaffinity failed");
+#elif defined(_WIN32)
+	if (SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(mask)) == 0)
+		throw MakeLastError("SetThreadAffinityMask failed");
+#else
+	(void)mask;
+#endif
+}
@@ -30,6 +30,8 @@
 #ifndef THREAD_UTIL_HXX
 #define THREAD_UTIL_HXX
 
+#include <stdint.h>
+
 /**
  * Lower the current thread's priority to "idle" (very low).
  */
@@ -39,9 +41,21 @@ SetThreadIdlePriority() noexcept;
 /**
  * Raise the current thread's priority to "real-time" (very high).
  *
+ * @param priority the static scheduling priority (1..99)
+ * @param round_robin use SCHED_RR instead of SCHED_FIFO
+ *
+ * Throws std::system_error on error.
+ */
+void
+SetThreadRealtime(unsigned priority, bool round_robin);
+
+/**
+ * Bind the current thread to the given set of CPUs; bit i of the mask
+ * stands for CPU i.
+ *
  * Throws std::system_error on error.
  */
 void
-SetThreadRealtime();
+SetThreadAffinity(uint64_t mask);
 
 #endif
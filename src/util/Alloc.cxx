@@ -20,6 +20,7 @@
 #include "config.h"
 #include "Alloc.hxx"
 #include "ConcatString.hxx"
+#include "HeapProfile.hxx"
 
 #include <stdlib.h>
 #include <string.h>
@@ -40,6 +41,7 @@ xalloc(size_t size)
 	if (gcc_unlikely(p == nullptr))
 		oom();
 
+	heap_profile_record(HeapTag::ALLOC, size);
 	return p;
 }
 
@@ -58,6 +60,7 @@ xstrdup(const char *s)
 	if (gcc_unlikely(p == nullptr))
 		oom();
 
+	heap_profile_record(HeapTag::ALLOC, strlen(p) + 1);
 	return p;
 }
 
@@ -68,6 +71,8 @@ xstrndup(const char *s, size_t n)
 	char *p = strndup(s, n);
 	if (gcc_unlikely(p == nullptr))
 		oom();
+
+	heap_profile_record(HeapTag::ALLOC, n + 1);
 #else
 	char *p = (char *)xalloc(n + 1);
 	memcpy(p, s, n);
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "AllocAudit.hxx"
+
+#ifdef ENABLE_ALLOC_AUDIT
+
+#include <atomic>
+
+#include <execinfo.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <unistd.h>
+
+extern "C" {
+/* the real glibc allocator entry points, so the interposed functions
+   below can forward to them */
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t nmemb, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+}
+
+/**
+ * Armed by alloc_audit_enable()?  Written once during startup,
+ * before the audited threads exist.
+ */
+static bool alloc_audit_enabled;
+
+/**
+ * The nesting depth of ScopeAllocForbidden on this thread; non-zero
+ * means allocations are forbidden.
+ */
+static thread_local unsigned alloc_forbid_depth;
+
+/**
+ * How many more violations may be logged, globally.  Keeps a
+ * regression which allocates on every chunk from flooding stderr.
+ */
+static std::atomic<unsigned> alloc_audit_log_budget{256};
+
+void
+alloc_audit_enable() noexcept
+{
+	alloc_audit_enabled = true;
+}
+
+void
+alloc_audit_forbid() noexcept
+{
+	++alloc_forbid_depth;
+}
+
+void
+alloc_audit_allow() noexcept
+{
+	--alloc_forbid_depth;
+}
+
+unsigned
+alloc_audit_suspend() noexcept
+{
+	const unsigned depth = alloc_forbid_depth;
+	alloc_forbid_depth = 0;
+	return depth;
+}
+
+void
+alloc_audit_resume(unsigned depth) noexcept
+{
+	alloc_forbid_depth = depth;
+}
+
+static void
+alloc_audit_check(const char *function, size_t size) noexcept
+{
+	if (!alloc_audit_enabled || alloc_forbid_depth == 0)
+		return;
+
+	unsigned budget = alloc_audit_log_budget.load(std::memory_order_relaxed);
+	do {
+		if (budget == 0)
+			return;
+	} while (!alloc_audit_log_budget.compare_exchange_weak(budget,
+							       budget - 1));
+
+	/* lift the forbidden state while logging, because
+	   backtrace() and the symbolizer allocate themselves */
+	const unsigned saved = alloc_audit_suspend();
+
+	char header[128];
+	int length = snprintf(header, sizeof(header),
+			      "alloc_audit: %s(%zu) from an "
+			      "allocation-forbidden thread:\n",
+			      function, size);
+	if (length > 0)
+		(void)write(STDERR_FILENO, header, length);
+
+	void *frames[32];
+	const int n = backtrace(frames, 32);
+	backtrace_symbols_fd(frames, n, STDERR_FILENO);
+
+	alloc_audit_resume(saved);
+}
+
+extern "C" void *
+malloc(size_t size)
+{
+	alloc_audit_check("malloc", size);
+	return __libc_malloc(size);
+}
+
+extern "C" void *
+calloc(size_t nmemb, size_t size)
+{
+	alloc_audit_check("calloc", nmemb * size);
+	return __libc_calloc(nmemb, size);
+}
+
+extern "C" void *
+realloc(void *ptr, size_t size)
+{
+	alloc_audit_check("realloc", size);
+	return __libc_realloc(ptr, size);
+}
+
+#endif /* ENABLE_ALLOC_AUDIT */
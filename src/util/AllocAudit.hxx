@@ -0,0 +1,141 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_ALLOC_AUDIT_HXX
+#define MPD_ALLOC_AUDIT_HXX
+
+#include "check.h"
+
+/* __GLIBC__ is only defined once a libc header has been included;
+   include one here so the feature test below gives the same answer in
+   every translation unit */
+#include <limits.h>
+
+/**
+ * The allocation audit ("allocation_audit" setting) marks the
+ * realtime code paths of the player, output and decoder threads as
+ * allocation-forbidden; any malloc() from such a scope logs a stack
+ * trace to stderr.  This keeps the allocation-elimination work on
+ * the chunk path, the filter buffers and the encoder pages from
+ * regressing silently.
+ *
+ * Like the poisoning in poison.h, this is debug-build tooling; it
+ * also needs glibc, whose __libc_malloc() makes interposing malloc()
+ * trivial.  In other configurations, everything here is a no-op.
+ */
+#if !defined(NDEBUG) && defined(__GLIBC__)
+#define ENABLE_ALLOC_AUDIT
+#endif
+
+#ifdef ENABLE_ALLOC_AUDIT
+
+/**
+ * Globally arm the audit.  To be called during startup, before the
+ * audited threads exist.
+ */
+void
+alloc_audit_enable() noexcept;
+
+/**
+ * Mark the calling thread allocation-forbidden.  May be nested.
+ */
+void
+alloc_audit_forbid() noexcept;
+
+void
+alloc_audit_allow() noexcept;
+
+/**
+ * Temporarily lift the calling thread's forbidden state, e.g. around
+ * a known and intentional allocation.  Returns the saved nesting
+ * depth, to be passed to alloc_audit_resume().
+ */
+unsigned
+alloc_audit_suspend() noexcept;
+
+void
+alloc_audit_resume(unsigned depth) noexcept;
+
+#else
+
+static inline void
+alloc_audit_enable() noexcept
+{
+}
+
+static inline void
+alloc_audit_forbid() noexcept
+{
+}
+
+static inline void
+alloc_audit_allow() noexcept
+{
+}
+
+static inline unsigned
+alloc_audit_suspend() noexcept
+{
+	return 0;
+}
+
+static inline void
+alloc_audit_resume(unsigned) noexcept
+{
+}
+
+#endif
+
+/**
+ * RAII: the calling thread is allocation-forbidden while this object
+ * lives.
+ */
+class ScopeAllocForbidden {
+public:
+	ScopeAllocForbidden() noexcept {
+		alloc_audit_forbid();
+	}
+
+	~ScopeAllocForbidden() noexcept {
+		alloc_audit_allow();
+	}
+
+	ScopeAllocForbidden(const ScopeAllocForbidden &) = delete;
+	ScopeAllocForbidden &operator=(const ScopeAllocForbidden &) = delete;
+};
+
+/**
+ * RAII: lift the forbidden state around an intentional allocation.
+ */
+class ScopeAllocAllowed {
+	const unsigned saved_depth;
+
+public:
+	ScopeAllocAllowed() noexcept
+		:saved_depth(alloc_audit_suspend()) {}
+
+	~ScopeAllocAllowed() noexcept {
+		alloc_audit_resume(saved_depth);
+	}
+
+	ScopeAllocAllowed(const ScopeAllocAllowed &) = delete;
+	ScopeAllocAllowed &operator=(const ScopeAllocAllowed &) = delete;
+};
+
+#endif
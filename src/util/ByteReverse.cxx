@@ -21,6 +21,15 @@
 #include "system/ByteOrder.hxx"
 #include "Compiler.h"
 
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+#endif
+
 #include <assert.h>
 
 void
@@ -32,6 +41,19 @@ reverse_bytes_16(uint16_t *gcc_restrict dest,
 	assert(src != nullptr);
 	assert(src_end >= src);
 
+#ifdef __ARM_NEON__
+	for (; src_end - src >= 8; src += 8, dest += 8)
+		vst1q_u8((uint8_t *)dest,
+			 vrev16q_u8(vld1q_u8((const uint8_t *)src)));
+#elif defined(__SSE2__)
+	for (; src_end - src >= 8; src += 8, dest += 8) {
+		__m128i x = _mm_loadu_si128((const __m128i *)src);
+		x = _mm_or_si128(_mm_slli_epi16(x, 8),
+				 _mm_srli_epi16(x, 8));
+		_mm_storeu_si128((__m128i *)dest, x);
+	}
+#endif
+
 	while (src < src_end) {
 		const uint16_t x = *src++;
 		*dest++ = ByteSwap16(x);
@@ -47,6 +69,28 @@ reverse_bytes_32(uint32_t *gcc_restrict dest,
 	assert(src != nullptr);
 	assert(src_end >= src);
 
+#ifdef __ARM_NEON__
+	for (; src_end - src >= 4; src += 4, dest += 4)
+		vst1q_u8((uint8_t *)dest,
+			 vrev32q_u8(vld1q_u8((const uint8_t *)src)));
+#elif defined(__SSSE3__)
+	const __m128i mask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11,
+					  4, 5, 6, 7, 0, 1, 2, 3);
+	for (; src_end - src >= 4; src += 4, dest += 4)
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)src),
+						  mask));
+#elif defined(__SSE2__)
+	for (; src_end - src >= 4; src += 4, dest += 4) {
+		__m128i x = _mm_loadu_si128((const __m128i *)src);
+		x = _mm_or_si128(_mm_slli_epi16(x, 8),
+				 _mm_srli_epi16(x, 8));
+		x = _mm_or_si128(_mm_slli_epi32(x, 16),
+				 _mm_srli_epi32(x, 16));
+		_mm_storeu_si128((__m128i *)dest, x);
+	}
+#endif
+
 	while (src < src_end) {
 		const uint32_t x = *src++;
 		*dest++ = ByteSwap32(x);
@@ -62,6 +106,28 @@ reverse_bytes_64(uint64_t *gcc_restrict dest,
 	assert(src != nullptr);
 	assert(src_end >= src);
 
+#ifdef __ARM_NEON__
+	for (; src_end - src >= 2; src += 2, dest += 2)
+		vst1q_u8((uint8_t *)dest,
+			 vrev64q_u8(vld1q_u8((const uint8_t *)src)));
+#elif defined(__SSSE3__)
+	const __m128i mask = _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15,
+					  0, 1, 2, 3, 4, 5, 6, 7);
+	for (; src_end - src >= 2; src += 2, dest += 2)
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)src),
+						  mask));
+#elif defined(__SSE2__)
+	for (; src_end - src >= 2; src += 2, dest += 2) {
+		__m128i x = _mm_loadu_si128((const __m128i *)src);
+		x = _mm_or_si128(_mm_slli_epi16(x, 8),
+				 _mm_srli_epi16(x, 8));
+		x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+		x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+		_mm_storeu_si128((__m128i *)dest, x);
+	}
+#endif
+
 	while (src < src_end) {
 		const uint64_t x = *src++;
 		*dest++ = ByteSwap64(x);
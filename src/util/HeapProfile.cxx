@@ -0,0 +1,75 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "HeapProfile.hxx"
+
+#include <assert.h>
+
+static constexpr const char *heap_tag_names[] = {
+	"alloc",
+	"varsize",
+	"tag_pool",
+	"pcm_buffer",
+};
+
+static_assert(sizeof(heap_tag_names) / sizeof(heap_tag_names[0]) ==
+	      unsigned(HeapTag::COUNT),
+	      "Wrong heap_tag_names size");
+
+const char *
+heap_tag_name(HeapTag tag) noexcept
+{
+	assert(unsigned(tag) < unsigned(HeapTag::COUNT));
+
+	return heap_tag_names[unsigned(tag)];
+}
+
+#ifdef ENABLE_HEAP_PROFILE
+
+#include <atomic>
+
+struct HeapProfileSlot {
+	std::atomic<uint64_t> count{0};
+	std::atomic<uint64_t> bytes{0};
+};
+
+static HeapProfileSlot heap_profile_slots[unsigned(HeapTag::COUNT)];
+
+void
+heap_profile_record(HeapTag tag, size_t size) noexcept
+{
+	assert(unsigned(tag) < unsigned(HeapTag::COUNT));
+
+	auto &slot = heap_profile_slots[unsigned(tag)];
+	slot.count.fetch_add(1, std::memory_order_relaxed);
+	slot.bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+HeapProfileCounters
+heap_profile_get(HeapTag tag) noexcept
+{
+	assert(unsigned(tag) < unsigned(HeapTag::COUNT));
+
+	const auto &slot = heap_profile_slots[unsigned(tag)];
+	return {slot.count.load(std::memory_order_relaxed),
+		slot.bytes.load(std::memory_order_relaxed)};
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_HEAP_PROFILE_HXX
+#define MPD_HEAP_PROFILE_HXX
+
+#include "check.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Call site categories for the first-party heap profiler
+ * (--enable-heap-profile).  Generic heap profilers cannot attribute
+ * variable-size songs vs. tag pool slots vs. PCM buffers; these
+ * counters can.  Note that the categories overlap: #VARSIZE and
+ * #TAG_POOL allocations go through xalloc() and are therefore also
+ * counted in #ALLOC.
+ */
+enum class HeapTag : unsigned {
+	/** all xalloc()/xstrdup() traffic (util/Alloc.cxx) */
+	ALLOC,
+
+	/** variable-size objects (util/VarSize.hxx), e.g. songs and
+	    directories */
+	VARSIZE,
+
+	/** tag string pool slots (tag/Pool.cxx) */
+	TAG_POOL,
+
+	/** PCM work buffer growth (pcm/PcmBuffer.cxx); counted only
+	    when a buffer actually grows, not on every Get() */
+	PCM_BUFFER,
+
+	COUNT
+};
+
+/**
+ * The name of a category, for building "memstats" keys.
+ */
+const char *
+heap_tag_name(HeapTag tag) noexcept;
+
+/**
+ * A snapshot of one category's counters: the number of allocations
+ * and the cumulative number of bytes since startup.
+ */
+struct HeapProfileCounters {
+	uint64_t count;
+	uint64_t bytes;
+};
+
+#ifdef ENABLE_HEAP_PROFILE
+
+/**
+ * Account one allocation.  Thread-safe (relaxed atomics).
+ */
+void
+heap_profile_record(HeapTag tag, size_t size) noexcept;
+
+HeapProfileCounters
+heap_profile_get(HeapTag tag) noexcept;
+
+#else
+
+/* no-ops, so call sites need not be wrapped in #ifdef */
+
+static inline void
+heap_profile_record(HeapTag, size_t) noexcept
+{
+}
+
+static inline HeapProfileCounters
+heap_profile_get(HeapTag) noexcept
+{
+	return {0, 0};
+}
+
+#endif
+
+#endif
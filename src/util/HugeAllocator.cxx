@@ -33,7 +33,10 @@
 
 #ifdef __linux__
 #include <sys/mman.h>
+#include <sys/syscall.h>
 #include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
 #else
 #include <stdlib.h>
 #endif
@@ -99,6 +102,85 @@ HugeDiscard(void *p, size_t size) noexcept
 #endif
 }
 
+#ifdef __NR_mbind
+
+/**
+ * Build a bit mask of all online NUMA nodes from sysfs.  The file
+ * contains a range list such as "0" or "0-1,4".
+ */
+gcc_pure
+static unsigned long
+OnlineNumaNodeMask() noexcept
+{
+	/* node 0 always exists */
+	unsigned long mask = 1;
+
+	FILE *file = fopen("/sys/devices/system/node/online", "r");
+	if (file == nullptr)
+		return mask;
+
+	char line[64];
+	if (fgets(line, sizeof(line), file) != nullptr) {
+		char *p = line;
+		while (*p != 0) {
+			char *endptr;
+			unsigned long first = strtoul(p, &endptr, 10);
+			unsigned long last = first;
+			if (endptr == p)
+				break;
+
+			p = endptr;
+			if (*p == '-') {
+				last = strtoul(p + 1, &endptr, 10);
+				if (endptr == p + 1)
+					break;
+				p = endptr;
+			}
+
+			for (unsigned long i = first;
+			     i <= last && i < sizeof(mask) * 8; ++i)
+				mask |= 1UL << i;
+
+			if (*p != ',')
+				break;
+			++p;
+		}
+	}
+
+	fclose(file);
+	return mask;
+}
+
+#endif
+
+void
+HugeNumaInterleave(void *p, size_t size) noexcept
+{
+#ifdef __NR_mbind
+	/* from <linux/mempolicy.h>, which glibc does not wrap */
+	constexpr int MPOL_INTERLEAVE = 3;
+
+	const unsigned long nodemask = OnlineNumaNodeMask();
+	if (nodemask == 1)
+		/* just one node, nothing to interleave */
+		return;
+
+	syscall(__NR_mbind, p, AlignToPageSize(size),
+		MPOL_INTERLEAVE,
+		&nodemask, sizeof(nodemask) * 8 + 1,
+		0);
+#else
+	(void)p;
+	(void)size;
+#endif
+}
+
+void
+HugeLock(void *p, size_t size) noexcept
+{
+	mlock(p, AlignToPageSize(size));
+}
+
 #elif defined(_WIN32)
 
 WritableBuffer<void>
@@ -78,6 +78,24 @@ HugeForkCow(void *p, size_t size, bool enable) noexcept;
 void
 HugeDiscard(void *p, size_t size) noexcept;
 
+/**
+ * Ask the kernel to interleave the allocation's physical pages over
+ * all online NUMA nodes, so no single node has to serve all the
+ * memory traffic.  Best effort: errors are ignored.
+ *
+ * Must be called before the pages are first touched.
+ */
+void
+HugeNumaInterleave(void *p, size_t size) noexcept;
+
+/**
+ * Lock the allocation into physical memory, so it can never be
+ * swapped out.  This faults in all pages.  Best effort: errors
+ * (e.g. RLIMIT_MEMLOCK) are ignored.
+ */
+void
+HugeLock(void *p, size_t size) noexcept;
+
 #elif defined(_WIN32)
 #include <windows.h>
 
@@ -101,6 +119,16 @@ HugeDiscard(void *p, size_t size) noexcept
 	VirtualAlloc(p, size, MEM_RESET, PAGE_NOACCESS);
 }
 
+static inline void
+HugeNumaInterleave(void *, size_t) noexcept
+{
+}
+
+static inline void
+HugeLock(void *, size_t) noexcept
+{
+}
+
 #else
 
 /* not Linux: fall back to standard C calls */
@@ -130,6 +158,16 @@ HugeDiscard(void *, size_t) noexcept
 {
 }
 
+static inline void
+HugeNumaInterleave(void *, size_t) noexcept
+{
+}
+
+static inline void
+HugeLock(void *, size_t) noexcept
+{
+}
+
 #endif
 
 /**
@@ -178,6 +216,16 @@ public:
 		HugeDiscard(v.data, v.size);
 	}
 
+	void NumaInterleave() noexcept {
+		auto v = buffer.ToVoid();
+		HugeNumaInterleave(v.data, v.size);
+	}
+
+	void Lock() noexcept {
+		auto v = buffer.ToVoid();
+		HugeLock(v.data, v.size);
+	}
+
 	constexpr bool operator==(std::nullptr_t) const {
 		return buffer == nullptr;
 	}
@@ -21,10 +21,79 @@
 #include "DynamicFifoBuffer.hxx"
 
 #include <algorithm>
+#include <utility>
 
 #include <assert.h>
 #include <string.h>
 
+/* each thread running an #EventLoop keeps a few drained peak buffers
+   for reuse; all sockets served by the same loop take turns with
+   them, which makes burst absorption allocation-free in steady state
+   while bounding the lingering memory per thread.  Being thread-local
+   makes the pool thread-safe without locking.  A buffer is reused
+   only on an exact capacity match: the peak capacity doubles as a
+   configured limit (e.g. client_max_output_buffer_size), so rounding
+   it up to a size class would silently raise that limit. */
+static constexpr unsigned SPARE_PEAK_BUFFERS = 4;
+
+static thread_local struct SparePeakBuffers {
+	DynamicFifoBuffer<uint8_t> *slots[SPARE_PEAK_BUFFERS] = {};
+
+	~SparePeakBuffers() noexcept {
+		Discard();
+	}
+
+	void Discard() noexcept {
+		for (auto &i : slots) {
+			delete i;
+			i = nullptr;
+		}
+	}
+
+	DynamicFifoBuffer<uint8_t> *Get(size_t capacity) noexcept {
+		for (auto &i : slots)
+			if (i != nullptr && i->GetCapacity() == capacity)
+				return std::exchange(i, nullptr);
+
+		return nullptr;
+	}
+
+	bool Put(DynamicFifoBuffer<uint8_t> *buffer) noexcept {
+		for (auto &i : slots)
+			if (i == nullptr) {
+				i = buffer;
+				return true;
+			}
+
+		return false;
+	}
+} spare_peak_buffers;
+
+static DynamicFifoBuffer<uint8_t> *
+AllocatePeakBuffer(size_t capacity)
+{
+	auto *buffer = spare_peak_buffers.Get(capacity);
+	if (buffer != nullptr)
+		return buffer;
+
+	return new DynamicFifoBuffer<uint8_t>(capacity);
+}
+
+static void
+ReturnPeakBuffer(DynamicFifoBuffer<uint8_t> *buffer) noexcept
+{
+	assert(buffer->empty());
+
+	if (!spare_peak_buffers.Put(buffer))
+		delete buffer;
+}
+
+void
+PeakBuffer::DiscardSpare() noexcept
+{
+	spare_peak_buffers.Discard();
+}
+
 PeakBuffer::~PeakBuffer()
 {
 	delete normal_buffer;
@@ -38,6 +107,20 @@ PeakBuffer::empty() const noexcept
 		(peak_buffer == nullptr || peak_buffer->empty());
 }
 
+size_t
+PeakBuffer::GetSize() const noexcept
+{
+	size_t size = 0;
+
+	if (normal_buffer != nullptr)
+		size += normal_buffer->GetAvailable();
+
+	if (peak_buffer != nullptr)
+		size += peak_buffer->GetAvailable();
+
+	return size;
+}
+
 WritableBuffer<void>
 PeakBuffer::Read() const noexcept
 {
@@ -56,6 +139,26 @@ PeakBuffer::Read() const noexcept
 	return nullptr;
 }
 
+unsigned
+PeakBuffer::Read2(WritableBuffer<void> v[]) const noexcept
+{
+	unsigned n = 0;
+
+	if (normal_buffer != nullptr) {
+		const auto p = normal_buffer->Read();
+		if (!p.empty())
+			v[n++] = p.ToVoid();
+	}
+
+	if (peak_buffer != nullptr) {
+		const auto p = peak_buffer->Read();
+		if (!p.empty())
+			v[n++] = p.ToVoid();
+	}
+
+	return n;
+}
+
 void
 PeakBuffer::Consume(size_t length) noexcept
 {
@@ -67,7 +170,7 @@ PeakBuffer::Consume(size_t length) noexcept
 	if (peak_buffer != nullptr && !peak_buffer->empty()) {
 		peak_buffer->Consume(length);
 		if (peak_buffer->empty()) {
-			delete peak_buffer;
+			ReturnPeakBuffer(peak_buffer);
 			peak_buffer = nullptr;
 		}
 
@@ -125,7 +228,7 @@ PeakBuffer::Append(const void *data, size_t length)
 
 	if (peak_buffer == nullptr) {
 		if (peak_size > 0)
-			peak_buffer = new DynamicFifoBuffer<uint8_t>(peak_size);
+			peak_buffer = AllocatePeakBuffer(peak_size);
 		if (peak_buffer == nullptr)
 			return false;
 	}
@@ -59,12 +59,37 @@ public:
 	gcc_pure
 	bool empty() const noexcept;
 
+	/**
+	 * How many bytes are stored currently?
+	 */
+	gcc_pure
+	size_t GetSize() const noexcept;
+
 	gcc_pure
 	WritableBuffer<void> Read() const noexcept;
 
+	/**
+	 * Returns all readable segments (at most one per internal
+	 * buffer), for scatter-gather I/O.
+	 *
+	 * @param v an array of at least two elements
+	 * @return the number of segments filled in
+	 */
+	unsigned Read2(WritableBuffer<void> v[]) const noexcept;
+
 	void Consume(size_t length) noexcept;
 
 	bool Append(const void *data, size_t length);
+
+	/**
+	 * Free the calling thread's spare buffers.  When a peak
+	 * buffer has been consumed completely, it is kept in a small
+	 * per-thread pool to be reused by the next peak, instead of
+	 * going through the allocator for every large response; this
+	 * method gives that memory back to the kernel, e.g. when the
+	 * connections being served have gone idle.
+	 */
+	static void DiscardSpare() noexcept;
 };
 
 #endif
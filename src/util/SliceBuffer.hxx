@@ -23,20 +23,30 @@
 #include "HugeAllocator.hxx"
 #include "Compiler.h"
 
+#include <atomic>
 #include <utility>
 #include <new>
 
 #include <assert.h>
+#include <stdint.h>
 #include <stddef.h>
 
 /**
  * This class pre-allocates a certain number of objects, and allows
  * callers to allocate and free these objects ("slices").
+ *
+ * This class is thread-safe: Allocate() and Free() are lock-free and
+ * may be called concurrently from any thread.
  */
 template<typename T>
 class SliceBuffer {
 	union Slice {
-		Slice *next;
+		/**
+		 * The index (plus one) of the next slice in the free
+		 * list; zero terminates the list.  Only valid while
+		 * the slice is free.
+		 */
+		uint32_t next;
 
 		T value;
 	};
@@ -48,17 +58,20 @@ class SliceBuffer {
 	 * avoid page faulting on the new allocation, so the kernel
 	 * does not need to reserve physical memory pages.
 	 */
-	unsigned n_initialized = 0;
+	std::atomic<unsigned> n_initialized{0};
 
 	/**
 	 * The number of slices currently allocated.
 	 */
-	unsigned n_allocated = 0;
+	std::atomic<unsigned> n_allocated{0};
 
 	/**
-	 * Pointer to the first free element in the chain.
+	 * The head of the free list: the lower 32 bits are the index
+	 * (plus one) of the first free slice (zero if the list is
+	 * empty), and the upper 32 bits are a version counter which
+	 * protects the compare-and-swap against the "ABA" problem.
 	 */
-	Slice *available = nullptr;
+	std::atomic<uint64_t> available{0};
 
 public:
 	SliceBuffer(unsigned _count)
@@ -69,53 +82,84 @@ public:
 	~SliceBuffer() noexcept {
 		/* all slices must be freed explicitly, and this
 		   assertion checks for leaks */
-		assert(n_allocated == 0);
+		assert(n_allocated.load() == 0);
 	}
 
 	SliceBuffer(const SliceBuffer &other) = delete;
 	SliceBuffer &operator=(const SliceBuffer &other) = delete;
 
+	/**
+	 * Spread the buffer's pages over all NUMA nodes.  Must be
+	 * called before the first Allocate() call.
+	 */
+	void NumaInterleave() noexcept {
+		buffer.NumaInterleave();
+	}
+
+	/**
+	 * Lock the buffer into physical memory.  Call after
+	 * NumaInterleave(), because locking faults in all pages.
+	 */
+	void Lock() noexcept {
+		buffer.Lock();
+	}
+
 	unsigned GetCapacity() const noexcept {
 		return buffer.size();
 	}
 
 	bool empty() const noexcept {
-		return n_allocated == 0;
+		return n_allocated.load(std::memory_order_relaxed) == 0;
 	}
 
 	bool IsFull() const noexcept {
-		return n_allocated == buffer.size();
+		return n_allocated.load(std::memory_order_relaxed) == buffer.size();
 	}
 
-	template<typename... Args>
-	T *Allocate(Args&&... args) {
-		assert(n_initialized <= buffer.size());
-		assert(n_allocated <= n_initialized);
+	/**
+	 * Returns the number of slices which are currently free.  The
+	 * value may be stale already when this method returns.
+	 */
+	unsigned GetFreeCount() const noexcept {
+		return buffer.size() - n_allocated.load(std::memory_order_relaxed);
+	}
 
-		if (available == nullptr) {
-			if (n_initialized == buffer.size()) {
-				/* out of (internal) memory, buffer is full */
-				assert(n_allocated == buffer.size());
-				return nullptr;
-			}
+	/**
+	 * Returns the index of the given object within the buffer.
+	 */
+	unsigned IndexOf(const T &value) const noexcept {
+		const Slice *slice = reinterpret_cast<const Slice *>(&value);
+		assert(slice >= &buffer.front() && slice <= &buffer.back());
+
+		return slice - &buffer.front();
+	}
 
-			available = &buffer[n_initialized++];
-			available->next = nullptr;
+	template<typename... Args>
+	T *Allocate(Args&&... args) {
+		Slice *slice = PopAvailable();
+		if (slice == nullptr) {
+			/* the free list is empty: initialize another
+			   slice */
+			unsigned i = n_initialized.load(std::memory_order_relaxed);
+			do {
+				if (i == buffer.size())
+					/* out of (internal) memory,
+					   buffer is full */
+					return nullptr;
+			} while (!n_initialized.compare_exchange_weak(i, i + 1,
+								      std::memory_order_relaxed));
+
+			slice = &buffer[i];
 		}
 
-		/* allocate a slice */
-		T *value = &available->value;
-		available = available->next;
-		++n_allocated;
+		n_allocated.fetch_add(1, std::memory_order_relaxed);
 
 		/* construct the object */
-		return ::new((void *)value) T(std::forward<Args>(args)...);
+		return ::new((void *)&slice->value) T(std::forward<Args>(args)...);
 	}
 
 	void Free(T *value) noexcept {
-		assert(n_initialized <= buffer.size());
-		assert(n_allocated > 0);
-		assert(n_allocated <= n_initialized);
+		assert(n_allocated.load() > 0);
 
 		Slice *slice = reinterpret_cast<Slice *>(value);
 		assert(slice >= &buffer.front() && slice <= &buffer.back());
@@ -124,16 +168,46 @@ public:
 		value->~T();
 
 		/* insert the slice in the "available" linked list */
-		slice->next = available;
-		available = slice;
-		--n_allocated;
-
-		/* give memory back to the kernel when the last slice
-		   was freed */
-		if (n_allocated == 0) {
-			buffer.Discard();
-			n_initialized = 0;
-			available = nullptr;
+		const uint32_t index = (slice - &buffer.front()) + 1;
+		uint64_t old = available.load(std::memory_order_relaxed);
+		uint64_t replacement;
+		do {
+			slice->next = uint32_t(old);
+			replacement = (((old >> 32) + 1) << 32) | index;
+		} while (!available.compare_exchange_weak(old, replacement,
+							  std::memory_order_release,
+							  std::memory_order_relaxed));
+
+		n_allocated.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+private:
+	/**
+	 * Remove the first slice from the free list.  Returns nullptr
+	 * if the free list is empty.
+	 */
+	Slice *PopAvailable() noexcept {
+		uint64_t old = available.load(std::memory_order_acquire);
+
+		while (true) {
+			const uint32_t index = uint32_t(old);
+			if (index == 0)
+				return nullptr;
+
+			Slice &slice = buffer[index - 1];
+
+			/* this read may be stale if another thread
+			   pops the slice concurrently, but then the
+			   version counter has changed, and the
+			   compare_exchange below fails */
+			const uint32_t next = slice.next;
+
+			const uint64_t replacement =
+				(((old >> 32) + 1) << 32) | next;
+			if (available.compare_exchange_weak(old, replacement,
+							    std::memory_order_acq_rel,
+							    std::memory_order_acquire))
+				return &slice;
 		}
 	}
 };
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_SPSC_CIRCULAR_BUFFER_HXX
+#define MPD_SPSC_CIRCULAR_BUFFER_HXX
+
+#include "WritableBuffer.hxx"
+
+#include <atomic>
+
+#include <assert.h>
+#include <stddef.h>
+
+/**
+ * A circular buffer for one producer thread and one consumer thread.
+ *
+ * Like #CircularBuffer, this class does not manage buffer memory; it
+ * only manages the contents of an existing buffer given to the
+ * constructor.
+ *
+ * The producer may call Write() and Append(), the consumer may call
+ * Read() and Consume(), each without locking: the positions are
+ * atomic, and each one lives on its own cache line, so the two
+ * threads do not false-share.  All other methods (e.g. Clear()) may
+ * only be called while the threads are synchronized externally.
+ */
+template<typename T>
+class SpscCircularBuffer {
+public:
+	typedef WritableBuffer<T> Range;
+	typedef typename Range::pointer_type pointer_type;
+	typedef typename Range::size_type size_type;
+
+	/**
+	 * Assumed size of a cache line; used to pad the positions so
+	 * the producer and the consumer do not write to the same
+	 * line.
+	 */
+	static constexpr size_t CACHE_LINE_SIZE = 64;
+
+protected:
+	/**
+	 * The next index to be read.  Written only by the consumer
+	 * thread.
+	 */
+	std::atomic<size_type> head;
+
+	/**
+	 * Padding which keeps #head and #tail on separate cache
+	 * lines.  Explicit padding instead of alignas(), because
+	 * plain C++14 "operator new" does not guarantee extended
+	 * alignment, and instances of this class usually live inside
+	 * heap-allocated objects.
+	 */
+	char head_padding[CACHE_LINE_SIZE - sizeof(std::atomic<size_type>)];
+
+	/**
+	 * The next index to be written to.  Written only by the
+	 * producer thread.
+	 */
+	std::atomic<size_type> tail;
+
+	/**
+	 * Padding which separates #tail from the read-only members
+	 * below.
+	 */
+	char tail_padding[CACHE_LINE_SIZE - sizeof(std::atomic<size_type>)];
+
+	const size_type capacity;
+	const pointer_type data;
+
+public:
+	SpscCircularBuffer(pointer_type _data, size_type _capacity) noexcept
+		:head(0), tail(0), capacity(_capacity), data(_data) {}
+
+	SpscCircularBuffer(const SpscCircularBuffer &other) = delete;
+
+protected:
+	constexpr size_type Next(size_type i) const noexcept {
+		return i + 1 == capacity
+			? 0
+			: i + 1;
+	}
+
+public:
+	/**
+	 * May only be called while no other thread accesses this
+	 * buffer.
+	 */
+	void Clear() noexcept {
+		head.store(0, std::memory_order_relaxed);
+		tail.store(0, std::memory_order_relaxed);
+	}
+
+	constexpr size_type GetCapacity() const noexcept {
+		return capacity;
+	}
+
+	bool empty() const noexcept {
+		return head.load(std::memory_order_acquire) ==
+			tail.load(std::memory_order_acquire);
+	}
+
+	bool IsFull() const noexcept {
+		return Next(tail.load(std::memory_order_acquire)) ==
+			head.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Returns the number of elements stored in this buffer.
+	 */
+	size_type GetSize() const noexcept {
+		const size_type h = head.load(std::memory_order_acquire);
+		const size_type t = tail.load(std::memory_order_acquire);
+
+		return h <= t
+			? t - h
+			: capacity - h + t;
+	}
+
+	/**
+	 * Returns the number of elements that can be added to this
+	 * buffer.
+	 */
+	size_type GetSpace() const noexcept {
+		const size_type h = head.load(std::memory_order_acquire);
+		const size_type t = tail.load(std::memory_order_acquire);
+
+		/* space = capacity - size - 1 */
+		return (h <= t
+			? capacity - t + h
+			: h - t)
+			- 1;
+	}
+
+	/**
+	 * Prepares writing.  Returns a buffer range which may be
+	 * written.  When you are finished, call Append().
+	 *
+	 * May only be called by the producer thread.
+	 */
+	Range Write() noexcept {
+		const size_type h = head.load(std::memory_order_acquire);
+		const size_type t = tail.load(std::memory_order_relaxed);
+		assert(h < capacity);
+		assert(t < capacity);
+
+		size_type end = t < h
+			? h - 1
+			/* the "head==0" is there so we don't write
+			   the last cell, as this situation cannot be
+			   represented by head/tail */
+			: capacity - (h == 0);
+
+		return Range(data + t, end - t);
+	}
+
+	/**
+	 * Expands the tail of the buffer, after data has been written
+	 * to the buffer returned by Write().
+	 *
+	 * May only be called by the producer thread.
+	 */
+	void Append(size_type n) noexcept {
+		const size_type h = head.load(std::memory_order_acquire);
+		size_type t = tail.load(std::memory_order_relaxed);
+		assert(h < capacity);
+		assert(t < capacity);
+		assert(n < capacity);
+		assert(t + n <= capacity);
+		assert(h <= t || t + n < h);
+		(void)h;
+
+		t += n;
+
+		if (t == capacity) {
+			assert(h > 0);
+			t = 0;
+		}
+
+		tail.store(t, std::memory_order_release);
+	}
+
+	/**
+	 * Return a buffer range which may be read.  The buffer
+	 * pointer is writable, to allow modifications while parsing.
+	 *
+	 * May only be called by the consumer thread.
+	 */
+	Range Read() noexcept {
+		const size_type h = head.load(std::memory_order_relaxed);
+		const size_type t = tail.load(std::memory_order_acquire);
+		assert(h < capacity);
+		assert(t < capacity);
+
+		return Range(data + h, (t < h ? capacity : t) - h);
+	}
+
+	/**
+	 * Marks a chunk as consumed.
+	 *
+	 * May only be called by the consumer thread.
+	 */
+	void Consume(size_type n) noexcept {
+		size_type h = head.load(std::memory_order_relaxed);
+		const size_type t = tail.load(std::memory_order_acquire);
+		assert(h < capacity);
+		assert(t < capacity);
+		assert(n < capacity);
+		assert(h + n <= capacity);
+		assert(t < h || h + n <= t);
+		(void)t;
+
+		h += n;
+		if (h == capacity)
+			h = 0;
+
+		head.store(h, std::memory_order_release);
+	}
+};
+
+#endif
@@ -37,6 +37,19 @@ StringArrayContainsCase(const char *const*haystack,
 	return false;
 }
 
+bool
+StringArrayContainsCase(const char *const*haystack,
+			StringView needle) noexcept
+{
+	assert(haystack != nullptr);
+
+	for (; *haystack != nullptr; ++haystack)
+		if (needle.EqualsIgnoreCase(*haystack))
+			return true;
+
+	return false;
+}
+
 void
 ToUpperASCII(char *dest, const char *src, size_t size) noexcept
 {
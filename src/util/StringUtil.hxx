@@ -20,6 +20,7 @@
 #ifndef STRING_UTIL_HXX
 #define STRING_UTIL_HXX
 
+#include "StringView.hxx"
 #include "Compiler.h"
 
 #include <stddef.h>
@@ -37,6 +38,11 @@ bool
 StringArrayContainsCase(const char *const*haystack,
 			const char *needle) noexcept;
 
+gcc_pure
+bool
+StringArrayContainsCase(const char *const*haystack,
+			StringView needle) noexcept;
+
 /**
  * Convert the specified ASCII string (0x00..0x7f) to upper case.
  *
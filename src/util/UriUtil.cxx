@@ -86,6 +86,16 @@ uri_get_scheme(const char *uri) noexcept
 	return std::string(uri, end);
 }
 
+StringView
+uri_get_scheme_view(const char *uri) noexcept
+{
+	const char *end = strstr(uri, "://");
+	if (end == nullptr)
+		return nullptr;
+
+	return {uri, end};
+}
+
 const char *
 uri_get_path(const char *uri) noexcept
 {
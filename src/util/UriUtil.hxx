@@ -20,6 +20,7 @@
 #ifndef MPD_URI_UTIL_HXX
 #define MPD_URI_UTIL_HXX
 
+#include "StringView.hxx"
 #include "Compiler.h"
 
 #include <string>
@@ -39,6 +40,15 @@ gcc_pure
 std::string
 uri_get_scheme(const char *uri) noexcept;
 
+/**
+ * Returns the scheme name of the specified URI as a #StringView
+ * pointing into the given string, without allocating memory.  Returns
+ * nullptr if the URI has no scheme.
+ */
+gcc_pure
+StringView
+uri_get_scheme_view(const char *uri) noexcept;
+
 /**
  * Returns the URI path (including the query string) or nullptr if the
  * given URI has no path.
@@ -31,6 +31,7 @@
 #define MPD_VAR_SIZE_HXX
 
 #include "Alloc.hxx"
+#include "HeapProfile.hxx"
 #include "Compiler.h"
 
 #include <type_traits>
@@ -62,6 +63,7 @@ NewVarSize(size_t declared_tail_size, size_t real_tail_size, Args&&... args)
 
 	/* allocate memory */
 	T *instance = (T *)xalloc(size);
+	heap_profile_record(HeapTag::VARSIZE, size);
 
 	/* call the constructor */
 	new(instance) T(std::forward<Args>(args)...);
@@ -19,6 +19,10 @@
 
 #include "bit_reverse.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 /**
  * @see http://graphics.stanford.edu/~seander/bithacks.html#BitReverseTable
  */
@@ -29,3 +33,32 @@ const uint8_t bit_reverse_table[256] =
 #define R6(n) R4(n), R4(n + 2*4 ), R4(n + 1*4 ), R4(n + 3*4 )
     R6(0), R6(2), R6(1), R6(3)
 };
+
+void
+bit_reverse_buffer(uint8_t *p, uint8_t *end)
+{
+#ifdef __SSE2__
+	/* swap bit groups of decreasing width, 16 bytes at a time */
+	for (; p + 16 <= end; p += 16) {
+		__m128i v = _mm_loadu_si128((__m128i *)p);
+
+		v = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(v, 4),
+					       _mm_set1_epi8((char)0xf0)),
+				 _mm_and_si128(_mm_srli_epi16(v, 4),
+					       _mm_set1_epi8(0x0f)));
+		v = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(v, 2),
+					       _mm_set1_epi8((char)0xcc)),
+				 _mm_and_si128(_mm_srli_epi16(v, 2),
+					       _mm_set1_epi8(0x33)));
+		v = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(v, 1),
+					       _mm_set1_epi8((char)0xaa)),
+				 _mm_and_si128(_mm_srli_epi16(v, 1),
+					       _mm_set1_epi8(0x55)));
+
+		_mm_storeu_si128((__m128i *)p, v);
+	}
+#endif
+
+	for (; p < end; ++p)
+		*p = bit_reverse(*p);
+}
@@ -33,4 +33,18 @@ bit_reverse(uint8_t x)
 	return bit_reverse_table[x];
 }
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Reverse the bits in each byte of the given buffer (in place).
+ */
+void
+bit_reverse_buffer(uint8_t *p, uint8_t *end);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
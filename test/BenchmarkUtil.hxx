@@ -0,0 +1,65 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef BENCHMARK_UTIL_HXX
+#define BENCHMARK_UTIL_HXX
+
+#include <chrono>
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Invoke the given function #n_warmup times to warm up caches and
+ * branch predictors (and to trigger lazy allocations), then #n_runs
+ * times measured.
+ *
+ * @return the elapsed wallclock time in seconds
+ */
+template<typename F>
+static inline double
+RunBenchmark(unsigned n_warmup, unsigned n_runs, F &&f)
+{
+	for (unsigned i = 0; i < n_warmup; ++i)
+		f();
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (unsigned i = 0; i < n_runs; ++i)
+		f();
+
+	return std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Print one benchmark result line: throughput in MB/s and the cost of
+ * one sample in nanoseconds (multiply with your clock frequency in
+ * GHz to obtain cycles per sample).
+ */
+static inline void
+PrintBenchmarkResult(const char *name,
+		     uint64_t bytes, uint64_t samples, double seconds)
+{
+	printf("%-32s %8.1f MB/s %8.2f ns/sample\n",
+	       name,
+	       bytes / seconds / 1e6,
+	       seconds * 1e9 / samples);
+}
+
+#endif
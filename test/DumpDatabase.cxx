@@ -35,8 +35,11 @@
 #include "Log.hxx"
 #include "util/ScopeExit.hxx"
 
+#include <chrono>
 #include <stdexcept>
 #include <iostream>
+
+#include <stdio.h>
 using std::cout;
 using std::cerr;
 using std::endl;
@@ -143,14 +146,28 @@ try {
 
 	AtScopeExit(db) { delete db; };
 
+	const auto open_start = std::chrono::steady_clock::now();
+
 	db->Open();
 
+	const auto open_elapsed = std::chrono::steady_clock::now()
+		- open_start;
+
 	AtScopeExit(db) { db->Close(); };
 
 	const DatabaseSelection selection("", true);
 
+	const auto visit_start = std::chrono::steady_clock::now();
+
 	db->Visit(selection, DumpDirectory, DumpSong, DumpPlaylist);
 
+	const auto visit_elapsed = std::chrono::steady_clock::now()
+		- visit_start;
+
+	fprintf(stderr, "load: %.3f s, visit: %.3f s\n",
+		std::chrono::duration_cast<std::chrono::duration<double>>(open_elapsed).count(),
+		std::chrono::duration_cast<std::chrono::duration<double>>(visit_elapsed).count());
+
 	return EXIT_SUCCESS;
  } catch (const std::exception &e) {
 	LogError(e);
@@ -0,0 +1,114 @@
+/*
+ * Unit tests for class SpscCircularBuffer.
+ */
+
+#include "check.h"
+#include "util/SpscCircularBuffer.hxx"
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class TestSpscCircularBuffer : public CppUnit::TestFixture {
+	CPPUNIT_TEST_SUITE(TestSpscCircularBuffer);
+	CPPUNIT_TEST(TestIt);
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void TestIt() {
+		/* same single-threaded sequence as in
+		   TestCircularBuffer; the concurrent properties cannot
+		   be checked deterministically here */
+
+		static size_t N = 8;
+		int data[N];
+		SpscCircularBuffer<int> buffer(data, N);
+
+		CPPUNIT_ASSERT_EQUAL(size_t(N), buffer.GetCapacity());
+
+		/* '.' = empty; 'O' = occupied; 'X' = blocked */
+
+		/* checks on empty buffer */
+		/* [.......X] */
+		CPPUNIT_ASSERT_EQUAL(true, buffer.empty());
+		CPPUNIT_ASSERT_EQUAL(false, buffer.IsFull());
+		CPPUNIT_ASSERT_EQUAL(size_t(0), buffer.GetSize());
+		CPPUNIT_ASSERT_EQUAL(size_t(7), buffer.GetSpace());
+		CPPUNIT_ASSERT_EQUAL(true, buffer.Read().empty());
+		CPPUNIT_ASSERT_EQUAL(false, buffer.Write().empty());
+		CPPUNIT_ASSERT_EQUAL(&data[0], buffer.Write().data);
+		CPPUNIT_ASSERT_EQUAL(size_t(7), buffer.Write().size);
+
+		/* append one element */
+		/* [O......X] */
+		buffer.Append(1);
+		CPPUNIT_ASSERT_EQUAL(false, buffer.empty());
+		CPPUNIT_ASSERT_EQUAL(false, buffer.IsFull());
+		CPPUNIT_ASSERT_EQUAL(size_t(1), buffer.GetSize());
+		CPPUNIT_ASSERT_EQUAL(size_t(6), buffer.GetSpace());
+		CPPUNIT_ASSERT_EQUAL(size_t(1), buffer.Read().size);
+		CPPUNIT_ASSERT_EQUAL(&data[0], buffer.Read().data);
+		CPPUNIT_ASSERT_EQUAL(&data[1], buffer.Write().data);
+		CPPUNIT_ASSERT_EQUAL(size_t(6), buffer.Write().size);
+
+		/* append 6 elements, buffer is now full */
+		/* [OOOOOOOX] */
+		buffer.Append(6);
+		CPPUNIT_ASSERT_EQUAL(true, buffer.IsFull());
+		CPPUNIT_ASSERT_EQUAL(size_t(7), buffer.GetSize());
+		CPPUNIT_ASSERT_EQUAL(size_t(0), buffer.GetSpace());
+		CPPUNIT_ASSERT_EQUAL(size_t(7), buffer.Read().size);
+		CPPUNIT_ASSERT_EQUAL(true, buffer.Write().empty());
+
+		/* consume [0]; can append one at [7] */
+		/* [XOOOOOO.] */
+		buffer.Consume(1);
+		CPPUNIT_ASSERT_EQUAL(false, buffer.IsFull());
+		CPPUNIT_ASSERT_EQUAL(size_t(6), buffer.GetSize());
+		CPPUNIT_ASSERT_EQUAL(size_t(1), buffer.GetSpace());
+		CPPUNIT_ASSERT_EQUAL(size_t(6), buffer.Read().size);
+		CPPUNIT_ASSERT_EQUAL(&data[1], buffer.Read().data);
+		CPPUNIT_ASSERT_EQUAL(&data[7], buffer.Write().data);
+		CPPUNIT_ASSERT_EQUAL(size_t(1), buffer.Write().size);
+
+		/* append one element; [0] is still empty but cannot
+		   be written to because head==1 */
+		/* [XOOOOOOO] */
+		buffer.Append(1);
+		CPPUNIT_ASSERT_EQUAL(true, buffer.IsFull());
+		CPPUNIT_ASSERT_EQUAL(size_t(7), buffer.GetSize());
+		CPPUNIT_ASSERT_EQUAL(size_t(7), buffer.Read().size);
+		CPPUNIT_ASSERT_EQUAL(&data[1], buffer.Read().data);
+		CPPUNIT_ASSERT_EQUAL(true, buffer.Write().empty());
+
+		/* consume [1..3]; can append [0..2] */
+		/* [...XOOOO] */
+		buffer.Consume(3);
+		CPPUNIT_ASSERT_EQUAL(size_t(4), buffer.GetSize());
+		CPPUNIT_ASSERT_EQUAL(size_t(3), buffer.GetSpace());
+		CPPUNIT_ASSERT_EQUAL(size_t(4), buffer.Read().size);
+		CPPUNIT_ASSERT_EQUAL(&data[4], buffer.Read().data);
+		CPPUNIT_ASSERT_EQUAL(&data[0], buffer.Write().data);
+		CPPUNIT_ASSERT_EQUAL(size_t(3), buffer.Write().size);
+
+		/* wrap the tail around */
+		/* [OOOXOOOO] */
+		buffer.Append(3);
+		CPPUNIT_ASSERT_EQUAL(true, buffer.IsFull());
+		CPPUNIT_ASSERT_EQUAL(size_t(7), buffer.GetSize());
+		CPPUNIT_ASSERT_EQUAL(size_t(4), buffer.Read().size);
+		CPPUNIT_ASSERT_EQUAL(&data[4], buffer.Read().data);
+
+		/* consume [4..7]; the head wraps around */
+		/* [OOO....X] */
+		buffer.Consume(4);
+		CPPUNIT_ASSERT_EQUAL(size_t(3), buffer.GetSize());
+		CPPUNIT_ASSERT_EQUAL(size_t(4), buffer.GetSpace());
+		CPPUNIT_ASSERT_EQUAL(size_t(3), buffer.Read().size);
+		CPPUNIT_ASSERT_EQUAL(&data[0], buffer.Read().data);
+
+		/* Clear() empties the buffer */
+		buffer.Clear();
+		CPPUNIT_ASSERT_EQUAL(true, buffer.empty());
+		CPPUNIT_ASSERT_EQUAL(size_t(7), buffer.GetSpace());
+	}
+};
@@ -0,0 +1,273 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * This program measures the throughput of #PcmConvert, including
+ * format conversion, channel conversion and resampling.  Without
+ * arguments, a default set of conversions is run; alternatively, one
+ * conversion may be given like for run_convert:
+ *
+ *   benchmark_convert IN_FORMAT OUT_FORMAT
+ *
+ * "--sweep" runs the full matrix of sample format pairs, channel
+ * count pairs and sample rate pairs; "--json FILE" additionally
+ * writes the sweep results as a JSON report, so per-platform numbers
+ * (x86 servers, ARM endpoints) can be collected by CI and compared
+ * when picking dispatch thresholds for the conversion kernels:
+ *
+ *   benchmark_convert --sweep [--json FILE]
+ */
+
+#include "config.h"
+#include "AudioParser.hxx"
+#include "AudioFormat.hxx"
+#include "pcm/PcmConvert.hxx"
+#include "util/ConstBuffer.hxx"
+#include "Log.hxx"
+#include "BenchmarkUtil.hxx"
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static constexpr size_t N_FRAMES = 4096;
+static constexpr unsigned N_WARMUP = 16;
+static constexpr unsigned N_RUNS = 4096;
+
+/** fewer measured runs per conversion in sweep mode, because the
+    matrix contains dozens of entries */
+static constexpr unsigned N_SWEEP_RUNS = 1024;
+
+struct ConvertResult {
+	char in[32], out[32];
+
+	double mb_per_s, ns_per_sample;
+
+	/** false if #PcmConvert rejected this conversion */
+	bool supported;
+};
+
+static ConvertResult
+BenchmarkConvert(const char *in_s, const char *out_s, unsigned n_runs)
+{
+	ConvertResult result;
+	snprintf(result.in, sizeof(result.in), "%s", in_s);
+	snprintf(result.out, sizeof(result.out), "%s", out_s);
+
+	const auto in_audio_format = ParseAudioFormat(in_s, false);
+	const auto out_audio_format =
+		in_audio_format.WithMask(ParseAudioFormat(out_s, false));
+
+	static uint8_t src[N_FRAMES * MAX_CHANNELS * 4];
+	const size_t size = N_FRAMES * in_audio_format.GetFrameSize();
+
+	std::mt19937 rng(42);
+	for (size_t i = 0; i < size; ++i)
+		src[i] = uint8_t(rng());
+
+	PcmConvert state;
+
+	try {
+		state.Open(in_audio_format, out_audio_format);
+	} catch (const std::runtime_error &) {
+		/* e.g. an unsupported channel count combination */
+		char name[64];
+		snprintf(name, sizeof(name), "%s -> %s", in_s, out_s);
+		printf("%-32s (unsupported)\n", name);
+		result.mb_per_s = result.ns_per_sample = 0;
+		result.supported = false;
+		return result;
+	}
+
+	const double seconds = RunBenchmark(N_WARMUP, n_runs, [&](){
+		state.Convert({src, size});
+	});
+
+	state.Close();
+
+	const uint64_t bytes = uint64_t(size) * n_runs;
+	const uint64_t samples =
+		uint64_t(N_FRAMES) * in_audio_format.channels * n_runs;
+
+	char name[64];
+	snprintf(name, sizeof(name), "%s -> %s", in_s, out_s);
+	PrintBenchmarkResult(name, bytes, samples, seconds);
+
+	result.mb_per_s = bytes / seconds / 1e6;
+	result.ns_per_sample = seconds * 1e9 / samples;
+	result.supported = true;
+	return result;
+}
+
+/**
+ * Run the full conversion matrix: all sample format pairs at
+ * 44100:2, all channel count pairs at 16 bits, and all sample rate
+ * pairs at 16:2.
+ */
+static std::vector<ConvertResult>
+RunSweep()
+{
+	std::vector<ConvertResult> results;
+
+	static constexpr const char *formats[] = {
+		"8", "16", "24", "32", "f",
+	};
+
+	static constexpr unsigned channels[] = { 1, 2, 4, 6, 8 };
+
+	static constexpr unsigned rates[] = {
+		44100, 48000, 96000, 192000,
+	};
+
+	char in[32], out[32];
+
+	for (const char *f_in : formats)
+		for (const char *f_out : formats) {
+			snprintf(in, sizeof(in), "44100:%s:2", f_in);
+			snprintf(out, sizeof(out), "44100:%s:2", f_out);
+			results.push_back(BenchmarkConvert(in, out,
+							   N_SWEEP_RUNS));
+		}
+
+	for (unsigned c_in : channels)
+		for (unsigned c_out : channels) {
+			if (c_in == c_out)
+				continue;
+
+			snprintf(in, sizeof(in), "44100:16:%u", c_in);
+			snprintf(out, sizeof(out), "44100:16:%u", c_out);
+			results.push_back(BenchmarkConvert(in, out,
+							   N_SWEEP_RUNS));
+		}
+
+	for (unsigned r_in : rates)
+		for (unsigned r_out : rates) {
+			if (r_in == r_out)
+				continue;
+
+			snprintf(in, sizeof(in), "%u:16:2", r_in);
+			snprintf(out, sizeof(out), "%u:16:2", r_out);
+			results.push_back(BenchmarkConvert(in, out,
+							   N_SWEEP_RUNS));
+		}
+
+	return results;
+}
+
+static bool
+WriteJsonReport(const char *path, const std::vector<ConvertResult> &results)
+{
+	FILE *file = fopen(path, "w");
+	if (file == nullptr) {
+		perror(path);
+		return false;
+	}
+
+	fprintf(file, "{\n  \"frames_per_run\": %zu,\n  \"results\": [\n",
+		N_FRAMES);
+
+	bool first = true;
+	for (const auto &i : results) {
+		if (!first)
+			fprintf(file, ",\n");
+		first = false;
+
+		if (i.supported)
+			fprintf(file,
+				"    {\"in\": \"%s\", \"out\": \"%s\", "
+				"\"mb_per_s\": %.1f, "
+				"\"ns_per_sample\": %.2f}",
+				i.in, i.out,
+				i.mb_per_s, i.ns_per_sample);
+		else
+			fprintf(file,
+				"    {\"in\": \"%s\", \"out\": \"%s\", "
+				"\"supported\": false}",
+				i.in, i.out);
+	}
+
+	fprintf(file, "\n  ]\n}\n");
+	fclose(file);
+	return true;
+}
+
+int
+main(int argc, char **argv)
+try {
+	if (argc >= 2 && strcmp(argv[1], "--sweep") == 0) {
+		const char *json_path = nullptr;
+		if (argc == 4 && strcmp(argv[2], "--json") == 0)
+			json_path = argv[3];
+		else if (argc != 2) {
+			fprintf(stderr,
+				"Usage: benchmark_convert --sweep [--json FILE]\n");
+			return EXIT_FAILURE;
+		}
+
+		const auto results = RunSweep();
+
+		if (json_path != nullptr &&
+		    !WriteJsonReport(json_path, results))
+			return EXIT_FAILURE;
+
+		return EXIT_SUCCESS;
+	}
+
+	if (argc == 3) {
+		BenchmarkConvert(argv[1], argv[2], N_RUNS);
+		return EXIT_SUCCESS;
+	}
+
+	if (argc != 1) {
+		fprintf(stderr,
+			"Usage: benchmark_convert [--sweep [--json FILE]]\n"
+			"       benchmark_convert IN_FORMAT OUT_FORMAT\n");
+		return EXIT_FAILURE;
+	}
+
+	static constexpr struct {
+		const char *in, *out;
+	} conversions[] = {
+		/* format conversion */
+		{ "44100:16:2", "44100:32:2" },
+		{ "44100:16:2", "44100:f:2" },
+		{ "44100:24:2", "44100:16:2" },
+		{ "44100:f:2", "44100:16:2" },
+
+		/* channel conversion */
+		{ "44100:16:1", "44100:16:2" },
+		{ "44100:16:6", "44100:16:2" },
+
+		/* resampling */
+		{ "44100:16:2", "48000:16:2" },
+		{ "96000:24:2", "48000:24:2" },
+	};
+
+	for (const auto &c : conversions)
+		BenchmarkConvert(c.in, c.out, N_RUNS);
+
+	return EXIT_SUCCESS;
+} catch (const std::exception &e) {
+	LogError(e);
+	return EXIT_FAILURE;
+}
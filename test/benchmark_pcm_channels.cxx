@@ -0,0 +1,99 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * This program measures the throughput of pcm_convert_channels_*()
+ * and prints frames per second for each conversion.
+ */
+
+#include "config.h"
+#include "pcm/PcmChannels.hxx"
+#include "pcm/PcmBuffer.hxx"
+#include "util/ConstBuffer.hxx"
+
+#include <chrono>
+#include <random>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static constexpr size_t N_FRAMES = 4096;
+static constexpr unsigned N_RUNS = 20000;
+
+template<typename T, typename F>
+static void
+Benchmark(const char *name, unsigned dest_channels, unsigned src_channels,
+	  F &&convert)
+{
+	static T src[N_FRAMES * 8];
+
+	std::mt19937 rng(42);
+	for (auto &i : src)
+		i = T(rng());
+
+	PcmBuffer buffer;
+
+	/* warm up (and allocate the destination buffer) */
+	convert(buffer, dest_channels, src_channels,
+		ConstBuffer<T>(src, N_FRAMES * src_channels));
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (unsigned i = 0; i < N_RUNS; ++i)
+		convert(buffer, dest_channels, src_channels,
+			ConstBuffer<T>(src, N_FRAMES * src_channels));
+
+	const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+	printf("%-16s %u -> %u: %8.1f Mframes/s\n",
+	       name, src_channels, dest_channels,
+	       double(uint64_t(N_FRAMES) * N_RUNS) / elapsed);
+}
+
+int
+main(int, char **)
+{
+	static constexpr struct {
+		unsigned dest, src;
+	} conversions[] = {
+		{ 2, 1 },
+		{ 1, 2 },
+		{ 2, 6 },
+		{ 2, 8 },
+		{ 6, 2 },
+	};
+
+	for (const auto &c : conversions)
+		Benchmark<int16_t>("s16", c.dest, c.src,
+				   pcm_convert_channels_16);
+
+	for (const auto &c : conversions)
+		Benchmark<int32_t>("s24_p32", c.dest, c.src,
+				   pcm_convert_channels_24);
+
+	for (const auto &c : conversions)
+		Benchmark<int32_t>("s32", c.dest, c.src,
+				   pcm_convert_channels_32);
+
+	for (const auto &c : conversions)
+		Benchmark<float>("float", c.dest, c.src,
+				 pcm_convert_channels_float);
+
+	return EXIT_SUCCESS;
+}
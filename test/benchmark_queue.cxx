@@ -0,0 +1,317 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * This program measures how the queue scales with its length: bulk
+ * Append(), DeletePosition() from the middle, ShuffleOrder(),
+ * SetPriorityRange(), the "plchanges" delta (both the full scan over
+ * IsNewerAtPosition() and the change ring fast path), and a
+ * queue_save()/queue_load_song() round trip, each over a synthetic
+ * queue of 10k to 500k songs.  The numbers are only comparable
+ * between builds on the same machine.
+ */
+
+#include "config.h"
+#include "queue/Queue.hxx"
+#include "queue/QueueSave.hxx"
+#include "DetachedSong.hxx"
+#include "SongLoader.hxx"
+#include "LocateUri.hxx"
+#include "tag/Builder.hxx"
+#include "tag/Tag.hxx"
+#include "fs/Path.hxx"
+#include "fs/io/TextFile.hxx"
+#include "fs/io/BufferedOutputStream.hxx"
+#include "fs/io/StringOutputStream.hxx"
+#include "ls.hxx"
+#include "Log.hxx"
+#include "BenchmarkUtil.hxx"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static constexpr unsigned QUEUE_SIZES[] = { 10000, 100000, 500000 };
+
+/** number of songs modified for the "plchanges" benchmarks */
+static constexpr unsigned N_CHANGES = 100;
+
+/** number of middle deletions for the DeletePosition() benchmark */
+static constexpr unsigned N_DELETE = 1000;
+
+/* all benchmark songs are remote, so the #SongLoader passes their
+   URIs through unchanged; these stubs keep the database and client
+   machinery out of the link */
+
+bool
+uri_supported_scheme(const char *uri) noexcept
+{
+	return strncmp(uri, "http://", 7) == 0;
+}
+
+DetachedSong
+SongLoader::LoadSong(const LocatedUri &located_uri) const
+{
+	return DetachedSong(located_uri.canonical_uri);
+}
+
+DetachedSong
+SongLoader::LoadSong(const char *uri_utf8) const
+{
+	return DetachedSong(uri_utf8);
+}
+
+bool
+DetachedSong::LoadFile(Path)
+{
+	return false;
+}
+
+static DetachedSong
+MakeSong(unsigned i)
+{
+	char buffer[64];
+
+	TagBuilder tag;
+
+	snprintf(buffer, sizeof(buffer), "Artist %u", i % 100);
+	tag.AddItem(TAG_ARTIST, buffer);
+
+	snprintf(buffer, sizeof(buffer), "Album %u", i % 1000);
+	tag.AddItem(TAG_ALBUM, buffer);
+
+	snprintf(buffer, sizeof(buffer), "Title Number %u", i);
+	tag.AddItem(TAG_TITLE, buffer);
+
+	snprintf(buffer, sizeof(buffer), "http://bench.invalid/song%u.ogg", i);
+	return DetachedSong(buffer, tag.Commit());
+}
+
+static void
+PrintRate(const char *name, unsigned n, uint64_t n_songs, double seconds)
+{
+	printf("%-24s %7uk %8.2f Msongs/s\n",
+	       name, n / 1000, double(n_songs) / seconds / 1e6);
+}
+
+static void
+BenchmarkAppend(Queue &queue)
+{
+	const unsigned n = queue.max_length;
+
+	const double seconds = RunBenchmark(0, 1, [&](){
+		for (unsigned i = 0; i < n; ++i)
+			queue.Append(MakeSong(i), 0);
+	});
+
+	PrintRate("append", n, n, seconds);
+}
+
+static void
+BenchmarkChanges(Queue &queue)
+{
+	const unsigned n = queue.GetLength();
+
+	/* flush the bulk append churn, which has overflowed the
+	   change ring anyway */
+	queue.IncrementVersion();
+
+	/* modify a handful of spread-out songs after the version the
+	   client has seen, which is what an idle "playlist" client
+	   asking for plchanges looks like */
+	const uint32_t since = queue.version;
+
+	for (unsigned i = 0; i < N_CHANGES; ++i)
+		queue.ModifyAtPosition(i * (n / N_CHANGES));
+
+	queue.IncrementVersion();
+
+	/* prevent the compiler from optimizing the scans away */
+	volatile unsigned n_changed = 0;
+
+	constexpr unsigned N_RUNS = 64;
+
+	double seconds = RunBenchmark(4, N_RUNS, [&](){
+		unsigned count = 0;
+		for (unsigned i = 0; i < n; ++i)
+			if (queue.IsNewerAtPosition(i, since))
+				++count;
+		n_changed = count;
+	});
+
+	PrintRate("plchanges full scan", n,
+		  uint64_t(n) * N_RUNS, seconds);
+
+	std::vector<unsigned> positions;
+
+	seconds = RunBenchmark(4, N_RUNS, [&](){
+		positions.clear();
+		if (!queue.GetChangedPositions(since, positions)) {
+			fprintf(stderr, "change ring did not cover the delta\n");
+			exit(EXIT_FAILURE);
+		}
+		n_changed = positions.size();
+	});
+
+	printf("%-24s %7uk %8.2f us/call (%u changed)\n",
+	       "plchanges change ring", n / 1000,
+	       seconds * 1e6 / N_RUNS, n_changed);
+}
+
+static void
+BenchmarkShuffle(Queue &queue)
+{
+	const unsigned n = queue.GetLength();
+
+	const double seconds = RunBenchmark(1, 4, [&](){
+		queue.ShuffleOrder();
+	});
+
+	PrintRate("shuffle order", n, uint64_t(n) * 4, seconds);
+}
+
+static void
+BenchmarkPriority(Queue &queue)
+{
+	/* prioritize a 1000-song slice in the middle, which is the
+	   shape of "prio" on an album in a big queue; applying a
+	   priority to every song would drown the measurement in the
+	   O(n²) reorder */
+	const unsigned n = queue.GetLength();
+	const unsigned start = n / 2;
+	const unsigned end = start + 1000;
+	uint8_t priority = 1;
+
+	const double seconds = RunBenchmark(1, 4, [&](){
+		queue.SetPriorityRange(start, end, priority++, -1);
+	});
+
+	printf("%-24s %7uk %8.2f ms/slice\n",
+	       "set priority slice", n / 1000, seconds * 1e3 / 4);
+
+	/* restore neutral priorities so the saved queue is free of
+	   "Prio:" lines */
+	queue.SetPriorityRange(start, end, 0, -1);
+}
+
+static void
+BenchmarkSaveLoad(Queue &queue)
+{
+	const unsigned n = queue.GetLength();
+
+	std::string image;
+
+	const double save_seconds = RunBenchmark(1, 4, [&](){
+		StringOutputStream sos;
+		BufferedOutputStream bos(sos);
+		queue_save(bos, queue);
+		bos.Flush();
+		image = sos.TakeValue();
+	});
+
+	PrintBenchmarkResult("queue_save",
+			     uint64_t(image.length()) * 4,
+			     uint64_t(n) * 4, save_seconds);
+
+	char path[] = "/tmp/benchmark_queue.XXXXXX";
+	const int fd = mkstemp(path);
+	if (fd < 0) {
+		perror("mkstemp");
+		exit(EXIT_FAILURE);
+	}
+
+	if (write(fd, image.data(), image.length()) < 0) {
+		perror("write");
+		exit(EXIT_FAILURE);
+	}
+
+	close(fd);
+
+	Queue loaded(queue.max_length);
+	const SongLoader loader(nullptr, nullptr);
+
+	const double load_seconds = RunBenchmark(0, 1, [&](){
+		TextFile file(Path::FromFS(path));
+
+		const char *line;
+		while ((line = file.ReadLine()) != nullptr)
+			queue_load_song(file, loader, line, loaded);
+	});
+
+	unlink(path);
+
+	if (loaded.GetLength() != n) {
+		fprintf(stderr, "round trip lost songs: %u != %u\n",
+			loaded.GetLength(), n);
+		exit(EXIT_FAILURE);
+	}
+
+	PrintRate("queue_load_song", n, n, load_seconds);
+
+	loaded.Clear();
+}
+
+static void
+BenchmarkDelete(Queue &queue)
+{
+	const double seconds = RunBenchmark(0, 1, [&](){
+		for (unsigned i = 0; i < N_DELETE; ++i)
+			queue.DeletePosition(queue.GetLength() / 2);
+	});
+
+	printf("%-24s %7uk %8.2f us/delete\n",
+	       "delete middle", queue.max_length / 1000,
+	       seconds * 1e6 / N_DELETE);
+}
+
+static void
+BenchmarkQueueSize(unsigned n)
+{
+	Queue queue(n);
+
+	/* the shuffle and priority benchmarks reorder like "random"
+	   mode does */
+	queue.random = true;
+
+	BenchmarkAppend(queue);
+	BenchmarkChanges(queue);
+	BenchmarkShuffle(queue);
+	BenchmarkPriority(queue);
+	BenchmarkSaveLoad(queue);
+	BenchmarkDelete(queue);
+
+	queue.Clear();
+}
+
+int
+main(int, char **)
+try {
+	for (unsigned n : QUEUE_SIZES)
+		BenchmarkQueueSize(n);
+
+	return EXIT_SUCCESS;
+} catch (const std::exception &e) {
+	LogError(e);
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * This program measures the throughput of SongFilter::Match() over a
+ * synthetic song collection, once with an exact (case-sensitive)
+ * match and once with a case-folding substring search, which is what
+ * the "search" command uses.
+ */
+
+#include "config.h"
+#include "SongFilter.hxx"
+#include "DetachedSong.hxx"
+#include "tag/Builder.hxx"
+#include "tag/Tag.hxx"
+#include "Log.hxx"
+#include "BenchmarkUtil.hxx"
+
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static constexpr unsigned N_SONGS = 1024;
+static constexpr unsigned N_WARMUP = 4;
+static constexpr unsigned N_RUNS = 1024;
+
+static std::vector<DetachedSong>
+MakeSongs()
+{
+	std::vector<DetachedSong> songs;
+	songs.reserve(N_SONGS);
+
+	for (unsigned i = 0; i < N_SONGS; ++i) {
+		char buffer[64];
+
+		TagBuilder tag;
+
+		snprintf(buffer, sizeof(buffer), "Artist %u", i % 100);
+		tag.AddItem(TAG_ARTIST, buffer);
+
+		snprintf(buffer, sizeof(buffer), "Album %u", i % 200);
+		tag.AddItem(TAG_ALBUM, buffer);
+
+		snprintf(buffer, sizeof(buffer), "Title Number %u", i);
+		tag.AddItem(TAG_TITLE, buffer);
+
+		snprintf(buffer, sizeof(buffer), "song%u.ogg", i);
+		songs.emplace_back(buffer, tag.Commit());
+	}
+
+	return songs;
+}
+
+static void
+BenchmarkFilter(const char *name,
+		const std::vector<DetachedSong> &songs,
+		const char *tag, const char *value, bool fold_case)
+{
+	SongFilter filter;
+	if (!filter.Parse(tag, value, fold_case)) {
+		fprintf(stderr, "Failed to parse filter: %s\n", tag);
+		exit(EXIT_FAILURE);
+	}
+
+	/* prevent the compiler from optimizing the matches away */
+	volatile unsigned n_matches = 0;
+
+	const double seconds = RunBenchmark(N_WARMUP, N_RUNS, [&](){
+		unsigned n = 0;
+		for (const auto &song : songs)
+			if (filter.Match(song))
+				++n;
+		n_matches = n;
+	});
+
+	printf("%-32s %8.2f Msongs/s (%u matches)\n",
+	       name,
+	       double(uint64_t(N_SONGS) * N_RUNS) / seconds / 1e6,
+	       n_matches);
+}
+
+int
+main(int, char **)
+try {
+	const auto songs = MakeSongs();
+
+	BenchmarkFilter("artist exact", songs,
+			"artist", "Artist 50", false);
+	BenchmarkFilter("artist substring fold_case", songs,
+			"artist", "artist 50", true);
+	BenchmarkFilter("any substring fold_case", songs,
+			"any", "number 512", true);
+
+	return EXIT_SUCCESS;
+} catch (const std::exception &e) {
+	LogError(e);
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * This program measures the throughput of #PcmVolume (software
+ * volume) for each sample format.
+ */
+
+#include "config.h"
+#include "pcm/Volume.hxx"
+#include "util/WritableBuffer.hxx"
+#include "Log.hxx"
+#include "BenchmarkUtil.hxx"
+
+#include <random>
+
+#include <stdlib.h>
+
+static constexpr size_t N_SAMPLES = 4096 * 2;
+static constexpr unsigned N_WARMUP = 64;
+static constexpr unsigned N_RUNS = 65536;
+
+/**
+ * A sink for benchmark output; keeps the compiler from proving the
+ * results unused.
+ */
+static volatile uint8_t benchmark_sink;
+
+static void
+BenchmarkVolume(const char *name, SampleFormat format)
+{
+	static uint8_t buffer[N_SAMPLES * 4];
+	const size_t size = N_SAMPLES * sample_format_size(format);
+
+	std::mt19937 rng(42);
+	for (size_t i = 0; i < size; ++i)
+		buffer[i] = uint8_t(rng());
+
+	PcmVolume pv;
+	pv.SetVolume(PCM_VOLUME_1 * 3 / 4);
+	pv.Open(format);
+
+	/* ApplyInPlace() instead of Apply(): the latter is gcc_pure,
+	   and the compiler deletes a pure call whose result is
+	   discarded, leaving nothing to measure */
+	const double seconds = RunBenchmark(N_WARMUP, N_RUNS, [&](){
+		pv.ApplyInPlace({buffer, size});
+	});
+
+	pv.Close();
+
+	/* consume the output */
+	uint8_t checksum = 0;
+	for (size_t i = 0; i < size; ++i)
+		checksum ^= buffer[i];
+	benchmark_sink = checksum;
+
+	PrintBenchmarkResult(name,
+			     uint64_t(size) * N_RUNS,
+			     uint64_t(N_SAMPLES) * N_RUNS,
+			     seconds);
+}
+
+int
+main(int, char **)
+try {
+	BenchmarkVolume("s8", SampleFormat::S8);
+	BenchmarkVolume("s16", SampleFormat::S16);
+	BenchmarkVolume("s24_p32", SampleFormat::S24_P32);
+	BenchmarkVolume("s32", SampleFormat::S32);
+	BenchmarkVolume("float", SampleFormat::FLOAT);
+
+	return EXIT_SUCCESS;
+} catch (const std::exception &e) {
+	LogError(e);
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright 2003-2017 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Replays a command trace recorded with the "player_trace_file"
+ * setting against a real player/decoder thread pair feeding a null
+ * output, reproducing the recorded command timing.  After each
+ * command, the resulting player state and the state-transition
+ * latency (the time the synchronous command took) are printed, so
+ * pipeline regressions can be bisected with a deterministic input.
+ *
+ * With --fast, the recorded delays are skipped and the commands are
+ * issued back-to-back, which shakes out races that depend on
+ * command timing.
+ */
+
+#include "config.h"
+#include "player/Control.hxx"
+#include "player/Thread.hxx"
+#include "player/Listener.hxx"
+#include "output/MultipleOutputs.hxx"
+#include "mixer/Listener.hxx"
+#include "decoder/DecoderList.hxx"
+#include "input/Init.hxx"
+#include "event/Thread.hxx"
+#include "config/ConfigGlobal.hxx"
+#include "DetachedSong.hxx"
+#include "ReplayGainConfig.hxx"
+#include "Chrono.hxx"
+#include "util/StringAPI.hxx"
+#include "Log.hxx"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* this binary has no clients; idle events are discarded (and this
+   stub keeps the Instance machinery out of the link) */
+void
+idle_add(unsigned)
+{
+}
+
+class ReplayPlayerListener final : public PlayerListener {
+public:
+	void OnPlayerSync() noexcept override {}
+	void OnPlayerTagModified() noexcept override {}
+};
+
+class ReplayMixerListener final : public MixerListener {
+public:
+	void OnMixerVolumeChanged(Mixer &, int) override {}
+};
+
+static const char *
+player_state_name(PlayerState state) noexcept
+{
+	switch (state) {
+	case PlayerState::STOP:
+		return "stop";
+
+	case PlayerState::PAUSE:
+		return "pause";
+
+	case PlayerState::PLAY:
+		return "play";
+	}
+
+	return "?";
+}
+
+/**
+ * Issue one recorded player command through the same public
+ * PlayerControl API the playlist uses.
+ */
+static void
+replay_command(PlayerControl &pc, const char *name,
+	       const std::string &song_uri, unsigned song_ms)
+{
+	if (StringIsEqual(name, "queue")) {
+		pc.LockEnqueueSong(std::make_unique<DetachedSong>(song_uri.c_str()));
+	} else if (StringIsEqual(name, "seek")) {
+		try {
+			pc.LockSeek(std::make_unique<DetachedSong>(song_uri.c_str()),
+				    SongTime::FromMS(song_ms));
+		} catch (const std::exception &e) {
+			/* a failed decoder start was probably also
+			   part of the recorded run */
+			fprintf(stderr, "seek failed: %s\n", e.what());
+		}
+	} else if (StringIsEqual(name, "stop") ||
+		   StringIsEqual(name, "close_audio")) {
+		pc.LockStop();
+	} else if (StringIsEqual(name, "pause")) {
+		pc.LockPause();
+	} else if (StringIsEqual(name, "cancel")) {
+		pc.LockCancel();
+	} else if (StringIsEqual(name, "update_audio")) {
+		pc.LockUpdateAudio();
+	} else if (StringIsEqual(name, "refresh")) {
+		pc.LockGetStatus();
+	} else if (!StringIsEqual(name, "none")) {
+		fprintf(stderr, "unknown player command: %s\n", name);
+	}
+}
+
+int main(int argc, char **argv)
+try {
+	bool fast = false;
+	int i = 1;
+
+	if (i < argc && StringIsEqual(argv[i], "--fast")) {
+		fast = true;
+		++i;
+	}
+
+	if (i + 1 != argc) {
+		fprintf(stderr, "Usage: run_player_replay [--fast] TRACE\n");
+		return EXIT_FAILURE;
+	}
+
+	const char *const trace_path = argv[i];
+
+	FILE *trace = fopen(trace_path, "r");
+	if (trace == nullptr) {
+		fprintf(stderr, "Failed to open %s\n", trace_path);
+		return EXIT_FAILURE;
+	}
+
+	config_global_init();
+
+	EventThread io_thread;
+	io_thread.Start();
+
+	input_stream_global_init(io_thread.GetEventLoop());
+	decoder_plugin_init_all();
+
+	ReplayPlayerListener listener;
+	ReplayMixerListener mixer_listener;
+	const ReplayGainConfig replay_gain_config;
+
+	MultipleOutputs outputs(mixer_listener);
+
+	PlayerControl pc(listener, outputs,
+			 1024, 102, 0,
+			 AudioFormat::Undefined(), replay_gain_config);
+
+	outputs.AddNullOutput(io_thread.GetEventLoop(),
+			      replay_gain_config, pc);
+
+	StartPlayerThread(pc);
+
+	char line[4096];
+	unsigned long long last_t = 0;
+	std::string song_uri;
+	unsigned song_ms = 0;
+
+	while (fgets(line, sizeof(line), trace) != nullptr) {
+		char *p = strchr(line, '\n');
+		if (p != nullptr)
+			*p = 0;
+
+		unsigned long long t;
+		char seam[16];
+		int consumed;
+		if (sscanf(line, "%llu %15s %n", &t, seam, &consumed) < 2)
+			continue;
+
+		const char *rest = line + consumed;
+
+		if (StringIsEqual(seam, "song")) {
+			if (sscanf(rest, "%u %n", &song_ms, &consumed) < 1)
+				continue;
+
+			song_uri = rest + consumed;
+		} else if (StringIsEqual(seam, "player")) {
+			/* reproduce the recorded command timing */
+			if (!fast && t > last_t)
+				usleep(t - last_t);
+			last_t = t;
+
+			if (StringIsEqual(rest, "exit"))
+				break;
+
+			const auto cmd_start = std::chrono::steady_clock::now();
+			replay_command(pc, rest, song_uri, song_ms);
+			const auto latency = std::chrono::steady_clock::now() - cmd_start;
+
+			const auto status = pc.LockGetStatus();
+			printf("%10llu %-12s state=%-5s latency=%lluus\n",
+			       t, rest, player_state_name(status.state),
+			       (unsigned long long)
+			       std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+		}
+
+		/* "decoder" lines are informational: the replayed
+		   player thread issues its own decoder commands */
+	}
+
+	fclose(trace);
+
+	pc.Kill();
+
+	decoder_plugin_deinit_all();
+	input_stream_global_finish();
+
+	return EXIT_SUCCESS;
+} catch (const std::exception &e) {
+	LogError(e);
+	return EXIT_FAILURE;
+}
@@ -8,6 +8,7 @@
 #include "UriUtilTest.hxx"
 #include "MimeTypeTest.hxx"
 #include "TestCircularBuffer.hxx"
+#include "TestSpscCircularBuffer.hxx"
 
 #include <cppunit/TestFixture.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
@@ -21,6 +22,7 @@ CPPUNIT_TEST_SUITE_REGISTRATION(SplitStringTest);
 CPPUNIT_TEST_SUITE_REGISTRATION(UriUtilTest);
 CPPUNIT_TEST_SUITE_REGISTRATION(MimeTypeTest);
 CPPUNIT_TEST_SUITE_REGISTRATION(TestCircularBuffer);
+CPPUNIT_TEST_SUITE_REGISTRATION(TestSpscCircularBuffer);
 
 int
 main(gcc_unused int argc, gcc_unused char **argv)